@@ -0,0 +1,281 @@
+#!/usr/bin/env python3
+
+# Copyright 2023 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+"""Tunes CPU dispatch tile sizes and writes a tuning database.
+
+Takes the executable benchmarks dumped by iree-compile with
+`--iree-hal-dump-executable-benchmarks-to=<dir>`, sweeps candidate lowering
+configurations for each dispatch root op, times them with
+iree-benchmark-module on the local CPU, and writes the fastest configurations
+to a tuning database that iree-compile consumes via
+`--iree-codegen-llvmcpu-tuning-db=<file>`.
+
+Candidates are derived from the default configuration selected by the compiler
+by scaling the distribution and vector tile sizes. Only candidates that beat
+the default by at least `--min-speedup` are recorded.
+
+Example:
+  iree-compile model.mlir -o /dev/null \\
+    --iree-hal-target-backends=llvm-cpu \\
+    --iree-llvmcpu-target-cpu=host \\
+    --iree-hal-dump-executable-benchmarks-to=/tmp/benchmarks
+  tune_cpu_dispatches.py \\
+    --iree_compile=build/tools/iree-compile \\
+    --iree_benchmark_module=build/tools/iree-benchmark-module \\
+    --benchmarks_dir=/tmp/benchmarks \\
+    --output=tuning.db \\
+    -- --iree-hal-target-backends=llvm-cpu --iree-llvmcpu-target-cpu=host
+  iree-compile model.mlir -o model.vmfb ... \\
+    --iree-codegen-llvmcpu-tuning-db=tuning.db
+"""
+
+import argparse
+import ast
+import itertools
+import json
+import pathlib
+import re
+import subprocess
+import sys
+import tempfile
+from typing import Dict, List, Optional, Sequence, Tuple
+
+# Matches a tuning database entry: "<key>" = <compilation_info>
+DB_ENTRY_RE = re.compile(r'^"(?P<key>[^"]+)"\s*=\s*(?P<value>.+)$')
+# Matches the tile sizes within a lowering config.
+TILE_SIZES_RE = re.compile(r"tile_sizes\s*=\s*(\[\[.*?\]\])")
+# Factors applied to each tile size when generating candidates.
+SCALE_FACTORS = (0.5, 1, 2)
+
+
+def parse_arguments():
+  """Parses command line arguments."""
+  parser = argparse.ArgumentParser(
+      description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+  parser.add_argument("--iree_compile",
+                      type=pathlib.Path,
+                      required=True,
+                      help="path to the iree-compile tool")
+  parser.add_argument("--iree_benchmark_module",
+                      type=pathlib.Path,
+                      required=True,
+                      help="path to the iree-benchmark-module tool")
+  parser.add_argument("--benchmarks_dir",
+                      type=pathlib.Path,
+                      required=True,
+                      help="directory of dumped executable benchmarks")
+  parser.add_argument("--output",
+                      type=pathlib.Path,
+                      required=True,
+                      help="tuning database to write; existing entries are "
+                      "preserved unless retuned")
+  parser.add_argument("--device",
+                      default="local-task",
+                      help="device to benchmark on")
+  parser.add_argument("--repetitions",
+                      type=int,
+                      default=5,
+                      help="benchmark repetitions; the median is used")
+  parser.add_argument("--max_candidates",
+                      type=int,
+                      default=32,
+                      help="maximum number of candidates per dispatch")
+  parser.add_argument("--min_speedup",
+                      type=float,
+                      default=1.03,
+                      help="minimum speedup over the default configuration "
+                      "required to record a candidate")
+  parser.add_argument("compile_flags",
+                      metavar="<compile-flags>",
+                      nargs="*",
+                      help="additional flags passed to iree-compile; must "
+                      "select the same target as the original compilation")
+  return parser.parse_args()
+
+
+def read_database(path: pathlib.Path) -> Dict[str, str]:
+  """Reads a tuning database into a key -> compilation_info dict."""
+  entries = {}
+  if not path.exists():
+    return entries
+  for line in path.read_text().splitlines():
+    line = line.strip()
+    if not line or line.startswith("//"):
+      continue
+    match = DB_ENTRY_RE.match(line)
+    if match:
+      entries[match.group("key")] = match.group("value").strip()
+  return entries
+
+
+def write_database(path: pathlib.Path, entries: Dict[str, str],
+                   header: Sequence[str] = ()):
+  with open(path, "w") as f:
+    for line in header:
+      f.write(f"// {line}\n")
+    for key, value in sorted(entries.items()):
+      f.write(f'"{key}" = {value}\n')
+
+
+def compile_module(args, source: pathlib.Path, output: pathlib.Path,
+                   extra_flags: Sequence[str]) -> bool:
+  cmd = [
+      str(args.iree_compile),
+      str(source), "-o",
+      str(output)
+  ] + list(args.compile_flags) + list(extra_flags)
+  result = subprocess.run(cmd,
+                          stdout=subprocess.DEVNULL,
+                          stderr=subprocess.PIPE,
+                          text=True)
+  if result.returncode != 0:
+    print(f"  compilation failed: {result.stderr.strip()[:200]}",
+          file=sys.stderr)
+    return False
+  return True
+
+
+def benchmark_module(args, module: pathlib.Path) -> Optional[float]:
+  """Returns the summed median real time in ns of all benchmark functions."""
+  cmd = [
+      str(args.iree_benchmark_module), f"--module={module}",
+      f"--device={args.device}", "--benchmark_format=json",
+      f"--benchmark_repetitions={args.repetitions}",
+      "--benchmark_report_aggregates_only=true"
+  ]
+  result = subprocess.run(cmd,
+                          stdout=subprocess.PIPE,
+                          stderr=subprocess.DEVNULL,
+                          text=True)
+  if result.returncode != 0:
+    return None
+  try:
+    report = json.loads(result.stdout)
+  except json.JSONDecodeError:
+    return None
+  total_ns = 0.0
+  for benchmark in report.get("benchmarks", []):
+    if benchmark.get("aggregate_name") != "median":
+      continue
+    scale = {"ns": 1, "us": 1e3, "ms": 1e6, "s": 1e9}[benchmark["time_unit"]]
+    total_ns += benchmark["real_time"] * scale
+  return total_ns if total_ns > 0 else None
+
+
+def scale_tile_size(size: int, factor: float) -> int:
+  return max(1, int(size * factor)) if size > 0 else size
+
+
+def generate_candidates(compilation_info: str,
+                        max_candidates: int) -> List[str]:
+  """Generates variants of |compilation_info| with scaled tile sizes.
+
+  The first tiling level (distribution) and second tiling level (vector
+  parallel) of every non-zero dimension are scaled independently. Candidates
+  where an inner tile size does not evenly divide the outer one are dropped.
+  """
+  match = TILE_SIZES_RE.search(compilation_info)
+  if not match:
+    return []
+  tile_sizes = ast.literal_eval(match.group(1))
+  if len(tile_sizes) < 2:
+    return []
+
+  dims = [
+      i for i, size in enumerate(tile_sizes[0])
+      if size > 0 or (i < len(tile_sizes[1]) and tile_sizes[1][i] > 0)
+  ]
+  candidates = []
+  seen = {str(tile_sizes)}
+  for factors in itertools.product(SCALE_FACTORS, repeat=2 * len(dims)):
+    new_sizes = [list(level) for level in tile_sizes]
+    for i, dim in enumerate(dims):
+      new_sizes[0][dim] = scale_tile_size(tile_sizes[0][dim], factors[2 * i])
+      if dim < len(new_sizes[1]):
+        new_sizes[1][dim] = scale_tile_size(tile_sizes[1][dim],
+                                            factors[2 * i + 1])
+    if any(outer > 0 and inner > 0 and outer % inner != 0
+           for outer, inner in zip(new_sizes[0], new_sizes[1])):
+      continue
+    if str(new_sizes) in seen:
+      continue
+    seen.add(str(new_sizes))
+    sizes_str = "[" + ", ".join(
+        "[" + ", ".join(str(s) for s in level) + "]" for level in new_sizes) + "]"
+    candidates.append(compilation_info[:match.start(1)] + sizes_str +
+                      compilation_info[match.end(1):])
+    # Bound the sweep for high-rank ops (convolutions).
+    if len(candidates) >= 16 * max_candidates:
+      break
+
+  # Prefer candidates closest to the default configuration.
+  candidates.sort(key=lambda c: sum(
+      abs(a - b) for a, b in zip(
+          itertools.chain(*ast.literal_eval(TILE_SIZES_RE.search(c).group(1))),
+          itertools.chain(*tile_sizes))))
+  return candidates[:max_candidates]
+
+
+def tune_benchmark_file(args, source: pathlib.Path,
+                        work_dir: pathlib.Path) -> Dict[str, Tuple[str, float]]:
+  """Tunes all dispatches in |source|; returns key -> (config, speedup)."""
+  record_path = work_dir / "record.db"
+  record_path.unlink(missing_ok=True)
+  module_path = work_dir / "module.vmfb"
+  if not compile_module(
+      args, source, module_path,
+      [f"--iree-codegen-llvmcpu-tuning-db-record={record_path}"]):
+    return {}
+  defaults = read_database(record_path)
+  baseline_ns = benchmark_module(args, module_path)
+  if baseline_ns is None:
+    print("  failed to benchmark default configuration", file=sys.stderr)
+    return {}
+  print(f"  default: {baseline_ns / 1e3:.3f} us")
+
+  results = {}
+  for key, default_info in defaults.items():
+    print(f"  tuning {key}")
+    best_ns, best_info = baseline_ns, None
+    for candidate in generate_candidates(default_info, args.max_candidates):
+      db_path = work_dir / "candidate.db"
+      write_database(db_path, {key: candidate})
+      if not compile_module(args, source, module_path,
+                            [f"--iree-codegen-llvmcpu-tuning-db={db_path}"]):
+        continue
+      candidate_ns = benchmark_module(args, module_path)
+      if candidate_ns is not None and candidate_ns < best_ns:
+        best_ns, best_info = candidate_ns, candidate
+    speedup = baseline_ns / best_ns
+    if best_info and speedup >= args.min_speedup:
+      print(f"    {speedup:.2f}x: {best_info}")
+      results[key] = (best_info, speedup)
+  return results
+
+
+def main(args):
+  sources = sorted(args.benchmarks_dir.glob("*.mlir"))
+  if not sources:
+    raise ValueError(f"no benchmark files found in {args.benchmarks_dir}")
+
+  database = read_database(args.output)
+  with tempfile.TemporaryDirectory() as temp_dir:
+    for source in sources:
+      print(f"{source.name}:")
+      for key, (info, _) in tune_benchmark_file(
+          args, source, pathlib.Path(temp_dir)).items():
+        database[key] = info
+      # Write after each file so that partial results survive interruption.
+      write_database(args.output, database, header=[
+          "IREE CPU dispatch tuning database.",
+          "Generated by build_tools/scripts/tune_cpu_dispatches.py.",
+      ])
+  print(f"wrote {len(database)} entries to {args.output}")
+
+
+if __name__ == "__main__":
+  main(parse_arguments())
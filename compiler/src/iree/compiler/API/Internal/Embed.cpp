@@ -52,6 +52,7 @@
 #include "iree/compiler/Tools/init_passes.h"
 #include "iree/compiler/Tools/init_targets.h"
 #include "iree/compiler/Tools/version.h"
+#include "iree/compiler/Utils/OptionUtils.h"
 #include "iree/compiler/Utils/TracingUtils.h"
 #include "iree/compiler/embedding_api.h"
 #include "llvm/Support/Allocator.h"
@@ -936,6 +937,7 @@ void ireeCompilerSetupGlobalCL(int argc, const char **argv, const char *banner,
   }
 
   llvm::cl::ParseCommandLineOptions(argc, argv, banner);
+  mlir::iree_compiler::setGlobalCommandLineFlags(argc, argv);
 }
 
 void ireeCompilerGlobalInitialize() {
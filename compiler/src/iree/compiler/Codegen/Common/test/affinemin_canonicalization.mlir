@@ -60,3 +60,39 @@ func.func @scf_for_distributed(%A : memref<i64>, %id1 : index, %count1 : index,
 
   return
 }
+
+// Tests that loops over a dynamic workload rounded down to a multiple of the
+// tile size with affine.apply (as done when specializing dispatches for shape
+// buckets) need no partial tile. The same rounding with arith ops is opaque to
+// the divisibility analysis and keeps the affine.min.
+
+// CHECK-LABEL: func.func @workload_rounded_to_tile_size
+func.func @workload_rounded_to_tile_size(%A : memref<i64>, %workload : index,
+                                         %id : index, %count : index) {
+  %c16 = arith.constant 16 : index
+  %lb = affine.apply affine_map<()[s0] -> (s0 * 16)>()[%id]
+  %step = affine.apply affine_map<()[s0] -> (s0 * 16)>()[%count]
+
+  //  CHECK-DAG:   %[[C16:.*]] = arith.constant 16 : i64
+  //      CHECK:   scf.for
+  // CHECK-NEXT:     memref.store %[[C16]], %{{.*}}[] : memref<i64>
+  %ub = affine.apply affine_map<()[s0] -> ((s0 floordiv 16) * 16)>()[%workload]
+  scf.for %iv = %lb to %ub step %step {
+    %size = affine.min affine_map<(d0, d1) -> (16, d0 - d1)>(%ub, %iv)
+    %size_i64 = arith.index_cast %size : index to i64
+    memref.store %size_i64, %A[] : memref<i64>
+  }
+
+  //      CHECK:   arith.divui
+  //      CHECK:   arith.muli
+  //      CHECK:   scf.for
+  // CHECK-NEXT:     affine.min
+  %div = arith.divui %workload, %c16 : index
+  %arith_ub = arith.muli %div, %c16 : index
+  scf.for %iv = %lb to %arith_ub step %step {
+    %size = affine.min affine_map<(d0, d1) -> (16, d0 - d1)>(%arith_ub, %iv)
+    %size_i64 = arith.index_cast %size : index to i64
+    memref.store %size_i64, %A[] : memref<i64>
+  }
+  return
+}
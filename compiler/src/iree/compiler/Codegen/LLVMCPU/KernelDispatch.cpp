@@ -11,6 +11,7 @@
 #include "iree-dialects/Dialect/LinalgExt/IR/LinalgExtOps.h"
 #include "iree/compiler/Codegen/Common/UserConfig.h"
 #include "iree/compiler/Codegen/LLVMCPU/TargetMLTransformInfo.h"
+#include "iree/compiler/Codegen/LLVMCPU/TuningDatabase.h"
 #include "iree/compiler/Codegen/LLVMCPU/Utils.h"
 #include "iree/compiler/Codegen/TransformDialectStrategies/CPU/Common.h"
 #include "iree/compiler/Codegen/Transforms/Transforms.h"
@@ -2085,6 +2086,12 @@ static LogicalResult setTranslationInfoAndRootConfig(
       return failure();
     }
   } else {
+    // Tuned configurations take precedence over the default heuristics and are
+    // treated the same as user-provided ones.
+    if (IREE::Codegen::CompilationInfoAttr tunedInfo =
+            lookupTunedCompilationInfo(targetAttr, rootOperation)) {
+      return setUserConfig(entryPointFn, rootOperation, tunedInfo);
+    }
     auto targetMLTransInfo =
         TargetMLTransformInfo::getTargetMLTransformInfo(targetAttr);
     if (failed(setRootConfigImpl(entryPointFn, rootOperation,
@@ -2101,6 +2108,10 @@ static LogicalResult setTranslationInfoAndRootConfig(
     return failure();
   }
 
+  if (!isVMVXBackend(targetAttr)) {
+    recordTuningDatabaseEntry(targetAttr, entryPointFn, rootOperation);
+  }
+
   return success();
 }
 
@@ -0,0 +1,197 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Codegen/LLVMCPU/TuningDatabase.h"
+
+#include <memory>
+#include <mutex>
+
+#include "iree/compiler/Codegen/Utils/Utils.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SHA256.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/AsmParser/AsmParser.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+
+#define DEBUG_TYPE "iree-llvmcpu-tuning-database"
+
+namespace mlir {
+namespace iree_compiler {
+
+static llvm::cl::opt<std::string> clTuningDatabasePath(
+    "iree-codegen-llvmcpu-tuning-db",
+    llvm::cl::desc("path to a tuning database of compilation_info entries that "
+                   "override the default CPU dispatch configurations"),
+    llvm::cl::init(""));
+
+static llvm::cl::opt<std::string> clTuningDatabaseRecordPath(
+    "iree-codegen-llvmcpu-tuning-db-record",
+    llvm::cl::desc("path to a file the keys and selected configurations of all "
+                   "CPU dispatch root ops are appended to"),
+    llvm::cl::init(""));
+
+std::string getTuningKey(IREE::HAL::ExecutableTargetAttr targetAttr,
+                         Operation *rootOp) {
+  std::string key;
+  llvm::raw_string_ostream os(key);
+  auto triple = getConfigStringAttr(targetAttr, "target_triple");
+  auto cpu = getConfigStringAttr(targetAttr, "cpu");
+  auto cpuFeatures = getConfigStringAttr(targetAttr, "cpu_features");
+  auto nativeVectorSize =
+      getConfigIntegerAttr(targetAttr, "native_vector_size");
+  os << (triple ? triple->getValue() : "unknown") << "|"
+     << (cpu && !cpu->getValue().empty() ? cpu->getValue() : "generic") << "|"
+     << (cpuFeatures ? cpuFeatures->getValue() : "") << "|"
+     << (nativeVectorSize ? nativeVectorSize->getInt() : 0) << "|"
+     << rootOp->getName().getStringRef() << "|";
+  llvm::interleave(rootOp->getOperandTypes(), os, ",");
+  os << "->";
+  llvm::interleave(rootOp->getResultTypes(), os, ",");
+  if (auto genericOp = dyn_cast<linalg::GenericOp>(rootOp)) {
+    os << "|";
+    llvm::interleave(genericOp.getIndexingMapsArray(), os, ",");
+    os << "|";
+    llvm::interleave(genericOp.getIteratorTypesArray(), os, ",");
+  }
+  return os.str();
+}
+
+namespace {
+
+// A database loaded from a file. Entries are keyed by tuning key and kept in
+// textual form as attributes are owned by an MLIRContext and the database is
+// shared by all contexts in the process.
+struct TuningDatabase {
+  // Hex SHA256 hash of the file contents the entries were parsed from or
+  // "missing" if the file could not be read.
+  std::string hash;
+  llvm::StringMap<std::string> entries;
+};
+
+}  // namespace
+
+static TuningDatabase loadTuningDatabase(StringRef path) {
+  TuningDatabase database;
+  auto fileOrErr = llvm::MemoryBuffer::getFile(path, /*IsText=*/true);
+  if (!fileOrErr) {
+    llvm::errs() << "WARNING: failed to open tuning database `" << path
+                 << "`: " << fileOrErr.getError().message() << "\n";
+    database.hash = "missing";
+    return database;
+  }
+  StringRef contents = (*fileOrErr)->getBuffer();
+  database.hash = llvm::toHex(
+      llvm::SHA256::hash(llvm::arrayRefFromStringRef(contents)),
+      /*LowerCase=*/true);
+  SmallVector<StringRef> lines;
+  contents.split(lines, '\n', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+  for (auto [lineIndex, rawLine] : llvm::enumerate(lines)) {
+    StringRef line = rawLine.trim();
+    if (line.empty() || line.starts_with("//")) continue;
+    // "<key>" = <attribute>
+    StringRef key, value;
+    if (line.consume_front("\"")) {
+      std::tie(key, value) = line.split('"');
+      value = value.ltrim();
+    }
+    if (key.empty() || !value.consume_front("=")) {
+      llvm::errs() << "WARNING: ignoring malformed tuning database entry at `"
+                   << path << ":" << (lineIndex + 1) << "`\n";
+      continue;
+    }
+    database.entries[key] = value.trim().str();
+  }
+  LLVM_DEBUG(llvm::dbgs() << "loaded " << database.entries.size()
+                          << " tuning database entries from " << path << "\n");
+  return database;
+}
+
+// Returns the database loaded from `path`. Databases are cached by path so
+// that the file is read once no matter how many dispatches are configured and
+// so that lookups use the same contents that `getTuningDatabaseHash` reported
+// for the compiler session even if the file is rewritten meanwhile.
+static std::shared_ptr<const TuningDatabase> getTuningDatabase(
+    StringRef path) {
+  // Executables are configured in parallel so serialize access to the cache.
+  static std::mutex cacheMutex;
+  static llvm::StringMap<std::shared_ptr<const TuningDatabase>> cache;
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  auto &database = cache[path];
+  if (!database) {
+    database = std::make_shared<const TuningDatabase>(loadTuningDatabase(path));
+  }
+  return database;
+}
+
+std::string getTuningDatabaseHash() {
+  if (clTuningDatabasePath.empty()) return "";
+  return getTuningDatabase(clTuningDatabasePath)->hash;
+}
+
+IREE::Codegen::CompilationInfoAttr lookupTunedCompilationInfo(
+    IREE::HAL::ExecutableTargetAttr targetAttr, Operation *rootOp) {
+  if (clTuningDatabasePath.empty()) return {};
+  std::shared_ptr<const TuningDatabase> database =
+      getTuningDatabase(clTuningDatabasePath);
+  if (database->entries.empty()) return {};
+
+  std::string key = getTuningKey(targetAttr, rootOp);
+  auto it = database->entries.find(key);
+  if (it == database->entries.end()) {
+    LLVM_DEBUG(llvm::dbgs() << "tuning database miss: " << key << "\n");
+    return {};
+  }
+  LLVM_DEBUG(llvm::dbgs() << "tuning database hit: " << key << "\n");
+
+  auto compilationInfo = dyn_cast_or_null<IREE::Codegen::CompilationInfoAttr>(
+      parseAttribute(it->second, rootOp->getContext()));
+  if (!compilationInfo) {
+    rootOp->emitWarning() << "ignoring invalid tuning database entry for `"
+                          << key << "`";
+    return {};
+  }
+  return compilationInfo;
+}
+
+void recordTuningDatabaseEntry(IREE::HAL::ExecutableTargetAttr targetAttr,
+                               func::FuncOp entryPointFn, Operation *rootOp) {
+  if (clTuningDatabaseRecordPath.empty()) return;
+  auto loweringConfig = getLoweringConfig(rootOp);
+  auto translationInfo = getTranslationInfo(entryPointFn);
+  FailureOr<IREE::HAL::ExecutableExportOp> exportOp =
+      getEntryPoint(entryPointFn);
+  if (!loweringConfig || !translationInfo || failed(exportOp)) return;
+  auto compilationInfo = IREE::Codegen::CompilationInfoAttr::get(
+      rootOp->getContext(), loweringConfig, translationInfo,
+      getWorkgroupSize(*exportOp), getSubgroupSize(*exportOp));
+
+  std::string entry;
+  llvm::raw_string_ostream os(entry);
+  os << "\"" << getTuningKey(targetAttr, rootOp) << "\" = " << compilationInfo
+     << "\n";
+
+  // Executables are configured in parallel so serialize appends.
+  static std::mutex recordMutex;
+  std::lock_guard<std::mutex> lock(recordMutex);
+  std::error_code ec;
+  llvm::raw_fd_ostream file(clTuningDatabaseRecordPath, ec,
+                            llvm::sys::fs::OF_Append | llvm::sys::fs::OF_Text);
+  if (ec) {
+    rootOp->emitWarning() << "failed to open tuning database record file `"
+                          << clTuningDatabaseRecordPath
+                          << "`: " << ec.message();
+    return;
+  }
+  file << os.str();
+}
+
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -0,0 +1,62 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_COMPILER_CODEGEN_LLVMCPU_TUNINGDATABASE_H_
+#define IREE_COMPILER_CODEGEN_LLVMCPU_TUNINGDATABASE_H_
+
+#include <string>
+
+#include "iree/compiler/Codegen/Dialect/LoweringConfig.h"
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+
+namespace mlir {
+namespace iree_compiler {
+
+/// A tuning database maps root operations of dispatches to the
+/// `#iree_codegen.compilation_info` that should be used when compiling them
+/// for a particular target. Databases are text files with one entry per line:
+///
+///   "<key>" = #iree_codegen.compilation_info<...>
+///
+/// Empty lines and lines starting with `//` are ignored. When a key appears
+/// multiple times the last entry wins so that newly tuned entries can be
+/// appended to an existing database.
+///
+/// Databases are produced by `build_tools/scripts/tune_cpu_dispatches.py`,
+/// which uses `--iree-codegen-llvmcpu-tuning-db-record` to discover the keys
+/// and default configurations of the dispatches it tunes.
+
+/// Returns the key identifying `rootOp` compiled for `targetAttr`. The key is
+/// composed of the target triple, CPU, CPU features and native vector size,
+/// the operation name, the operand types and (for generic ops) the indexing
+/// maps and iterator types.
+std::string getTuningKey(IREE::HAL::ExecutableTargetAttr targetAttr,
+                         Operation *rootOp);
+
+/// Returns the tuned compilation info for `rootOp` from the database given by
+/// `--iree-codegen-llvmcpu-tuning-db`, if any.
+IREE::Codegen::CompilationInfoAttr lookupTunedCompilationInfo(
+    IREE::HAL::ExecutableTargetAttr targetAttr, Operation *rootOp);
+
+/// Returns a hex SHA256 hash of the contents of the database given by
+/// `--iree-codegen-llvmcpu-tuning-db`, or an empty string if no database is
+/// used. Changes to the database change the hash so that artifacts compiled
+/// with prior entries can be invalidated. Databases are loaded once per path
+/// and the hash always matches the entries used by
+/// `lookupTunedCompilationInfo`.
+std::string getTuningDatabaseHash();
+
+/// Appends the configuration selected for `rootOp` in `entryPointFn` to the
+/// file given by `--iree-codegen-llvmcpu-tuning-db-record`, if set. The output
+/// is itself a valid tuning database.
+void recordTuningDatabaseEntry(IREE::HAL::ExecutableTargetAttr targetAttr,
+                               func::FuncOp entryPointFn, Operation *rootOp);
+
+}  // namespace iree_compiler
+}  // namespace mlir
+
+#endif  // IREE_COMPILER_CODEGEN_LLVMCPU_TUNINGDATABASE_H_
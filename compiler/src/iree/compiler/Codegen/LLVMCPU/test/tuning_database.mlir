@@ -0,0 +1,60 @@
+// RUN: rm -f %t.record
+// RUN: iree-opt --pass-pipeline='builtin.module(hal.executable(hal.executable.variant(iree-llvmcpu-lower-executable-target{test-lowering-configuration=true})))' --iree-codegen-llvmcpu-tuning-db-record=%t.record %s | FileCheck %s --check-prefix=DEFAULT
+// RUN: FileCheck %s --check-prefix=RECORD --input-file=%t.record
+// RUN: sed -e 's/\[128, 64, 0\], \[8, 32, 0\]/[64, 32, 0], [4, 16, 0]/' %t.record > %t.db
+// RUN: iree-opt --pass-pipeline='builtin.module(hal.executable(hal.executable.variant(iree-llvmcpu-lower-executable-target{test-lowering-configuration=true})))' --iree-codegen-llvmcpu-tuning-db=%t.db %s | FileCheck %s --check-prefix=TUNED
+// RUN: sed -e 's/|generic||16|/|generic|+avx512f|16|/' %t.db > %t.features.db
+// RUN: iree-opt --pass-pipeline='builtin.module(hal.executable(hal.executable.variant(iree-llvmcpu-lower-executable-target{test-lowering-configuration=true})))' --iree-codegen-llvmcpu-tuning-db=%t.features.db %s | FileCheck %s --check-prefix=DEFAULT
+// RUN: sed -e 's/|generic||16|/|generic||32|/' %t.db > %t.vector.db
+// RUN: iree-opt --pass-pipeline='builtin.module(hal.executable(hal.executable.variant(iree-llvmcpu-lower-executable-target{test-lowering-configuration=true})))' --iree-codegen-llvmcpu-tuning-db=%t.vector.db %s | FileCheck %s --check-prefix=DEFAULT
+
+#pipeline_layout = #hal.pipeline.layout<push_constants = 0, sets = [
+  #hal.descriptor_set.layout<0, bindings = [
+    #hal.descriptor_set.binding<0, storage_buffer>,
+    #hal.descriptor_set.binding<1, storage_buffer>,
+    #hal.descriptor_set.binding<2, storage_buffer>
+  ]>
+]>
+hal.executable private @matmul_static  {
+  hal.executable.variant public @embedded_elf_x86_64, target = #hal.executable.target<
+    "llvm-cpu",
+    "embedded-elf-x86_64", {
+      data_layout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128",
+      target_triple = "x86_64-unknown-unknown-eabi-elf",
+      native_vector_size = 16 : index
+    }> {
+    hal.executable.export public @matmul_static layout(#pipeline_layout)
+    builtin.module {
+      func.func @matmul_static() {
+        %cst = arith.constant 0.0 : f32
+        %lhs_binding = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) : !flow.dispatch.tensor<readonly:tensor<384x512xf32>>
+        %rhs_binding = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) : !flow.dispatch.tensor<readonly:tensor<512x128xf32>>
+        %result_binding = hal.interface.binding.subspan set(0) binding(2) type(storage_buffer) : !flow.dispatch.tensor<writeonly:tensor<384x128xf32>>
+        %lhs = flow.dispatch.tensor.load %lhs_binding, offsets = [0, 0], sizes = [384, 512], strides = [1, 1]
+            : !flow.dispatch.tensor<readonly:tensor<384x512xf32>> -> tensor<384x512xf32>
+        %rhs = flow.dispatch.tensor.load %rhs_binding, offsets = [0, 0], sizes = [512, 128], strides = [1, 1]
+            : !flow.dispatch.tensor<readonly:tensor<512x128xf32>> -> tensor<512x128xf32>
+        %init = tensor.empty() : tensor<384x128xf32>
+        %fill = linalg.fill ins(%cst : f32) outs(%init : tensor<384x128xf32>) -> tensor<384x128xf32>
+        %gemm = linalg.matmul ins(%lhs, %rhs : tensor<384x512xf32>, tensor<512x128xf32>)
+            outs(%fill : tensor<384x128xf32>) -> tensor<384x128xf32>
+        flow.dispatch.tensor.store %gemm, %result_binding, offsets = [0, 0], sizes = [384, 128], strides = [1, 1]
+            : tensor<384x128xf32> -> !flow.dispatch.tensor<writeonly:tensor<384x128xf32>>
+        return
+      }
+
+//  DEFAULT-DAG: #[[CONFIG:.+]] = #iree_codegen.lowering_config<tile_sizes = {{\[}}[128, 64, 0], [8, 32, 0], [0, 0, 16]{{\]}}>
+//      DEFAULT: linalg.matmul
+// DEFAULT-SAME:     lowering_config = #[[CONFIG]]
+
+//      RECORD: "x86_64-unknown-unknown-eabi-elf|generic||16|linalg.matmul|tensor<384x512xf32>,tensor<512x128xf32>,tensor<384x128xf32>->tensor<384x128xf32>"
+// RECORD-SAME:   = #iree_codegen.compilation_info<
+// RECORD-SAME:     tile_sizes = {{\[}}[128, 64, 0], [8, 32, 0], [0, 0, 16]{{\]}}
+// RECORD-SAME:     CPUDoubleTilingPadExpert
+
+//  TUNED-DAG: #[[CONFIG:.+]] = #iree_codegen.lowering_config<tile_sizes = {{\[}}[64, 32, 0], [4, 16, 0], [0, 0, 16]{{\]}}>
+//  TUNED-DAG: #[[TRANSLATION:.+]] = #iree_codegen.translation_info<CPUDoubleTilingPadExpert>
+//      TUNED: hal.executable.export public @matmul_static
+// TUNED-SAME:     translation_info = #[[TRANSLATION]]
+//      TUNED: linalg.matmul
+// TUNED-SAME:     lowering_config = #[[CONFIG]]
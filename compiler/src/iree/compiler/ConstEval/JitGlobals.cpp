@@ -10,6 +10,7 @@
 #include "iree/compiler/Pipelines/Pipelines.h"
 #include "iree/compiler/Utils/PassUtils.h"
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
@@ -25,8 +26,20 @@ namespace mlir {
 namespace iree_compiler {
 namespace ConstEval {
 
+static llvm::cl::opt<std::string> clJitTargetBackend(
+    "iree-consteval-jit-target-backend",
+    llvm::cl::desc("Target backend used to JIT global initializers. "
+                   "'llvm-cpu' compiles for the host CPU independent of the "
+                   "--iree-llvmcpu-* target flags and falls back to 'vmvx' "
+                   "if the compiler was built without it."),
+    llvm::cl::init("llvm-cpu"));
+
 namespace {
 
+// Name of the registration of the llvm-cpu target backend that is configured
+// for the host CPU. See registerLLVMCPUTargetBackends.
+static const char kHostLLVMCPURegistrationName[] = "llvm-cpu-host";
+
 struct ProgramExtractor {
  public:
   ProgramExtractor(Operation *sourceModuleOp, Operation *targetModuleOp)
@@ -120,6 +133,7 @@ struct ProgramExtractor {
 // shared.
 // TODO: See if we can make them copyable?
 struct CompileOptions {
+  IREE::HAL::TargetBackendRegistry targetRegistry;
   BindingOptions bindingOptions;
   InputDialectOptions inputOptions;
   PreprocessingOptions preprocessingOptions;
@@ -135,7 +149,8 @@ struct JitGlobalsPass : public JitGlobalsBase<JitGlobalsPass> {
       : options(std::make_shared<CompileOptions>()),
         compilePipeline("builtin.module") {
     // Invoke IREE compilation flow.
-    options->executableOptions.targets.push_back("vmvx");
+    targetBackend = selectTargetBackend(options->targetRegistry);
+    options->executableOptions.targets.push_back(targetBackend);
     options->targetOptions.f32Extension = true;
     options->targetOptions.f64Extension = false;  // not yet implemented
 
@@ -146,15 +161,52 @@ struct JitGlobalsPass : public JitGlobalsBase<JitGlobalsPass> {
     options->highLevelOptimizationOptions.constEval = false;
 
     buildIREEVMTransformPassPipeline(
-        // TODO: If ever not using VMVX, plumb the real target registry
-        // through.
-        IREE::HAL::TargetBackendRegistry::getGlobal(), options->bindingOptions,
-        options->inputOptions, options->preprocessingOptions,
+        options->targetRegistry, options->bindingOptions, options->inputOptions,
+        options->preprocessingOptions,
         options->highLevelOptimizationOptions, options->schedulingOptions,
         options->executableOptions, options->targetOptions, options->hooks,
         compilePipeline);
   }
 
+  // Populates |targetRegistry| with the backend used to compile the JIT
+  // program and returns its name. The llvm-cpu backend flags describe the
+  // deployment target and not the compiler host so we substitute the
+  // registration that always targets the host CPU.
+  static std::string selectTargetBackend(
+      IREE::HAL::TargetBackendRegistry &targetRegistry) {
+    const auto &globalRegistry = IREE::HAL::TargetBackendRegistry::getGlobal();
+    std::shared_ptr<IREE::HAL::TargetBackend> backend;
+    StringRef backendName = clJitTargetBackend;
+    if (backendName == "llvm-cpu") {
+      backend = globalRegistry.getTargetBackend(kHostLLVMCPURegistrationName);
+    } else {
+      backend = globalRegistry.getTargetBackend(backendName);
+    }
+    if (!backend) {
+      LLVM_DEBUG(dbgs() << "JitGlobals: target backend '" << backendName
+                        << "' not available; falling back to vmvx\n");
+      backendName = "vmvx";
+      backend = globalRegistry.getTargetBackend(backendName);
+    }
+    IREE::HAL::TargetBackendList targetList;
+    targetList.add(backendName, [backend]() { return backend; });
+    targetRegistry.mergeFrom(targetList);
+    return backendName.str();
+  }
+
+  // Whether a global of the given |type| can be evaluated with the selected
+  // target backend.
+  bool isSupportedGlobalType(Type type) const {
+    // VMVX does not support f64 but LLVM CPU can produce f64 tensors.
+    if (auto tensorType = llvm::dyn_cast<RankedTensorType>(type)) {
+      if (targetBackend == "llvm-cpu" &&
+          llvm::isa<Float64Type>(tensorType.getElementType())) {
+        return true;
+      }
+    }
+    return CompiledBinary::isSupportedResultType(type);
+  }
+
   void getDependentDialects(DialectRegistry &registry) const override {
     compilePipeline.getDependentDialects(registry);
   }
@@ -190,7 +242,7 @@ struct JitGlobalsPass : public JitGlobalsBase<JitGlobalsPass> {
       // Only generate an accessor for types our runtime bridge knows how to
       // handle.
       Type type = globalOp.getType();
-      if (!CompiledBinary::isSupportedResultType(type)) {
+      if (!isSupportedGlobalType(type)) {
         LLVM_DEBUG(dbgs() << "JitGlobals: unsupported global type " << type);
         continue;
       }
@@ -223,20 +275,25 @@ struct JitGlobalsPass : public JitGlobalsBase<JitGlobalsPass> {
     // Kill the temporary program we constructed.
     innerModule.erase();
 
-    bool modified = false;
+    // Read back all of the evaluated globals. Conversion of the results into
+    // attributes happens concurrently as it dominates with large globals.
+    SmallVector<IREE::Util::GlobalOp> targetGlobals;
+    SmallVector<CompiledBinary::NullaryFunction> functions;
     for (auto &it : uninitializedGlobals) {
       StringAttr funcSymbol = it.first;
       StringAttr globalSymbol = it.second;
       auto targetGlobal = llvm::cast<IREE::Util::GlobalOp>(
           outerSymbolTable.lookup(globalSymbol));
-      Location loc = targetGlobal->getLoc();
-
-      Attribute value =
-          binary.invokeNullaryAsAttribute(loc, funcSymbol.strref());
-      if (!value) {
-        return signalPassFailure();
-      }
+      targetGlobals.push_back(targetGlobal);
+      functions.push_back({targetGlobal->getLoc(), funcSymbol.strref()});
+    }
+    SmallVector<Attribute> values;
+    if (failed(binary.invokeNullariesAsAttributes(functions, values))) {
+      return signalPassFailure();
+    }
 
+    bool modified = false;
+    for (auto [targetGlobal, value] : llvm::zip_equal(targetGlobals, values)) {
       modified = true;
       targetGlobal.setInitialValueAttr(cast<TypedAttr>(value));
     }
@@ -254,6 +311,7 @@ struct JitGlobalsPass : public JitGlobalsBase<JitGlobalsPass> {
   }
 
   std::shared_ptr<CompileOptions> options;
+  std::string targetBackend;
   OpPassManager compilePipeline;
 };
 
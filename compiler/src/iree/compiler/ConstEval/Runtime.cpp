@@ -7,9 +7,13 @@
 #include "iree/compiler/ConstEval/Runtime.h"
 
 #include "iree/compiler/Dialect/VM/Target/Bytecode/BytecodeModuleTarget.h"
-#include "iree/hal/drivers/local_task/registration/driver_module.h"
+#include "iree/hal/drivers/local_task/task_driver.h"
+#include "iree/hal/local/loaders/registration/init.h"
+#include "iree/task/executor.h"
+#include "iree/task/topology.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/Threading.h"
 
 namespace mlir {
 namespace iree_compiler {
@@ -81,6 +85,57 @@ static Attribute createAttributeFromRawData(Location loc,
   return {};
 }
 
+// Creates a local-task driver with a single executor spanning all physical
+// cores of the host. The runtime flags that usually configure the executor
+// topology are not parsed by the compiler and their defaults cap the number of
+// workers well below what is available on large machines.
+static iree_status_t createHostTaskDriver(iree_allocator_t hostAllocator,
+                                          iree_hal_driver_t** outDriver) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_physical_cores(
+      IREE_TASK_TOPOLOGY_NODE_ID_ANY, IREE_TASK_EXECUTOR_MAX_WORKER_COUNT,
+      &topology);
+  iree_task_executor_options_t executorOptions;
+  iree_task_executor_options_initialize(&executorOptions);
+  iree_task_executor_t* executor = nullptr;
+  iree_status_t status = iree_task_executor_create(
+      executorOptions, &topology, hostAllocator, &executor);
+  iree_task_topology_deinitialize(&topology);
+
+  // Create all executable loaders linked into the binary. This includes the
+  // embedded ELF loader used for llvm-cpu executables.
+  std::array<iree_hal_executable_loader_t*, 8> loaders = {nullptr};
+  iree_host_size_t loaderCount = 0;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_create_all_available_executable_loaders(
+        /*plugin_manager=*/nullptr, loaders.size(), &loaderCount,
+        loaders.data(), hostAllocator);
+  }
+
+  iree_hal_allocator_t* deviceAllocator = nullptr;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_allocator_create_heap(iree_make_cstring_view("local"),
+                                            hostAllocator, hostAllocator,
+                                            &deviceAllocator);
+  }
+
+  if (iree_status_is_ok(status)) {
+    iree_hal_task_device_params_t params;
+    iree_hal_task_device_params_initialize(&params);
+    status = iree_hal_task_driver_create(
+        iree_make_cstring_view("local-task"), &params, /*queue_count=*/1,
+        &executor, loaderCount, loaders.data(), deviceAllocator, hostAllocator,
+        outDriver);
+  }
+
+  iree_task_executor_release(executor);
+  for (iree_host_size_t i = 0; i < loaderCount; ++i) {
+    iree_hal_executable_loader_release(loaders[i]);
+  }
+  iree_hal_allocator_release(deviceAllocator);
+  return status;
+}
+
 }  // namespace
 
 CompiledBinary::CompiledBinary() = default;
@@ -156,10 +211,49 @@ Attribute CompiledBinary::invokeNullaryAsAttribute(Location loc,
   return result;
 }
 
+LogicalResult CompiledBinary::invokeNullariesAsAttributes(
+    ArrayRef<NullaryFunction> functions, SmallVectorImpl<Attribute>& results) {
+  results.clear();
+  if (functions.empty()) return success();
+
+  // Invocations share the VM context and must be serialized. Their results
+  // are retained so that they can be converted below.
+  SmallVector<iree::vm::ref<iree_vm_list_t>> outputLists(functions.size());
+  for (size_t i = 0; i < functions.size(); ++i) {
+    const NullaryFunction& function = functions[i];
+    if (failed(invokeNullary(
+            function.loc, function.name,
+            [&](iree_vm_list_t* outputs) -> LogicalResult {
+              if (iree_vm_list_size(outputs) != 1) {
+                return emitError(function.loc)
+                       << "expected 1 result for func " << function.name
+                       << " got " << iree_vm_list_size(outputs);
+              }
+              outputLists[i] = iree::vm::retain_ref(outputs);
+              return success();
+            }))) {
+      return failure();
+    }
+  }
+
+  // Converting a result copies its contents into the MLIRContext which for
+  // large tensors dominates the time spent evaluating globals.
+  results.resize(functions.size());
+  MLIRContext* context = functions.front().loc.getContext();
+  return failableParallelForEachN(
+      context, 0, functions.size(), [&](size_t i) -> LogicalResult {
+        iree_vm_variant_t variant = iree_vm_variant_empty();
+        IREE_CHECK_OK(
+            iree_vm_list_get_variant_assign(outputLists[i].get(), 0, &variant));
+        results[i] = convertVariantToAttribute(functions[i].loc, variant);
+        return success(results[i] != nullptr);
+      });
+}
+
 bool CompiledBinary::isSupportedResultType(Type type) {
   // TODO(laurenzo): Not currently supported. VMVX would need to support these
-  // and today it doesn't. We could use alternative backends (LLVM CPU/etc) if
-  // we wanted to handle f64, but f16 and bf16 often need special hardware.
+  // and today it doesn't. LLVM CPU can handle f64 (see JitGlobals) but f16 and
+  // bf16 often need special hardware.
   if (llvm::isa<Float16Type>(type) || llvm::isa<BFloat16Type>(type) ||
       llvm::isa<Float64Type>(type)) {
     return false;
@@ -263,14 +357,9 @@ Attribute CompiledBinary::convertVariantToAttribute(
 void CompiledBinary::initialize(void* data, size_t length) {
   Runtime& runtime = Runtime::getInstance();
 
-  // Create driver and device.
-  iree_hal_driver_t* driver = nullptr;
-  IREE_CHECK_OK(iree_hal_driver_registry_try_create(
-      runtime.registry, iree_make_cstring_view("local-task"),
-      iree_allocator_system(), &driver));
+  // Create device.
   IREE_CHECK_OK(iree_hal_driver_create_default_device(
-      driver, iree_allocator_system(), &device));
-  iree_hal_driver_release(driver);
+      runtime.driver, iree_allocator_system(), &device));
 
   // Create hal module.
   IREE_CHECK_OK(iree_hal_module_create(runtime.instance.get(), device.get(),
@@ -309,9 +398,7 @@ LogicalResult InMemoryCompiledBinary::translateFromModule(
 }
 
 Runtime::Runtime() {
-  IREE_CHECK_OK(
-      iree_hal_driver_registry_allocate(iree_allocator_system(), &registry));
-  IREE_CHECK_OK(iree_hal_local_task_driver_module_register(registry));
+  IREE_CHECK_OK(createHostTaskDriver(iree_allocator_system(), &driver));
   IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
                                         iree_allocator_system(), &instance));
   IREE_CHECK_OK(iree_hal_module_register_all_types(instance.get()));
@@ -319,7 +406,7 @@ Runtime::Runtime() {
 
 Runtime::~Runtime() {
   instance.reset();
-  iree_hal_driver_registry_free(registry);
+  iree_hal_driver_release(driver);
 }
 
 Runtime& Runtime::getInstance() {
@@ -26,6 +26,11 @@ namespace ConstEval {
 class CompiledBinary {
  public:
   using ResultsCallback = std::function<LogicalResult(iree_vm_list_t* outputs)>;
+  // A nullary function to invoke and the location used for reporting errors.
+  struct NullaryFunction {
+    Location loc;
+    StringRef name;
+  };
   virtual ~CompiledBinary();
 
   // Invokes a nullary function.
@@ -36,6 +41,12 @@ class CompiledBinary {
   // as an Attribute.
   Attribute invokeNullaryAsAttribute(Location loc, StringRef name);
 
+  // Invokes each nullary function in |functions| and returns their (presumed
+  // single) results as Attributes in |results|. Functions are invoked serially
+  // in order but their results are converted to Attributes in parallel.
+  LogicalResult invokeNullariesAsAttributes(
+      ArrayRef<NullaryFunction> functions, SmallVectorImpl<Attribute>& results);
+
   // Whether the given type is supported in *AsAttribute methods.
   static bool isSupportedResultType(Type type);
 
@@ -65,12 +76,13 @@ class InMemoryCompiledBinary : public CompiledBinary {
 };
 
 // Simple wrapper around IREE runtime library sufficient for loading and
-// executing simple programs.
+// executing simple programs. Programs execute on a local-task driver using all
+// physical cores of the host.
 class Runtime {
  public:
   static Runtime& getInstance();
 
-  iree_hal_driver_registry_t* registry = nullptr;
+  iree_hal_driver_t* driver = nullptr;
   iree::vm::ref<iree_vm_instance_t> instance;
 
  private:
@@ -0,0 +1,85 @@
+// RUN: iree-opt --split-input-file --iree-consteval-jit-globals --iree-consteval-jit-target-backend=llvm-cpu %s | FileCheck %s
+
+// CHECK-LABEL: @linalg_tensor_jit
+// CHECK: util.global private @{{.*}} = dense<4.000000e+04> : tensor<5x6xf32>
+#map0 = affine_map<(d0, d1) -> ()>
+#map1 = affine_map<(d0, d1) -> (d0, d1)>
+module @linalg_tensor_jit {
+  util.global private @hoisted : tensor<5x6xf32>
+  func.func @main() -> tensor<5x6xf32> {
+    %hoisted = util.global.load @hoisted : tensor<5x6xf32>
+    return %hoisted : tensor<5x6xf32>
+  }
+  // CHECK-NOT: util.initializer
+  util.initializer {
+    %cst = arith.constant dense<2.0e+02> : tensor<f32>
+    %0 = tensor.empty() : tensor<5x6xf32>
+    %1 = linalg.generic {indexing_maps = [#map0, #map1], iterator_types = ["parallel", "parallel"]} ins(%cst : tensor<f32>) outs(%0 : tensor<5x6xf32>) {
+    ^bb0(%arg0: f32, %arg1: f32):  // no predecessors
+      linalg.yield %arg0 : f32
+    } -> tensor<5x6xf32>
+    %2 = tensor.empty() : tensor<5x6xf32>
+    %3 = linalg.generic {indexing_maps = [#map1, #map1, #map1], iterator_types = ["parallel", "parallel"]} ins(%1, %1 : tensor<5x6xf32>, tensor<5x6xf32>) outs(%2 : tensor<5x6xf32>) {
+    ^bb0(%arg0: f32, %arg1: f32, %arg2: f32):  // no predecessors
+      %4 = arith.mulf %arg0, %arg1 : f32
+      linalg.yield %4 : f32
+    } -> tensor<5x6xf32>
+    util.global.store %3, @hoisted : tensor<5x6xf32>
+    util.initializer.return
+  }
+}
+
+// -----
+// CHECK-LABEL: @independent_initializers
+// CHECK-DAG: util.global private @hoisted_0 = dense<3.000000e+00> : tensor<4x8xf32>
+// CHECK-DAG: util.global private @hoisted_1 = dense<6> : tensor<8x4xi32>
+#map = affine_map<(d0, d1) -> (d0, d1)>
+module @independent_initializers {
+  util.global private @hoisted_0 : tensor<4x8xf32>
+  util.global private @hoisted_1 : tensor<8x4xi32>
+  func.func @main() -> (tensor<4x8xf32>, tensor<8x4xi32>) {
+    %hoisted_0 = util.global.load @hoisted_0 : tensor<4x8xf32>
+    %hoisted_1 = util.global.load @hoisted_1 : tensor<8x4xi32>
+    return %hoisted_0, %hoisted_1 : tensor<4x8xf32>, tensor<8x4xi32>
+  }
+  // CHECK-NOT: util.initializer
+  util.initializer {
+    %cst = arith.constant dense<1.5> : tensor<4x8xf32>
+    %0 = tensor.empty() : tensor<4x8xf32>
+    %1 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%cst : tensor<4x8xf32>) outs(%0 : tensor<4x8xf32>) {
+    ^bb0(%arg0: f32, %arg1: f32):
+      %2 = arith.addf %arg0, %arg0 : f32
+      linalg.yield %2 : f32
+    } -> tensor<4x8xf32>
+    util.global.store %1, @hoisted_0 : tensor<4x8xf32>
+    util.initializer.return
+  }
+  util.initializer {
+    %cst = arith.constant dense<3> : tensor<8x4xi32>
+    %0 = tensor.empty() : tensor<8x4xi32>
+    %1 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%cst : tensor<8x4xi32>) outs(%0 : tensor<8x4xi32>) {
+    ^bb0(%arg0: i32, %arg1: i32):
+      %2 = arith.addi %arg0, %arg0 : i32
+      linalg.yield %2 : i32
+    } -> tensor<8x4xi32>
+    util.global.store %1, @hoisted_1 : tensor<8x4xi32>
+    util.initializer.return
+  }
+}
+
+// -----
+// CHECK-LABEL: @eval_f64_tensor
+// CHECK: util.global private @{{.*}} = dense<[2.000000e+02, 3.200000e+03]> : tensor<2xf64>
+module @eval_f64_tensor {
+  util.global private @hoisted : tensor<2xf64>
+  func.func @main() -> tensor<2xf64> {
+    %hoisted = util.global.load @hoisted : tensor<2xf64>
+    return %hoisted : tensor<2xf64>
+  }
+  // CHECK-NOT: util.initializer
+  util.initializer {
+    %cst = arith.constant dense<[2.0e+2, 3.2e+3]> : tensor<2xf64>
+    util.global.store %cst, @hoisted : tensor<2xf64>
+    util.initializer.return
+  }
+}
@@ -32,6 +32,11 @@ namespace IREE {
 namespace Flow {
 class DispatchRegionOp;
 
+// Function attribute recording the number of dispatches removed by
+// iree-flow-fuse-horizontal-dispatch-regions.
+constexpr StringLiteral kHorizontallyFusedDispatchesAttrName =
+    "flow.horizontally_fused_dispatches";
+
 // Populates flow.dispatch.* canonicalization patterns.
 void populateFlowDispatchCanonicalizationPatterns(
     ::mlir::RewritePatternSet &results, ::mlir::MLIRContext *context);
@@ -0,0 +1,188 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===--- AnnotateDispatchRoofline.cpp -------------------------------------===//
+//
+// Annotates each dispatch function with its static arithmetic operation count
+// and the minimum number of bytes it moves. Backends record these in their
+// executable metadata so that tools can relate measured dispatch times to the
+// peak compute throughput and memory bandwidth of the machine.
+//
+//===----------------------------------------------------------------------===//
+
+#include <limits>
+#include <optional>
+
+#include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
+#include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/TypeUtilities.h"
+#include "mlir/Pass/Pass.h"
+
+#define DEBUG_TYPE "iree-flow-annotate-dispatch-roofline"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Flow {
+
+// Returns the number of arithmetic operations |op| performs per execution.
+// Only float and integer math on element values counts: constants,
+// conversions, comparisons, selects, and index computations are free and
+// fused multiply-adds count as two.
+static int64_t getArithmeticOpCount(Operation *op) {
+  if (!isa<arith::ArithDialect, math::MathDialect>(op->getDialect())) return 0;
+  if (isa<arith::ConstantOp, arith::CmpFOp, arith::CmpIOp, arith::SelectOp,
+          CastOpInterface>(op)) {
+    return 0;
+  }
+  if (op->getNumResults() != 1) return 0;
+  if (!getElementTypeOrSelf(op->getResult(0).getType()).isIntOrFloat()) {
+    return 0;
+  }
+  if (isa<math::FmaOp>(op)) return 2;
+  return 1;
+}
+
+// Returns |lhs| * |rhs| clamped to the int64_t range.
+static int64_t saturatingMultiply(int64_t lhs, int64_t rhs) {
+  int64_t result = 0;
+  if (llvm::MulOverflow(lhs, rhs, result)) {
+    return std::numeric_limits<int64_t>::max();
+  }
+  return result;
+}
+
+// Returns |lhs| + |rhs| clamped to the int64_t range.
+static int64_t saturatingAdd(int64_t lhs, int64_t rhs) {
+  int64_t result = 0;
+  if (llvm::AddOverflow(lhs, rhs, result)) {
+    return std::numeric_limits<int64_t>::max();
+  }
+  return result;
+}
+
+// Returns the number of arithmetic operations performed by |linalgOp| or
+// std::nullopt if its iteration space is not static. Counts too large to
+// represent saturate.
+static std::optional<int64_t> getFlopCount(linalg::LinalgOp linalgOp) {
+  int64_t iterationCount = 1;
+  for (int64_t range : linalgOp.getStaticLoopRanges()) {
+    if (ShapedType::isDynamic(range)) return std::nullopt;
+    iterationCount = saturatingMultiply(iterationCount, range);
+  }
+  int64_t opsPerIteration = 0;
+  for (Operation &op : linalgOp.getBlock()->without_terminator()) {
+    opsPerIteration += getArithmeticOpCount(&op);
+  }
+  return saturatingMultiply(iterationCount, opsPerIteration);
+}
+
+// Returns the size of |type| in bytes or std::nullopt if it is dynamic.
+static std::optional<int64_t> getStaticByteSize(RankedTensorType type) {
+  if (!type.hasStaticShape()) return std::nullopt;
+  return saturatingMultiply(
+      type.getNumElements(),
+      IREE::Util::getRoundedElementByteWidth(type.getElementType()));
+}
+
+// Annotates |funcOp| with an `iree.roofline` dictionary containing `flops`
+// and `bytes` entries for each value that could be statically determined.
+//
+// Example:
+//   func.func @matmul(...) attributes {
+//     iree.roofline = {bytes = 57344 : i64, flops = 524288 : i64}
+//   }
+static void annotateRoofline(mlir::func::FuncOp funcOp) {
+  std::optional<int64_t> flopCount = 0;
+  funcOp.walk([&](linalg::LinalgOp linalgOp) {
+    auto opFlopCount = getFlopCount(linalgOp);
+    if (!opFlopCount) {
+      flopCount = std::nullopt;
+      return WalkResult::interrupt();
+    }
+    *flopCount = saturatingAdd(*flopCount, *opFlopCount);
+    return WalkResult::advance();
+  });
+
+  // Every byte loaded from or stored to a binding must cross the memory
+  // hierarchy at least once; anything beyond that is reuse codegen did not
+  // capture.
+  std::optional<int64_t> byteCount = 0;
+  funcOp.walk([&](Operation *op) {
+    RankedTensorType tensorType;
+    if (auto loadOp = dyn_cast<Flow::DispatchTensorLoadOp>(op)) {
+      tensorType = loadOp.getResult().getType();
+    } else if (auto storeOp = dyn_cast<Flow::DispatchTensorStoreOp>(op)) {
+      tensorType = llvm::cast<RankedTensorType>(storeOp.getValue().getType());
+    } else {
+      return WalkResult::advance();
+    }
+    auto opByteCount = getStaticByteSize(tensorType);
+    if (!opByteCount) {
+      byteCount = std::nullopt;
+      return WalkResult::interrupt();
+    }
+    *byteCount = saturatingAdd(*byteCount, *opByteCount);
+    return WalkResult::advance();
+  });
+
+  LLVM_DEBUG(llvm::dbgs() << "@" << funcOp.getName() << ": flops="
+                          << flopCount.value_or(-1)
+                          << " bytes=" << byteCount.value_or(-1) << "\n");
+
+  Builder builder(funcOp.getContext());
+  SmallVector<NamedAttribute> rooflineAttrs;
+  if (byteCount && *byteCount > 0) {
+    rooflineAttrs.push_back(builder.getNamedAttr(
+        "bytes", builder.getI64IntegerAttr(*byteCount)));
+  }
+  if (flopCount && *flopCount > 0) {
+    rooflineAttrs.push_back(builder.getNamedAttr(
+        "flops", builder.getI64IntegerAttr(*flopCount)));
+  }
+  if (rooflineAttrs.empty()) return;
+  funcOp->setAttr("iree.roofline", builder.getDictionaryAttr(rooflineAttrs));
+}
+
+namespace {
+
+struct AnnotateDispatchRooflinePass
+    : public AnnotateDispatchRooflineBase<AnnotateDispatchRooflinePass> {
+  void runOnOperation() override {
+    for (auto executableOp :
+         getOperation().getOps<IREE::Flow::ExecutableOp>()) {
+      auto innerModuleOp = executableOp.getInnerModule();
+      if (!innerModuleOp) continue;
+      for (auto exportOp :
+           executableOp.getOps<IREE::Flow::ExecutableExportOp>()) {
+        auto funcOp = innerModuleOp.lookupSymbol<mlir::func::FuncOp>(
+            exportOp.getFunctionRef());
+        if (funcOp) annotateRoofline(funcOp);
+      }
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<OperationPass<mlir::ModuleOp>>
+createAnnotateDispatchRooflinePass() {
+  return std::make_unique<AnnotateDispatchRooflinePass>();
+}
+
+}  // namespace Flow
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -0,0 +1,255 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===--- DemoteActivationStorage.cpp --------------------------------------===//
+//
+// Stores large f32 tensors passed between dispatch regions as bf16 or f16.
+// Unlike iree-util-demote-f32-to-f16 the computation within each dispatch
+// remains in f32: the producing dispatch truncates the value before returning
+// it and each consuming dispatch extends it again before use. This halves the
+// memory traffic and transient storage of activations at the cost of precision
+// only at dispatch boundaries.
+//
+//===----------------------------------------------------------------------===//
+
+#include <cmath>
+#include <optional>
+
+#include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
+#include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "iree/compiler/Dialect/Util/Analysis/Attributes/Range.h"
+#include "iree/compiler/Dialect/Util/Analysis/DFX/Solver.h"
+#include "iree/compiler/Dialect/Util/Analysis/Explorer.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/Builders.h"
+
+#define DEBUG_TYPE "iree-flow-demote-activation-storage"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Flow {
+
+// Largest finite value representable in f16.
+static constexpr double kF16MaxValue = 65504.0;
+
+namespace {
+
+// An f32 result of a dispatch region used only by other dispatch regions.
+struct DemotionCandidate {
+  Flow::DispatchRegionOp producerOp;
+  OpResult result;
+  SmallVector<Flow::DispatchRegionOp> consumerOps;
+  // Element type |result| will be stored as.
+  Type storageType;
+
+  // Returns the value within the producer that is returned as |result|.
+  Value getReturnedValue() {
+    auto returnOp = cast<Flow::ReturnOp>(
+        producerOp.getBody().front().getTerminator());
+    return returnOp.getOperand(result.getResultNumber());
+  }
+};
+
+}  // namespace
+
+// Returns a lower bound of the storage size of |type| in bytes. Dynamic
+// dimensions are assumed to have extent 1.
+static int64_t getMinimumStorageSize(RankedTensorType type) {
+  int64_t elementCount = 1;
+  for (int64_t dim : type.getShape()) {
+    if (!ShapedType::isDynamic(dim)) elementCount *= dim;
+  }
+  return elementCount * llvm::divideCeil(type.getElementTypeBitWidth(), 8);
+}
+
+// Returns the dispatch regions in the same block as |producerOp| containing
+// all uses of |value| or std::nullopt if any use is outside of a dispatch
+// region.
+static std::optional<SmallVector<Flow::DispatchRegionOp>> getConsumerRegions(
+    Flow::DispatchRegionOp producerOp, Value value) {
+  llvm::SetVector<Flow::DispatchRegionOp> consumerOps;
+  for (auto &use : value.getUses()) {
+    auto consumerOp =
+        use.getOwner()->getParentOfType<Flow::DispatchRegionOp>();
+    if (!consumerOp || consumerOp->getBlock() != producerOp->getBlock()) {
+      return std::nullopt;
+    }
+    consumerOps.insert(consumerOp);
+  }
+  if (consumerOps.empty()) return std::nullopt;
+  return consumerOps.takeVector();
+}
+
+// Creates an elementwise linalg.generic converting |source| to a tensor of the
+// same shape with |elementType|.
+static Value convertElementType(OpBuilder &builder, Location loc, Value source,
+                                Type elementType) {
+  auto sourceType = llvm::cast<RankedTensorType>(source.getType());
+  auto targetType = RankedTensorType::get(sourceType.getShape(), elementType,
+                                          sourceType.getEncoding());
+  Value init = builder.create<tensor::EmptyOp>(
+      loc, tensor::getMixedSizes(builder, loc, source), elementType,
+      sourceType.getEncoding());
+  AffineMap identityMap = builder.getMultiDimIdentityMap(sourceType.getRank());
+  SmallVector<utils::IteratorType> iteratorTypes(sourceType.getRank(),
+                                                 utils::IteratorType::parallel);
+  auto genericOp = builder.create<linalg::GenericOp>(
+      loc, targetType, source, init,
+      ArrayRef<AffineMap>{identityMap, identityMap}, iteratorTypes,
+      [&](OpBuilder &b, Location nestedLoc, ValueRange args) {
+        Value result;
+        if (elementType.getIntOrFloatBitWidth() <
+            sourceType.getElementTypeBitWidth()) {
+          result = b.create<arith::TruncFOp>(nestedLoc, elementType, args[0]);
+        } else {
+          result = b.create<arith::ExtFOp>(nestedLoc, elementType, args[0]);
+        }
+        b.create<linalg::YieldOp>(nestedLoc, result);
+      });
+  return genericOp.getResult(0);
+}
+
+// Returns true if all values in |stats| are known to be representable in f16.
+static bool fitsInF16(IREE::Util::FloatRangeStats stats) {
+  return !stats.isInvalid() && stats.isFinite() &&
+         std::abs(stats.minValue) <= kF16MaxValue &&
+         std::abs(stats.maxValue) <= kF16MaxValue;
+}
+
+// Changes the result of |candidate| to be stored as its storage type and
+// extends it back to its original type at the start of each consumer.
+static void demoteResultStorage(DemotionCandidate &candidate) {
+  Type storageType = candidate.storageType;
+  OpResult result = candidate.result;
+  auto originalType = llvm::cast<RankedTensorType>(result.getType());
+  Location loc = result.getLoc();
+
+  // Truncate in the producer right before the value is returned.
+  auto returnOp = cast<Flow::ReturnOp>(
+      candidate.producerOp.getBody().front().getTerminator());
+  OpOperand &returnedOperand = returnOp->getOpOperand(result.getResultNumber());
+  OpBuilder builder(returnOp);
+  returnedOperand.set(
+      convertElementType(builder, loc, returnedOperand.get(), storageType));
+  result.setType(RankedTensorType::get(originalType.getShape(), storageType,
+                                       originalType.getEncoding()));
+
+  // Extend in each consumer before any use. All uses are gathered first so
+  // that the conversions themselves still use the stored value.
+  for (auto consumerOp : candidate.consumerOps) {
+    SmallVector<OpOperand *> uses;
+    for (auto &use : result.getUses()) {
+      if (consumerOp->isProperAncestor(use.getOwner())) uses.push_back(&use);
+    }
+    builder.setInsertionPointToStart(&consumerOp.getBody().front());
+    Value extendedValue = convertElementType(
+        builder, loc, result, originalType.getElementType());
+    for (auto *use : uses) use->set(extendedValue);
+  }
+}
+
+namespace {
+
+struct DemoteActivationStoragePass
+    : public DemoteActivationStorageBase<DemoteActivationStoragePass> {
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<arith::ArithDialect, linalg::LinalgDialect,
+                    tensor::TensorDialect>();
+  }
+  DemoteActivationStoragePass(std::string storageType, int64_t minSizeBytes,
+                              bool useRangeAnalysis) {
+    this->storageType = storageType;
+    this->minSizeBytes = minSizeBytes;
+    this->useRangeAnalysis = useRangeAnalysis;
+  }
+  DemoteActivationStoragePass(const DemoteActivationStoragePass &pass)
+      : DemoteActivationStoragePass(pass.storageType, pass.minSizeBytes,
+                                    pass.useRangeAnalysis) {}
+
+  void runOnOperation() override {
+    auto funcOp = getOperation();
+    MLIRContext *context = &getContext();
+
+    Type requestedType;
+    if (storageType == "bf16") {
+      requestedType = FloatType::getBF16(context);
+    } else if (storageType == "f16") {
+      requestedType = FloatType::getF16(context);
+    } else {
+      funcOp.emitError() << "unsupported activation storage type '"
+                         << storageType << "'; expected bf16 or f16";
+      return signalPassFailure();
+    }
+
+    // Gather all f32 tensors crossing dispatch boundaries that are large
+    // enough to be worth converting.
+    SmallVector<DemotionCandidate> candidates;
+    funcOp.walk([&](Flow::DispatchRegionOp producerOp) {
+      if (!llvm::hasSingleElement(producerOp.getBody())) return;
+      for (auto result : producerOp->getResults()) {
+        auto tensorType = llvm::dyn_cast<RankedTensorType>(result.getType());
+        if (!tensorType || !tensorType.getElementType().isF32()) continue;
+        if (getMinimumStorageSize(tensorType) < minSizeBytes) continue;
+        auto consumerOps = getConsumerRegions(producerOp, result);
+        if (!consumerOps) continue;
+        candidates.push_back(DemotionCandidate{producerOp, result,
+                                               *consumerOps, requestedType});
+      }
+    });
+    if (candidates.empty()) return;
+
+    // f16 has a much narrower range than bf16 and f32. When requested the
+    // range analysis is used to only store values in f16 when they are known
+    // to fit and otherwise bf16 is used.
+    if (useRangeAnalysis && requestedType.isF16()) {
+      Explorer explorer(funcOp.getOperation(), TraversalAction::SHALLOW);
+      llvm::BumpPtrAllocator allocator;
+      DFX::Solver solver(explorer, allocator);
+      for (auto &candidate : candidates) {
+        solver.getOrCreateElementFor<IREE::Util::FloatRangeValueElement>(
+            Position::forValue(candidate.getReturnedValue()));
+      }
+      if (failed(solver.run())) return signalPassFailure();
+      for (auto &candidate : candidates) {
+        auto *element =
+            solver.lookupElementFor<IREE::Util::FloatRangeValueElement>(
+                Position::forValue(candidate.getReturnedValue()));
+        if (!element || !fitsInF16(element->getKnown())) {
+          candidate.storageType = FloatType::getBF16(context);
+        }
+      }
+    }
+
+    for (auto &candidate : candidates) {
+      LLVM_DEBUG(llvm::dbgs() << "storing result "
+                              << candidate.result.getResultNumber() << " of "
+                              << candidate.producerOp.getLoc() << " as "
+                              << candidate.storageType << "\n");
+      demoteResultStorage(candidate);
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<InterfacePass<mlir::FunctionOpInterface>>
+createDemoteActivationStoragePass(std::string storageType,
+                                  int64_t minSizeBytes,
+                                  bool useRangeAnalysis) {
+  return std::make_unique<DemoteActivationStoragePass>(
+      storageType, minSizeBytes, useRangeAnalysis);
+}
+
+}  // namespace Flow
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
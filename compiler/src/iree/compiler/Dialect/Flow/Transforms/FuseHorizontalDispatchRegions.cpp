@@ -0,0 +1,299 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===--- FuseHorizontalDispatchRegions.cpp --------------------------------===//
+//
+// Fuses small independent flow.dispatch.region ops that each contain a single
+// linalg.generic with identical static iteration spaces into one dispatch
+// region containing a multi-result linalg.generic. The fused dispatch uses the
+// same workgroup grid each of the original dispatches would have used and
+// saves the per-dispatch issue and barrier overhead of the others.
+//
+//===----------------------------------------------------------------------===//
+
+#include <optional>
+
+#include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
+#include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/PatternMatch.h"
+
+#define DEBUG_TYPE "iree-flow-fuse-horizontal-dispatch-regions"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Flow {
+namespace {
+
+// A dispatch region containing one statically-shaped linalg.generic (along
+// with any empty tensors and constants it uses) and returning exactly its
+// results.
+struct FusionCandidate {
+  Flow::DispatchRegionOp regionOp;
+  linalg::GenericOp genericOp;
+};
+
+// A set of independent dispatch regions with identical iteration spaces that
+// will be fused into one.
+struct FusionGroup {
+  SmallVector<int64_t> loopRanges;
+  SmallVector<utils::IteratorType> iteratorTypes;
+  SmallVector<FusionCandidate> members;
+};
+
+}  // namespace
+
+static std::optional<FusionCandidate> matchFusionCandidate(
+    Flow::DispatchRegionOp regionOp, int64_t maxIterationSpaceSize) {
+  // Regions with explicit workloads or dynamic results would need their
+  // workgroup count calculations merged; leave them alone.
+  if (!regionOp.getWorkload().empty() ||
+      !regionOp.getWorkgroupCount().empty() ||
+      !regionOp.getResultDims().empty()) {
+    return std::nullopt;
+  }
+  if (!llvm::hasSingleElement(regionOp.getBody())) return std::nullopt;
+  Block &body = regionOp.getBody().front();
+
+  linalg::GenericOp genericOp;
+  for (auto &op : body.without_terminator()) {
+    if (auto candidateOp = dyn_cast<linalg::GenericOp>(op)) {
+      if (genericOp) return std::nullopt;
+      genericOp = candidateOp;
+    } else if (!isa<tensor::EmptyOp>(op) &&
+               !op.hasTrait<OpTrait::ConstantLike>()) {
+      return std::nullopt;
+    }
+  }
+  if (!genericOp || !genericOp.hasTensorSemantics()) return std::nullopt;
+  auto returnOp = cast<Flow::ReturnOp>(body.getTerminator());
+  if (!llvm::equal(returnOp.getOperands(), genericOp->getResults())) {
+    return std::nullopt;
+  }
+
+  // Large dispatches have enough parallelism on their own to amortize their
+  // overhead and fusing them only serializes their tails.
+  int64_t iterationSpaceSize = 1;
+  for (int64_t range : genericOp.getStaticLoopRanges()) {
+    if (ShapedType::isDynamic(range)) return std::nullopt;
+    iterationSpaceSize *= range;
+    if (iterationSpaceSize > maxIterationSpaceSize) return std::nullopt;
+  }
+
+  return FusionCandidate{regionOp, genericOp};
+}
+
+// Returns true if all users of the results of |regionOp| are after
+// |insertionOp|. Fusing |regionOp| into a dispatch at |insertionOp| is then
+// guaranteed not to break dominance and |insertionOp| is independent of it.
+static bool areAllUsesAfter(Flow::DispatchRegionOp regionOp,
+                            Operation *insertionOp) {
+  Block *block = insertionOp->getBlock();
+  for (auto *user : regionOp->getUsers()) {
+    auto *ancestorOp = block->findAncestorOpInBlock(*user);
+    if (!ancestorOp || !insertionOp->isBeforeInBlock(ancestorOp)) return false;
+  }
+  return true;
+}
+
+// Replaces all members of |group| with a single dispatch region at the
+// position of the last member. The region contains a multi-result generic with
+// the inputs and outputs of all members concatenated.
+static void fuseGroup(RewriterBase &rewriter, FusionGroup &group) {
+  auto lastRegionOp = group.members.back().regionOp;
+  Location loc = rewriter.getFusedLoc(llvm::map_to_vector(
+      group.members, [](FusionCandidate &member) -> Location {
+        return member.regionOp.getLoc();
+      }));
+
+  SmallVector<Type> resultTypes;
+  for (auto &member : group.members) {
+    llvm::append_range(resultTypes, member.regionOp.getResultTypes());
+  }
+
+  OpBuilder::InsertionGuard guard(rewriter);
+  rewriter.setInsertionPoint(lastRegionOp);
+  auto fusedRegionOp = rewriter.create<Flow::DispatchRegionOp>(
+      loc, resultTypes, /*dynamicDims=*/ValueRange{},
+      /*workload=*/ValueRange{});
+  Block &fusedBody = fusedRegionOp.getBody().emplaceBlock();
+  rewriter.setInsertionPointToStart(&fusedBody);
+
+  // Clone the empty tensors and constants of all members and gather the
+  // operands of the fused generic. All inputs come before all outputs.
+  IRMapping mapping;
+  SmallVector<Value> inputs;
+  SmallVector<Value> outputs;
+  SmallVector<AffineMap> inputMaps;
+  SmallVector<AffineMap> outputMaps;
+  SmallVector<BlockArgument> inputArgs;
+  SmallVector<BlockArgument> outputArgs;
+  for (auto &member : group.members) {
+    auto genericOp = member.genericOp;
+    for (auto &op : member.regionOp.getBody().front().without_terminator()) {
+      if (&op != genericOp.getOperation()) rewriter.clone(op, mapping);
+    }
+    for (OpOperand *operand : genericOp.getDpsInputOperands()) {
+      inputs.push_back(mapping.lookupOrDefault(operand->get()));
+      inputMaps.push_back(genericOp.getMatchingIndexingMap(operand));
+      inputArgs.push_back(genericOp.getMatchingBlockArgument(operand));
+    }
+    for (OpOperand *operand : genericOp.getDpsInitOperands()) {
+      outputs.push_back(mapping.lookupOrDefault(operand->get()));
+      outputMaps.push_back(genericOp.getMatchingIndexingMap(operand));
+      outputArgs.push_back(genericOp.getMatchingBlockArgument(operand));
+    }
+  }
+  SmallVector<AffineMap> indexingMaps = llvm::to_vector(inputMaps);
+  llvm::append_range(indexingMaps, outputMaps);
+  auto fusedGenericOp = rewriter.create<linalg::GenericOp>(
+      loc, resultTypes, inputs, outputs, indexingMaps, group.iteratorTypes);
+
+  // Build the fused body by cloning each member body in order.
+  SmallVector<BlockArgument> oldArgs = llvm::to_vector(inputArgs);
+  llvm::append_range(oldArgs, outputArgs);
+  SmallVector<Type> argTypes;
+  SmallVector<Location> argLocs;
+  for (auto arg : oldArgs) {
+    argTypes.push_back(arg.getType());
+    argLocs.push_back(arg.getLoc());
+  }
+  Block *fusedBlock = rewriter.createBlock(&fusedGenericOp.getRegion(),
+                                           fusedGenericOp.getRegion().end(),
+                                           argTypes, argLocs);
+  for (auto [oldArg, newArg] :
+       llvm::zip_equal(oldArgs, fusedBlock->getArguments())) {
+    mapping.map(oldArg, newArg);
+  }
+  SmallVector<Value> yieldedValues;
+  for (auto &member : group.members) {
+    Block *memberBlock = member.genericOp.getBody();
+    for (auto &op : memberBlock->without_terminator()) {
+      rewriter.clone(op, mapping);
+    }
+    auto yieldOp = cast<linalg::YieldOp>(memberBlock->getTerminator());
+    for (auto value : yieldOp.getValues()) {
+      yieldedValues.push_back(mapping.lookupOrDefault(value));
+    }
+  }
+  rewriter.create<linalg::YieldOp>(loc, yieldedValues);
+
+  rewriter.setInsertionPointAfter(fusedGenericOp);
+  rewriter.create<Flow::ReturnOp>(loc, fusedGenericOp->getResults());
+
+  unsigned resultOffset = 0;
+  for (auto &member : group.members) {
+    unsigned resultCount = member.regionOp->getNumResults();
+    rewriter.replaceOp(member.regionOp, fusedRegionOp->getResults().slice(
+                                            resultOffset, resultCount));
+    resultOffset += resultCount;
+  }
+}
+
+namespace {
+
+struct FuseHorizontalDispatchRegionsPass
+    : public FuseHorizontalDispatchRegionsBase<
+          FuseHorizontalDispatchRegionsPass> {
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<linalg::LinalgDialect, tensor::TensorDialect>();
+  }
+  FuseHorizontalDispatchRegionsPass(unsigned maxFusedDispatches,
+                                    int64_t maxIterationSpaceSize) {
+    this->maxFusedDispatches = maxFusedDispatches;
+    this->maxIterationSpaceSize = maxIterationSpaceSize;
+  }
+  FuseHorizontalDispatchRegionsPass(
+      const FuseHorizontalDispatchRegionsPass &pass)
+      : FuseHorizontalDispatchRegionsPass(pass.maxFusedDispatches,
+                                          pass.maxIterationSpaceSize) {}
+
+  void runOnOperation() override {
+    auto funcOp = getOperation();
+    if (maxFusedDispatches < 2) return;
+
+    SmallVector<Block *> blocks;
+    funcOp->walk([&](Block *block) { blocks.push_back(block); });
+
+    IRRewriter rewriter(&getContext());
+    int64_t removedDispatchCount = 0;
+    for (auto *block : blocks) {
+      // Greedily assign each candidate to the first compatible group it is
+      // independent of. Groups are fused after all have been formed; moving
+      // each group to its last member preserves the dependencies checked
+      // against the original order.
+      SmallVector<FusionGroup> groups;
+      for (auto regionOp : block->getOps<Flow::DispatchRegionOp>()) {
+        auto candidate = matchFusionCandidate(regionOp, maxIterationSpaceSize);
+        if (!candidate) continue;
+        auto loopRanges = candidate->genericOp.getStaticLoopRanges();
+        auto iteratorTypes = candidate->genericOp.getIteratorTypesArray();
+        FusionGroup *targetGroup = nullptr;
+        for (auto &group : groups) {
+          if (group.members.size() >= maxFusedDispatches) continue;
+          if (group.loopRanges != loopRanges ||
+              group.iteratorTypes != iteratorTypes) {
+            continue;
+          }
+          if (llvm::all_of(group.members, [&](FusionCandidate &member) {
+                return areAllUsesAfter(member.regionOp, regionOp);
+              })) {
+            targetGroup = &group;
+            break;
+          }
+        }
+        if (!targetGroup) {
+          targetGroup = &groups.emplace_back();
+          targetGroup->loopRanges = loopRanges;
+          targetGroup->iteratorTypes = iteratorTypes;
+        }
+        targetGroup->members.push_back(*candidate);
+      }
+
+      for (auto &group : groups) {
+        if (group.members.size() < 2) continue;
+        LLVM_DEBUG(llvm::dbgs() << "fusing " << group.members.size()
+                                << " dispatch regions at "
+                                << group.members.back().regionOp.getLoc()
+                                << "\n");
+        fuseGroup(rewriter, group);
+        removedDispatchCount += group.members.size() - 1;
+      }
+    }
+    if (removedDispatchCount == 0) return;
+
+    // Record how many dispatches were removed so that later statistics can
+    // report it; the attribute is purely informational.
+    auto countAttrName =
+        rewriter.getStringAttr(kHorizontallyFusedDispatchesAttrName);
+    if (auto countAttr = funcOp->getAttrOfType<IntegerAttr>(countAttrName)) {
+      removedDispatchCount += countAttr.getInt();
+    }
+    funcOp->setAttr(countAttrName,
+                    rewriter.getI64IntegerAttr(removedDispatchCount));
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<InterfacePass<mlir::FunctionOpInterface>>
+createFuseHorizontalDispatchRegionsPass(unsigned maxFusedDispatches,
+                                        int64_t maxIterationSpaceSize) {
+  return std::make_unique<FuseHorizontalDispatchRegionsPass>(
+      maxFusedDispatches, maxIterationSpaceSize);
+}
+
+}  // namespace Flow
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
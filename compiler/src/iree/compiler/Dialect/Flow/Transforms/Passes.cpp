@@ -104,6 +104,56 @@ static llvm::cl::opt<bool> clDispatchGenerateWorkloadRegion(
     "iree-flow-dispatch-generate-workload-region",
     llvm::cl::desc("Generate the workload region."), llvm::cl::init(true));
 
+static llvm::cl::opt<bool> clEnableHorizontalFusion(
+    "iree-flow-enable-horizontal-fusion",
+    llvm::cl::desc("Fuse small independent dispatch regions with identical "
+                   "iteration spaces into a single dispatch."),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<unsigned> clHorizontalFusionMaxFusedDispatches(
+    "iree-flow-horizontal-fusion-max-fused-dispatches",
+    llvm::cl::desc("Maximum number of dispatch regions fused horizontally into "
+                   "a single dispatch."),
+    llvm::cl::init(8));
+
+static llvm::cl::opt<int64_t> clHorizontalFusionMaxIterationSpaceSize(
+    "iree-flow-horizontal-fusion-max-iteration-space-size",
+    llvm::cl::desc("Maximum iteration space size of dispatch regions "
+                   "considered for horizontal fusion."),
+    llvm::cl::init(65536));
+
+static llvm::cl::list<int64_t> clDispatchShapeBucketDivisors(
+    "iree-flow-dispatch-shape-bucket-divisors",
+    llvm::cl::desc("Comma-separated workload divisors (such as 16,64,128) for "
+                   "which specialized variants of dynamically shaped "
+                   "dispatches are created and selected at runtime. Divisors "
+                   "are used as given and are not derived from profiles."),
+    llvm::cl::CommaSeparated);
+
+static llvm::cl::opt<bool> clAnnotateDispatchRoofline(
+    "iree-flow-annotate-dispatch-roofline",
+    llvm::cl::desc("Records static FLOP and byte counts of each dispatch in "
+                   "the executable metadata for runtime roofline reporting."),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<std::string> clActivationStorageType(
+    "iree-flow-activation-storage-type",
+    llvm::cl::desc("Stores large f32 tensors passed between dispatches as the "
+                   "given type (bf16 or f16) while computing in f32."),
+    llvm::cl::init(""));
+
+static llvm::cl::opt<int64_t> clActivationStorageMinSize(
+    "iree-flow-activation-storage-min-size",
+    llvm::cl::desc("Minimum static size in bytes of tensors stored with "
+                   "--iree-flow-activation-storage-type."),
+    llvm::cl::init(1048576));
+
+static llvm::cl::opt<bool> clActivationStorageUseRangeAnalysis(
+    "iree-flow-activation-storage-use-range-analysis",
+    llvm::cl::desc("Falls back to bf16 for tensors not known to fit in f16 "
+                   "when using f16 activation storage."),
+    llvm::cl::init(false));
+
 static llvm::cl::opt<bool> clEnableDataTiling(
     "iree-flow-enable-data-tiling", llvm::cl::desc("Enable data tiling path."),
     llvm::cl::init(false));
@@ -281,8 +331,23 @@ void buildFlowTransformPassPipeline(OpPassManager &passManager,
             clEnableFusePaddingIntoLinalgConsumerOps,
             clEnableFusePaddingIntoLinalgProducerOps});
       })
+      // Fuse small independent dispatch regions to reduce dispatch overhead.
+      .addPredicatedPass(clEnableHorizontalFusion,
+                         [&]() {
+                           return createFuseHorizontalDispatchRegionsPass(
+                               clHorizontalFusionMaxFusedDispatches,
+                               clHorizontalFusionMaxIterationSpaceSize);
+                         })
       // Collapse dimensions of linalg Ops.
       .addPass(createCollapseDimensionsPass)
+      // Store activations crossing dispatch boundaries in reduced precision.
+      .addPredicatedPass(!clActivationStorageType.empty(),
+                         [&]() {
+                           return createDemoteActivationStoragePass(
+                               clActivationStorageType,
+                               clActivationStorageMinSize,
+                               clActivationStorageUseRangeAnalysis);
+                         })
       // Clone all producers into the dispatch region to perpare for being
       // isolated from above. This enables running additional transformations
       // afterwards that would need the full dispatch content but don't want to
@@ -338,6 +403,19 @@ void buildFlowTransformPassPipeline(OpPassManager &passManager,
   // an argument if two executables differ only in that one dimension).
   passManager.addPass(IREE::Flow::createDeduplicateExecutablesPass());
 
+  // Multi-version dispatches with dynamic workloads for the requested shape
+  // buckets. This happens after deduplication so that each unique executable
+  // is only specialized once.
+  if (!clDispatchShapeBucketDivisors.empty()) {
+    passManager.addPass(IREE::Flow::createSpecializeDispatchShapeBucketsPass(
+        clDispatchShapeBucketDivisors));
+  }
+
+  // Annotate each dispatch with its static cost for roofline reporting.
+  if (clAnnotateDispatchRoofline) {
+    passManager.addPass(IREE::Flow::createAnnotateDispatchRooflinePass());
+  }
+
   // Create one function per exported program entry point that can be used with
   // iree-benchmark-module to benchmark each function individually. Whether
   // a model supports execution like this (handles zero/null args, has state
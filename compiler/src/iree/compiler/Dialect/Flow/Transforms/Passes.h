@@ -153,10 +153,26 @@ struct FormDispatchRegionsOptions {
 std::unique_ptr<InterfacePass<mlir::FunctionOpInterface>>
 createFormDispatchRegionsPass(FormDispatchRegionsOptions options = {});
 
+// Pass to fuse small independent dispatch regions whose roots have identical
+// static iteration spaces into a single dispatch region. At most
+// |maxFusedDispatches| regions with no more than |maxIterationSpaceSize|
+// iterations each are fused together.
+std::unique_ptr<InterfacePass<mlir::FunctionOpInterface>>
+createFuseHorizontalDispatchRegionsPass(unsigned maxFusedDispatches = 8,
+                                        int64_t maxIterationSpaceSize = 65536);
+
 // Pass to collapse dimensions of Linalg Ops on tensor ops.
 std::unique_ptr<InterfacePass<mlir::FunctionOpInterface>>
 createCollapseDimensionsPass();
 
+// Stores f32 tensors of at least |minSizeBytes| passed between dispatch regions
+// as |storageType| (bf16 or f16) while keeping computation in f32. With
+// |useRangeAnalysis| f16 is only used for values known to fit.
+std::unique_ptr<InterfacePass<mlir::FunctionOpInterface>>
+createDemoteActivationStoragePass(std::string storageType = "bf16",
+                                  int64_t minSizeBytes = 1048576,
+                                  bool useRangeAnalysis = false);
+
 // Pass to clone into dispatch regions producers of values used in the dispatch
 // regions but defined in the above. This prepares the dispatch regions for
 // converting to dispatch workgroups with explicit captures.
@@ -218,6 +234,17 @@ createOutlineLargeConstantsPass();
 std::unique_ptr<OperationPass<mlir::ModuleOp>>
 createDeduplicateExecutablesPass();
 
+// Creates variants of dispatches with dynamic workloads that assume the
+// workload is divisible by each of |divisors| and selects between them at each
+// dispatch site at runtime.
+std::unique_ptr<OperationPass<mlir::ModuleOp>>
+createSpecializeDispatchShapeBucketsPass(ArrayRef<int64_t> divisors = {});
+
+// Annotates dispatch functions with the number of arithmetic operations they
+// perform and the minimum number of bytes they move when statically known.
+std::unique_ptr<OperationPass<mlir::ModuleOp>>
+createAnnotateDispatchRooflinePass();
+
 // Create a pass to raise sequence of ops to higher level linalg.ext
 // representation.
 std::unique_ptr<Pass> createRaiseSpecialOps();
@@ -0,0 +1,292 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===--- SpecializeDispatchShapeBuckets.cpp -------------------------------===//
+//
+// Multi-versions dispatches with dynamic workloads for a set of shape buckets.
+// Each bucket is a divisor: the variant for divisor N may assume that every
+// workload value is a multiple of N and codegen can then tile without peeling
+// or masking. Dispatch sites select the most specialized variant at runtime
+// and fall back to the original fully dynamic dispatch.
+//
+//===----------------------------------------------------------------------===//
+
+#include <functional>
+
+#include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
+#include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/Pass.h"
+
+#define DEBUG_TYPE "iree-flow-specialize-dispatch-shape-buckets"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Flow {
+
+namespace {
+
+// A specialized variant of an export that assumes all workload values are
+// divisible by |divisor|.
+struct BucketVariant {
+  int64_t divisor;
+  SymbolRefAttr entryPoint;
+};
+
+}  // namespace
+
+// Rounds each workload value in |funcOp| down to a multiple of |divisor|.
+// This is an identity when the dispatch site has verified the divisibility but
+// makes it visible to codegen, which can then drop partial tile handling. The
+// rounding is expressed as an affine.apply so that the divisibility analysis
+// used when canonicalizing tiled loops (which composes affine maps) can prove
+// that loop bounds derived from the workload are multiples of the tile size.
+//
+// Example:
+//   %0 = flow.dispatch.workload.ordinal %arg0, 0 : index
+// ->
+//   %0 = flow.dispatch.workload.ordinal %arg0, 0 : index
+//   %1 = affine.apply affine_map<()[s0] -> ((s0 floordiv 16) * 16)>()[%0]
+static void assumeDivisibleWorkload(mlir::func::FuncOp funcOp,
+                                    int64_t divisor) {
+  MLIRContext *context = funcOp.getContext();
+  AffineExpr s0 = getAffineSymbolExpr(0, context);
+  AffineMap roundingMap =
+      AffineMap::get(0, 1, s0.floorDiv(divisor) * divisor, context);
+  funcOp.walk([&](Flow::DispatchWorkloadOrdinalOp ordinalOp) {
+    OpBuilder builder(ordinalOp);
+    builder.setInsertionPointAfter(ordinalOp);
+    auto roundedOp = builder.create<affine::AffineApplyOp>(
+        ordinalOp.getLoc(), roundingMap, ValueRange{ordinalOp.getResult()});
+    ordinalOp.getResult().replaceAllUsesExcept(roundedOp.getResult(),
+                                               roundedOp);
+  });
+}
+
+// Creates one variant of |exportOp| per divisor in |divisors| and returns them
+// ordered from most to least specialized.
+static SmallVector<BucketVariant> createBucketVariants(
+    Flow::ExecutableOp executableOp, Flow::ExecutableExportOp exportOp,
+    ArrayRef<int64_t> divisors) {
+  auto innerModuleOp = executableOp.getInnerModule();
+  if (!innerModuleOp) return {};
+  auto funcOp =
+      innerModuleOp.lookupSymbol<mlir::func::FuncOp>(exportOp.getFunctionRef());
+  if (!funcOp) return {};
+
+  // Only dispatches with workloads captured from their operands can be
+  // specialized; everything else has nothing to bucket on.
+  bool hasWorkloadOrdinals = false;
+  funcOp.walk([&](Flow::DispatchWorkloadOrdinalOp ordinalOp) {
+    hasWorkloadOrdinals = true;
+    return WalkResult::interrupt();
+  });
+  if (!hasWorkloadOrdinals) return {};
+
+  SymbolTable executableSymbolTable(executableOp);
+  SymbolTable innerSymbolTable(innerModuleOp);
+  SmallVector<BucketVariant> variants;
+  Operation *lastFuncOp = funcOp;
+  Operation *lastExportOp = exportOp;
+  for (int64_t divisor : divisors) {
+    std::string suffix = "_div" + std::to_string(divisor);
+
+    auto variantFuncOp = cast<mlir::func::FuncOp>(funcOp->clone());
+    variantFuncOp.setName(
+        StringAttr::get(funcOp.getContext(), funcOp.getName() + suffix));
+    innerSymbolTable.insert(variantFuncOp,
+                            std::next(Block::iterator(lastFuncOp)));
+    lastFuncOp = variantFuncOp;
+    assumeDivisibleWorkload(variantFuncOp, divisor);
+
+    auto variantExportOp = cast<Flow::ExecutableExportOp>(exportOp->clone());
+    variantExportOp.setSymName((exportOp.getSymName() + suffix).str());
+    variantExportOp.setFunctionRefAttr(
+        FlatSymbolRefAttr::get(variantFuncOp.getNameAttr()));
+    executableSymbolTable.insert(variantExportOp,
+                                 std::next(Block::iterator(lastExportOp)));
+    lastExportOp = variantExportOp;
+
+    variants.push_back(BucketVariant{
+        divisor,
+        SymbolRefAttr::get(executableOp.getSymNameAttr(),
+                           {FlatSymbolRefAttr::get(variantExportOp)}),
+    });
+  }
+  return variants;
+}
+
+// Replaces |dispatchOp| with a runtime selection between the |variants| and the
+// original dispatch. Workload values known to be constant are checked at
+// compile time and variants they don't fit are skipped.
+//
+// Example with one variant:
+//   %0 = flow.dispatch @ex::@entry[%w](%arg0, %w)
+// ->
+//   %rem = arith.remui %w, %c16 : index
+//   %cond = arith.cmpi eq, %rem, %c0 : index
+//   cf.cond_br %cond, ^bb1, ^bb2
+// ^bb1:
+//   %1 = flow.dispatch @ex::@entry_div16[%w](%arg0, %w)
+//   cf.br ^bb3(%1)
+// ^bb2:
+//   %2 = flow.dispatch @ex::@entry[%w](%arg0, %w)
+//   cf.br ^bb3(%2)
+// ^bb3(%0):
+static void selectBucketVariant(Flow::DispatchOp dispatchOp,
+                                ArrayRef<BucketVariant> variants) {
+  // Dispatches nested in structured control flow can't be split into blocks.
+  Block *block = dispatchOp->getBlock();
+  if (!isa<CallableOpInterface>(block->getParentOp())) return;
+
+  Location loc = dispatchOp.getLoc();
+  OpBuilder builder(dispatchOp);
+  SmallVector<std::pair<const BucketVariant *, Value>> candidates;
+  for (auto &variant : variants) {
+    auto isDivisible = [&](Value value) {
+      APInt constantValue;
+      return !matchPattern(value, m_ConstantInt(&constantValue)) ||
+             constantValue.getZExtValue() % variant.divisor == 0;
+    };
+    if (!llvm::all_of(dispatchOp.getWorkload(), isDivisible)) continue;
+
+    Value condition;
+    for (auto workloadValue : dispatchOp.getWorkload()) {
+      if (matchPattern(workloadValue, m_Constant())) continue;
+      Value divisorValue =
+          builder.create<arith::ConstantIndexOp>(loc, variant.divisor);
+      Value zero = builder.create<arith::ConstantIndexOp>(loc, 0);
+      Value remainder =
+          builder.create<arith::RemUIOp>(loc, workloadValue, divisorValue);
+      Value isZero = builder.create<arith::CmpIOp>(
+          loc, arith::CmpIPredicate::eq, remainder, zero);
+      if (condition) {
+        condition = builder.create<arith::AndIOp>(loc, condition, isZero);
+      } else {
+        condition = isZero;
+      }
+    }
+    candidates.push_back(std::make_pair(&variant, condition));
+  }
+  if (candidates.empty()) return;
+
+  // Split the block around the dispatch such that it ends up alone in the
+  // fallback block and all of its uses in the merge block.
+  Block *mergeBlock = block->splitBlock(std::next(dispatchOp->getIterator()));
+  for (auto result : dispatchOp.getResults()) {
+    result.replaceAllUsesWith(mergeBlock->addArgument(result.getType(), loc));
+  }
+  Block *fallbackBlock = block->splitBlock(dispatchOp->getIterator());
+  builder.setInsertionPointToEnd(fallbackBlock);
+  builder.create<cf::BranchOp>(loc, mergeBlock, dispatchOp.getResults());
+
+  // Chain the checks from the least specialized variant up such that the most
+  // specialized variant is checked first in the original block.
+  Block *nextBlock = fallbackBlock;
+  for (auto [index, candidate] : llvm::enumerate(llvm::reverse(candidates))) {
+    auto [variant, condition] = candidate;
+    Block *variantBlock = builder.createBlock(fallbackBlock);
+    auto variantOp = cast<Flow::DispatchOp>(builder.clone(*dispatchOp));
+    variantOp.setEntryPointAttr(variant->entryPoint);
+    builder.create<cf::BranchOp>(loc, mergeBlock, variantOp.getResults());
+
+    bool isFirstCheck = index == candidates.size() - 1;
+    Block *checkBlock =
+        isFirstCheck ? block : builder.createBlock(variantBlock);
+    builder.setInsertionPointToEnd(checkBlock);
+    builder.create<cf::CondBranchOp>(loc, condition, variantBlock, nextBlock);
+    nextBlock = checkBlock;
+  }
+}
+
+namespace {
+
+class SpecializeDispatchShapeBucketsPass
+    : public SpecializeDispatchShapeBucketsBase<
+          SpecializeDispatchShapeBucketsPass> {
+ public:
+  SpecializeDispatchShapeBucketsPass() = default;
+  SpecializeDispatchShapeBucketsPass(ArrayRef<int64_t> divisors) {
+    this->divisors = divisors;
+  }
+  SpecializeDispatchShapeBucketsPass(
+      const SpecializeDispatchShapeBucketsPass &pass)
+      : SpecializeDispatchShapeBucketsPass(llvm::to_vector(pass.divisors)) {}
+
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<affine::AffineDialect, arith::ArithDialect,
+                    cf::ControlFlowDialect>();
+  }
+
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+
+    // Most specialized (largest) divisors first; 1 is the original dispatch.
+    SmallVector<int64_t> sortedDivisors;
+    for (int64_t divisor : divisors) {
+      if (divisor > 1) sortedDivisors.push_back(divisor);
+    }
+    llvm::sort(sortedDivisors, std::greater<int64_t>());
+    sortedDivisors.erase(
+        std::unique(sortedDivisors.begin(), sortedDivisors.end()),
+        sortedDivisors.end());
+    if (sortedDivisors.empty()) return;
+
+    // Find all dispatches with dynamic workloads and bucket by their target.
+    SymbolTable symbolTable(moduleOp);
+    llvm::MapVector<Operation *, SmallVector<Flow::DispatchOp>>
+        exportDispatchOps;
+    moduleOp.walk([&](Flow::DispatchOp dispatchOp) {
+      if (llvm::all_of(dispatchOp.getWorkload(), [](Value value) {
+            return matchPattern(value, m_Constant());
+          })) {
+        return;
+      }
+      auto *exportOp = symbolTable.lookupNearestSymbolFrom(
+          dispatchOp, dispatchOp.getEntryPoint());
+      if (exportOp) exportDispatchOps[exportOp].push_back(dispatchOp);
+    });
+
+    for (auto &[op, dispatchOps] : exportDispatchOps) {
+      auto exportOp = cast<Flow::ExecutableExportOp>(op);
+      auto executableOp = exportOp->getParentOfType<Flow::ExecutableOp>();
+      auto variants =
+          createBucketVariants(executableOp, exportOp, sortedDivisors);
+      if (variants.empty()) continue;
+      LLVM_DEBUG(llvm::dbgs()
+                 << "specialized @" << executableOp.getSymName()
+                 << "::@" << exportOp.getSymName() << " for "
+                 << variants.size() << " shape buckets used by "
+                 << dispatchOps.size() << " dispatches\n");
+      for (auto dispatchOp : dispatchOps) {
+        selectBucketVariant(dispatchOp, variants);
+      }
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<OperationPass<mlir::ModuleOp>>
+createSpecializeDispatchShapeBucketsPass(ArrayRef<int64_t> divisors) {
+  return std::make_unique<SpecializeDispatchShapeBucketsPass>(divisors);
+}
+
+}  // namespace Flow
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -14,6 +14,8 @@
 #include "iree-dialects/Dialect/LinalgExt/Transforms/Transforms.h"
 #include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
 #include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "llvm/ADT/bit.h"
+#include "llvm/Support/MathExtras.h"
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Linalg/Transforms/Transforms.h"
@@ -29,11 +31,67 @@ static llvm::cl::opt<int64_t> splitReductionRatio(
     "iree-flow-split-matmul-reduction", llvm::cl::desc("split ratio"),
     llvm::cl::init(1));
 
+static llvm::cl::opt<int64_t> splitMatmulReductionWorkers(
+    "iree-flow-split-matmul-reduction-workers",
+    llvm::cl::desc(
+        "split the reduction of matmuls whose parallel dimensions are too "
+        "small to occupy this many workers; 0 to disable. The estimate "
+        "models llvm-cpu distribution so this should be set to the value of "
+        "iree-codegen-llvm-number-of-threads and only when compiling for "
+        "CPU targets"),
+    llvm::cl::init(0));
+
+static llvm::cl::opt<int64_t> splitMatmulReductionMinSize(
+    "iree-flow-split-matmul-reduction-min-size",
+    llvm::cl::desc("minimum size of each split of a matmul reduction when "
+                   "split based on the worker count; values below 1 are "
+                   "treated as 1"),
+    llvm::cl::init(256));
+
 static llvm::cl::list<int64_t> topkSplitReductionRatio(
     "iree-flow-topk-split-reduction",
     llvm::cl::desc("comma separated list of split ratios"),
     llvm::cl::CommaSeparated);
 
+// Largest tile size the CPU backend distributes a parallel dimension with.
+static constexpr int64_t kMaxDistributionTileSize = 64;
+
+/// Returns an estimate of the number of workgroups a parallel dimension with
+/// |size| iterations is distributed across. This mirrors the default CPU
+/// distribution which uses power of two tiles no larger than half the
+/// dimension or kMaxDistributionTileSize.
+static int64_t estimateDistributedTileCount(int64_t size) {
+  int64_t tileSize = std::max<int64_t>(
+      llvm::bit_floor<uint64_t>(std::min(size / 2, kMaxDistributionTileSize)),
+      1);
+  return llvm::divideCeil(size, tileSize);
+}
+
+/// Returns the ratio the reduction dimension of |matmulOp| should be split by
+/// so that the resulting parallel iterations can occupy |workerCount| workers.
+/// Skinny matmuls (like those of single token decoding) have too little
+/// parallel work along M and N but often a large K. Each split must have at
+/// least |minSplitSize| iterations (and always at least 1) so that the partial
+/// results do not dominate. Returns 1 if the op should not be split.
+static int64_t getWorkerSplitRatio(linalg::MatmulOp matmulOp,
+                                   int64_t workerCount, int64_t minSplitSize) {
+  SmallVector<int64_t> loopRanges = matmulOp.getStaticLoopRanges();
+  if (llvm::any_of(loopRanges, ShapedType::isDynamic)) return 1;
+  int64_t m = loopRanges[0], n = loopRanges[1], k = loopRanges[2];
+  if (m <= 0 || n <= 0 || k <= 0) return 1;
+  minSplitSize = std::max<int64_t>(minSplitSize, 1);
+  int64_t parallelTileCount =
+      estimateDistributedTileCount(m) * estimateDistributedTileCount(n);
+  int64_t ratio = 1;
+  // Each split has at least one iteration so the ratio never exceeds k.
+  while (parallelTileCount * ratio < workerCount) {
+    int64_t nextRatio = ratio * 2;
+    if (k % nextRatio != 0 || k / nextRatio < minSplitSize) break;
+    ratio = nextRatio;
+  }
+  return ratio;
+}
+
 namespace {
 /// Pattern to wrap splitReduction transformation. This also propagates
 /// attributes to allow compilation info attribute to not be lost.
@@ -83,6 +141,7 @@ struct SplitReductionPass : public SplitReductionBase<SplitReductionPass> {
 
   void runOnOperation() override {
     if (splitReductionRatio.getValue() <= 1 &&
+        splitMatmulReductionWorkers.getValue() <= 1 &&
         topkSplitReductionRatio.empty()) {
       return;
     }
@@ -93,8 +152,14 @@ struct SplitReductionPass : public SplitReductionBase<SplitReductionPass> {
         [&](linalg::LinalgOp op) -> linalg::SplitReductionOptions {
           // For matmul make the new parallel dimension first so that it looks
           // like a batch_matmul and can follow the same codegen.
-          if (isa<linalg::MatmulOp>(op))
-            return {int64_t(splitReductionRatio), 0, /*innerParallel=*/false};
+          if (auto matmulOp = dyn_cast<linalg::MatmulOp>(op.getOperation())) {
+            int64_t ratio = splitReductionRatio;
+            if (ratio <= 1 && splitMatmulReductionWorkers > 1) {
+              ratio = getWorkerSplitRatio(matmulOp, splitMatmulReductionWorkers,
+                                          splitMatmulReductionMinSize);
+            }
+            return {ratio, 0, /*innerParallel=*/false};
+          }
           // Currently disable spliting reduction for non-matmul op. This will
           // get enabled after once tests are ready.
           return {int64_t(0), 0, /*innerParallel=*/false};
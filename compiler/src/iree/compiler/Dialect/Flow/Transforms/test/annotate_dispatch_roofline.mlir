@@ -0,0 +1,124 @@
+// RUN: iree-opt --split-input-file --iree-flow-annotate-dispatch-roofline-pass %s | FileCheck %s
+
+flow.executable private @ex {
+  flow.executable.export public @matmul
+  builtin.module {
+    // CHECK: func.func @matmul
+    // CHECK-SAME: iree.roofline = {bytes = 57344 : i64, flops = 524288 : i64}
+    func.func @matmul(%lhs_binding: !flow.dispatch.tensor<readonly:tensor<64x128xf32>>, %rhs_binding: !flow.dispatch.tensor<readonly:tensor<128x32xf32>>, %result_binding: !flow.dispatch.tensor<writeonly:tensor<64x32xf32>>) {
+      %cst = arith.constant 0.000000e+00 : f32
+      %lhs = flow.dispatch.tensor.load %lhs_binding, offsets = [0, 0], sizes = [64, 128], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<64x128xf32>> -> tensor<64x128xf32>
+      %rhs = flow.dispatch.tensor.load %rhs_binding, offsets = [0, 0], sizes = [128, 32], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<128x32xf32>> -> tensor<128x32xf32>
+      %empty = tensor.empty() : tensor<64x32xf32>
+      %fill = linalg.fill ins(%cst : f32) outs(%empty : tensor<64x32xf32>) -> tensor<64x32xf32>
+      %result = linalg.matmul ins(%lhs, %rhs : tensor<64x128xf32>, tensor<128x32xf32>) outs(%fill : tensor<64x32xf32>) -> tensor<64x32xf32>
+      flow.dispatch.tensor.store %result, %result_binding, offsets = [0, 0], sizes = [64, 32], strides = [1, 1] : tensor<64x32xf32> -> !flow.dispatch.tensor<writeonly:tensor<64x32xf32>>
+      return
+    }
+  }
+}
+
+// -----
+
+// Conversions are free and fused multiply-adds count as two operations.
+
+#map = affine_map<(d0) -> (d0)>
+flow.executable private @ex {
+  flow.executable.export public @fma
+  builtin.module {
+    // CHECK: func.func @fma
+    // CHECK-SAME: iree.roofline = {bytes = 512 : i64, flops = 256 : i64}
+    func.func @fma(%binding: !flow.dispatch.tensor<readwrite:tensor<128xf16>>) {
+      %value = flow.dispatch.tensor.load %binding, offsets = [0], sizes = [128], strides = [1] : !flow.dispatch.tensor<readwrite:tensor<128xf16>> -> tensor<128xf16>
+      %result = linalg.generic {indexing_maps = [#map], iterator_types = ["parallel"]} outs(%value : tensor<128xf16>) {
+      ^bb0(%out: f16):
+        %ext = arith.extf %out : f16 to f32
+        %fma = math.fma %ext, %ext, %ext : f32
+        %trunc = arith.truncf %fma : f32 to f16
+        linalg.yield %trunc : f16
+      } -> tensor<128xf16>
+      flow.dispatch.tensor.store %result, %binding, offsets = [0], sizes = [128], strides = [1] : tensor<128xf16> -> !flow.dispatch.tensor<readwrite:tensor<128xf16>>
+      return
+    }
+  }
+}
+
+// -----
+
+// Comparisons, selects, and index computations are not arithmetic on element
+// values and are free.
+
+#map = affine_map<(d0) -> (d0)>
+flow.executable private @ex {
+  flow.executable.export public @select
+  builtin.module {
+    // CHECK: func.func @select
+    // CHECK-SAME: iree.roofline = {bytes = 1024 : i64, flops = 128 : i64}
+    func.func @select(%input_binding: !flow.dispatch.tensor<readonly:tensor<128xf32>>, %result_binding: !flow.dispatch.tensor<writeonly:tensor<128xf32>>) {
+      %input = flow.dispatch.tensor.load %input_binding, offsets = [0], sizes = [128], strides = [1] : !flow.dispatch.tensor<readonly:tensor<128xf32>> -> tensor<128xf32>
+      %empty = tensor.empty() : tensor<128xf32>
+      %result = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel"]} ins(%input : tensor<128xf32>) outs(%empty : tensor<128xf32>) {
+      ^bb0(%in: f32, %out: f32):
+        %c1 = arith.constant 1 : index
+        %index = linalg.index 0 : index
+        %next = arith.addi %index, %c1 : index
+        %next_i32 = arith.index_cast %next : index to i32
+        %next_f32 = arith.sitofp %next_i32 : i32 to f32
+        %cmp = arith.cmpf ogt, %in, %next_f32 : f32
+        %select = arith.select %cmp, %in, %next_f32 : f32
+        %add = arith.addf %select, %in : f32
+        linalg.yield %add : f32
+      } -> tensor<128xf32>
+      flow.dispatch.tensor.store %result, %result_binding, offsets = [0], sizes = [128], strides = [1] : tensor<128xf32> -> !flow.dispatch.tensor<writeonly:tensor<128xf32>>
+      return
+    }
+  }
+}
+
+// -----
+
+// Counts too large to represent saturate instead of wrapping.
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+flow.executable private @ex {
+  flow.executable.export public @saturate
+  builtin.module {
+    // CHECK: func.func @saturate
+    // CHECK-SAME: iree.roofline = {bytes = 9223372036854775807 : i64, flops = 9223372036854775807 : i64}
+    func.func @saturate(%binding: !flow.dispatch.tensor<readwrite:tensor<2147483648x2147483648xi8>>) {
+      %value = flow.dispatch.tensor.load %binding, offsets = [0, 0], sizes = [2147483648, 2147483648], strides = [1, 1] : !flow.dispatch.tensor<readwrite:tensor<2147483648x2147483648xi8>> -> tensor<2147483648x2147483648xi8>
+      %result = linalg.generic {indexing_maps = [#map], iterator_types = ["parallel", "parallel"]} outs(%value : tensor<2147483648x2147483648xi8>) {
+      ^bb0(%out: i8):
+        %add = arith.addi %out, %out : i8
+        %mul = arith.muli %add, %add : i8
+        linalg.yield %mul : i8
+      } -> tensor<2147483648x2147483648xi8>
+      flow.dispatch.tensor.store %result, %binding, offsets = [0, 0], sizes = [2147483648, 2147483648], strides = [1, 1] : tensor<2147483648x2147483648xi8> -> !flow.dispatch.tensor<readwrite:tensor<2147483648x2147483648xi8>>
+      return
+    }
+  }
+}
+
+// -----
+
+// Nothing is recorded when the costs depend on dynamic shapes.
+
+flow.executable private @ex {
+  flow.executable.export public @dynamic
+  builtin.module {
+    // CHECK: func.func @dynamic
+    // CHECK-NOT: iree.roofline
+    func.func @dynamic(%binding: !flow.dispatch.tensor<readwrite:tensor<?xf32>>, %dim_arg: index) {
+      %dim = flow.dispatch.workload.ordinal %dim_arg, 0 : index
+      %tied = flow.dispatch.tie_shape %binding : !flow.dispatch.tensor<readwrite:tensor<?xf32>>{%dim}
+      %value = flow.dispatch.tensor.load %tied, offsets = [0], sizes = [%dim], strides = [1] : !flow.dispatch.tensor<readwrite:tensor<?xf32>>{%dim} -> tensor<?xf32>
+      %result = linalg.generic {indexing_maps = [affine_map<(d0) -> (d0)>], iterator_types = ["parallel"]} outs(%value : tensor<?xf32>) {
+      ^bb0(%out: f32):
+        %add = arith.addf %out, %out : f32
+        linalg.yield %add : f32
+      } -> tensor<?xf32>
+      flow.dispatch.tensor.store %result, %tied, offsets = [0], sizes = [%dim], strides = [1] : tensor<?xf32> -> !flow.dispatch.tensor<readwrite:tensor<?xf32>>{%dim}
+      return
+    }
+  }
+}
@@ -0,0 +1,121 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(func.func(iree-flow-demote-activation-storage{min-size-bytes=1024}))" %s | FileCheck %s
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(func.func(iree-flow-demote-activation-storage{storage-type=f16 min-size-bytes=1024 use-range-analysis=true}))" %s | FileCheck %s --check-prefix=CHECK-F16
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+func.func @demote_between_dispatches(%arg0: tensor<16x32xf32>) -> tensor<16x32xf32> {
+  %empty = tensor.empty() : tensor<16x32xf32>
+  %0 = flow.dispatch.region -> (tensor<16x32xf32>) {
+    %1 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]}
+        ins(%arg0 : tensor<16x32xf32>) outs(%empty : tensor<16x32xf32>) {
+    ^bb0(%in: f32, %out: f32):
+      %2 = math.exp %in : f32
+      linalg.yield %2 : f32
+    } -> tensor<16x32xf32>
+    flow.return %1 : tensor<16x32xf32>
+  }
+  %3 = flow.dispatch.region -> (tensor<16x32xf32>) {
+    %4 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]}
+        ins(%0 : tensor<16x32xf32>) outs(%empty : tensor<16x32xf32>) {
+    ^bb0(%in: f32, %out: f32):
+      %5 = arith.addf %in, %in : f32
+      linalg.yield %5 : f32
+    } -> tensor<16x32xf32>
+    flow.return %4 : tensor<16x32xf32>
+  }
+  return %3 : tensor<16x32xf32>
+}
+
+// CHECK-LABEL: func.func @demote_between_dispatches
+//       CHECK:   %[[PRODUCER:.+]] = flow.dispatch.region -> (tensor<16x32xbf16>) {
+//       CHECK:     %[[EXP:.+]] = linalg.generic
+//       CHECK:       math.exp
+//       CHECK:     %[[TRUNC_INIT:.+]] = tensor.empty() : tensor<16x32xbf16>
+//       CHECK:     %[[TRUNC:.+]] = linalg.generic
+//  CHECK-SAME:         ins(%[[EXP]] : tensor<16x32xf32>) outs(%[[TRUNC_INIT]] : tensor<16x32xbf16>)
+//       CHECK:       arith.truncf %{{.+}} : f32 to bf16
+//       CHECK:     flow.return %[[TRUNC]] : tensor<16x32xbf16>
+//       CHECK:   %[[CONSUMER:.+]] = flow.dispatch.region -> (tensor<16x32xf32>) {
+//       CHECK:     %[[EXT_INIT:.+]] = tensor.empty() : tensor<16x32xf32>
+//       CHECK:     %[[EXT:.+]] = linalg.generic
+//  CHECK-SAME:         ins(%[[PRODUCER]] : tensor<16x32xbf16>) outs(%[[EXT_INIT]] : tensor<16x32xf32>)
+//       CHECK:       arith.extf %{{.+}} : bf16 to f32
+//       CHECK:     linalg.generic
+//  CHECK-SAME:         ins(%[[EXT]] : tensor<16x32xf32>)
+//       CHECK:       arith.addf
+//       CHECK:     flow.return %{{.+}} : tensor<16x32xf32>
+//       CHECK:   return %[[CONSUMER]] : tensor<16x32xf32>
+
+// Without range information the f16 request falls back to bf16.
+// CHECK-F16-LABEL: func.func @demote_between_dispatches
+//       CHECK-F16:   flow.dispatch.region -> (tensor<16x32xbf16>)
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+func.func @demote_known_range(%arg0: tensor<16x32xf32>) -> tensor<16x32xf32> {
+  %cst = arith.constant 1.000000e+00 : f32
+  %empty = tensor.empty() : tensor<16x32xf32>
+  %0 = flow.dispatch.region -> (tensor<16x32xf32>) {
+    %1 = linalg.fill ins(%cst : f32) outs(%empty : tensor<16x32xf32>) -> tensor<16x32xf32>
+    flow.return %1 : tensor<16x32xf32>
+  }
+  %2 = flow.dispatch.region -> (tensor<16x32xf32>) {
+    %3 = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel", "parallel"]}
+        ins(%arg0, %0 : tensor<16x32xf32>, tensor<16x32xf32>) outs(%empty : tensor<16x32xf32>) {
+    ^bb0(%in0: f32, %in1: f32, %out: f32):
+      %4 = arith.addf %in0, %in1 : f32
+      linalg.yield %4 : f32
+    } -> tensor<16x32xf32>
+    flow.return %3 : tensor<16x32xf32>
+  }
+  return %2 : tensor<16x32xf32>
+}
+
+// Values known to fit in f16 are stored as f16.
+// CHECK-F16-LABEL: func.func @demote_known_range
+//       CHECK-F16:   flow.dispatch.region -> (tensor<16x32xf16>)
+//       CHECK-F16:     arith.truncf %{{.+}} : f32 to f16
+//       CHECK-F16:   flow.dispatch.region -> (tensor<16x32xf32>)
+//       CHECK-F16:     arith.extf %{{.+}} : f16 to f32
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+func.func @no_demote(%arg0: tensor<4x4xf32>, %arg1: tensor<16x32xf32>) -> (tensor<4x4xf32>, tensor<16x32xf32>) {
+  %empty0 = tensor.empty() : tensor<4x4xf32>
+  %empty1 = tensor.empty() : tensor<16x32xf32>
+  // Too small to be worth demoting.
+  %0 = flow.dispatch.region -> (tensor<4x4xf32>) {
+    %1 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]}
+        ins(%arg0 : tensor<4x4xf32>) outs(%empty0 : tensor<4x4xf32>) {
+    ^bb0(%in: f32, %out: f32):
+      %2 = math.exp %in : f32
+      linalg.yield %2 : f32
+    } -> tensor<4x4xf32>
+    flow.return %1 : tensor<4x4xf32>
+  }
+  %3 = flow.dispatch.region -> (tensor<4x4xf32>) {
+    %4 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]}
+        ins(%0 : tensor<4x4xf32>) outs(%empty0 : tensor<4x4xf32>) {
+    ^bb0(%in: f32, %out: f32):
+      %5 = math.exp %in : f32
+      linalg.yield %5 : f32
+    } -> tensor<4x4xf32>
+    flow.return %4 : tensor<4x4xf32>
+  }
+  // Escapes the function and must keep its type.
+  %6 = flow.dispatch.region -> (tensor<16x32xf32>) {
+    %7 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]}
+        ins(%arg1 : tensor<16x32xf32>) outs(%empty1 : tensor<16x32xf32>) {
+    ^bb0(%in: f32, %out: f32):
+      %8 = math.exp %in : f32
+      linalg.yield %8 : f32
+    } -> tensor<16x32xf32>
+    flow.return %7 : tensor<16x32xf32>
+  }
+  return %3, %6 : tensor<4x4xf32>, tensor<16x32xf32>
+}
+
+// CHECK-LABEL: func.func @no_demote
+//   CHECK-NOT:   arith.truncf
+//       CHECK:   return
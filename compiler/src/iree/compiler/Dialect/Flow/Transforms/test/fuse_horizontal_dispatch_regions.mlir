@@ -0,0 +1,150 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(func.func(iree-flow-fuse-horizontal-dispatch-regions))" %s | FileCheck %s
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+func.func @fuse_independent(%arg0: tensor<4x8xf32>, %arg1: tensor<4x8xf32>, %arg2: tensor<4x8xf32>) -> (tensor<4x8xf32>, tensor<4x8xf32>) {
+  %empty = tensor.empty() : tensor<4x8xf32>
+  %0 = flow.dispatch.region -> (tensor<4x8xf32>) {
+    %1 = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel", "parallel"]}
+        ins(%arg0, %arg1 : tensor<4x8xf32>, tensor<4x8xf32>) outs(%empty : tensor<4x8xf32>) {
+    ^bb0(%in0: f32, %in1: f32, %out: f32):
+      %2 = arith.addf %in0, %in1 : f32
+      linalg.yield %2 : f32
+    } -> tensor<4x8xf32>
+    flow.return %1 : tensor<4x8xf32>
+  }
+  %3 = flow.dispatch.region -> (tensor<4x8xf32>) {
+    %4 = tensor.empty() : tensor<4x8xf32>
+    %5 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]}
+        ins(%arg2 : tensor<4x8xf32>) outs(%4 : tensor<4x8xf32>) {
+    ^bb0(%in0: f32, %out: f32):
+      %6 = math.exp %in0 : f32
+      linalg.yield %6 : f32
+    } -> tensor<4x8xf32>
+    flow.return %5 : tensor<4x8xf32>
+  }
+  return %0, %3 : tensor<4x8xf32>, tensor<4x8xf32>
+}
+
+// CHECK-LABEL: func.func @fuse_independent
+//  CHECK-SAME:     (%[[ARG0:.+]]: tensor<4x8xf32>, %[[ARG1:.+]]: tensor<4x8xf32>, %[[ARG2:.+]]: tensor<4x8xf32>)
+//  CHECK-SAME:     flow.horizontally_fused_dispatches = 1 : i64
+//       CHECK:   %[[EMPTY:.+]] = tensor.empty() : tensor<4x8xf32>
+//       CHECK:   %[[FUSED:.+]]:2 = flow.dispatch.region -> (tensor<4x8xf32>, tensor<4x8xf32>) {
+//       CHECK:     %[[EMPTY1:.+]] = tensor.empty() : tensor<4x8xf32>
+//       CHECK:     %[[GENERIC:.+]]:2 = linalg.generic
+//  CHECK-SAME:         ins(%[[ARG0]], %[[ARG1]], %[[ARG2]] : tensor<4x8xf32>, tensor<4x8xf32>, tensor<4x8xf32>)
+//  CHECK-SAME:         outs(%[[EMPTY]], %[[EMPTY1]] : tensor<4x8xf32>, tensor<4x8xf32>)
+//  CHECK-NEXT:     ^bb0(%[[IN0:.+]]: f32, %[[IN1:.+]]: f32, %[[IN2:.+]]: f32, %{{.+}}: f32, %{{.+}}: f32):
+//  CHECK-NEXT:       %[[ADD:.+]] = arith.addf %[[IN0]], %[[IN1]] : f32
+//  CHECK-NEXT:       %[[EXP:.+]] = math.exp %[[IN2]] : f32
+//  CHECK-NEXT:       linalg.yield %[[ADD]], %[[EXP]] : f32, f32
+//       CHECK:     flow.return %[[GENERIC]]#0, %[[GENERIC]]#1
+//       CHECK:   return %[[FUSED]]#0, %[[FUSED]]#1
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+func.func @no_fuse_dependent(%arg0: tensor<4x8xf32>) -> tensor<4x8xf32> {
+  %empty = tensor.empty() : tensor<4x8xf32>
+  %0 = flow.dispatch.region -> (tensor<4x8xf32>) {
+    %1 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]}
+        ins(%arg0 : tensor<4x8xf32>) outs(%empty : tensor<4x8xf32>) {
+    ^bb0(%in0: f32, %out: f32):
+      %2 = math.exp %in0 : f32
+      linalg.yield %2 : f32
+    } -> tensor<4x8xf32>
+    flow.return %1 : tensor<4x8xf32>
+  }
+  %3 = flow.dispatch.region -> (tensor<4x8xf32>) {
+    %4 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]}
+        ins(%0 : tensor<4x8xf32>) outs(%empty : tensor<4x8xf32>) {
+    ^bb0(%in0: f32, %out: f32):
+      %5 = math.exp %in0 : f32
+      linalg.yield %5 : f32
+    } -> tensor<4x8xf32>
+    flow.return %4 : tensor<4x8xf32>
+  }
+  return %3 : tensor<4x8xf32>
+}
+
+// CHECK-LABEL: func.func @no_fuse_dependent
+//   CHECK-NOT:   flow.horizontally_fused_dispatches
+//       CHECK:   flow.dispatch.region -> (tensor<4x8xf32>)
+//       CHECK:   flow.dispatch.region -> (tensor<4x8xf32>)
+
+// -----
+
+#map0 = affine_map<(d0, d1) -> (d0, d1)>
+#map1 = affine_map<(d0, d1) -> (d0)>
+func.func @no_fuse_incompatible(%arg0: tensor<4x8xf32>, %arg1: tensor<8x4xf32>, %arg2: tensor<4x8xf32>) -> (tensor<4x8xf32>, tensor<8x4xf32>, tensor<4xf32>) {
+  %empty0 = tensor.empty() : tensor<4x8xf32>
+  %empty1 = tensor.empty() : tensor<8x4xf32>
+  %empty2 = tensor.empty() : tensor<4xf32>
+  %0 = flow.dispatch.region -> (tensor<4x8xf32>) {
+    %1 = linalg.generic {indexing_maps = [#map0, #map0], iterator_types = ["parallel", "parallel"]}
+        ins(%arg0 : tensor<4x8xf32>) outs(%empty0 : tensor<4x8xf32>) {
+    ^bb0(%in0: f32, %out: f32):
+      %2 = math.exp %in0 : f32
+      linalg.yield %2 : f32
+    } -> tensor<4x8xf32>
+    flow.return %1 : tensor<4x8xf32>
+  }
+  // Different loop ranges.
+  %3 = flow.dispatch.region -> (tensor<8x4xf32>) {
+    %4 = linalg.generic {indexing_maps = [#map0, #map0], iterator_types = ["parallel", "parallel"]}
+        ins(%arg1 : tensor<8x4xf32>) outs(%empty1 : tensor<8x4xf32>) {
+    ^bb0(%in0: f32, %out: f32):
+      %5 = math.exp %in0 : f32
+      linalg.yield %5 : f32
+    } -> tensor<8x4xf32>
+    flow.return %4 : tensor<8x4xf32>
+  }
+  // Different iterator types.
+  %6 = flow.dispatch.region -> (tensor<4xf32>) {
+    %7 = linalg.generic {indexing_maps = [#map0, #map1], iterator_types = ["parallel", "reduction"]}
+        ins(%arg2 : tensor<4x8xf32>) outs(%empty2 : tensor<4xf32>) {
+    ^bb0(%in0: f32, %out: f32):
+      %8 = arith.addf %in0, %out : f32
+      linalg.yield %8 : f32
+    } -> tensor<4xf32>
+    flow.return %7 : tensor<4xf32>
+  }
+  return %0, %3, %6 : tensor<4x8xf32>, tensor<8x4xf32>, tensor<4xf32>
+}
+
+// CHECK-LABEL: func.func @no_fuse_incompatible
+//   CHECK-NOT:   flow.horizontally_fused_dispatches
+//       CHECK:   flow.dispatch.region -> (tensor<4x8xf32>)
+//       CHECK:   flow.dispatch.region -> (tensor<8x4xf32>)
+//       CHECK:   flow.dispatch.region -> (tensor<4xf32>)
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+func.func @no_fuse_large(%arg0: tensor<512x256xf32>, %arg1: tensor<512x256xf32>) -> (tensor<512x256xf32>, tensor<512x256xf32>) {
+  %empty = tensor.empty() : tensor<512x256xf32>
+  %0 = flow.dispatch.region -> (tensor<512x256xf32>) {
+    %1 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]}
+        ins(%arg0 : tensor<512x256xf32>) outs(%empty : tensor<512x256xf32>) {
+    ^bb0(%in0: f32, %out: f32):
+      %2 = math.exp %in0 : f32
+      linalg.yield %2 : f32
+    } -> tensor<512x256xf32>
+    flow.return %1 : tensor<512x256xf32>
+  }
+  %3 = flow.dispatch.region -> (tensor<512x256xf32>) {
+    %4 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]}
+        ins(%arg1 : tensor<512x256xf32>) outs(%empty : tensor<512x256xf32>) {
+    ^bb0(%in0: f32, %out: f32):
+      %5 = math.exp %in0 : f32
+      linalg.yield %5 : f32
+    } -> tensor<512x256xf32>
+    flow.return %4 : tensor<512x256xf32>
+  }
+  return %0, %3 : tensor<512x256xf32>, tensor<512x256xf32>
+}
+
+// CHECK-LABEL: func.func @no_fuse_large
+//   CHECK-NOT:   flow.horizontally_fused_dispatches
+//       CHECK:   flow.dispatch.region -> (tensor<512x256xf32>)
+//       CHECK:   flow.dispatch.region -> (tensor<512x256xf32>)
@@ -0,0 +1,130 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(iree-flow-specialize-dispatch-shape-buckets{divisors=16,64})" %s | FileCheck %s
+
+// CHECK-DAG: #[[MAP64:.+]] = affine_map<()[s0] -> ((s0 floordiv 64) * 64)>
+// CHECK-DAG: #[[MAP16:.+]] = affine_map<()[s0] -> ((s0 floordiv 16) * 16)>
+
+// CHECK-LABEL: flow.executable private @ex
+flow.executable private @ex {
+  // CHECK: flow.executable.export public @entry workgroups
+  // CHECK: flow.executable.export public @entry_div64 workgroups
+  // CHECK: flow.executable.export public @entry_div16 workgroups
+  flow.executable.export public @entry workgroups(%arg0: index) -> (index, index, index) {
+    %x, %y, %z = flow.dispatch.workgroup_count_from_slice %arg0
+    flow.return %x, %y, %z : index, index, index
+  }
+  builtin.module {
+    // CHECK: func.func @entry(%[[ARG0:.+]]: !flow.dispatch.tensor<readonly:tensor<?xf32>>, %[[ARG1:.+]]: index
+    // CHECK:   %[[DIM:.+]] = flow.dispatch.workload.ordinal %[[ARG1]], 0 : index
+    // CHECK:   flow.dispatch.tie_shape %[[ARG0]] : !flow.dispatch.tensor<readonly:tensor<?xf32>>{%[[DIM]]}
+    // CHECK: func.func @entry_div64(%[[ARG0:.+]]: !flow.dispatch.tensor<readonly:tensor<?xf32>>, %[[ARG1:.+]]: index
+    // CHECK:   %[[DIM:.+]] = flow.dispatch.workload.ordinal %[[ARG1]], 0 : index
+    // CHECK:   %[[ROUNDED:.+]] = affine.apply #[[MAP64]]()[%[[DIM]]]
+    // CHECK:   flow.dispatch.tie_shape %[[ARG0]] : !flow.dispatch.tensor<readonly:tensor<?xf32>>{%[[ROUNDED]]}
+    // CHECK: func.func @entry_div16(
+    // CHECK:   affine.apply #[[MAP16]]()
+    func.func @entry(%arg0: !flow.dispatch.tensor<readonly:tensor<?xf32>>, %arg1: index, %arg2: !flow.dispatch.tensor<writeonly:tensor<?xf32>>) {
+      %dim = flow.dispatch.workload.ordinal %arg1, 0 : index
+      %0 = flow.dispatch.tie_shape %arg0 : !flow.dispatch.tensor<readonly:tensor<?xf32>>{%dim}
+      %1 = flow.dispatch.tie_shape %arg2 : !flow.dispatch.tensor<writeonly:tensor<?xf32>>{%dim}
+      %2 = flow.dispatch.tensor.load %0, offsets = [0], sizes = [%dim], strides = [1] : !flow.dispatch.tensor<readonly:tensor<?xf32>>{%dim} -> tensor<?xf32>
+      flow.dispatch.tensor.store %2, %1, offsets = [0], sizes = [%dim], strides = [1] : tensor<?xf32> -> !flow.dispatch.tensor<writeonly:tensor<?xf32>>{%dim}
+      return
+    }
+  }
+}
+
+// CHECK-LABEL: func.func @dynamic_dispatch
+// CHECK-SAME: (%[[INPUT:.+]]: tensor<?xf32>, %[[DIM:.+]]: index)
+func.func @dynamic_dispatch(%input: tensor<?xf32>, %dim: index) -> tensor<?xf32> {
+  //      CHECK:   %[[REM64:.+]] = arith.remui %[[DIM]], %c64
+  //      CHECK:   %[[IS64:.+]] = arith.cmpi eq, %[[REM64]], %c0
+  //      CHECK:   %[[REM16:.+]] = arith.remui %[[DIM]], %c16
+  //      CHECK:   %[[IS16:.+]] = arith.cmpi eq, %[[REM16]], %c0
+  //      CHECK:   cf.cond_br %[[IS64]], ^[[BB64:.+]], ^[[CHECK16:.+]]
+  //      CHECK: ^[[CHECK16]]:
+  //      CHECK:   cf.cond_br %[[IS16]], ^[[BB16:.+]], ^[[FALLBACK:.+]]
+  //      CHECK: ^[[BB16]]:
+  //      CHECK:   %[[RESULT16:.+]] = flow.dispatch @ex::@entry_div16[%[[DIM]]](%[[INPUT]], %[[DIM]])
+  //      CHECK:   cf.br ^[[MERGE:.+]](%[[RESULT16]] : tensor<?xf32>)
+  //      CHECK: ^[[BB64]]:
+  //      CHECK:   %[[RESULT64:.+]] = flow.dispatch @ex::@entry_div64[%[[DIM]]](%[[INPUT]], %[[DIM]])
+  //      CHECK:   cf.br ^[[MERGE]](%[[RESULT64]] : tensor<?xf32>)
+  //      CHECK: ^[[FALLBACK]]:
+  //      CHECK:   %[[RESULT:.+]] = flow.dispatch @ex::@entry[%[[DIM]]](%[[INPUT]], %[[DIM]])
+  //      CHECK:   cf.br ^[[MERGE]](%[[RESULT]] : tensor<?xf32>)
+  %0 = flow.dispatch @ex::@entry[%dim](%input, %dim) : (tensor<?xf32>{%dim}, index) -> tensor<?xf32>{%dim}
+  //      CHECK: ^[[MERGE]](%[[MERGED:.+]]: tensor<?xf32>):
+  // CHECK-NEXT:   return %[[MERGED]]
+  return %0 : tensor<?xf32>
+}
+
+// -----
+
+flow.executable private @ex {
+  flow.executable.export public @entry workgroups(%arg0: index, %arg1: index) -> (index, index, index) {
+    %x, %y, %z = flow.dispatch.workgroup_count_from_slice %arg0, %arg1
+    flow.return %x, %y, %z : index, index, index
+  }
+  builtin.module {
+    func.func @entry(%arg0: !flow.dispatch.tensor<readonly:tensor<?x?xf32>>, %arg1: index, %arg2: index, %arg3: !flow.dispatch.tensor<writeonly:tensor<?x?xf32>>) {
+      %dim0 = flow.dispatch.workload.ordinal %arg1, 0 : index
+      %dim1 = flow.dispatch.workload.ordinal %arg2, 1 : index
+      %0 = flow.dispatch.tie_shape %arg0 : !flow.dispatch.tensor<readonly:tensor<?x?xf32>>{%dim0, %dim1}
+      %1 = flow.dispatch.tie_shape %arg3 : !flow.dispatch.tensor<writeonly:tensor<?x?xf32>>{%dim0, %dim1}
+      %2 = flow.dispatch.tensor.load %0, offsets = [0, 0], sizes = [%dim0, %dim1], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<?x?xf32>>{%dim0, %dim1} -> tensor<?x?xf32>
+      flow.dispatch.tensor.store %2, %1, offsets = [0, 0], sizes = [%dim0, %dim1], strides = [1, 1] : tensor<?x?xf32> -> !flow.dispatch.tensor<writeonly:tensor<?x?xf32>>{%dim0, %dim1}
+      return
+    }
+  }
+}
+
+// Constant workload values are checked at compile time: 32 is only divisible
+// by 16 so the 64 bucket is never considered.
+
+// CHECK-LABEL: func.func @mixed_dispatch
+// CHECK-SAME: (%[[INPUT:.+]]: tensor<32x?xf32>, %[[DIM:.+]]: index)
+func.func @mixed_dispatch(%input: tensor<32x?xf32>, %dim: index) -> tensor<32x?xf32> {
+  %c32 = arith.constant 32 : index
+  //  CHECK-NOT:   arith.remui %{{.+}}, %c64
+  //      CHECK:   %[[REM16:.+]] = arith.remui %[[DIM]], %c16
+  //      CHECK:   %[[IS16:.+]] = arith.cmpi eq, %[[REM16]], %c0
+  //      CHECK:   cf.cond_br %[[IS16]], ^[[BB16:.+]], ^[[FALLBACK:.+]]
+  //      CHECK: ^[[BB16]]:
+  //      CHECK:   flow.dispatch @ex::@entry_div16[%c32, %[[DIM]]]
+  //      CHECK: ^[[FALLBACK]]:
+  //      CHECK:   flow.dispatch @ex::@entry[%c32, %[[DIM]]]
+  %0 = flow.dispatch @ex::@entry[%c32, %dim](%input, %c32, %dim) : (tensor<32x?xf32>{%dim}, index, index) -> tensor<32x?xf32>{%dim}
+  return %0 : tensor<32x?xf32>
+}
+
+// -----
+
+// Dispatches with fully static workloads are left unchanged.
+
+flow.executable private @ex {
+  // CHECK: flow.executable.export public @entry workgroups
+  // CHECK-NOT: flow.executable.export public @entry_div
+  flow.executable.export public @entry workgroups(%arg0: index) -> (index, index, index) {
+    %x, %y, %z = flow.dispatch.workgroup_count_from_slice %arg0
+    flow.return %x, %y, %z : index, index, index
+  }
+  builtin.module {
+    func.func @entry(%arg0: !flow.dispatch.tensor<readonly:tensor<?xf32>>, %arg1: index, %arg2: !flow.dispatch.tensor<writeonly:tensor<?xf32>>) {
+      %dim = flow.dispatch.workload.ordinal %arg1, 0 : index
+      %0 = flow.dispatch.tie_shape %arg0 : !flow.dispatch.tensor<readonly:tensor<?xf32>>{%dim}
+      %1 = flow.dispatch.tie_shape %arg2 : !flow.dispatch.tensor<writeonly:tensor<?xf32>>{%dim}
+      %2 = flow.dispatch.tensor.load %0, offsets = [0], sizes = [%dim], strides = [1] : !flow.dispatch.tensor<readonly:tensor<?xf32>>{%dim} -> tensor<?xf32>
+      flow.dispatch.tensor.store %2, %1, offsets = [0], sizes = [%dim], strides = [1] : tensor<?xf32> -> !flow.dispatch.tensor<writeonly:tensor<?xf32>>{%dim}
+      return
+    }
+  }
+}
+
+// CHECK-LABEL: func.func @static_dispatch
+func.func @static_dispatch(%input: tensor<128xf32>) -> tensor<128xf32> {
+  %c128 = arith.constant 128 : index
+  // CHECK-NOT: cf.cond_br
+  // CHECK: flow.dispatch @ex::@entry[%c128]
+  %0 = flow.dispatch @ex::@entry[%c128](%input, %c128) : (tensor<128xf32>, index) -> tensor<128xf32>
+  return %0 : tensor<128xf32>
+}
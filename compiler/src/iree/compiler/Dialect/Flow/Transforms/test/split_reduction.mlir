@@ -0,0 +1,74 @@
+// RUN: iree-opt --split-input-file --iree-flow-split-matmul-reduction-workers=16 --iree-flow-split-reduction-ops %s | FileCheck %s
+// RUN: iree-opt --split-input-file --iree-flow-split-matmul-reduction-workers=16 --iree-flow-split-matmul-reduction-min-size=0 --iree-flow-split-reduction-ops %s | FileCheck %s --check-prefix=MIN0
+
+// Skinny matmuls that cannot occupy all workers along M and N are split along
+// K until they can.
+
+// CHECK-LABEL: func.func @skinny_matmul
+func.func @skinny_matmul(%lhs: tensor<1x16384xf32>, %rhs: tensor<16384x256xf32>, %init: tensor<1x256xf32>) -> tensor<1x256xf32> {
+  // CHECK: tensor.expand_shape {{.+}} : tensor<1x16384xf32> into tensor<1x4x4096xf32>
+  // CHECK: tensor.expand_shape {{.+}} : tensor<16384x256xf32> into tensor<4x4096x256xf32>
+  // CHECK: linalg.fill {{.+}} -> tensor<4x1x256xf32>
+  // CHECK: linalg.generic
+  // CHECK-SAME: iterator_types = ["parallel", "parallel", "parallel", "reduction"]
+  // CHECK: %[[RESULT:.+]] = linalg.generic
+  // CHECK-SAME: iterator_types = ["reduction", "parallel", "parallel"]
+  // CHECK-SAME: outs(%{{.+}} : tensor<1x256xf32>)
+  %0 = linalg.matmul ins(%lhs, %rhs : tensor<1x16384xf32>, tensor<16384x256xf32>) outs(%init : tensor<1x256xf32>) -> tensor<1x256xf32>
+  // CHECK: return %[[RESULT]]
+  return %0 : tensor<1x256xf32>
+}
+
+// -----
+
+// Matmuls with enough parallel work are left alone.
+
+// CHECK-LABEL: func.func @wide_matmul
+func.func @wide_matmul(%lhs: tensor<1x4096xf32>, %rhs: tensor<4096x4096xf32>, %init: tensor<1x4096xf32>) -> tensor<1x4096xf32> {
+  // CHECK-NOT: tensor.expand_shape
+  // CHECK: linalg.matmul
+  %0 = linalg.matmul ins(%lhs, %rhs : tensor<1x4096xf32>, tensor<4096x4096xf32>) outs(%init : tensor<1x4096xf32>) -> tensor<1x4096xf32>
+  return %0 : tensor<1x4096xf32>
+}
+
+// -----
+
+// Splits must keep a minimum reduction size. Without one the split is only
+// limited by the worker count.
+
+// CHECK-LABEL: func.func @short_reduction_matmul
+// MIN0-LABEL: func.func @short_reduction_matmul
+func.func @short_reduction_matmul(%lhs: tensor<1x256xf32>, %rhs: tensor<256x256xf32>, %init: tensor<1x256xf32>) -> tensor<1x256xf32> {
+  // CHECK-NOT: tensor.expand_shape
+  // MIN0: tensor.expand_shape {{.+}} : tensor<1x256xf32> into tensor<1x4x64xf32>
+  // CHECK: linalg.matmul
+  %0 = linalg.matmul ins(%lhs, %rhs : tensor<1x256xf32>, tensor<256x256xf32>) outs(%init : tensor<1x256xf32>) -> tensor<1x256xf32>
+  return %0 : tensor<1x256xf32>
+}
+
+// -----
+
+// Dynamic matmuls are not split as their parallelism is unknown.
+
+// CHECK-LABEL: func.func @dynamic_matmul
+func.func @dynamic_matmul(%lhs: tensor<?x16384xf32>, %rhs: tensor<16384x256xf32>, %init: tensor<?x256xf32>) -> tensor<?x256xf32> {
+  // CHECK-NOT: tensor.expand_shape
+  // CHECK: linalg.matmul
+  %0 = linalg.matmul ins(%lhs, %rhs : tensor<?x16384xf32>, tensor<16384x256xf32>) outs(%init : tensor<?x256xf32>) -> tensor<?x256xf32>
+  return %0 : tensor<?x256xf32>
+}
+
+// -----
+
+// Empty reductions are not split.
+
+// CHECK-LABEL: func.func @empty_reduction_matmul
+// MIN0-LABEL: func.func @empty_reduction_matmul
+func.func @empty_reduction_matmul(%lhs: tensor<1x0xf32>, %rhs: tensor<0x256xf32>, %init: tensor<1x256xf32>) -> tensor<1x256xf32> {
+  // CHECK-NOT: tensor.expand_shape
+  // CHECK: linalg.matmul
+  // MIN0-NOT: tensor.expand_shape
+  // MIN0: linalg.matmul
+  %0 = linalg.matmul ins(%lhs, %rhs : tensor<1x0xf32>, tensor<0x256xf32>) outs(%init : tensor<1x256xf32>) -> tensor<1x256xf32>
+  return %0 : tensor<1x256xf32>
+}
@@ -6,12 +6,14 @@
 
 #include "iree/compiler/Dialect/HAL/Target/LLVMCPU/LLVMCPUTarget.h"
 
+#include <algorithm>
 #include <cstdlib>
 
 #include "iree-dialects/Dialect/LinalgExt/IR/LinalgExtDialect.h"
 #include "iree-dialects/Dialect/LinalgTransform/LinalgTransformOps.h"
 #include "iree/compiler/Codegen/Dialect/IREECodegenDialect.h"
 #include "iree/compiler/Codegen/LLVMCPU/LLVMCPUPasses.h"
+#include "iree/compiler/Codegen/LLVMCPU/TuningDatabase.h"
 #include "iree/compiler/Codegen/Utils/Utils.h"
 #include "iree/compiler/Dialect/HAL/Target/LLVMCPU/Builtins/Device.h"
 #include "iree/compiler/Dialect/HAL/Target/LLVMCPU/Builtins/Musl.h"
@@ -30,6 +32,7 @@
 #include "llvm/IR/Module.h"
 #include "llvm/Linker/Linker.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/Threading.h"
 #include "mlir/Dialect/ArmNeon/ArmNeonDialect.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "mlir/Dialect/PDL/IR/PDL.h"
@@ -199,6 +202,35 @@ class LLVMCPUTargetBackend final : public TargetBackend {
     buildLLVMCPULinkingPassPipeline(passManager);
   }
 
+  void printExecutableCacheConfiguration(
+      llvm::raw_ostream &os) const override {
+    os << "triple=" << options_.target.triple
+       << ";cpu=" << options_.target.cpu
+       << ";cpu-features=" << options_.target.cpuFeatures
+       << ";abi=" << options_.options.MCOptions.ABIName
+       << ";float-abi=" << static_cast<int>(options_.options.FloatABIType)
+       << ";opt=" << options_.optimizerOptLevel.getSpeedupLevel() << "/"
+       << options_.optimizerOptLevel.getSizeLevel()
+       << ";codegen-opt=" << static_cast<int>(options_.codeGenOptLevel)
+       << ";loop-interleaving="
+       << options_.pipelineTuningOptions.LoopInterleaving
+       << ";loop-vectorization="
+       << options_.pipelineTuningOptions.LoopVectorization
+       << ";loop-unrolling=" << options_.pipelineTuningOptions.LoopUnrolling
+       << ";slp-vectorization="
+       << options_.pipelineTuningOptions.SLPVectorization
+       << ";debug-symbols=" << options_.debugSymbols
+       << ";sanitizer=" << static_cast<int>(options_.sanitizerKind)
+       << ";system-linker=" << options_.systemLinkerPath
+       << ";embedded-linker=" << options_.embeddedLinkerPath
+       << ";wasm-linker=" << options_.wasmLinkerPath
+       << ";link-embedded=" << options_.linkEmbedded
+       << ";link-static=" << options_.linkStatic
+       << ";codegen-partitions=" << options_.codegenPartitionCount
+       << ";static-library=" << options_.staticLibraryOutput
+       << ";tuning-db=" << getTuningDatabaseHash();
+  }
+
   // Gets the LLVM target from |variantOp|.
   // This will differ from the default options specified by command line flags
   // whenever multi-targeting.
@@ -353,9 +385,22 @@ class LLVMCPUTargetBackend final : public TargetBackend {
           sourceLine = loc->getLine();
         }
       }
+      // Static dispatch costs computed by the compiler, if any, are embedded
+      // so that tools can report achieved throughput.
+      LibraryBuilder::DispatchRoofline roofline;
+      if (auto rooflineAttr =
+              exportOp->getAttrOfType<DictionaryAttr>("iree.roofline")) {
+        if (auto flopsAttr = rooflineAttr.getAs<IntegerAttr>("flops")) {
+          roofline.flopCount = flopsAttr.getInt();
+        }
+        if (auto bytesAttr = rooflineAttr.getAs<IntegerAttr>("bytes")) {
+          roofline.byteCount = bytesAttr.getInt();
+        }
+      }
+
       libraryBuilder.addExport(
           exportOp.getName(), sourceFile, sourceLine, /*tag=*/"",
-          LibraryBuilder::DispatchAttrs{localMemorySize}, llvmFunc);
+          LibraryBuilder::DispatchAttrs{localMemorySize}, roofline, llvmFunc);
     }
 
     auto queryFunctionName = std::string(kQueryFunctionName);
@@ -531,26 +576,49 @@ class LLVMCPUTargetBackend final : public TargetBackend {
 
     SmallVector<Artifact> objectFiles;
 
-    // Emit the base object file containing the bulk of our code.
-    // This must come first such that we have the proper library linking order.
+    // Emit the base object files containing the bulk of our code.
+    // These must come first such that we have the proper library linking
+    // order.
     {
-      // NOTE: today we just use a single object file, however if we wanted to
-      // scale code generation and linking we'd want to generate one per
-      // function (or something like that). A single object file is also
-      // instrumental to static library generation (which only supports one
-      // object file per library).
-      std::string objectData;
-      if (failed(runEmitObjFilePasses(targetMachine.get(), llvmModule.get(),
-                                      llvm::CGFT_ObjectFile, &objectData))) {
+      // Large (especially linked) executables spend most of their time in
+      // LLVM code generation which is single-threaded per module. We split
+      // the module into partitions that are code generated in parallel and
+      // emit one object file per partition. Static library generation only
+      // supports one object file per library and we respect the context
+      // threading setting so that --mlir-disable-threading is honored.
+      unsigned partitionCount = 1;
+      if (!options_.linkStatic &&
+          variantOp.getContext()->isMultithreadingEnabled()) {
+        partitionCount = options_.codegenPartitionCount;
+        if (partitionCount == 0) {
+          partitionCount = llvm::hardware_concurrency().compute_thread_count();
+        }
+        // No benefit to having more partitions than functions to compile.
+        unsigned definedFunctionCount = llvm::count_if(
+            *llvmModule, [](llvm::Function &func) {
+              return !func.isDeclaration();
+            });
+        partitionCount =
+            std::max(1u, std::min(partitionCount, definedFunctionCount));
+      }
+      SmallVector<std::string> objectDatas;
+      if (failed(runParallelEmitObjFilePasses(target, options_,
+                                              llvmModule.get(), partitionCount,
+                                              objectDatas))) {
         return variantOp.emitError()
                << "failed to compile LLVM-IR module to an object file";
       }
-      auto objectFile = Artifact::createTemporary(libraryName, "o");
-      auto &os = objectFile.outputFile->os();
-      os << objectData;
-      os.flush();
-      os.close();
-      objectFiles.push_back(std::move(objectFile));
+      for (auto [index, objectData] : llvm::enumerate(objectDatas)) {
+        auto objectFile = Artifact::createTemporary(
+            index == 0 ? libraryName
+                       : libraryName + "_part" + std::to_string(index),
+            "o");
+        auto &os = objectFile.outputFile->os();
+        os << objectData;
+        os.flush();
+        os.close();
+        objectFiles.push_back(std::move(objectFile));
+      }
     }
 
     // Dump assembly listing after optimization, which is just a textual
@@ -933,6 +1001,15 @@ void registerLLVMCPUTargetBackends(
   // #hal.device.target<"llvm-cpu", ...
   // #hal.executable.target<"llvm-cpu", ...
   static TargetBackendRegistration registration("llvm-cpu", backendFactory);
+
+  // Same backend but configured for the host CPU regardless of flags. Used for
+  // programs that are run within the compiler process such as during constant
+  // evaluation. Produces #hal.executable.target<"llvm-cpu", ... attributes and
+  // must be registered as "llvm-cpu" in the registry used for compilation.
+  static TargetBackendRegistration hostRegistration("llvm-cpu-host", []() {
+    return std::make_shared<LLVMCPUTargetBackend>(
+        getLLVMTargetOptionsForHost());
+  });
 }
 
 }  // namespace HAL
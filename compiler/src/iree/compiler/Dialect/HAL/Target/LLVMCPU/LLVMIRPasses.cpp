@@ -7,6 +7,7 @@
 #include "iree/compiler/Dialect/HAL/Target/LLVMCPU/LLVMIRPasses.h"
 
 #include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/CodeGen/ParallelCG.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
@@ -19,6 +20,7 @@
 #include "llvm/Support/Error.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/TargetParser/Host.h"
+#include "llvm/Transforms/Utils/Cloning.h"
 #include "llvm/Transforms/Instrumentation/AddressSanitizer.h"
 #include "llvm/Transforms/Instrumentation/ThreadSanitizer.h"
 
@@ -128,6 +130,57 @@ LogicalResult runEmitObjFilePasses(llvm::TargetMachine *machine,
   return success();
 }
 
+LogicalResult runParallelEmitObjFilePasses(
+    const LLVMTarget &target, const LLVMTargetOptions &options,
+    llvm::Module *module, unsigned partitionCount,
+    llvm::SmallVectorImpl<std::string> &objData) {
+  if (partitionCount <= 1) {
+    auto targetMachine = createTargetMachine(target, options);
+    if (!targetMachine) return failure();
+    std::string data;
+    if (failed(runEmitObjFilePasses(targetMachine.get(), module,
+                                    llvm::CGFT_ObjectFile, &data))) {
+      return failure();
+    }
+    objData.push_back(std::move(data));
+    return success();
+  }
+
+  // Target machine creation only depends on |target| and |options| so we check
+  // once here that it succeeds; splitCodeGen has no way to report failure from
+  // its factory.
+  if (!createTargetMachine(target, options)) return failure();
+
+  // SplitModule externalizes and renames local symbols in the module it
+  // splits. We split a clone so that |module| remains as-is for any later
+  // dumps.
+  std::unique_ptr<llvm::Module> splitModule = llvm::CloneModule(*module);
+
+  // Each partition gets its own output stream. splitCodeGen handles cloning
+  // the partitions into their own contexts and running them on a thread pool
+  // with one thread per partition.
+  llvm::SmallVector<llvm::SmallVector<char, 0>> buffers(partitionCount);
+  llvm::SmallVector<std::unique_ptr<llvm::raw_svector_ostream>> streams;
+  llvm::SmallVector<llvm::raw_pwrite_stream *> streamPtrs;
+  streams.reserve(partitionCount);
+  for (auto &buffer : buffers) {
+    streams.push_back(std::make_unique<llvm::raw_svector_ostream>(buffer));
+    streamPtrs.push_back(streams.back().get());
+  }
+  llvm::splitCodeGen(
+      *splitModule, streamPtrs, /*BCOSs=*/{},
+      [&]() { return createTargetMachine(target, options); },
+      llvm::CGFT_ObjectFile);
+
+  // Partitioning may produce empty partitions when there are fewer
+  // partitionable symbols than requested partitions; those emit no object.
+  for (auto &buffer : buffers) {
+    if (buffer.empty()) continue;
+    objData.push_back(std::string(buffer.begin(), buffer.end()));
+  }
+  return success();
+}
+
 }  // namespace HAL
 }  // namespace IREE
 }  // namespace iree_compiler
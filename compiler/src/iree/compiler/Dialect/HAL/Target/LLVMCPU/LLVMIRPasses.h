@@ -10,6 +10,7 @@
 #include <memory>
 
 #include "iree/compiler/Dialect/HAL/Target/LLVMCPU/LLVMTargetOptions.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Target/TargetMachine.h"
 #include "mlir/Support/LogicalResult.h"
@@ -34,6 +35,16 @@ LogicalResult runEmitObjFilePasses(llvm::TargetMachine *machine,
                                    llvm::CodeGenFileType fileType,
                                    std::string *objData);
 
+// Emits compiled module objects for the target machine after splitting the
+// module into up to |partitionCount| partitions that are code generated in
+// parallel. Each partition is compiled in its own LLVMContext using a target
+// machine produced from |target| and |options|. The order of |objData| is
+// deterministic and matches the partition order.
+LogicalResult runParallelEmitObjFilePasses(
+    const LLVMTarget &target, const LLVMTargetOptions &options,
+    llvm::Module *module, unsigned partitionCount,
+    llvm::SmallVectorImpl<std::string> &objData);
+
 }  // namespace HAL
 }  // namespace IREE
 }  // namespace iree_compiler
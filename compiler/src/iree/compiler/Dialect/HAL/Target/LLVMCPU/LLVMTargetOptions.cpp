@@ -76,6 +76,24 @@ static void addTargetCPUFeaturesForCPU(LLVMTarget &target) {
   target.cpuFeatures = targetCpuFeatures.getString();
 }
 
+static void addTargetPlatformFeatures(LLVMTarget &target) {
+  if (llvm::Triple(target.triple).isAArch64()) {
+    llvm::SubtargetFeatures targetCpuFeatures(target.cpuFeatures);
+    targetCpuFeatures.AddFeature("reserve-x18", true);
+    target.cpuFeatures = targetCpuFeatures.getString();
+  }
+}
+
+static void setEmbeddedTargetTriple(LLVMTarget &target) {
+  // Force the triple to something compatible with embedded linking.
+  llvm::Triple targetTriple(target.triple);
+  targetTriple.setVendor(llvm::Triple::VendorType::UnknownVendor);
+  targetTriple.setEnvironment(llvm::Triple::EnvironmentType::EABI);
+  targetTriple.setOS(llvm::Triple::OSType::UnknownOS);
+  targetTriple.setObjectFormat(llvm::Triple::ObjectFormatType::ELF);
+  target.triple = targetTriple.str();
+}
+
 LLVMTargetOptions getLLVMTargetOptionsFromFlags() {
   auto targetOptions = getDefaultLLVMTargetOptions();
 
@@ -121,11 +139,7 @@ LLVMTargetOptions getLLVMTargetOptionsFromFlags() {
   // TODO(muralivi): Move this into `addTargetCPUFeaturesForCPU`, after fixing
   // the predicate for when `addTargetCPUFeaturesForCPU` is called (i.e.
   // removing the condition that clTargetCPU is neither host nor generic).
-  if (llvm::Triple(targetOptions.target.triple).isAArch64()) {
-    llvm::SubtargetFeatures targetCpuFeatures(targetOptions.target.cpuFeatures);
-    targetCpuFeatures.AddFeature("reserve-x18", true);
-    targetOptions.target.cpuFeatures = targetCpuFeatures.getString();
-  }
+  addTargetPlatformFeatures(targetOptions.target);
 
   // LLVM opt options.
   targetOptions.pipelineTuningOptions.LoopInterleaving = llvmLoopInterleaving;
@@ -199,12 +213,7 @@ LLVMTargetOptions getLLVMTargetOptionsFromFlags() {
     targetOptions.linkEmbedded = false;
   }
   if (targetOptions.linkEmbedded) {
-    // Force the triple to something compatible with embedded linking.
-    targetTriple.setVendor(llvm::Triple::VendorType::UnknownVendor);
-    targetTriple.setEnvironment(llvm::Triple::EnvironmentType::EABI);
-    targetTriple.setOS(llvm::Triple::OSType::UnknownOS);
-    targetTriple.setObjectFormat(llvm::Triple::ObjectFormatType::ELF);
-    targetOptions.target.triple = targetTriple.str();
+    setEmbeddedTargetTriple(targetOptions.target);
   }
 
   static llvm::cl::opt<bool> clLinkStatic(
@@ -221,6 +230,17 @@ LLVMTargetOptions getLLVMTargetOptionsFromFlags() {
       llvm::cl::init(targetOptions.keepLinkerArtifacts));
   targetOptions.keepLinkerArtifacts = clKeepLinkerArtifacts;
 
+  static llvm::cl::opt<unsigned> clCodegenPartitionCount(
+      "iree-llvmcpu-codegen-partitions",
+      llvm::cl::desc(
+          "Number of partitions to split each executable into for parallel "
+          "LLVM code generation; 1 disables partitioning and 0 selects based "
+          "on the host hardware concurrency. Partitions use their own threads "
+          "so values > 1 are best used when few executables are serialized "
+          "at once (such as with linked executables)."),
+      llvm::cl::init(targetOptions.codegenPartitionCount));
+  targetOptions.codegenPartitionCount = clCodegenPartitionCount;
+
   static llvm::cl::opt<std::string> clStaticLibraryOutputPath(
       "iree-llvmcpu-static-library-output-path",
       llvm::cl::desc(
@@ -243,6 +263,23 @@ LLVMTargetOptions getLLVMTargetOptionsFromFlags() {
   return targetOptions;
 }
 
+LLVMTargetOptions getLLVMTargetOptionsForHost() {
+  // Start from the flags so that optimization options are still honored but
+  // ignore anything that would change how or where the binaries are produced.
+  auto targetOptions = getLLVMTargetOptionsFromFlags();
+  auto defaultOptions = getDefaultLLVMTargetOptions();
+  targetOptions.target = defaultOptions.target;
+  targetOptions.options = defaultOptions.options;
+  targetOptions.debugSymbols = false;
+  targetOptions.sanitizerKind = SanitizerKind::kNone;
+  targetOptions.linkEmbedded = true;
+  targetOptions.linkStatic = false;
+  targetOptions.staticLibraryOutput.clear();
+  addTargetPlatformFeatures(targetOptions.target);
+  setEmbeddedTargetTriple(targetOptions.target);
+  return targetOptions;
+}
+
 }  // namespace HAL
 }  // namespace IREE
 }  // namespace iree_compiler
@@ -74,6 +74,15 @@ struct LLVMTargetOptions {
   // True to keep linker artifacts for debugging.
   bool keepLinkerArtifacts = false;
 
+  // Number of partitions each executable is split into for parallel LLVM code
+  // generation. Each partition produces its own object file that is linked
+  // into the final binary. 1 (the default) disables partitioning. 0 selects a
+  // partition count based on the host hardware concurrency; partitions run on
+  // their own threads in addition to the MLIR thread pool that serializes
+  // executables in parallel. Ignored when producing static libraries as those
+  // only support a single object file.
+  unsigned codegenPartitionCount = 1;
+
   // Build for IREE static library loading using this output path for
   // a "{staticLibraryOutput}.o" object file and "{staticLibraryOutput}.h"
   // header file.
@@ -85,6 +94,12 @@ struct LLVMTargetOptions {
 // Returns LLVMTargetOptions struct intialized with the iree-llvmcpu-* flags.
 LLVMTargetOptions getLLVMTargetOptionsFromFlags();
 
+// Returns LLVMTargetOptions struct targeting the host CPU with all of its
+// features for executables loaded in-process by the embedded ELF loader.
+// Optimization related iree-llvmcpu-* flags are honored while the target
+// machine and output format flags are ignored.
+LLVMTargetOptions getLLVMTargetOptionsForHost();
+
 }  // namespace HAL
 }  // namespace IREE
 }  // namespace iree_compiler
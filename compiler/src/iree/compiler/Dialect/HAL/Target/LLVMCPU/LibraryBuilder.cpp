@@ -156,6 +156,26 @@ static llvm::StructType *makeSrcLocType(llvm::LLVMContext &context) {
   return type;
 }
 
+// %struct.iree_hal_executable_roofline_v0_t = type {
+//   i64,
+//   i64
+// }
+static llvm::StructType *makeRooflineType(llvm::LLVMContext &context) {
+  if (auto *existingType = llvm::StructType::getTypeByName(
+          context, "iree_hal_executable_roofline_v0_t")) {
+    return existingType;
+  }
+  auto *i64Type = llvm::IntegerType::getInt64Ty(context);
+  auto *type = llvm::StructType::create(context,
+                                        {
+                                            i64Type,
+                                            i64Type,
+                                        },
+                                        "iree_hal_executable_roofline_v0_t",
+                                        /*isPacked=*/false);
+  return type;
+}
+
 // %struct.iree_hal_executable_export_table_v0_t = type {
 //   i32,
 //   i32*,
@@ -237,6 +257,8 @@ static llvm::StructType *makeLibraryHeaderType(llvm::LLVMContext &context) {
 //   %struct.iree_hal_executable_library_header_t*,
 //   %struct.iree_hal_executable_import_table_v0_t,
 //   %struct.iree_hal_executable_export_table_v0_t,
+//   %struct.iree_hal_executable_constant_table_v0_t,
+//   %struct.iree_hal_executable_roofline_v0_t*,
 // }
 static llvm::StructType *makeLibraryType(llvm::StructType *libraryHeaderType) {
   auto &context = libraryHeaderType->getContext();
@@ -247,12 +269,14 @@ static llvm::StructType *makeLibraryType(llvm::StructType *libraryHeaderType) {
   auto *importTableType = makeImportTableType(context);
   auto *exportTableType = makeExportTableType(context);
   auto *constantTableType = makeConstantTableType(context);
+  auto *rooflineType = makeRooflineType(context);
   auto *type = llvm::StructType::create(context,
                                         {
                                             libraryHeaderType->getPointerTo(),
                                             importTableType,
                                             exportTableType,
                                             constantTableType,
+                                            rooflineType->getPointerTo(),
                                         },
                                         "iree_hal_executable_library_v0_t",
                                         /*isPacked=*/false);
@@ -524,12 +548,57 @@ llvm::Constant *LibraryBuilder::buildLibraryV0ConstantTable(
                          });
 }
 
+llvm::Constant *LibraryBuilder::buildLibraryV0RooflineTable(
+    std::string libraryName) {
+  auto &context = module->getContext();
+  auto *rooflineType = makeRooflineType(context);
+  auto *i32Type = llvm::IntegerType::getInt32Ty(context);
+  auto *i64Type = llvm::IntegerType::getInt64Ty(context);
+  llvm::Constant *zero = llvm::ConstantInt::get(i32Type, 0);
+
+  // iree_hal_executable_library_v0_t::rooflines
+  bool hasRooflines = llvm::any_of(exports, [](const Dispatch &dispatch) {
+    return !dispatch.roofline.isDefault();
+  });
+  if (!hasRooflines) {
+    return llvm::Constant::getNullValue(rooflineType->getPointerTo());
+  }
+  SmallVector<llvm::Constant *, 4> rooflineValues;
+  for (auto dispatch : exports) {
+    rooflineValues.push_back(llvm::ConstantStruct::get(
+        rooflineType,
+        {
+            // flop_count=
+            llvm::ConstantInt::get(i64Type, dispatch.roofline.flopCount),
+            // byte_count=
+            llvm::ConstantInt::get(i64Type, dispatch.roofline.byteCount),
+        }));
+  }
+  auto *rooflinesType =
+      llvm::ArrayType::get(rooflineType, rooflineValues.size());
+  auto *global = new llvm::GlobalVariable(
+      *module, rooflinesType, /*isConstant=*/true,
+      llvm::GlobalVariable::PrivateLinkage,
+      llvm::ConstantArray::get(rooflinesType, rooflineValues),
+      /*Name=*/libraryName + "_rooflines");
+  return llvm::ConstantExpr::getInBoundsGetElementPtr(
+      rooflinesType, global, ArrayRef<llvm::Constant *>{zero, zero});
+}
+
 llvm::Constant *LibraryBuilder::buildLibraryV0(std::string libraryName) {
   auto &context = module->getContext();
   auto *libraryHeaderType = makeLibraryHeaderType(context);
   auto *libraryType = makeLibraryType(libraryHeaderType);
   auto *i32Type = llvm::IntegerType::getInt32Ty(context);
 
+  // The roofline table trails the library struct and is only read by runtimes
+  // when the header declares the feature.
+  auto *rooflineTable = buildLibraryV0RooflineTable(libraryName);
+  auto libraryFeatures = static_cast<uint32_t>(features);
+  if (!rooflineTable->isNullValue()) {
+    libraryFeatures |= static_cast<uint32_t>(Features::ROOFLINE);
+  }
+
   // ----- Header -----
 
   auto *libraryHeader = new llvm::GlobalVariable(
@@ -544,7 +613,7 @@ llvm::Constant *LibraryBuilder::buildLibraryV0(std::string libraryName) {
               // name=
               getStringConstant(module->getName(), module),
               // features=
-              llvm::ConstantInt::get(i32Type, static_cast<int64_t>(features)),
+              llvm::ConstantInt::get(i32Type, libraryFeatures),
               // sanitizer=
               llvm::ConstantInt::get(i32Type,
                                      static_cast<int64_t>(sanitizerKind)),
@@ -567,6 +636,8 @@ llvm::Constant *LibraryBuilder::buildLibraryV0(std::string libraryName) {
                                     buildLibraryV0ExportTable(libraryName),
                                     // constants=
                                     buildLibraryV0ConstantTable(libraryName),
+                                    // rooflines=
+                                    rooflineTable,
                                 }),
       /*Name=*/libraryName);
   // TODO(benvanik): force alignment (8? natural pointer width?)
@@ -28,7 +28,8 @@ namespace HAL {
 // Usage:
 //  LibraryBuilder builder(&module);
 //  builder.addExport(
-//     "hello", "source.mlir", 123, "test tag", DispatchAttrs{}, &helloFunc);
+//     "hello", "source.mlir", 123, "test tag", DispatchAttrs{},
+//     DispatchRoofline{}, &helloFunc);
 //  ...
 //  auto *queryFunc = builder.build("_query_library_foo");
 //  // call queryFunc, export it, etc
@@ -59,6 +60,8 @@ class LibraryBuilder {
   enum class Features : uint32_t {
     // IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_NONE
     NONE = 0u,
+    // IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_ROOFLINE
+    ROOFLINE = 1u << 0,
   };
 
   // iree_hal_executable_library_sanitizer_kind_t
@@ -87,6 +90,19 @@ class LibraryBuilder {
     constexpr bool isDefault() const { return localMemorySize == 0; }
   };
 
+  // iree_hal_executable_roofline_v0_t
+  struct DispatchRoofline {
+    // Total arithmetic operations performed by the dispatch or 0 if unknown.
+    uint64_t flopCount = 0;
+    // Minimum bytes read from and written to bindings or 0 if unknown.
+    uint64_t byteCount = 0;
+
+    // True if all values are unknown and the roofline may be omitted.
+    constexpr bool isDefault() const {
+      return flopCount == 0 && byteCount == 0;
+    }
+  };
+
   LibraryBuilder(llvm::Module *module, Mode mode,
                  Version version = Version::LATEST)
       : module(module), mode(mode), version(version) {}
@@ -114,10 +130,12 @@ class LibraryBuilder {
   // |name| will be used as the library export
   // |sourceFile| and |sourceLoc| are optional source information
   // |tag| is an optional attachment
+  // |roofline| is the optional static cost of the dispatch
   void addExport(StringRef name, StringRef sourceFile, uint32_t sourceLoc,
-                 StringRef tag, DispatchAttrs attrs, llvm::Function *func) {
-    exports.push_back(
-        {name.str(), sourceFile.str(), sourceLoc, tag.str(), attrs, func});
+                 StringRef tag, DispatchAttrs attrs, DispatchRoofline roofline,
+                 llvm::Function *func) {
+    exports.push_back({name.str(), sourceFile.str(), sourceLoc, tag.str(),
+                       attrs, roofline, func});
   }
 
   // Builds a `iree_hal_executable_library_query_fn_t` with the given
@@ -136,6 +154,7 @@ class LibraryBuilder {
   llvm::Constant *buildLibraryV0ImportTable(std::string libraryName);
   llvm::Constant *buildLibraryV0ExportTable(std::string libraryName);
   llvm::Constant *buildLibraryV0ConstantTable(std::string libraryName);
+  llvm::Constant *buildLibraryV0RooflineTable(std::string libraryName);
 
   llvm::Module *module = nullptr;
   Mode mode = Mode::INCLUDE_REFLECTION_ATTRS;
@@ -155,6 +174,7 @@ class LibraryBuilder {
     uint32_t sourceLoc;
     std::string tag;
     DispatchAttrs attrs;
+    DispatchRoofline roofline;
     llvm::Function *func;
   };
   SmallVector<Dispatch> exports;
@@ -64,6 +64,15 @@ void TargetOptions::bindOptions(OptionsBinder &binder) {
       llvm::cl::desc(
           "Path to write translated and serialized executable binaries into."),
       llvm::cl::cat(halTargetOptionsCategory));
+
+  binder.opt<std::string>(
+      "iree-hal-executable-cache-path", executableCachePath,
+      llvm::cl::desc(
+          "Path to a content-addressed cache of translated and serialized "
+          "executables reused across compiler invocations. Executables whose "
+          "IR, target, compiler build, and flags are unchanged are loaded "
+          "from the cache instead of being recompiled."),
+      llvm::cl::cat(halTargetOptionsCategory));
 }
 
 void dumpDataToPath(StringRef path, StringRef baseName, StringRef suffix,
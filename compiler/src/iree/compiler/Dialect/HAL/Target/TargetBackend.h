@@ -52,6 +52,10 @@ struct TargetOptions {
   // A path to write translated and serialized executable binaries into.
   std::string executableBinariesPath;
 
+  // A path to a content-addressed cache of translated and serialized
+  // executables shared across compiler invocations. Empty to disable.
+  std::string executableCachePath;
+
   void bindOptions(OptionsBinder &binder);
   using FromFlags = OptionsFromFlags<TargetOptions>;
 };
@@ -245,6 +249,13 @@ class TargetBackend {
     assert(false && "unimplemented serializeExecutable");
     return failure();
   }
+
+  // Prints the backend configuration that influences translation or
+  // serialization but is not captured in the executable IR, such as the
+  // resolved backend target options and the contents of external databases.
+  // The output is hashed into the executable cache keys so that entries
+  // produced under a different configuration are not reused.
+  virtual void printExecutableCacheConfiguration(llvm::raw_ostream &os) const {}
 };
 
 // Dumps binary data to a file formed by joining the given path components:
@@ -213,12 +213,25 @@ static void appendDispatchBenchmark(IREE::HAL::ExecutableOp executableOp,
   // Mark the function as being a dispatch benchmark.
   // This tells iree-benchmark-module to pass in the arguments we need.
   funcOp->setAttr("iree.abi.stub", moduleBuilder.getUnitAttr());
-  funcOp->setAttr(
-      "iree.reflection",
-      moduleBuilder.getDictionaryAttr({
-          moduleBuilder.getNamedAttr("iree.benchmark",
-                                     moduleBuilder.getStringAttr("dispatch")),
-      }));
+  SmallVector<NamedAttribute> reflectionAttrs = {
+      moduleBuilder.getNamedAttr("iree.benchmark",
+                                 moduleBuilder.getStringAttr("dispatch")),
+  };
+
+  // Pass along the static dispatch cost, if known, so that the achieved
+  // throughput can be reported relative to the machine peak.
+  if (auto rooflineAttr =
+          exportOp->getAttrOfType<DictionaryAttr>("iree.roofline")) {
+    for (auto namedAttr : rooflineAttr) {
+      auto valueAttr = llvm::dyn_cast<IntegerAttr>(namedAttr.getValue());
+      if (!valueAttr) continue;
+      reflectionAttrs.push_back(moduleBuilder.getNamedAttr(
+          ("iree.roofline." + namedAttr.getName().strref()).str(),
+          moduleBuilder.getStringAttr(std::to_string(valueAttr.getInt()))));
+    }
+  }
+  funcOp->setAttr("iree.reflection",
+                  moduleBuilder.getDictionaryAttr(reflectionAttrs));
 
   // Build the function that runs the dispatches.
   auto *entryBlock = funcOp.addEntryBlock();
@@ -227,6 +227,9 @@ static mlir::func::FuncOp cloneFuncWithInterface(
   // Clone so that we can do a bunch of unsafe in-place updates.
   auto clonedFuncOp = sourceFuncOp.clone();
 
+  // The static dispatch cost now lives on the export.
+  clonedFuncOp->removeAttr("iree.roofline");
+
   // Strip all arguments as functions take all I/O through the interface API.
   clonedFuncOp.setType(FunctionType::get(clonedFuncOp.getContext(), {}, {}));
 
@@ -338,6 +341,12 @@ static LogicalResult declareEntryPointOps(
           /*subgroup_size=*/IntegerAttr{},
           /*workgroup_local_memory=*/IntegerAttr{});
 
+      // Carry over the static dispatch cost so that targets can embed it in
+      // their executable metadata.
+      if (auto rooflineAttr = sourceFuncOp->getAttr("iree.roofline")) {
+        newExportOp->setAttr("iree.roofline", rooflineAttr);
+      }
+
       // Map the original export name to the new variant export.
       entryPointExpansions[SymbolRefAttr::get(sourceExecutableOp.getNameAttr(),
                                               {FlatSymbolRefAttr::get(
@@ -61,6 +61,14 @@ static llvm::cl::opt<llvm::cl::PowerOf2ByteSize> clInstrumentDispatchBufferSize{
     llvm::cl::init(llvm::cl::PowerOf2ByteSize(0)),
 };
 
+static llvm::cl::opt<bool> clInlineFuncs{
+    "iree-hal-inline-funcs",
+    llvm::cl::desc(
+        "Inlines small and single-use functions during whole-program "
+        "optimization using the budgets of the iree-util-inline-funcs pass."),
+    llvm::cl::init(false),
+};
+
 static llvm::cl::list<std::string> clSubstituteExecutableSource{
     "iree-hal-substitute-executable-source",
     llvm::cl::desc(
@@ -243,7 +251,8 @@ void buildHALTransformPassPipeline(OpPassManager &passManager,
   // After this point the executables are opaque blobs and we cannot change
   // their interfaces.
   passManager.addNestedPass<IREE::HAL::ExecutableOp>(
-      createTranslateExecutablesPass(targetRegistry));
+      createTranslateExecutablesPass(targetRegistry,
+                                     targetOptions.executableCachePath));
 
   if (compileTo == PipelinePhase::ExecutableTargets) return;
 
@@ -345,7 +354,8 @@ void buildHALTransformPassPipeline(OpPassManager &passManager,
         createSerializeExecutablesPass(
             targetRegistry, targetOptions.debugLevel,
             targetOptions.executableIntermediatesPath,
-            targetOptions.executableBinariesPath));
+            targetOptions.executableBinariesPath,
+            targetOptions.executableCachePath));
 
     // NOTE: symbol DCE will destroy executable target contents, so only run it
     // if we serialized things.
@@ -367,6 +377,13 @@ void buildHALTransformPassPipeline(OpPassManager &passManager,
     // IPO and other cleanups.
     addCleanupPatterns(ipoPipeline);
 
+    // Inline small wrapper functions and those with a single caller so that
+    // IPO and global folding can see across the calls and we avoid the
+    // runtime call overhead.
+    if (clInlineFuncs) {
+      ipoPipeline.addPass(IREE::Util::createInlineFuncsPass());
+    }
+
     // Large IPO pass. Note that this can introduce a significant amount of
     // duplication/inlined constants and we'll want to ensure we're running
     // cleanup again after (this entire set of patterns is run in a fixed-point
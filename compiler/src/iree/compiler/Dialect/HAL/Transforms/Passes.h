@@ -131,8 +131,11 @@ std::unique_ptr<OperationPass<IREE::HAL::ExecutableOp>>
 createPreprocessExecutablesWithToolPass(std::string command);
 
 // Translates hal.executable.variant ops via a nested translation pipeline.
+// If |cachePath| is provided translated variants are reused from and stored
+// into a content-addressed cache at that path.
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableOp>>
-createTranslateExecutablesPass(const TargetBackendRegistry &targetRegistry);
+createTranslateExecutablesPass(const TargetBackendRegistry &targetRegistry,
+                               std::string cachePath = "");
 
 // Translates hal.executable.variant ops for the specified |target| backend.
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableVariantOp>>
@@ -155,18 +158,21 @@ std::unique_ptr<OperationPass<mlir::ModuleOp>>
 createResolveExportOrdinalsPass();
 
 // Converts hal.executable.variants to one or more hal.executable.binary ops.
+// If |cachePath| is provided serialized binaries are reused from and stored
+// into a content-addressed cache at that path.
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableOp>>
 createSerializeExecutablesPass(const TargetBackendRegistry &targetRegistry,
                                int debugLevel = 2,
                                std::string dumpIntermediatesPath = "",
-                               std::string dumpBinariesPath = "");
+                               std::string dumpBinariesPath = "",
+                               std::string cachePath = "");
 
 // Serializes executables for the specified |target| backend.
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableOp>>
 createSerializeTargetExecutablesPass(
     const TargetBackendRegistry &targetRegistry, StringRef target,
     int debugLevel = 2, std::string dumpIntermediatesPath = "",
-    std::string dumpBinariesPath = "");
+    std::string dumpBinariesPath = "", std::string cachePath = "");
 
 //===----------------------------------------------------------------------===//
 // Resource initialization, caching, and optimization
@@ -11,6 +11,7 @@
 #include "iree/compiler/Dialect/HAL/IR/HALOps.h"
 #include "iree/compiler/Dialect/HAL/Target/TargetBackend.h"
 #include "iree/compiler/Dialect/HAL/Target/TargetRegistry.h"
+#include "iree/compiler/Dialect/HAL/Utils/ExecutableCache.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Support/FileSystem.h"
 #include "mlir/IR/Attributes.h"
@@ -35,12 +36,14 @@ class SerializeTargetExecutablesPass
   SerializeTargetExecutablesPass(const TargetBackendRegistry &targetRegistry,
                                  StringRef target, int debugLevel,
                                  std::string dumpIntermediatesPath,
-                                 std::string dumpBinariesPath)
+                                 std::string dumpBinariesPath,
+                                 std::string cachePath)
       : targetRegistry(targetRegistry) {
     this->target = target.str();
     this->debugLevel = debugLevel;
     this->dumpIntermediatesPath = dumpIntermediatesPath;
     this->dumpBinariesPath = dumpBinariesPath;
+    this->cachePath = cachePath;
   }
 
   StringRef getArgument() const override {
@@ -87,20 +90,75 @@ class SerializeTargetExecutablesPass
       llvm::sys::fs::create_directories(dumpBinariesPath);
     }
 
+    // The debug level changes the serialized output and must be part of the
+    // cache key.
+    ExecutableCache cache(cachePath);
+    std::string cacheStage = "serialize-" + std::to_string(debugLevel);
+    std::string cacheConfiguration;
+    if (cache.isEnabled()) {
+      llvm::raw_string_ostream os(cacheConfiguration);
+      targetBackend->printExecutableCacheConfiguration(os);
+    }
+
+    // Dumps are produced by the backend during serialization so we always
+    // serialize when they are requested. The results are still stored so that
+    // subsequent compilations without dumps can reuse them.
+    bool allowCacheHits =
+        dumpIntermediatesPath.empty() && dumpBinariesPath.empty();
+
     auto variantOps = llvm::to_vector<4>(
         executableOp.getBlock().getOps<IREE::HAL::ExecutableVariantOp>());
     for (auto variantOp : variantOps) {
       if (variantOp.getTarget().getBackend().getValue() != target) continue;
       OpBuilder executableBuilder(variantOp);
+
+      // Reuse the binaries serialized by a prior compilation if available.
+      std::string cacheKey;
+      if (cache.isEnabled()) {
+        cacheKey = cache.computeKey(cacheStage, target, cacheConfiguration,
+                                    variantOp);
+        auto cachedModuleOp =
+            allowCacheHits ? cache.lookup(executableOp.getContext(), cacheKey)
+                           : OwningOpRef<mlir::ModuleOp>();
+        if (cachedModuleOp) {
+          ++numCacheHits;
+          for (auto cachedExecutableOp :
+               cachedModuleOp->getOps<IREE::HAL::ExecutableOp>()) {
+            for (auto binaryOp :
+                 cachedExecutableOp.getOps<IREE::HAL::ExecutableBinaryOp>()) {
+              executableBuilder.clone(*binaryOp);
+            }
+          }
+          variantOp.erase();
+          continue;
+        }
+        ++numCacheMisses;
+      }
+
       // Ask the target backend to serialize the executable. Note that it
       // may create one or more hal.executable.binary ops in the case of
       // multi-architecture binaries.
+      Operation *prevOp = variantOp->getPrevNode();
       if (failed(targetBackend->serializeExecutable(
               serializationOptions, variantOp, executableBuilder))) {
         variantOp.emitError()
             << "failed to serialize executable for target backend " << target;
         return signalPassFailure();
       }
+
+      // Everything the backend inserted before the variant is the result of
+      // serialization.
+      if (cache.isEnabled()) {
+        SmallVector<Operation *> serializedOps;
+        for (Operation *op = prevOp ? prevOp->getNextNode()
+                                    : &executableOp.getBlock().front();
+             op != variantOp.getOperation(); op = op->getNextNode()) {
+          serializedOps.push_back(op);
+        }
+        cache.store(cacheKey, executableOp.getName(), executableOp.getLoc(),
+                    serializedOps);
+      }
+
       variantOp.erase();
     }
   }
@@ -123,6 +181,16 @@ class SerializeTargetExecutablesPass
       *this, "dump-binaries-path",
       llvm::cl::desc("Path to write translated and serialized executable "
                      "binaries into for debugging.")};
+  Option<std::string> cachePath{
+      *this, "cache-path",
+      llvm::cl::desc("Path to a content-addressed cache of serialized "
+                     "executable binaries; empty to disable caching.")};
+
+  Statistic numCacheHits{this, "cache hit(s)",
+                         "Number of variants loaded from the executable cache"};
+  Statistic numCacheMisses{
+      this, "cache miss(es)",
+      "Number of variants serialized with the executable cache enabled"};
 
   const TargetBackendRegistry &targetRegistry;
 };
@@ -131,10 +199,10 @@ std::unique_ptr<OperationPass<IREE::HAL::ExecutableOp>>
 createSerializeTargetExecutablesPass(
     const TargetBackendRegistry &targetRegistry, StringRef target,
     int debugLevel, std::string dumpIntermediatesPath,
-    std::string dumpBinariesPath) {
+    std::string dumpBinariesPath, std::string cachePath) {
   return std::make_unique<SerializeTargetExecutablesPass>(
       targetRegistry, target, debugLevel, dumpIntermediatesPath,
-      dumpBinariesPath);
+      dumpBinariesPath, cachePath);
 }
 
 static PassRegistration<SerializeTargetExecutablesPass> linkTargetPass([] {
@@ -149,11 +217,12 @@ class SerializeExecutablesPass
       : targetRegistry(TargetBackendRegistry::getGlobal()) {}
   SerializeExecutablesPass(const TargetBackendRegistry &targetRegistry,
                            int debugLevel, std::string dumpIntermediatesPath,
-                           std::string dumpBinariesPath)
+                           std::string dumpBinariesPath, std::string cachePath)
       : targetRegistry(targetRegistry),
         debugLevel(debugLevel),
         dumpIntermediatesPath(dumpIntermediatesPath),
-        dumpBinariesPath(dumpBinariesPath) {}
+        dumpBinariesPath(dumpBinariesPath),
+        cachePath(cachePath) {}
 
   StringRef getArgument() const override {
     return "iree-hal-serialize-executables";
@@ -169,7 +238,7 @@ class SerializeExecutablesPass
     for (const auto &targetName : gatherExecutableTargetNames(executableOp)) {
       passManager.addPass(createSerializeTargetExecutablesPass(
           targetRegistry, targetName, debugLevel, dumpIntermediatesPath,
-          dumpBinariesPath));
+          dumpBinariesPath, cachePath));
     }
     if (failed(runPipeline(passManager, executableOp))) {
       executableOp.emitError() << "failed to serialize executables";
@@ -182,15 +251,18 @@ class SerializeExecutablesPass
   int debugLevel;
   std::string dumpIntermediatesPath;
   std::string dumpBinariesPath;
+  std::string cachePath;
 };
 
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableOp>>
 createSerializeExecutablesPass(const TargetBackendRegistry &targetRegistry,
                                int debugLevel,
                                std::string dumpIntermediatesPath,
-                               std::string dumpBinariesPath) {
+                               std::string dumpBinariesPath,
+                               std::string cachePath) {
   return std::make_unique<SerializeExecutablesPass>(
-      targetRegistry, debugLevel, dumpIntermediatesPath, dumpBinariesPath);
+      targetRegistry, debugLevel, dumpIntermediatesPath, dumpBinariesPath,
+      cachePath);
 }
 
 static PassRegistration<SerializeExecutablesPass> linkPass([] {
@@ -11,6 +11,7 @@
 #include "iree/compiler/Dialect/HAL/IR/HALOps.h"
 #include "iree/compiler/Dialect/HAL/Target/TargetBackend.h"
 #include "iree/compiler/Dialect/HAL/Target/TargetRegistry.h"
+#include "iree/compiler/Dialect/HAL/Utils/ExecutableCache.h"
 #include "iree/compiler/Utils/TracingUtils.h"
 #include "llvm/ADT/StringSet.h"
 #include "mlir/Dialect/Bufferization/IR/Bufferization.h"
@@ -105,8 +106,11 @@ class TranslateExecutablesPass
       : targetRegistry(TargetBackendRegistry::getGlobal()) {}
   TranslateExecutablesPass(const TranslateExecutablesPass &pass)
       : targetRegistry(pass.targetRegistry) {}
-  TranslateExecutablesPass(const TargetBackendRegistry &targetRegistry)
-      : targetRegistry(targetRegistry) {}
+  TranslateExecutablesPass(const TargetBackendRegistry &targetRegistry,
+                           std::string cachePath)
+      : targetRegistry(targetRegistry) {
+    this->cachePath = std::move(cachePath);
+  }
 
   StringRef getArgument() const override {
     return "iree-hal-translate-executables";
@@ -128,27 +132,93 @@ class TranslateExecutablesPass
 
   void runOnOperation() override {
     auto executableOp = getOperation();
+    IREE_COMPILER_TRACE_MESSAGE_DYNAMIC(INFO, executableOp.getSymName().str());
+
+    if (!cachePath.empty()) {
+      if (failed(translateVariantsWithCache(executableOp))) {
+        return signalPassFailure();
+      }
+      return;
+    }
+
     OpPassManager passManager(executableOp.getOperationName());
     for (const auto &targetName : gatherExecutableTargetNames(executableOp)) {
       passManager.addNestedPass<IREE::HAL::ExecutableVariantOp>(
           createTranslateTargetExecutableVariantsPass(targetRegistry,
                                                       targetName));
     }
-
-    IREE_COMPILER_TRACE_MESSAGE_DYNAMIC(INFO, executableOp.getSymName().str());
-
     if (failed(runPipeline(passManager, executableOp))) {
       executableOp.emitError() << "failed to serialize executables";
       return signalPassFailure();
     }
   }
 
+ private:
+  // Translates each variant individually, reusing translated variants from
+  // the executable cache when the variant IR is unchanged from a prior
+  // compilation and populating the cache otherwise.
+  LogicalResult translateVariantsWithCache(
+      IREE::HAL::ExecutableOp executableOp) {
+    ExecutableCache cache(cachePath);
+    auto variantOps = llvm::to_vector(
+        executableOp.getBlock().getOps<IREE::HAL::ExecutableVariantOp>());
+    for (auto variantOp : variantOps) {
+      auto targetName = variantOp.getTarget().getBackend().getValue();
+      std::string targetConfiguration;
+      if (auto targetBackend = targetRegistry.getTargetBackend(targetName)) {
+        llvm::raw_string_ostream os(targetConfiguration);
+        targetBackend->printExecutableCacheConfiguration(os);
+      }
+      auto key = cache.computeKey("translate", targetName, targetConfiguration,
+                                  variantOp);
+
+      // Substitute the previously translated variant if present.
+      if (auto cachedModuleOp = cache.lookup(&getContext(), key)) {
+        IREE::HAL::ExecutableVariantOp cachedVariantOp;
+        cachedModuleOp->walk([&](IREE::HAL::ExecutableVariantOp op) {
+          if (op.getSymName() == variantOp.getSymName()) cachedVariantOp = op;
+        });
+        if (cachedVariantOp) {
+          OpBuilder(variantOp).clone(*cachedVariantOp);
+          variantOp.erase();
+          ++numCacheHits;
+          continue;
+        }
+      }
+      ++numCacheMisses;
+
+      OpPassManager passManager(variantOp.getOperationName());
+      passManager.addPass(
+          createTranslateTargetExecutableVariantsPass(targetRegistry,
+                                                      targetName));
+      if (failed(runPipeline(passManager, variantOp))) {
+        return executableOp.emitError() << "failed to serialize executables";
+      }
+      cache.store(key, executableOp.getName(), executableOp.getLoc(),
+                  {variantOp});
+    }
+    return success();
+  }
+
+  Option<std::string> cachePath{
+      *this, "cache-path",
+      llvm::cl::desc("Path to a content-addressed cache of translated "
+                     "executable variants; empty to disable caching.")};
+
+  Statistic numCacheHits{this, "cache hit(s)",
+                         "Number of variants loaded from the executable cache"};
+  Statistic numCacheMisses{
+      this, "cache miss(es)",
+      "Number of variants translated with the executable cache enabled"};
+
   const TargetBackendRegistry &targetRegistry;
 };
 
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableOp>>
-createTranslateExecutablesPass(const TargetBackendRegistry &targetRegistry) {
-  return std::make_unique<TranslateExecutablesPass>(targetRegistry);
+createTranslateExecutablesPass(const TargetBackendRegistry &targetRegistry,
+                               std::string cachePath) {
+  return std::make_unique<TranslateExecutablesPass>(targetRegistry,
+                                                    std::move(cachePath));
 }
 
 static PassRegistration<TranslateExecutablesPass> translatePass([] {
@@ -28,6 +28,7 @@ module attributes {hal.device.targets = [#device_target_cpu]}  {
   hal.executable private @ex0 {
     hal.executable.variant public @embedded_elf_x86_64, target = #executable_target_embedded_elf_x86_64_ {
       hal.executable.export public @dispatch0 ordinal(0) layout(#pipeline_layout_0) attributes {
+        iree.roofline = {bytes = 96 : i64, flops = 8 : i64},
         translation_info = #iree_codegen.translation_info<CPUDefault>
       } {
       ^bb0(%device: !hal.device, %arg0: index):
@@ -67,7 +68,7 @@ module attributes {hal.device.targets = [#device_target_cpu]}  {
   // CHECK-NEXT: util.global.store %[[BUFFER]], @ex0_embedded_elf_x86_64_dispatch0_512_buffer : !hal.buffer
 
   // CHECK: func.func @ex0_embedded_elf_x86_64_dispatch0_512(%arg0: i32)
-  // CHECK-SAME: attributes {iree.abi.stub, iree.reflection = {iree.benchmark = "dispatch"}} {
+  // CHECK-SAME: attributes {iree.abi.stub, iree.reflection = {iree.benchmark = "dispatch", iree.roofline.bytes = "96", iree.roofline.flops = "8"}} {
   // CHECK: %[[BATCH_SIZE:.+]] = arith.index_cast %arg0 : i32 to index
 
   // Create command buffer:
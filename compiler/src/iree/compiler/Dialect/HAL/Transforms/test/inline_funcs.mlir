@@ -0,0 +1,28 @@
+// RUN: iree-opt --iree-hal-transformation-pipeline --iree-hal-target-backends=vmvx --iree-hal-inline-funcs %s | FileCheck %s --check-prefix=INLINE
+// RUN: iree-opt --iree-hal-transformation-pipeline --iree-hal-target-backends=vmvx %s | FileCheck %s --check-prefix=NOINLINE
+
+// Tests that small functions are only inlined during whole-program
+// optimization when enabled.
+
+// INLINE-NOT: func.func private @small_callee
+// NOINLINE: func.func private @small_callee
+func.func private @small_callee(%arg0: index, %arg1: index) -> index {
+  %0 = arith.addi %arg0, %arg1 : index
+  %1 = arith.muli %0, %arg1 : index
+  return %1 : index
+}
+
+// INLINE-LABEL: func.func @caller
+// NOINLINE-LABEL: func.func @caller
+func.func @caller(%arg0: index, %arg1: index) -> index {
+  // INLINE-NOT: call
+  // INLINE: arith.addi
+  // INLINE: arith.muli
+  // INLINE: arith.addi
+  // INLINE: arith.muli
+  // NOINLINE: call @small_callee
+  %0 = call @small_callee(%arg0, %arg1) : (index, index) -> index
+  // NOINLINE: call @small_callee
+  %1 = call @small_callee(%0, %arg1) : (index, index) -> index
+  return %1 : index
+}
@@ -0,0 +1,205 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/HAL/Utils/ExecutableCache.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif  // _WIN32
+
+#include "iree/compiler/Tools/version.h"
+#include "iree/compiler/Utils/OptionUtils.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Chrono.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA256.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/Parser/Parser.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace HAL {
+
+// Bump when the cache entry format or key derivation changes.
+static constexpr char kCacheVersion[] = "iree-hal-executable-cache-v2";
+
+namespace {
+
+// Streams everything written to it into a SHA256 hasher so that large IR can
+// be hashed without materializing it as a string.
+class HashingOStream : public llvm::raw_ostream {
+ public:
+  explicit HashingOStream(llvm::SHA256 &hasher) : hasher(hasher) {}
+  ~HashingOStream() override { flush(); }
+
+ private:
+  void write_impl(const char *ptr, size_t size) override {
+    hasher.update(StringRef(ptr, size));
+    position += size;
+  }
+  uint64_t current_pos() const override { return position; }
+
+  llvm::SHA256 &hasher;
+  uint64_t position = 0;
+};
+
+}  // namespace
+
+// Returns the path of the binary containing the compiler. This is the
+// libIREECompiler shared library when the compiler is used through it and the
+// main executable when the compiler is linked statically.
+static std::string getCompilerBinaryPath() {
+  static int anchor = 0;
+#if defined(_WIN32)
+  HMODULE module = nullptr;
+  if (GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS |
+                             GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                         reinterpret_cast<LPCSTR>(&anchor), &module)) {
+    char modulePath[MAX_PATH];
+    DWORD length = GetModuleFileNameA(module, modulePath, MAX_PATH);
+    if (length > 0 && length < MAX_PATH) {
+      return std::string(modulePath, length);
+    }
+  }
+#else
+  Dl_info info;
+  if (dladdr(&anchor, &info) && info.dli_fname) {
+    return info.dli_fname;
+  }
+#endif  // _WIN32
+  return llvm::sys::fs::getMainExecutable(nullptr, &anchor);
+}
+
+// Returns a string identifying the running compiler build. The revision is
+// only available in release builds so we also use the path, size, and
+// modification time of the compiler binary so that rebuilding the compiler
+// invalidates all entries produced by the prior build.
+static StringRef getCompilerIdentity() {
+  static const std::string identity = []() {
+    std::string value = kCacheVersion;
+    value += ":" + getIreeRevision();
+    std::string binaryPath = getCompilerBinaryPath();
+    llvm::sys::fs::file_status status;
+    if (!binaryPath.empty() && !llvm::sys::fs::status(binaryPath, status)) {
+      value += ":" + binaryPath;
+      value += ":" + std::to_string(status.getSize());
+      value += ":" + std::to_string(llvm::sys::toTimeT(
+                         status.getLastModificationTime()));
+    }
+    return value;
+  }();
+  return identity;
+}
+
+// Returns true if |flag| only controls where compiler outputs are written and
+// does not change the artifacts produced.
+static bool isOutputLocationFlag(StringRef flag) {
+  StringRef name = flag.drop_front(2).split('=').first;
+  return name == "o" || name == "iree-hal-executable-cache-path" ||
+         name.starts_with("iree-hal-dump-executable-");
+}
+
+ExecutableCache::ExecutableCache(StringRef path) : path(path.str()) {
+  if (!this->path.empty()) {
+    llvm::sys::fs::create_directories(this->path);
+  }
+}
+
+std::string ExecutableCache::computeKey(StringRef stage, StringRef target,
+                                        StringRef targetConfiguration,
+                                        Operation *op) {
+  llvm::SHA256 hasher;
+  {
+    HashingOStream os(hasher);
+    os << getCompilerIdentity() << '\0' << stage << '\0' << target << '\0';
+    for (auto &flag : getGlobalCommandLineFlags()) {
+      if (!isOutputLocationFlag(flag)) os << flag << '\0';
+    }
+    os << targetConfiguration << '\0';
+    // Locations are excluded so that unrelated source changes that shift line
+    // numbers don't invalidate entries. Cached artifacts retain the locations
+    // from when they were produced.
+    op->print(os,
+              OpPrintingFlags().enableDebugInfo(false).printGenericOpForm());
+  }
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+std::string ExecutableCache::getEntryPath(StringRef key) const {
+  SmallString<256> entryPath(path);
+  llvm::sys::path::append(entryPath, key + ".mlirbc");
+  return std::string(entryPath);
+}
+
+OwningOpRef<mlir::ModuleOp> ExecutableCache::lookup(MLIRContext *context,
+                                                    StringRef key) {
+  if (!isEnabled()) return {};
+  auto entryPath = getEntryPath(key);
+  if (!llvm::sys::fs::exists(entryPath)) return {};
+  ParserConfig parserConfig(context);
+  auto moduleOp = parseSourceFile<mlir::ModuleOp>(entryPath, parserConfig);
+  if (!moduleOp) {
+    llvm::errs() << "WARNING: ignoring unreadable executable cache entry `"
+                 << entryPath << "`\n";
+    return {};
+  }
+  return moduleOp;
+}
+
+void ExecutableCache::store(StringRef key, StringRef executableName,
+                            Location executableLoc, ArrayRef<Operation *> ops) {
+  if (!isEnabled()) return;
+
+  // Build a standalone module with an executable holding the artifacts.
+  OwningOpRef<mlir::ModuleOp> moduleOp(mlir::ModuleOp::create(executableLoc));
+  OpBuilder builder = OpBuilder::atBlockBegin(moduleOp->getBody());
+  auto executableOp =
+      builder.create<IREE::HAL::ExecutableOp>(executableLoc, executableName);
+  builder.setInsertionPoint(&executableOp.getBlock().back());
+  for (auto *op : ops) builder.clone(*op);
+
+  // Write to a temporary file and rename it into place so concurrent readers
+  // never see partial entries.
+  auto entryPath = getEntryPath(key);
+  SmallString<256> tempPath;
+  int tempFd = -1;
+  if (auto ec = llvm::sys::fs::createUniqueFile(entryPath + ".%%%%%%%%.tmp",
+                                                tempFd, tempPath)) {
+    mlir::emitWarning(executableLoc)
+        << "failed to create executable cache entry `" << entryPath
+        << "`: " << ec.message();
+    return;
+  }
+  bool writeFailed = false;
+  {
+    llvm::raw_fd_ostream os(tempFd, /*shouldClose=*/true);
+    if (failed(writeBytecodeToFile(*moduleOp, os))) writeFailed = true;
+    os.flush();
+    if (os.has_error()) {
+      os.clear_error();
+      writeFailed = true;
+    }
+  }
+  if (writeFailed || llvm::sys::fs::rename(tempPath, entryPath)) {
+    mlir::emitWarning(executableLoc)
+        << "failed to write executable cache entry `" << entryPath << "`";
+    llvm::sys::fs::remove(tempPath);
+  }
+}
+
+}  // namespace HAL
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -0,0 +1,80 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_COMPILER_DIALECT_HAL_UTILS_EXECUTABLECACHE_H_
+#define IREE_COMPILER_DIALECT_HAL_UTILS_EXECUTABLECACHE_H_
+
+#include <string>
+
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Support/LogicalResult.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace HAL {
+
+// A content-addressed on-disk cache of executable compilation artifacts.
+//
+// Entries are keyed by a hash of:
+//   * the compilation stage and target backend;
+//   * the compiler build: its revision and the identity (path, size, and
+//     modification time) of the binary containing the compiler, which is
+//     libIREECompiler when built as a shared library;
+//   * the compiler configuration: the global command line flags (excluding
+//     those that only control where outputs are written) and the target
+//     backend configuration, which includes resolved target options and the
+//     contents of external inputs such as tuning databases;
+//   * the IR of the operation being compiled (excluding locations).
+// Values are MLIR bytecode files containing a `hal.executable` holding the
+// artifacts produced by the stage. Because the cache is keyed on content it
+// can be shared across compiler invocations and programs and only dispatches
+// that actually changed need to be recompiled.
+//
+// Thread-safe: entries are written to temporary files and atomically renamed
+// so that concurrent compilations sharing a cache path never observe partial
+// entries.
+class ExecutableCache {
+ public:
+  // Creates a cache rooted at |path|. An empty path disables the cache.
+  explicit ExecutableCache(StringRef path);
+
+  // Returns true if the cache is enabled.
+  bool isEnabled() const { return !path.empty(); }
+
+  // Computes the cache key for |op| compiled by |target| in |stage|.
+  // |targetConfiguration| is the backend configuration as printed by
+  // TargetBackend::printExecutableCacheConfiguration.
+  std::string computeKey(StringRef stage, StringRef target,
+                         StringRef targetConfiguration, Operation *op);
+
+  // Loads the cached `hal.executable` for |key|, if present. The returned
+  // module contains a single executable. Returns nullptr on cache misses or if
+  // the entry could not be parsed (in which case it is treated as a miss).
+  OwningOpRef<mlir::ModuleOp> lookup(MLIRContext *context, StringRef key);
+
+  // Stores clones of |ops| in a `hal.executable` named |executableName| under
+  // |key|. Failures are reported as warnings on |executableLoc| and do not
+  // affect compilation.
+  void store(StringRef key, StringRef executableName, Location executableLoc,
+             ArrayRef<Operation *> ops);
+
+ private:
+  std::string getEntryPath(StringRef key) const;
+
+  std::string path;
+};
+
+}  // namespace HAL
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
+
+#endif  // IREE_COMPILER_DIALECT_HAL_UTILS_EXECUTABLECACHE_H_
@@ -168,13 +168,16 @@ void PartitionSet::topologicalSort() {
 
 PartitionSet partitionStreamableOps(IREE::Stream::PartitioningConfigAttr config,
                                     Block *block) {
-  // Only one algorithm today.
+  // Stream formation is independent of the favor; see
+  // partitionRegionConcurrency for where favors diverge.
   return partitionStreamableOpsReference(config, block);
 }
 
 PartitionSet partitionRegionConcurrency(
     IREE::Stream::PartitioningConfigAttr config, Block *block) {
-  // Only one algorithm today.
+  if (config.getFavor().getValue() == IREE::Stream::Favor::Balanced) {
+    return partitionRegionConcurrencyCostModel(config, block);
+  }
   return partitionRegionConcurrencyReference(config, block);
 }
 
@@ -125,6 +125,19 @@ PartitionSet partitionStreamableOpsReference(
 PartitionSet partitionRegionConcurrencyReference(
     IREE::Stream::PartitioningConfigAttr config, Block *block);
 
+//===----------------------------------------------------------------------===//
+// Cost-model partitioning
+//===----------------------------------------------------------------------===//
+
+// Levelized wave scheduling within partitioned streams using estimated op
+// execution costs and resource footprints. The number of waves (and barriers)
+// is fixed to the critical path through the hazards in the block and ops with
+// slack are placed in the wave that best hides their execution behind other
+// work, shortens the live ranges of the resources they produce and consume,
+// and avoids opening waves that would otherwise be empty.
+PartitionSet partitionRegionConcurrencyCostModel(
+    IREE::Stream::PartitioningConfigAttr config, Block *block);
+
 }  // namespace Stream
 }  // namespace IREE
 }  // namespace iree_compiler
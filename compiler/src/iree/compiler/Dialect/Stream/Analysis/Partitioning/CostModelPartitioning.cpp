@@ -0,0 +1,323 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <algorithm>
+#include <limits>
+
+#include "iree/compiler/Dialect/Stream/Analysis/Partitioning.h"
+#include "iree/compiler/Dialect/Stream/Analysis/ResourceHazards.h"
+#include "iree/compiler/Dialect/Stream/IR/StreamOps.h"
+#include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include "mlir/IR/AsmState.h"
+#include "mlir/IR/Matchers.h"
+
+#define DEBUG_TYPE "iree-stream-partitioning"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Stream {
+
+// Byte size assumed for resources and ranges with dynamic sizes. This only
+// needs to be large enough that dynamically-sized work does not look free
+// relative to small statically-sized work.
+static constexpr int64_t kDynamicSizeEstimate = 64 * 1024;
+
+// Cost of an additional barrier between waves in the same units as op costs
+// (bytes touched). Placing an op into an otherwise empty wave must save at
+// least this much to be worth the extra synchronization.
+static constexpr int64_t kBarrierCost = 256 * 1024;
+
+static int64_t estimateSize(Value sizeValue) {
+  if (!sizeValue) return 0;
+  APInt size;
+  if (matchPattern(sizeValue, m_ConstantInt(&size))) {
+    return size.getSExtValue();
+  }
+  return kDynamicSizeEstimate;
+}
+
+namespace {
+
+// Estimated costs of executing a single op.
+struct OpCost {
+  // Approximate execution time in bytes touched (or invocations for dispatches
+  // that touch less memory than they have work).
+  int64_t execution = 0;
+  // Bytes of new storage produced by the op. Results tied to operands reuse
+  // the operand storage and are excluded.
+  int64_t producedBytes = 0;
+  // Bytes of storage produced within the region that are dead after the op
+  // executes as it is their only user.
+  int64_t releasedBytes = 0;
+};
+
+}  // namespace
+
+static OpCost estimateOpCost(Operation *op) {
+  OpCost cost;
+
+  if (auto accessOp = dyn_cast<IREE::Stream::AsyncAccessOpInterface>(op)) {
+    SmallVector<AsyncAccessRange> ranges;
+    accessOp.getAsyncAccessRanges(ranges);
+    for (auto &range : ranges) {
+      cost.execution += estimateSize(range.length);
+    }
+  }
+  if (auto dispatchOp = dyn_cast<IREE::Stream::AsyncDispatchOp>(op)) {
+    uint64_t invocationCount = 1;
+    for (auto workload : dispatchOp.getWorkload()) {
+      invocationCount = llvm::SaturatingMultiply(
+          invocationCount, static_cast<uint64_t>(estimateSize(workload)));
+    }
+    invocationCount = std::min<uint64_t>(
+        invocationCount, std::numeric_limits<int32_t>::max());
+    cost.execution =
+        std::max(cost.execution, static_cast<int64_t>(invocationCount));
+  }
+
+  auto sizeAwareOp = dyn_cast<IREE::Util::SizeAwareOpInterface>(op);
+  if (!sizeAwareOp) return cost;
+  auto tiedOp = dyn_cast<IREE::Util::TiedOpInterface>(op);
+  for (auto result : op->getResults()) {
+    if (!llvm::isa<IREE::Stream::ResourceType>(result.getType())) continue;
+    if (tiedOp && tiedOp.getTiedResultOperand(result)) continue;
+    cost.producedBytes +=
+        estimateSize(sizeAwareOp.getResultSize(result.getResultNumber()));
+  }
+  for (auto &operand : op->getOpOperands()) {
+    auto value = operand.get();
+    if (!llvm::isa<IREE::Stream::ResourceType>(value.getType())) continue;
+    if (tiedOp && tiedOp.isOperandTied(operand.getOperandNumber())) continue;
+    // Captured resources (block arguments) live for the entire region.
+    auto *definingOp = value.getDefiningOp();
+    if (!definingOp || definingOp->getBlock() != op->getBlock()) continue;
+    if (!value.hasOneUse()) continue;
+    cost.releasedBytes +=
+        estimateSize(sizeAwareOp.getOperandSize(operand.getOperandNumber()));
+  }
+  return cost;
+}
+
+PartitionSet partitionRegionConcurrencyCostModel(
+    IREE::Stream::PartitioningConfigAttr config, Block *block) {
+  PartitionSet waveSet;
+
+  // Run analysis - if it fails then we'll just be conservative.
+  IREE::Stream::ResourceHazardAnalysis hazardAnalysis(block->getParentOp());
+  if (failed(hazardAnalysis.run())) {
+    LLVM_DEBUG(llvm::dbgs() << "WARNING: resource hazard analysis failed; "
+                               "conservatively scheduling\n");
+  }
+
+  struct OpInfo {
+    // True if the op is placed into a wave. Non-member ops (non-streamable or
+    // metadata) are tracked only to carry dependencies through them.
+    bool isMember = false;
+    // Members: the wave the op is placed in.
+    // Non-members: the latest wave of any member the op transitively depends
+    // on or -1 if none.
+    int wave = -1;
+    // Members: the latest wave the op can be placed in without extending the
+    // total wave count.
+    // Non-members: the latest wave any member the op transitively depends on
+    // can be placed in.
+    int latestWave = 0;
+    OpCost cost;
+  };
+  DenseMap<Operation *, OpInfo> opInfos;
+  SmallVector<Operation *> memberOps;
+
+  // Returns the earliest wave |op| can be placed in given the current wave
+  // assignment of all of the ops it depends on. As with the reference
+  // algorithm the hazard is checked on the edge into the consumer: ops
+  // producing values used without a hazard may share a wave with the user.
+  auto findEarliestWave = [&](Operation &op) {
+    int earliestWave = 0;
+    for (auto operand : op.getOperands()) {
+      auto *producerOp = operand.getDefiningOp();
+      if (!producerOp) continue;
+      auto producerInfoIt = opInfos.find(producerOp);
+      if (producerInfoIt == opInfos.end()) continue;
+      auto &producerInfo = producerInfoIt->second;
+      if (producerInfo.wave == -1) continue;
+      int wave = producerInfo.wave;
+      if (hazardAnalysis.hasHazard(producerOp, &op)) ++wave;
+      earliestWave = std::max(earliestWave, wave);
+    }
+    return earliestWave;
+  };
+
+  // Returns the latest wave of any member |op| transitively depends on or -1
+  // if none. Used to carry dependencies through non-member ops; the hazard is
+  // checked on the edge from the non-member into its consumers.
+  auto findLatestDependencyWave = [&](Operation &op) {
+    int latestWave = -1;
+    for (auto operand : op.getOperands()) {
+      auto *producerOp = operand.getDefiningOp();
+      if (!producerOp) continue;
+      auto producerInfoIt = opInfos.find(producerOp);
+      if (producerInfoIt == opInfos.end()) continue;
+      latestWave = std::max(latestWave, producerInfoIt->second.wave);
+    }
+    return latestWave;
+  };
+
+  // Forward walk assigning the earliest possible wave to each op. This gives
+  // us the critical path and with it the minimum number of waves (and thus
+  // barriers) required to respect all hazards.
+  int waveCount = 0;
+  for (auto &op : *block) {
+    // Skip constants; they just add noise (and since they are heavily CSE'd
+    // they have lots of users to test).
+    if (op.hasTrait<OpTrait::ConstantLike>()) continue;
+    auto streamableOp = dyn_cast<IREE::Stream::StreamableOpInterface>(op);
+    auto &opInfo = opInfos[&op];
+    opInfo.isMember = streamableOp && !streamableOp.isMetadata();
+    if (!opInfo.isMember) {
+      opInfo.wave = findLatestDependencyWave(op);
+      continue;
+    }
+    opInfo.wave = findEarliestWave(op);
+    opInfo.cost = estimateOpCost(&op);
+    waveCount = std::max(waveCount, opInfo.wave + 1);
+    memberOps.push_back(&op);
+  }
+  if (memberOps.empty()) return waveSet;
+
+  // Reverse walk assigning the latest possible wave to each op within the
+  // minimum wave count. The distance between the earliest and latest wave is
+  // the slack we have when placing the op.
+  for (auto &op : llvm::reverse(*block)) {
+    auto opInfoIt = opInfos.find(&op);
+    if (opInfoIt == opInfos.end()) continue;
+    auto &opInfo = opInfoIt->second;
+    // Producers must come strictly before users they have a hazard with.
+    // Non-member users forward the constraints of their own users.
+    opInfo.latestWave = waveCount - 1;
+    for (auto user : op.getUsers()) {
+      auto userInfoIt = opInfos.find(user);
+      if (userInfoIt == opInfos.end()) continue;
+      auto &userInfo = userInfoIt->second;
+      int latestWave = userInfo.latestWave;
+      if (userInfo.isMember && hazardAnalysis.hasHazard(&op, user)) {
+        --latestWave;
+      }
+      opInfo.latestWave = std::min(opInfo.latestWave, latestWave);
+    }
+  }
+
+  // Place each op into the wave within its slack that minimizes the estimated
+  // cost. Ops are visited in order so all producers are placed before their
+  // consumers and the earliest wave is recomputed from the actual placement.
+  struct WaveState {
+    // Longest estimated op execution in the wave; assuming independent ops
+    // run in parallel this is the duration of the wave.
+    int64_t duration = 0;
+    // Total estimated execution of all ops in the wave.
+    int64_t totalExecution = 0;
+    SetVector<Operation *> ops;
+  };
+  SmallVector<WaveState> waves(waveCount);
+  for (auto &op : *block) {
+    auto opInfoIt = opInfos.find(&op);
+    if (opInfoIt == opInfos.end()) continue;
+    auto &opInfo = opInfoIt->second;
+    if (!opInfo.isMember) {
+      opInfo.wave = findLatestDependencyWave(op);
+      continue;
+    }
+
+    int earliestWave = findEarliestWave(op);
+    int latestWave = std::max(earliestWave, opInfo.latestWave);
+    const auto &cost = opInfo.cost;
+    int bestWave = earliestWave;
+    int64_t bestScore = std::numeric_limits<int64_t>::max();
+    for (int wave = earliestWave; wave <= latestWave; ++wave) {
+      auto &waveState = waves[wave];
+      // Concurrency: growth of the critical path through the wave. Ops that
+      // fit within the duration of the existing wave run on otherwise idle
+      // cores for free.
+      int64_t score = std::max<int64_t>(0, cost.execution - waveState.duration);
+      // Barriers: opening a new wave adds a barrier.
+      if (waveState.ops.empty()) score += kBarrierCost;
+      // Memory: results are live from the wave they are produced in and
+      // operands we release are live until the wave we run in. Placing an op
+      // that produces more than it releases later shortens live ranges.
+      score += (cost.releasedBytes - cost.producedBytes) *
+               static_cast<int64_t>(wave - earliestWave);
+      // Ties go to the least loaded wave so that independent work spreads
+      // across waves instead of piling into one.
+      if (score < bestScore ||
+          (score == bestScore &&
+           waveState.totalExecution < waves[bestWave].totalExecution)) {
+        bestScore = score;
+        bestWave = wave;
+      }
+    }
+
+    LLVM_DEBUG({
+      llvm::dbgs() << "Placing op in wave " << bestWave << " of ["
+                   << earliestWave << ", " << latestWave
+                   << "] (execution=" << cost.execution
+                   << ", produced=" << cost.producedBytes
+                   << ", released=" << cost.releasedBytes << "): ";
+      op.print(llvm::dbgs(), OpPrintingFlags().skipRegions());
+      llvm::dbgs() << "\n";
+    });
+    opInfo.wave = bestWave;
+    auto &waveState = waves[bestWave];
+    waveState.duration = std::max(waveState.duration, cost.execution);
+    waveState.totalExecution += cost.execution;
+    waveState.ops.insert(&op);
+  }
+
+  // Emit non-empty waves in forward order. Ops within each wave are already
+  // in block order.
+  for (auto &waveState : waves) {
+    if (waveState.ops.empty()) continue;
+    Partition wave;
+
+    SetVector<Value> consumedValues;
+    SetVector<Value> producedValues;
+    SetVector<Value> escapingValues;
+    for (auto *op : waveState.ops) {
+      for (auto operand : op->getOperands()) {
+        consumedValues.insert(operand);
+      }
+      for (auto result : op->getResults()) {
+        producedValues.insert(result);
+        for (auto user : result.getUsers()) {
+          if (!waveState.ops.contains(user)) {
+            escapingValues.insert(result);
+          }
+        }
+      }
+    }
+    consumedValues.set_subtract(producedValues);
+    wave.ins = consumedValues;
+    wave.outs = escapingValues;
+
+    wave.ops = std::move(waveState.ops);
+    waveSet.partitions.push_back(std::move(wave));
+  }
+
+  LLVM_DEBUG({
+    AsmState asmState(block->getParentOp());
+    waveSet.dump(asmState);
+  });
+
+  return waveSet;
+}
+
+}  // namespace Stream
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -37,7 +37,10 @@ static llvm::cl::opt<Favor> clPartitioningFavor(
                    "additional concurrency."),
         clEnumValN(Favor::MaxConcurrency, "max-concurrency",
                    "Favor maximizing concurrency at the cost of additional "
-                   "memory consumption.")));
+                   "memory consumption."),
+        clEnumValN(Favor::Balanced, "balanced",
+                   "Balance concurrency against memory consumption and "
+                   "barrier count using estimated op costs.")));
 
 // TODO(#8042): properly choose this value based on target devices. We don't
 // yet have the device information up in stream and thus for targets that have
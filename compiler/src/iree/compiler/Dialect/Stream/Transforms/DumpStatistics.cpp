@@ -6,6 +6,7 @@
 
 #include <utility>
 
+#include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
 #include "iree/compiler/Dialect/Stream/IR/StreamDialect.h"
 #include "iree/compiler/Dialect/Stream/IR/StreamOps.h"
 #include "iree/compiler/Dialect/Stream/IR/StreamTraits.h"
@@ -54,10 +55,17 @@ struct UsageInfo {
   // stream.cmd.execute ops containing all relevant device commands.
   SmallVector<IREE::Stream::CmdExecuteOp> executeOps;
   SmallVector<IREE::Stream::ResourceAllocaOp> allocaOps;
+  // stream.resource.alloca/stream.resource.dealloca ops in program order within
+  // each function. Used to compute the transient memory live at any point.
+  SmallVector<SmallVector<Operation *>> transientLifetimeOps;
 
   // stream.timepoint.await ops indicating host/device synchronization.
   SmallVector<IREE::Stream::TimepointAwaitOp> awaitOps;
 
+  // Total number of dispatches removed by horizontal dispatch region fusion as
+  // recorded on each function by iree-flow-fuse-horizontal-dispatch-regions.
+  int64_t fusedDispatchCount = 0;
+
   void analyze(mlir::ModuleOp moduleOp) {
     SymbolTable symbolTable(moduleOp);
     for (auto globalOp : moduleOp.getOps<IREE::Util::GlobalOp>()) {
@@ -69,12 +77,21 @@ struct UsageInfo {
       executableOps[executableOp.getName()] = executableOp;
     }
     for (auto funcLikeOp : moduleOp.getOps<FunctionOpInterface>()) {
-      funcLikeOp.walk([&](Operation *op) {
+      if (auto fusedCountAttr = funcLikeOp->getAttrOfType<IntegerAttr>(
+              IREE::Flow::kHorizontallyFusedDispatchesAttrName)) {
+        fusedDispatchCount += fusedCountAttr.getInt();
+      }
+      auto &lifetimeOps = transientLifetimeOps.emplace_back();
+      funcLikeOp.walk<WalkOrder::PreOrder>([&](Operation *op) {
         TypeSwitch<Operation *>(op)
             .Case<IREE::Util::BufferConstantOp>(
                 [&](auto op) { bufferConstantOps.push_back(op); })
-            .Case<IREE::Stream::ResourceAllocaOp>(
-                [&](auto op) { allocaOps.push_back(op); })
+            .Case<IREE::Stream::ResourceAllocaOp>([&](auto op) {
+              allocaOps.push_back(op);
+              lifetimeOps.push_back(op);
+            })
+            .Case<IREE::Stream::ResourceDeallocaOp>(
+                [&](auto op) { lifetimeOps.push_back(op); })
             .Case<IREE::Stream::CmdExecuteOp>(
                 [&](auto op) { executeOps.push_back(op); })
             .Case<IREE::Stream::TimepointAwaitOp>(
@@ -113,11 +130,18 @@ struct Statistics {
   size_t submissionCount = 0;
   int64_t transientSize = 0;
   bool transientSizeDynamic = false;
+  // Peak statically-sized transient memory live at any point within a single
+  // function assuming each allocation is freed at its dealloca. Compared to
+  // |transientSize| this indicates how much reuse is possible across execution
+  // regions. Dynamically-sized allocations are not included.
+  int64_t peakStaticTransientSize = 0;
   // TODO(benvanik): add fill/copy sizes (when possible).
   size_t fillCount = 0;
   size_t copyCount = 0;
   size_t collectiveCount = 0;
   size_t dispatchCount = 0;
+  // Dispatches removed by fusing small independent dispatch regions.
+  size_t fusedDispatchCount = 0;
   size_t callCount = 0;
 
   // Executables:
@@ -162,6 +186,10 @@ struct Statistics {
         transientSizeDynamic = true;
       }
     }
+    for (auto &lifetimeOps : usageInfo.transientLifetimeOps) {
+      peakStaticTransientSize =
+          std::max(peakStaticTransientSize, computePeakLiveSize(lifetimeOps));
+    }
     for (auto executeOp : usageInfo.executeOps) {
       executeOp.walk([&](Operation *op) {
         TypeSwitch<Operation *>(op)
@@ -174,10 +202,39 @@ struct Statistics {
             .Case<IREE::Stream::CmdCallOp>([&](auto op) { ++callCount; });
       });
     }
+    fusedDispatchCount = usageInfo.fusedDispatchCount;
 
     // Executables:
     executableCount = usageInfo.executableOps.size();
   }
+
+  // Returns the maximum total size of statically-sized allocations live at any
+  // point in |lifetimeOps|. Dynamically-sized allocations are ignored (and are
+  // already reported by |transientSizeDynamic|).
+  static int64_t computePeakLiveSize(ArrayRef<Operation *> lifetimeOps) {
+    DenseMap<Value, int64_t> liveSizes;
+    int64_t liveSize = 0;
+    int64_t peakSize = 0;
+    for (auto *op : lifetimeOps) {
+      if (auto allocaOp = dyn_cast<IREE::Stream::ResourceAllocaOp>(op)) {
+        APInt allocaSize;
+        if (!matchPattern(allocaOp.getStorageSize(),
+                          m_ConstantInt(&allocaSize))) {
+          continue;
+        }
+        liveSizes[allocaOp.getResult()] = allocaSize.getSExtValue();
+        liveSize += allocaSize.getSExtValue();
+        peakSize = std::max(peakSize, liveSize);
+      } else if (auto deallocaOp =
+                     dyn_cast<IREE::Stream::ResourceDeallocaOp>(op)) {
+        auto it = liveSizes.find(deallocaOp.getOperand());
+        if (it == liveSizes.end()) continue;
+        liveSize -= it->second;
+        liveSizes.erase(it);
+      }
+    }
+    return peakSize;
+  }
 };
 
 //===----------------------------------------------------------------------===//
@@ -244,11 +301,18 @@ static void prettyPrintStatistics(const UsageInfo &usageInfo,
   os << llvm::formatv(
       "{0}{1} B ({2:F2} MiB)\n", stats.transientSizeDynamic ? "minimum " : "",
       stats.transientSize, stats.transientSize / (1 * 1024 * 1024.0f));
+  os << llvm::formatv(
+      "// Peak Static: {0} B ({1:F2} MiB) transients live{2}\n",
+      stats.peakStaticTransientSize,
+      stats.peakStaticTransientSize / (1 * 1024 * 1024.0f),
+      stats.transientSizeDynamic ? ", excluding dynamically-sized" : "");
 
   os << llvm::formatv("//   DMA Fills: {0}\n", stats.fillCount);
   os << llvm::formatv("//  DMA Copies: {0}\n", stats.copyCount);
   os << llvm::formatv("// Collectives: {0}\n", stats.collectiveCount);
   os << llvm::formatv("//  Dispatches: {0}\n", stats.dispatchCount);
+  os << llvm::formatv("//       Fused: {0} dispatches removed\n",
+                      stats.fusedDispatchCount);
   os << llvm::formatv("// Async Calls: {0}\n", stats.callCount);
 
   os << llvm::formatv(
@@ -403,7 +467,7 @@ static void dumpAggregateCSVTable(const UsageInfo &usageInfo,
   Statistics stats;
   stats.analyze(usageInfo);
 
-  os << R"("Constants","Constant Size","Variables","Variable Size","Awaits","Submissions","Transient Size","Fills","Copies","Dispatches","Async Calls","Executables")";
+  os << R"("Constants","Constant Size","Variables","Variable Size","Awaits","Submissions","Transient Size","Peak Static Transient Size","Fills","Copies","Dispatches","Fused Dispatches","Async Calls","Executables")";
   os << "\n";
 
   // Globals:
@@ -415,9 +479,10 @@ static void dumpAggregateCSVTable(const UsageInfo &usageInfo,
   os << llvm::formatv("{0},", stats.awaitCount);
 
   // Execution:
-  os << llvm::formatv("{0},{1},{2},{3},{4},{5},", stats.submissionCount,
-                      stats.transientSize, stats.fillCount, stats.copyCount,
-                      stats.dispatchCount, stats.callCount);
+  os << llvm::formatv("{0},{1},{2},{3},{4},{5},{6},{7},", stats.submissionCount,
+                      stats.transientSize, stats.peakStaticTransientSize,
+                      stats.fillCount, stats.copyCount, stats.dispatchCount,
+                      stats.fusedDispatchCount, stats.callCount);
 
   // Executables:
   os << llvm::formatv("{0}", stats.executableCount);
@@ -538,6 +603,7 @@ static void dumpAggregateJSONStructure(const UsageInfo &usageInfo,
   os << llvm::formatv(kvPair, "fill-count", stats.fillCount);
   os << llvm::formatv(kvPair, "copy-count", stats.copyCount);
   os << llvm::formatv(kvPair, "dispatch-count", stats.dispatchCount);
+  os << llvm::formatv(kvPair, "fused-dispatch-count", stats.fusedDispatchCount);
   os << llvm::formatv(kvPairNoComma, "call-count", stats.callCount);
   os << "  },\n";
 
@@ -5,6 +5,7 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 #include <list>
+#include <numeric>
 
 #include "iree/compiler/Dialect/Stream/IR/StreamDialect.h"
 #include "iree/compiler/Dialect/Stream/IR/StreamOps.h"
@@ -35,6 +36,12 @@ namespace {
 
 using Slice = IREE::Stream::ResourcePackOp::Slice;
 
+// Returns the size of a slice known to have a constant size.
+static int64_t getStaticSliceSize(const Slice &slice) {
+  return cast<arith::ConstantIndexOp>(slice.dynamicSize.getDefiningOp())
+      .value();
+}
+
 // Packs slices back-to-back with no aliasing. Useful when debugging to remove
 // the aliasing that makes data breakpoints useless.
 //
@@ -63,7 +70,9 @@ static Value packSlicesWithNoAliasing(
   return builder.createOrFold<IREE::Util::AlignOp>(loc, offset, rangeAlignment);
 }
 
-// Packs a set of statically-sized slices by greedy strip packing.
+// Computes a layout for a set of statically-sized slices by greedy strip
+// packing. Slices are placed in the given |order| into the smallest gap between
+// existing reservations with overlapping lifetimes.
 //
 // This is the same algorithm used in tflite here:
 // https://github.com/tensorflow/tensorflow/blob/master/tensorflow/lite/simple_memory_arena.cc
@@ -78,16 +87,11 @@ static Value packSlicesWithNoAliasing(
 // https://www.sciencedirect.com/science/article/pii/S0925772113001016 that
 // someone with a brain able to parse mathy papers can try implementing.
 //
-// Slice packed offset SSA values will be updated and start at the given
-// |baseOffset|. Returns |baseOffset| + the total size of the allocation
-// aligned to the requirements of |resourceConfig|.
-static Value packStaticSlicesGreedily(
-    IREE::Stream::ResourcePackOp packOp, Value baseOffset,
-    ArrayRef<Slice> slices, IREE::Stream::ResourceConfigAttr resourceConfig,
-    IndexSet &indexSet, OpBuilder &builder) {
-  int64_t offsetAlignment = resourceConfig.getMinBufferOffsetAlignment();
-  int64_t rangeAlignment = resourceConfig.getMinBufferRangeAlignment();
-
+// |staticOffsets| will contain the offset of each slice relative to the start
+// of the slab. Returns the total size of the slab aligned to |rangeAlignment|.
+static int64_t computeStaticSliceLayout(
+    ArrayRef<Slice> slices, ArrayRef<size_t> order, int64_t offsetAlignment,
+    int64_t rangeAlignment, SmallVectorImpl<int64_t> &staticOffsets) {
   struct Reservation {
     const Slice *slice = nullptr;
     int64_t staticOffset = 0;
@@ -95,14 +99,15 @@ static Value packStaticSlicesGreedily(
   };
   static constexpr int64_t UNASSIGNED = INT64_MAX;
 
+  staticOffsets.assign(slices.size(), 0);
   std::list<Reservation> reservations;
   int64_t highwaterMark = 0;
-  for (auto &slice : slices) {
+  for (size_t sliceIndex : order) {
+    auto &slice = slices[sliceIndex];
     int64_t bestOffset = UNASSIGNED;
     int64_t bestOffsetFit = UNASSIGNED;
-    int64_t staticSize =
-        cast<arith::ConstantIndexOp>(slice.dynamicSize.getDefiningOp()).value();
-    int64_t alignedSize = IREE::Util::align(staticSize, rangeAlignment);
+    int64_t alignedSize =
+        IREE::Util::align(getStaticSliceSize(slice), rangeAlignment);
 
     // Iterate through reservations (sorted by ascending offset) and identify
     // gaps in which the slice will fit. To reduce wastage we want to find the
@@ -141,17 +146,66 @@ static Value packStaticSlicesGreedily(
       ++insertionIt;
     }
     reservations.insert(insertionIt, reservation);
-    slice.packedOffset.replaceAllUsesWith(builder.createOrFold<arith::AddIOp>(
-        packOp.getLoc(), baseOffset, indexSet.get(bestOffset)));
+    staticOffsets[sliceIndex] = bestOffset;
 
     // Update highwater mark indicating how much memory needs to be allocated
     // for the entire slab.
     highwaterMark = std::max(highwaterMark, bestOffset + alignedSize);
   }
 
-  highwaterMark = IREE::Util::align(highwaterMark, rangeAlignment);
+  return IREE::Util::align(highwaterMark, rangeAlignment);
+}
+
+// Packs a set of statically-sized slices by greedy strip packing.
+//
+// Two orderings are tried and the one producing the smallest slab is used:
+// program order (slices as they appear in the pack op, which generally follows
+// lifetime start) and greedy-by-size (largest slices first). Placing large
+// slices first avoids fragmenting the slab with small slices that large ones
+// then can't fit between and is often significantly better on graphs with a
+// few large activations and many small temporaries.
+//
+// Slice packed offset SSA values will be updated and start at the given
+// |baseOffset|. Returns |baseOffset| + the total size of the allocation
+// aligned to the requirements of |resourceConfig|.
+static Value packStaticSlicesGreedily(
+    IREE::Stream::ResourcePackOp packOp, Value baseOffset,
+    ArrayRef<Slice> slices, IREE::Stream::ResourceConfigAttr resourceConfig,
+    IndexSet &indexSet, OpBuilder &builder) {
+  int64_t offsetAlignment = resourceConfig.getMinBufferOffsetAlignment();
+  int64_t rangeAlignment = resourceConfig.getMinBufferRangeAlignment();
+
+  SmallVector<size_t> programOrder(slices.size());
+  std::iota(programOrder.begin(), programOrder.end(), 0);
+  SmallVector<int64_t> staticOffsets;
+  int64_t totalSize =
+      computeStaticSliceLayout(slices, programOrder, offsetAlignment,
+                               rangeAlignment, staticOffsets);
+
+  SmallVector<size_t> sizeOrder = programOrder;
+  std::stable_sort(sizeOrder.begin(), sizeOrder.end(),
+                   [&](size_t lhs, size_t rhs) {
+                     return getStaticSliceSize(slices[lhs]) >
+                            getStaticSliceSize(slices[rhs]);
+                   });
+  SmallVector<int64_t> sizeOrderOffsets;
+  int64_t sizeOrderTotalSize =
+      computeStaticSliceLayout(slices, sizeOrder, offsetAlignment,
+                               rangeAlignment, sizeOrderOffsets);
+  LLVM_DEBUG(llvm::dbgs() << "static slices: program order " << totalSize
+                          << " B, size order " << sizeOrderTotalSize
+                          << " B\n");
+  if (sizeOrderTotalSize < totalSize) {
+    totalSize = sizeOrderTotalSize;
+    staticOffsets = std::move(sizeOrderOffsets);
+  }
+
+  for (auto [slice, staticOffset] : llvm::zip_equal(slices, staticOffsets)) {
+    slice.packedOffset.replaceAllUsesWith(builder.createOrFold<arith::AddIOp>(
+        packOp.getLoc(), baseOffset, indexSet.get(staticOffset)));
+  }
   return builder.createOrFold<arith::AddIOp>(packOp.getLoc(), baseOffset,
-                                             indexSet.get(highwaterMark));
+                                             indexSet.get(totalSize));
 }
 
 // Packs a set of dynamically-sized slices based on the structural information
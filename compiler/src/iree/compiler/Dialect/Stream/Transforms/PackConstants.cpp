@@ -60,6 +60,94 @@ struct ConstantSlice {
   }
 };
 
+// Returns the raw bytes of |value| if they are available for comparison.
+// Dense elements return their raw data (a single element if splat) and dense
+// resources return their blob data when loaded.
+static std::optional<ArrayRef<char>> getRawContents(Attribute value) {
+  if (auto denseAttr = llvm::dyn_cast<DenseElementsAttr>(value)) {
+    return denseAttr.getRawData();
+  } else if (auto resourceAttr =
+                 llvm::dyn_cast<DenseResourceElementsAttr>(value)) {
+    if (AsmResourceBlob *blob = resourceAttr.getRawHandle().getBlob()) {
+      return blob->getData();
+    }
+  }
+  return std::nullopt;
+}
+
+// Returns true if |value| is stored as a single repeated element.
+static bool isSplatContents(Attribute value) {
+  auto denseAttr = llvm::dyn_cast<DenseElementsAttr>(value);
+  return denseAttr && denseAttr.isSplat();
+}
+
+// Returns a hash of the encoded contents of |slice| that is consistent with
+// haveSameContents. Values with raw contents hash their bytes so that values
+// of different shapes or attribute kinds with the same bytes collide; other
+// attrs hash by identity.
+static llvm::hash_code hashContents(const ConstantSlice &slice) {
+  auto storageSize = slice.getStorageSize();
+  if (auto rawData = getRawContents(slice.value)) {
+    return llvm::hash_combine(
+        storageSize, llvm::cast<ElementsAttr>(slice.value).getElementType(),
+        isSplatContents(slice.value),
+        llvm::hash_combine_range(rawData->begin(), rawData->end()));
+  }
+  return llvm::hash_combine(storageSize, slice.value);
+}
+
+// Returns true if |lhs| and |rhs| encode to the same bytes and have the same
+// resource size such that they can share storage.
+static bool haveSameContents(const ConstantSlice &lhs,
+                             const ConstantSlice &rhs) {
+  if (lhs.resultSize != rhs.resultSize) {
+    APInt lhsSize, rhsSize;
+    if (!matchPattern(lhs.resultSize, m_ConstantInt(&lhsSize)) ||
+        !matchPattern(rhs.resultSize, m_ConstantInt(&rhsSize)) ||
+        lhsSize != rhsSize) {
+      return false;
+    }
+  }
+  if (lhs.value == rhs.value) return true;
+  auto lhsData = getRawContents(lhs.value);
+  auto rhsData = getRawContents(rhs.value);
+  if (!lhsData || !rhsData) return false;
+  return llvm::cast<ElementsAttr>(lhs.value).getElementType() ==
+             llvm::cast<ElementsAttr>(rhs.value).getElementType() &&
+         isSplatContents(lhs.value) == isSplatContents(rhs.value) &&
+         lhs.getStorageSize() == rhs.getStorageSize() && *lhsData == *rhsData;
+}
+
+// A slice whose contents are identical to an earlier slice and that will
+// alias its storage.
+struct DuplicateSlice {
+  ConstantSlice slice;
+  // Result of the slice that holds the storage.
+  Value canonicalResult;
+};
+
+// Splits |slices| into the unique slices that need storage and the duplicates
+// that can alias them. The relative order of the unique slices is preserved.
+static SmallVector<ConstantSlice> deduplicateSlices(
+    ArrayRef<ConstantSlice> slices,
+    SmallVectorImpl<DuplicateSlice> &duplicateSlices) {
+  SmallVector<ConstantSlice> uniqueSlices;
+  DenseMap<llvm::hash_code, SmallVector<unsigned>> uniqueSlicesByHash;
+  for (auto &slice : slices) {
+    auto &candidates = uniqueSlicesByHash[hashContents(slice)];
+    auto it = llvm::find_if(candidates, [&](unsigned index) {
+      return haveSameContents(uniqueSlices[index], slice);
+    });
+    if (it != candidates.end()) {
+      duplicateSlices.push_back({slice, uniqueSlices[*it].result});
+      continue;
+    }
+    candidates.push_back(uniqueSlices.size());
+    uniqueSlices.push_back(slice);
+  }
+  return uniqueSlices;
+}
+
 struct PackedSpan {
   // Original slice this span represents.
   ConstantSlice slice;
@@ -82,34 +170,71 @@ struct StorageResource {
   // Packed byte data that must be embedded in the final module.
   // It must be written with an alignment as required by the constraints.
   IREE::Util::CompositeAttr data;
+
+  // Returns the total length, in bytes, of the valid span data excluding
+  // padding.
+  uint64_t getPayloadSize() const {
+    uint64_t payloadSize = 0;
+    for (auto &span : spans) payloadSize += span.length;
+    return payloadSize;
+  }
+};
+
+// Sizes accumulated across all packed storage resources.
+struct PackingStatistics {
+  // Total number of storage resources produced.
+  uint64_t resourceCount = 0;
+  // Total bytes of valid constant data stored.
+  uint64_t payloadBytes = 0;
+  // Total bytes of padding inserted for alignment.
+  uint64_t paddingBytes = 0;
+  // Total bytes not stored as they duplicated other constants.
+  uint64_t deduplicatedBytes = 0;
 };
 
 // Buckets |slices| into 1+ storage resources based on |resourceConfig|.
+// Each slice is placed in the resource it fits in with the least space
+// remaining after placement (including the padding required to align its
+// offset) and a new resource is started when it fits in none. Slices are
+// always appended so the relative order of slices within each resource is
+// preserved.
 static SmallVector<StorageResource, 8> bucketValuesIntoStorageResources(
     ArrayRef<ConstantSlice> slices,
     IREE::Stream::ResourceConfigAttr resourceConfig) {
-  // TODO(benvanik): replace with a better strategy (best-fit, etc).
   SmallVector<StorageResource, 8> storageBuffers;
-  storageBuffers.push_back({UnknownLoc::get(resourceConfig.getContext())});
-  StorageResource *currentBuffer = &storageBuffers.back();
   for (auto slice : slices) {
-    uint64_t offset = IREE::Util::align(
-        currentBuffer->totalSize, resourceConfig.getMinBufferOffsetAlignment());
     uint64_t unpaddedLength = slice.getStorageSize();
     uint64_t paddedLength = IREE::Util::align(
         unpaddedLength, resourceConfig.getMinBufferRangeAlignment());
-    if (offset + unpaddedLength > resourceConfig.getMaxAllocationSize()) {
-      // Spilling buffer; make a new one.
+
+    StorageResource *bestBuffer = nullptr;
+    uint64_t bestOffset = 0;
+    uint64_t bestRemaining = UINT64_MAX;
+    for (auto &storageBuffer : storageBuffers) {
+      uint64_t offset =
+          IREE::Util::align(storageBuffer.totalSize,
+                            resourceConfig.getMinBufferOffsetAlignment());
+      if (offset + unpaddedLength > resourceConfig.getMaxAllocationSize()) {
+        continue;
+      }
+      uint64_t remaining =
+          resourceConfig.getMaxAllocationSize() - (offset + unpaddedLength);
+      if (remaining < bestRemaining) {
+        bestBuffer = &storageBuffer;
+        bestOffset = offset;
+        bestRemaining = remaining;
+      }
+    }
+    if (!bestBuffer) {
+      // Fits in no existing buffer; make a new one.
       storageBuffers.push_back({UnknownLoc::get(resourceConfig.getContext())});
-      currentBuffer = &storageBuffers.back();
-      offset = 0;
+      bestBuffer = &storageBuffers.back();
+      bestOffset = 0;
     }
-    currentBuffer->spans.push_back({slice, offset, unpaddedLength});
-    currentBuffer->totalSize =
-        std::max(currentBuffer->totalSize, offset + paddedLength);
-  }
-  if (storageBuffers.back().spans.empty()) {
-    storageBuffers.pop_back();
+
+    bestBuffer->spans.push_back({slice, bestOffset, unpaddedLength});
+    bestBuffer->totalSize =
+        std::max(bestBuffer->totalSize, bestOffset + paddedLength);
   }
   return storageBuffers;
 }
@@ -215,11 +340,14 @@ static SmallVector<StorageResource, 8> computePackingMap(
   // things around and waste on silly things like loading times).
   //
   // Here it's all descriptor sets and mapped pages but same thing pretty
-  // much, and passes earlier on may duplicate constants in the pool if it
-  // means they can improve locality at runtime. This pass doesn't dedupe and
-  // just sticks to packing for that reason.
-
-  // Build a list of resources and spans (append to current or spill to new).
+  // much, and passes earlier on may duplicate constants if it means they can
+  // improve locality at runtime. Such duplicates should be placed in separate
+  // pools: within a pool identical immutable constants are deduplicated
+  // before packing as no amount of locality is worth storing them twice next
+  // to each other.
+
+  // Build a list of resources and spans (best-fit into existing or spill to
+  // new).
   auto storageBuffers =
       bucketValuesIntoStorageResources(slices, resourceConfig);
 
@@ -425,7 +553,8 @@ static UploadResult buildTryMapConstantResources(
 static Value generateUpload(IREE::Stream::ResourceConstantsOp constantsOp,
                             IREE::Stream::Lifetime lifetime,
                             IREE::Stream::ResourceConfigAttr resourceConfig,
-                            IndexSet &indexSet, OpBuilder &builder) {
+                            IndexSet &indexSet, OpBuilder &builder,
+                            PackingStatistics &statistics) {
   // Gather the slices produced by this constant pooling op.
   SmallVector<ConstantSlice> slices;
   slices.reserve(constantsOp.getResults().size());
@@ -442,12 +571,43 @@ static Value generateUpload(IREE::Stream::ResourceConstantsOp constantsOp,
     });
   }
 
+  // Immutable constants with identical contents can share storage. Variables
+  // are each initialized with the constant value but then may diverge and
+  // need their own storage.
+  SmallVector<ConstantSlice> uniqueSlices;
+  SmallVector<DuplicateSlice> duplicateSlices;
+  if (lifetime == IREE::Stream::Lifetime::Constant) {
+    uniqueSlices = deduplicateSlices(slices, duplicateSlices);
+  } else {
+    uniqueSlices = slices;
+  }
+
   // Perform the packing of dense values to compute the storage resources we
   // will need and where each value will be placed.
   auto storageResources =
-      computePackingMap(slices, resourceConfig, constantsOp.getContext());
+      computePackingMap(uniqueSlices, resourceConfig, constantsOp.getContext());
   if (storageResources.empty()) return nullptr;
 
+  for (auto [i, storageResource] : llvm::enumerate(storageResources)) {
+    uint64_t payloadSize = storageResource.getPayloadSize();
+    LLVM_DEBUG(llvm::dbgs()
+               << "storage resource " << i << " ("
+               << stringifyLifetime(lifetime) << "): "
+               << storageResource.spans.size() << " spans, " << payloadSize
+               << " payload bytes, "
+               << (storageResource.totalSize - payloadSize)
+               << " padding bytes, " << storageResource.totalSize
+               << " total bytes\n");
+    ++statistics.resourceCount;
+    statistics.payloadBytes += payloadSize;
+    statistics.paddingBytes += storageResource.totalSize - payloadSize;
+  }
+  for (auto &duplicateSlice : duplicateSlices) {
+    LLVM_DEBUG(llvm::dbgs() << "deduplicated " << duplicateSlice.slice.value
+                            << "\n");
+    statistics.deduplicatedBytes += duplicateSlice.slice.getStorageSize();
+  }
+
   // Emit rodata storage for the constant values.
   // As our upload paths may vary this ensures that we are only emitting
   // them once regardless of how many strategies we emit IR for.
@@ -478,6 +638,7 @@ static Value generateUpload(IREE::Stream::ResourceConstantsOp constantsOp,
   }
 
   // Build subviews for all packed spans back into storage buffers.
+  DenseMap<Value, std::pair<AllocatedStorage, uint64_t>> spanStorage;
   for (auto [storageResource, allocatedStorage] :
        llvm::zip_equal(storageResources, uploadResult.allocations)) {
     for (auto &span : storageResource.spans) {
@@ -486,9 +647,22 @@ static Value generateUpload(IREE::Stream::ResourceConstantsOp constantsOp,
           loc, allocatedStorage.resource, allocatedStorage.resourceSize,
           indexSet.get(span.offset), span.slice.resultSize);
       span.slice.result.replaceAllUsesWith(subviewOp.getResult());
+      spanStorage[span.slice.result] = {allocatedStorage, span.offset};
     }
   }
 
+  // Duplicates get their own subviews aliasing the storage of the span they
+  // were deduplicated against.
+  for (auto &duplicateSlice : duplicateSlices) {
+    auto [allocatedStorage, offset] =
+        spanStorage.lookup(duplicateSlice.canonicalResult);
+    auto subviewOp = builder.create<IREE::Stream::ResourceSubviewOp>(
+        duplicateSlice.slice.result.getLoc(), allocatedStorage.resource,
+        allocatedStorage.resourceSize, indexSet.get(offset),
+        duplicateSlice.slice.resultSize);
+    duplicateSlice.slice.result.replaceAllUsesWith(subviewOp.getResult());
+  }
+
   // Join on storage timepoints for our transitive dependencies to await.
   return uploadResult.timepoint;
 }
@@ -524,6 +698,7 @@ class PackConstantsPass : public PackConstantsBase<PackConstantsPass> {
       return;
     }
 
+    PackingStatistics statistics;
     parentOp.walk([&](IREE::Stream::ResourceConstantsOp constantsOp) {
       // Derive resource constraints based on pack affinity.
       auto resourceConfig =
@@ -535,14 +710,14 @@ class PackConstantsPass : public PackConstantsBase<PackConstantsPass> {
 
       // Perform upload/processing for immutable and mutable constants.
       SmallVector<Value> timepoints;
-      if (auto timepoint =
-              generateUpload(constantsOp, IREE::Stream::Lifetime::Constant,
-                             resourceConfig, indexSet, builder)) {
+      if (auto timepoint = generateUpload(
+              constantsOp, IREE::Stream::Lifetime::Constant, resourceConfig,
+              indexSet, builder, statistics)) {
         timepoints.push_back(timepoint);
       }
-      if (auto timepoint =
-              generateUpload(constantsOp, IREE::Stream::Lifetime::Variable,
-                             resourceConfig, indexSet, builder)) {
+      if (auto timepoint = generateUpload(
+              constantsOp, IREE::Stream::Lifetime::Variable, resourceConfig,
+              indexSet, builder, statistics)) {
         timepoints.push_back(timepoint);
       }
       if (timepoints.empty()) return;
@@ -561,6 +736,11 @@ class PackConstantsPass : public PackConstantsBase<PackConstantsPass> {
 
       constantsOp.erase();
     });
+
+    numStorageResources += statistics.resourceCount;
+    numPayloadBytes += statistics.payloadBytes;
+    numPaddingBytes += statistics.paddingBytes;
+    numDeduplicatedBytes += statistics.deduplicatedBytes;
   }
 };
 
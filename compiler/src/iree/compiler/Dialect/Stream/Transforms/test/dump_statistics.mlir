@@ -6,15 +6,17 @@
 // CHECK-PRETTY:   Variables: 0, (TBD)
 // CHECK-PRETTY:  D->H Syncs: 2
 // CHECK-PRETTY: Submissions: 3, using cumulative 0 B
+// CHECK-PRETTY: Peak Static: 0 B (0.00 MiB) transients live
 // CHECK-PRETTY:   DMA Fills: 0
 // CHECK-PRETTY:  DMA Copies: 2
 // CHECK-PRETTY: Collectives: 0
 // CHECK-PRETTY:  Dispatches: 3
+// CHECK-PRETTY:       Fused: 0 dispatches removed
 // CHECK-PRETTY: Executables: 2, 33% reuse
 
 // CHECK-CSV: ; Aggregate Statistics
-// CHECK-CSV: "Constants","Constant Size","Variables","Variable Size","Awaits","Submissions","Transient Size","Fills","Copies","Dispatches","Async Calls","Executables"
-// CHECK-CSV: 1,192,0,0,2,3,0,0,2,3,0,2
+// CHECK-CSV: "Constants","Constant Size","Variables","Variable Size","Awaits","Submissions","Transient Size","Peak Static Transient Size","Fills","Copies","Dispatches","Fused Dispatches","Async Calls","Executables"
+// CHECK-CSV: 1,192,0,0,2,3,0,0,0,2,3,0,0,2
 // CHECK-CSV: ; Execution
 // CHECK-CSV: "Depth","Command","Symbol","Length","Invocations","Workload","Operands","Resources"
 // CHECK-CSV: 0,"copy",,192,,,,
@@ -156,3 +158,50 @@ func.func public @func_a() -> (tensor<4xi32>, tensor<4xi32>) {
   %7 = stream.tensor.export %6 : tensor<4xi32> in !stream.resource<external>{%c16} -> tensor<4xi32>
   return %5, %7 : tensor<4xi32>, tensor<4xi32>
 }
+
+// -----
+
+// Transients with overlapping lifetimes: the peak is reached while %a and %b
+// are both live (64 + 128) and %c reuses the space freed by %a. The
+// dynamically-sized %d only counts towards the cumulative size.
+
+// CHECK-PRETTY: Aggregate Statistics
+// CHECK-PRETTY: Submissions: 0, using cumulative minimum 224 B
+// CHECK-PRETTY: Peak Static: 192 B (0.00 MiB) transients live, excluding dynamically-sized
+
+// CHECK-CSV: ; Aggregate Statistics
+// CHECK-CSV: "Constants","Constant Size","Variables","Variable Size","Awaits","Submissions","Transient Size","Peak Static Transient Size","Fills","Copies","Dispatches","Fused Dispatches","Async Calls","Executables"
+// CHECK-CSV: 0,0,0,0,0,0,224,192,0,0,0,0,0,0
+
+func.func public @overlapping_transients(%size: index) {
+  %c32 = arith.constant 32 : index
+  %c64 = arith.constant 64 : index
+  %c128 = arith.constant 128 : index
+  %a:2 = stream.resource.alloca uninitialized : !stream.resource<transient>{%c64} => !stream.timepoint
+  %b:2 = stream.resource.alloca uninitialized : !stream.resource<transient>{%c128} => !stream.timepoint
+  %d:2 = stream.resource.alloca uninitialized : !stream.resource<transient>{%size} => !stream.timepoint
+  %a_dealloca = stream.resource.dealloca %a#0 : !stream.resource<transient>{%c64} => !stream.timepoint
+  %c:2 = stream.resource.alloca uninitialized : !stream.resource<transient>{%c32} => !stream.timepoint
+  %b_dealloca = stream.resource.dealloca %b#0 : !stream.resource<transient>{%c128} => !stream.timepoint
+  %c_dealloca = stream.resource.dealloca %c#0 : !stream.resource<transient>{%c32} => !stream.timepoint
+  %d_dealloca = stream.resource.dealloca %d#0 : !stream.resource<transient>{%size} => !stream.timepoint
+  return
+}
+
+// -----
+
+// Dispatches removed by horizontal fusion are summed across all functions.
+
+// CHECK-PRETTY: Aggregate Statistics
+// CHECK-PRETTY: Fused: 5 dispatches removed
+
+// CHECK-CSV: ; Aggregate Statistics
+// CHECK-CSV: "Constants","Constant Size","Variables","Variable Size","Awaits","Submissions","Transient Size","Peak Static Transient Size","Fills","Copies","Dispatches","Fused Dispatches","Async Calls","Executables"
+// CHECK-CSV: 0,0,0,0,0,0,0,0,0,0,0,5,0,0
+
+func.func public @fused_a() attributes {flow.horizontally_fused_dispatches = 2 : i64} {
+  return
+}
+func.func public @fused_b() attributes {flow.horizontally_fused_dispatches = 3 : i64} {
+  return
+}
@@ -29,6 +29,37 @@ func.func @layoutStatic() -> (index, index, index, index, index, index, index)
 
 // -----
 
+#layoutStaticBySizeConfig = #stream.resource_config<{
+  max_allocation_size = 1073741824,
+  min_buffer_offset_alignment = 16,
+  max_buffer_range = 1073741824,
+  min_buffer_range_alignment = 16,
+  index_bits = 32
+}>
+
+// Packing in program order would require 176 bytes (48 + 48 + 16 + 64) as the
+// small [2, 3] slice fragments the slab. Placing the largest slices first
+// allows [3, 4] to alias with [1, 2].
+
+// CHECK-LABEL: @layoutStaticBySize
+func.func @layoutStaticBySize() -> (index, index, index, index, index)
+    attributes {stream.resources = #layoutStaticBySizeConfig} {
+  %c16 = arith.constant 16 : index
+  %c48 = arith.constant 48 : index
+  %c64 = arith.constant 64 : index
+  %t:5 = stream.resource.pack slices({
+    [1, 2] = %c48,  // +0
+    [1, 3] = %c48,  // +64 (after [3, 4])
+    [2, 3] = %c16,  // +112 (after [1, 3])
+    [3, 4] = %c64,  // +0 (largest, placed first)
+  }) : index
+  // CHECK: return %c128
+  // CHECK-SAME: %c0, %c64, %c112, %c0
+  return %t#0, %t#1, %t#2, %t#3, %t#4 : index, index, index, index, index
+}
+
+// -----
+
 #layoutDynamicConfig = #stream.resource_config<{
   max_allocation_size = 1073741824,
   min_buffer_offset_alignment = 16,
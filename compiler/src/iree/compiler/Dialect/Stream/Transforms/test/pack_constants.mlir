@@ -146,3 +146,88 @@ func.func @mixedResourceConstants() -> (!stream.resource<constant>, !stream.reso
   // CHECK: return %[[CONSTANT_VIEW]], %[[VARIABLE_VIEW]], %[[JOIN]]
   return %0#0, %0#1, %0#2 : !stream.resource<constant>, !stream.resource<variable>, !stream.timepoint
 }
+
+// -----
+
+// Tests that constants are placed into the storage resource they fit best in
+// instead of only the last one: the 24-byte constant fits in the space left in
+// the first resource after the 40-byte constant spilled into a second.
+
+#bestFitResourceConstantsConfig = #stream.resource_config<{
+  max_allocation_size = 48,
+  min_buffer_offset_alignment = 16,
+  max_buffer_range = 1073741824,
+  min_buffer_range_alignment = 16,
+  index_bits = 32
+}>
+
+// CHECK: #composite_of_48b = #util.composite<48xi8, [
+// CHECK:     dense<[1, 2]> : tensor<2xi32>,
+// CHECK:     dense<0> : vector<8xi8>,
+// CHECK:     dense<[7, 8, 9, 10, 11, 12]> : tensor<6xi32>,
+// CHECK:     dense<0> : vector<8xi8>,
+// CHECK: ]>
+// CHECK: #composite_of_48b1 = #util.composite<48xi8, [
+// CHECK:     dense<[3, 4, 5, 6, 7, 8, 9, 10, 11, 12]> : tensor<10xi32>,
+// CHECK:     dense<0> : vector<8xi8>,
+// CHECK: ]>
+
+// CHECK-LABEL: @bestFitResourceConstants
+func.func @bestFitResourceConstants() -> (!stream.resource<constant>, !stream.resource<constant>, !stream.resource<constant>, !stream.timepoint)
+    attributes {stream.resources = #bestFitResourceConstantsConfig} {
+  %c8 = arith.constant 8 : index
+  %c24 = arith.constant 24 : index
+  %c40 = arith.constant 40 : index
+
+  // CHECK: util.buffer.constant {alignment = 16 : index} : !util.buffer = #composite_of_48b
+  // CHECK: util.buffer.constant {alignment = 16 : index} : !util.buffer = #composite_of_48b1
+  %0:4 = stream.resource.constants :
+    !stream.resource<constant>{%c8} = dense<[1, 2]> : tensor<2xi32>,
+    !stream.resource<constant>{%c40} = dense<[3, 4, 5, 6, 7, 8, 9, 10, 11, 12]> : tensor<10xi32>,
+    !stream.resource<constant>{%c24} = dense<[7, 8, 9, 10, 11, 12]> : tensor<6xi32>
+    => !stream.timepoint
+
+  // CHECK: %[[IF:.+]]:3 = scf.if
+
+  // CHECK: %[[RES0:.+]] = stream.resource.subview %[[IF]]#0[%c0] : !stream.resource<constant>{%c48} -> !stream.resource<constant>{%c8}
+  // CHECK: %[[RES2:.+]] = stream.resource.subview %[[IF]]#0[%c16] : !stream.resource<constant>{%c48} -> !stream.resource<constant>{%c24}
+  // CHECK: %[[RES1:.+]] = stream.resource.subview %[[IF]]#1[%c0] : !stream.resource<constant>{%c48} -> !stream.resource<constant>{%c40}
+
+  // CHECK: return %[[RES0]], %[[RES1]], %[[RES2]], %[[IF]]#2
+  return %0#0, %0#1, %0#2, %0#3 : !stream.resource<constant>, !stream.resource<constant>, !stream.resource<constant>, !stream.timepoint
+}
+
+// -----
+
+// Tests that immutable constants with identical contents share storage even if
+// their shapes differ while variables always get their own storage.
+
+//      CHECK: #composite_of_64b = #util.composite<64xi8, [
+// CHECK-NEXT:   dense<[1, 2]> : tensor<2xi32>,
+// CHECK-NEXT:   dense<0> : vector<56xi8>,
+// CHECK-NEXT: ]>
+
+// CHECK-LABEL: @dedupResourceConstants
+func.func @dedupResourceConstants() -> (!stream.resource<constant>, !stream.resource<constant>, !stream.resource<constant>, !stream.resource<variable>, !stream.timepoint) {
+  %c8 = arith.constant 8 : index
+
+  // CHECK: util.buffer.constant {alignment = 64 : index} : !util.buffer = #composite_of_64b
+  %0:5 = stream.resource.constants :
+    !stream.resource<constant>{%c8} = dense<[1, 2]> : tensor<2xi32>,
+    !stream.resource<constant>{%c8} = dense<[1, 2]> : tensor<2xi32>,
+    !stream.resource<constant>{%c8} = dense<[[1, 2]]> : tensor<1x2xi32>,
+    !stream.resource<variable>{%c8} = dense<[1, 2]> : tensor<2xi32>
+    => !stream.timepoint
+
+  // CHECK: %[[CONSTANT_IF:.+]]:2 = scf.if {{.+}} -> (!stream.resource<constant>, !stream.timepoint)
+  // CHECK: %[[RES0:.+]] = stream.resource.subview %[[CONSTANT_IF]]#0[%c0] : !stream.resource<constant>{%c64} -> !stream.resource<constant>{%c8}
+  // CHECK: %[[RES1:.+]] = stream.resource.subview %[[CONSTANT_IF]]#0[%c0] : !stream.resource<constant>{%c64} -> !stream.resource<constant>{%c8}
+  // CHECK: %[[RES2:.+]] = stream.resource.subview %[[CONSTANT_IF]]#0[%c0] : !stream.resource<constant>{%c64} -> !stream.resource<constant>{%c8}
+
+  // CHECK: util.buffer.constant {{.+}} = #composite_of_64b
+  // CHECK: %[[VARIABLE_BUFFER:.+]] = stream.resource.alloc {{.+}} : !stream.resource<variable>{%c64}
+  // CHECK: %[[RES3:.+]] = stream.resource.subview %[[VARIABLE_BUFFER]][%c0]
+
+  // CHECK: return %[[RES0]], %[[RES1]], %[[RES2]], %[[RES3]]
+  return %0#0, %0#1, %0#2, %0#3, %0#4 : !stream.resource<constant>, !stream.resource<constant>, !stream.resource<constant>, !stream.resource<variable>, !stream.timepoint
+}
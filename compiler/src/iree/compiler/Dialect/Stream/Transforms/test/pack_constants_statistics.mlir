@@ -0,0 +1,50 @@
+// RUN: iree-opt --pass-pipeline='builtin.module(func.func(iree-stream-pack-constants))' %s | FileCheck %s
+// RUN: iree-opt --pass-pipeline='builtin.module(func.func(iree-stream-pack-constants))' --mlir-pass-statistics %s -o /dev/null 2>&1 | FileCheck %s --check-prefix=STATS
+
+// Tests that resource blobs are deduplicated by their contents with each other
+// and with dense elements holding the same bytes and that the packing
+// statistics account for the stored, padding and elided bytes.
+
+//      CHECK: #composite_of_128b = #util.composite<128xi8, [
+// CHECK-NEXT:   dense_resource<blob0> : tensor<2xi32>,
+// CHECK-NEXT:   dense<0> : vector<56xi8>,
+// CHECK-NEXT:   dense_resource<blob2> : tensor<2xi32>,
+// CHECK-NEXT:   dense<0> : vector<56xi8>,
+// CHECK-NEXT: ]>
+
+// CHECK-LABEL: @dedupBlobConstants
+func.func @dedupBlobConstants() -> (!stream.resource<constant>, !stream.resource<constant>, !stream.resource<constant>, !stream.resource<constant>, !stream.timepoint) {
+  %c8 = arith.constant 8 : index
+
+  // CHECK: util.buffer.constant {alignment = 64 : index} : !util.buffer = #composite_of_128b
+  %0:5 = stream.resource.constants :
+    !stream.resource<constant>{%c8} = dense_resource<blob0> : tensor<2xi32>,
+    !stream.resource<constant>{%c8} = dense_resource<blob1> : tensor<2xi32>,
+    !stream.resource<constant>{%c8} = dense<[1, 2]> : tensor<2xi32>,
+    !stream.resource<constant>{%c8} = dense_resource<blob2> : tensor<2xi32>
+    => !stream.timepoint
+
+  // CHECK: %[[CONSTANT_IF:.+]]:2 = scf.if {{.+}} -> (!stream.resource<constant>, !stream.timepoint)
+  // CHECK: %[[RES0:.+]] = stream.resource.subview %[[CONSTANT_IF]]#0[%c0] : !stream.resource<constant>{%c128} -> !stream.resource<constant>{%c8}
+  // CHECK: %[[RES1:.+]] = stream.resource.subview %[[CONSTANT_IF]]#0[%c0] : !stream.resource<constant>{%c128} -> !stream.resource<constant>{%c8}
+  // CHECK: %[[RES2:.+]] = stream.resource.subview %[[CONSTANT_IF]]#0[%c0] : !stream.resource<constant>{%c128} -> !stream.resource<constant>{%c8}
+  // CHECK: %[[RES3:.+]] = stream.resource.subview %[[CONSTANT_IF]]#0[%c64] : !stream.resource<constant>{%c128} -> !stream.resource<constant>{%c8}
+
+  // CHECK: return %[[RES0]], %[[RES1]], %[[RES2]], %[[RES3]]
+  return %0#0, %0#1, %0#2, %0#3, %0#4 : !stream.resource<constant>, !stream.resource<constant>, !stream.resource<constant>, !stream.resource<constant>, !stream.timepoint
+}
+
+// STATS-DAG: (S) 1 storage-resources
+// STATS-DAG: (S) 16 payload-bytes
+// STATS-DAG: (S) 112 padding-bytes
+// STATS-DAG: (S) 16 deduplicated-bytes
+
+{-#
+  dialect_resources: {
+    builtin: {
+      blob0: "0x040000000100000002000000",
+      blob1: "0x040000000100000002000000",
+      blob2: "0x040000000300000004000000"
+    }
+  }
+#-}
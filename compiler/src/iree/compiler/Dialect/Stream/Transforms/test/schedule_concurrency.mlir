@@ -103,6 +103,62 @@ func.func @partitioningForMaxConcurrency(%arg0: !stream.resource<external>, %arg
 
 // -----
 
+// Tests that when favor=balanced ops with slack are placed using the cost
+// model: the small splat is deferred to run alongside the large dispatch (so
+// its result is live for less time) and the independent dispatches at the end
+// of the region share a wave.
+
+// CHECK-LABEL: @partitioningForBalanced
+// CHECK-SAME: (%[[ARG0:.+]]: !stream.resource<external>, %[[ARG1:.+]]: !stream.resource<external>)
+func.func @partitioningForBalanced(%arg0: !stream.resource<external>, %arg1: !stream.resource<external>) -> (!stream.resource<external>, !stream.resource<external>)
+    attributes {stream.partitioning = #stream.partitioning_config<"balanced">} {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c20 = arith.constant 20 : index
+  %c80 = arith.constant 80 : index
+  %c1280 = arith.constant 1280 : index
+  %c255_i32 = arith.constant 255 : i32
+  // CHECK: stream.async.execute
+  %results:2, %result_timepoint = stream.async.execute
+      // CHECK-SAME: with(%[[ARG1]] as %[[ARG1_CAPTURE:.+]]: !stream.resource<external>{%c80},
+      // CHECK-SAME:      %[[ARG0]] as %[[ARG0_CAPTURE:.+]]: !stream.resource<external>{%c20})
+      with(%arg1 as %arg2: !stream.resource<external>{%c80},
+           %arg0 as %arg3: !stream.resource<external>{%c20})
+      -> (!stream.resource<external>{%c20}, !stream.resource<external>{%c20}) {
+
+    // CHECK: %[[SPLAT0:.+]] = stream.async.splat %c255_i32 : i32 -> !stream.resource<transient>{%c1280}
+    %1 = stream.async.splat %c255_i32 : i32 -> !stream.resource<transient>{%c1280}
+
+    // CHECK: %[[CON0:.+]]:2 = stream.async.concurrent
+    // CHECK-SAME: with(%[[SPLAT0]] as %[[SPLAT0_CAPTURE:.+]]: !stream.resource<transient>{%c1280},
+    // CHECK-SAME:      %[[ARG1_CAPTURE]] as %[[ARG1_CON0_CAPTURE:.+]]: !stream.resource<external>{%c80})
+    // CHECK-SAME: -> (!stream.resource<transient>{%c1280}, !stream.resource<external>{%c20}) {
+    // CHECK-NEXT: %[[DISPATCH0:.+]] = stream.async.dispatch @ex::@dispatch_0[%c1, %c1, %c1](%[[SPLAT0_CAPTURE]][{{.+}}], %[[ARG1_CON0_CAPTURE]][{{.+}}])
+    %2 = stream.async.dispatch @ex::@dispatch_0[%c1, %c1, %c1](%1[%c0 to %c1280 for %c1280], %arg2[%c0 to %c80 for %c80]) : (!stream.resource<transient>{%c1280}, !stream.resource<external>{%c80}) -> %1{%c1280}
+    // CHECK-NEXT: %[[SPLAT1:.+]] = stream.async.splat %c255_i32 : i32 -> !stream.resource<external>{%c20}
+    %3 = stream.async.splat %c255_i32 : i32 -> !stream.resource<external>{%c20}
+    // CHECK-NEXT: stream.yield %[[DISPATCH0]], %[[SPLAT1]] : !stream.resource<transient>{%c1280}, !stream.resource<external>{%c20}
+
+    // CHECK: %[[CON1:.+]]:2 = stream.async.concurrent
+    // CHECK-SAME: with(%[[ARG0_CAPTURE]] as %[[ARG0_CON1_CAPTURE:.+]]: !stream.resource<external>{%c20},
+    // CHECK-SAME:      %[[CON0]]#1 as %[[CON0_1_CAPTURE:.+]]: !stream.resource<external>{%c20},
+    // CHECK-SAME:      %[[CON0]]#0 as %[[CON0_0_CAPTURE:.+]]: !stream.resource<transient>{%c1280})
+    // CHECK-SAME: -> (!stream.resource<external>{%c20}, !stream.resource<external>{%c20}) {
+    // CHECK-NEXT: %[[DISPATCH1:.+]] = stream.async.dispatch @ex::@dispatch_1[%c1, %c1, %c1](%[[ARG0_CON1_CAPTURE]][{{.+}}], %[[CON0_1_CAPTURE]][{{.+}}])
+    %4 = stream.async.dispatch @ex::@dispatch_1[%c1, %c1, %c1](%arg3[%c0 to %c20 for %c20], %3[%c0 to %c20 for %c20]) : (!stream.resource<external>{%c20}, !stream.resource<external>{%c20}) -> %3{%c20}
+    // CHECK-NEXT: %[[DISPATCH2:.+]] = stream.async.dispatch @ex::@dispatch_2[%c1, %c1, %c1](%[[CON0_0_CAPTURE]][{{.+}}])
+    %5 = stream.async.dispatch @ex::@dispatch_2[%c1, %c1, %c1](%2[%c0 to %c1280 for %c1280]) : (!stream.resource<transient>{%c1280}) -> !stream.resource<external>{%c20}
+    // CHECK-NEXT: stream.yield %[[DISPATCH1]], %[[DISPATCH2]]
+
+    // CHECK: stream.yield %[[CON1]]#1, %[[CON1]]#0
+    stream.yield %5, %4 : !stream.resource<external>{%c20}, !stream.resource<external>{%c20}
+  } => !stream.timepoint
+  %0:2 = stream.timepoint.await %result_timepoint => %results#0, %results#1 : !stream.resource<external>{%c20}, !stream.resource<external>{%c20}
+  return %0#0, %0#1 : !stream.resource<external>, !stream.resource<external>
+}
+
+// -----
+
 // TODO(#11249): add a test for in-place collectives (send == recv).
 
 // Tests that multiple collective ops will get grouped together in a concurrent
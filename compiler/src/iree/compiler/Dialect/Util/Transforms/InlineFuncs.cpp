@@ -0,0 +1,299 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/Util/IR/UtilDialect.h"
+#include "iree/compiler/Dialect/Util/IR/UtilOps.h"
+#include "iree/compiler/Dialect/Util/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Util/Transforms/Passes.h"
+#include "iree/compiler/Utils/PassUtils.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SCCIterator.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Analysis/CallGraph.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Interfaces/FunctionInterfaces.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/InliningUtils.h"
+
+#define DEBUG_TYPE "iree-util-inline-funcs"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Util {
+namespace {
+
+// Names of the globals accessed within a function and the number of
+// operations it contains. Cached per caller and updated as callees are inlined
+// into it.
+struct CallerInfo {
+  DenseSet<StringRef> accessedGlobals;
+  int64_t size = 0;
+};
+
+}  // namespace
+
+// Returns the name of the global accessed by |op| or an empty string if it is
+// not a direct global load or store.
+static StringRef getAccessedGlobalName(Operation *op) {
+  if (auto loadOp = dyn_cast<IREE::Util::GlobalLoadOpInterface>(op)) {
+    return loadOp.getGlobalName();
+  } else if (auto storeOp = dyn_cast<IREE::Util::GlobalStoreOpInterface>(op)) {
+    return storeOp.getGlobalName();
+  }
+  return {};
+}
+
+static CallerInfo analyzeCaller(FunctionOpInterface callerOp) {
+  CallerInfo info;
+  callerOp.walk([&](Operation *op) {
+    if (op == callerOp.getOperation()) return;
+    ++info.size;
+    StringRef globalName = getAccessedGlobalName(op);
+    if (!globalName.empty()) info.accessedGlobals.insert(globalName);
+  });
+  return info;
+}
+
+// Returns all callables that are part of a call graph cycle of any length,
+// including functions that directly call themselves. Inlining never creates
+// new cycles so the set remains valid as calls are inlined.
+static DenseSet<Operation *> findRecursiveCallables(mlir::ModuleOp moduleOp) {
+  DenseSet<Operation *> recursiveOps;
+  CallGraph callGraph(moduleOp);
+  for (auto it = llvm::scc_begin(&callGraph); !it.isAtEnd(); ++it) {
+    if (!it.hasCycle()) continue;
+    for (auto *node : *it) {
+      if (node->isExternal()) continue;
+      recursiveOps.insert(node->getCallableRegion()->getParentOp());
+    }
+  }
+  return recursiveOps;
+}
+
+// Returns true if |callOp| can be replaced with the body of |calleeOp|.
+static bool isLegalToInlineCall(func::CallOp callOp, func::FuncOp calleeOp,
+                                FunctionOpInterface callerOp,
+                                const DenseSet<Operation *> &recursiveOps) {
+  if (calleeOp.isExternal() || calleeOp->hasAttr("noinline")) return false;
+  if (recursiveOps.contains(calleeOp.getOperation())) return false;
+  // Callees with control flow can only be inlined directly into a function
+  // body; nested regions (like scf.if) may only have a single block.
+  if (!llvm::hasSingleElement(calleeOp.getBody()) &&
+      callOp->getParentOp() != callerOp.getOperation()) {
+    return false;
+  }
+  return true;
+}
+
+// Returns the estimated number of operations |calleeOp| will add to the caller
+// of |callOp| once inlined and cleaned up.
+//
+// The estimate depends on the call site: operations only depending on
+// constants or constant call operands are expected to fold away once inlined
+// and accesses to globals the caller already accesses are expected to be
+// merged with those by global access simplification. No specialized clones of
+// the callee are created for calls that are not inlined.
+static int64_t estimateInlinedSize(func::CallOp callOp, func::FuncOp calleeOp,
+                                   const CallerInfo &callerInfo) {
+  DenseSet<Value> constantValues;
+  for (auto [arg, operand] :
+       llvm::zip_equal(calleeOp.getArguments(), callOp.getOperands())) {
+    if (matchPattern(operand, m_Constant())) constantValues.insert(arg);
+  }
+  int64_t size = 0;
+  calleeOp.walk([&](Operation *op) {
+    if (op == calleeOp || op->hasTrait<OpTrait::IsTerminator>()) return;
+    if (op->hasTrait<OpTrait::ConstantLike>()) {
+      constantValues.insert(op->result_begin(), op->result_end());
+      return;
+    }
+    StringRef globalName = getAccessedGlobalName(op);
+    if (!globalName.empty() &&
+        callerInfo.accessedGlobals.contains(globalName)) {
+      return;
+    }
+    if (op->getNumRegions() == 0 && op->getNumOperands() > 0 &&
+        isMemoryEffectFree(op) &&
+        llvm::all_of(op->getOperands(), [&](Value operand) {
+          return constantValues.contains(operand);
+        })) {
+      constantValues.insert(op->result_begin(), op->result_end());
+      return;
+    }
+    ++size;
+  });
+  return size;
+}
+
+// Returns the number of operations that inlining |calleeOp| adds to a caller.
+// Entry block terminators are not counted as their operands replace the call
+// results.
+static int64_t countInlinedOps(func::FuncOp calleeOp) {
+  bool isSingleBlock = llvm::hasSingleElement(calleeOp.getBody());
+  int64_t count = 0;
+  calleeOp.walk([&](Operation *op) {
+    if (op == calleeOp.getOperation()) return;
+    if (isSingleBlock && op->getParentOp() == calleeOp.getOperation() &&
+        op->hasTrait<OpTrait::IsTerminator>()) {
+      return;
+    }
+    ++count;
+  });
+  return count;
+}
+
+namespace {
+
+// Number of symbol uses of each top-level symbol in the module. Computed once
+// per run and updated as calls are inlined so that single-use queries do not
+// rescan the module. Counts are unknown if any op has unknown symbol uses.
+class SymbolUseCounts {
+ public:
+  explicit SymbolUseCounts(mlir::ModuleOp moduleOp) {
+    auto uses = SymbolTable::getSymbolUses(moduleOp);
+    if (!uses) {
+      isKnown = false;
+      return;
+    }
+    for (auto &use : *uses) ++counts[use.getSymbolRef().getRootReference()];
+  }
+
+  // Returns true if |symbolOp| is known to have exactly |count| uses.
+  bool hasUseCount(Operation *symbolOp, int64_t count) const {
+    return isKnown &&
+           counts.lookup(SymbolTable::getSymbolName(symbolOp)) == count;
+  }
+
+  // Updates the counts for |callOp| having been replaced by |calleeOp|'s body.
+  void recordInlinedCall(func::CallOp callOp, func::FuncOp calleeOp) {
+    --counts[callOp.getCalleeAttr().getRootReference()];
+    auto uses = SymbolTable::getSymbolUses(&calleeOp.getBody());
+    if (!uses) {
+      isKnown = false;
+      return;
+    }
+    for (auto &use : *uses) ++counts[use.getSymbolRef().getRootReference()];
+  }
+
+ private:
+  DenseMap<StringAttr, int64_t> counts;
+  bool isKnown = true;
+};
+
+}  // namespace
+
+namespace {
+
+// Inlines func.call ops whose callees are small enough at the call site that
+// the call overhead (a VM frame enter/leave at runtime) dominates or whose
+// callee has no other callers. Unlike the upstream inliner this does not
+// inline everything so that it can run as part of the whole-program
+// optimization pipeline where inlining exposes constants and global accesses
+// across calls to IPO and global folding.
+class InlineFuncsPass : public InlineFuncsBase<InlineFuncsPass> {
+ public:
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<IREE::Util::UtilDialect>();
+  }
+
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+    SymbolTable symbolTable(moduleOp);
+
+    // Gather all call sites in top-level functions up front. Calls introduced
+    // by inlining are considered on the next run of the pass (usually as part
+    // of a fixed-point iteration).
+    SmallVector<func::CallOp> callOps;
+    for (auto callerOp : moduleOp.getOps<FunctionOpInterface>()) {
+      callerOp.walk([&](func::CallOp callOp) { callOps.push_back(callOp); });
+    }
+
+    DenseSet<Operation *> recursiveOps = findRecursiveCallables(moduleOp);
+    SymbolUseCounts useCounts(moduleOp);
+
+    InlinerInterface inlinerInterface(&getContext());
+    DenseMap<Operation *, CallerInfo> callerInfos;
+    llvm::SetVector<func::FuncOp> inlinedCalleeOps;
+    for (auto callOp : callOps) {
+      auto calleeOp = symbolTable.lookup<func::FuncOp>(callOp.getCallee());
+      auto callerOp = callOp->getParentOfType<FunctionOpInterface>();
+      if (!calleeOp || !callerOp) continue;
+      if (!isLegalToInlineCall(callOp, calleeOp, callerOp, recursiveOps)) {
+        continue;
+      }
+
+      auto callerInfoIt = callerInfos.find(callerOp.getOperation());
+      if (callerInfoIt == callerInfos.end()) {
+        callerInfoIt =
+            callerInfos
+                .try_emplace(callerOp.getOperation(), analyzeCaller(callerOp))
+                .first;
+      }
+      CallerInfo &callerInfo = callerInfoIt->second;
+
+      int64_t inlinedSize = estimateInlinedSize(callOp, calleeOp, callerInfo);
+      bool isProfitable = inlinedSize <= maxCalleeSize ||
+                          (inlinedSize <= maxSingleUseCalleeSize &&
+                           calleeOp.isPrivate() &&
+                           useCounts.hasUseCount(calleeOp, 1));
+      if (!isProfitable || callerInfo.size + inlinedSize > maxCallerSize) {
+        LLVM_DEBUG(llvm::dbgs() << "not inlining @" << calleeOp.getName()
+                                << " at " << callOp.getLoc() << " (size "
+                                << inlinedSize << ")\n");
+        continue;
+      }
+
+      LLVM_DEBUG(llvm::dbgs() << "inlining @" << calleeOp.getName() << " at "
+                              << callOp.getLoc() << " (size " << inlinedSize
+                              << ")\n");
+      if (failed(mlir::inlineCall(inlinerInterface, callOp, calleeOp,
+                                  &calleeOp.getBody(),
+                                  /*shouldCloneInlinedRegion=*/true))) {
+        continue;
+      }
+      useCounts.recordInlinedCall(callOp, calleeOp);
+      callOp.erase();
+      inlinedCalleeOps.insert(calleeOp);
+
+      // The call op itself was removed.
+      callerInfo.size += countInlinedOps(calleeOp) - 1;
+      calleeOp.walk([&](Operation *op) {
+        StringRef globalName = getAccessedGlobalName(op);
+        if (!globalName.empty()) callerInfo.accessedGlobals.insert(globalName);
+      });
+    }
+    if (inlinedCalleeOps.empty()) return;
+
+    // Drop private functions that were inlined into all of their callers.
+    for (auto calleeOp : inlinedCalleeOps) {
+      if (calleeOp.isPrivate() && useCounts.hasUseCount(calleeOp, 0)) {
+        calleeOp.erase();
+      }
+    }
+
+    // When running under the FixedPointIterator pass we need to signal when we
+    // made a change.
+    signalFixedPointModified(moduleOp);
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<OperationPass<mlir::ModuleOp>> createInlineFuncsPass() {
+  return std::make_unique<InlineFuncsPass>();
+}
+
+}  // namespace Util
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -0,0 +1,186 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(iree-util-inline-funcs{max-callee-size=2 max-single-use-callee-size=3})" %s | FileCheck %s
+
+// Tests that small callees are inlined into all callers and then dropped.
+
+// CHECK-NOT: func.func private @small_callee
+func.func private @small_callee(%arg0: index) -> index {
+  %0 = arith.addi %arg0, %arg0 : index
+  return %0 : index
+}
+
+// CHECK-LABEL: func.func @small_caller_a
+// CHECK-SAME: (%[[ARG0:.+]]: index)
+func.func @small_caller_a(%arg0: index) -> index {
+  // CHECK-NOT: call
+  // CHECK: %[[ADD:.+]] = arith.addi %[[ARG0]], %[[ARG0]]
+  %0 = call @small_callee(%arg0) : (index) -> index
+  // CHECK: return %[[ADD]]
+  return %0 : index
+}
+
+// CHECK-LABEL: func.func @small_caller_b
+func.func @small_caller_b(%arg0: index) -> index {
+  // CHECK-NOT: call
+  // CHECK: arith.addi
+  %0 = call @small_callee(%arg0) : (index) -> index
+  return %0 : index
+}
+
+// -----
+
+// Tests that large callees are only inlined when they have a single caller.
+
+// CHECK-LABEL: func.func private @large_callee
+func.func private @large_callee(%arg0: index) -> index {
+  %0 = arith.addi %arg0, %arg0 : index
+  %1 = arith.muli %0, %arg0 : index
+  %2 = arith.subi %1, %arg0 : index
+  return %2 : index
+}
+
+// CHECK-LABEL: func.func @large_caller_a
+func.func @large_caller_a(%arg0: index) -> index {
+  // CHECK: call @large_callee
+  %0 = call @large_callee(%arg0) : (index) -> index
+  return %0 : index
+}
+
+// CHECK-LABEL: func.func @large_caller_b
+func.func @large_caller_b(%arg0: index) -> index {
+  // CHECK: call @large_callee
+  %0 = call @large_callee(%arg0) : (index) -> index
+  return %0 : index
+}
+
+// CHECK-NOT: func.func private @single_use_callee
+func.func private @single_use_callee(%arg0: index) -> index {
+  %0 = arith.addi %arg0, %arg0 : index
+  %1 = arith.muli %0, %arg0 : index
+  %2 = arith.subi %1, %arg0 : index
+  return %2 : index
+}
+
+// CHECK-LABEL: func.func @single_use_caller
+func.func @single_use_caller(%arg0: index) -> index {
+  // CHECK-NOT: call
+  // CHECK: arith.addi
+  // CHECK: arith.muli
+  // CHECK: arith.subi
+  %0 = call @single_use_callee(%arg0) : (index) -> index
+  return %0 : index
+}
+
+// -----
+
+// Tests that callee ops that will fold away given constant call operands do not
+// count against the budget. Call sites that are not inlined keep calling the
+// original callee as no specialized clones are created.
+
+// CHECK-LABEL: func.func private @constant_foldable_callee
+func.func private @constant_foldable_callee(%arg0: index, %arg1: index) -> index {
+  %0 = arith.addi %arg0, %arg0 : index
+  %1 = arith.muli %0, %arg0 : index
+  %2 = arith.addi %1, %arg0 : index
+  %3 = arith.subi %2, %arg1 : index
+  return %3 : index
+}
+
+// CHECK-LABEL: func.func @constant_caller
+func.func @constant_caller(%arg0: index) -> index {
+  %c4 = arith.constant 4 : index
+  // CHECK-NOT: call
+  // CHECK: arith.subi
+  %0 = call @constant_foldable_callee(%c4, %arg0) : (index, index) -> index
+  return %0 : index
+}
+
+// CHECK-LABEL: func.func @dynamic_caller
+func.func @dynamic_caller(%arg0: index) -> index {
+  // CHECK: call @constant_foldable_callee
+  %0 = call @constant_foldable_callee(%arg0, %arg0) : (index, index) -> index
+  return %0 : index
+}
+
+// -----
+
+// Tests that accesses to globals the caller already accesses are not counted
+// as they will be merged with those of the caller.
+
+util.global private mutable @counter = 0 : index
+
+// CHECK-LABEL: func.func private @increment_counter
+func.func private @increment_counter() {
+  %c1 = arith.constant 1 : index
+  %0 = util.global.load @counter : index
+  %1 = arith.addi %0, %c1 : index
+  %2 = arith.muli %1, %1 : index
+  util.global.store %2, @counter : index
+  return
+}
+
+// CHECK-LABEL: func.func @global_caller
+func.func @global_caller() -> index {
+  // CHECK-NOT: call
+  // CHECK: util.global.store %{{.+}}, @counter
+  call @increment_counter() : () -> ()
+  // CHECK: %[[VALUE:.+]] = util.global.load @counter
+  %0 = util.global.load @counter : index
+  // CHECK: return %[[VALUE]]
+  return %0 : index
+}
+
+// CHECK-LABEL: func.func @non_global_caller
+func.func @non_global_caller() {
+  // CHECK: call @increment_counter
+  call @increment_counter() : () -> ()
+  return
+}
+
+// -----
+
+// Tests that noinline and recursive functions are not inlined, including
+// functions that are part of longer call cycles.
+
+// CHECK-LABEL: func.func private @noinline_callee
+func.func private @noinline_callee(%arg0: index) -> index attributes {noinline} {
+  return %arg0 : index
+}
+
+// CHECK-LABEL: func.func private @recursive_callee
+func.func private @recursive_callee(%arg0: index) -> index {
+  // CHECK: call @recursive_callee
+  %0 = call @recursive_callee(%arg0) : (index) -> index
+  return %0 : index
+}
+
+// CHECK-LABEL: func.func private @cycle_a
+func.func private @cycle_a(%arg0: index) -> index {
+  // CHECK: call @cycle_b
+  %0 = call @cycle_b(%arg0) : (index) -> index
+  return %0 : index
+}
+
+// CHECK-LABEL: func.func private @cycle_b
+func.func private @cycle_b(%arg0: index) -> index {
+  // CHECK: call @cycle_c
+  %0 = call @cycle_c(%arg0) : (index) -> index
+  return %0 : index
+}
+
+// CHECK-LABEL: func.func private @cycle_c
+func.func private @cycle_c(%arg0: index) -> index {
+  // CHECK: call @cycle_a
+  %0 = call @cycle_a(%arg0) : (index) -> index
+  return %0 : index
+}
+
+// CHECK-LABEL: func.func @noinline_caller
+func.func @noinline_caller(%arg0: index) -> (index, index, index) {
+  // CHECK: call @noinline_callee
+  %0 = call @noinline_callee(%arg0) : (index) -> index
+  // CHECK: call @recursive_callee
+  %1 = call @recursive_callee(%arg0) : (index) -> index
+  // CHECK: call @cycle_a
+  %2 = call @cycle_a(%arg0) : (index) -> index
+  return %0, %1, %2 : index, index, index
+}
@@ -37,6 +37,23 @@ void TargetOptions::bindOptions(OptionsBinder &binder) {
       llvm::cl::desc(
           "Prefer optimizations that reduce VM stack usage over performance."),
       llvm::cl::cat(vmTargetOptionsCategory));
+  binder.opt<std::string>(
+      "iree-vm-target-parameter-archive", parameterArchivePath,
+      llvm::cl::desc("Path of a parameter archive (.irpa) to write large "
+                     "constants into instead of embedding them in the module. "
+                     "The archive must be provided at runtime."),
+      llvm::cl::cat(vmTargetOptionsCategory));
+  binder.opt<std::string>(
+      "iree-vm-target-parameter-archive-scope", parameterArchiveScope,
+      llvm::cl::desc("Scope the parameter archive is registered under at "
+                     "runtime."),
+      llvm::cl::cat(vmTargetOptionsCategory));
+  binder.opt<int64_t>(
+      "iree-vm-target-parameter-archive-minimum-size",
+      parameterArchiveMinimumSize,
+      llvm::cl::desc("Minimum size in bytes of a constant to move into the "
+                     "parameter archive."),
+      llvm::cl::cat(vmTargetOptionsCategory));
 }
 
 }  // namespace VM
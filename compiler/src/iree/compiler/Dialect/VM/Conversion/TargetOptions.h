@@ -7,6 +7,8 @@
 #ifndef IREE_COMPILER_DIALECT_VM_CONVERSION_TARGETOPTIONS_H_
 #define IREE_COMPILER_DIALECT_VM_CONVERSION_TARGETOPTIONS_H_
 
+#include <string>
+
 #include "iree/compiler/Utils/OptionUtils.h"
 #include "mlir/Transforms/DialectConversion.h"
 
@@ -32,6 +34,14 @@ struct TargetOptions {
   // Prefer optimizations that reduce VM stack usage over performance.
   bool optimizeForStackSize = false;
 
+  // Path of a parameter archive to write large constants into instead of
+  // embedding them in the module. Empty to embed all constants.
+  std::string parameterArchivePath;
+  // Scope the parameter archive is registered under at runtime.
+  std::string parameterArchiveScope;
+  // Minimum size in bytes of a constant to move into the parameter archive.
+  int64_t parameterArchiveMinimumSize = 4096;
+
   void bindOptions(OptionsBinder &binder);
   using FromFlags = OptionsFromFlags<TargetOptions>;
 };
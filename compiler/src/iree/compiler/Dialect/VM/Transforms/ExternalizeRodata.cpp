@@ -0,0 +1,273 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <map>
+#include <string>
+#include <utility>
+
+#include "iree/compiler/Dialect/Util/IR/UtilDialect.h"
+#include "iree/compiler/Dialect/Util/IR/UtilOps.h"
+#include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
+#include "iree/compiler/Dialect/VM/Transforms/Passes.h"
+#include "iree/schemas/parameter_archive.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/SHA256.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/FileUtilities.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace VM {
+
+// Name of the runtime import used to resolve externalized parameters.
+// Implemented by the io_parameters native module.
+static constexpr StringLiteral kLookupImportName = "io_parameters.lookup";
+
+// Streams everything written to it into a SHA256 hasher so that large values
+// can be hashed without materializing their serialized form.
+class HashingOStream : public llvm::raw_ostream {
+ public:
+  explicit HashingOStream(llvm::SHA256 &hasher) : hasher(hasher) {}
+  ~HashingOStream() override { flush(); }
+
+ private:
+  void write_impl(const char *ptr, size_t size) override {
+    hasher.update(StringRef(ptr, size));
+    position += size;
+  }
+  uint64_t current_pos() const override { return position; }
+
+  llvm::SHA256 &hasher;
+  uint64_t position = 0;
+};
+
+// A unique parameter value to be written to the archive.
+struct ArchiveEntry {
+  IREE::Util::SerializableAttrInterface value;
+  uint64_t length = 0;
+  uint64_t dataOffset = 0;
+};
+
+static uint64_t alignArchiveOffset(uint64_t offset) {
+  return llvm::alignTo(offset, IREE_IO_PARAMETER_ARCHIVE_DATA_ALIGNMENT);
+}
+
+// Returns a key derived from the serialized contents of |value|.
+// Keys are stable across compilations such that archives produced for
+// different model variants sharing the same weights are interchangeable and
+// identical values within a program share a single archive entry.
+static FailureOr<std::string> deriveParameterKey(
+    IREE::Util::SerializableAttrInterface value) {
+  llvm::SHA256 hasher;
+  {
+    HashingOStream os(hasher);
+    if (failed(value.serializeToStream(llvm::support::endianness::little, os)))
+      return failure();
+  }
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+// Writes the archive in the format defined by iree/schemas/parameter_archive.h
+// with |entries| sorted by key (as std::map orders them).
+static LogicalResult writeParameterArchive(
+    Location loc, std::map<std::string, ArchiveEntry> &entries,
+    llvm::raw_ostream &os) {
+  const uint64_t entryTableOffset = sizeof(iree_io_parameter_archive_header_t);
+  const uint64_t stringTableOffset =
+      entryTableOffset +
+      entries.size() * sizeof(iree_io_parameter_archive_entry_t);
+  uint64_t stringTableLength = 0;
+  uint64_t dataLength = 0;
+  for (auto &[key, entry] : entries) {
+    stringTableLength += key.size();
+    entry.dataOffset = dataLength;
+    dataLength = alignArchiveOffset(dataLength + entry.length);
+  }
+  const uint64_t dataOffset =
+      alignArchiveOffset(stringTableOffset + stringTableLength);
+
+  llvm::support::endian::Writer writer(os, llvm::support::endianness::little);
+  writer.write<uint32_t>(IREE_IO_PARAMETER_ARCHIVE_MAGIC);
+  writer.write<uint32_t>(IREE_IO_PARAMETER_ARCHIVE_VERSION);
+  writer.write<uint64_t>(entries.size());
+  writer.write<uint64_t>(entryTableOffset);
+  writer.write<uint64_t>(stringTableOffset);
+  writer.write<uint64_t>(stringTableLength);
+  writer.write<uint64_t>(dataOffset);
+  writer.write<uint64_t>(dataOffset + dataLength);
+
+  uint64_t keyOffset = 0;
+  for (auto &[key, entry] : entries) {
+    writer.write<uint64_t>(keyOffset);
+    writer.write<uint64_t>(key.size());
+    writer.write<uint64_t>(entry.dataOffset);
+    writer.write<uint64_t>(entry.length);
+    keyOffset += key.size();
+  }
+  for (auto &[key, entry] : entries) os << key;
+
+  os.write_zeros(dataOffset - os.tell());
+  for (auto &[key, entry] : entries) {
+    uint64_t startOffset = os.tell();
+    if (failed(entry.value.serializeToStream(llvm::support::endianness::little,
+                                             os))) {
+      return mlir::emitError(loc)
+             << "failed to serialize parameter '" << key << "'";
+    }
+    uint64_t actualLength = os.tell() - startOffset;
+    if (actualLength != entry.length) {
+      return mlir::emitError(loc)
+             << "parameter '" << key << "' serialized to " << actualLength
+             << " bytes but expected " << entry.length;
+    }
+    os.write_zeros(alignArchiveOffset(os.tell()) - os.tell());
+  }
+  return success();
+}
+
+class ExternalizeRodataPass
+    : public PassWrapper<ExternalizeRodataPass,
+                         OperationPass<mlir::ModuleOp>> {
+ public:
+  explicit ExternalizeRodataPass(TargetOptions targetOptions)
+      : targetOptions_(targetOptions) {}
+
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<IREE::Util::UtilDialect, func::FuncDialect>();
+  }
+
+  StringRef getArgument() const override {
+    return "iree-vm-externalize-rodata";
+  }
+
+  StringRef getDescription() const override {
+    return "Moves large util.buffer.constant values into an external "
+           "parameter archive loaded at runtime.";
+  }
+
+  void runOnOperation() override {
+    if (targetOptions_.parameterArchivePath.empty()) return;
+    auto moduleOp = getOperation();
+
+    // Gather all constants large enough to be worth externalizing. Constants
+    // with a mime type are opaque blobs (executables/etc) that are consumed
+    // from the module directly and those requiring more than page alignment
+    // can't be served from the archive.
+    std::map<std::string, ArchiveEntry> entries;
+    SmallVector<std::pair<IREE::Util::BufferConstantOp, std::string>>
+        constantOps;
+    auto walkResult = moduleOp.walk([&](IREE::Util::BufferConstantOp op) {
+      if (op.getMimeType().has_value()) return WalkResult::advance();
+      if (op.getAlignment().has_value() &&
+          op.getAlignment()->getZExtValue() >
+              IREE_IO_PARAMETER_ARCHIVE_DATA_ALIGNMENT) {
+        return WalkResult::advance();
+      }
+      auto value = llvm::dyn_cast<IREE::Util::SerializableAttrInterface>(
+          op.getValue());
+      if (!value) return WalkResult::advance();
+      int64_t storageSize = value.getStorageSize();
+      if (storageSize < targetOptions_.parameterArchiveMinimumSize) {
+        return WalkResult::advance();
+      }
+      auto key = deriveParameterKey(value);
+      if (failed(key)) {
+        op.emitError() << "failed to serialize constant for externalization";
+        return WalkResult::interrupt();
+      }
+      auto &entry = entries[*key];
+      entry.value = value;
+      entry.length = static_cast<uint64_t>(storageSize);
+      constantOps.push_back(std::make_pair(op, *key));
+      return WalkResult::advance();
+    });
+    if (walkResult.wasInterrupted()) return signalPassFailure();
+    if (constantOps.empty()) return;
+
+    // Write the archive. We do this before changing the IR so that failures
+    // leave the program untouched.
+    std::string error;
+    auto file =
+        mlir::openOutputFile(targetOptions_.parameterArchivePath, &error);
+    if (!file) {
+      moduleOp.emitError() << "failed to open parameter archive '"
+                           << targetOptions_.parameterArchivePath
+                           << "': " << error;
+      return signalPassFailure();
+    }
+    if (failed(writeParameterArchive(moduleOp.getLoc(), entries, file->os()))) {
+      return signalPassFailure();
+    }
+    file->os().flush();
+    if (file->os().has_error()) {
+      moduleOp.emitError() << "failed to write parameter archive '"
+                           << targetOptions_.parameterArchivePath << "'";
+      return signalPassFailure();
+    }
+    file->keep();
+
+    // Declare the lookup import; it's converted to a vm.import along with all
+    // other external functions.
+    auto bufferType = IREE::Util::BufferType::get(&getContext());
+    auto lookupOp = moduleOp.lookupSymbol<func::FuncOp>(kLookupImportName);
+    if (!lookupOp) {
+      auto moduleBuilder = OpBuilder::atBlockBegin(moduleOp.getBody());
+      lookupOp = moduleBuilder.create<func::FuncOp>(
+          moduleOp.getLoc(), kLookupImportName,
+          moduleBuilder.getFunctionType({bufferType, bufferType},
+                                        {bufferType}));
+      lookupOp.setPrivate();
+      lookupOp->setAttr("nosideeffects", moduleBuilder.getUnitAttr());
+    }
+
+    // Replace each constant with a lookup of its parameter.
+    for (auto [constantOp, key] : constantOps) {
+      OpBuilder builder(constantOp);
+      auto loc = constantOp.getLoc();
+      Value scope;
+      if (targetOptions_.parameterArchiveScope.empty()) {
+        scope = builder.create<IREE::Util::NullOp>(loc, bufferType);
+      } else {
+        scope = builder.create<IREE::Util::BufferConstantOp>(
+            loc, /*name=*/StringAttr{},
+            builder.getStringAttr(targetOptions_.parameterArchiveScope),
+            /*alignment=*/IntegerAttr{}, /*mime_type=*/StringAttr{});
+      }
+      Value keyBuffer = builder.create<IREE::Util::BufferConstantOp>(
+          loc, /*name=*/StringAttr{}, builder.getStringAttr(key),
+          /*alignment=*/IntegerAttr{}, /*mime_type=*/StringAttr{});
+      auto callOp = builder.create<func::CallOp>(loc, lookupOp,
+                                                 ValueRange{scope, keyBuffer});
+      constantOp.replaceAllUsesWith(callOp.getResult(0));
+      constantOp.erase();
+    }
+  }
+
+ private:
+  TargetOptions targetOptions_;
+};
+
+std::unique_ptr<OperationPass<mlir::ModuleOp>> createExternalizeRodataPass(
+    TargetOptions targetOptions) {
+  return std::make_unique<ExternalizeRodataPass>(targetOptions);
+}
+
+static PassRegistration<ExternalizeRodataPass> pass([] {
+  auto options = TargetOptions::FromFlags::get();
+  return std::make_unique<ExternalizeRodataPass>(options);
+});
+
+}  // namespace VM
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -90,6 +90,11 @@ void buildVMTransformPassPipeline(OpPassManager &passManager,
   passManager.addPass(IREE::Util::createPropagateSubrangesPass());
   addCleanupPatterns(passManager);
 
+  // Move large constants into an external parameter archive, if requested.
+  if (!targetOptions.parameterArchivePath.empty()) {
+    passManager.addPass(createExternalizeRodataPass(targetOptions));
+  }
+
   // Convert std/util/etc -> VM, along with any other dialects implementing the
   // VM conversion dialect interface.
   passManager.addPass(createConversionPass(targetOptions));
@@ -43,6 +43,11 @@ void registerVMTransformPassPipeline();
 // Conversion
 //===----------------------------------------------------------------------===//
 
+// Moves large util.buffer.constant values into the parameter archive specified
+// in |targetOptions| and replaces them with lookups at runtime.
+std::unique_ptr<OperationPass<mlir::ModuleOp>> createExternalizeRodataPass(
+    TargetOptions targetOptions);
+
 // Converts from various dialects (standard, HAL, etc) to the VM dialect.
 std::unique_ptr<OperationPass<mlir::ModuleOp>> createConversionPass(
     TargetOptions targetOptions);
@@ -103,6 +108,7 @@ createConvertStandardToVMTestPass();
 inline void registerVMPasses() {
   auto targetOptions = TargetOptions::FromFlags::get();
   registerVMTransformPassPipeline();
+  createExternalizeRodataPass(targetOptions);
   createConversionPass(targetOptions);
   createHoistInlinedRodataPass();
   createDeduplicateRodataPass();
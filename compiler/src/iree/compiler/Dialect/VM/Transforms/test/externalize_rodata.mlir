@@ -0,0 +1,28 @@
+// RUN: iree-opt --iree-vm-target-parameter-archive=%t.irpa --iree-vm-target-parameter-archive-scope=model --iree-vm-target-parameter-archive-minimum-size=64 --iree-vm-externalize-rodata %s | FileCheck %s
+
+// CHECK: func.func private @io_parameters.lookup(!util.buffer, !util.buffer) -> !util.buffer attributes {nosideeffects}
+
+// CHECK-LABEL: @externalize
+func.func @externalize() -> (!util.buffer, !util.buffer, !util.buffer, !util.buffer, !util.buffer) {
+  // Large constants are replaced with lookups keyed by content.
+  // CHECK: %[[SCOPE0:.+]] = util.buffer.constant : !util.buffer = "model"
+  // CHECK: %[[KEY0:.+]] = util.buffer.constant : !util.buffer = "[[KEY:[0-9a-f]+]]"
+  // CHECK: %[[LARGE0:.+]] = call @io_parameters.lookup(%[[SCOPE0]], %[[KEY0]])
+  %large0 = util.buffer.constant {alignment = 64 : index} : !util.buffer = dense<1> : tensor<16xi32>
+  // Identical values share the same archive entry.
+  // CHECK: %[[SCOPE1:.+]] = util.buffer.constant : !util.buffer = "model"
+  // CHECK: %[[KEY1:.+]] = util.buffer.constant : !util.buffer = "[[KEY]]"
+  // CHECK: %[[LARGE1:.+]] = call @io_parameters.lookup(%[[SCOPE1]], %[[KEY1]])
+  %large1 = util.buffer.constant : !util.buffer = dense<1> : tensor<16xi32>
+  // Small constants remain inline.
+  // CHECK: %[[SMALL:.+]] = util.buffer.constant : !util.buffer = dense<2> : tensor<4xi32>
+  %small = util.buffer.constant : !util.buffer = dense<2> : tensor<4xi32>
+  // Opaque blobs with mime types remain inline.
+  // CHECK: %[[BLOB:.+]] = util.buffer.constant {mime_type = "application/x-test"} : !util.buffer = dense<3> : tensor<16xi32>
+  %blob = util.buffer.constant {mime_type = "application/x-test"} : !util.buffer = dense<3> : tensor<16xi32>
+  // Constants requiring more than page alignment remain inline.
+  // CHECK: %[[OVERALIGNED:.+]] = util.buffer.constant {alignment = 8192 : index} : !util.buffer = dense<4> : tensor<16xi32>
+  %overaligned = util.buffer.constant {alignment = 8192 : index} : !util.buffer = dense<4> : tensor<16xi32>
+  // CHECK: return %[[LARGE0]], %[[LARGE1]], %[[SMALL]], %[[BLOB]], %[[OVERALIGNED]]
+  return %large0, %large1, %small, %blob, %overaligned : !util.buffer, !util.buffer, !util.buffer, !util.buffer, !util.buffer
+}
@@ -90,6 +90,36 @@ llvm::SmallVector<std::string> OptionsBinder::printArguments(
   return values;
 }
 
+static llvm::ManagedStatic<std::vector<std::string>> globalCommandLineFlags;
+
+void setGlobalCommandLineFlags(int argc, const char *const *argv) {
+  auto &registeredOptions = llvm::cl::getRegisteredOptions();
+  globalCommandLineFlags->clear();
+  for (int i = 1; i < argc; ++i) {
+    llvm::StringRef arg(argv[i]);
+    if (arg == "--") break;
+    if (!arg.startswith("-") || arg == "-") continue;
+
+    // Join flags taking a value from the following argument (`-o file`) so
+    // that the recorded flags don't depend on the spelling used.
+    llvm::StringRef name = arg.ltrim('-');
+    std::string flag = ("--" + name).str();
+    if (!name.contains('=') && i + 1 < argc) {
+      auto foundIt = registeredOptions.find(name);
+      if (foundIt != registeredOptions.end() &&
+          foundIt->second->getValueExpectedFlag() == llvm::cl::ValueRequired) {
+        flag += "=";
+        flag += argv[++i];
+      }
+    }
+    globalCommandLineFlags->push_back(std::move(flag));
+  }
+}
+
+llvm::ArrayRef<std::string> getGlobalCommandLineFlags() {
+  return *globalCommandLineFlags;
+}
+
 }  // namespace iree_compiler
 }  // namespace mlir
 
@@ -7,6 +7,7 @@
 #ifndef IREE_COMPILER_UTILS_FLAG_UTILS_H
 #define IREE_COMPILER_UTILS_FLAG_UTILS_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/CommandLine.h"
@@ -234,6 +235,17 @@ class OptionsFromFlags {
     return singleton;                                                  \
   }
 
+// Records the flags of the process command line once global options have been
+// parsed. Positional arguments are dropped and flags whose values were passed
+// as separate arguments are normalized to `--name=value`.
+void setGlobalCommandLineFlags(int argc, const char *const *argv);
+
+// Returns the flags recorded by setGlobalCommandLineFlags in the order they
+// were specified, or an empty list if the process command line was not parsed.
+// Used by components that need to identify the configuration of the compiler
+// beyond the IR they operate on (such as content-addressed caches).
+llvm::ArrayRef<std::string> getGlobalCommandLineFlags();
+
 }  // namespace iree_compiler
 }  // namespace mlir
 
@@ -226,6 +226,8 @@ void HalDevice::BeginProfiling(const py::kwargs& kwargs) {
       options.mode = IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_COUNTERS;
     } else if (mode_str == "executable") {
       options.mode = IREE_HAL_DEVICE_PROFILING_MODE_EXECUTABLE_COUNTERS;
+    } else if (mode_str == "timeline") {
+      options.mode = IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_TIMELINE;
     } else {
       throw RaiseValueError("unrecognized profiling mode");
     }
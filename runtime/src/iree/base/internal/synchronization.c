@@ -678,9 +678,12 @@ bool iree_notification_commit_wait(iree_notification_t* notification,
   pthread_mutex_lock(&notification->mutex);
 
   // Spin until notified and the epoch increments from what we captured during
-  // iree_notification_prepare_wait.
+  // iree_notification_prepare_wait. A deadline in the past only checks.
   bool result = true;
-  while (notification->epoch == wait_token) {
+  if (deadline_ns == IREE_TIME_INFINITE_PAST) {
+    result = notification->epoch != wait_token;
+  }
+  while (result && notification->epoch == wait_token) {
     int ret = pthread_cond_timedwait(&notification->cond, &notification->mutex,
                                      &abs_ts);
     if (ret != 0) {
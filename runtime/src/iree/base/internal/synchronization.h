@@ -402,7 +402,9 @@ iree_wait_token_t iree_notification_prepare_wait(
 // posted.
 //
 // If |spin_ns| is not IREE_DURATION_ZERO the wait _may_ spin for at least the
-// specified duration before entering the system wait API.
+// specified duration before entering the system wait API. If |deadline_ns| is
+// IREE_TIME_INFINITE_PAST the system wait API is never entered and the wait
+// returns false if the notification was not posted while spinning.
 //
 // Acts as (at least) a memory_order_acquire operation on the notification
 // object. This is meant to be paired with iree_notification_post, which is a
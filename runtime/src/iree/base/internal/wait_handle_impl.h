@@ -34,6 +34,11 @@
 // NOTE: order matters; priorities are (kqueue|epoll) > ppoll > poll.
 // When overridden with NULL (no platform primitives) or on Win32 we always use
 // those implementations (today).
+//
+// IO_URING is Linux-only (5.11+) and must be selected explicitly with the
+// IREE_ENABLE_WAIT_HANDLE_IO_URING CMake option (or -DIREE_WAIT_API=8) as
+// io_uring is frequently disabled by seccomp policies (containers, Android,
+// ChromeOS, etc).
 #define IREE_WAIT_API_NULL 0
 #define IREE_WAIT_API_INPROC 1
 #define IREE_WAIT_API_WIN32 2
@@ -42,6 +47,7 @@
 #define IREE_WAIT_API_EPOLL 5
 #define IREE_WAIT_API_KQUEUE 6
 #define IREE_WAIT_API_PROMISE 7
+#define IREE_WAIT_API_IO_URING 8
 
 // We allow overriding the wait API via command line flags. If unspecified we
 // try to guess based on the target platform.
@@ -73,10 +79,11 @@
 
 // Many implementations share the same posix-like nature (file descriptors/etc)
 // and can share most of their code.
-#if (IREE_WAIT_API == IREE_WAIT_API_POLL) ||  \
-    (IREE_WAIT_API == IREE_WAIT_API_PPOLL) || \
-    (IREE_WAIT_API == IREE_WAIT_API_EPOLL) || \
-    (IREE_WAIT_API == IREE_WAIT_API_KQUEUE)
+#if (IREE_WAIT_API == IREE_WAIT_API_POLL) ||   \
+    (IREE_WAIT_API == IREE_WAIT_API_PPOLL) ||  \
+    (IREE_WAIT_API == IREE_WAIT_API_EPOLL) ||  \
+    (IREE_WAIT_API == IREE_WAIT_API_KQUEUE) || \
+    (IREE_WAIT_API == IREE_WAIT_API_IO_URING)
 #define IREE_WAIT_API_POSIX_LIKE 1
 #endif  // IREE_WAIT_API = posix-like
 
@@ -0,0 +1,817 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// NOTE: must be first to ensure that we can define settings for all includes.
+#include "iree/base/internal/wait_handle_impl.h"
+
+#if IREE_WAIT_API == IREE_WAIT_API_IO_URING
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/wait_handle_posix.h"
+#include "iree/base/tracing.h"
+
+//===----------------------------------------------------------------------===//
+// io_uring utilities
+//===----------------------------------------------------------------------===//
+
+// We talk to the kernel directly instead of using liburing so that there are
+// no additional dependencies. Only the small subset required for poll
+// registration and waiting is implemented.
+//
+// Each handle in a wait set is registered with a multishot IORING_OP_POLL_ADD
+// that remains armed for as long as the handle is in the set: the kernel posts
+// a completion each time the handle becomes readable without us needing to
+// resubmit the fd list as poll/ppoll do. Registrations and removals are queued
+// in the submission ring and flushed in the same io_uring_enter call that
+// waits for completions so that batches of set changes cost no additional
+// syscalls.
+//
+// Completions only indicate that a handle was signaled at some point; the
+// handle may have since been reset. Handles that have completions are kept in
+// a pending list and all of them are revalidated with a single zero-timeout
+// poll before being reported as signaled. All per-wait work is proportional to
+// the number of handles with completions or registration changes and not to
+// the capacity of the set.
+//
+// Documentation: https://man7.org/linux/man-pages/man7/io_uring.7.html
+
+static int iree_io_uring_setup(unsigned entries, struct io_uring_params* p) {
+  return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int iree_io_uring_enter(int fd, unsigned to_submit,
+                               unsigned min_complete, unsigned flags,
+                               const void* arg, size_t arg_size) {
+  return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+                      arg, arg_size);
+}
+
+// Mapped io_uring instance.
+typedef struct iree_io_uring_t {
+  int fd;
+
+  // Submission queue ring.
+  void* sq_ring_ptr;
+  size_t sq_ring_size;
+  iree_atomic_int32_t* sq_head;
+  iree_atomic_int32_t* sq_tail;
+  uint32_t sq_mask;
+  uint32_t sq_entries;
+  uint32_t* sq_array;
+  struct io_uring_sqe* sqes;
+  size_t sqes_size;
+  // Number of SQEs written to the ring but not yet submitted.
+  uint32_t sq_pending;
+
+  // Completion queue ring (may share the SQ ring mapping).
+  void* cq_ring_ptr;
+  size_t cq_ring_size;
+  iree_atomic_int32_t* cq_head;
+  iree_atomic_int32_t* cq_tail;
+  uint32_t cq_mask;
+  struct io_uring_cqe* cqes;
+} iree_io_uring_t;
+
+static void iree_io_uring_deinitialize(iree_io_uring_t* ring) {
+  if (ring->sqes && ring->sqes != MAP_FAILED) {
+    munmap(ring->sqes, ring->sqes_size);
+  }
+  if (ring->cq_ring_ptr && ring->cq_ring_ptr != MAP_FAILED &&
+      ring->cq_ring_ptr != ring->sq_ring_ptr) {
+    munmap(ring->cq_ring_ptr, ring->cq_ring_size);
+  }
+  if (ring->sq_ring_ptr && ring->sq_ring_ptr != MAP_FAILED) {
+    munmap(ring->sq_ring_ptr, ring->sq_ring_size);
+  }
+  if (ring->fd >= 0) close(ring->fd);
+  memset(ring, 0, sizeof(*ring));
+  ring->fd = -1;
+}
+
+static iree_status_t iree_io_uring_initialize(uint32_t entries,
+                                              iree_io_uring_t* out_ring) {
+  memset(out_ring, 0, sizeof(*out_ring));
+  out_ring->fd = -1;
+
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int fd = iree_io_uring_setup(entries, &params);
+  if (fd < 0) {
+    int err = errno;
+    if (err == ENOSYS || err == EPERM || err == EACCES) {
+      // Kernels without io_uring or with it disabled by policy (sysctl or
+      // seccomp) are common; report them uniformly so callers can fall back.
+      return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                              "io_uring unavailable (errno %d)", err);
+    }
+    return iree_make_status(iree_status_code_from_errno(err),
+                            "io_uring_setup failure %d", err);
+  }
+  out_ring->fd = fd;
+
+  // We rely on the extended enter args to pass wait timeouts without needing
+  // to submit timeout operations (5.11+).
+  if (!(params.features & IORING_FEAT_EXT_ARG)) {
+    iree_io_uring_deinitialize(out_ring);
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "io_uring does not support IORING_FEAT_EXT_ARG");
+  }
+
+  out_ring->sq_ring_size =
+      params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  out_ring->cq_ring_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    out_ring->sq_ring_size = out_ring->cq_ring_size =
+        iree_max(out_ring->sq_ring_size, out_ring->cq_ring_size);
+  }
+  out_ring->sq_ring_ptr =
+      mmap(NULL, out_ring->sq_ring_size, PROT_READ | PROT_WRITE,
+           MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (out_ring->sq_ring_ptr == MAP_FAILED) {
+    int err = errno;
+    iree_io_uring_deinitialize(out_ring);
+    return iree_make_status(iree_status_code_from_errno(err),
+                            "io_uring SQ ring mmap failure %d", err);
+  }
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    out_ring->cq_ring_ptr = out_ring->sq_ring_ptr;
+  } else {
+    out_ring->cq_ring_ptr =
+        mmap(NULL, out_ring->cq_ring_size, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (out_ring->cq_ring_ptr == MAP_FAILED) {
+      int err = errno;
+      iree_io_uring_deinitialize(out_ring);
+      return iree_make_status(iree_status_code_from_errno(err),
+                              "io_uring CQ ring mmap failure %d", err);
+    }
+  }
+  out_ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  out_ring->sqes = (struct io_uring_sqe*)mmap(
+      NULL, out_ring->sqes_size, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (out_ring->sqes == MAP_FAILED) {
+    int err = errno;
+    iree_io_uring_deinitialize(out_ring);
+    return iree_make_status(iree_status_code_from_errno(err),
+                            "io_uring SQE mmap failure %d", err);
+  }
+
+  uint8_t* sq_ptr = (uint8_t*)out_ring->sq_ring_ptr;
+  out_ring->sq_head = (iree_atomic_int32_t*)(sq_ptr + params.sq_off.head);
+  out_ring->sq_tail = (iree_atomic_int32_t*)(sq_ptr + params.sq_off.tail);
+  out_ring->sq_mask = *(uint32_t*)(sq_ptr + params.sq_off.ring_mask);
+  out_ring->sq_entries = *(uint32_t*)(sq_ptr + params.sq_off.ring_entries);
+  out_ring->sq_array = (uint32_t*)(sq_ptr + params.sq_off.array);
+
+  uint8_t* cq_ptr = (uint8_t*)out_ring->cq_ring_ptr;
+  out_ring->cq_head = (iree_atomic_int32_t*)(cq_ptr + params.cq_off.head);
+  out_ring->cq_tail = (iree_atomic_int32_t*)(cq_ptr + params.cq_off.tail);
+  out_ring->cq_mask = *(uint32_t*)(cq_ptr + params.cq_off.ring_mask);
+  out_ring->cqes = (struct io_uring_cqe*)(cq_ptr + params.cq_off.cqes);
+
+  return iree_ok_status();
+}
+
+// Submits all pending SQEs and optionally waits for at least |min_complete|
+// completions to be available until |deadline_ns|.
+//
+// Returns RESOURCE_EXHAUSTED if the kernel accepts none of the pending SQEs
+// (such as while completions it could not post to a full completion queue
+// are outstanding) so that callers can reap completions instead of spinning.
+static iree_status_t iree_io_uring_submit_and_wait(iree_io_uring_t* ring,
+                                                   uint32_t min_complete,
+                                                   iree_time_t deadline_ns) {
+  if (min_complete == 0 && ring->sq_pending == 0) return iree_ok_status();
+  uint32_t to_submit = ring->sq_pending;
+  int rv = -1;
+  int err = 0;
+  do {
+    unsigned flags = IORING_ENTER_EXT_ARG;
+    struct __kernel_timespec timeout_ts;
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    if (min_complete > 0) {
+      flags |= IORING_ENTER_GETEVENTS;
+      if (deadline_ns != IREE_TIME_INFINITE_FUTURE) {
+        // Wait only for as much time as we have before the deadline is
+        // exceeded. As with ppoll we still perform the wait with a zero
+        // timeout if the deadline has already passed.
+        iree_duration_t timeout_ns =
+            deadline_ns == IREE_TIME_INFINITE_PAST
+                ? 0
+                : iree_max(0, deadline_ns - iree_time_now());
+        timeout_ts.tv_sec = (int64_t)(timeout_ns / 1000000000ull);
+        timeout_ts.tv_nsec = (long long)(timeout_ns % 1000000000ull);
+        arg.ts = (uint64_t)(uintptr_t)&timeout_ts;
+      }
+    }
+    rv = iree_io_uring_enter(ring->fd, to_submit, min_complete, flags, &arg,
+                             sizeof(arg));
+    err = rv < 0 ? errno : 0;
+    if ((err == EBUSY || err == EAGAIN) && to_submit > 0 && min_complete > 0) {
+      // The kernel refuses new submissions until overflowed completions are
+      // consumed; wait for completions only and submit on the next call.
+      to_submit = 0;
+      err = EINTR;
+    }
+  } while (err == EINTR);
+  if (rv < 0) {
+    if (err == ETIME) {
+      return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+    } else if (err == EBUSY || err == EAGAIN) {
+      return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                              "io_uring completion queue overflowed");
+    }
+    return iree_make_status(iree_status_code_from_errno(err),
+                            "io_uring_enter failure %d", err);
+  }
+  if (to_submit > 0) {
+    ring->sq_pending -= iree_min((uint32_t)rv, ring->sq_pending);
+    if (rv == 0 && min_complete == 0) {
+      return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                              "io_uring accepted no submissions");
+    }
+  }
+  return iree_ok_status();
+}
+
+// Returns a zeroed SQE from the submission ring or NULL if the ring is full.
+static struct io_uring_sqe* iree_io_uring_try_get_sqe(iree_io_uring_t* ring) {
+  uint32_t head =
+      (uint32_t)iree_atomic_load_int32(ring->sq_head, iree_memory_order_acquire);
+  uint32_t tail =
+      (uint32_t)iree_atomic_load_int32(ring->sq_tail, iree_memory_order_relaxed);
+  if (tail - head >= ring->sq_entries) return NULL;
+  uint32_t index = tail & ring->sq_mask;
+  struct io_uring_sqe* sqe = &ring->sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  ring->sq_array[index] = index;
+  iree_atomic_store_int32(ring->sq_tail, (int32_t)(tail + 1),
+                          iree_memory_order_release);
+  ++ring->sq_pending;
+  return sqe;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_wait_set_t
+//===----------------------------------------------------------------------===//
+
+// Bit set in the completion user_data of poll removal operations so that their
+// completions can be told apart from poll completions.
+#define IREE_WAIT_SET_USER_DATA_REMOVE (1ull << 63)
+
+typedef struct iree_wait_set_slot_t {
+  // User-provided handle.
+  iree_wait_handle_t handle;
+  // Incremented each time the slot is reused to discard stale completions.
+  uint32_t generation;
+  // Value of iree_wait_set_t::wait_epoch when the handle was last observed
+  // signaled during an iree_wait_all.
+  uint32_t observed_epoch;
+  // Position of the slot in the pending list when |pending| is set.
+  uint16_t pending_position;
+  // True if the slot holds a handle.
+  bool in_use;
+  // True if the slot has a poll registered with the kernel.
+  bool armed;
+  // True if a poll completion has been received since the handle was last
+  // observed to be unsignaled; the slot is in the pending list.
+  bool pending;
+  // True if the slot is in the rearm list.
+  bool rearm_queued;
+} iree_wait_set_slot_t;
+
+struct iree_wait_set_t {
+  iree_allocator_t allocator;
+
+  iree_io_uring_t ring;
+
+  // Total capacity of the slot list.
+  iree_host_size_t handle_capacity;
+
+  // Total number of used slots.
+  iree_host_size_t handle_count;
+
+  // Number of used slots with handles that have fds the kernel can poll.
+  iree_host_size_t fd_count;
+
+  // Incremented on each iree_wait_all to invalidate prior observations.
+  uint32_t wait_epoch;
+
+  // Fixed slot storage; handles do not move while in the set so that poll
+  // completions can address them directly.
+  iree_wait_set_slot_t* slots;
+
+  // Scratch storage used to revalidate all pending slots with one poll.
+  struct pollfd* poll_fds;
+
+  // Stack of unused slot indices.
+  iree_host_size_t free_count;
+  uint16_t* free_indices;
+
+  // Slots with completions that have not yet been observed unsignaled.
+  iree_host_size_t pending_count;
+  uint16_t* pending_indices;
+
+  // Slots whose multishot poll was terminated by the kernel and that must be
+  // registered again before the next wait.
+  iree_host_size_t rearm_count;
+  uint16_t* rearm_indices;
+};
+
+static uint64_t iree_wait_set_slot_user_data(iree_host_size_t index,
+                                             const iree_wait_set_slot_t* slot) {
+  return ((uint64_t)slot->generation << 32) | (uint64_t)index;
+}
+
+static void iree_wait_set_push_pending(iree_wait_set_t* set,
+                                       iree_host_size_t index) {
+  iree_wait_set_slot_t* slot = &set->slots[index];
+  if (slot->pending) return;
+  slot->pending = true;
+  slot->pending_position = (uint16_t)set->pending_count;
+  set->pending_indices[set->pending_count++] = (uint16_t)index;
+}
+
+static void iree_wait_set_remove_pending(iree_wait_set_t* set,
+                                         iree_host_size_t index) {
+  iree_wait_set_slot_t* slot = &set->slots[index];
+  if (!slot->pending) return;
+  slot->pending = false;
+  uint16_t last_index = set->pending_indices[--set->pending_count];
+  if (last_index != index) {
+    set->pending_indices[slot->pending_position] = last_index;
+    set->slots[last_index].pending_position = slot->pending_position;
+  }
+}
+
+// Reaps all available completions and marks the slots they reference pending.
+static void iree_wait_set_reap_completions(iree_wait_set_t* set) {
+  iree_io_uring_t* ring = &set->ring;
+  uint32_t head =
+      (uint32_t)iree_atomic_load_int32(ring->cq_head, iree_memory_order_relaxed);
+  uint32_t tail =
+      (uint32_t)iree_atomic_load_int32(ring->cq_tail, iree_memory_order_acquire);
+  for (; head != tail; ++head) {
+    const struct io_uring_cqe* cqe = &ring->cqes[head & ring->cq_mask];
+    if (cqe->user_data & IREE_WAIT_SET_USER_DATA_REMOVE) continue;
+    iree_host_size_t index = (iree_host_size_t)(cqe->user_data & 0xFFFFFFFFu);
+    uint32_t generation = (uint32_t)(cqe->user_data >> 32);
+    if (index >= set->handle_capacity) continue;
+    iree_wait_set_slot_t* slot = &set->slots[index];
+    if (!slot->in_use || slot->generation != generation) {
+      continue;  // stale completion from a removed handle
+    }
+    // Errors (including POLLERR/POLLHUP/POLLNVAL) are surfaced by the
+    // revalidation poll; we only need to know which handles to look at.
+    iree_wait_set_push_pending(set, index);
+    if (!(cqe->flags & IORING_CQE_F_MORE)) {
+      // The kernel terminated the multishot poll (overflow, error, or kernels
+      // that only support oneshot polls); it must be rearmed.
+      slot->armed = false;
+      if (!slot->rearm_queued) {
+        slot->rearm_queued = true;
+        set->rearm_indices[set->rearm_count++] = (uint16_t)index;
+      }
+    }
+  }
+  iree_atomic_store_int32(ring->cq_head, (int32_t)head,
+                          iree_memory_order_release);
+}
+
+// Returns a zeroed SQE, flushing queued registration changes to the kernel if
+// the submission ring is full.
+static iree_status_t iree_wait_set_acquire_sqe(iree_wait_set_t* set,
+                                               struct io_uring_sqe** out_sqe) {
+  *out_sqe = iree_io_uring_try_get_sqe(&set->ring);
+  if (*out_sqe) return iree_ok_status();
+  // Reap first so that the completion queue has room for the results of the
+  // submissions we are about to flush.
+  iree_wait_set_reap_completions(set);
+  IREE_RETURN_IF_ERROR(iree_io_uring_submit_and_wait(
+      &set->ring, /*min_complete=*/0, IREE_TIME_INFINITE_PAST));
+  *out_sqe = iree_io_uring_try_get_sqe(&set->ring);
+  if (!*out_sqe) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "io_uring submission queue full");
+  }
+  return iree_ok_status();
+}
+
+// Queues a multishot poll registration for the slot at |index|.
+static iree_status_t iree_wait_set_arm_slot(iree_wait_set_t* set,
+                                            iree_host_size_t index) {
+  iree_wait_set_slot_t* slot = &set->slots[index];
+  // As with poll we ignore handles without fds (immediate handles).
+  int fd = iree_wait_primitive_get_read_fd(&slot->handle);
+  if (fd < 0) return iree_ok_status();
+  struct io_uring_sqe* sqe = NULL;
+  IREE_RETURN_IF_ERROR(iree_wait_set_acquire_sqe(set, &sqe));
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+  sqe->poll32_events = POLLIN | POLLPRI;
+  sqe->len = IORING_POLL_ADD_MULTI;
+  sqe->user_data = iree_wait_set_slot_user_data(index, slot);
+  slot->armed = true;
+  return iree_ok_status();
+}
+
+// Queues removal of the poll registration for the slot at |index|, if any.
+static void iree_wait_set_disarm_slot(iree_wait_set_t* set,
+                                      iree_host_size_t index) {
+  iree_wait_set_slot_t* slot = &set->slots[index];
+  if (!slot->armed) return;
+  slot->armed = false;
+  struct io_uring_sqe* sqe = NULL;
+  iree_status_t status = iree_wait_set_acquire_sqe(set, &sqe);
+  if (!iree_status_is_ok(status)) {
+    // The registration will be dropped when the generation mismatches.
+    iree_status_ignore(status);
+    return;
+  }
+  sqe->opcode = IORING_OP_POLL_REMOVE;
+  sqe->fd = -1;
+  sqe->addr = iree_wait_set_slot_user_data(index, slot);
+  sqe->user_data = IREE_WAIT_SET_USER_DATA_REMOVE;
+}
+
+// Rearms the slots whose multishot polls were terminated by the kernel.
+static iree_status_t iree_wait_set_rearm_slots(iree_wait_set_t* set) {
+  while (set->rearm_count > 0) {
+    iree_host_size_t index = set->rearm_indices[set->rearm_count - 1];
+    iree_wait_set_slot_t* slot = &set->slots[index];
+    if (slot->in_use && !slot->armed) {
+      IREE_RETURN_IF_ERROR(iree_wait_set_arm_slot(set, index));
+    }
+    slot->rearm_queued = false;
+    --set->rearm_count;
+  }
+  return iree_ok_status();
+}
+
+// Maps a poll revent bitfield result to a status (on failure) and an indicator
+// of whether the event was signaled.
+static iree_status_t iree_wait_set_resolve_poll_events(short revents,
+                                                       bool* out_signaled) {
+  if (revents & POLLERR) {
+    return iree_make_status(IREE_STATUS_INTERNAL, "POLLERR on fd");
+  } else if (revents & POLLHUP) {
+    return iree_make_status(IREE_STATUS_CANCELLED, "POLLHUP on fd");
+  } else if (revents & POLLNVAL) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT, "POLLNVAL on fd");
+  }
+  *out_signaled = (revents & POLLIN) != 0;
+  return iree_ok_status();
+}
+
+// Revalidates the pending slots with a single zero-timeout poll and removes
+// those that are no longer signaled from the pending list. When
+// |skip_observed| is set slots already observed in the current wait epoch are
+// neither polled nor removed. Slots found signaled are marked observed in the
+// current epoch and counted in |out_signaled_count|.
+static iree_status_t iree_wait_set_validate_pending(
+    iree_wait_set_t* set, bool skip_observed,
+    iree_host_size_t* out_signaled_count) {
+  *out_signaled_count = 0;
+
+  iree_host_size_t poll_count = 0;
+  for (iree_host_size_t i = 0; i < set->pending_count; ++i) {
+    const iree_wait_set_slot_t* slot = &set->slots[set->pending_indices[i]];
+    if (skip_observed && slot->observed_epoch == set->wait_epoch) continue;
+    struct pollfd* poll_fd = &set->poll_fds[poll_count++];
+    poll_fd->fd = iree_wait_primitive_get_read_fd(&slot->handle);
+    poll_fd->events = POLLIN | POLLPRI;
+    poll_fd->revents = 0;
+  }
+  if (poll_count == 0) return iree_ok_status();
+
+  int rv = 0;
+  IREE_SYSCALL(rv, poll(set->poll_fds, (nfds_t)poll_count, 0));
+  if (rv < 0) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "poll failure %d", errno);
+  }
+
+  // Compact the pending list in order so that it stays in sync with the poll
+  // results; on failure the remaining slots are kept pending.
+  iree_status_t status = iree_ok_status();
+  iree_host_size_t poll_index = 0;
+  iree_host_size_t pending_count = 0;
+  for (iree_host_size_t i = 0; i < set->pending_count; ++i) {
+    uint16_t index = set->pending_indices[i];
+    iree_wait_set_slot_t* slot = &set->slots[index];
+    bool keep = true;
+    if (!skip_observed || slot->observed_epoch != set->wait_epoch) {
+      short revents = set->poll_fds[poll_index++].revents;
+      bool signaled = false;
+      if (iree_status_is_ok(status)) {
+        status = iree_wait_set_resolve_poll_events(revents, &signaled);
+      }
+      if (iree_status_is_ok(status)) {
+        if (signaled) {
+          slot->observed_epoch = set->wait_epoch;
+          ++*out_signaled_count;
+        } else {
+          keep = false;
+        }
+      }
+    }
+    if (keep) {
+      slot->pending_position = (uint16_t)pending_count;
+      set->pending_indices[pending_count++] = index;
+    } else {
+      slot->pending = false;
+    }
+  }
+  set->pending_count = pending_count;
+  return status;
+}
+
+iree_status_t iree_wait_set_allocate(iree_host_size_t capacity,
+                                     iree_allocator_t allocator,
+                                     iree_wait_set_t** out_set) {
+  IREE_ASSERT_ARGUMENT(out_set);
+
+  // The wait handle set_internal.index is only 16 bits.
+  if (capacity >= UINT16_MAX) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "wait set capacity of %zu is unreasonably large",
+                            capacity);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_host_size_t slot_list_size = capacity * sizeof(iree_wait_set_slot_t);
+  iree_host_size_t poll_fd_list_size = capacity * sizeof(struct pollfd);
+  iree_host_size_t index_list_size = capacity * sizeof(uint16_t);
+  iree_host_size_t total_size = iree_sizeof_struct(iree_wait_set_t) +
+                                slot_list_size + poll_fd_list_size +
+                                3 * index_list_size;
+
+  iree_wait_set_t* set = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(allocator, total_size, (void**)&set));
+  set->allocator = allocator;
+  set->handle_capacity = capacity;
+  set->handle_count = 0;
+  uint8_t* storage = (uint8_t*)set + iree_sizeof_struct(iree_wait_set_t);
+  set->slots = (iree_wait_set_slot_t*)storage;
+  storage += slot_list_size;
+  set->poll_fds = (struct pollfd*)storage;
+  storage += poll_fd_list_size;
+  set->free_indices = (uint16_t*)storage;
+  storage += index_list_size;
+  set->pending_indices = (uint16_t*)storage;
+  storage += index_list_size;
+  set->rearm_indices = (uint16_t*)storage;
+  memset(set->slots, 0, slot_list_size);
+
+  // Hand out slots in ascending order.
+  set->free_count = capacity;
+  for (iree_host_size_t i = 0; i < capacity; ++i) {
+    set->free_indices[i] = (uint16_t)(capacity - 1 - i);
+  }
+
+  // Size the submission ring such that a full set of removals and insertions
+  // can be batched before needing to flush.
+  uint32_t ring_entries = 8;
+  while (ring_entries < capacity * 2) ring_entries <<= 1;
+  iree_status_t status = iree_io_uring_initialize(ring_entries, &set->ring);
+
+  if (iree_status_is_ok(status)) {
+    *out_set = set;
+  } else {
+    iree_allocator_free(allocator, set);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+void iree_wait_set_free(iree_wait_set_t* set) {
+  if (!set) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  // Closing the ring cancels all outstanding polls.
+  iree_io_uring_deinitialize(&set->ring);
+  iree_allocator_free(set->allocator, set);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+bool iree_wait_set_is_empty(const iree_wait_set_t* set) {
+  return set->handle_count == 0;
+}
+
+iree_status_t iree_wait_set_insert(iree_wait_set_t* set,
+                                   iree_wait_handle_t handle) {
+  if (set->free_count == 0) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "wait set capacity reached");
+  }
+
+  iree_host_size_t index = set->free_indices[--set->free_count];
+  iree_wait_set_slot_t* slot = &set->slots[index];
+  iree_wait_handle_wrap_primitive(handle.type, handle.value, &slot->handle);
+  ++slot->generation;
+  slot->observed_epoch = set->wait_epoch - 1;
+  slot->in_use = true;
+  slot->armed = false;
+
+  // The registration is only queued here and will be submitted to the kernel
+  // along with any other changes on the next wait.
+  iree_status_t status = iree_wait_set_arm_slot(set, index);
+  if (!iree_status_is_ok(status)) {
+    slot->in_use = false;
+    set->free_indices[set->free_count++] = (uint16_t)index;
+    return status;
+  }
+  ++set->handle_count;
+  if (iree_wait_primitive_get_read_fd(&slot->handle) >= 0) ++set->fd_count;
+  return iree_ok_status();
+}
+
+// Removes the handle in the slot at |index| from the set.
+static void iree_wait_set_erase_slot(iree_wait_set_t* set,
+                                     iree_host_size_t index) {
+  iree_wait_set_slot_t* slot = &set->slots[index];
+  iree_wait_set_remove_pending(set, index);
+  iree_wait_set_disarm_slot(set, index);
+  if (iree_wait_primitive_get_read_fd(&slot->handle) >= 0) --set->fd_count;
+  slot->in_use = false;
+  set->free_indices[set->free_count++] = (uint16_t)index;
+  --set->handle_count;
+}
+
+void iree_wait_set_erase(iree_wait_set_t* set, iree_wait_handle_t handle) {
+  // Use the index set by iree_wait_any if valid and otherwise scan.
+  iree_host_size_t index = handle.set_internal.index;
+  if (IREE_UNLIKELY(index >= set->handle_capacity) ||
+      IREE_UNLIKELY(!set->slots[index].in_use) ||
+      IREE_UNLIKELY(!iree_wait_primitive_compare_identical(
+          &set->slots[index].handle, &handle))) {
+    index = set->handle_capacity;
+    for (iree_host_size_t i = 0; i < set->handle_capacity; ++i) {
+      if (set->slots[i].in_use &&
+          iree_wait_primitive_compare_identical(&set->slots[i].handle,
+                                                &handle)) {
+        index = i;
+        break;
+      }
+    }
+    if (index == set->handle_capacity) return;  // not found
+  }
+  iree_wait_set_erase_slot(set, index);
+}
+
+void iree_wait_set_clear(iree_wait_set_t* set) {
+  for (iree_host_size_t i = 0; i < set->handle_capacity; ++i) {
+    if (set->slots[i].in_use) iree_wait_set_erase_slot(set, i);
+  }
+}
+
+// Flushes registration changes and waits for at least one new completion.
+// Returns true in |out_timed_out| if the deadline was exceeded; callers should
+// still check the completions that arrived as submissions are processed even
+// if the wait itself times out.
+static iree_status_t iree_wait_set_submit_and_wait(iree_wait_set_t* set,
+                                                   iree_time_t deadline_ns,
+                                                   bool* out_timed_out) {
+  *out_timed_out = false;
+  IREE_RETURN_IF_ERROR(iree_wait_set_rearm_slots(set));
+  iree_status_t status = iree_io_uring_submit_and_wait(
+      &set->ring, /*min_complete=*/1, deadline_ns);
+  if (iree_status_is_deadline_exceeded(status)) {
+    *out_timed_out = true;
+    return iree_ok_status();
+  }
+  return status;
+}
+
+iree_status_t iree_wait_all(iree_wait_set_t* set, iree_time_t deadline_ns) {
+  // Make the syscall only when we have at least one valid fd.
+  // Don't use this as a sleep. Handles without fds are ignored by the kernel
+  // (as with poll).
+  if (set->fd_count == 0) {
+    return iree_ok_status();
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // As with the poll implementation handles only need to have been observed
+  // signaled at some point during the wait and not all at the same time.
+  ++set->wait_epoch;
+  iree_host_size_t unsignaled_count = set->fd_count;
+
+  iree_status_t status = iree_ok_status();
+  bool timed_out = false;
+  while (true) {
+    iree_wait_set_reap_completions(set);
+    iree_host_size_t signaled_count = 0;
+    status = iree_wait_set_validate_pending(set, /*skip_observed=*/true,
+                                            &signaled_count);
+    if (!iree_status_is_ok(status)) break;
+    unsignaled_count -= signaled_count;
+    if (unsignaled_count == 0) break;
+    if (timed_out) {
+      status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+      break;
+    }
+    status = iree_wait_set_submit_and_wait(set, deadline_ns, &timed_out);
+    if (!iree_status_is_ok(status)) break;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_wait_any(iree_wait_set_t* set, iree_time_t deadline_ns,
+                            iree_wait_handle_t* out_wake_handle) {
+  // Make the syscall only when we have at least one valid fd.
+  // Don't use this as a sleep.
+  memset(out_wake_handle, 0, sizeof(*out_wake_handle));
+  if (set->handle_count <= 0) {
+    return iree_ok_status();
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_status_t status = iree_ok_status();
+  bool timed_out = false;
+  while (true) {
+    // Check the handles the kernel has told us were signaled; all those that
+    // remain pending after validation are currently signaled.
+    iree_wait_set_reap_completions(set);
+    iree_host_size_t signaled_count = 0;
+    status = iree_wait_set_validate_pending(set, /*skip_observed=*/false,
+                                            &signaled_count);
+    if (!iree_status_is_ok(status)) break;
+    if (set->pending_count > 0) {
+      iree_host_size_t index = set->pending_indices[0];
+      memcpy(out_wake_handle, &set->slots[index].handle,
+             sizeof(*out_wake_handle));
+      out_wake_handle->set_internal.index = index;
+      break;
+    }
+    if (timed_out) {
+      status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+      break;
+    }
+    status = iree_wait_set_submit_and_wait(set, deadline_ns, &timed_out);
+    if (!iree_status_is_ok(status)) break;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_wait_one(iree_wait_handle_t* handle,
+                            iree_time_t deadline_ns) {
+  // Single handle waits don't benefit from a ring and would need to set one up
+  // per call; a plain poll is cheaper.
+  struct pollfd poll_fd;
+  poll_fd.fd = iree_wait_primitive_get_read_fd(handle);
+  if (poll_fd.fd == -1) return iree_ok_status();
+  poll_fd.events = POLLIN;
+  poll_fd.revents = 0;
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  int rv = -1;
+  do {
+    struct timespec timeout_ts;
+    struct timespec* tmo_p = &timeout_ts;
+    if (deadline_ns == IREE_TIME_INFINITE_FUTURE) {
+      tmo_p = NULL;
+    } else {
+      iree_duration_t timeout_ns =
+          deadline_ns == IREE_TIME_INFINITE_PAST
+              ? 0
+              : iree_max(0, deadline_ns - iree_time_now());
+      timeout_ts.tv_sec = (time_t)(timeout_ns / 1000000000ull);
+      timeout_ts.tv_nsec = (long)(timeout_ns % 1000000000ull);
+    }
+    rv = ppoll(&poll_fd, 1, tmo_p, NULL);
+  } while (rv < 0 && errno == EINTR);
+
+  IREE_TRACE_ZONE_END(z0);
+  if (rv < 0) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "ppoll failure %d", errno);
+  }
+  return rv > 0 ? iree_ok_status()
+                : iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+}
+
+#endif  // IREE_WAIT_API == IREE_WAIT_API_IO_URING
@@ -26,6 +26,25 @@ namespace {
 constexpr iree_duration_t kShortTimeoutNS = 1000000ull;     // 1ms
 constexpr iree_duration_t kLongTimeoutNS = 60000000000ull;  // 1min
 
+// Skips all tests when the wait set implementation is unavailable at runtime,
+// such as when io_uring is disabled by the kernel or a seccomp policy.
+class WaitSetEnvironment : public ::testing::Environment {
+ public:
+  void SetUp() override {
+    iree_wait_set_t* wait_set = NULL;
+    iree_status_t status =
+        iree_wait_set_allocate(1, iree_allocator_system(), &wait_set);
+    if (iree_status_is_unavailable(status)) {
+      iree_status_ignore(status);
+      GTEST_SKIP() << "wait sets are unavailable on this system";
+    }
+    IREE_ASSERT_OK(status);
+    iree_wait_set_free(wait_set);
+  }
+};
+static ::testing::Environment* const kWaitSetEnvironment =
+    ::testing::AddGlobalTestEnvironment(new WaitSetEnvironment());
+
 //===----------------------------------------------------------------------===//
 // IREE_WAIT_PRIMITIVE_TYPE_EVENT_FD
 //===----------------------------------------------------------------------===//
@@ -96,6 +96,11 @@ enum iree_hal_device_profiling_mode_bits_t {
   // locations. This can have a significant performance impact and should only
   // be used when investigating the performance of an individual dispatch.
   IREE_HAL_DEVICE_PROFILING_MODE_EXECUTABLE_COUNTERS = 1u << 2,
+
+  // Capture a timeline of when and where each dispatch workgroup executed
+  // within the profiled range. Implementations write the timeline to the
+  // profiling file path in a format consumable by iree-dump-instruments.
+  IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_TIMELINE = 1u << 3,
 };
 typedef uint32_t iree_hal_device_profiling_mode_t;
 
@@ -19,6 +19,7 @@
 #include "iree/hal/local/inline_command_buffer.h"
 #include "iree/hal/local/local_executable_cache.h"
 #include "iree/hal/local/local_pipeline_layout.h"
+#include "iree/hal/local/profiling.h"
 #include "iree/hal/utils/buffer_transfer.h"
 #include "iree/hal/utils/deferred_command_buffer.h"
 
@@ -41,6 +42,11 @@ typedef struct iree_hal_sync_device_t {
   // synchronization ourselves.
   iree_hal_sync_semaphore_state_t semaphore_state;
 
+  // Hook referenced by inline command buffers to sample their dispatches.
+  iree_hal_local_profiling_hook_t profiling_hook;
+  // Active dispatch profiler between profiling_begin/profiling_end, if any.
+  iree_hal_local_profiler_t* profiler;
+
   iree_host_size_t loader_count;
   iree_hal_executable_loader_t* loaders[];
 } iree_hal_sync_device_t;
@@ -108,6 +114,8 @@ iree_status_t iree_hal_sync_device_create(
     }
 
     iree_hal_sync_semaphore_state_initialize(&device->semaphore_state);
+    iree_hal_local_profiling_hook_initialize(host_allocator,
+                                             &device->profiling_hook);
   }
 
   if (iree_status_is_ok(status)) {
@@ -126,6 +134,9 @@ static void iree_hal_sync_device_destroy(iree_hal_device_t* base_device) {
 
   iree_hal_sync_semaphore_state_deinitialize(&device->semaphore_state);
 
+  iree_hal_local_profiling_hook_deinitialize(&device->profiling_hook);
+  iree_status_ignore(iree_hal_local_profiler_end(device->profiler));
+
   for (iree_host_size_t i = 0; i < device->loader_count; ++i) {
     iree_hal_executable_loader_release(device->loaders[i]);
   }
@@ -224,13 +235,14 @@ static iree_status_t iree_hal_sync_device_create_command_buffer(
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
     iree_hal_command_buffer_t** out_command_buffer) {
+  iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
   if (iree_all_bits_set(mode,
                         IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION)) {
     return iree_hal_inline_command_buffer_create(
         base_device, mode, command_categories, queue_affinity, binding_capacity,
-        iree_hal_device_host_allocator(base_device), out_command_buffer);
+        &device->profiling_hook, iree_hal_device_host_allocator(base_device),
+        out_command_buffer);
   } else {
-    iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
     return iree_hal_deferred_command_buffer_create(
         base_device, mode, command_categories, binding_capacity,
         &device->large_block_pool, device->host_allocator, out_command_buffer);
@@ -346,8 +358,8 @@ static iree_status_t iree_hal_sync_device_apply_deferred_command_buffers(
           iree_hal_command_buffer_mode(command_buffer) |
               IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION,
           IREE_HAL_COMMAND_CATEGORY_ANY, IREE_HAL_QUEUE_AFFINITY_ANY,
-          /*binding_capacity=*/0, device->host_allocator, storage,
-          &inline_command_buffer));
+          /*binding_capacity=*/0, &device->profiling_hook,
+          device->host_allocator, storage, &inline_command_buffer));
       iree_status_t status = iree_hal_deferred_command_buffer_apply(
           command_buffer, inline_command_buffer,
           iree_hal_buffer_binding_table_empty());
@@ -404,23 +416,40 @@ static iree_status_t iree_hal_sync_device_wait_semaphores(
 }
 
 static iree_status_t iree_hal_sync_device_profiling_begin(
-    iree_hal_device_t* device,
+    iree_hal_device_t* base_device,
     const iree_hal_device_profiling_options_t* options) {
-  // Unimplemented (and that's ok).
-  // We could hook in to vendor APIs (Intel/ARM/etc) or generic perf infra:
-  // https://man7.org/linux/man-pages/man2/perf_event_open.2.html
-  // Capturing things like:
-  //   PERF_COUNT_HW_CPU_CYCLES / PERF_COUNT_HW_INSTRUCTIONS
-  //   PERF_COUNT_HW_CACHE_REFERENCES / PERF_COUNT_HW_CACHE_MISSES
-  //   etc
-  // TODO(benvanik): shared iree/hal/local/profiling implementation of this.
+  iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
+  if (device->profiler) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "profiling already active on this device");
+  }
+  // Only dispatch timelines are supported today; other modes are ignored.
+  // Dispatches run on whichever threads submit work and hardware counters are
+  // tracked per worker so they cannot be attributed reliably. All threads
+  // share a single timeline ring and records carry the processor ID.
+  iree_hal_device_profiling_options_t timeline_options = *options;
+  timeline_options.mode &= IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_TIMELINE;
+  IREE_RETURN_IF_ERROR(iree_hal_local_profiler_begin(
+      &timeline_options, /*worker_count=*/1, device->host_allocator,
+      &device->profiler));
+  if (device->profiler) {
+    // Submitting threads have no stable worker IDs and share one counter.
+    iree_hal_local_profiling_hook_attach(&device->profiling_hook,
+                                         device->profiler, /*worker_base=*/0,
+                                         /*worker_count=*/0);
+  }
   return iree_ok_status();
 }
 
 static iree_status_t iree_hal_sync_device_profiling_end(
-    iree_hal_device_t* device) {
-  // Unimplemented (and that's ok).
-  return iree_ok_status();
+    iree_hal_device_t* base_device) {
+  iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
+  // Dispatches are executed synchronously by submitting threads and any still
+  // sampling must end before the profiler can be freed.
+  iree_hal_local_profiling_hook_detach(&device->profiling_hook);
+  iree_hal_local_profiler_t* profiler = device->profiler;
+  device->profiler = NULL;
+  return iree_hal_local_profiler_end(profiler);
 }
 
 static const iree_hal_device_vtable_t iree_hal_sync_device_vtable = {
@@ -17,6 +17,7 @@
 #include "iree/hal/local/executable_library.h"
 #include "iree/hal/local/local_executable.h"
 #include "iree/hal/local/local_pipeline_layout.h"
+#include "iree/hal/local/profiling.h"
 #include "iree/hal/utils/resource_set.h"
 #include "iree/task/affinity_set.h"
 #include "iree/task/list.h"
@@ -41,6 +42,10 @@ typedef struct iree_hal_task_command_buffer_t {
 
   iree_task_scope_t* scope;
 
+  // Hook of the queue the command buffer was created for. Dispatches sample
+  // any profiler attached to it.
+  iree_hal_local_profiling_hook_t* profiling_hook;
+
   // Arena used for all allocations; references the shared device block pool.
   iree_arena_allocator_t arena;
 
@@ -108,6 +113,7 @@ static iree_hal_task_command_buffer_t* iree_hal_task_command_buffer_cast(
 
 iree_status_t iree_hal_task_command_buffer_create(
     iree_hal_device_t* device, iree_task_scope_t* scope,
+    iree_hal_local_profiling_hook_t* profiling_hook,
     iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
@@ -146,6 +152,7 @@ iree_status_t iree_hal_task_command_buffer_create(
         &iree_hal_task_command_buffer_vtable, &command_buffer->base);
     command_buffer->host_allocator = host_allocator;
     command_buffer->scope = scope;
+    command_buffer->profiling_hook = profiling_hook;
     iree_arena_initialize(block_pool, &command_buffer->arena);
     iree_task_list_initialize(&command_buffer->root_tasks);
     iree_task_list_initialize(&command_buffer->leaf_tasks);
@@ -814,6 +821,9 @@ typedef struct iree_hal_cmd_dispatch_t {
   iree_hal_local_executable_t* executable;
   int32_t ordinal;
 
+  // Hook of the queue the dispatch executes on used for profiling.
+  iree_hal_local_profiling_hook_t* profiling_hook;
+
   // Total number of available 4 byte push constant values in |push_constants|.
   uint16_t push_constant_count;
 
@@ -870,9 +880,20 @@ static iree_status_t iree_hal_cmd_dispatch_tile(
           .local_memory = tile_context->local_memory.data,
           .local_memory_size = (size_t)tile_context->local_memory.data_length,
       };
+  iree_hal_local_profiling_sample_t profiling_sample;
+  iree_hal_local_profiling_sample_begin(
+      cmd->profiling_hook, tile_context->worker_id, &profiling_sample);
   iree_status_t status = iree_hal_local_executable_issue_call(
       cmd->executable, cmd->ordinal, &dispatch_state, &workgroup_state,
       tile_context->worker_id);
+  iree_hal_local_profiling_sample_end(
+      &profiling_sample, cmd->executable, cmd->ordinal,
+      tile_context->workgroup_xyz[0] +
+          tile_context->workgroup_count[0] *
+              (tile_context->workgroup_xyz[1] +
+               tile_context->workgroup_count[1] *
+                   tile_context->workgroup_xyz[2]),
+      /*workgroup_count=*/1);
 
   IREE_TRACE_ZONE_END(z0);
   return status;
@@ -919,6 +940,7 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
 
   cmd->executable = local_executable;
   cmd->ordinal = entry_point;
+  cmd->profiling_hook = command_buffer->profiling_hook;
   cmd->push_constant_count = push_constant_count;
   cmd->binding_count = used_binding_count;
 
@@ -11,6 +11,7 @@
 #include "iree/base/internal/arena.h"
 #include "iree/hal/api.h"
 #include "iree/hal/drivers/local_task/task_queue_state.h"
+#include "iree/hal/local/profiling.h"
 #include "iree/task/scope.h"
 #include "iree/task/task.h"
 
@@ -18,8 +19,11 @@
 extern "C" {
 #endif  // __cplusplus
 
+// Creates a command buffer recording tasks into |scope|. Dispatches are
+// measured by any profiler attached to |profiling_hook| while they execute.
 iree_status_t iree_hal_task_command_buffer_create(
     iree_hal_device_t* device, iree_task_scope_t* scope,
+    iree_hal_local_profiling_hook_t* profiling_hook,
     iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
@@ -20,6 +20,7 @@
 #include "iree/hal/local/executable_environment.h"
 #include "iree/hal/local/local_executable_cache.h"
 #include "iree/hal/local/local_pipeline_layout.h"
+#include "iree/hal/local/profiling.h"
 #include "iree/hal/utils/buffer_transfer.h"
 
 typedef struct iree_hal_task_device_t {
@@ -42,6 +43,9 @@ typedef struct iree_hal_task_device_t {
   // Optional provider used for creating/configuring collective channels.
   iree_hal_channel_provider_t* channel_provider;
 
+  // Active dispatch profiler between profiling_begin/profiling_end, if any.
+  iree_hal_local_profiler_t* profiler;
+
   iree_host_size_t queue_count;
   iree_hal_task_queue_t queues[];
 } iree_hal_task_device_t;
@@ -80,6 +84,43 @@ iree_event_pool_t* iree_hal_task_device_shared_event_pool(
   return iree_task_executor_event_pool(device->queues[0].executor);
 }
 
+// Returns the total number of workers across the executors of all queues.
+// Executors shared by multiple queues are counted once per queue.
+static iree_host_size_t iree_hal_task_device_worker_count(
+    iree_hal_task_device_t* device) {
+  iree_host_size_t total_worker_count = 0;
+  for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+    total_worker_count +=
+        iree_task_executor_worker_count(device->queues[i].executor);
+  }
+  return total_worker_count;
+}
+
+// Attaches the device profiler to the hooks of all queues. Each queue is
+// assigned its own range of the profiler worker table so that workers of
+// different executors (which share worker IDs) never share state.
+static void iree_hal_task_device_attach_profiler(
+    iree_hal_task_device_t* device) {
+  iree_host_size_t worker_base = 0;
+  for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+    const iree_host_size_t worker_count =
+        iree_task_executor_worker_count(device->queues[i].executor);
+    iree_hal_local_profiling_hook_attach(&device->queues[i].profiling_hook,
+                                         device->profiler, worker_base,
+                                         worker_count);
+    worker_base += worker_count;
+  }
+}
+
+// Detaches the device profiler from all queues and waits for any workgroup
+// still sampling it to complete.
+static void iree_hal_task_device_detach_profiler(
+    iree_hal_task_device_t* device) {
+  for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+    iree_hal_local_profiling_hook_detach(&device->queues[i].profiling_hook);
+  }
+}
+
 iree_status_t iree_hal_task_device_create(
     iree_string_view_t identifier, const iree_hal_task_device_params_t* params,
     iree_host_size_t queue_count, iree_task_executor_t* const* queue_executors,
@@ -133,7 +174,7 @@ iree_status_t iree_hal_task_device_create(
       // TODO(benvanik): add a number to each queue ID.
       iree_hal_task_queue_initialize(device->identifier, queue_executors[i],
                                      &device->small_block_pool,
-                                     &device->queues[i]);
+                                     host_allocator, &device->queues[i]);
     }
   }
 
@@ -151,10 +192,13 @@ static void iree_hal_task_device_destroy(iree_hal_device_t* base_device) {
   iree_allocator_t host_allocator = iree_hal_device_host_allocator(base_device);
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  iree_hal_task_device_detach_profiler(device);
   for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
     iree_hal_task_queue_deinitialize(&device->queues[i]);
   }
 
+  iree_status_ignore(iree_hal_local_profiler_end(device->profiler));
+
   for (iree_host_size_t i = 0; i < device->loader_count; ++i) {
     iree_hal_executable_loader_release(device->loaders[i]);
   }
@@ -220,6 +264,76 @@ static iree_status_t iree_hal_task_device_trim(iree_hal_device_t* base_device) {
   return iree_ok_status();
 }
 
+#if IREE_STATISTICS_ENABLE
+// Queries the |key| statistic aggregated across all queues of |device|.
+static iree_status_t iree_hal_task_device_query_statistic(
+    iree_hal_task_device_t* device, iree_string_view_t key,
+    int64_t* out_value) {
+  iree_task_dispatch_statistics_t statistics;
+  memset(&statistics, 0, sizeof(statistics));
+  iree_task_executor_statistics_t worker_statistics;
+  memset(&worker_statistics, 0, sizeof(worker_statistics));
+  for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+    iree_task_dispatch_statistics_merge(
+        &device->queues[i].scope.dispatch_statistics, &statistics);
+    // Queues may share executors; only count each once.
+    bool is_shared = false;
+    for (iree_host_size_t j = 0; j < i; ++j) {
+      is_shared |= device->queues[j].executor == device->queues[i].executor;
+    }
+    if (!is_shared) {
+      iree_task_executor_statistics_t executor_statistics;
+      iree_task_executor_query_statistics(device->queues[i].executor,
+                                          &executor_statistics);
+      worker_statistics.worker_wait_time_ns +=
+          executor_statistics.worker_wait_time_ns;
+      worker_statistics.worker_spin_hit_count +=
+          executor_statistics.worker_spin_hit_count;
+      worker_statistics.worker_futex_wake_count +=
+          executor_statistics.worker_futex_wake_count;
+      worker_statistics.worker_wake_count +=
+          executor_statistics.worker_wake_count;
+      worker_statistics.worker_wake_latency_ns +=
+          executor_statistics.worker_wake_latency_ns;
+    }
+  }
+  struct {
+    iree_string_view_t key;
+    int64_t value;
+  } values[] = {
+#define IREE_HAL_TASK_STATISTIC(name) \
+  {IREE_SVL(#name),                   \
+   iree_atomic_load_int64(&statistics.name, iree_memory_order_relaxed)}
+      IREE_HAL_TASK_STATISTIC(dispatch_count),
+      IREE_HAL_TASK_STATISTIC(shard_count),
+      IREE_HAL_TASK_STATISTIC(tile_count),
+      IREE_HAL_TASK_STATISTIC(stolen_tile_count),
+      IREE_HAL_TASK_STATISTIC(shard_time_ns),
+      IREE_HAL_TASK_STATISTIC(max_shard_time_ns),
+      IREE_HAL_TASK_STATISTIC(shard_latency_ns),
+      IREE_HAL_TASK_STATISTIC(tile_yield_count),
+#undef IREE_HAL_TASK_STATISTIC
+#define IREE_HAL_TASK_WORKER_STATISTIC(name) \
+  {IREE_SVL(#name), worker_statistics.name}
+      IREE_HAL_TASK_WORKER_STATISTIC(worker_wait_time_ns),
+      IREE_HAL_TASK_WORKER_STATISTIC(worker_spin_hit_count),
+      IREE_HAL_TASK_WORKER_STATISTIC(worker_futex_wake_count),
+      IREE_HAL_TASK_WORKER_STATISTIC(worker_wake_count),
+      IREE_HAL_TASK_WORKER_STATISTIC(worker_wake_latency_ns),
+#undef IREE_HAL_TASK_WORKER_STATISTIC
+  };
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(values); ++i) {
+    if (iree_string_view_equal(key, values[i].key)) {
+      *out_value = values[i].value;
+      return iree_ok_status();
+    }
+  }
+  return iree_make_status(IREE_STATUS_NOT_FOUND,
+                          "unknown task statistic '%.*s'", (int)key.size,
+                          key.data);
+}
+#endif  // IREE_STATISTICS_ENABLE
+
 static iree_status_t iree_hal_task_device_query_i64(
     iree_hal_device_t* base_device, iree_string_view_t category,
     iree_string_view_t key, int64_t* out_value) {
@@ -249,6 +363,11 @@ static iree_status_t iree_hal_task_device_query_i64(
   } else if (iree_string_view_equal(category, IREE_SV("hal.cpu"))) {
     return iree_cpu_lookup_data_by_key(key, out_value);
   }
+#if IREE_STATISTICS_ENABLE
+  else if (iree_string_view_equal(category, IREE_SV("hal.task.statistics"))) {
+    return iree_hal_task_device_query_statistic(device, key, out_value);
+  }
+#endif  // IREE_STATISTICS_ENABLE
 
   return iree_make_status(
       IREE_STATUS_NOT_FOUND,
@@ -286,7 +405,8 @@ static iree_status_t iree_hal_task_device_create_command_buffer(
   iree_host_size_t queue_index = iree_hal_task_device_select_queue(
       device, command_categories, queue_affinity);
   return iree_hal_task_command_buffer_create(
-      base_device, &device->queues[queue_index].scope, mode, command_categories,
+      base_device, &device->queues[queue_index].scope,
+      &device->queues[queue_index].profiling_hook, mode, command_categories,
       queue_affinity, binding_capacity, &device->large_block_pool,
       device->host_allocator, out_command_buffer);
 }
@@ -315,11 +435,8 @@ static iree_status_t iree_hal_task_device_create_executable_cache(
 
   // Sum up the total worker count across all queues so that the loaders can
   // preallocate worker-specific storage.
-  iree_host_size_t total_worker_count = 0;
-  for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
-    total_worker_count +=
-        iree_task_executor_worker_count(device->queues[i].executor);
-  }
+  iree_host_size_t total_worker_count =
+      iree_hal_task_device_worker_count(device);
 
   return iree_hal_local_executable_cache_create(
       identifier, total_worker_count, device->loader_count, device->loaders,
@@ -424,23 +541,31 @@ static iree_status_t iree_hal_task_device_wait_semaphores(
 }
 
 static iree_status_t iree_hal_task_device_profiling_begin(
-    iree_hal_device_t* device,
+    iree_hal_device_t* base_device,
     const iree_hal_device_profiling_options_t* options) {
-  // Unimplemented (and that's ok).
-  // We could hook in to vendor APIs (Intel/ARM/etc) or generic perf infra:
-  // https://man7.org/linux/man-pages/man2/perf_event_open.2.html
-  // Capturing things like:
-  //   PERF_COUNT_HW_CPU_CYCLES / PERF_COUNT_HW_INSTRUCTIONS
-  //   PERF_COUNT_HW_CACHE_REFERENCES / PERF_COUNT_HW_CACHE_MISSES
-  //   etc
-  // TODO(benvanik): shared iree/hal/local/profiling implementation of this.
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  if (device->profiler) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "profiling already active on this device");
+  }
+  // Only dispatch counters and timelines are supported today; other modes are
+  // ignored.
+  IREE_RETURN_IF_ERROR(iree_hal_local_profiler_begin(
+      options, iree_hal_task_device_worker_count(device),
+      device->host_allocator, &device->profiler));
+  if (device->profiler) iree_hal_task_device_attach_profiler(device);
   return iree_ok_status();
 }
 
 static iree_status_t iree_hal_task_device_profiling_end(
-    iree_hal_device_t* device) {
-  // Unimplemented (and that's ok).
-  return iree_ok_status();
+    iree_hal_device_t* base_device) {
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  // Workgroups may still be executing (or yet to execute) and must stop
+  // sampling before the profiler can be merged and freed.
+  iree_hal_task_device_detach_profiler(device);
+  iree_hal_local_profiler_t* profiler = device->profiler;
+  device->profiler = NULL;
+  return iree_hal_local_profiler_end(profiler);
 }
 
 static const iree_hal_device_vtable_t iree_hal_task_device_vtable = {
@@ -416,6 +416,7 @@ static iree_status_t iree_hal_task_queue_retire_cmd_allocate(
 void iree_hal_task_queue_initialize(iree_string_view_t identifier,
                                     iree_task_executor_t* executor,
                                     iree_arena_block_pool_t* block_pool,
+                                    iree_allocator_t host_allocator,
                                     iree_hal_task_queue_t* out_queue) {
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_TEXT(z0, identifier.data, identifier.size);
@@ -427,6 +428,8 @@ void iree_hal_task_queue_initialize(iree_string_view_t identifier,
   out_queue->block_pool = block_pool;
 
   iree_task_scope_initialize(identifier, &out_queue->scope);
+  iree_hal_local_profiling_hook_initialize(host_allocator,
+                                           &out_queue->profiling_hook);
 
   iree_hal_task_queue_state_initialize(&out_queue->state);
 
@@ -440,6 +443,7 @@ void iree_hal_task_queue_deinitialize(iree_hal_task_queue_t* queue) {
       iree_task_scope_wait_idle(&queue->scope, IREE_TIME_INFINITE_FUTURE));
 
   iree_hal_task_queue_state_deinitialize(&queue->state);
+  iree_hal_local_profiling_hook_deinitialize(&queue->profiling_hook);
   iree_task_scope_deinitialize(&queue->scope);
   iree_task_executor_release(queue->executor);
 
@@ -14,6 +14,7 @@
 #include "iree/base/internal/synchronization.h"
 #include "iree/hal/api.h"
 #include "iree/hal/drivers/local_task/task_queue_state.h"
+#include "iree/hal/local/profiling.h"
 #include "iree/task/executor.h"
 #include "iree/task/scope.h"
 #include "iree/task/task.h"
@@ -33,6 +34,9 @@ typedef struct iree_hal_task_queue_t {
   // This allows for easy waits on all outstanding queue tasks as well as
   // differentiation of tasks within the executor.
   iree_task_scope_t scope;
+  // Hook the device profiler is attached to while profiling the queue. Shared
+  // by all dispatches recorded into command buffers for the queue.
+  iree_hal_local_profiling_hook_t profiling_hook;
   // State tracking used during command buffer issue.
   // The intra-queue synchronization (barriers/events) carries across command
   // buffers and this is used to rendezvous the tasks in each set.
@@ -42,6 +46,7 @@ typedef struct iree_hal_task_queue_t {
 void iree_hal_task_queue_initialize(iree_string_view_t identifier,
                                     iree_task_executor_t* executor,
                                     iree_arena_block_pool_t* block_pool,
+                                    iree_allocator_t host_allocator,
                                     iree_hal_task_queue_t* out_queue);
 
 void iree_hal_task_queue_deinitialize(iree_hal_task_queue_t* queue);
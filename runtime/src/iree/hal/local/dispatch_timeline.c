@@ -0,0 +1,483 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/dispatch_timeline.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+#include "iree/schemas/instruments/dispatch.h"
+
+// NOTE: include order matters:
+#include "iree/base/internal/flatcc/building.h"
+#include "iree/schemas/instruments/dispatch_def_builder.h"
+
+// Maximum number of unique executable exports that can be recorded. Must be a
+// power of two. Workgroups of dispatches beyond this are dropped.
+#define IREE_HAL_LOCAL_DISPATCH_TIMELINE_MAX_DISPATCHES 1024
+
+static_assert((IREE_HAL_LOCAL_DISPATCH_TIMELINE_RING_CAPACITY &
+               (IREE_HAL_LOCAL_DISPATCH_TIMELINE_RING_CAPACITY - 1)) == 0,
+              "ring capacity must be a power of two");
+
+// A single worker ringbuffer. Rings are written by their worker (or workers,
+// if IDs beyond the worker count share the ring) and only read once the
+// timeline ends and the device is idle.
+typedef struct iree_alignas(iree_hardware_destructive_interference_size)
+    iree_hal_local_dispatch_timeline_ring_t {
+  // Total number of records ever reserved in the ring. The record for a
+  // reservation is at |head| modulo the ring capacity.
+  iree_atomic_int64_t head;
+  // iree_instrument_dispatch_timeline_t[RING_CAPACITY] allocated on first use.
+  iree_atomic_intptr_t records;
+} iree_hal_local_dispatch_timeline_ring_t;
+
+// An executable export assigned a dispatch ID.
+typedef struct iree_hal_local_dispatch_timeline_entry_t {
+  // Executable retained for the duration of the timeline or 0 if the entry is
+  // unused. Stored with release semantics after the other fields are set such
+  // that entries can be looked up without a lock.
+  iree_atomic_intptr_t executable;
+  uint32_t ordinal;
+  uint32_t dispatch_id;
+} iree_hal_local_dispatch_timeline_entry_t;
+
+struct iree_hal_local_dispatch_timeline_t {
+  iree_allocator_t host_allocator;
+  // Path the timeline is written to when it ends.
+  iree_string_view_t file_path;
+  // Workgroups that could not be recorded due to resource exhaustion.
+  iree_atomic_int64_t dropped_count;
+  // Guards insertion into |entries|. Lookups are lock-free.
+  iree_slim_mutex_t mutex;
+  uint32_t dispatch_count IREE_GUARDED_BY(mutex);
+  // Open-addressed table keyed on executable and export ordinal.
+  iree_hal_local_dispatch_timeline_entry_t
+      entries[IREE_HAL_LOCAL_DISPATCH_TIMELINE_MAX_DISPATCHES];
+  iree_host_size_t ring_count;
+  iree_hal_local_dispatch_timeline_ring_t* rings;
+  // + trailing rings[ring_count] storage (aligned)
+  // + trailing file_path storage
+};
+
+//===----------------------------------------------------------------------===//
+// Dispatch instrumentation
+//===----------------------------------------------------------------------===//
+
+// Assigns the next dispatch ID to |executable| export |ordinal| if it has not
+// already been assigned one by another worker.
+static bool iree_hal_local_dispatch_timeline_insert_dispatch(
+    iree_hal_local_dispatch_timeline_t* timeline, uintptr_t hash,
+    iree_hal_local_executable_t* executable, uint32_t ordinal,
+    uint32_t* out_dispatch_id) {
+  bool found = false;
+  iree_slim_mutex_lock(&timeline->mutex);
+  for (iree_host_size_t i = 0;
+       i < IREE_HAL_LOCAL_DISPATCH_TIMELINE_MAX_DISPATCHES; ++i) {
+    iree_hal_local_dispatch_timeline_entry_t* entry =
+        &timeline->entries[(hash + i) &
+                           (IREE_HAL_LOCAL_DISPATCH_TIMELINE_MAX_DISPATCHES -
+                            1)];
+    intptr_t entry_executable =
+        iree_atomic_load_intptr(&entry->executable, iree_memory_order_relaxed);
+    if (entry_executable == (intptr_t)executable && entry->ordinal == ordinal) {
+      *out_dispatch_id = entry->dispatch_id;
+      found = true;
+      break;
+    } else if (!entry_executable) {
+      // Retain so that the export name is available when writing the timeline
+      // even if the executable is released before the timeline ends.
+      iree_hal_executable_retain((iree_hal_executable_t*)executable);
+      entry->ordinal = ordinal;
+      entry->dispatch_id = timeline->dispatch_count++;
+      iree_atomic_store_intptr(&entry->executable, (intptr_t)executable,
+                               iree_memory_order_release);
+      *out_dispatch_id = entry->dispatch_id;
+      found = true;
+      break;
+    }
+  }
+  iree_slim_mutex_unlock(&timeline->mutex);
+  return found;
+}
+
+static bool iree_hal_local_dispatch_timeline_lookup_dispatch(
+    iree_hal_local_dispatch_timeline_t* timeline,
+    iree_hal_local_executable_t* executable, uint32_t ordinal,
+    uint32_t* out_dispatch_id) {
+  uintptr_t hash = ((uintptr_t)executable >> 4) * 31 + ordinal;
+  for (iree_host_size_t i = 0;
+       i < IREE_HAL_LOCAL_DISPATCH_TIMELINE_MAX_DISPATCHES; ++i) {
+    iree_hal_local_dispatch_timeline_entry_t* entry =
+        &timeline->entries[(hash + i) &
+                           (IREE_HAL_LOCAL_DISPATCH_TIMELINE_MAX_DISPATCHES -
+                            1)];
+    intptr_t entry_executable =
+        iree_atomic_load_intptr(&entry->executable, iree_memory_order_acquire);
+    if (entry_executable == (intptr_t)executable && entry->ordinal == ordinal) {
+      *out_dispatch_id = entry->dispatch_id;
+      return true;
+    } else if (!entry_executable) {
+      // First time the dispatch has been seen (or another worker is inserting
+      // it concurrently); resolve under the lock.
+      return iree_hal_local_dispatch_timeline_insert_dispatch(
+          timeline, hash, executable, ordinal, out_dispatch_id);
+    }
+  }
+  return false;
+}
+
+// Returns the records of |ring|, allocating them on first use.
+static iree_instrument_dispatch_timeline_t*
+iree_hal_local_dispatch_timeline_ring_records(
+    iree_hal_local_dispatch_timeline_t* timeline,
+    iree_hal_local_dispatch_timeline_ring_t* ring) {
+  iree_instrument_dispatch_timeline_t* records =
+      (iree_instrument_dispatch_timeline_t*)iree_atomic_load_intptr(
+          &ring->records, iree_memory_order_acquire);
+  if (IREE_LIKELY(records)) return records;
+
+  iree_status_t status = iree_allocator_malloc(
+      timeline->host_allocator,
+      IREE_HAL_LOCAL_DISPATCH_TIMELINE_RING_CAPACITY * sizeof(*records),
+      (void**)&records);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    return NULL;
+  }
+  intptr_t expected = 0;
+  if (!iree_atomic_compare_exchange_strong_intptr(
+          &ring->records, &expected, (intptr_t)records,
+          iree_memory_order_acq_rel, iree_memory_order_acquire)) {
+    // Another worker sharing the ring allocated it first.
+    iree_allocator_free(timeline->host_allocator, records);
+    records = (iree_instrument_dispatch_timeline_t*)expected;
+  }
+  return records;
+}
+
+void iree_hal_local_dispatch_timeline_record(
+    iree_hal_local_dispatch_timeline_t* timeline, uint32_t worker_id,
+    iree_hal_local_executable_t* executable, uint32_t ordinal,
+    uint32_t workgroup_index, uint32_t workgroup_count,
+    iree_time_t begin_time_ns, iree_time_t end_time_ns) {
+  uint32_t dispatch_id = 0;
+  iree_hal_local_dispatch_timeline_ring_t* ring =
+      &timeline->rings[worker_id < timeline->ring_count
+                           ? worker_id
+                           : worker_id % timeline->ring_count];
+  iree_instrument_dispatch_timeline_t* records =
+      iree_hal_local_dispatch_timeline_ring_records(timeline, ring);
+  if (IREE_UNLIKELY(!records ||
+                    !iree_hal_local_dispatch_timeline_lookup_dispatch(
+                        timeline, executable, ordinal, &dispatch_id))) {
+    iree_atomic_fetch_add_int64(&timeline->dropped_count, 1,
+                                iree_memory_order_relaxed);
+    return;
+  }
+
+  // Rings are usually only written by a single worker but workers beyond the
+  // ring count share rings and the head is reserved atomically to keep them
+  // lock-free.
+  const int64_t index = iree_atomic_fetch_add_int64(&ring->head, 1,
+                                                    iree_memory_order_relaxed);
+  iree_instrument_dispatch_timeline_t* record =
+      &records[index & (IREE_HAL_LOCAL_DISPATCH_TIMELINE_RING_CAPACITY - 1)];
+  record->tag = IREE_INSTRUMENT_DISPATCH_TYPE_TIMELINE;
+  record->dispatch_id = dispatch_id;
+  record->worker_id = worker_id;
+  record->workgroup_index = workgroup_index;
+  record->workgroup_count = workgroup_count;
+  record->begin_time_ns = begin_time_ns;
+  record->end_time_ns = end_time_ns;
+}
+
+//===----------------------------------------------------------------------===//
+// Timeline file output
+//===----------------------------------------------------------------------===//
+
+static iree_status_t iree_hal_local_dispatch_timeline_fwrite(
+    const void* data, iree_host_size_t length, FILE* file) {
+  if (length && fwrite(data, 1, length, file) != length) {
+    return iree_make_status(IREE_STATUS_DATA_LOSS,
+                            "failed to write %" PRIhsz " bytes of timeline",
+                            length);
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_local_dispatch_timeline_write_chunk_header(
+    iree_idbts_chunk_type_t type, uint64_t content_length, FILE* file) {
+  iree_idbts_chunk_header_t header;
+  memset(&header, 0, sizeof(header));
+  header.magic = IREE_IDBTS_CHUNK_MAGIC;
+  header.type = type;
+  header.version = 0;
+  header.content_length = content_length;
+  return iree_hal_local_dispatch_timeline_fwrite(&header, sizeof(header), file);
+}
+
+// Builds the dispatch metadata flatbuffer with one function and one site per
+// dispatch ID.
+static iree_status_t iree_hal_local_dispatch_timeline_build_metadata(
+    iree_hal_local_dispatch_timeline_t* timeline, flatcc_builder_t* builder) {
+  iree_slim_mutex_lock(&timeline->mutex);
+  const uint32_t dispatch_count = timeline->dispatch_count;
+  iree_slim_mutex_unlock(&timeline->mutex);
+
+  iree_instruments_DispatchFunctionDef_ref_t* function_refs = NULL;
+  iree_instruments_DispatchSiteDef_ref_t* site_refs = NULL;
+  if (dispatch_count > 0) {
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+        timeline->host_allocator,
+        dispatch_count * (sizeof(*function_refs) + sizeof(*site_refs)),
+        (void**)&function_refs));
+    site_refs =
+        (iree_instruments_DispatchSiteDef_ref_t*)(function_refs +
+                                                  dispatch_count);
+  }
+
+  for (iree_host_size_t i = 0;
+       i < IREE_HAL_LOCAL_DISPATCH_TIMELINE_MAX_DISPATCHES; ++i) {
+    iree_hal_local_dispatch_timeline_entry_t* entry = &timeline->entries[i];
+    iree_hal_local_executable_t* executable =
+        (iree_hal_local_executable_t*)iree_atomic_load_intptr(
+            &entry->executable, iree_memory_order_acquire);
+    if (!executable) continue;
+    const char* export_name = executable->export_names
+                                  ? executable->export_names[entry->ordinal]
+                                  : NULL;
+    char fallback_name[32];
+    if (!export_name) {
+      snprintf(fallback_name, sizeof(fallback_name), "%p:%u",
+               (void*)executable, entry->ordinal);
+      export_name = fallback_name;
+    }
+    flatbuffers_string_ref_t name_ref =
+        flatbuffers_string_create_str(builder, export_name);
+    iree_instruments_DispatchFunctionDef_start(builder);
+    iree_instruments_DispatchFunctionDef_name_add(builder, name_ref);
+    function_refs[entry->dispatch_id] =
+        iree_instruments_DispatchFunctionDef_end(builder);
+    iree_instruments_DispatchSiteDef_start(builder);
+    iree_instruments_DispatchSiteDef_function_add(builder, entry->dispatch_id);
+    site_refs[entry->dispatch_id] =
+        iree_instruments_DispatchSiteDef_end(builder);
+  }
+
+  iree_instruments_DispatchFunctionDef_vec_ref_t functions_ref =
+      iree_instruments_DispatchFunctionDef_vec_create(builder, function_refs,
+                                                      dispatch_count);
+  iree_instruments_DispatchSiteDef_vec_ref_t sites_ref =
+      iree_instruments_DispatchSiteDef_vec_create(builder, site_refs,
+                                                  dispatch_count);
+  iree_instruments_DispatchInstrumentDef_start_as_root(builder);
+  iree_instruments_DispatchInstrumentDef_version_add(builder, 0);
+  iree_instruments_DispatchInstrumentDef_flags_add(builder, 0);
+  iree_instruments_DispatchInstrumentDef_functions_add(builder, functions_ref);
+  iree_instruments_DispatchInstrumentDef_sites_add(builder, sites_ref);
+  iree_instruments_DispatchInstrumentDef_end_as_root(builder);
+
+  iree_allocator_free(timeline->host_allocator, function_refs);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_local_dispatch_timeline_write_metadata(
+    iree_hal_local_dispatch_timeline_t* timeline, FILE* file) {
+  flatcc_builder_t builder;
+  if (flatcc_builder_init(&builder) != 0) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "failed to initialize flatbuffer builder");
+  }
+  iree_status_t status =
+      iree_hal_local_dispatch_timeline_build_metadata(timeline, &builder);
+
+  uint8_t* metadata = NULL;
+  size_t metadata_size = 0;
+  if (iree_status_is_ok(status)) {
+    metadata_size = flatcc_builder_get_buffer_size(&builder);
+    status = iree_allocator_malloc(timeline->host_allocator, metadata_size,
+                                   (void**)&metadata);
+  }
+  if (iree_status_is_ok(status) &&
+      !flatcc_builder_copy_buffer(&builder, metadata, metadata_size)) {
+    status = iree_make_status(IREE_STATUS_INTERNAL,
+                              "failed to finalize dispatch metadata");
+  }
+  flatcc_builder_clear(&builder);
+
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_local_dispatch_timeline_write_chunk_header(
+        IREE_IDBTS_CHUNK_TYPE_DISPATCH_METADATA, metadata_size, file);
+  }
+  if (iree_status_is_ok(status)) {
+    status =
+        iree_hal_local_dispatch_timeline_fwrite(metadata, metadata_size, file);
+  }
+  if (iree_status_is_ok(status)) {
+    // Chunks must start at 16-byte alignment boundaries.
+    static const uint8_t zeros[16] = {0};
+    status = iree_hal_local_dispatch_timeline_fwrite(
+        zeros, iree_host_align(metadata_size, 16) - metadata_size, file);
+  }
+  iree_allocator_free(timeline->host_allocator, metadata);
+  return status;
+}
+
+// Writes |ring| as a ringbuffer chunk in the format produced by compiled-in
+// dispatch instrumentation. Records are linearized such that the oldest
+// retained record is first and the write head is set to the end of the
+// retained records.
+static iree_status_t iree_hal_local_dispatch_timeline_write_ring(
+    iree_hal_local_dispatch_timeline_ring_t* ring, FILE* file) {
+  const iree_instrument_dispatch_timeline_t* records =
+      (const iree_instrument_dispatch_timeline_t*)iree_atomic_load_intptr(
+          &ring->records, iree_memory_order_acquire);
+  const int64_t head =
+      iree_atomic_load_int64(&ring->head, iree_memory_order_acquire);
+  if (!records || head == 0) return iree_ok_status();
+
+  const uint64_t record_count =
+      iree_min((uint64_t)head, IREE_HAL_LOCAL_DISPATCH_TIMELINE_RING_CAPACITY);
+  const uint64_t first_index = (head - record_count) &
+                               (IREE_HAL_LOCAL_DISPATCH_TIMELINE_RING_CAPACITY -
+                                1);
+  const uint64_t leading_count =
+      iree_min(record_count,
+               IREE_HAL_LOCAL_DISPATCH_TIMELINE_RING_CAPACITY - first_index);
+  const uint64_t ring_size = record_count * sizeof(*records);
+
+  IREE_RETURN_IF_ERROR(iree_hal_local_dispatch_timeline_write_chunk_header(
+      IREE_IDBTS_CHUNK_TYPE_DISPATCH_RINGBUFFER,
+      ring_size + IREE_INSTRUMENT_DISPATCH_PADDING, file));
+  IREE_RETURN_IF_ERROR(iree_hal_local_dispatch_timeline_fwrite(
+      &records[first_index], leading_count * sizeof(*records), file));
+  IREE_RETURN_IF_ERROR(iree_hal_local_dispatch_timeline_fwrite(
+      records, (record_count - leading_count) * sizeof(*records), file));
+
+  // The trailing 8 bytes of the padding are the ringbuffer write head.
+  static const uint8_t zeros[IREE_INSTRUMENT_DISPATCH_PADDING -
+                             sizeof(uint64_t)] = {0};
+  IREE_RETURN_IF_ERROR(
+      iree_hal_local_dispatch_timeline_fwrite(zeros, sizeof(zeros), file));
+  return iree_hal_local_dispatch_timeline_fwrite(&ring_size, sizeof(ring_size),
+                                                 file);
+}
+
+static iree_status_t iree_hal_local_dispatch_timeline_write_file(
+    iree_hal_local_dispatch_timeline_t* timeline) {
+#if IREE_FILE_IO_ENABLE
+  FILE* file = fopen(timeline->file_path.data, "wb");
+  if (!file) {
+    return iree_make_status(IREE_STATUS_PERMISSION_DENIED,
+                            "failed to open dispatch timeline file '%s'",
+                            timeline->file_path.data);
+  }
+  iree_status_t status =
+      iree_hal_local_dispatch_timeline_write_metadata(timeline, file);
+  for (iree_host_size_t i = 0;
+       i < timeline->ring_count && iree_status_is_ok(status); ++i) {
+    status = iree_hal_local_dispatch_timeline_write_ring(&timeline->rings[i],
+                                                         file);
+  }
+  if (fclose(file) != 0 && iree_status_is_ok(status)) {
+    status = iree_make_status(IREE_STATUS_DATA_LOSS,
+                              "failed to flush dispatch timeline file '%s'",
+                              timeline->file_path.data);
+  }
+  return status;
+#else
+  return iree_make_status(IREE_STATUS_UNAVAILABLE, "File I/O is disabled");
+#endif  // IREE_FILE_IO_ENABLE
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_local_dispatch_timeline_t
+//===----------------------------------------------------------------------===//
+
+iree_status_t iree_hal_local_dispatch_timeline_begin(
+    const iree_hal_device_profiling_options_t* options,
+    iree_host_size_t worker_count, iree_allocator_t host_allocator,
+    iree_hal_local_dispatch_timeline_t** out_timeline) {
+  IREE_ASSERT_ARGUMENT(options);
+  IREE_ASSERT_ARGUMENT(out_timeline);
+  *out_timeline = NULL;
+  if (!iree_all_bits_set(options->mode,
+                         IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_TIMELINE)) {
+    return iree_ok_status();
+  }
+  iree_string_view_t file_path = iree_make_cstring_view(options->file_path);
+  if (iree_string_view_is_empty(file_path)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "dispatch timelines require a profiling file path");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Workers always get at least one ring to share.
+  const iree_host_size_t ring_count = iree_max(1, worker_count);
+  iree_hal_local_dispatch_timeline_t* timeline = NULL;
+  const iree_host_size_t rings_offset = iree_host_align(
+      sizeof(*timeline), iree_hardware_destructive_interference_size);
+  const iree_host_size_t file_path_offset =
+      rings_offset + ring_count * sizeof(*timeline->rings);
+  const iree_host_size_t total_size = file_path_offset + file_path.size + 1;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc_aligned(
+              host_allocator, total_size,
+              iree_hardware_destructive_interference_size, 0,
+              (void**)&timeline));
+  timeline->host_allocator = host_allocator;
+  timeline->ring_count = ring_count;
+  timeline->rings =
+      (iree_hal_local_dispatch_timeline_ring_t*)((uint8_t*)timeline +
+                                                 rings_offset);
+  char* file_path_ptr = (char*)timeline + file_path_offset;
+  memcpy(file_path_ptr, file_path.data, file_path.size);
+  file_path_ptr[file_path.size] = 0;
+  timeline->file_path = iree_make_string_view(file_path_ptr, file_path.size);
+  iree_slim_mutex_initialize(&timeline->mutex);
+
+  *out_timeline = timeline;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_local_dispatch_timeline_end(
+    iree_hal_local_dispatch_timeline_t* timeline) {
+  if (!timeline) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_status_t status = iree_hal_local_dispatch_timeline_write_file(timeline);
+  IREE_TRACE({
+    IREE_TRACE_PLOT_VALUE_I64(
+        "hal-local-timeline-dropped",
+        iree_atomic_load_int64(&timeline->dropped_count,
+                               iree_memory_order_relaxed));
+  });
+
+  for (iree_host_size_t i = 0;
+       i < IREE_HAL_LOCAL_DISPATCH_TIMELINE_MAX_DISPATCHES; ++i) {
+    iree_hal_executable_t* executable =
+        (iree_hal_executable_t*)iree_atomic_load_intptr(
+            &timeline->entries[i].executable, iree_memory_order_acquire);
+    iree_hal_executable_release(executable);
+  }
+  for (iree_host_size_t i = 0; i < timeline->ring_count; ++i) {
+    iree_allocator_free(timeline->host_allocator,
+                        (void*)iree_atomic_load_intptr(
+                            &timeline->rings[i].records,
+                            iree_memory_order_acquire));
+  }
+  iree_slim_mutex_deinitialize(&timeline->mutex);
+  iree_allocator_free_aligned(timeline->host_allocator, timeline);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -0,0 +1,79 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_LOCAL_DISPATCH_TIMELINE_H_
+#define IREE_HAL_LOCAL_DISPATCH_TIMELINE_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/local/local_executable.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Number of records retained per worker ringbuffer. Must be a power of two.
+// Each record is 32 bytes and rings are allocated on first use by a worker.
+// Once a ring fills the oldest records are overwritten.
+#if !defined(IREE_HAL_LOCAL_DISPATCH_TIMELINE_RING_CAPACITY)
+#define IREE_HAL_LOCAL_DISPATCH_TIMELINE_RING_CAPACITY (32 * 1024)
+#endif  // !IREE_HAL_LOCAL_DISPATCH_TIMELINE_RING_CAPACITY
+
+//===----------------------------------------------------------------------===//
+// iree_hal_local_dispatch_timeline_t
+//===----------------------------------------------------------------------===//
+
+// Runtime-only dispatch timeline recorder used by the local HAL profiler.
+//
+// When IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_TIMELINE is requested each
+// workgroup (or each inline dispatch on devices that run all workgroups at
+// once) appends a fixed-size record with its dispatch, worker, and begin/end
+// timestamps to a per-worker ringbuffer. Appending a record is lock-free and
+// costs an atomic increment of the ring head and a 32 byte store. Dispatches
+// are identified by their executable export and assigned a dispatch ID on
+// first use.
+//
+// When the timeline ends the rings are written to the file path provided in
+// the profiling options as an IDBTS instrument stream containing a dispatch
+// metadata chunk naming each dispatch followed by one ringbuffer chunk of
+// iree_instrument_dispatch_timeline_t records per worker. The file can be
+// inspected with iree-dump-instruments.
+//
+// Timelines are not used directly by devices: they are owned by an
+// iree_hal_local_profiler_t which routes workgroup samples to them through
+// the profiling hooks of the device (see iree/hal/local/profiling.h).
+typedef struct iree_hal_local_dispatch_timeline_t
+    iree_hal_local_dispatch_timeline_t;
+
+// Begins recording a timeline with the given |options| and one ringbuffer per
+// worker in |worker_count|. Returns NULL in |out_timeline| if |options| does
+// not request a dispatch timeline. Fails if no file path is provided.
+iree_status_t iree_hal_local_dispatch_timeline_begin(
+    const iree_hal_device_profiling_options_t* options,
+    iree_host_size_t worker_count, iree_allocator_t host_allocator,
+    iree_hal_local_dispatch_timeline_t** out_timeline);
+
+// Ends recording, writes the timeline file, and frees the |timeline|.
+// No workgroups may be recorded concurrently.
+iree_status_t iree_hal_local_dispatch_timeline_end(
+    iree_hal_local_dispatch_timeline_t* timeline);
+
+// Records an interval from |begin_time_ns| to |end_time_ns| covering
+// |workgroup_count| workgroups starting at the linearized |workgroup_index| of
+// |executable| export |ordinal| as executed by |worker_id|. Workers with IDs
+// beyond the worker count of the timeline share rings with lower IDs and their
+// records retain the original worker ID.
+void iree_hal_local_dispatch_timeline_record(
+    iree_hal_local_dispatch_timeline_t* timeline, uint32_t worker_id,
+    iree_hal_local_executable_t* executable, uint32_t ordinal,
+    uint32_t workgroup_index, uint32_t workgroup_count,
+    iree_time_t begin_time_ns, iree_time_t end_time_ns);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_LOCAL_DISPATCH_TIMELINE_H_
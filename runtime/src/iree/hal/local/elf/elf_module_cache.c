@@ -0,0 +1,205 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/elf/elf_module_cache.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "iree/base/internal/call_once.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+
+//===----------------------------------------------------------------------===//
+// iree_elf_module_cache_t
+//===----------------------------------------------------------------------===//
+
+// Number of hash buckets in the cache. Programs rarely have more than a few
+// hundred unique executables and the chains are short enough to walk.
+#define IREE_ELF_MODULE_CACHE_BUCKET_COUNT 64
+
+typedef struct iree_elf_module_cache_entry_t {
+  // Next entry in the bucket chain.
+  struct iree_elf_module_cache_entry_t* next;
+  // Number of outstanding acquires of |module|.
+  iree_host_size_t reference_count;
+  // Content hash of the ELF data used to select the bucket.
+  uint64_t hash;
+  // Loaded module shared by all acquirers.
+  iree_elf_module_t module;
+  // Private copy of the ELF data used to disambiguate hash collisions.
+  iree_host_size_t data_length;
+  uint8_t data[];
+} iree_elf_module_cache_entry_t;
+
+struct iree_elf_module_cache_t {
+  iree_allocator_t host_allocator;
+  iree_slim_mutex_t mutex;
+  iree_host_size_t module_count IREE_GUARDED_BY(mutex);
+  uint64_t hit_count IREE_GUARDED_BY(mutex);
+  uint64_t miss_count IREE_GUARDED_BY(mutex);
+  iree_elf_module_cache_entry_t* buckets[IREE_ELF_MODULE_CACHE_BUCKET_COUNT]
+      IREE_GUARDED_BY(mutex);
+};
+
+static iree_elf_module_cache_t iree_elf_module_cache_default_;
+static iree_once_flag iree_elf_module_cache_default_flag_ = IREE_ONCE_FLAG_INIT;
+static void iree_elf_module_cache_default_initialize(void) {
+  memset(&iree_elf_module_cache_default_, 0,
+         sizeof(iree_elf_module_cache_default_));
+  iree_elf_module_cache_default_.host_allocator = iree_allocator_system();
+  iree_slim_mutex_initialize(&iree_elf_module_cache_default_.mutex);
+}
+
+iree_elf_module_cache_t* iree_elf_module_cache_default(void) {
+  iree_call_once(&iree_elf_module_cache_default_flag_,
+                 iree_elf_module_cache_default_initialize);
+  return &iree_elf_module_cache_default_;
+}
+
+// 64-bit FNV-1a over |data|. The hash is only used for bucketing and entries
+// are always verified with a full comparison.
+static uint64_t iree_elf_module_cache_hash(iree_const_byte_span_t data) {
+  uint64_t hash = 0xCBF29CE484222325ull;
+  for (iree_host_size_t i = 0; i < data.data_length; ++i) {
+    hash ^= data.data[i];
+    hash *= 0x100000001B3ull;
+  }
+  return hash;
+}
+
+static iree_elf_module_cache_entry_t* iree_elf_module_cache_lookup(
+    iree_elf_module_cache_t* cache, uint64_t hash,
+    iree_const_byte_span_t raw_data) {
+  iree_elf_module_cache_entry_t* entry =
+      cache->buckets[hash % IREE_ELF_MODULE_CACHE_BUCKET_COUNT];
+  for (; entry != NULL; entry = entry->next) {
+    if (entry->hash == hash && entry->data_length == raw_data.data_length &&
+        memcmp(entry->data, raw_data.data, raw_data.data_length) == 0) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+static void iree_elf_module_cache_entry_free(
+    iree_elf_module_cache_t* cache, iree_elf_module_cache_entry_t* entry) {
+  iree_elf_module_deinitialize(&entry->module);
+  iree_allocator_free(cache->host_allocator, entry);
+}
+
+iree_status_t iree_elf_module_cache_acquire(iree_elf_module_cache_t* cache,
+                                            iree_const_byte_span_t raw_data,
+                                            iree_elf_module_t** out_module) {
+  IREE_ASSERT_ARGUMENT(cache);
+  IREE_ASSERT_ARGUMENT(raw_data.data);
+  IREE_ASSERT_ARGUMENT(out_module);
+  *out_module = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)raw_data.data_length);
+
+  const uint64_t hash = iree_elf_module_cache_hash(raw_data);
+
+  // Fast path: module already loaded.
+  iree_slim_mutex_lock(&cache->mutex);
+  iree_elf_module_cache_entry_t* entry =
+      iree_elf_module_cache_lookup(cache, hash, raw_data);
+  if (entry) {
+    ++entry->reference_count;
+    ++cache->hit_count;
+    *out_module = &entry->module;
+  }
+  iree_slim_mutex_unlock(&cache->mutex);
+  if (*out_module) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+
+  // Slow path: load the module outside of the lock so that unrelated loads can
+  // proceed in parallel.
+  iree_elf_module_cache_entry_t* new_entry = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(cache->host_allocator,
+                                sizeof(*new_entry) + raw_data.data_length,
+                                (void**)&new_entry));
+  new_entry->next = NULL;
+  new_entry->reference_count = 1;
+  new_entry->hash = hash;
+  new_entry->data_length = raw_data.data_length;
+  memcpy(new_entry->data, raw_data.data, raw_data.data_length);
+  iree_status_t status = iree_elf_module_initialize_from_memory(
+      raw_data, /*import_table=*/NULL, cache->host_allocator,
+      &new_entry->module);
+  if (!iree_status_is_ok(status)) {
+    iree_allocator_free(cache->host_allocator, new_entry);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  // Insert the new entry unless another thread beat us to it.
+  iree_slim_mutex_lock(&cache->mutex);
+  entry = iree_elf_module_cache_lookup(cache, hash, raw_data);
+  if (entry) {
+    ++entry->reference_count;
+    ++cache->hit_count;
+  } else {
+    iree_elf_module_cache_entry_t** bucket =
+        &cache->buckets[hash % IREE_ELF_MODULE_CACHE_BUCKET_COUNT];
+    new_entry->next = *bucket;
+    *bucket = new_entry;
+    ++cache->module_count;
+    ++cache->miss_count;
+    entry = new_entry;
+    new_entry = NULL;
+  }
+  *out_module = &entry->module;
+  iree_slim_mutex_unlock(&cache->mutex);
+
+  if (new_entry) iree_elf_module_cache_entry_free(cache, new_entry);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+void iree_elf_module_cache_release(iree_elf_module_cache_t* cache,
+                                   iree_elf_module_t* module) {
+  if (!module) return;
+  IREE_ASSERT_ARGUMENT(cache);
+  iree_elf_module_cache_entry_t* entry =
+      (iree_elf_module_cache_entry_t*)((uint8_t*)module -
+                                       offsetof(iree_elf_module_cache_entry_t,
+                                                module));
+
+  iree_slim_mutex_lock(&cache->mutex);
+  bool should_free = --entry->reference_count == 0;
+  if (should_free) {
+    iree_elf_module_cache_entry_t** link =
+        &cache->buckets[entry->hash % IREE_ELF_MODULE_CACHE_BUCKET_COUNT];
+    while (*link != entry) link = &(*link)->next;
+    *link = entry->next;
+    --cache->module_count;
+  }
+  iree_slim_mutex_unlock(&cache->mutex);
+
+  if (should_free) {
+    IREE_TRACE_ZONE_BEGIN(z0);
+    iree_elf_module_cache_entry_free(cache, entry);
+    IREE_TRACE_ZONE_END(z0);
+  }
+}
+
+void iree_elf_module_cache_query_statistics(
+    iree_elf_module_cache_t* cache,
+    iree_elf_module_cache_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(cache);
+  IREE_ASSERT_ARGUMENT(out_statistics);
+  iree_slim_mutex_lock(&cache->mutex);
+  out_statistics->module_count = cache->module_count;
+  out_statistics->hit_count = cache->hit_count;
+  out_statistics->miss_count = cache->miss_count;
+  iree_slim_mutex_unlock(&cache->mutex);
+}
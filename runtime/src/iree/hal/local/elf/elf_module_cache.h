@@ -0,0 +1,83 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_LOCAL_ELF_ELF_MODULE_CACHE_H_
+#define IREE_HAL_LOCAL_ELF_ELF_MODULE_CACHE_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/local/elf/elf_module.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_elf_module_cache_t
+//===----------------------------------------------------------------------===//
+
+// A content-addressed cache of loaded ELF modules.
+//
+// Loading an ELF module requires mapping pages, applying relocations, and
+// changing page protections - all of which are relatively expensive and repeat
+// identically each time the same executable is loaded. Because loaded modules
+// are immutable after initialization (IREE executables do not have mutable
+// global state and receive everything they need via the environment and
+// dispatch state) the same loaded image can be shared by any number of
+// executables across devices and VM contexts within the process.
+//
+// Entries are keyed by the contents of the ELF (or FatELF) data and are
+// reference counted: the first acquire of a particular ELF loads it and the
+// last release unloads it. A private copy of the ELF data is retained per entry
+// so that hash collisions are detected with a full comparison; this is small
+// compared to the loaded image and avoids requiring callers to keep their
+// executable data live.
+//
+// Thread-safe - multiple threads may acquire and release modules concurrently.
+// Two threads racing to load the same ELF may both perform the load with the
+// loser discarding its copy in favor of the one that was inserted first.
+typedef struct iree_elf_module_cache_t iree_elf_module_cache_t;
+
+// Returns the process-wide default module cache.
+// The cache uses the system allocator as it outlives any particular device or
+// context that may acquire modules from it.
+iree_elf_module_cache_t* iree_elf_module_cache_default(void);
+
+// Acquires a loaded module for the ELF |raw_data| from the |cache|.
+// If an identical ELF has already been loaded and is still referenced the
+// existing module is returned; otherwise the ELF is loaded and inserted.
+// Callers must balance each successful acquire with a call to
+// iree_elf_module_cache_release once they no longer need the module.
+//
+// |raw_data| only needs to remain valid for the duration of the call.
+iree_status_t iree_elf_module_cache_acquire(iree_elf_module_cache_t* cache,
+                                            iree_const_byte_span_t raw_data,
+                                            iree_elf_module_t** out_module);
+
+// Releases a |module| previously acquired from the |cache|. The module will be
+// unloaded if this was the last reference.
+void iree_elf_module_cache_release(iree_elf_module_cache_t* cache,
+                                   iree_elf_module_t* module);
+
+// Statistics about cache usage for diagnostics and testing.
+typedef struct iree_elf_module_cache_statistics_t {
+  // Total number of modules currently loaded in the cache.
+  iree_host_size_t module_count;
+  // Total number of acquires that were satisfied by an existing module.
+  uint64_t hit_count;
+  // Total number of acquires that required loading a new module.
+  uint64_t miss_count;
+} iree_elf_module_cache_statistics_t;
+
+// Queries the current |cache| statistics.
+void iree_elf_module_cache_query_statistics(
+    iree_elf_module_cache_t* cache,
+    iree_elf_module_cache_statistics_t* out_statistics);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_LOCAL_ELF_ELF_MODULE_CACHE_H_
@@ -8,6 +8,7 @@
 #include "iree/base/internal/cpu.h"
 #include "iree/base/target_platform.h"
 #include "iree/hal/local/elf/elf_module.h"
+#include "iree/hal/local/elf/elf_module_cache.h"
 #include "iree/hal/local/executable_environment.h"
 #include "iree/hal/local/executable_library.h"
 
@@ -156,8 +157,59 @@ static iree_status_t run_test() {
   return status;
 }
 
+static iree_status_t run_cache_test() {
+  iree_const_byte_span_t file_data;
+  IREE_RETURN_IF_ERROR(query_arch_test_file_data(&file_data));
+
+  iree_elf_module_cache_t* cache = iree_elf_module_cache_default();
+  iree_elf_module_cache_statistics_t base_statistics;
+  iree_elf_module_cache_query_statistics(cache, &base_statistics);
+
+  // Acquiring the same ELF twice must return the same loaded module.
+  iree_elf_module_t* module_a = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_elf_module_cache_acquire(cache, file_data, &module_a));
+  iree_elf_module_t* module_b = NULL;
+  iree_status_t status =
+      iree_elf_module_cache_acquire(cache, file_data, &module_b);
+
+  iree_elf_module_cache_statistics_t statistics;
+  iree_elf_module_cache_query_statistics(cache, &statistics);
+  if (iree_status_is_ok(status) && module_a != module_b) {
+    status = iree_make_status(IREE_STATUS_INTERNAL,
+                              "cached module was not shared");
+  }
+  if (iree_status_is_ok(status) &&
+      (statistics.module_count != base_statistics.module_count + 1 ||
+       statistics.miss_count != base_statistics.miss_count + 1 ||
+       statistics.hit_count != base_statistics.hit_count + 1)) {
+    status = iree_make_status(IREE_STATUS_INTERNAL,
+                              "unexpected cache statistics");
+  }
+
+  // The shared module must still resolve its exports.
+  void* query_fn_ptr = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_elf_module_lookup_export(
+        module_b, IREE_HAL_EXECUTABLE_LIBRARY_EXPORT_NAME, &query_fn_ptr);
+  }
+
+  iree_elf_module_cache_release(cache, module_b);
+  iree_elf_module_cache_release(cache, module_a);
+
+  // Once all references are released the module must be unloaded.
+  iree_elf_module_cache_query_statistics(cache, &statistics);
+  if (iree_status_is_ok(status) &&
+      statistics.module_count != base_statistics.module_count) {
+    status = iree_make_status(IREE_STATUS_INTERNAL,
+                              "cached module was not unloaded");
+  }
+  return status;
+}
+
 int main() {
-  const iree_status_t result = run_test();
+  iree_status_t result = run_test();
+  if (iree_status_is_ok(result)) result = run_cache_test();
   int ret = (int)iree_status_code(result);
   if (!iree_status_is_ok(result)) {
     iree_status_fprint(stderr, result);
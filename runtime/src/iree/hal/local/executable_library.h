@@ -40,6 +40,10 @@
 // Defines a bitfield of features that the library requires or supports.
 enum iree_hal_executable_library_feature_bits_t {
   IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_NONE = 0u,
+  // Library includes the iree_hal_executable_library_v0_t::rooflines table.
+  // Libraries without this feature end before the field and it must not be
+  // accessed.
+  IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_ROOFLINE = 1u << 0,
   // TODO(benvanik): declare features for debugging/coverage/printf/etc.
   // These will control which symbols are injected into the library at runtime.
 };
@@ -401,6 +405,18 @@ typedef struct iree_hal_executable_src_loc_v0_t {
   const char* path;
 } iree_hal_executable_src_loc_v0_t;
 
+// Static cost of a dispatch function as computed by the compiler. Counts are
+// totals for a complete dispatch across all workgroups and can be related to
+// measured dispatch times to compute achieved throughput. A value of 0
+// indicates the count is unknown (such as when it depends on dynamic shapes).
+typedef struct iree_hal_executable_roofline_v0_t {
+  // Number of arithmetic operations performed with a fused multiply-add
+  // counting as two.
+  uint64_t flop_count;
+  // Minimum number of bytes read from and written to bindings.
+  uint64_t byte_count;
+} iree_hal_executable_roofline_v0_t;
+
 // A table of exported functions arranged as a struct-of-arrays for more
 // efficient packing and faster lookup. Each subarray - when not omitted and
 // NULL - is indexed by export ordinal and has up to |count| entries.
@@ -462,6 +478,11 @@ typedef struct iree_hal_executable_library_v0_t {
 
   // Table of executable-level constants.
   iree_hal_executable_constant_table_v0_t constants;
+
+  // Optional table of static dispatch costs 1:1 with exports.ptrs.
+  // Only present when the header declares
+  // IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_ROOFLINE and may still be NULL.
+  const iree_hal_executable_roofline_v0_t* rooflines;
 } iree_hal_executable_library_v0_t;
 
 #endif  // IREE_HAL_LOCAL_EXECUTABLE_LIBRARY_H_
@@ -50,6 +50,15 @@ IREE_FLAG(int32_t, workgroup_size_z, 1,
 IREE_FLAG(int32_t, max_concurrency, 1,
           "Maximum available concurrency exposed to the dispatch.");
 
+IREE_FLAG(double, roofline_peak_gflops, 0.0,
+          "Peak compute throughput of the machine in GFLOP/s used to report\n"
+          "the achieved fraction of peak for executables compiled with\n"
+          "--iree-flow-annotate-dispatch-roofline.");
+IREE_FLAG(double, roofline_peak_gbps, 0.0,
+          "Peak memory bandwidth of the machine in GB/s used to report the\n"
+          "achieved fraction of peak for executables compiled with\n"
+          "--iree-flow-annotate-dispatch-roofline.");
+
 // Total number of bindings we (currently) allow any executable to have.
 #define IREE_HAL_LOCAL_MAX_TOTAL_BINDING_COUNT \
   (IREE_HAL_LOCAL_MAX_DESCRIPTOR_SET_COUNT *   \
@@ -131,6 +140,34 @@ IREE_FLAG_CALLBACK(
     "  # 2 4-byte floating-point values with contents [[1.4], [2.1]]:\n"
     "  --binding=2x1xf32=1.4,2.1");
 
+// Reports the achieved throughput of |dispatch_count| dispatches taking
+// |elapsed_ns| in total relative to the static cost in |roofline| and the
+// machine peaks provided by flags.
+static void iree_hal_executable_library_report_roofline(
+    const iree_hal_executable_roofline_v0_t* roofline, int64_t dispatch_count,
+    iree_duration_t elapsed_ns, iree_benchmark_state_t* benchmark_state) {
+  if (dispatch_count <= 0 || elapsed_ns <= 0) return;
+  // Counts per nanosecond are equivalent to billions per second.
+  if (roofline->flop_count > 0) {
+    double gflops =
+        (double)roofline->flop_count * dispatch_count / (double)elapsed_ns;
+    iree_benchmark_set_counter(benchmark_state, "GFLOP/s", gflops);
+    if (FLAG_roofline_peak_gflops > 0.0) {
+      iree_benchmark_set_counter(benchmark_state, "%peak_flops",
+                                 100.0 * gflops / FLAG_roofline_peak_gflops);
+    }
+  }
+  if (roofline->byte_count > 0) {
+    double gbps =
+        (double)roofline->byte_count * dispatch_count / (double)elapsed_ns;
+    iree_benchmark_set_counter(benchmark_state, "GB/s", gbps);
+    if (FLAG_roofline_peak_gbps > 0.0) {
+      iree_benchmark_set_counter(benchmark_state, "%peak_bandwidth",
+                                 100.0 * gbps / FLAG_roofline_peak_gbps);
+    }
+  }
+}
+
 // NOTE: error handling is here just for better diagnostics: it is not tracking
 // allocations correctly and will leak. Don't use this as an example for how to
 // write robust code.
@@ -241,11 +278,13 @@ static iree_status_t iree_hal_executable_library_run(
   // tile processing the same exact region of memory over and over we are not
   // testing cache effects.
   int64_t dispatch_count = 0;
+  iree_time_t start_ns = iree_time_now();
   while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
     IREE_RETURN_IF_ERROR(iree_hal_local_executable_issue_dispatch_inline(
         local_executable, FLAG_entry_point, &dispatch_state, 0, local_memory));
     ++dispatch_count;
   }
+  iree_duration_t elapsed_ns = iree_time_now() - start_ns;
 
   // To get a total time per invocation we set the item count to the total
   // invocations dispatched. That gives us both total dispatch and single
@@ -255,6 +294,15 @@ static iree_status_t iree_hal_executable_library_run(
       dispatch_state.workgroup_count_y * dispatch_state.workgroup_count_z;
   iree_benchmark_set_items_processed(benchmark_state, total_invocations);
 
+  // If the compiler recorded the static cost of the dispatch we can report how
+  // close it gets to the machine peaks. This assumes the workgroup count flags
+  // cover the full dispatch the costs were computed for.
+  if (local_executable->rooflines) {
+    iree_hal_executable_library_report_roofline(
+        &local_executable->rooflines[FLAG_entry_point], dispatch_count,
+        elapsed_ns, benchmark_state);
+  }
+
   // Deallocate buffers.
   for (iree_host_size_t i = 0; i < dispatch_params.binding_count; ++i) {
     iree_hal_buffer_view_release(buffer_views[i]);
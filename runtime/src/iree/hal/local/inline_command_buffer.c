@@ -18,6 +18,7 @@
 #include "iree/hal/local/executable_library.h"
 #include "iree/hal/local/local_executable.h"
 #include "iree/hal/local/local_pipeline_layout.h"
+#include "iree/hal/local/profiling.h"
 
 //===----------------------------------------------------------------------===//
 // iree_hal_inline_command_buffer_t
@@ -28,6 +29,9 @@ typedef struct iree_hal_inline_command_buffer_t {
   iree_hal_command_buffer_t base;
   iree_allocator_t host_allocator;
 
+  // Optional profiling hook of the device dispatches are executed on behalf of.
+  iree_hal_local_profiling_hook_t* profiling_hook;
+
   struct {
     // A flattened list of all available descriptor set bindings.
     // As descriptor sets are pushed/bound the bindings will be updated to
@@ -94,6 +98,7 @@ iree_status_t iree_hal_inline_command_buffer_initialize(
     iree_hal_device_t* device, iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    iree_hal_local_profiling_hook_t* profiling_hook,
     iree_allocator_t host_allocator, iree_byte_span_t storage,
     iree_hal_command_buffer_t** out_command_buffer) {
   IREE_ASSERT_ARGUMENT(out_command_buffer);
@@ -131,6 +136,7 @@ iree_status_t iree_hal_inline_command_buffer_initialize(
       device, mode, command_categories, queue_affinity, binding_capacity,
       &iree_hal_inline_command_buffer_vtable, &command_buffer->base);
   command_buffer->host_allocator = host_allocator;
+  command_buffer->profiling_hook = profiling_hook;
   iree_hal_inline_command_buffer_reset(command_buffer);
 
   *out_command_buffer = &command_buffer->base;
@@ -150,6 +156,7 @@ iree_status_t iree_hal_inline_command_buffer_create(
     iree_hal_device_t* device, iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    iree_hal_local_profiling_hook_t* profiling_hook,
     iree_allocator_t host_allocator,
     iree_hal_command_buffer_t** out_command_buffer) {
   IREE_ASSERT_ARGUMENT(out_command_buffer);
@@ -163,7 +170,7 @@ iree_status_t iree_hal_inline_command_buffer_create(
   if (iree_status_is_ok(status)) {
     status = iree_hal_inline_command_buffer_initialize(
         device, mode, command_categories, queue_affinity, binding_capacity,
-        host_allocator,
+        profiling_hook, host_allocator,
         iree_make_byte_span(storage, iree_hal_inline_command_buffer_size()),
         &command_buffer);
   }
@@ -533,9 +540,20 @@ static iree_status_t iree_hal_inline_command_buffer_dispatch(
   // floating point state. Reset it.
   iree_fpu_state_t fpu_state =
       iree_fpu_state_push(IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
+  // All workgroups run back-to-back on the calling thread so we record them as
+  // a single sample instead of adding overhead to each one. There are no
+  // workers and the thread is borrowed so the processor is used to identify
+  // where the dispatch executed.
+  iree_hal_local_profiling_sample_t profiling_sample;
+  iree_hal_local_profiling_sample_begin(command_buffer->profiling_hook,
+                                        command_buffer->state.processor_id,
+                                        &profiling_sample);
   iree_status_t status = iree_hal_local_executable_issue_dispatch_inline(
       local_executable, entry_point, dispatch_state,
       command_buffer->state.processor_id, local_memory);
+  iree_hal_local_profiling_sample_end(
+      &profiling_sample, local_executable, entry_point,
+      /*workgroup_index=*/0, workgroup_x * workgroup_y * workgroup_z);
   iree_fpu_state_pop(fpu_state);
 
   if (local_memory.data) {
@@ -13,6 +13,7 @@
 #include "iree/base/tracing.h"
 #include "iree/hal/api.h"
 #include "iree/hal/local/elf/elf_module.h"
+#include "iree/hal/local/elf/elf_module_cache.h"
 #include "iree/hal/local/executable_library.h"
 #include "iree/hal/local/executable_library_util.h"
 #include "iree/hal/local/executable_plugin_manager.h"
@@ -25,8 +26,11 @@
 typedef struct iree_hal_elf_executable_t {
   iree_hal_local_executable_t base;
 
-  // Loaded ELF module.
-  iree_elf_module_t module;
+  // Loaded ELF module. Either points at |owned_module| or a module shared
+  // with other executables via the process-wide module cache.
+  iree_elf_module_t* module;
+  iree_elf_module_cache_t* module_cache;
+  iree_elf_module_t owned_module;
 
   // Name used for the file field in tracy and debuggers.
   iree_string_view_t identifier;
@@ -47,7 +51,7 @@ static iree_status_t iree_hal_elf_executable_query_library(
   // Get the exported symbol used to get the library metadata.
   iree_hal_executable_library_query_fn_t query_fn = NULL;
   IREE_RETURN_IF_ERROR(iree_elf_module_lookup_export(
-      &executable->module, IREE_HAL_EXECUTABLE_LIBRARY_EXPORT_NAME,
+      executable->module, IREE_HAL_EXECUTABLE_LIBRARY_EXPORT_NAME,
       (void**)&query_fn));
 
   // Query for a compatible version of the library.
@@ -82,6 +86,11 @@ static iree_status_t iree_hal_elf_executable_query_library(
 
   executable->identifier = iree_make_cstring_view(header->name);
   executable->base.dispatch_attrs = executable->library.v0->exports.attrs;
+  executable->base.export_names = executable->library.v0->exports.names;
+  if (iree_all_bits_set(header->features,
+                        IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_ROOFLINE)) {
+    executable->base.rooflines = executable->library.v0->rooflines;
+  }
   return iree_ok_status();
 }
 
@@ -130,11 +139,27 @@ static iree_status_t iree_hal_elf_executable_create(
     executable->base.environment.constants = target_constants;
   }
 
-  // Attempt to load the ELF module.
+  // Attempt to load the ELF module. When persistent caching is allowed we
+  // share the loaded image with any other executable in the process created
+  // from the same ELF data so that relocation and page protection only happen
+  // once regardless of how many devices or contexts load it.
   if (iree_status_is_ok(status)) {
-    status = iree_elf_module_initialize_from_memory(
-        executable_params->executable_data, /*import_table=*/NULL,
-        host_allocator, &executable->module);
+    if (iree_all_bits_set(
+            executable_params->caching_mode,
+            IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_PERSISTENT_CACHING)) {
+      iree_elf_module_cache_t* module_cache = iree_elf_module_cache_default();
+      status = iree_elf_module_cache_acquire(
+          module_cache, executable_params->executable_data,
+          &executable->module);
+      if (iree_status_is_ok(status)) executable->module_cache = module_cache;
+    } else {
+      status = iree_elf_module_initialize_from_memory(
+          executable_params->executable_data, /*import_table=*/NULL,
+          host_allocator, &executable->owned_module);
+      if (iree_status_is_ok(status)) {
+        executable->module = &executable->owned_module;
+      }
+    }
   }
 
   // Query metadata and get the entry point function pointers.
@@ -173,7 +198,12 @@ static void iree_hal_elf_executable_destroy(
   iree_allocator_t host_allocator = executable->base.host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  iree_elf_module_deinitialize(&executable->module);
+  if (executable->module_cache) {
+    iree_elf_module_cache_release(executable->module_cache,
+                                  executable->module);
+  } else if (executable->module) {
+    iree_elf_module_deinitialize(executable->module);
+  }
 
   iree_hal_executable_library_deinitialize_imports(
       &executable->base.environment, host_allocator);
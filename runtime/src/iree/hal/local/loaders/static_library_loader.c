@@ -75,6 +75,11 @@ static iree_status_t iree_hal_static_executable_create(
     executable->library.header = library_header;
     executable->identifier = iree_make_cstring_view((*library_header)->name);
     executable->base.dispatch_attrs = executable->library.v0->exports.attrs;
+    executable->base.export_names = executable->library.v0->exports.names;
+    if (iree_all_bits_set((*library_header)->features,
+                          IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_ROOFLINE)) {
+      executable->base.rooflines = executable->library.v0->rooflines;
+    }
   }
 
   // Copy executable constants so we own them.
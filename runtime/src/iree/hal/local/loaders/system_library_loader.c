@@ -202,6 +202,11 @@ static iree_status_t iree_hal_system_executable_query_library(
 
   executable->identifier = iree_make_cstring_view(header->name);
   executable->base.dispatch_attrs = executable->library.v0->exports.attrs;
+  executable->base.export_names = executable->library.v0->exports.names;
+  if (iree_all_bits_set(header->features,
+                        IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_ROOFLINE)) {
+    executable->base.rooflines = executable->library.v0->rooflines;
+  }
   return iree_ok_status();
 }
 
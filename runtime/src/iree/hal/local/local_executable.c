@@ -28,6 +28,8 @@ void iree_hal_local_executable_initialize(
 
   // Function attributes are optional and populated by the parent type.
   out_base_executable->dispatch_attrs = NULL;
+  out_base_executable->rooflines = NULL;
+  out_base_executable->export_names = NULL;
 
   // Default environment with no imports assigned.
   iree_hal_executable_environment_initialize(host_allocator,
@@ -35,6 +35,15 @@ typedef struct iree_hal_local_executable_t {
   // of memory required by the function.
   const iree_hal_executable_dispatch_attrs_v0_t* dispatch_attrs;
 
+  // Optional per-entry point static costs used for roofline reporting.
+  // May be NULL if the executable was compiled without them.
+  const iree_hal_executable_roofline_v0_t* rooflines;
+
+  // Optional per-entry point names used for diagnostics and profiling.
+  // May be NULL if the executable format does not carry names or any entry may
+  // be NULL if the particular entry point is unnamed.
+  const char* const* export_names;
+
   // Execution environment.
   iree_hal_executable_environment_v0_t environment;
 } iree_hal_local_executable_t;
@@ -19,9 +19,11 @@ extern "C" {
 // more specialized; like nop_executable_cache (does nothing but pass through)
 // or inproc_lru_executable_cache (simple in-memory LRU of recent executables).
 //
-// We can also set this up so they share storage. Ideally a JIT'ed executable in
-// one device is the same JIT'ed executable in another, and in multi-tenant
-// situations we're likely to want that isolation _and_ sharing.
+// Loaders may share storage across caches: the embedded ELF loader shares
+// loaded images process-wide (see iree/hal/local/elf/elf_module_cache.h) for
+// any executable prepared with
+// IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_PERSISTENT_CACHING such that the same
+// executable loaded in multiple devices or contexts is only relocated once.
 
 iree_status_t iree_hal_local_executable_cache_create(
     iree_string_view_t identifier, iree_host_size_t worker_capacity,
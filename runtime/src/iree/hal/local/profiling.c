@@ -0,0 +1,658 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// NOTE: must be first before _any_ system includes.
+#define _GNU_SOURCE
+
+#include "iree/hal/local/profiling.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/local/dispatch_timeline.h"
+
+#if defined(IREE_PLATFORM_LINUX) || defined(IREE_PLATFORM_ANDROID)
+#define IREE_HAL_LOCAL_PROFILING_HAVE_PERF_EVENT 1
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#define IREE_HAL_LOCAL_PROFILING_HAVE_PERF_EVENT 0
+#endif  // IREE_PLATFORM_LINUX || IREE_PLATFORM_ANDROID
+
+// Maximum number of unique executable exports tracked per worker. Must be a
+// power of two. Dispatches beyond this are dropped from the profile.
+#define IREE_HAL_LOCAL_PROFILING_MAX_DISPATCHES 256
+
+static const char* iree_hal_local_profiling_counter_names
+    [IREE_HAL_LOCAL_PROFILING_COUNTER_COUNT] = {
+        "cycles",
+        "instructions",
+        "cache-references",
+        "cache-misses",
+};
+
+// Accumulated measurements for a single executable export.
+typedef struct iree_hal_local_profiling_entry_t {
+  // Executable retained for the duration of the profile or NULL if unused.
+  iree_hal_local_executable_t* executable;
+  uint32_t ordinal;
+  uint64_t workgroup_count;
+  iree_time_t total_time_ns;
+  uint64_t counters[IREE_HAL_LOCAL_PROFILING_COUNTER_COUNT];
+} iree_hal_local_profiling_entry_t;
+
+// Per-worker state. Only ever touched by the worker owning it until the
+// profile ends and the device is idle.
+typedef struct iree_hal_local_profiling_worker_t {
+  // True once the worker has attempted to open its counters.
+  bool initialized;
+  // True if all counters in |fds| were opened successfully.
+  bool counters_available;
+  // perf_event file descriptors with |fds[0]| as the group leader.
+  int fds[IREE_HAL_LOCAL_PROFILING_COUNTER_COUNT];
+  // Workgroups that could not be recorded due to table exhaustion.
+  uint64_t dropped_count;
+  // Open-addressed table keyed on executable and export ordinal.
+  iree_hal_local_profiling_entry_t
+      entries[IREE_HAL_LOCAL_PROFILING_MAX_DISPATCHES];
+} iree_hal_local_profiling_worker_t;
+
+struct iree_hal_local_profiler_t {
+  iree_allocator_t host_allocator;
+  // Optional path the report is written to; stderr if empty.
+  iree_string_view_t file_path;
+  // Workgroups executed by workers outside of the worker table. Only possible
+  // if a hook was attached with a worker range beyond |worker_count|.
+  iree_atomic_int64_t unknown_worker_count;
+  iree_host_size_t worker_count;
+  // Per-worker counter tables or NULL if dispatch counters were not requested.
+  iree_hal_local_profiling_worker_t* workers;
+  // Timeline recording all samples or NULL if not requested.
+  iree_hal_local_dispatch_timeline_t* timeline;
+  // + trailing workers[worker_count] storage
+  // + trailing file_path storage
+};
+
+// In-flight sample count of a single worker. Padded so that the counts of
+// different workers never share a cache line.
+typedef struct iree_hal_local_profiling_hook_slot_t {
+  iree_atomic_int32_t in_flight;
+  uint8_t reserved[iree_hardware_destructive_interference_size -
+                   sizeof(iree_atomic_int32_t)];
+} iree_hal_local_profiling_hook_slot_t;
+
+// Per-worker in-flight sample counts of a hook.
+typedef struct iree_hal_local_profiling_hook_slots_t {
+  iree_host_size_t count;
+  iree_hal_local_profiling_hook_slot_t slots[];
+} iree_hal_local_profiling_hook_slots_t;
+
+//===----------------------------------------------------------------------===//
+// Hardware counters
+//===----------------------------------------------------------------------===//
+
+#if IREE_HAL_LOCAL_PROFILING_HAVE_PERF_EVENT
+
+static const uint64_t iree_hal_local_profiling_perf_configs
+    [IREE_HAL_LOCAL_PROFILING_COUNTER_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_REFERENCES,
+        PERF_COUNT_HW_CACHE_MISSES,
+};
+
+// Opens the counter group for the calling thread. Failures are not fatal and
+// leave the worker measuring only time.
+static void iree_hal_local_profiling_worker_open_counters(
+    iree_hal_local_profiling_worker_t* worker) {
+  for (int i = 0; i < IREE_HAL_LOCAL_PROFILING_COUNTER_COUNT; ++i) {
+    worker->fds[i] = -1;
+  }
+  for (int i = 0; i < IREE_HAL_LOCAL_PROFILING_COUNTER_COUNT; ++i) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = iree_hal_local_profiling_perf_configs[i];
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.disabled = i == 0 ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    int fd = (int)syscall(SYS_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1,
+                          /*group_fd=*/i == 0 ? -1 : worker->fds[0],
+                          /*flags=*/0);
+    if (fd < 0) {
+      for (int j = 0; j < i; ++j) close(worker->fds[j]);
+      for (int j = 0; j < i; ++j) worker->fds[j] = -1;
+      return;
+    }
+    worker->fds[i] = fd;
+  }
+  ioctl(worker->fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(worker->fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  worker->counters_available = true;
+}
+
+static void iree_hal_local_profiling_worker_close_counters(
+    iree_hal_local_profiling_worker_t* worker) {
+  if (!worker->counters_available) return;
+  for (int i = 0; i < IREE_HAL_LOCAL_PROFILING_COUNTER_COUNT; ++i) {
+    close(worker->fds[i]);
+    worker->fds[i] = -1;
+  }
+  worker->counters_available = false;
+}
+
+static bool iree_hal_local_profiling_worker_read_counters(
+    iree_hal_local_profiling_worker_t* worker,
+    uint64_t out_counters[IREE_HAL_LOCAL_PROFILING_COUNTER_COUNT]) {
+  // PERF_FORMAT_GROUP layout: { u64 nr; u64 values[nr]; }
+  uint64_t buffer[1 + IREE_HAL_LOCAL_PROFILING_COUNTER_COUNT];
+  ssize_t read_length = read(worker->fds[0], buffer, sizeof(buffer));
+  if (read_length != (ssize_t)sizeof(buffer)) return false;
+  memcpy(out_counters, &buffer[1],
+         IREE_HAL_LOCAL_PROFILING_COUNTER_COUNT * sizeof(uint64_t));
+  return true;
+}
+
+#else
+
+static void iree_hal_local_profiling_worker_open_counters(
+    iree_hal_local_profiling_worker_t* worker) {}
+
+static void iree_hal_local_profiling_worker_close_counters(
+    iree_hal_local_profiling_worker_t* worker) {}
+
+static bool iree_hal_local_profiling_worker_read_counters(
+    iree_hal_local_profiling_worker_t* worker,
+    uint64_t out_counters[IREE_HAL_LOCAL_PROFILING_COUNTER_COUNT]) {
+  return false;
+}
+
+#endif  // IREE_HAL_LOCAL_PROFILING_HAVE_PERF_EVENT
+
+//===----------------------------------------------------------------------===//
+// Dispatch instrumentation
+//===----------------------------------------------------------------------===//
+
+// Returns the in-flight sample count of |worker_id| in |hook|.
+static iree_atomic_int32_t* iree_hal_local_profiling_hook_in_flight(
+    iree_hal_local_profiling_hook_t* hook, uint32_t worker_id) {
+  iree_hal_local_profiling_hook_slots_t* slots =
+      (iree_hal_local_profiling_hook_slots_t*)iree_atomic_load_intptr(
+          &hook->slots, iree_memory_order_acquire);
+  if (IREE_LIKELY(slots && worker_id < slots->count)) {
+    return &slots->slots[worker_id].in_flight;
+  }
+  return &hook->sample_count;
+}
+
+void iree_hal_local_profiling_sample_begin(
+    iree_hal_local_profiling_hook_t* hook, uint32_t worker_id,
+    iree_hal_local_profiling_sample_t* out_sample) {
+  out_sample->hook = NULL;
+  if (IREE_LIKELY(!hook || !iree_atomic_load_intptr(
+                               &hook->profiler, iree_memory_order_relaxed))) {
+    return;
+  }
+
+  // Register the sample before reading the profiler we'll use so that a
+  // concurrent detach either waits for us or we observe it and bail. Both
+  // sides use sequentially consistent operations for this to hold. Workers
+  // only modify their own slot so this does not contend with other workers.
+  iree_atomic_int32_t* in_flight =
+      iree_hal_local_profiling_hook_in_flight(hook, worker_id);
+  iree_atomic_fetch_add_int32(in_flight, 1, iree_memory_order_seq_cst);
+  iree_hal_local_profiler_t* profiler =
+      (iree_hal_local_profiler_t*)iree_atomic_load_intptr(
+          &hook->profiler, iree_memory_order_seq_cst);
+  if (IREE_UNLIKELY(!profiler)) {
+    iree_atomic_fetch_sub_int32(in_flight, 1, iree_memory_order_release);
+    return;
+  }
+  const uint32_t worker_index = hook->worker_base + worker_id;
+  iree_hal_local_profiling_worker_t* worker = NULL;
+  if (profiler->workers) {
+    if (IREE_LIKELY(worker_index < profiler->worker_count)) {
+      worker = &profiler->workers[worker_index];
+    } else {
+      iree_atomic_fetch_add_int64(&profiler->unknown_worker_count, 1,
+                                  iree_memory_order_relaxed);
+    }
+  }
+  if (IREE_UNLIKELY(!worker && !profiler->timeline)) {
+    iree_atomic_fetch_sub_int32(in_flight, 1, iree_memory_order_release);
+    return;
+  }
+  out_sample->hook = hook;
+  out_sample->in_flight = in_flight;
+  out_sample->profiler = profiler;
+  out_sample->worker_index = worker_index;
+
+  memset(out_sample->counters, 0, sizeof(out_sample->counters));
+  if (worker) {
+    if (IREE_UNLIKELY(!worker->initialized)) {
+      worker->initialized = true;
+      iree_hal_local_profiling_worker_open_counters(worker);
+    }
+    if (worker->counters_available) {
+      iree_hal_local_profiling_worker_read_counters(worker,
+                                                    out_sample->counters);
+    }
+  }
+  out_sample->start_time_ns = iree_time_now();
+}
+
+static iree_hal_local_profiling_entry_t* iree_hal_local_profiling_lookup_entry(
+    iree_hal_local_profiling_worker_t* worker,
+    iree_hal_local_executable_t* executable, uint32_t ordinal) {
+  uintptr_t hash = ((uintptr_t)executable >> 4) * 31 + ordinal;
+  for (iree_host_size_t i = 0; i < IREE_HAL_LOCAL_PROFILING_MAX_DISPATCHES;
+       ++i) {
+    iree_hal_local_profiling_entry_t* entry =
+        &worker->entries[(hash + i) &
+                         (IREE_HAL_LOCAL_PROFILING_MAX_DISPATCHES - 1)];
+    if (entry->executable == executable && entry->ordinal == ordinal) {
+      return entry;
+    } else if (!entry->executable) {
+      // Retain so that the export name is available when reporting even if
+      // the executable is released before the profile ends.
+      iree_hal_executable_retain((iree_hal_executable_t*)executable);
+      entry->executable = executable;
+      entry->ordinal = ordinal;
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+void iree_hal_local_profiling_sample_end(
+    const iree_hal_local_profiling_sample_t* sample,
+    iree_hal_local_executable_t* executable, uint32_t ordinal,
+    uint32_t workgroup_index, uint32_t workgroup_count) {
+  if (IREE_LIKELY(!sample->hook)) return;
+  iree_time_t end_time_ns = iree_time_now();
+  iree_hal_local_profiler_t* profiler = sample->profiler;
+
+  if (profiler->timeline) {
+    iree_hal_local_dispatch_timeline_record(
+        profiler->timeline, sample->worker_index, executable, ordinal,
+        workgroup_index, workgroup_count, sample->start_time_ns, end_time_ns);
+  }
+
+  if (profiler->workers && sample->worker_index < profiler->worker_count) {
+    iree_hal_local_profiling_worker_t* worker =
+        &profiler->workers[sample->worker_index];
+    uint64_t counters[IREE_HAL_LOCAL_PROFILING_COUNTER_COUNT] = {0};
+    if (worker->counters_available) {
+      iree_hal_local_profiling_worker_read_counters(worker, counters);
+    }
+    iree_hal_local_profiling_entry_t* entry =
+        iree_hal_local_profiling_lookup_entry(worker, executable, ordinal);
+    if (IREE_LIKELY(entry)) {
+      entry->workgroup_count += workgroup_count;
+      entry->total_time_ns += end_time_ns - sample->start_time_ns;
+      for (int i = 0; i < IREE_HAL_LOCAL_PROFILING_COUNTER_COUNT; ++i) {
+        entry->counters[i] += counters[i] - sample->counters[i];
+      }
+    } else {
+      worker->dropped_count += workgroup_count;
+    }
+  }
+
+  // The profiler must not be touched after this as it may be ended.
+  iree_atomic_fetch_sub_int32(sample->in_flight, 1, iree_memory_order_release);
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_local_profiling_hook_t
+//===----------------------------------------------------------------------===//
+
+void iree_hal_local_profiling_hook_initialize(
+    iree_allocator_t host_allocator,
+    iree_hal_local_profiling_hook_t* out_hook) {
+  iree_atomic_store_intptr(&out_hook->profiler, 0, iree_memory_order_relaxed);
+  iree_atomic_store_intptr(&out_hook->slots, 0, iree_memory_order_relaxed);
+  iree_atomic_store_int32(&out_hook->sample_count, 0,
+                          iree_memory_order_relaxed);
+  out_hook->worker_base = 0;
+  out_hook->host_allocator = host_allocator;
+}
+
+void iree_hal_local_profiling_hook_deinitialize(
+    iree_hal_local_profiling_hook_t* hook) {
+  iree_hal_local_profiling_hook_detach(hook);
+  void* slots = (void*)iree_atomic_load_intptr(&hook->slots,
+                                               iree_memory_order_acquire);
+  iree_atomic_store_intptr(&hook->slots, 0, iree_memory_order_relaxed);
+  iree_allocator_free(hook->host_allocator, slots);
+}
+
+// Ensures |hook| has an in-flight slot for each of |worker_count| workers.
+// Slots are never reallocated once published as workers may hold them; if
+// allocation fails (or more workers are needed) workers without a slot share
+// the hook counter.
+static void iree_hal_local_profiling_hook_reserve_slots(
+    iree_hal_local_profiling_hook_t* hook, iree_host_size_t worker_count) {
+  if (!worker_count ||
+      iree_atomic_load_intptr(&hook->slots, iree_memory_order_relaxed)) {
+    return;
+  }
+  iree_hal_local_profiling_hook_slots_t* slots = NULL;
+  const iree_host_size_t total_size =
+      sizeof(*slots) + worker_count * sizeof(slots->slots[0]);
+  if (!iree_status_is_ok(iree_allocator_malloc(hook->host_allocator,
+                                               total_size, (void**)&slots))) {
+    return;
+  }
+  memset(slots, 0, total_size);
+  slots->count = worker_count;
+  iree_atomic_store_intptr(&hook->slots, (intptr_t)slots,
+                           iree_memory_order_release);
+}
+
+void iree_hal_local_profiling_hook_attach(iree_hal_local_profiling_hook_t* hook,
+                                          iree_hal_local_profiler_t* profiler,
+                                          iree_host_size_t worker_base,
+                                          iree_host_size_t worker_count) {
+  iree_hal_local_profiling_hook_reserve_slots(hook, worker_count);
+  hook->worker_base = (uint32_t)worker_base;
+  iree_atomic_store_intptr(&hook->profiler, (intptr_t)profiler,
+                           iree_memory_order_seq_cst);
+}
+
+// Polls until |in_flight| reaches zero. Workgroups are short so this rarely
+// waits.
+static void iree_hal_local_profiling_drain(iree_atomic_int32_t* in_flight) {
+  while (iree_atomic_load_int32(in_flight, iree_memory_order_seq_cst) != 0) {
+    iree_wait_until(iree_time_now() + 10 * 1000);
+  }
+}
+
+void iree_hal_local_profiling_hook_detach(
+    iree_hal_local_profiling_hook_t* hook) {
+  if (!iree_atomic_load_intptr(&hook->profiler, iree_memory_order_relaxed)) {
+    return;
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_atomic_store_intptr(&hook->profiler, 0, iree_memory_order_seq_cst);
+  // Wait for any samples that observed the profiler before it was detached to
+  // end; new samples observe the detach and bail.
+  iree_hal_local_profiling_hook_slots_t* slots =
+      (iree_hal_local_profiling_hook_slots_t*)iree_atomic_load_intptr(
+          &hook->slots, iree_memory_order_acquire);
+  for (iree_host_size_t i = 0; slots && i < slots->count; ++i) {
+    iree_hal_local_profiling_drain(&slots->slots[i].in_flight);
+  }
+  iree_hal_local_profiling_drain(&hook->sample_count);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_local_profiler_t
+//===----------------------------------------------------------------------===//
+
+iree_status_t iree_hal_local_profiler_begin(
+    const iree_hal_device_profiling_options_t* options,
+    iree_host_size_t worker_count, iree_allocator_t host_allocator,
+    iree_hal_local_profiler_t** out_profiler) {
+  IREE_ASSERT_ARGUMENT(options);
+  IREE_ASSERT_ARGUMENT(out_profiler);
+  *out_profiler = NULL;
+  const bool counters_requested = iree_all_bits_set(
+      options->mode, IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_COUNTERS);
+  const bool timeline_requested = iree_all_bits_set(
+      options->mode, IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_TIMELINE);
+  if (!counters_requested && !timeline_requested) return iree_ok_status();
+  if (counters_requested && timeline_requested) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "dispatch counters and timelines cannot be "
+                            "captured in the same profile");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_string_view_t file_path = iree_make_cstring_view(options->file_path);
+  iree_hal_local_profiler_t* profiler = NULL;
+  const iree_host_size_t workers_size =
+      counters_requested ? worker_count * sizeof(*profiler->workers) : 0;
+  const iree_host_size_t total_size =
+      sizeof(*profiler) + workers_size + file_path.size + 1;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, total_size, (void**)&profiler));
+  memset(profiler, 0, total_size);
+  profiler->host_allocator = host_allocator;
+  profiler->worker_count = worker_count;
+  if (counters_requested) {
+    profiler->workers =
+        (iree_hal_local_profiling_worker_t*)((uint8_t*)profiler +
+                                             sizeof(*profiler));
+  }
+  char* file_path_ptr = (char*)profiler + sizeof(*profiler) + workers_size;
+  memcpy(file_path_ptr, file_path.data, file_path.size);
+  file_path_ptr[file_path.size] = 0;
+  profiler->file_path = iree_make_string_view(file_path_ptr, file_path.size);
+
+  iree_status_t status = iree_hal_local_dispatch_timeline_begin(
+      options, worker_count, host_allocator, &profiler->timeline);
+  if (!iree_status_is_ok(status)) {
+    iree_allocator_free(host_allocator, profiler);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  *out_profiler = profiler;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+// Aggregated measurements across all workers for a single export.
+typedef struct iree_hal_local_profiling_report_row_t {
+  iree_hal_local_executable_t* executable;
+  uint32_t ordinal;
+  uint64_t workgroup_count;
+  iree_time_t total_time_ns;
+  uint64_t counters[IREE_HAL_LOCAL_PROFILING_COUNTER_COUNT];
+} iree_hal_local_profiling_report_row_t;
+
+static int iree_hal_local_profiling_report_row_compare(const void* lhs,
+                                                       const void* rhs) {
+  iree_time_t lhs_time =
+      ((const iree_hal_local_profiling_report_row_t*)lhs)->total_time_ns;
+  iree_time_t rhs_time =
+      ((const iree_hal_local_profiling_report_row_t*)rhs)->total_time_ns;
+  return lhs_time < rhs_time ? 1 : (lhs_time > rhs_time ? -1 : 0);
+}
+
+static void iree_hal_local_profiling_print_report(
+    iree_hal_local_profiler_t* profiler, bool counters_available,
+    uint64_t dropped_count, iree_hal_local_profiling_report_row_t* rows,
+    iree_host_size_t row_count, FILE* file) {
+  const int64_t unknown_worker_count = iree_atomic_load_int64(
+      &profiler->unknown_worker_count, iree_memory_order_relaxed);
+  fprintf(file, "; IREE local HAL dispatch profile\n");
+  if (!counters_available) {
+    fprintf(file,
+            "; hardware counters unavailable; check perf_event_paranoid\n");
+  }
+  if (dropped_count) {
+    fprintf(file, "; %" PRIu64 " workgroups dropped (too many dispatches)\n",
+            dropped_count);
+  }
+  if (unknown_worker_count) {
+    fprintf(file,
+            "; %" PRId64 " workgroups dropped (executed by unknown workers)\n",
+            unknown_worker_count);
+  }
+  fprintf(file, "\"Export\",\"Workgroups\",\"Total Time (us)\"");
+  for (int i = 0; i < IREE_HAL_LOCAL_PROFILING_COUNTER_COUNT; ++i) {
+    fprintf(file, ",\"%s\"", iree_hal_local_profiling_counter_names[i]);
+  }
+  fprintf(file, ",\"IPC\",\"Cache Miss Rate\"\n");
+  for (iree_host_size_t i = 0; i < row_count; ++i) {
+    const iree_hal_local_profiling_report_row_t* row = &rows[i];
+    const char* export_name = row->executable->export_names
+                                  ? row->executable->export_names[row->ordinal]
+                                  : NULL;
+    if (export_name) {
+      fprintf(file, "\"%s\"", export_name);
+    } else {
+      fprintf(file, "\"%p:%u\"", (void*)row->executable, row->ordinal);
+    }
+    fprintf(file, ",%" PRIu64 ",%.3f", row->workgroup_count,
+            row->total_time_ns / 1000.0);
+    for (int j = 0; j < IREE_HAL_LOCAL_PROFILING_COUNTER_COUNT; ++j) {
+      fprintf(file, ",%" PRIu64, row->counters[j]);
+    }
+    const uint64_t cycles =
+        row->counters[IREE_HAL_LOCAL_PROFILING_COUNTER_CYCLES];
+    const uint64_t cache_references =
+        row->counters[IREE_HAL_LOCAL_PROFILING_COUNTER_CACHE_REFERENCES];
+    fprintf(file, ",%.3f,%.3f\n",
+            cycles ? (double)row->counters
+                             [IREE_HAL_LOCAL_PROFILING_COUNTER_INSTRUCTIONS] /
+                         cycles
+                   : 0.0,
+            cache_references
+                ? (double)row->counters
+                          [IREE_HAL_LOCAL_PROFILING_COUNTER_CACHE_MISSES] /
+                      cache_references
+                : 0.0);
+  }
+}
+
+static void iree_hal_local_profiling_emit_report(
+    iree_hal_local_profiler_t* profiler, bool counters_available,
+    uint64_t dropped_count, iree_hal_local_profiling_report_row_t* rows,
+    iree_host_size_t row_count) {
+  qsort(rows, row_count, sizeof(*rows),
+        iree_hal_local_profiling_report_row_compare);
+
+  FILE* file = stderr;
+#if IREE_FILE_IO_ENABLE
+  if (!iree_string_view_is_empty(profiler->file_path)) {
+    file = fopen(profiler->file_path.data, "w");
+    if (!file) {
+      fprintf(stderr, "failed to open dispatch profile output file '%s'\n",
+              profiler->file_path.data);
+      file = stderr;
+    }
+  }
+#endif  // IREE_FILE_IO_ENABLE
+  iree_hal_local_profiling_print_report(profiler, counters_available,
+                                        dropped_count, rows, row_count, file);
+  if (file != stderr) fclose(file);
+
+  // Totals across the profile; Tracy plot names must be literals so these are
+  // aggregated instead of per-dispatch.
+  IREE_TRACE({
+    uint64_t total_counters[IREE_HAL_LOCAL_PROFILING_COUNTER_COUNT] = {0};
+    for (iree_host_size_t i = 0; i < row_count; ++i) {
+      for (int j = 0; j < IREE_HAL_LOCAL_PROFILING_COUNTER_COUNT; ++j) {
+        total_counters[j] += rows[i].counters[j];
+      }
+    }
+    IREE_TRACE_PLOT_VALUE_I64(
+        "hal-local-profile-cycles",
+        (int64_t)total_counters[IREE_HAL_LOCAL_PROFILING_COUNTER_CYCLES]);
+    IREE_TRACE_PLOT_VALUE_I64(
+        "hal-local-profile-instructions",
+        (int64_t)total_counters[IREE_HAL_LOCAL_PROFILING_COUNTER_INSTRUCTIONS]);
+    IREE_TRACE_PLOT_VALUE_I64(
+        "hal-local-profile-cache-misses",
+        (int64_t)total_counters[IREE_HAL_LOCAL_PROFILING_COUNTER_CACHE_MISSES]);
+  });
+}
+
+// Merges all worker counter tables into one row per export and emits the
+// report. Releases all executables retained by the tables.
+static iree_status_t iree_hal_local_profiler_report_counters(
+    iree_hal_local_profiler_t* profiler) {
+  // Merge all worker tables into one row per export.
+  iree_host_size_t max_row_count = 0;
+  for (iree_host_size_t i = 0; i < profiler->worker_count; ++i) {
+    for (iree_host_size_t j = 0; j < IREE_HAL_LOCAL_PROFILING_MAX_DISPATCHES;
+         ++j) {
+      if (profiler->workers[i].entries[j].executable) ++max_row_count;
+    }
+  }
+  iree_hal_local_profiling_report_row_t* rows = NULL;
+  iree_status_t status = iree_ok_status();
+  if (max_row_count > 0) {
+    status = iree_allocator_malloc(profiler->host_allocator,
+                                   max_row_count * sizeof(*rows),
+                                   (void**)&rows);
+  }
+  iree_host_size_t row_count = 0;
+  bool counters_available = false;
+  uint64_t dropped_count = 0;
+  for (iree_host_size_t i = 0; i < profiler->worker_count; ++i) {
+    iree_hal_local_profiling_worker_t* worker = &profiler->workers[i];
+    counters_available |= worker->counters_available;
+    dropped_count += worker->dropped_count;
+    for (iree_host_size_t j = 0; j < IREE_HAL_LOCAL_PROFILING_MAX_DISPATCHES;
+         ++j) {
+      iree_hal_local_profiling_entry_t* entry = &worker->entries[j];
+      if (!entry->executable) continue;
+      if (rows) {
+        iree_hal_local_profiling_report_row_t* row = NULL;
+        for (iree_host_size_t k = 0; k < row_count; ++k) {
+          if (rows[k].executable == entry->executable &&
+              rows[k].ordinal == entry->ordinal) {
+            row = &rows[k];
+            break;
+          }
+        }
+        if (!row) {
+          row = &rows[row_count++];
+          memset(row, 0, sizeof(*row));
+          row->executable = entry->executable;
+          row->ordinal = entry->ordinal;
+          iree_hal_executable_retain((iree_hal_executable_t*)row->executable);
+        }
+        row->workgroup_count += entry->workgroup_count;
+        row->total_time_ns += entry->total_time_ns;
+        for (int k = 0; k < IREE_HAL_LOCAL_PROFILING_COUNTER_COUNT; ++k) {
+          row->counters[k] += entry->counters[k];
+        }
+      }
+      iree_hal_executable_release((iree_hal_executable_t*)entry->executable);
+    }
+    iree_hal_local_profiling_worker_close_counters(worker);
+  }
+
+  if (iree_status_is_ok(status)) {
+    iree_hal_local_profiling_emit_report(profiler, counters_available,
+                                         dropped_count, rows, row_count);
+  }
+  for (iree_host_size_t i = 0; i < row_count; ++i) {
+    iree_hal_executable_release((iree_hal_executable_t*)rows[i].executable);
+  }
+  iree_allocator_free(profiler->host_allocator, rows);
+  return status;
+}
+
+iree_status_t iree_hal_local_profiler_end(iree_hal_local_profiler_t* profiler) {
+  if (!profiler) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_status_t status = iree_ok_status();
+  if (profiler->workers) {
+    status = iree_hal_local_profiler_report_counters(profiler);
+  }
+  status = iree_status_join(
+      status, iree_hal_local_dispatch_timeline_end(profiler->timeline));
+  iree_allocator_free(profiler->host_allocator, profiler);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
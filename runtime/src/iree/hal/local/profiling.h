@@ -0,0 +1,165 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_LOCAL_PROFILING_H_
+#define IREE_HAL_LOCAL_PROFILING_H_
+
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/hal/api.h"
+#include "iree/hal/local/local_executable.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_hal_local_profiler_t
+//===----------------------------------------------------------------------===//
+
+// Hardware counters captured per dispatch when available.
+typedef enum iree_hal_local_profiling_counter_e {
+  IREE_HAL_LOCAL_PROFILING_COUNTER_CYCLES = 0,
+  IREE_HAL_LOCAL_PROFILING_COUNTER_INSTRUCTIONS,
+  IREE_HAL_LOCAL_PROFILING_COUNTER_CACHE_REFERENCES,
+  IREE_HAL_LOCAL_PROFILING_COUNTER_CACHE_MISSES,
+  IREE_HAL_LOCAL_PROFILING_COUNTER_COUNT,
+} iree_hal_local_profiling_counter_t;
+
+// Dispatch profiler shared by local HAL devices.
+//
+// When IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_COUNTERS is requested each
+// worker lazily opens a group of hardware performance counters for itself on
+// the first workgroup it executes (via perf_event_open on Linux/Android) and
+// every workgroup is measured and attributed to its executable export. On
+// platforms or systems where counters are unavailable (unsupported OS,
+// restrictive perf_event_paranoid, containers, etc) only invocation counts and
+// wall time are captured. When the profile ends a per-dispatch report is
+// written to the file path provided in the profiling options (or stderr) and
+// the totals are plotted in Tracy when tracing is enabled.
+//
+// When IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_TIMELINE is requested the same
+// samples are also recorded into an iree_hal_local_dispatch_timeline_t that is
+// written to the file path provided in the profiling options when the profile
+// ends. Counters and timelines cannot both be requested as they would be
+// written to the same file.
+//
+// Profilers are owned by a device and attached to the hooks of each executor
+// the device submits work to. Multiple devices may profile concurrently.
+typedef struct iree_hal_local_profiler_t iree_hal_local_profiler_t;
+
+// Begins a profiling session with the given |options| for |worker_count|
+// workers across all hooks the profiler will be attached to. Returns NULL in
+// |out_profiler| if |options| does not request any mode the profiler supports.
+//
+// Hardware counters are tracked per worker and require that each worker in
+// the table executes on a single thread at a time. Hooks shared by arbitrary
+// threads must only request dispatch timelines.
+iree_status_t iree_hal_local_profiler_begin(
+    const iree_hal_device_profiling_options_t* options,
+    iree_host_size_t worker_count, iree_allocator_t host_allocator,
+    iree_hal_local_profiler_t** out_profiler);
+
+// Ends the profiling session, emits the report, and frees the |profiler|.
+// The profiler must have been detached from all hooks.
+iree_status_t iree_hal_local_profiler_end(iree_hal_local_profiler_t* profiler);
+
+//===----------------------------------------------------------------------===//
+// iree_hal_local_profiling_hook_t
+//===----------------------------------------------------------------------===//
+
+// Attachment point of a profiler to the workers of a single executor.
+//
+// Hooks are owned by whatever submits work to the executor (such as each queue
+// of a local-task device) and referenced by the dispatches recorded for it:
+// command buffers may be recorded before profiling begins and are not tied to
+// a particular session but they are tied to the device that created them.
+// Workers only observe the profiler attached to the hook of the dispatch they
+// are executing.
+//
+// In-flight samples are tracked per worker so that workers never contend on
+// shared state while profiling: each worker only touches its own cache line
+// and detaching drains every worker in turn. Workers beyond the count provided
+// when attaching (such as arbitrary threads executing inline) share a single
+// counter instead.
+typedef struct iree_hal_local_profiling_hook_t {
+  // Attached iree_hal_local_profiler_t, if any.
+  iree_atomic_intptr_t profiler;
+  // iree_hal_local_profiling_hook_slots_t with the in-flight sample count of
+  // each worker. Allocated on the first attach and retained until the hook is
+  // deinitialized as workers may reference it after a detach has begun.
+  iree_atomic_intptr_t slots;
+  // Number of in-flight samples from workers without a slot.
+  iree_atomic_int32_t sample_count;
+  // Index of worker 0 of the executor in the profiler worker table. Hooks
+  // attached to the same profiler use disjoint ranges of the table. Worker
+  // IDs are offset by this in timeline records.
+  uint32_t worker_base;
+  // Allocator used for |slots|.
+  iree_allocator_t host_allocator;
+} iree_hal_local_profiling_hook_t;
+
+// Initializes |out_hook| with no profiler attached.
+void iree_hal_local_profiling_hook_initialize(
+    iree_allocator_t host_allocator, iree_hal_local_profiling_hook_t* out_hook);
+
+// Detaches any profiler from |hook| and releases its resources.
+void iree_hal_local_profiling_hook_deinitialize(
+    iree_hal_local_profiling_hook_t* hook);
+
+// Attaches |profiler| to |hook| with the executor workers occupying the
+// profiler worker table starting at |worker_base|. Workers with IDs below
+// |worker_count| track their in-flight samples independently.
+void iree_hal_local_profiling_hook_attach(iree_hal_local_profiling_hook_t* hook,
+                                          iree_hal_local_profiler_t* profiler,
+                                          iree_host_size_t worker_base,
+                                          iree_host_size_t worker_count);
+
+// Detaches any profiler from |hook| and waits for all in-flight samples that
+// may still reference it to end.
+void iree_hal_local_profiling_hook_detach(
+    iree_hal_local_profiling_hook_t* hook);
+
+//===----------------------------------------------------------------------===//
+// Dispatch instrumentation
+//===----------------------------------------------------------------------===//
+
+// State captured at the start of a workgroup and consumed at its end.
+typedef struct iree_hal_local_profiling_sample_t {
+  // Hook the sample was taken through or NULL if no profiler was attached.
+  iree_hal_local_profiling_hook_t* hook;
+  // In-flight sample count the sample is registered with in |hook|.
+  iree_atomic_int32_t* in_flight;
+  iree_hal_local_profiler_t* profiler;
+  // Index of the worker in the profiler worker table. Beyond the worker count
+  // if the worker is unknown to the profiler.
+  uint32_t worker_index;
+  iree_time_t start_time_ns;
+  uint64_t counters[IREE_HAL_LOCAL_PROFILING_COUNTER_COUNT];
+} iree_hal_local_profiling_sample_t;
+
+// Begins measuring one or more workgroups executed by executor worker
+// |worker_id| through |hook| (which may be NULL). When no profiler is attached
+// this only performs a single relaxed atomic load and leaves the sample hook
+// NULL.
+void iree_hal_local_profiling_sample_begin(
+    iree_hal_local_profiling_hook_t* hook, uint32_t worker_id,
+    iree_hal_local_profiling_sample_t* out_sample);
+
+// Ends measuring workgroups started with iree_hal_local_profiling_sample_begin
+// and attributes the elapsed time and counters to the |workgroup_count|
+// workgroups starting at the linearized |workgroup_index| of |executable|
+// export |ordinal|.
+void iree_hal_local_profiling_sample_end(
+    const iree_hal_local_profiling_sample_t* sample,
+    iree_hal_local_executable_t* executable, uint32_t ordinal,
+    uint32_t workgroup_index, uint32_t workgroup_count);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_LOCAL_PROFILING_H_
@@ -30,39 +30,148 @@ static void iree_hal_semaphore_timepoint_list_push_back(
     list->head = timepoint;
   }
   timepoint->next = NULL;
-  timepoint->prev = list->tail;
   list->tail = timepoint;
 }
 
-// Erases |timepoint| from |list|.
-static void iree_hal_semaphore_timepoint_list_erase(
-    iree_hal_semaphore_timepoint_list_t* list,
-    iree_hal_semaphore_timepoint_t* timepoint) {
-  iree_hal_semaphore_timepoint_t* next = timepoint->next;
-  iree_hal_semaphore_timepoint_t* prev = timepoint->prev;
-  if (prev) {
-    prev->next = next;
-    timepoint->prev = NULL;
-  } else {
-    list->head = next;
+// Returns the timepoint containing the given value heap |node|.
+static inline iree_hal_semaphore_timepoint_t*
+iree_hal_semaphore_timepoint_from_value_node(
+    iree_hal_semaphore_timepoint_node_t* node) {
+  const size_t offset = offsetof(iree_hal_semaphore_timepoint_t, value_node);
+  return (iree_hal_semaphore_timepoint_t*)((uint8_t*)node - offset);
+}
+
+// Returns the timepoint containing the given deadline heap |node|.
+static inline iree_hal_semaphore_timepoint_t*
+iree_hal_semaphore_timepoint_from_deadline_node(
+    iree_hal_semaphore_timepoint_node_t* node) {
+  const size_t offset = offsetof(iree_hal_semaphore_timepoint_t, deadline_node);
+  return (iree_hal_semaphore_timepoint_t*)((uint8_t*)node - offset);
+}
+
+// Returns true if |timepoint| has a finite deadline and is tracked in the
+// deadline heap.
+static inline bool iree_hal_semaphore_timepoint_has_deadline(
+    const iree_hal_semaphore_timepoint_t* timepoint) {
+  return timepoint->deadline_ns != IREE_TIME_INFINITE_FUTURE;
+}
+
+// Returns an unsigned heap key with the same ordering as |deadline_ns|.
+static inline uint64_t iree_hal_semaphore_deadline_key(
+    iree_time_t deadline_ns) {
+  return (uint64_t)deadline_ns ^ (1ull << 63);
+}
+
+// Melds two detached heap roots and returns the new root.
+static iree_hal_semaphore_timepoint_node_t* iree_hal_semaphore_timepoint_meld(
+    iree_hal_semaphore_timepoint_node_t* a,
+    iree_hal_semaphore_timepoint_node_t* b) {
+  if (!a) return b;
+  if (!b) return a;
+  if (b->key < a->key) {
+    iree_hal_semaphore_timepoint_node_t* t = a;
+    a = b;
+    b = t;
   }
-  if (next) {
-    next->prev = prev;
-    timepoint->next = NULL;
+  // |b| becomes the first child of |a|.
+  b->prev = a;
+  b->sibling = a->child;
+  if (a->child) a->child->prev = b;
+  a->child = b;
+  a->prev = NULL;
+  a->sibling = NULL;
+  return a;
+}
+
+// Melds the sibling list starting at |first| into a single heap using the
+// standard two-pass pairing and returns its root.
+static iree_hal_semaphore_timepoint_node_t*
+iree_hal_semaphore_timepoint_merge_pairs(
+    iree_hal_semaphore_timepoint_node_t* first) {
+  // Pass 1: meld pairs left to right and push them onto a stack (linked
+  // through the sibling pointer).
+  iree_hal_semaphore_timepoint_node_t* stack = NULL;
+  while (first) {
+    iree_hal_semaphore_timepoint_node_t* a = first;
+    iree_hal_semaphore_timepoint_node_t* b = a->sibling;
+    first = b ? b->sibling : NULL;
+    a->prev = a->sibling = NULL;
+    if (b) b->prev = b->sibling = NULL;
+    iree_hal_semaphore_timepoint_node_t* pair =
+        iree_hal_semaphore_timepoint_meld(a, b);
+    pair->sibling = stack;
+    stack = pair;
+  }
+  // Pass 2: meld the pairs right to left.
+  iree_hal_semaphore_timepoint_node_t* root = NULL;
+  while (stack) {
+    iree_hal_semaphore_timepoint_node_t* next = stack->sibling;
+    stack->sibling = NULL;
+    root = iree_hal_semaphore_timepoint_meld(root, stack);
+    stack = next;
+  }
+  return root;
+}
+
+// Inserts |node| with the given |key| into |heap|.
+static void iree_hal_semaphore_timepoint_heap_insert(
+    iree_hal_semaphore_timepoint_heap_t* heap,
+    iree_hal_semaphore_timepoint_node_t* node, uint64_t key) {
+  node->child = NULL;
+  node->sibling = NULL;
+  node->prev = NULL;
+  node->key = key;
+  heap->root = iree_hal_semaphore_timepoint_meld(heap->root, node);
+}
+
+// Erases |node| from |heap|. The node may be anywhere in the heap.
+static void iree_hal_semaphore_timepoint_heap_erase(
+    iree_hal_semaphore_timepoint_heap_t* heap,
+    iree_hal_semaphore_timepoint_node_t* node) {
+  iree_hal_semaphore_timepoint_node_t* children =
+      iree_hal_semaphore_timepoint_merge_pairs(node->child);
+  if (node == heap->root) {
+    heap->root = children;
   } else {
-    list->tail = prev;
+    // Unlink the node (and its subtree) from its parent or left sibling.
+    if (node->prev->child == node) {
+      node->prev->child = node->sibling;
+    } else {
+      node->prev->sibling = node->sibling;
+    }
+    if (node->sibling) node->sibling->prev = node->prev;
+    heap->root = iree_hal_semaphore_timepoint_meld(heap->root, children);
   }
+  node->child = NULL;
+  node->sibling = NULL;
+  node->prev = NULL;
 }
 
-// Takes all timepoints from |available_list| and moves them into |ready_list|.
-static void iree_hal_semaphore_timepoint_list_take_all(
-    iree_hal_semaphore_timepoint_list_t* available_list,
-    iree_hal_semaphore_timepoint_list_t* ready_list) {
-  IREE_ASSERT(available_list != ready_list);
-  ready_list->head = available_list->head;
-  ready_list->tail = available_list->tail;
-  available_list->head = NULL;
-  available_list->tail = NULL;
+// Inserts |timepoint| into the semaphore timepoint heaps.
+// NOTE: semaphore timepoint lock must be held.
+static void iree_hal_semaphore_timepoint_insert(
+    iree_hal_semaphore_t* semaphore,
+    iree_hal_semaphore_timepoint_t* timepoint) {
+  iree_hal_semaphore_timepoint_heap_insert(
+      &semaphore->value_heap, &timepoint->value_node, timepoint->minimum_value);
+  if (iree_hal_semaphore_timepoint_has_deadline(timepoint)) {
+    iree_hal_semaphore_timepoint_heap_insert(
+        &semaphore->deadline_heap, &timepoint->deadline_node,
+        iree_hal_semaphore_deadline_key(timepoint->deadline_ns));
+  }
+}
+
+// Erases |timepoint| from the semaphore timepoint heaps.
+// NOTE: semaphore timepoint lock must be held.
+static void iree_hal_semaphore_timepoint_erase(
+    iree_hal_semaphore_t* semaphore,
+    iree_hal_semaphore_timepoint_t* timepoint) {
+  iree_hal_semaphore_timepoint_heap_erase(&semaphore->value_heap,
+                                          &timepoint->value_node);
+  if (iree_hal_semaphore_timepoint_has_deadline(timepoint)) {
+    iree_hal_semaphore_timepoint_heap_erase(&semaphore->deadline_heap,
+                                            &timepoint->deadline_node);
+  }
 }
 
 // Issues the callback for the given |timepoint| and resets it.
@@ -101,7 +210,6 @@ static void iree_hal_semaphore_issue_timepoint_callbacks(
        timepoint != NULL;) {
     list->head = timepoint->next;
     timepoint->next = NULL;
-    timepoint->prev = NULL;
     iree_hal_semaphore_issue_timepoint_callback(semaphore, new_value,
                                                 new_status_code, timepoint);
     timepoint = list->head;
@@ -114,45 +222,37 @@ static void iree_hal_semaphore_resolve_timepoints(
     iree_hal_semaphore_t* semaphore, uint64_t new_value) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  iree_hal_semaphore_timepoint_list_t pending_list = {NULL, NULL};
   iree_hal_semaphore_timepoint_list_t ready_list = {NULL, NULL};
   iree_hal_semaphore_timepoint_list_t expired_list = {NULL, NULL};
 
   iree_slim_mutex_lock(&semaphore->timepoint_mutex);
 
-  if (iree_hal_semaphore_timepoint_list_is_empty(&semaphore->timepoint_list)) {
-    iree_slim_mutex_unlock(&semaphore->timepoint_mutex);
-    IREE_TRACE_ZONE_END(z0);
-    return;
+  // Take all timepoints that have been reached in payload order; even if the
+  // deadline has been reached we'll still consider this a hit. Unsatisfied
+  // timepoints are not visited.
+  while (semaphore->value_heap.root &&
+         semaphore->value_heap.root->key <= new_value) {
+    iree_hal_semaphore_timepoint_t* timepoint =
+        iree_hal_semaphore_timepoint_from_value_node(
+            semaphore->value_heap.root);
+    iree_hal_semaphore_timepoint_erase(semaphore, timepoint);
+    iree_hal_semaphore_timepoint_list_push_back(&ready_list, timepoint);
   }
 
-  // Scan through the list and divvy up timepoints into still-pending, ready to
-  // resolve, and expired buckets.
-  iree_time_t now_ns = iree_time_now();
-  for (iree_hal_semaphore_timepoint_t* timepoint =
-           semaphore->timepoint_list.head;
-       timepoint != NULL;) {
-    iree_hal_semaphore_timepoint_t* next_timepoint = timepoint->next;
-    timepoint->next = NULL;
-
-    if (timepoint->minimum_value <= new_value) {
-      // Reached the timepoint; even if the deadline has been reached we'll
-      // still consider this a hit.
-      iree_hal_semaphore_timepoint_list_push_back(&ready_list, timepoint);
-    } else if (timepoint->deadline_ns <= now_ns) {
-      // Deadline expired before the timepoint was reached.
+  // Take all remaining timepoints whose deadlines expired before they were
+  // reached. We only need to query the time if any have finite deadlines.
+  if (semaphore->deadline_heap.root) {
+    const uint64_t now_key = iree_hal_semaphore_deadline_key(iree_time_now());
+    while (semaphore->deadline_heap.root &&
+           semaphore->deadline_heap.root->key <= now_key) {
+      iree_hal_semaphore_timepoint_t* timepoint =
+          iree_hal_semaphore_timepoint_from_deadline_node(
+              semaphore->deadline_heap.root);
+      iree_hal_semaphore_timepoint_erase(semaphore, timepoint);
       iree_hal_semaphore_timepoint_list_push_back(&expired_list, timepoint);
-    } else {
-      // Still pending.
-      iree_hal_semaphore_timepoint_list_push_back(&pending_list, timepoint);
     }
-
-    timepoint = next_timepoint;
   }
 
-  // Preserve pending timepoints.
-  semaphore->timepoint_list = pending_list;
-
   // Issue callbacks for all successes and failures.
   iree_hal_semaphore_issue_timepoint_callbacks(semaphore, new_value,
                                                IREE_STATUS_OK, &ready_list);
@@ -171,10 +271,15 @@ static void iree_hal_semaphore_reject_timepoints(
 
   iree_slim_mutex_lock(&semaphore->timepoint_mutex);
 
-  // Take the entire timepoint list from the semaphore.
+  // Take all timepoints from the semaphore.
   iree_hal_semaphore_timepoint_list_t failed_list = {NULL, NULL};
-  iree_hal_semaphore_timepoint_list_take_all(&semaphore->timepoint_list,
-                                             &failed_list);
+  while (semaphore->value_heap.root) {
+    iree_hal_semaphore_timepoint_t* timepoint =
+        iree_hal_semaphore_timepoint_from_value_node(
+            semaphore->value_heap.root);
+    iree_hal_semaphore_timepoint_erase(semaphore, timepoint);
+    iree_hal_semaphore_timepoint_list_push_back(&failed_list, timepoint);
+  }
 
   // Issue failure callbacks for all timepoints.
   iree_hal_semaphore_issue_timepoint_callbacks(semaphore, UINT64_MAX,
@@ -195,8 +300,8 @@ IREE_API_EXPORT void iree_hal_semaphore_initialize(
   IREE_ASSERT_ARGUMENT(out_semaphore);
   iree_hal_resource_initialize(vtable, &out_semaphore->resource);
   iree_slim_mutex_initialize(&out_semaphore->timepoint_mutex);
-  memset(&out_semaphore->timepoint_list, 0,
-         sizeof(out_semaphore->timepoint_list));
+  out_semaphore->value_heap.root = NULL;
+  out_semaphore->deadline_heap.root = NULL;
 }
 
 IREE_API_EXPORT void iree_hal_semaphore_deinitialize(
@@ -217,19 +322,17 @@ IREE_API_EXPORT void iree_hal_semaphore_acquire_timepoint(
   // Note that we capture the timeout as an absolute deadline as we don't know
   // how long it'll take to acquire the lock and how long it'll be pending.
   out_timepoint->next = NULL;
-  out_timepoint->prev = NULL;
   out_timepoint->semaphore = semaphore;
   iree_hal_semaphore_retain(semaphore);
   out_timepoint->minimum_value = minimum_value;
   out_timepoint->deadline_ns = iree_timeout_as_deadline_ns(timeout);
   out_timepoint->callback = callback;
 
-  // Insert into timepoint list.
+  // Insert into the timepoint heaps.
   // After we release the lock the callback may be issued immediately as another
   // thread may be waiting to signal the timepoint.
   iree_slim_mutex_lock(&semaphore->timepoint_mutex);
-  iree_hal_semaphore_timepoint_list_push_back(&semaphore->timepoint_list,
-                                              out_timepoint);
+  iree_hal_semaphore_timepoint_insert(semaphore, out_timepoint);
   iree_slim_mutex_unlock(&semaphore->timepoint_mutex);
 
   IREE_TRACE_ZONE_END(z0);
@@ -248,10 +351,9 @@ IREE_API_EXPORT void iree_hal_semaphore_cancel_timepoint(
   // even if such a race is possible.
   const bool needs_release = timepoint->semaphore != NULL;
   if (needs_release) {
-    // Remove the timepoint from the list to ensure no other code can issue its
-    // callback.
-    iree_hal_semaphore_timepoint_list_erase(&semaphore->timepoint_list,
-                                            timepoint);
+    // Remove the timepoint from the heaps to ensure no other code can issue
+    // its callback.
+    iree_hal_semaphore_timepoint_erase(semaphore, timepoint);
 
     // Neuter the timepoint so that it is never called.
     // Other threads may be sitting and waiting for the lock and we need to
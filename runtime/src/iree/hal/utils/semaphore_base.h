@@ -38,16 +38,41 @@ typedef struct iree_hal_semaphore_callback_t {
   void* user_data;
 } iree_hal_semaphore_callback_t;
 
+// Intrusive pairing heap node used to order timepoints.
+// Guarded by the semaphore timepoint mutex.
+typedef struct iree_hal_semaphore_timepoint_node_t {
+  // First (leftmost) child of this node.
+  struct iree_hal_semaphore_timepoint_node_t* child;
+  // Next sibling in the child list of this node's parent.
+  struct iree_hal_semaphore_timepoint_node_t* sibling;
+  // Previous sibling or the parent if this node is the first child.
+  struct iree_hal_semaphore_timepoint_node_t* prev;
+  // Ordering key; the node with the smallest key is the heap root.
+  uint64_t key;
+} iree_hal_semaphore_timepoint_node_t;
+
+// A min-heap of timepoint nodes.
+// Insertion is O(1) and removal of the minimum or an arbitrary node is
+// O(log n) amortized. As with the timepoint list the nodes are not owned.
+typedef struct iree_hal_semaphore_timepoint_heap_t {
+  iree_hal_semaphore_timepoint_node_t* root;
+} iree_hal_semaphore_timepoint_heap_t;
+
 // Storage for a semaphore timepoint.
-// Each semaphore manages a list of active timepoints and issues their specified
+// Each semaphore manages a set of active timepoints and issues their specified
 // callback when the semaphore is signaled to or beyond a given value.
 typedef struct iree_hal_semaphore_timepoint_t {
-  // Intrusive doubly-linked list next entry pointer.
-  // Guarded by the semaphore mutex.
+  // Intrusive singly-linked list next entry pointer used while a timepoint is
+  // being resolved. Guarded by the semaphore mutex.
   struct iree_hal_semaphore_timepoint_t* next;
-  // Intrusive doubly-linked list previous entry pointer.
+
+  // Node in the semaphore value heap keyed by minimum_value.
   // Guarded by the semaphore mutex.
-  struct iree_hal_semaphore_timepoint_t* prev;
+  iree_hal_semaphore_timepoint_node_t value_node;
+  // Node in the semaphore deadline heap keyed by deadline_ns. Only used if the
+  // deadline is not IREE_TIME_INFINITE_FUTURE.
+  // Guarded by the semaphore mutex.
+  iree_hal_semaphore_timepoint_node_t deadline_node;
 
   // Retained semaphore; this ensures the semaphore remains valid for the
   // lifetime of the timepoint. The semaphore must be released by the underlying
@@ -66,9 +91,7 @@ typedef struct iree_hal_semaphore_timepoint_t {
   iree_hal_semaphore_callback_t callback;
 } iree_hal_semaphore_timepoint_t;
 
-// A doubly-linked FIFO list of timepoints.
-// The order of the timepoints does *not* match increasing payload values but
-// instead the order they were added to the list.
+// A singly-linked FIFO list of timepoints.
 //
 // Note that the timepoints are not owned by the list - this just nicely
 // stitches together timepoints for easier management.
@@ -95,13 +118,17 @@ struct iree_hal_semaphore_t {
   // Non-recursive mutex guarding access to the timepoint list.
   iree_slim_mutex_t timepoint_mutex;
 
-  // Timepoint list in insertion order.
-  // There are probably better orderings we could use here that allow us to
-  // walk the entire list less frequently, though target payload value is not
-  // enough as deadlines still require the scan. We could sort by non-infinite
-  // deadlines first and then infinite ones last but given the common timepoint
-  // counts (0..1) it's not worth the complexity today.
-  iree_hal_semaphore_timepoint_list_t timepoint_list
+  // All pending timepoints ordered by minimum_value.
+  // Notification only touches the timepoints that have been satisfied instead
+  // of scanning every timepoint as pipelined workloads may have thousands of
+  // outstanding timepoints on a single semaphore.
+  iree_hal_semaphore_timepoint_heap_t value_heap
+      IREE_GUARDED_BY(timepoint_mutex);
+
+  // Pending timepoints with finite deadlines ordered by deadline_ns.
+  // Timepoints waiting forever are not tracked here and the common case of
+  // no finite deadlines skips the deadline check entirely.
+  iree_hal_semaphore_timepoint_heap_t deadline_heap
       IREE_GUARDED_BY(timepoint_mutex);
 };
 
@@ -111,7 +138,8 @@ IREE_API_EXPORT void iree_hal_semaphore_initialize(
     iree_hal_semaphore_t* out_semaphore);
 
 // Deinitializes the |semaphore|.
-// Because timepoints retain their semaphore the timepoint list is known empty.
+// Because timepoints retain their semaphore the timepoint heaps are known
+// empty.
 IREE_API_EXPORT void iree_hal_semaphore_deinitialize(
     iree_hal_semaphore_t* semaphore);
 
@@ -0,0 +1,274 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/prng.h"
+#include "iree/hal/api.h"
+#include "iree/hal/utils/semaphore_base.h"
+#include "iree/testing/benchmark.h"
+
+// Minimal semaphore that notifies the base timepoint tracking on signal.
+// Not thread-safe; benchmarks run on a single thread.
+typedef struct iree_hal_test_semaphore_t {
+  iree_hal_semaphore_t base;
+  iree_allocator_t host_allocator;
+  uint64_t current_value;
+} iree_hal_test_semaphore_t;
+
+static const iree_hal_semaphore_vtable_t iree_hal_test_semaphore_vtable;
+
+static iree_hal_test_semaphore_t* iree_hal_test_semaphore_cast(
+    iree_hal_semaphore_t* base_value) {
+  return (iree_hal_test_semaphore_t*)base_value;
+}
+
+static iree_status_t iree_hal_test_semaphore_create(
+    iree_allocator_t host_allocator, iree_hal_semaphore_t** out_semaphore) {
+  iree_hal_test_semaphore_t* semaphore = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      host_allocator, sizeof(*semaphore), (void**)&semaphore));
+  iree_hal_semaphore_initialize(&iree_hal_test_semaphore_vtable,
+                                &semaphore->base);
+  semaphore->host_allocator = host_allocator;
+  semaphore->current_value = 0;
+  *out_semaphore = &semaphore->base;
+  return iree_ok_status();
+}
+
+static void iree_hal_test_semaphore_destroy(
+    iree_hal_semaphore_t* base_semaphore) {
+  iree_hal_test_semaphore_t* semaphore =
+      iree_hal_test_semaphore_cast(base_semaphore);
+  iree_allocator_t host_allocator = semaphore->host_allocator;
+  iree_hal_semaphore_deinitialize(&semaphore->base);
+  iree_allocator_free(host_allocator, semaphore);
+}
+
+static iree_status_t iree_hal_test_semaphore_query(
+    iree_hal_semaphore_t* base_semaphore, uint64_t* out_value) {
+  *out_value = iree_hal_test_semaphore_cast(base_semaphore)->current_value;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_test_semaphore_signal(
+    iree_hal_semaphore_t* base_semaphore, uint64_t new_value) {
+  iree_hal_test_semaphore_cast(base_semaphore)->current_value = new_value;
+  iree_hal_semaphore_notify(base_semaphore, new_value, IREE_STATUS_OK);
+  return iree_ok_status();
+}
+
+static void iree_hal_test_semaphore_fail(iree_hal_semaphore_t* base_semaphore,
+                                         iree_status_t status) {
+  iree_hal_semaphore_notify(base_semaphore, 0, iree_status_code(status));
+  iree_status_ignore(status);
+}
+
+static iree_status_t iree_hal_test_semaphore_wait(
+    iree_hal_semaphore_t* base_semaphore, uint64_t value,
+    iree_timeout_t timeout) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED, "benchmark semaphore");
+}
+
+static const iree_hal_semaphore_vtable_t iree_hal_test_semaphore_vtable = {
+    .destroy = iree_hal_test_semaphore_destroy,
+    .query = iree_hal_test_semaphore_query,
+    .signal = iree_hal_test_semaphore_signal,
+    .fail = iree_hal_test_semaphore_fail,
+    .wait = iree_hal_test_semaphore_wait,
+};
+
+static iree_status_t iree_hal_semaphore_benchmark_callback(
+    void* user_data, iree_hal_semaphore_t* semaphore, uint64_t value,
+    iree_status_code_t status_code) {
+  ++*(uint64_t*)user_data;
+  return iree_ok_status();
+}
+
+// Tests signaling a semaphore with N outstanding timepoints where each signal
+// resolves exactly one timepoint. This models a pipelined loop where waits are
+// queued well ahead of the signals that satisfy them. Each resolved timepoint
+// is reacquired N values ahead so the outstanding count remains constant.
+//
+// user_data is a count of outstanding timepoints. When |with_deadlines| is
+// true all timepoints have (far-future) finite deadlines.
+static iree_status_t iree_hal_semaphore_benchmark_signal_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state, bool with_deadlines) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+  uint32_t count = (uint32_t)(uintptr_t)benchmark_def->user_data;
+
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_CHECK_OK(iree_hal_test_semaphore_create(host_allocator, &semaphore));
+
+  iree_hal_semaphore_timepoint_t* timepoints = NULL;
+  IREE_CHECK_OK(iree_allocator_malloc(host_allocator,
+                                      sizeof(*timepoints) * count,
+                                      (void**)&timepoints));
+  iree_timeout_t timeout = with_deadlines
+                               ? iree_make_timeout_ms(60 * 60 * 1000)
+                               : iree_infinite_timeout();
+  uint64_t callback_count = 0;
+  iree_hal_semaphore_callback_t callback = {
+      .fn = iree_hal_semaphore_benchmark_callback,
+      .user_data = &callback_count,
+  };
+  for (uint32_t i = 0; i < count; ++i) {
+    iree_hal_semaphore_acquire_timepoint(semaphore, i + 1, timeout, callback,
+                                         &timepoints[i]);
+  }
+
+  uint64_t value = 0;
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    ++value;
+    IREE_CHECK_OK(iree_hal_semaphore_signal(semaphore, value));
+    iree_hal_semaphore_acquire_timepoint(semaphore, value + count, timeout,
+                                         callback,
+                                         &timepoints[(value - 1) % count]);
+  }
+  if (callback_count != value) {
+    fprintf(stderr, "expected %" PRIu64 " callbacks but got %" PRIu64 "\n",
+            value, callback_count);
+    abort();
+  }
+
+  // Cleanup.
+  for (uint32_t i = 0; i < count; ++i) {
+    iree_hal_semaphore_cancel_timepoint(semaphore, &timepoints[i]);
+  }
+  iree_allocator_free(host_allocator, timepoints);
+  iree_hal_semaphore_release(semaphore);
+
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_semaphore_benchmark_signal_infinite_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  return iree_hal_semaphore_benchmark_signal_n(benchmark_def, benchmark_state,
+                                               /*with_deadlines=*/false);
+}
+
+static iree_status_t iree_hal_semaphore_benchmark_signal_deadline_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  return iree_hal_semaphore_benchmark_signal_n(benchmark_def, benchmark_state,
+                                               /*with_deadlines=*/true);
+}
+
+// Tests acquiring and cancelling a timepoint with a random value while N
+// timepoints with random values are outstanding. This models waits that time
+// out or are abandoned before the semaphore reaches them.
+//
+// user_data is a count of outstanding timepoints.
+static iree_status_t iree_hal_semaphore_benchmark_cancel_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+  uint32_t count = (uint32_t)(uintptr_t)benchmark_def->user_data;
+
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_CHECK_OK(iree_hal_test_semaphore_create(host_allocator, &semaphore));
+
+  iree_hal_semaphore_timepoint_t* timepoints = NULL;
+  IREE_CHECK_OK(iree_allocator_malloc(host_allocator,
+                                      sizeof(*timepoints) * count,
+                                      (void**)&timepoints));
+  uint64_t callback_count = 0;
+  iree_hal_semaphore_callback_t callback = {
+      .fn = iree_hal_semaphore_benchmark_callback,
+      .user_data = &callback_count,
+  };
+
+  // The PRNG we use to select the values and the timepoint to cancel.
+  iree_prng_xoroshiro128_state_t prng = {0};
+  iree_prng_xoroshiro128_initialize(123ull, &prng);
+
+  for (uint32_t i = 0; i < count; ++i) {
+    iree_hal_semaphore_acquire_timepoint(
+        semaphore, 1 + iree_prng_xoroshiro128plus_next_uint32(&prng),
+        iree_infinite_timeout(), callback, &timepoints[i]);
+  }
+
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    uint32_t i = iree_prng_xoroshiro128plus_next_uint32(&prng) % count;
+    iree_hal_semaphore_cancel_timepoint(semaphore, &timepoints[i]);
+    iree_hal_semaphore_acquire_timepoint(
+        semaphore, 1 + iree_prng_xoroshiro128plus_next_uint32(&prng),
+        iree_infinite_timeout(), callback, &timepoints[i]);
+  }
+
+  // Cleanup.
+  for (uint32_t i = 0; i < count; ++i) {
+    iree_hal_semaphore_cancel_timepoint(semaphore, &timepoints[i]);
+  }
+  iree_allocator_free(host_allocator, timepoints);
+  iree_hal_semaphore_release(semaphore);
+
+  return iree_ok_status();
+}
+
+static void iree_hal_semaphore_benchmark_register_n(
+    const char* name_prefix, iree_benchmark_def_t* benchmark_def) {
+  static const uint32_t counts[] = {1, 16, 256, 4096};
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(counts); ++i) {
+    char name[64];
+    snprintf(name, sizeof(name), "%s_%u", name_prefix, counts[i]);
+    benchmark_def->user_data = (void*)(uintptr_t)counts[i];
+    iree_benchmark_register(iree_make_cstring_view(name), benchmark_def);
+  }
+}
+
+int main(int argc, char** argv) {
+  iree_benchmark_initialize(&argc, argv);
+
+  // iree_hal_semaphore_benchmark_signal_infinite_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_NANOSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_hal_semaphore_benchmark_signal_infinite_n,
+    };
+    iree_hal_semaphore_benchmark_register_n("signal", &benchmark_def);
+  }
+
+  // iree_hal_semaphore_benchmark_signal_deadline_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_NANOSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_hal_semaphore_benchmark_signal_deadline_n,
+    };
+    iree_hal_semaphore_benchmark_register_n("signal_deadline", &benchmark_def);
+  }
+
+  // iree_hal_semaphore_benchmark_cancel_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_NANOSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_hal_semaphore_benchmark_cancel_n,
+    };
+    iree_hal_semaphore_benchmark_register_n("cancel", &benchmark_def);
+  }
+
+  iree_benchmark_run_specified();
+  return 0;
+}
@@ -374,6 +374,79 @@ TEST_F(TrackingSemaphoreTest, CancelResolvedTimepoint) {
   iree_hal_semaphore_release(*semaphore);
 }
 
+// Tests that only timepoints at or below the signaled value are resolved when
+// many timepoints are outstanding and some have been cancelled.
+TEST_F(TrackingSemaphoreTest, ResolveManyTimepoints) {
+  auto* semaphore = TestSemaphore::Create(0ull, host_allocator);
+
+  // Acquire in a scrambled order so the heap has to reorder them.
+  static constexpr int kCount = 64;
+  CallbackState states[kCount];
+  iree_hal_semaphore_timepoint_t timepoints[kCount];
+  for (int i = 0; i < kCount; ++i) {
+    int j = (i * 37) % kCount;
+    iree_hal_semaphore_acquire_timepoint(*semaphore, (uint64_t)j + 1,
+                                         iree_infinite_timeout(),
+                                         MakeCallback(&states[j]),
+                                         &timepoints[j]);
+  }
+
+  // Cancel every fourth timepoint; these are scattered through the heap.
+  for (int i = 0; i < kCount; i += 4) {
+    iree_hal_semaphore_cancel_timepoint(*semaphore, &timepoints[i]);
+  }
+
+  // Signal halfway and ensure only the lower half was resolved.
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(*semaphore, kCount / 2));
+  for (int i = 0; i < kCount; ++i) {
+    const bool expect_resolved = (i % 4) != 0 && i < kCount / 2;
+    ASSERT_EQ(states[i].callback_count, expect_resolved ? 1 : 0) << i;
+  }
+
+  // Signal the remainder.
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(*semaphore, kCount));
+  for (int i = 0; i < kCount; ++i) {
+    ASSERT_EQ(states[i].callback_count, (i % 4) != 0 ? 1 : 0) << i;
+    if ((i % 4) != 0) {
+      ASSERT_EQ(states[i].status_code, IREE_STATUS_OK);
+    }
+  }
+
+  iree_hal_semaphore_release(*semaphore);
+}
+
+// Tests that expired timepoints are resolved with DEADLINE_EXCEEDED while
+// timepoints without deadlines remain pending.
+TEST_F(TrackingSemaphoreTest, ExpireTimepoints) {
+  auto* semaphore = TestSemaphore::Create(0ull, host_allocator);
+
+  CallbackState expired_state;
+  iree_hal_semaphore_timepoint_t expired_timepoint;
+  iree_hal_semaphore_acquire_timepoint(*semaphore, 10ull,
+                                       iree_immediate_timeout(),
+                                       MakeCallback(&expired_state),
+                                       &expired_timepoint);
+  CallbackState pending_state;
+  iree_hal_semaphore_timepoint_t pending_timepoint;
+  iree_hal_semaphore_acquire_timepoint(*semaphore, 10ull,
+                                       iree_infinite_timeout(),
+                                       MakeCallback(&pending_state),
+                                       &pending_timepoint);
+
+  // Neither timepoint has been reached but one has expired.
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(*semaphore, 1ull));
+  ASSERT_EQ(expired_state.callback_count, 1);
+  ASSERT_EQ(expired_state.status_code, IREE_STATUS_DEADLINE_EXCEEDED);
+  ASSERT_EQ(pending_state.callback_count, 0);
+
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(*semaphore, 10ull));
+  ASSERT_EQ(expired_state.callback_count, 1);
+  ASSERT_EQ(pending_state.callback_count, 1);
+  ASSERT_EQ(pending_state.status_code, IREE_STATUS_OK);
+
+  iree_hal_semaphore_release(*semaphore);
+}
+
 }  // namespace
 }  // namespace hal
 }  // namespace iree
@@ -0,0 +1,331 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/parameter_archive.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/tracing.h"
+#include "iree/schemas/parameter_archive.h"
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define IREE_IO_HAVE_MMAP 1
+#else
+#define IREE_IO_HAVE_MMAP 0
+#endif  // IREE_PLATFORM_*
+
+struct iree_io_parameter_archive_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  // Entire archive file contents.
+  iree_const_byte_span_t contents;
+  iree_io_parameter_archive_release_callback_t release_callback;
+  // Validated entry table within |contents| sorted by key.
+  iree_host_size_t entry_count;
+  const iree_io_parameter_archive_entry_t* entries;
+  // String table within |contents| referenced by entry keys.
+  const char* string_table;
+  // Data segment within |contents| referenced by entry data.
+  const uint8_t* data;
+};
+
+// Returns true if the range [offset, offset + length) is within [0, limit).
+static bool iree_io_parameter_archive_range_is_valid(uint64_t offset,
+                                                     uint64_t length,
+                                                     uint64_t limit) {
+  return offset <= limit && length <= limit - offset;
+}
+
+// Verifies the archive header and entry table in |contents| and populates the
+// table pointers in |archive|. All entries are verified upfront such that
+// lookups need not range check.
+static iree_status_t iree_io_parameter_archive_parse(
+    iree_const_byte_span_t contents, iree_io_parameter_archive_t* archive) {
+#if !defined(IREE_ENDIANNESS_LITTLE)
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "parameter archives are little-endian only");
+#endif  // !IREE_ENDIANNESS_LITTLE
+
+  if (contents.data_length < sizeof(iree_io_parameter_archive_header_t) ||
+      !iree_host_size_has_alignment((uintptr_t)contents.data,
+                                    iree_alignof(uint64_t))) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "parameter archive header truncated or unaligned");
+  }
+  const iree_io_parameter_archive_header_t* header =
+      (const iree_io_parameter_archive_header_t*)contents.data;
+  if (header->magic != IREE_IO_PARAMETER_ARCHIVE_MAGIC) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "parameter archive magic mismatch");
+  }
+  if (header->version != IREE_IO_PARAMETER_ARCHIVE_VERSION) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "parameter archive version %u not supported",
+                            header->version);
+  }
+  const uint64_t file_length = header->file_length;
+  if (file_length > contents.data_length) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "parameter archive truncated; expected %" PRIu64
+                            " bytes but have %" PRIhsz,
+                            file_length, contents.data_length);
+  }
+  const uint64_t entry_count = header->entry_count;
+  if (entry_count > file_length / sizeof(iree_io_parameter_archive_entry_t) ||
+      !iree_io_parameter_archive_range_is_valid(
+          header->entry_table_offset,
+          entry_count * sizeof(iree_io_parameter_archive_entry_t),
+          file_length) ||
+      !iree_host_size_has_alignment(header->entry_table_offset,
+                                    iree_alignof(uint64_t))) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "parameter archive entry table out of range");
+  }
+  if (!iree_io_parameter_archive_range_is_valid(header->string_table_offset,
+                                                header->string_table_length,
+                                                file_length)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "parameter archive string table out of range");
+  }
+  if (header->data_offset > file_length) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "parameter archive data segment out of range");
+  }
+  const uint64_t data_length = file_length - header->data_offset;
+
+  const iree_io_parameter_archive_entry_t* entries =
+      (const iree_io_parameter_archive_entry_t*)(contents.data +
+                                                 header->entry_table_offset);
+  const char* string_table =
+      (const char*)(contents.data + header->string_table_offset);
+  for (uint64_t i = 0; i < entry_count; ++i) {
+    const iree_io_parameter_archive_entry_t* entry = &entries[i];
+    if (!iree_io_parameter_archive_range_is_valid(
+            entry->key_offset, entry->key_length,
+            header->string_table_length) ||
+        !iree_io_parameter_archive_range_is_valid(
+            entry->data_offset, entry->data_length, data_length)) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "parameter archive entry %" PRIu64
+                              " out of range",
+                              i);
+    }
+    if (i > 0) {
+      const iree_io_parameter_archive_entry_t* prev_entry = &entries[i - 1];
+      iree_string_view_t prev_key = iree_make_string_view(
+          string_table + prev_entry->key_offset, prev_entry->key_length);
+      iree_string_view_t key = iree_make_string_view(
+          string_table + entry->key_offset, entry->key_length);
+      if (iree_string_view_compare(prev_key, key) >= 0) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "parameter archive entries not sorted or "
+                                "contain duplicate key '%.*s'",
+                                (int)key.size, key.data);
+      }
+    }
+  }
+
+  archive->entry_count = (iree_host_size_t)entry_count;
+  archive->entries = entries;
+  archive->string_table = string_table;
+  archive->data = contents.data + header->data_offset;
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_io_parameter_archive_wrap_memory(
+    iree_const_byte_span_t contents,
+    iree_io_parameter_archive_release_callback_t release_callback,
+    iree_allocator_t host_allocator,
+    iree_io_parameter_archive_t** out_archive) {
+  IREE_ASSERT_ARGUMENT(out_archive);
+  *out_archive = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_io_parameter_archive_t* archive = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*archive),
+                                (void**)&archive));
+  iree_atomic_ref_count_init(&archive->ref_count);
+  archive->host_allocator = host_allocator;
+  archive->contents = contents;
+  archive->release_callback = iree_io_parameter_archive_release_callback_null();
+
+  iree_status_t status = iree_io_parameter_archive_parse(contents, archive);
+
+  if (iree_status_is_ok(status)) {
+    // Only take ownership of the contents once we know we'll succeed.
+    archive->release_callback = release_callback;
+    *out_archive = archive;
+  } else {
+    iree_allocator_free(host_allocator, archive);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+#if IREE_IO_HAVE_MMAP
+
+static void iree_io_parameter_archive_unmap(void* user_data,
+                                            iree_const_byte_span_t contents) {
+  munmap((void*)contents.data, contents.data_length);
+}
+
+IREE_API_EXPORT iree_status_t iree_io_parameter_archive_open_file(
+    iree_string_view_t path, iree_allocator_t host_allocator,
+    iree_io_parameter_archive_t** out_archive) {
+  IREE_ASSERT_ARGUMENT(out_archive);
+  *out_archive = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, path.data, path.size);
+
+  char path_str[2048];
+  if (path.size >= sizeof(path_str)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE, "path too long");
+  }
+  memcpy(path_str, path.data, path.size);
+  path_str[path.size] = 0;
+
+  int fd = open(path_str, O_RDONLY);
+  if (fd == -1) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to open parameter archive '%s'", path_str);
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == -1) {
+    close(fd);
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to stat parameter archive '%s'", path_str);
+  }
+  if (file_stat.st_size == 0 ||
+      (uint64_t)file_stat.st_size > IREE_HOST_SIZE_MAX) {
+    close(fd);
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "parameter archive '%s' cannot be mapped",
+                            path_str);
+  }
+
+  // Mapped shared and read-only so that all mappings of the file across
+  // contexts and processes reference the same page cache pages. Pages are
+  // faulted in on first access by whatever device touches them.
+  void* data =
+      mmap(NULL, (size_t)file_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to map parameter archive '%s'", path_str);
+  }
+
+  iree_const_byte_span_t contents =
+      iree_make_const_byte_span(data, (iree_host_size_t)file_stat.st_size);
+  iree_io_parameter_archive_release_callback_t release_callback = {
+      .fn = iree_io_parameter_archive_unmap,
+      .user_data = NULL,
+  };
+  iree_status_t status = iree_io_parameter_archive_wrap_memory(
+      contents, release_callback, host_allocator, out_archive);
+  if (!iree_status_is_ok(status)) {
+    munmap(data, contents.data_length);
+    status = iree_status_annotate_f(status, "opening parameter archive '%s'",
+                                    path_str);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+#else
+
+IREE_API_EXPORT iree_status_t iree_io_parameter_archive_open_file(
+    iree_string_view_t path, iree_allocator_t host_allocator,
+    iree_io_parameter_archive_t** out_archive) {
+  IREE_ASSERT_ARGUMENT(out_archive);
+  *out_archive = NULL;
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "file mapping not available on this platform");
+}
+
+#endif  // IREE_IO_HAVE_MMAP
+
+static void iree_io_parameter_archive_destroy(
+    iree_io_parameter_archive_t* archive) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = archive->host_allocator;
+  if (archive->release_callback.fn) {
+    archive->release_callback.fn(archive->release_callback.user_data,
+                                 archive->contents);
+  }
+  iree_allocator_free(host_allocator, archive);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT void iree_io_parameter_archive_retain(
+    iree_io_parameter_archive_t* archive) {
+  if (IREE_LIKELY(archive)) {
+    iree_atomic_ref_count_inc(&archive->ref_count);
+  }
+}
+
+IREE_API_EXPORT void iree_io_parameter_archive_release(
+    iree_io_parameter_archive_t* archive) {
+  if (IREE_LIKELY(archive) &&
+      iree_atomic_ref_count_dec(&archive->ref_count) == 1) {
+    iree_io_parameter_archive_destroy(archive);
+  }
+}
+
+IREE_API_EXPORT iree_allocator_t
+iree_io_parameter_archive_host_allocator(iree_io_parameter_archive_t* archive) {
+  IREE_ASSERT_ARGUMENT(archive);
+  return archive->host_allocator;
+}
+
+IREE_API_EXPORT iree_host_size_t
+iree_io_parameter_archive_entry_count(iree_io_parameter_archive_t* archive) {
+  IREE_ASSERT_ARGUMENT(archive);
+  return archive->entry_count;
+}
+
+IREE_API_EXPORT iree_status_t iree_io_parameter_archive_lookup(
+    iree_io_parameter_archive_t* archive, iree_string_view_t key,
+    iree_const_byte_span_t* out_contents) {
+  IREE_ASSERT_ARGUMENT(archive);
+  IREE_ASSERT_ARGUMENT(out_contents);
+  *out_contents = iree_const_byte_span_empty();
+
+  // Entries were verified to be sorted when the archive was opened.
+  iree_host_size_t low = 0;
+  iree_host_size_t high = archive->entry_count;
+  while (low < high) {
+    const iree_host_size_t mid = low + (high - low) / 2;
+    const iree_io_parameter_archive_entry_t* entry = &archive->entries[mid];
+    iree_string_view_t entry_key = iree_make_string_view(
+        archive->string_table + entry->key_offset, entry->key_length);
+    int cmp = iree_string_view_compare(key, entry_key);
+    if (cmp == 0) {
+      *out_contents = iree_make_const_byte_span(
+          archive->data + entry->data_offset, entry->data_length);
+      return iree_ok_status();
+    } else if (cmp < 0) {
+      high = mid;
+    } else {
+      low = mid + 1;
+    }
+  }
+  return iree_make_status(IREE_STATUS_NOT_FOUND,
+                          "parameter '%.*s' not found in archive",
+                          (int)key.size, key.data);
+}
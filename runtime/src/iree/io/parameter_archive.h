@@ -0,0 +1,89 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_IO_PARAMETER_ARCHIVE_H_
+#define IREE_IO_PARAMETER_ARCHIVE_H_
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_io_parameter_archive_t
+//===----------------------------------------------------------------------===//
+
+// A callback issued when the memory backing an archive is no longer used.
+typedef struct iree_io_parameter_archive_release_callback_t {
+  void(IREE_API_PTR* fn)(void* user_data, iree_const_byte_span_t contents);
+  void* user_data;
+} iree_io_parameter_archive_release_callback_t;
+
+// Returns a no-op release callback that implies that the caller manages the
+// lifetime of the archive contents.
+static inline iree_io_parameter_archive_release_callback_t
+iree_io_parameter_archive_release_callback_null(void) {
+  iree_io_parameter_archive_release_callback_t callback = {NULL, NULL};
+  return callback;
+}
+
+// A read-only indexed archive of named parameters in the format defined by
+// iree/schemas/parameter_archive.h.
+//
+// Archives opened from files are mapped shared and read-only such that all
+// archives of the same file - in this process or any other - are backed by the
+// same physical pages in the system file cache. Parameter contents returned
+// from lookups point directly into the mapping and remain valid for as long as
+// the archive is retained.
+//
+// Thread-safe: lookups may be performed concurrently.
+typedef struct iree_io_parameter_archive_t iree_io_parameter_archive_t;
+
+// Opens the archive file at |path| by mapping it into memory.
+// Returns IREE_STATUS_UNAVAILABLE on platforms without file mapping support.
+IREE_API_EXPORT iree_status_t iree_io_parameter_archive_open_file(
+    iree_string_view_t path, iree_allocator_t host_allocator,
+    iree_io_parameter_archive_t** out_archive);
+
+// Wraps archive |contents| already resident in memory. The contents must
+// remain valid until the |release_callback| is issued when the archive is
+// destroyed. The contents must be aligned to
+// IREE_IO_PARAMETER_ARCHIVE_DATA_ALIGNMENT for parameters to be importable
+// without copies.
+IREE_API_EXPORT iree_status_t iree_io_parameter_archive_wrap_memory(
+    iree_const_byte_span_t contents,
+    iree_io_parameter_archive_release_callback_t release_callback,
+    iree_allocator_t host_allocator, iree_io_parameter_archive_t** out_archive);
+
+// Retains the given |archive| for the caller.
+IREE_API_EXPORT void iree_io_parameter_archive_retain(
+    iree_io_parameter_archive_t* archive);
+
+// Releases the given |archive| from the caller.
+IREE_API_EXPORT void iree_io_parameter_archive_release(
+    iree_io_parameter_archive_t* archive);
+
+// Returns the allocator used to allocate the archive.
+IREE_API_EXPORT iree_allocator_t
+iree_io_parameter_archive_host_allocator(iree_io_parameter_archive_t* archive);
+
+// Returns the total number of parameters in the archive.
+IREE_API_EXPORT iree_host_size_t
+iree_io_parameter_archive_entry_count(iree_io_parameter_archive_t* archive);
+
+// Looks up the parameter with the given |key| and returns a view of its
+// contents in the archive. The contents are only valid while the archive is
+// retained. Returns IREE_STATUS_NOT_FOUND if the key is not present.
+IREE_API_EXPORT iree_status_t iree_io_parameter_archive_lookup(
+    iree_io_parameter_archive_t* archive, iree_string_view_t key,
+    iree_const_byte_span_t* out_contents);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_IO_PARAMETER_ARCHIVE_H_
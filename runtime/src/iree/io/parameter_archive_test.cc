@@ -0,0 +1,183 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/parameter_archive.h"
+
+#include <string>
+
+#include "iree/base/api.h"
+#include "iree/io/parameter_provider.h"
+#include "iree/io/testing/parameter_archive_builder.h"
+#include "iree/schemas/parameter_archive.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+using ::iree::io::testing::BuildArchive;
+using ::iree::io::testing::WrapArchive;
+using ::iree::testing::status::StatusIs;
+
+std::string ToString(iree_const_byte_span_t span) {
+  return std::string(reinterpret_cast<const char*>(span.data),
+                     span.data_length);
+}
+
+TEST(ParameterArchiveTest, Empty) {
+  auto storage = BuildArchive({});
+  iree_io_parameter_archive_t* archive = WrapArchive(storage);
+  EXPECT_EQ(iree_io_parameter_archive_entry_count(archive), 0);
+  iree_const_byte_span_t contents;
+  EXPECT_THAT(iree_io_parameter_archive_lookup(archive, IREE_SV("a"), &contents),
+              StatusIs(iree::StatusCode::kNotFound));
+  iree_io_parameter_archive_release(archive);
+}
+
+TEST(ParameterArchiveTest, Lookup) {
+  auto storage = BuildArchive({
+      {"a", "hello"},
+      {"ab", ""},
+      {"b", std::string(5000, 'x')},
+      {"c", "world"},
+  });
+  iree_io_parameter_archive_t* archive = WrapArchive(storage);
+  EXPECT_EQ(iree_io_parameter_archive_entry_count(archive), 4);
+
+  iree_const_byte_span_t contents;
+  IREE_ASSERT_OK(
+      iree_io_parameter_archive_lookup(archive, IREE_SV("a"), &contents));
+  EXPECT_EQ(ToString(contents), "hello");
+  IREE_ASSERT_OK(
+      iree_io_parameter_archive_lookup(archive, IREE_SV("ab"), &contents));
+  EXPECT_EQ(contents.data_length, 0);
+  IREE_ASSERT_OK(
+      iree_io_parameter_archive_lookup(archive, IREE_SV("b"), &contents));
+  EXPECT_EQ(ToString(contents), std::string(5000, 'x'));
+  IREE_ASSERT_OK(
+      iree_io_parameter_archive_lookup(archive, IREE_SV("c"), &contents));
+  EXPECT_EQ(ToString(contents), "world");
+
+  // Contents are returned in-place and page aligned.
+  EXPECT_GE(contents.data, storage.data);
+  EXPECT_LT(contents.data, storage.data + storage.length);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(contents.data) %
+                IREE_IO_PARAMETER_ARCHIVE_DATA_ALIGNMENT,
+            0);
+
+  EXPECT_THAT(iree_io_parameter_archive_lookup(archive, IREE_SV(""), &contents),
+              StatusIs(iree::StatusCode::kNotFound));
+  EXPECT_THAT(
+      iree_io_parameter_archive_lookup(archive, IREE_SV("bb"), &contents),
+      StatusIs(iree::StatusCode::kNotFound));
+  iree_io_parameter_archive_release(archive);
+}
+
+TEST(ParameterArchiveTest, ReleaseCallback) {
+  auto storage = BuildArchive({{"a", "hello"}});
+  int release_count = 0;
+  iree_io_parameter_archive_release_callback_t release_callback = {
+      +[](void* user_data, iree_const_byte_span_t contents) {
+        ++*reinterpret_cast<int*>(user_data);
+      },
+      &release_count,
+  };
+  iree_io_parameter_archive_t* archive = NULL;
+  IREE_ASSERT_OK(iree_io_parameter_archive_wrap_memory(
+      storage.span(), release_callback, iree_allocator_system(), &archive));
+  iree_io_parameter_archive_retain(archive);
+  iree_io_parameter_archive_release(archive);
+  EXPECT_EQ(release_count, 0);
+  iree_io_parameter_archive_release(archive);
+  EXPECT_EQ(release_count, 1);
+}
+
+TEST(ParameterArchiveTest, RejectInvalid) {
+  iree_io_parameter_archive_t* archive = NULL;
+
+  auto bad_magic = BuildArchive({{"a", "hello"}});
+  bad_magic.header()->magic = 0;
+  EXPECT_THAT(iree_io_parameter_archive_wrap_memory(
+                  bad_magic.span(),
+                  iree_io_parameter_archive_release_callback_null(),
+                  iree_allocator_system(), &archive),
+              StatusIs(iree::StatusCode::kInvalidArgument));
+
+  auto truncated = BuildArchive({{"a", "hello"}});
+  truncated.length -= 1;
+  EXPECT_THAT(iree_io_parameter_archive_wrap_memory(
+                  truncated.span(),
+                  iree_io_parameter_archive_release_callback_null(),
+                  iree_allocator_system(), &archive),
+              StatusIs(iree::StatusCode::kOutOfRange));
+
+  auto bad_entry = BuildArchive({{"a", "hello"}});
+  bad_entry.entries()[0].data_length = bad_entry.length;
+  EXPECT_THAT(iree_io_parameter_archive_wrap_memory(
+                  bad_entry.span(),
+                  iree_io_parameter_archive_release_callback_null(),
+                  iree_allocator_system(), &archive),
+              StatusIs(iree::StatusCode::kOutOfRange));
+
+  auto unsorted = BuildArchive({{"a", "hello"}, {"b", "world"}});
+  std::swap(unsorted.entries()[0], unsorted.entries()[1]);
+  EXPECT_THAT(iree_io_parameter_archive_wrap_memory(
+                  unsorted.span(),
+                  iree_io_parameter_archive_release_callback_null(),
+                  iree_allocator_system(), &archive),
+              StatusIs(iree::StatusCode::kInvalidArgument));
+}
+
+TEST(ParameterProviderTest, ScopedLookup) {
+  auto shared_storage = BuildArchive({{"a", "shared_a"}, {"b", "shared_b"}});
+  auto variant_storage = BuildArchive({{"b", "variant_b"}, {"c", "variant_c"}});
+  auto other_storage = BuildArchive({{"a", "other_a"}});
+  iree_io_parameter_archive_t* shared_archive = WrapArchive(shared_storage);
+  iree_io_parameter_archive_t* variant_archive = WrapArchive(variant_storage);
+  iree_io_parameter_archive_t* other_archive = WrapArchive(other_storage);
+
+  iree_io_parameter_provider_t* provider = NULL;
+  IREE_ASSERT_OK(
+      iree_io_parameter_provider_create(iree_allocator_system(), &provider));
+  IREE_ASSERT_OK(iree_io_parameter_provider_add_archive(
+      provider, IREE_SV("model"), variant_archive));
+  IREE_ASSERT_OK(iree_io_parameter_provider_add_archive(
+      provider, IREE_SV("model"), shared_archive));
+  IREE_ASSERT_OK(iree_io_parameter_provider_add_archive(
+      provider, iree_string_view_empty(), other_archive));
+  iree_io_parameter_archive_release(shared_archive);
+  iree_io_parameter_archive_release(variant_archive);
+  iree_io_parameter_archive_release(other_archive);
+
+  iree_io_parameter_archive_t* archive = NULL;
+  iree_const_byte_span_t contents;
+  IREE_ASSERT_OK(iree_io_parameter_provider_lookup(
+      provider, IREE_SV("model"), IREE_SV("a"), &archive, &contents));
+  EXPECT_EQ(archive, shared_archive);
+  EXPECT_EQ(ToString(contents), "shared_a");
+  IREE_ASSERT_OK(iree_io_parameter_provider_lookup(
+      provider, IREE_SV("model"), IREE_SV("b"), &archive, &contents));
+  EXPECT_EQ(archive, variant_archive);
+  EXPECT_EQ(ToString(contents), "variant_b");
+  IREE_ASSERT_OK(iree_io_parameter_provider_lookup(
+      provider, IREE_SV("model"), IREE_SV("c"), &archive, &contents));
+  EXPECT_EQ(ToString(contents), "variant_c");
+  IREE_ASSERT_OK(iree_io_parameter_provider_lookup(
+      provider, iree_string_view_empty(), IREE_SV("a"), &archive, &contents));
+  EXPECT_EQ(ToString(contents), "other_a");
+
+  EXPECT_THAT(
+      iree_io_parameter_provider_lookup(provider, iree_string_view_empty(),
+                                        IREE_SV("b"), &archive, &contents),
+      StatusIs(iree::StatusCode::kNotFound));
+  EXPECT_THAT(iree_io_parameter_provider_lookup(provider, IREE_SV("missing"),
+                                                IREE_SV("a"), &archive,
+                                                &contents),
+              StatusIs(iree::StatusCode::kNotFound));
+
+  iree_io_parameter_provider_release(provider);
+}
+
+}  // namespace
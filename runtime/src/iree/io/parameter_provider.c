@@ -0,0 +1,149 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/parameter_provider.h"
+
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/tracing.h"
+
+typedef struct iree_io_parameter_provider_entry_t {
+  // Scope the archive is registered under; stored in the same allocation.
+  iree_string_view_t scope;
+  iree_io_parameter_archive_t* archive;
+} iree_io_parameter_provider_entry_t;
+
+struct iree_io_parameter_provider_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  iree_host_size_t entry_capacity;
+  iree_host_size_t entry_count;
+  iree_io_parameter_provider_entry_t** entries;
+};
+
+IREE_API_EXPORT iree_status_t iree_io_parameter_provider_create(
+    iree_allocator_t host_allocator,
+    iree_io_parameter_provider_t** out_provider) {
+  IREE_ASSERT_ARGUMENT(out_provider);
+  *out_provider = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_io_parameter_provider_t* provider = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*provider),
+                                (void**)&provider));
+  iree_atomic_ref_count_init(&provider->ref_count);
+  provider->host_allocator = host_allocator;
+  provider->entry_capacity = 0;
+  provider->entry_count = 0;
+  provider->entries = NULL;
+
+  *out_provider = provider;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_io_parameter_provider_destroy(
+    iree_io_parameter_provider_t* provider) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = provider->host_allocator;
+  for (iree_host_size_t i = 0; i < provider->entry_count; ++i) {
+    iree_io_parameter_archive_release(provider->entries[i]->archive);
+    iree_allocator_free(host_allocator, provider->entries[i]);
+  }
+  iree_allocator_free(host_allocator, provider->entries);
+  iree_allocator_free(host_allocator, provider);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT void iree_io_parameter_provider_retain(
+    iree_io_parameter_provider_t* provider) {
+  if (IREE_LIKELY(provider)) {
+    iree_atomic_ref_count_inc(&provider->ref_count);
+  }
+}
+
+IREE_API_EXPORT void iree_io_parameter_provider_release(
+    iree_io_parameter_provider_t* provider) {
+  if (IREE_LIKELY(provider) &&
+      iree_atomic_ref_count_dec(&provider->ref_count) == 1) {
+    iree_io_parameter_provider_destroy(provider);
+  }
+}
+
+IREE_API_EXPORT iree_status_t iree_io_parameter_provider_add_archive(
+    iree_io_parameter_provider_t* provider, iree_string_view_t scope,
+    iree_io_parameter_archive_t* archive) {
+  IREE_ASSERT_ARGUMENT(provider);
+  IREE_ASSERT_ARGUMENT(archive);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, scope.data, scope.size);
+
+  if (provider->entry_count == provider->entry_capacity) {
+    iree_host_size_t new_capacity = iree_max(8, provider->entry_capacity * 2);
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_allocator_realloc(provider->host_allocator,
+                                   new_capacity * sizeof(provider->entries[0]),
+                                   (void**)&provider->entries));
+    provider->entry_capacity = new_capacity;
+  }
+
+  iree_io_parameter_provider_entry_t* entry = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(provider->host_allocator,
+                                sizeof(*entry) + scope.size, (void**)&entry));
+  char* scope_storage = (char*)entry + sizeof(*entry);
+  memcpy(scope_storage, scope.data, scope.size);
+  entry->scope = iree_make_string_view(scope_storage, scope.size);
+  entry->archive = archive;
+  iree_io_parameter_archive_retain(archive);
+  provider->entries[provider->entry_count++] = entry;
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_io_parameter_provider_open_archive_file(
+    iree_io_parameter_provider_t* provider, iree_string_view_t scope,
+    iree_string_view_t path) {
+  IREE_ASSERT_ARGUMENT(provider);
+  iree_io_parameter_archive_t* archive = NULL;
+  IREE_RETURN_IF_ERROR(iree_io_parameter_archive_open_file(
+      path, provider->host_allocator, &archive));
+  iree_status_t status =
+      iree_io_parameter_provider_add_archive(provider, scope, archive);
+  iree_io_parameter_archive_release(archive);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_io_parameter_provider_lookup(
+    iree_io_parameter_provider_t* provider, iree_string_view_t scope,
+    iree_string_view_t key, iree_io_parameter_archive_t** out_archive,
+    iree_const_byte_span_t* out_contents) {
+  IREE_ASSERT_ARGUMENT(provider);
+  IREE_ASSERT_ARGUMENT(out_archive);
+  IREE_ASSERT_ARGUMENT(out_contents);
+  *out_archive = NULL;
+  *out_contents = iree_const_byte_span_empty();
+  for (iree_host_size_t i = 0; i < provider->entry_count; ++i) {
+    iree_io_parameter_provider_entry_t* entry = provider->entries[i];
+    if (!iree_string_view_equal(entry->scope, scope)) continue;
+    iree_status_t status =
+        iree_io_parameter_archive_lookup(entry->archive, key, out_contents);
+    if (iree_status_is_ok(status)) {
+      *out_archive = entry->archive;
+      return status;
+    } else if (!iree_status_is_not_found(status)) {
+      return status;
+    }
+    iree_status_ignore(status);
+  }
+  return iree_make_status(IREE_STATUS_NOT_FOUND,
+                          "parameter '%.*s' not found in scope '%.*s'",
+                          (int)key.size, key.data, (int)scope.size,
+                          scope.data);
+}
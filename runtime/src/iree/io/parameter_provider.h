@@ -0,0 +1,71 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_IO_PARAMETER_PROVIDER_H_
+#define IREE_IO_PARAMETER_PROVIDER_H_
+
+#include "iree/base/api.h"
+#include "iree/io/parameter_archive.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_io_parameter_provider_t
+//===----------------------------------------------------------------------===//
+
+// Serves parameters by scope and key from a set of archives.
+//
+// Each archive is registered under a scope (which may be empty) and lookups
+// search the archives of the requested scope in registration order. Multiple
+// archives may share a scope such that common parameters can be split into a
+// shared archive used by several model variants each with their own archive
+// of variant-specific parameters.
+//
+// Providers are expected to be populated once during setup and then shared
+// across any number of modules and contexts. Registration is not thread-safe
+// but lookups may be performed concurrently once populated.
+typedef struct iree_io_parameter_provider_t iree_io_parameter_provider_t;
+
+// Creates an empty parameter provider.
+IREE_API_EXPORT iree_status_t iree_io_parameter_provider_create(
+    iree_allocator_t host_allocator,
+    iree_io_parameter_provider_t** out_provider);
+
+// Retains the given |provider| for the caller.
+IREE_API_EXPORT void iree_io_parameter_provider_retain(
+    iree_io_parameter_provider_t* provider);
+
+// Releases the given |provider| from the caller.
+IREE_API_EXPORT void iree_io_parameter_provider_release(
+    iree_io_parameter_provider_t* provider);
+
+// Registers |archive| under |scope|. The archive is retained by the provider.
+IREE_API_EXPORT iree_status_t iree_io_parameter_provider_add_archive(
+    iree_io_parameter_provider_t* provider, iree_string_view_t scope,
+    iree_io_parameter_archive_t* archive);
+
+// Opens the archive file at |path| and registers it under |scope|.
+IREE_API_EXPORT iree_status_t iree_io_parameter_provider_open_archive_file(
+    iree_io_parameter_provider_t* provider, iree_string_view_t scope,
+    iree_string_view_t path);
+
+// Looks up the parameter with the given |key| in the archives registered under
+// |scope|. Returns the archive containing the parameter in |out_archive|
+// (borrowed; callers must retain it for as long as they use the contents) and
+// a view of the parameter contents in |out_contents|.
+// Returns IREE_STATUS_NOT_FOUND if no archive in the scope has the key.
+IREE_API_EXPORT iree_status_t iree_io_parameter_provider_lookup(
+    iree_io_parameter_provider_t* provider, iree_string_view_t scope,
+    iree_string_view_t key, iree_io_parameter_archive_t** out_archive,
+    iree_const_byte_span_t* out_contents);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_IO_PARAMETER_PROVIDER_H_
@@ -0,0 +1,105 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_IO_TESTING_PARAMETER_ARCHIVE_BUILDER_H_
+#define IREE_IO_TESTING_PARAMETER_ARCHIVE_BUILDER_H_
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/io/parameter_archive.h"
+#include "iree/schemas/parameter_archive.h"
+
+namespace iree {
+namespace io {
+namespace testing {
+
+// Archive contents with storage aligned to the archive data alignment.
+struct ArchiveStorage {
+  std::vector<uint8_t> buffer;
+  uint8_t* data = nullptr;
+  size_t length = 0;
+
+  iree_const_byte_span_t span() const {
+    return iree_make_const_byte_span(data, length);
+  }
+  iree_io_parameter_archive_header_t* header() {
+    return reinterpret_cast<iree_io_parameter_archive_header_t*>(data);
+  }
+  iree_io_parameter_archive_entry_t* entries() {
+    return reinterpret_cast<iree_io_parameter_archive_entry_t*>(
+        data + header()->entry_table_offset);
+  }
+};
+
+// Builds an archive laid out the same way as the compiler emits them.
+inline ArchiveStorage BuildArchive(const std::map<std::string, std::string>& params) {
+  const uint64_t kAlignment = IREE_IO_PARAMETER_ARCHIVE_DATA_ALIGNMENT;
+  auto align = [&](uint64_t value) {
+    return (value + kAlignment - 1) & ~(kAlignment - 1);
+  };
+
+  iree_io_parameter_archive_header_t header = {};
+  header.magic = IREE_IO_PARAMETER_ARCHIVE_MAGIC;
+  header.version = IREE_IO_PARAMETER_ARCHIVE_VERSION;
+  header.entry_count = params.size();
+  header.entry_table_offset = sizeof(header);
+  header.string_table_offset =
+      header.entry_table_offset +
+      params.size() * sizeof(iree_io_parameter_archive_entry_t);
+  std::string string_table;
+  std::vector<iree_io_parameter_archive_entry_t> entries;
+  uint64_t data_length = 0;
+  for (auto& [key, value] : params) {
+    iree_io_parameter_archive_entry_t entry = {};
+    entry.key_offset = string_table.size();
+    entry.key_length = key.size();
+    entry.data_offset = data_length;
+    entry.data_length = value.size();
+    entries.push_back(entry);
+    string_table += key;
+    data_length = align(data_length + value.size());
+  }
+  header.string_table_length = string_table.size();
+  header.data_offset =
+      align(header.string_table_offset + header.string_table_length);
+  header.file_length = header.data_offset + data_length;
+
+  ArchiveStorage storage;
+  storage.buffer.resize(header.file_length + kAlignment);
+  storage.data = reinterpret_cast<uint8_t*>(
+      align(reinterpret_cast<uintptr_t>(storage.buffer.data())));
+  storage.length = header.file_length;
+  std::memcpy(storage.data, &header, sizeof(header));
+  std::memcpy(storage.data + header.entry_table_offset, entries.data(),
+              entries.size() * sizeof(entries[0]));
+  std::memcpy(storage.data + header.string_table_offset, string_table.data(),
+              string_table.size());
+  size_t i = 0;
+  for (auto& [key, value] : params) {
+    std::memcpy(storage.data + header.data_offset + entries[i++].data_offset,
+                value.data(), value.size());
+  }
+  return storage;
+}
+
+inline iree_io_parameter_archive_t* WrapArchive(const ArchiveStorage& storage) {
+  iree_io_parameter_archive_t* archive = NULL;
+  IREE_CHECK_OK(iree_io_parameter_archive_wrap_memory(
+      storage.span(), iree_io_parameter_archive_release_callback_null(),
+      iree_allocator_system(), &archive));
+  return archive;
+}
+
+}  // namespace testing
+}  // namespace io
+}  // namespace iree
+
+#endif  // IREE_IO_TESTING_PARAMETER_ARCHIVE_BUILDER_H_
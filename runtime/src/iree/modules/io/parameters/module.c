@@ -0,0 +1,220 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/modules/io/parameters/module.h"
+
+#include "iree/base/api.h"
+#include "iree/base/tracing.h"
+#include "iree/io/parameter_archive.h"
+#include "iree/vm/api.h"
+
+#define IREE_IO_PARAMETERS_MODULE_VERSION_0_0 0x00000000u
+#define IREE_IO_PARAMETERS_MODULE_VERSION_LATEST \
+  IREE_IO_PARAMETERS_MODULE_VERSION_0_0
+
+//===----------------------------------------------------------------------===//
+// Module type definitions
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_io_parameters_module_t {
+  iree_allocator_t host_allocator;
+  iree_io_parameter_provider_t* provider;
+} iree_io_parameters_module_t;
+
+#define IREE_IO_PARAMETERS_MODULE_CAST(module)        \
+  (iree_io_parameters_module_t*)((uint8_t*)(module) + \
+                                 iree_vm_native_module_size());
+
+// All state lives in the provider shared by every context using the module so
+// there is no per-context module state.
+
+static void IREE_API_PTR iree_io_parameters_module_destroy(void* base_module) {
+  iree_io_parameters_module_t* module =
+      IREE_IO_PARAMETERS_MODULE_CAST(base_module);
+  iree_io_parameter_provider_release(module->provider);
+}
+
+static iree_status_t IREE_API_PTR iree_io_parameters_module_notify(
+    void* self, iree_vm_module_state_t* module_state, iree_vm_signal_t signal) {
+  switch (signal) {
+    case IREE_VM_SIGNAL_SUSPEND:
+    case IREE_VM_SIGNAL_LOW_MEMORY:
+    default:
+      return iree_ok_status();
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Parameter buffers
+//===----------------------------------------------------------------------===//
+
+// Allocator used for the iree_vm_buffer_t headers wrapping parameter contents.
+// Allocations are forwarded to the archive host allocator and the archive
+// reference held by the buffer is released when its header is freed.
+static iree_status_t iree_io_parameters_buffer_allocator_ctl(
+    void* self, iree_allocator_command_t command, const void* params,
+    void** inout_ptr) {
+  iree_io_parameter_archive_t* archive = (iree_io_parameter_archive_t*)self;
+  iree_allocator_t host_allocator =
+      iree_io_parameter_archive_host_allocator(archive);
+  iree_status_t status =
+      host_allocator.ctl(host_allocator.self, command, params, inout_ptr);
+  if (command == IREE_ALLOCATOR_COMMAND_FREE) {
+    iree_io_parameter_archive_release(archive);
+  }
+  return status;
+}
+
+// Wraps the |contents| of a parameter in |archive| in a read-only buffer that
+// keeps the archive (and its mapping) live for as long as the buffer or any
+// HAL buffer imported from it is live.
+static iree_status_t iree_io_parameters_wrap_buffer(
+    iree_io_parameter_archive_t* archive, iree_const_byte_span_t contents,
+    iree_vm_buffer_t** out_buffer) {
+  *out_buffer = NULL;
+  iree_allocator_t buffer_allocator = {
+      .self = archive,
+      .ctl = iree_io_parameters_buffer_allocator_ctl,
+  };
+  iree_vm_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc_aligned(
+      buffer_allocator, sizeof(*buffer), 0, 0, (void**)&buffer));
+  iree_io_parameter_archive_retain(archive);  // released by FREE
+  iree_vm_buffer_initialize(
+      IREE_VM_BUFFER_ACCESS_ORIGIN_HOST,
+      iree_make_byte_span((void*)contents.data, contents.data_length),
+      buffer_allocator, buffer);
+  *out_buffer = buffer;
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Exported functions
+//===----------------------------------------------------------------------===//
+
+IREE_VM_ABI_EXPORT(iree_io_parameters_module_lookup, void, rr, r) {
+  iree_vm_buffer_t* scope = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_buffer_check_deref_or_null(args->r0, &scope));
+  iree_vm_buffer_t* key = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_buffer_check_deref(args->r1, &key));
+  iree_string_view_t scope_str =
+      scope ? iree_vm_buffer_as_string(scope) : iree_string_view_empty();
+  iree_string_view_t key_str = iree_vm_buffer_as_string(key);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, key_str.data, key_str.size);
+
+  iree_io_parameters_module_t* parameters_module =
+      IREE_IO_PARAMETERS_MODULE_CAST(module);
+  iree_io_parameter_archive_t* archive = NULL;
+  iree_const_byte_span_t contents = iree_const_byte_span_empty();
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_io_parameter_provider_lookup(parameters_module->provider, scope_str,
+                                        key_str, &archive, &contents));
+
+  iree_vm_buffer_t* buffer = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_io_parameters_wrap_buffer(archive, contents, &buffer));
+  rets->r0 = iree_vm_buffer_move_ref(buffer);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// VM module interface implementation
+//===----------------------------------------------------------------------===//
+
+// NOTE: this must match the ordering of the iree_io_parameters_module_exports_
+// table.
+static const iree_vm_native_function_ptr_t iree_io_parameters_module_funcs_[] =
+    {
+#define EXPORT_FN(name, target_fn, shim_arg_type, arg_types, ret_types) \
+  {                                                                     \
+      .shim = (iree_vm_native_function_shim_t)                          \
+          iree_vm_shim_##shim_arg_type##_##ret_types,                   \
+      .target = (iree_vm_native_function_target_t)(target_fn),          \
+  },
+#include "iree/modules/io/parameters/exports.inl"  // IWYU pragma: keep
+#undef EXPORT_FN
+};
+
+// NOTE: 0 length, but can't express that in C.
+static const iree_vm_native_import_descriptor_t
+    iree_io_parameters_module_imports_[1];
+
+static const iree_vm_native_export_descriptor_t
+    iree_io_parameters_module_exports_[] = {
+#define EXPORT_FN(name, target_fn, shim_arg_type, arg_types, ret_types) \
+  {                                                                     \
+      .local_name = iree_string_view_literal(name),                     \
+      .calling_convention =                                             \
+          iree_string_view_literal("0" #arg_types "_" #ret_types),      \
+      .attr_count = 0,                                                  \
+      .attrs = NULL,                                                    \
+  },
+#include "iree/modules/io/parameters/exports.inl"  // IWYU pragma: keep
+#undef EXPORT_FN
+};
+static_assert(IREE_ARRAYSIZE(iree_io_parameters_module_funcs_) ==
+                  IREE_ARRAYSIZE(iree_io_parameters_module_exports_),
+              "function pointer table must be 1:1 with exports");
+
+static const iree_vm_native_module_descriptor_t
+    iree_io_parameters_module_descriptor_ = {
+        .name = iree_string_view_literal("io_parameters"),
+        .version = IREE_IO_PARAMETERS_MODULE_VERSION_LATEST,
+        .attr_count = 0,
+        .attrs = NULL,
+        .dependency_count = 0,
+        .dependencies = NULL,
+        .import_count = 0,  // workaround for 0-length C struct
+        .imports = iree_io_parameters_module_imports_,
+        .export_count = IREE_ARRAYSIZE(iree_io_parameters_module_exports_),
+        .exports = iree_io_parameters_module_exports_,
+        .function_count = IREE_ARRAYSIZE(iree_io_parameters_module_funcs_),
+        .functions = iree_io_parameters_module_funcs_,
+};
+
+IREE_API_EXPORT iree_status_t iree_io_parameters_module_create(
+    iree_vm_instance_t* instance, iree_io_parameter_provider_t* provider,
+    iree_allocator_t host_allocator, iree_vm_module_t** out_module) {
+  IREE_ASSERT_ARGUMENT(instance);
+  IREE_ASSERT_ARGUMENT(provider);
+  IREE_ASSERT_ARGUMENT(out_module);
+  *out_module = NULL;
+
+  // Setup the interface with the functions we implement ourselves. Any function
+  // we omit will be handled by the base native module.
+  static const iree_vm_module_t interface = {
+      .destroy = iree_io_parameters_module_destroy,
+      .notify = iree_io_parameters_module_notify,
+  };
+
+  // Allocate shared module state.
+  iree_host_size_t total_size =
+      iree_vm_native_module_size() + sizeof(iree_io_parameters_module_t);
+  iree_vm_module_t* base_module = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(host_allocator, total_size, (void**)&base_module));
+  memset(base_module, 0, total_size);
+  iree_status_t status = iree_vm_native_module_initialize(
+      &interface, &iree_io_parameters_module_descriptor_, instance,
+      host_allocator, base_module);
+  if (!iree_status_is_ok(status)) {
+    iree_allocator_free(host_allocator, base_module);
+    return status;
+  }
+
+  iree_io_parameters_module_t* module =
+      IREE_IO_PARAMETERS_MODULE_CAST(base_module);
+  module->host_allocator = host_allocator;
+  module->provider = provider;
+  iree_io_parameter_provider_retain(provider);
+
+  *out_module = base_module;
+  return iree_ok_status();
+}
@@ -0,0 +1,40 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_MODULES_IO_PARAMETERS_MODULE_H_
+#define IREE_MODULES_IO_PARAMETERS_MODULE_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/io/parameter_provider.h"
+#include "iree/vm/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Creates a module for serving externalized parameters to compiled programs.
+//
+// Programs compiled with parameter archives import `io_parameters.lookup` in
+// place of embedded constants and receive read-only buffers that alias the
+// parameter contents in the archives of |provider|. The buffers retain their
+// archive and are imported by the HAL as constant device buffers without
+// copies when the device can access host memory. Since archives are mapped
+// shared the same pages back all modules, contexts, and processes using the
+// same archive files.
+//
+// The |provider| is retained by the module and may be shared by any number of
+// modules.
+IREE_API_EXPORT iree_status_t iree_io_parameters_module_create(
+    iree_vm_instance_t* instance, iree_io_parameter_provider_t* provider,
+    iree_allocator_t host_allocator, iree_vm_module_t** out_module);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_MODULES_IO_PARAMETERS_MODULE_H_
@@ -0,0 +1,165 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/modules/io/parameters/module.h"
+
+#include <cstring>
+#include <string>
+
+#include "iree/base/api.h"
+#include "iree/io/parameter_archive.h"
+#include "iree/io/parameter_provider.h"
+#include "iree/io/testing/parameter_archive_builder.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+
+namespace iree {
+namespace {
+
+using ::iree::io::testing::ArchiveStorage;
+using ::iree::io::testing::BuildArchive;
+using ::iree::testing::status::StatusIs;
+
+// Runs io_parameters.lookup in a context containing only the parameters
+// module serving a single archive under the `model` scope.
+class ParametersModuleTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                          iree_allocator_system(), &instance_));
+
+    storage_ = BuildArchive({{"weight", "hello"}});
+    iree_io_parameter_archive_release_callback_t release_callback = {
+        +[](void* user_data, iree_const_byte_span_t contents) {
+          ++*reinterpret_cast<int*>(user_data);
+        },
+        &archive_release_count_,
+    };
+    iree_io_parameter_archive_t* archive = nullptr;
+    IREE_CHECK_OK(iree_io_parameter_archive_wrap_memory(
+        storage_.span(), release_callback, iree_allocator_system(), &archive));
+    iree_io_parameter_provider_t* provider = nullptr;
+    IREE_CHECK_OK(
+        iree_io_parameter_provider_create(iree_allocator_system(), &provider));
+    IREE_CHECK_OK(iree_io_parameter_provider_add_archive(
+        provider, IREE_SV("model"), archive));
+    iree_io_parameter_archive_release(archive);
+
+    // The module retains the provider and the context retains the module.
+    iree_vm_module_t* module = nullptr;
+    IREE_CHECK_OK(iree_io_parameters_module_create(
+        instance_, provider, iree_allocator_system(), &module));
+    iree_io_parameter_provider_release(provider);
+    IREE_CHECK_OK(iree_vm_context_create_with_modules(
+        instance_, IREE_VM_CONTEXT_FLAG_NONE, 1, &module,
+        iree_allocator_system(), &context_));
+    iree_vm_module_release(module);
+  }
+
+  void TearDown() override {
+    iree_vm_context_release(context_);
+    iree_vm_instance_release(instance_);
+  }
+
+  // Returns a host buffer containing |value| or a null reference if empty.
+  static vm::ref<iree_vm_buffer_t> MakeStringBuffer(const std::string& value) {
+    vm::ref<iree_vm_buffer_t> buffer;
+    if (value.empty()) return buffer;
+    IREE_CHECK_OK(iree_vm_buffer_create(
+        IREE_VM_BUFFER_ACCESS_ORIGIN_HOST | IREE_VM_BUFFER_ACCESS_MUTABLE,
+        value.size(), /*alignment=*/0, iree_allocator_system(), &buffer));
+    IREE_CHECK_OK(iree_vm_buffer_write_elements(value.data(), buffer.get(), 0,
+                                                value.size(), 1));
+    return buffer;
+  }
+
+  // Calls io_parameters.lookup with |scope| (passed as null when empty) and
+  // |key| and returns the resulting buffer in |out_buffer|.
+  Status Lookup(const std::string& scope, const std::string& key,
+                vm::ref<iree_vm_buffer_t>* out_buffer) {
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(iree_vm_context_resolve_function(
+        context_, IREE_SV("io_parameters.lookup"), &function));
+
+    vm::ref<iree_vm_list_t> inputs;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                             2, iree_allocator_system(),
+                                             &inputs));
+    iree_vm_ref_t scope_ref =
+        iree_vm_buffer_move_ref(MakeStringBuffer(scope).release());
+    IREE_RETURN_IF_ERROR(iree_vm_list_push_ref_move(inputs.get(), &scope_ref));
+    iree_vm_ref_t key_ref =
+        iree_vm_buffer_move_ref(MakeStringBuffer(key).release());
+    IREE_RETURN_IF_ERROR(iree_vm_list_push_ref_move(inputs.get(), &key_ref));
+
+    vm::ref<iree_vm_list_t> outputs;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                             1, iree_allocator_system(),
+                                             &outputs));
+    IREE_RETURN_IF_ERROR(iree_vm_invoke(
+        context_, function, IREE_VM_INVOCATION_FLAG_NONE, /*policy=*/nullptr,
+        inputs.get(), outputs.get(), iree_allocator_system()));
+
+    iree_vm_ref_t result_ref = iree_vm_ref_null();
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_get_ref_retain(outputs.get(), 0, &result_ref));
+    iree_vm_buffer_t* result = nullptr;
+    IREE_RETURN_IF_ERROR(iree_vm_buffer_check_deref(result_ref, &result));
+    *out_buffer = vm::assign_ref(result);
+    return OkStatus();
+  }
+
+  iree_vm_instance_t* instance_ = nullptr;
+  iree_vm_context_t* context_ = nullptr;
+  ArchiveStorage storage_;
+  int archive_release_count_ = 0;
+};
+
+TEST_F(ParametersModuleTest, LookupAliasesArchive) {
+  vm::ref<iree_vm_buffer_t> buffer;
+  IREE_ASSERT_OK(Lookup("model", "weight", &buffer));
+  iree_const_byte_span_t contents = iree_vm_buffer_const_contents(buffer.get());
+  ASSERT_EQ(contents.data_length, 5);
+  EXPECT_EQ(std::memcmp(contents.data, "hello", 5), 0);
+  EXPECT_GE(contents.data, storage_.data);
+  EXPECT_LT(contents.data, storage_.data + storage_.length);
+}
+
+TEST_F(ParametersModuleTest, LookupIsReadOnly) {
+  vm::ref<iree_vm_buffer_t> buffer;
+  IREE_ASSERT_OK(Lookup("model", "weight", &buffer));
+  iree_byte_span_t span;
+  EXPECT_THAT(iree_vm_buffer_map_rw(buffer.get(), 0, 5, 1, &span),
+              StatusIs(StatusCode::kPermissionDenied));
+}
+
+TEST_F(ParametersModuleTest, LookupMissing) {
+  vm::ref<iree_vm_buffer_t> buffer;
+  EXPECT_THAT(Lookup("model", "missing", &buffer),
+              StatusIs(StatusCode::kNotFound));
+  // A null scope selects archives registered without a scope.
+  EXPECT_THAT(Lookup("", "weight", &buffer), StatusIs(StatusCode::kNotFound));
+}
+
+TEST_F(ParametersModuleTest, BufferKeepsArchiveLive) {
+  vm::ref<iree_vm_buffer_t> buffer;
+  IREE_ASSERT_OK(Lookup("model", "weight", &buffer));
+
+  // Dropping the context drops the module and provider but the buffer still
+  // references the archive.
+  iree_vm_context_release(context_);
+  context_ = nullptr;
+  EXPECT_EQ(archive_release_count_, 0);
+  iree_const_byte_span_t contents = iree_vm_buffer_const_contents(buffer.get());
+  EXPECT_EQ(std::memcmp(contents.data, "hello", 5), 0);
+
+  buffer.reset();
+  EXPECT_EQ(archive_release_count_, 1);
+}
+
+}  // namespace
+}  // namespace iree
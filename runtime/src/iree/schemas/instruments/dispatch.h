@@ -68,7 +68,7 @@ typedef enum iree_instrument_dispatch_type_e {
   IREE_INSTRUMENT_DISPATCH_TYPE_WORKGROUP = 0b00000000,
   IREE_INSTRUMENT_DISPATCH_TYPE_PRINT = 0b00000001,
   IREE_INSTRUMENT_DISPATCH_TYPE_VALUE = 0b00000010,
-  IREE_INSTRUMENT_DISPATCH_TYPE_RESERVED_0 = 0b00000011,  // free for use
+  IREE_INSTRUMENT_DISPATCH_TYPE_TIMELINE = 0b00000011,
   IREE_INSTRUMENT_DISPATCH_TYPE_MEMORY_LOAD = 0b00000100,
   IREE_INSTRUMENT_DISPATCH_TYPE_MEMORY_STORE = 0b00000101,
 } iree_instrument_dispatch_type_t;
@@ -105,6 +105,25 @@ typedef struct iree_instrument_dispatch_memory_op_t {
   uint64_t address;
 } iree_instrument_dispatch_memory_op_t;
 
+// Wall-clock interval of one or more consecutive workgroups of a dispatch as
+// executed by a single worker. These are produced by the runtime instead of
+// compiler-inserted instrumentation and always have a fixed size such that a
+// ringbuffer of them never splits a record when it wraps.
+typedef struct iree_instrument_dispatch_timeline_t {
+  uint32_t tag : 8;  // IREE_INSTRUMENT_DISPATCH_TYPE_TIMELINE
+  uint32_t dispatch_id : 24;
+  uint32_t worker_id;
+  // Linearized ID of the first workgroup (x + y * count_x + z * count_x *
+  // count_y) and the total number of workgroups covered by the interval.
+  uint32_t workgroup_index;
+  uint32_t workgroup_count;
+  // Timestamps in the iree_time_t (nanosecond) domain.
+  int64_t begin_time_ns;
+  int64_t end_time_ns;
+} iree_instrument_dispatch_timeline_t;
+static_assert(sizeof(iree_instrument_dispatch_timeline_t) == 32,
+              "timeline records must be fixed-size and 16-byte aligned");
+
 enum iree_instrument_dispatch_value_type_e {
   IREE_INSTRUMENT_DISPATCH_VALUE_TYPE_SINT_8 = 0,
   IREE_INSTRUMENT_DISPATCH_VALUE_TYPE_UINT_8,
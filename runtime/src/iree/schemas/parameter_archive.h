@@ -0,0 +1,82 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_SCHEMAS_PARAMETER_ARCHIVE_H_
+#define IREE_SCHEMAS_PARAMETER_ARCHIVE_H_
+
+#include <stdint.h>
+
+//===----------------------------------------------------------------------===//
+// IREE Parameter Archive (.irpa)
+//===----------------------------------------------------------------------===//
+// A flat indexed file of named parameter blobs designed to be memory mapped.
+// The compiler writes large module constants into an archive instead of
+// embedding them in the module and the runtime serves them by key directly out
+// of the mapped file pages. All fields are little-endian.
+//
+// Layout:
+//   iree_io_parameter_archive_header_t
+//   iree_io_parameter_archive_entry_t[entry_count]  @ entry_table_offset
+//   char[string_table_length]                       @ string_table_offset
+//   <padding>
+//   entry data                                      @ data_offset
+//
+// Entry data is aligned to IREE_IO_PARAMETER_ARCHIVE_DATA_ALIGNMENT such that
+// each parameter starts on its own page and can be imported as a host buffer
+// without copies. Keys are stored in the string table without NUL terminators
+// and entries are sorted by key to allow binary search.
+
+// Archive magic identifier.
+// "IREE Parameter Archive"
+// "IRPA" = 0x49 0x52 0x50 0x41
+#define IREE_IO_PARAMETER_ARCHIVE_MAGIC 0x41505249u
+
+// Current archive format version. Readers must reject other versions.
+#define IREE_IO_PARAMETER_ARCHIVE_VERSION 0u
+
+// Alignment of the data segment and each entry within it in bytes.
+// Matches the common host page size so that entries can be mapped and shared
+// across processes on page boundaries.
+#define IREE_IO_PARAMETER_ARCHIVE_DATA_ALIGNMENT 4096u
+
+// Header at the start of each archive file.
+typedef struct {
+  // Magic header bytes; must be IREE_IO_PARAMETER_ARCHIVE_MAGIC.
+  uint32_t magic;
+  // Format version; must be IREE_IO_PARAMETER_ARCHIVE_VERSION.
+  uint32_t version;
+  // Total number of entries in the entry table.
+  uint64_t entry_count;
+  // Byte offset of the entry table from the start of the file.
+  uint64_t entry_table_offset;
+  // Byte offset of the string table from the start of the file.
+  uint64_t string_table_offset;
+  // Total byte length of the string table.
+  uint64_t string_table_length;
+  // Byte offset of the data segment from the start of the file.
+  uint64_t data_offset;
+  // Total byte length of the file used to validate truncation.
+  uint64_t file_length;
+} iree_io_parameter_archive_header_t;
+static_assert(sizeof(iree_io_parameter_archive_header_t) == 56,
+              "archive header layout is fixed");
+
+// A single named parameter within the archive.
+typedef struct {
+  // Byte offset of the key relative to the start of the string table.
+  uint64_t key_offset;
+  // Byte length of the key.
+  uint64_t key_length;
+  // Byte offset of the entry data relative to the start of the data segment.
+  // Always aligned to IREE_IO_PARAMETER_ARCHIVE_DATA_ALIGNMENT.
+  uint64_t data_offset;
+  // Byte length of the entry data.
+  uint64_t data_length;
+} iree_io_parameter_archive_entry_t;
+static_assert(sizeof(iree_io_parameter_archive_entry_t) == 32,
+              "archive entry layout is fixed");
+
+#endif  // IREE_SCHEMAS_PARAMETER_ARCHIVE_H_
@@ -25,6 +25,20 @@ IREE_FLAG(
     "when latency is the #1 priority (vs. thermals, system-wide scheduling,\n"
     "etc).");
 
+IREE_FLAG(
+    string, task_worker_spin_policy, "fixed",
+    "Policy used to select how long workers spin up to the maximum set by\n"
+    "--task_worker_spin_us= before parking:\n"
+    " 'fixed': always spin for the maximum duration.\n"
+    " 'adaptive': spin only when recent arrivals of work predict that new\n"
+    "   work will arrive before the maximum duration elapses.");
+
+IREE_FLAG(
+    int32_t, task_worker_hot_count, 0,
+    "Number of workers that never park and instead spin until new work\n"
+    "arrives. Each hot worker fully occupies a core even when idle and should\n"
+    "only be used when submission latency is the #1 priority.");
+
 IREE_FLAG(
     int32_t, task_worker_stack_size, 128 * 1024,
     "Minimum size in bytes of each worker thread stack.\n"
@@ -51,6 +65,20 @@ iree_status_t iree_task_executor_options_initialize_from_flags(
   iree_task_executor_options_initialize(out_options);
   out_options->worker_spin_ns =
       (iree_duration_t)FLAG_task_worker_spin_us * 1000;
+  iree_string_view_t spin_policy =
+      iree_make_cstring_view(FLAG_task_worker_spin_policy);
+  if (iree_string_view_equal(spin_policy, IREE_SV("fixed"))) {
+    out_options->worker_spin_policy = IREE_TASK_WORKER_SPIN_POLICY_FIXED;
+  } else if (iree_string_view_equal(spin_policy, IREE_SV("adaptive"))) {
+    out_options->worker_spin_policy = IREE_TASK_WORKER_SPIN_POLICY_ADAPTIVE;
+  } else {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unsupported --task_worker_spin_policy= '%.*s'; "
+                            "expected 'fixed' or 'adaptive'",
+                            (int)spin_policy.size, spin_policy.data);
+  }
+  out_options->worker_hot_count =
+      (iree_host_size_t)iree_max(0, FLAG_task_worker_hot_count);
   out_options->worker_stack_size =
       (iree_host_size_t)FLAG_task_worker_stack_size;
   out_options->worker_local_memory_size =
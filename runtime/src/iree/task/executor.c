@@ -79,6 +79,8 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
   executor->allocator = allocator;
   executor->scheduling_mode = options.scheduling_mode;
   executor->worker_spin_ns = options.worker_spin_ns;
+  executor->worker_spin_policy = options.worker_spin_policy;
+  executor->worker_hot_count = options.worker_hot_count;
   iree_atomic_task_slist_initialize(&executor->incoming_ready_slist);
   iree_slim_mutex_initialize(&executor->coordinator_mutex);
 
@@ -255,6 +257,27 @@ iree_host_size_t iree_task_executor_worker_count(
   return executor->worker_count;
 }
 
+void iree_task_executor_query_statistics(
+    iree_task_executor_t* executor,
+    iree_task_executor_statistics_t* out_statistics) {
+  memset(out_statistics, 0, sizeof(*out_statistics));
+#if IREE_STATISTICS_ENABLE
+  for (iree_host_size_t i = 0; i < executor->worker_count; ++i) {
+    iree_task_worker_t* worker = &executor->workers[i];
+    out_statistics->worker_wait_time_ns += iree_atomic_load_int64(
+        &worker->wait_time_ns, iree_memory_order_relaxed);
+    out_statistics->worker_spin_hit_count += iree_atomic_load_int64(
+        &worker->spin_hit_count, iree_memory_order_relaxed);
+    out_statistics->worker_futex_wake_count += iree_atomic_load_int64(
+        &worker->futex_wake_count, iree_memory_order_relaxed);
+    out_statistics->worker_wake_count +=
+        iree_atomic_load_int64(&worker->wake_count, iree_memory_order_relaxed);
+    out_statistics->worker_wake_latency_ns += iree_atomic_load_int64(
+        &worker->wake_latency_ns, iree_memory_order_relaxed);
+  }
+#endif  // IREE_STATISTICS_ENABLE
+}
+
 iree_event_pool_t* iree_task_executor_event_pool(
     iree_task_executor_t* executor) {
   return executor->event_pool;
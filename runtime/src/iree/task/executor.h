@@ -268,6 +268,20 @@ enum iree_task_scheduling_mode_bits_t {
 };
 typedef uint32_t iree_task_scheduling_mode_t;
 
+// Defines how workers decide how long to spin waiting for new work before
+// parking themselves in the system wait API.
+typedef enum iree_task_worker_spin_policy_e {
+  // Workers spin for up to iree_task_executor_options_t::worker_spin_ns each
+  // time they run out of work.
+  IREE_TASK_WORKER_SPIN_POLICY_FIXED = 0,
+  // Workers track how long they have recently been idle before new work
+  // arrived and only spin when work is predicted to arrive within
+  // iree_task_executor_options_t::worker_spin_ns. Workers that see sparse
+  // arrivals park immediately and stop burning cores while workers that see
+  // bursty arrivals spin just long enough to avoid the system wake latency.
+  IREE_TASK_WORKER_SPIN_POLICY_ADAPTIVE = 1,
+} iree_task_worker_spin_policy_t;
+
 // Options controlling task executor behavior.
 typedef struct iree_task_executor_options_t {
   // Specifies the schedule mode used for worker and workload balancing.
@@ -288,6 +302,16 @@ typedef struct iree_task_executor_options_t {
   // scheduling, and the environment).
   iree_duration_t worker_spin_ns;
 
+  // Policy used to select the spin duration (up to worker_spin_ns) each time a
+  // worker runs out of work.
+  iree_task_worker_spin_policy_t worker_spin_policy;
+
+  // Number of workers (starting from the first) that never park and instead
+  // spin until new work arrives regardless of worker_spin_ns. Keeping a small
+  // number of workers hot bounds the latency of bursty submissions at the cost
+  // of fully occupying their cores. Defaults to 0.
+  iree_host_size_t worker_hot_count;
+
   // Minimum size in bytes of each worker thread stack.
   // The underlying platform may allocate more stack space but _should_
   // guarantee that the available stack space is near this amount. Note that the
@@ -335,6 +359,28 @@ void iree_task_executor_trim(iree_task_executor_t* executor);
 iree_host_size_t iree_task_executor_worker_count(
     iree_task_executor_t* executor);
 
+// Statistics aggregated across all workers of an executor.
+typedef struct iree_task_executor_statistics_t {
+  // Total time workers have spent spinning or sleeping while waiting for work
+  // in nanoseconds. Only available when IREE_STATISTICS_ENABLE is set.
+  int64_t worker_wait_time_ns;
+  // Total number of times workers were woken while spinning.
+  int64_t worker_spin_hit_count;
+  // Total number of times workers were woken after parking in the system wait
+  // API (a futex on most platforms).
+  int64_t worker_futex_wake_count;
+  // Total number of wakes requested by posting work to idle workers and the
+  // total time in nanoseconds between the posts and the workers resuming.
+  int64_t worker_wake_count;
+  int64_t worker_wake_latency_ns;
+} iree_task_executor_statistics_t;
+
+// Queries the statistics aggregated across all workers of |executor|.
+// Values may tear if workers are actively executing.
+void iree_task_executor_query_statistics(
+    iree_task_executor_t* executor,
+    iree_task_executor_statistics_t* out_statistics);
+
 // Returns an iree_event_t pool managed by the executor.
 // Users of the task system should acquire their transient events from this.
 // Long-lived events should be allocated on their own in order to avoid
@@ -0,0 +1,122 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "benchmark/benchmark.h"
+#include "iree/base/api.h"
+#include "iree/task/executor.h"
+
+namespace {
+
+// Number of dispatches submitted back-to-back in each burst.
+constexpr int kBurstLength = 8;
+
+// Number of workers in the executor.
+constexpr iree_host_size_t kWorkerCount = 4;
+
+// Measures end-to-end latency from submission to completion of small dispatches
+// submitted in bursts separated by an idle gap of state.range(0) microseconds.
+// Within a burst workers only go idle for the time it takes the submitter to
+// observe completion and submit again while between bursts they go idle for
+// the full gap. Only the dispatch latency is timed.
+static void BM_BurstyDispatchLatency(
+    benchmark::State& state, iree_task_worker_spin_policy_t spin_policy,
+    iree_duration_t spin_ns, iree_host_size_t hot_count) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(kWorkerCount, &topology);
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_spin_ns = spin_ns;
+  options.worker_spin_policy = spin_policy;
+  options.worker_hot_count = hot_count;
+  iree_task_executor_t* executor = NULL;
+  IREE_CHECK_OK(iree_task_executor_create(options, &topology,
+                                          iree_allocator_system(), &executor));
+  iree_task_topology_deinitialize(&topology);
+
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("bursty"), &scope);
+
+  const auto gap = std::chrono::microseconds(state.range(0));
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {kWorkerCount, 1, 1};
+  int64_t dispatch_count = 0;
+  for (auto _ : state) {
+    iree_duration_t burst_ns = 0;
+    for (int i = 0; i < kBurstLength; ++i) {
+      iree_task_dispatch_t dispatch;
+      iree_task_dispatch_initialize(
+          &scope,
+          iree_task_make_dispatch_closure(
+              [](void* user_context,
+                 const iree_task_tile_context_t* tile_context,
+                 iree_task_submission_t* pending_submission) {
+                return iree_ok_status();
+              },
+              NULL),
+          workgroup_size, workgroup_count, &dispatch);
+      iree_task_fence_t* fence = NULL;
+      IREE_CHECK_OK(
+          iree_task_executor_acquire_fence(executor, &scope, &fence));
+      iree_task_set_completion_task(&dispatch.header, &fence->header);
+
+      const iree_time_t start_time_ns = iree_time_now();
+      iree_task_submission_t submission;
+      iree_task_submission_initialize(&submission);
+      iree_task_submission_enqueue(&submission, &dispatch.header);
+      iree_task_executor_submit(executor, &submission);
+      iree_task_executor_flush(executor);
+      IREE_CHECK_OK(
+          iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+      burst_ns += iree_time_now() - start_time_ns;
+    }
+    dispatch_count += kBurstLength;
+    state.SetIterationTime(burst_ns / 1e9 / kBurstLength);
+    std::this_thread::sleep_for(gap);
+  }
+
+  iree_task_executor_statistics_t statistics;
+  iree_task_executor_query_statistics(executor, &statistics);
+  const int64_t wake_count =
+      statistics.worker_spin_hit_count + statistics.worker_futex_wake_count;
+  state.counters["spin_hit_%"] =
+      wake_count ? 100.0 * statistics.worker_spin_hit_count / wake_count : 0.0;
+  state.counters["wake_latency_us"] =
+      statistics.worker_wake_count ? statistics.worker_wake_latency_ns / 1e3 /
+                                         statistics.worker_wake_count
+                                   : 0.0;
+  state.counters["wait_ms_per_dispatch"] =
+      dispatch_count ? statistics.worker_wait_time_ns / 1e6 / dispatch_count
+                     : 0.0;
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+}
+
+#define IREE_BENCHMARK_BURSTY_DISPATCH_LATENCY(name, ...)             \
+  BENCHMARK_CAPTURE(BM_BurstyDispatchLatency, name, __VA_ARGS__)      \
+      ->ArgName("gap_us")                                             \
+      ->Arg(10)                                                       \
+      ->Arg(1000)                                                     \
+      ->UseManualTime()                                               \
+      ->Unit(benchmark::kMicrosecond)
+
+IREE_BENCHMARK_BURSTY_DISPATCH_LATENCY(park, IREE_TASK_WORKER_SPIN_POLICY_FIXED,
+                                       IREE_DURATION_ZERO, 0);
+IREE_BENCHMARK_BURSTY_DISPATCH_LATENCY(fixed_spin_100us,
+                                       IREE_TASK_WORKER_SPIN_POLICY_FIXED,
+                                       100 * 1000, 0);
+IREE_BENCHMARK_BURSTY_DISPATCH_LATENCY(adaptive_spin_100us,
+                                       IREE_TASK_WORKER_SPIN_POLICY_ADAPTIVE,
+                                       100 * 1000, 0);
+IREE_BENCHMARK_BURSTY_DISPATCH_LATENCY(adaptive_spin_100us_hot_1,
+                                       IREE_TASK_WORKER_SPIN_POLICY_ADAPTIVE,
+                                       100 * 1000, 1);
+
+}  // namespace
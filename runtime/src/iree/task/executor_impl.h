@@ -43,6 +43,13 @@ struct iree_task_executor_t {
   // IREE_DURATION_ZERO is used to disable spinning.
   iree_duration_t worker_spin_ns;
 
+  // Policy used by workers to select how long to spin up to worker_spin_ns.
+  iree_task_worker_spin_policy_t worker_spin_policy;
+
+  // Number of workers (starting from the first) that spin until woken instead
+  // of parking.
+  iree_host_size_t worker_hot_count;
+
   // State used by the work-stealing operations performed by donated threads.
   // This is **NOT SYNCHRONIZED** and relies on the fact that we actually don't
   // much care about the precise selection of workers enough to mind any tears
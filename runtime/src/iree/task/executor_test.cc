@@ -85,11 +85,11 @@ TEST(ExecutorTest, LifetimeStress) {
   iree_task_topology_deinitialize(&topology);
 }
 
-// Tests heavily serialized submission to an executor.
+// Submits a long serialized sequence of calls to an executor created with
+// |options|, waiting for each to complete before submitting the next.
 // This puts pressure on the overheads involved in spilling up threads.
-TEST(ExecutorTest, SubmissionStress) {
-  iree_task_executor_options_t options;
-  iree_task_executor_options_initialize(&options);
+static void RunSubmissionStress(iree_task_executor_options_t options,
+                                iree_task_executor_statistics_t* out_stats) {
   options.worker_local_memory_size = 64 * 1024;
   iree_task_topology_t topology;
   iree_task_topology_initialize_from_group_count(/*group_count=*/4, &topology);
@@ -128,9 +128,40 @@ TEST(ExecutorTest, SubmissionStress) {
     EXPECT_EQ(received_value, i) << "call did not correlate to loop";
   }
 
+  iree_task_executor_query_statistics(executor, out_stats);
   iree_task_scope_deinitialize(&scope);
   iree_task_executor_release(executor);
   iree_task_topology_deinitialize(&topology);
 }
 
+// Tests heavily serialized submission to an executor.
+TEST(ExecutorTest, SubmissionStress) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_executor_statistics_t statistics;
+  RunSubmissionStress(options, &statistics);
+#if IREE_STATISTICS_ENABLE
+  // Without spinning every wake must come from parking.
+  EXPECT_EQ(statistics.worker_spin_hit_count, 0);
+#endif  // IREE_STATISTICS_ENABLE
+}
+
+// Tests heavily serialized submission with workers adapting their spin
+// duration and one worker that never parks.
+TEST(ExecutorTest, SubmissionStressAdaptiveSpin) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_spin_ns = 50 * 1000;
+  options.worker_spin_policy = IREE_TASK_WORKER_SPIN_POLICY_ADAPTIVE;
+  options.worker_hot_count = 1;
+  iree_task_executor_statistics_t statistics;
+  RunSubmissionStress(options, &statistics);
+#if IREE_STATISTICS_ENABLE
+  EXPECT_GT(
+      statistics.worker_spin_hit_count + statistics.worker_futex_wake_count,
+      0);
+  EXPECT_GE(statistics.worker_wake_latency_ns, 0);
+#endif  // IREE_STATISTICS_ENABLE
+}
+
 }  // namespace
@@ -110,6 +110,10 @@ static void iree_task_post_batch_wake_workers(
   // migrations prior to beginning execution.
   iree_task_executor_t* executor = post_batch->executor;
   int wake_count = iree_task_affinity_set_count_ones(wake_mask);
+#if IREE_STATISTICS_ENABLE
+  // Workers measure their wake latency relative to when we began waking.
+  const iree_time_t post_time_ns = wake_count ? iree_time_now() : 0;
+#endif  // IREE_STATISTICS_ENABLE
   int worker_index = 0;
   for (int i = 0; i < wake_count; ++i) {
     int offset = iree_task_affinity_set_count_trailing_zeros(wake_mask);
@@ -122,6 +126,10 @@ static void iree_task_post_batch_wake_workers(
     // atomic load) if a particular worker isn't waiting or it's required to
     // actually wake it and we can't avoid it.
     iree_task_worker_t* worker = &executor->workers[wake_index];
+#if IREE_STATISTICS_ENABLE
+    iree_atomic_store_int64(&worker->wake_post_time_ns, post_time_ns,
+                            iree_memory_order_relaxed);
+#endif  // IREE_STATISTICS_ENABLE
     iree_notification_post(&worker->wake_notification, 1);
   }
 
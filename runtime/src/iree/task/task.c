@@ -513,10 +513,52 @@ static uint32_t iree_task_tile_to_color(
 
 #endif  // IREE_TASK_TRACING_PER_TILE_COLORS
 
+#if IREE_STATISTICS_ENABLE
+
+static void iree_task_dispatch_statistics_add(const iree_atomic_int64_t* source,
+                                              iree_atomic_int64_t* target) {
+  int64_t value = iree_atomic_load_int64((iree_atomic_int64_t*)source,
+                                         iree_memory_order_relaxed);
+  if (value) {
+    iree_atomic_fetch_add_int64(target, value, iree_memory_order_relaxed);
+  }
+}
+
+static void iree_task_dispatch_statistics_max(const iree_atomic_int64_t* source,
+                                              iree_atomic_int64_t* target) {
+  int64_t value = iree_atomic_load_int64((iree_atomic_int64_t*)source,
+                                         iree_memory_order_relaxed);
+  int64_t current = iree_atomic_load_int64(target, iree_memory_order_relaxed);
+  while (value > current &&
+         !iree_atomic_compare_exchange_weak_int64(target, &current, value,
+                                                  iree_memory_order_relaxed,
+                                                  iree_memory_order_relaxed)) {
+    // current updated with the latest value; retry if still larger.
+  }
+}
+
+#endif  // IREE_STATISTICS_ENABLE
+
 void iree_task_dispatch_statistics_merge(
     const iree_task_dispatch_statistics_t* source,
     iree_task_dispatch_statistics_t* target) {
-  // TODO(benvanik): statistics.
+#if IREE_STATISTICS_ENABLE
+  iree_task_dispatch_statistics_add(&source->dispatch_count,
+                                    &target->dispatch_count);
+  iree_task_dispatch_statistics_add(&source->shard_count,
+                                    &target->shard_count);
+  iree_task_dispatch_statistics_add(&source->tile_count, &target->tile_count);
+  iree_task_dispatch_statistics_add(&source->stolen_tile_count,
+                                    &target->stolen_tile_count);
+  iree_task_dispatch_statistics_add(&source->shard_time_ns,
+                                    &target->shard_time_ns);
+  iree_task_dispatch_statistics_max(&source->max_shard_time_ns,
+                                    &target->max_shard_time_ns);
+  iree_task_dispatch_statistics_add(&source->shard_latency_ns,
+                                    &target->shard_latency_ns);
+  iree_task_dispatch_statistics_add(&source->tile_yield_count,
+                                    &target->tile_yield_count);
+#endif  // IREE_STATISTICS_ENABLE
 }
 
 //==============================================================================
@@ -608,6 +650,10 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
   iree_host_size_t worker_count = iree_task_post_batch_worker_count(post_batch);
   iree_host_size_t shard_count =
       iree_min(dispatch_task->tile_count, worker_count);
+#if IREE_STATISTICS_ENABLE
+  dispatch_task->shard_count = (uint32_t)shard_count;
+  dispatch_task->issue_time_ns = iree_time_now();
+#endif  // IREE_STATISTICS_ENABLE
 
   // Compute how many tiles we want each shard to reserve at a time from the
   // larger grid. A higher number reduces overhead and improves locality while
@@ -656,7 +702,17 @@ void iree_task_dispatch_retire(iree_task_dispatch_t* dispatch_task,
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE(z0, dispatch_task->dispatch_id);
 
-  // TODO(benvanik): attach statistics to the tracy zone.
+#if IREE_STATISTICS_ENABLE
+  // Count the dispatch itself so that consumers can compute averages.
+  iree_atomic_store_int64(&dispatch_task->statistics.dispatch_count, 1,
+                          iree_memory_order_relaxed);
+  IREE_TRACE_ZONE_APPEND_VALUE(
+      z0, iree_atomic_load_int64(&dispatch_task->statistics.tile_count,
+                                 iree_memory_order_relaxed));
+  IREE_TRACE_ZONE_APPEND_VALUE(
+      z0, iree_atomic_load_int64(&dispatch_task->statistics.stolen_tile_count,
+                                 iree_memory_order_relaxed));
+#endif  // IREE_STATISTICS_ENABLE
 
   // Merge the statistics from the dispatch into the scope so we can track all
   // of the work without tracking all the dispatches at a global level.
@@ -694,6 +750,52 @@ void iree_task_dispatch_shard_initialize(iree_task_dispatch_t* dispatch_task,
   iree_task_initialize(IREE_TASK_TYPE_DISPATCH_SHARD,
                        dispatch_task->header.scope, &out_task->header);
   iree_task_set_completion_task(&out_task->header, &dispatch_task->header);
+  out_task->reserved_tile_base = 0;
+  out_task->reserved_tile_end = 0;
+  out_task->has_continuation = false;
+  out_task->suspended_tile_count = 0;
+#if IREE_STATISTICS_ENABLE
+  out_task->start_time_ns = 0;
+  out_task->execution_time_ns = 0;
+  out_task->completed_tile_count = 0;
+#endif  // IREE_STATISTICS_ENABLE
+}
+
+// Executes (or resumes) the tile at the linearized |tile_index| in the grid
+// with the given |storage|. Returns the status of the tile which may be
+// IREE_STATUS_DEFERRED if the tile yielded.
+static iree_status_t iree_task_dispatch_shard_execute_tile(
+    iree_task_dispatch_t* dispatch_task, uint32_t tile_index,
+    iree_task_tile_storage_t* storage, iree_task_tile_context_t* tile_context,
+    iree_task_submission_t* pending_submission) {
+  // TODO(benvanik): faster math here, especially knowing we pull off N
+  // sequential indices per reservation.
+  uint32_t tile_i = tile_index;
+  tile_context->workgroup_xyz[0] = tile_i % tile_context->workgroup_count[0];
+  tile_i /= tile_context->workgroup_count[0];
+  tile_context->workgroup_xyz[1] = tile_i % tile_context->workgroup_count[1];
+  tile_i /= tile_context->workgroup_count[1];
+  tile_context->workgroup_xyz[2] = tile_i;
+  tile_context->storage = storage;
+
+  IREE_TRACE_ZONE_BEGIN_NAMED(z_tile, "iree_task_dispatch_shard_execute_tile");
+  IREE_TRACE_ZONE_SET_COLOR(z_tile, iree_task_tile_to_color(tile_context));
+
+#ifndef NDEBUG
+  // NOTE: these are useful for debugging but dramatically increase our
+  // cost here; only enable if needed for tracking work distribution:
+  IREE_TRACE_ZONE_APPEND_VALUE(z_tile, tile_context->workgroup_xyz[0]);
+  IREE_TRACE_ZONE_APPEND_VALUE(z_tile, tile_context->workgroup_xyz[1]);
+  IREE_TRACE_ZONE_APPEND_VALUE(z_tile, tile_context->workgroup_xyz[2]);
+  // IREE_TRACE_ZONE_APPEND_VALUE(z_tile, (uint64_t)task->closure.fn);
+#endif  // !NDEBUG
+
+  iree_status_t status =
+      dispatch_task->closure.fn(dispatch_task->closure.user_context,
+                                tile_context, pending_submission);
+
+  IREE_TRACE_ZONE_END(z_tile);
+  return status;
 }
 
 iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
@@ -710,17 +812,26 @@ iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
   return shard_task;
 }
 
-void iree_task_dispatch_shard_execute(
+bool iree_task_dispatch_shard_execute(
     iree_task_dispatch_shard_t* task, iree_cpu_processor_id_t processor_id,
     uint32_t worker_id, iree_byte_span_t worker_local_memory,
-    iree_task_submission_t* pending_submission) {
+    iree_task_submission_t* pending_submission,
+    iree_task_dispatch_shard_t** out_continuation_task) {
   IREE_TRACE_ZONE_BEGIN(z0);
+  *out_continuation_task = NULL;
 
   iree_task_dispatch_t* dispatch_task = iree_task_dispatch_shard_parent(task);
   IREE_TRACE_ZONE_APPEND_VALUE(z0, dispatch_task->dispatch_id);
   IREE_TRACE_ZONE_SET_COLOR(
       z0, iree_math_ptr_to_xrgb(dispatch_task->closure.user_context));
 
+#if IREE_STATISTICS_ENABLE
+  const iree_time_t shard_start_time_ns = iree_time_now();
+  if (!task->start_time_ns) task->start_time_ns = shard_start_time_ns;
+  uint32_t shard_tile_count = 0;
+  uint32_t shard_yield_count = 0;
+#endif  // IREE_STATISTICS_ENABLE
+
   // Map only the requested amount of worker local memory into the tile context.
   // This ensures that how much memory is used by some executions does not
   // inadvertently leak over into other executions.
@@ -735,7 +846,7 @@ void iree_task_dispatch_shard_execute(
                          worker_local_memory.data_length));
     iree_task_retire(&task->header, pending_submission, iree_ok_status());
     IREE_TRACE_ZONE_END(z0);
-    return;
+    return true;
   }
   iree_byte_span_t local_memory = iree_make_byte_span(
       worker_local_memory.data, dispatch_task->local_memory_size);
@@ -746,8 +857,6 @@ void iree_task_dispatch_shard_execute(
          sizeof(tile_context.workgroup_size));
   memcpy(&tile_context.workgroup_count, dispatch_task->workgroup_count.value,
          sizeof(tile_context.workgroup_count));
-  uint32_t workgroup_count_x = tile_context.workgroup_count[0];
-  uint32_t workgroup_count_y = tile_context.workgroup_count[1];
   tile_context.worker_id = worker_id;
   tile_context.local_memory = local_memory;
 
@@ -761,66 +870,174 @@ void iree_task_dispatch_shard_execute(
   // Hint as to which processor we are running on.
   tile_context.processor_id = processor_id;
 
-  // Loop over all tiles until they are all processed.
   const uint32_t tile_count = dispatch_task->tile_count;
   const uint32_t tiles_per_reservation = dispatch_task->tiles_per_reservation;
-  // relaxed order because we only care about atomic increments, not about
-  // ordering of tile_index accesses w.r.t. other memory accesses.
-  uint32_t tile_base = iree_atomic_fetch_add_int32(&dispatch_task->tile_index,
-                                                   tiles_per_reservation,
-                                                   iree_memory_order_relaxed);
-  while (tile_base < tile_count) {
-    const uint32_t tile_range =
-        iree_min(tile_base + tiles_per_reservation, tile_count);
-    for (uint32_t tile_index = tile_base; tile_index < tile_range;
-         ++tile_index) {
-      // TODO(benvanik): faster math here, especially knowing we pull off N
-      // sequential indices per reservation.
-      uint32_t tile_i = tile_index;
-      tile_context.workgroup_xyz[0] = tile_i % workgroup_count_x;
-      tile_i /= workgroup_count_x;
-      tile_context.workgroup_xyz[1] = tile_i % workgroup_count_y;
-      tile_i /= workgroup_count_y;
-      tile_context.workgroup_xyz[2] = tile_i;
-
-      IREE_TRACE_ZONE_BEGIN_NAMED(z_tile,
-                                  "iree_task_dispatch_shard_execute_tile");
-      IREE_TRACE_ZONE_SET_COLOR(z_tile, iree_task_tile_to_color(&tile_context));
-
-#ifndef NDEBUG
-      // NOTE: these are useful for debugging but dramatically increase our
-      // cost here; only enable if needed for tracking work distribution:
-      IREE_TRACE_ZONE_APPEND_VALUE(z_tile, tile_context.workgroup_xyz[0]);
-      IREE_TRACE_ZONE_APPEND_VALUE(z_tile, tile_context.workgroup_xyz[1]);
-      IREE_TRACE_ZONE_APPEND_VALUE(z_tile, tile_context.workgroup_xyz[2]);
-      // IREE_TRACE_ZONE_APPEND_VALUE(z_tile, (uint64_t)task->closure.fn);
-#endif  // !NDEBUG
-
-      iree_status_t status =
-          dispatch_task->closure.fn(dispatch_task->closure.user_context,
-                                    &tile_context, pending_submission);
 
-      IREE_TRACE_ZONE_END(z_tile);
-
-      // If any tile fails we bail early from the loop. This doesn't match
-      // what an accelerator would do but saves some unneeded work.
-      // Note that other shards may have completed execution, be executing
-      // concurrently with this one, or still be pending - this does not
-      // have any influence on them and they may continue to execute even
-      // after we bail from here.
+  // Resume any tiles that yielded in a prior execution of the shard. If the
+  // dispatch has failed they are dropped as whatever they were waiting on may
+  // never happen.
+  bool is_aborted = false;
+  if (task->suspended_tile_count > 0) {
+    is_aborted = iree_atomic_load_intptr(&dispatch_task->status,
+                                         iree_memory_order_acquire) != 0;
+    uint32_t remaining_count = 0;
+    for (uint32_t i = 0; !is_aborted && i < task->suspended_tile_count; ++i) {
+      iree_task_dispatch_suspended_tile_t* tile = &task->suspended_tiles[i];
+      iree_status_t status = iree_task_dispatch_shard_execute_tile(
+          dispatch_task, tile->tile_index, &tile->storage, &tile_context,
+          pending_submission);
+      if (iree_status_is_deferred(status)) {
+        // Still waiting; keep the suspended tiles in the order they yielded.
+#if IREE_STATISTICS_ENABLE
+        ++shard_yield_count;
+#endif  // IREE_STATISTICS_ENABLE
+        if (i != remaining_count) {
+          memcpy(&task->suspended_tiles[remaining_count], tile, sizeof(*tile));
+        }
+        ++remaining_count;
+        continue;
+      }
+#if IREE_STATISTICS_ENABLE
+      ++shard_tile_count;
+#endif  // IREE_STATISTICS_ENABLE
       if (!iree_status_is_ok(status)) {
-        // Propagate failures to the dispatch task.
         iree_task_try_set_status(&dispatch_task->status, status);
-        goto abort_shard;  // out of the while-for nest
+        is_aborted = true;
+      }
+    }
+    task->suspended_tile_count = remaining_count;
+  }
+
+  // Loop over all tiles until they are all processed or we run out of space
+  // to hold tiles that yield.
+  uint32_t tile_base = task->reserved_tile_base;
+  uint32_t tile_end = task->reserved_tile_end;
+  while (!is_aborted && task->suspended_tile_count <
+                            IREE_TASK_DISPATCH_MAX_SUSPENDED_TILES_PER_SHARD) {
+    if (tile_base == tile_end) {
+      // Try to grab the next slice of tiles unless the grid was already
+      // exhausted during a prior execution of the shard.
+      if (tile_base >= tile_count) break;
+      // relaxed order because we only care about atomic increments, not about
+      // ordering of tile_index accesses w.r.t. other memory accesses.
+      tile_base = iree_atomic_fetch_add_int32(&dispatch_task->tile_index,
+                                              tiles_per_reservation,
+                                              iree_memory_order_relaxed);
+      if (tile_base >= tile_count) {
+        tile_base = tile_end = tile_count;
+        break;
+      }
+      tile_end = iree_min(tile_base + tiles_per_reservation, tile_count);
+    }
+
+    // Execute the tile directly in the next suspended tile slot so that if it
+    // yields its storage is already where it needs to be.
+    iree_task_dispatch_suspended_tile_t* tile =
+        &task->suspended_tiles[task->suspended_tile_count];
+    tile->tile_index = tile_base++;
+    tile->storage.resume_point = 0;
+    iree_status_t status = iree_task_dispatch_shard_execute_tile(
+        dispatch_task, tile->tile_index, &tile->storage, &tile_context,
+        pending_submission);
+    if (iree_status_is_deferred(status)) {
+#if IREE_STATISTICS_ENABLE
+      ++shard_yield_count;
+#endif  // IREE_STATISTICS_ENABLE
+      ++task->suspended_tile_count;
+      continue;
+    }
+#if IREE_STATISTICS_ENABLE
+    ++shard_tile_count;
+#endif  // IREE_STATISTICS_ENABLE
+
+    // If any tile fails we bail early from the loop. This doesn't match
+    // what an accelerator would do but saves some unneeded work.
+    // Note that other shards may have completed execution, be executing
+    // concurrently with this one, or still be pending - this does not
+    // have any influence on them and they may continue to execute even
+    // after we bail from here.
+    if (!iree_status_is_ok(status)) {
+      // Propagate failures to the dispatch task.
+      iree_task_try_set_status(&dispatch_task->status, status);
+      is_aborted = true;
+    }
+  }
+  if (!is_aborted && task->suspended_tile_count ==
+                         IREE_TASK_DISPATCH_MAX_SUSPENDED_TILES_PER_SHARD) {
+    // All suspended tile slots are full. The suspended tiles may be waiting on
+    // tiles that have not yet started (either reserved by us or still in the
+    // grid) and no other shard may be around to run them (such as when there
+    // is a single worker). Fork a continuation that takes over our unstarted
+    // reservation and keeps pulling from the grid. We only need one
+    // continuation pulling from the grid per shard: it forks its own when it
+    // fills up.
+    const bool has_unstarted_tiles = tile_base != tile_end;
+    const bool has_remaining_tiles =
+        !task->has_continuation &&
+        (uint32_t)iree_atomic_load_int32(&dispatch_task->tile_index,
+                                         iree_memory_order_relaxed) <
+            tile_count;
+    if (has_unstarted_tiles || has_remaining_tiles) {
+      iree_task_dispatch_shard_t* continuation_task =
+          iree_task_dispatch_shard_allocate(dispatch_task, task->header.pool);
+      if (continuation_task) {
+        continuation_task->reserved_tile_base = tile_base;
+        continuation_task->reserved_tile_end = tile_end;
+        tile_base = tile_end;
+        task->has_continuation = true;
+        *out_continuation_task = continuation_task;
+      } else {
+        iree_task_try_set_status(
+            &dispatch_task->status,
+            iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                             "unable to allocate a continuation shard for "
+                             "suspended tiles"));
+        is_aborted = true;
       }
     }
+  }
+  if (is_aborted) {
+    // Drop all remaining work in the shard; the dispatch has failed.
+    task->suspended_tile_count = 0;
+    tile_base = tile_end = tile_count;
+  }
+  task->reserved_tile_base = tile_base;
+  task->reserved_tile_end = tile_end;
+
+  // If any tiles are still suspended we'll need to be executed again.
+  const bool is_complete = task->suspended_tile_count == 0;
 
-    // Try to grab the next slice of tiles.
-    tile_base = iree_atomic_fetch_add_int32(&dispatch_task->tile_index,
-                                            tiles_per_reservation,
-                                            iree_memory_order_relaxed);
+#if IREE_STATISTICS_ENABLE
+  task->execution_time_ns += iree_time_now() - shard_start_time_ns;
+  task->completed_tile_count += shard_tile_count;
+  iree_atomic_store_int64(&shard_statistics.tile_yield_count, shard_yield_count,
+                          iree_memory_order_relaxed);
+  if (is_complete) {
+    // Shards beyond their even share of the grid picked up tiles that other
+    // shards did not get to in time.
+    const uint32_t shard_count = iree_max(1u, dispatch_task->shard_count);
+    const uint32_t even_share = (tile_count + shard_count - 1) / shard_count;
+    const uint32_t completed_tile_count = task->completed_tile_count;
+    const int64_t shard_time_ns = task->execution_time_ns;
+    iree_atomic_store_int64(&shard_statistics.shard_count, 1,
+                            iree_memory_order_relaxed);
+    iree_atomic_store_int64(&shard_statistics.tile_count, completed_tile_count,
+                            iree_memory_order_relaxed);
+    iree_atomic_store_int64(&shard_statistics.stolen_tile_count,
+                            completed_tile_count > even_share
+                                ? completed_tile_count - even_share
+                                : 0,
+                            iree_memory_order_relaxed);
+    iree_atomic_store_int64(&shard_statistics.shard_time_ns, shard_time_ns,
+                            iree_memory_order_relaxed);
+    iree_atomic_store_int64(&shard_statistics.max_shard_time_ns, shard_time_ns,
+                            iree_memory_order_relaxed);
+    iree_atomic_store_int64(
+        &shard_statistics.shard_latency_ns,
+        iree_max(0, task->start_time_ns - dispatch_task->issue_time_ns),
+        iree_memory_order_relaxed);
   }
-abort_shard:
+#endif  // IREE_STATISTICS_ENABLE
 
   // Push aggregate statistics up to the dispatch.
   // Note that we may have partial information here if we errored out of the
@@ -828,8 +1045,14 @@ abort_shard:
   iree_task_dispatch_statistics_merge(&shard_statistics,
                                       &dispatch_task->statistics);
 
+  if (!is_complete) {
+    IREE_TRACE_ZONE_END(z0);
+    return false;
+  }
+
   // NOTE: even if an error was hit we retire OK - the error has already been
   // propagated to the dispatch and it'll clean up after all shards are joined.
   iree_task_retire(&task->header, pending_submission, iree_ok_status());
   IREE_TRACE_ZONE_END(z0);
+  return true;
 }
@@ -17,6 +17,7 @@
 #include "iree/base/internal/cpu.h"
 #include "iree/base/internal/synchronization.h"
 #include "iree/task/affinity_set.h"
+#include "iree/task/tuning.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -492,10 +493,35 @@ void iree_task_wait_set_wait_any(iree_task_wait_t* task,
 // generic ones like 'l2 cache misses' or 'ipc') then we can sprinkle in some
 // #ifdefs.
 typedef struct iree_task_dispatch_statistics_t {
-  // TODO(benvanik): statistics counters.
   // NOTE: each of these increases the command buffer storage requirements; we
   // should always guard these with IREE_STATISTICS_ENABLE.
+#if IREE_STATISTICS_ENABLE
+  // Total number of dispatches that have retired.
+  iree_atomic_int64_t dispatch_count;
+  // Total number of shards executed across all dispatches.
+  iree_atomic_int64_t shard_count;
+  // Total number of tiles (workgroups) executed across all shards.
+  iree_atomic_int64_t tile_count;
+  // Number of tiles executed by shards beyond their even share of the
+  // dispatch grid. A high ratio relative to tile_count indicates that some
+  // shards started late or ran slow and others picked up their work.
+  iree_atomic_int64_t stolen_tile_count;
+  // Total wall time spent executing shards in nanoseconds.
+  iree_atomic_int64_t shard_time_ns;
+  // Longest wall time of any single shard in nanoseconds. Compared against
+  // the average shard time this indicates load imbalance.
+  iree_atomic_int64_t max_shard_time_ns;
+  // Total time between dispatches being issued and their shards beginning
+  // execution in nanoseconds. This includes time workers spent idle, spinning,
+  // or waking and is dominated by oversharding when shards queue up behind one
+  // another.
+  iree_atomic_int64_t shard_latency_ns;
+  // Total number of times tiles yielded by returning
+  // iree_task_tile_yield_status and were later resumed.
+  iree_atomic_int64_t tile_yield_count;
+#else
   iree_atomic_int32_t reserved;
+#endif  // IREE_STATISTICS_ENABLE
 } iree_task_dispatch_statistics_t;
 
 // Merges statistics from |source| to |target| atomically per-field.
@@ -505,22 +531,36 @@ void iree_task_dispatch_statistics_merge(
     const iree_task_dispatch_statistics_t* source,
     iree_task_dispatch_statistics_t* target);
 
+// Storage preserved across suspensions of a tile.
+//
+// Tiles may yield by returning iree_task_tile_yield_status after recording
+// where to resume and any live state they need in their storage. The worker is
+// then free to execute other tiles and tasks and the tile will be invoked again
+// later with the same workgroup_xyz and storage. This is a stackless coroutine:
+// locals and worker local memory are not preserved and tiles must be written
+// as state machines switching on the resume_point (or via a compiler
+// coroutine lowering that spills its frame here).
+//
+// If we get real compiler coroutines we'd ideally have a fixed coroutine
+// storage size per dispatch (via @llvm.coro.size) such that we can
+// preallocate all of the storage for a dispatch in one shot.
 typedef struct iree_task_tile_storage_t {
-  // TODO(benvanik): coroutine storage.
-  // Ideally we'll be able to have a fixed coroutine storage size per dispatch
-  // (via @llvm.coro.size) such that we can preallocate all of the storage for
-  // a dispatch in one shot. If we need to do dynamic allocation we will need a
-  // ringbuffer or other kind of pool to allocate from on-demand.
+  // Tile-defined resume point. Always 0 when a tile is first invoked and
+  // preserved as set by the tile when it yields.
+  uint32_t resume_point;
   uint32_t reserved;
+  // Tile-defined state preserved while the tile is suspended. Contents are
+  // undefined when a tile is first invoked.
+  uint64_t state[IREE_TASK_TILE_STORAGE_STATE_COUNT];
 } iree_task_tile_storage_t;
 
 // Per-tile context provided to each dispatch function invocation in the grid.
 // This information is unique to the tile being dispatched and may contain
 // specific state about the calling thread/fiber/etc.
 //
-// If tile execution is suspended by hitting a coroutine suspend point then the
-// coroutine state will be stored within the tile context until the tile is
-// resumed.
+// If tile execution is suspended by yielding then the tile state will be
+// stored within the tile storage until the tile is resumed. Resumed tiles may
+// execute on a different worker (and processor) than the one they yielded on.
 typedef iree_alignas(iree_max_align_t) struct {
   // Workgroup ID for the current invocation.
   uint32_t workgroup_xyz[3];
@@ -541,9 +581,12 @@ typedef iree_alignas(iree_max_align_t) struct {
 
   // Tile-local memory that is pinned to each worker ensuring no cache
   // thrashing. Aligned to at least the natural pointer size of the machine.
-  // Contents are (today) undefined upon entry.
+  // Contents are (today) undefined upon entry, including upon resuming.
   iree_byte_span_t local_memory;
 
+  // Storage preserved for the tile if it yields.
+  iree_task_tile_storage_t* storage;
+
   // Shared statistics counters for the dispatch shard.
   iree_task_dispatch_statistics_t* statistics;
 } iree_task_tile_context_t;
@@ -558,6 +601,19 @@ typedef iree_status_t(IREE_API_PTR* iree_task_dispatch_closure_fn_t)(
     void* user_context, const iree_task_tile_context_t* tile_context,
     iree_task_submission_t* pending_submission);
 
+// Returns a status that when returned from a dispatch function suspends the
+// tile. The tile will be invoked again with the same workgroup and storage
+// after the worker has had a chance to execute other tiles and tasks.
+//
+// Yielding allows a tile to wait on work performed by other tiles or tasks
+// (such as a producer in a pipeline between dispatches) without blocking the
+// worker it runs on. Each shard can hold at most
+// IREE_TASK_DISPATCH_MAX_SUSPENDED_TILES_PER_SHARD suspended tiles and stops
+// starting new tiles while full.
+static inline iree_status_t iree_task_tile_yield_status(void) {
+  return iree_status_from_code(IREE_STATUS_DEFERRED);
+}
+
 // A function closure representing the function to call and its arguments.
 typedef struct iree_task_dispatch_closure_t {
   // Function called per tile invocation.
@@ -653,6 +709,13 @@ typedef iree_alignas(iree_max_align_t) struct iree_task_dispatch_t {
   // per shard instead of once per slice and are less of a concern.
   iree_atomic_int32_t tile_index;
 
+#if IREE_STATISTICS_ENABLE
+  // Number of shards the dispatch was split into when issued.
+  uint32_t shard_count;
+  // Time the dispatch was issued and its shards posted to workers.
+  iree_time_t issue_time_ns;
+#endif  // IREE_STATISTICS_ENABLE
+
   // Incrementing process-lifetime dispatch identifier.
   IREE_TRACE(int64_t dispatch_id;)
 } iree_task_dispatch_t;
@@ -672,12 +735,46 @@ void iree_task_dispatch_initialize_indirect(
 // IREE_TASK_TYPE_DISPATCH_SHARD
 //==============================================================================
 
+// A tile that yielded and is waiting to be resumed by its shard.
+typedef struct iree_task_dispatch_suspended_tile_t {
+  // Linearized index of the tile in the dispatch grid.
+  uint32_t tile_index;
+  // Storage preserved across suspensions of the tile.
+  iree_task_tile_storage_t storage;
+} iree_task_dispatch_suspended_tile_t;
+
 typedef iree_alignas(iree_max_align_t) struct {
   // Task header: implementation detail, do not use.
   iree_task_t header;
 
   // NOTE: the parent dispatch task this shard is applied to is in the
   // header.completion_task field.
+
+  // Range of tiles reserved from the dispatch grid that have not yet started.
+  // Only non-empty if the shard suspended itself before it could start them or
+  // if the range was handed off to the shard as a continuation.
+  uint32_t reserved_tile_base;
+  uint32_t reserved_tile_end;
+
+  // True if the shard has forked a continuation to keep pulling tiles from the
+  // dispatch grid while its own suspended tile slots were full.
+  bool has_continuation;
+
+  // Tiles that have yielded and must be resumed before the shard can retire.
+  // Shards with suspended tiles are themselves suspended by the worker
+  // executing them and resumed once the worker has executed other work.
+  uint32_t suspended_tile_count;
+  iree_task_dispatch_suspended_tile_t
+      suspended_tiles[IREE_TASK_DISPATCH_MAX_SUSPENDED_TILES_PER_SHARD];
+
+#if IREE_STATISTICS_ENABLE
+  // Time the shard first began executing.
+  iree_time_t start_time_ns;
+  // Total time spent executing the shard across all resumptions.
+  iree_duration_t execution_time_ns;
+  // Total number of tiles completed by the shard across all resumptions.
+  uint32_t completed_tile_count;
+#endif  // IREE_STATISTICS_ENABLE
 } iree_task_dispatch_shard_t;
 
 void iree_task_dispatch_shard_initialize(iree_task_dispatch_t* dispatch_task,
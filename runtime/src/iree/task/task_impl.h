@@ -111,6 +111,17 @@ iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
 // May block the caller for an indeterminate amount of time and should only be
 // called from threads owned by or donated to the executor.
 //
+// Returns true if the shard retired. If any tiles yielded and are still
+// suspended returns false and the caller must execute the shard again later
+// after giving other work a chance to run. The shard may be executed again on
+// any thread owned by the executor.
+//
+// If the shard fills all of its suspended tile slots while work remains in the
+// grid it forks a continuation shard to take over the tiles it has not yet
+// started; those tiles may be what its suspended tiles are waiting on. The
+// continuation is returned in |out_continuation_task| and must be enqueued by
+// the caller. It is NULL if no continuation was forked.
+//
 // |processor_id| is a guess as to which logical processor the shard is
 // executing on. It may be out of date or 0 if the processor could not be
 // queried.
@@ -120,10 +131,11 @@ iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
 //
 // Errors are propagated to the parent scope and the dispatch will fail once
 // all shards have completed.
-void iree_task_dispatch_shard_execute(
+bool iree_task_dispatch_shard_execute(
     iree_task_dispatch_shard_t* task, iree_cpu_processor_id_t processor_id,
     uint32_t worker_id, iree_byte_span_t worker_local_memory,
-    iree_task_submission_t* pending_submission);
+    iree_task_submission_t* pending_submission,
+    iree_task_dispatch_shard_t** out_continuation_task);
 
 #ifdef __cplusplus
 }  // extern "C"
@@ -113,6 +113,34 @@ TEST_F(TaskDispatchTest, Issue345) {
   DispatchAndVerifyGrid(kWorkgroupSize, kWorkgroupCount, IREE_TASK_FLAG_NONE);
 }
 
+#if IREE_STATISTICS_ENABLE
+TEST_F(TaskDispatchTest, IssueStatistics) {
+  IREE_TRACE_SCOPE();
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {3, 4, 5};
+  DispatchAndVerifyGrid(kWorkgroupSize, kWorkgroupCount, IREE_TASK_FLAG_NONE);
+
+  // Dispatch statistics are merged into the scope when the dispatch retires.
+  iree_task_dispatch_statistics_t* statistics = &scope_.dispatch_statistics;
+  EXPECT_EQ(iree_atomic_load_int64(&statistics->dispatch_count,
+                                   iree_memory_order_relaxed),
+            1);
+  EXPECT_EQ(iree_atomic_load_int64(&statistics->tile_count,
+                                   iree_memory_order_relaxed),
+            3 * 4 * 5);
+  EXPECT_GE(iree_atomic_load_int64(&statistics->shard_count,
+                                   iree_memory_order_relaxed),
+            1);
+  EXPECT_LT(iree_atomic_load_int64(&statistics->stolen_tile_count,
+                                   iree_memory_order_relaxed),
+            3 * 4 * 5);
+  EXPECT_GE(iree_atomic_load_int64(&statistics->shard_time_ns,
+                                   iree_memory_order_relaxed),
+            iree_atomic_load_int64(&statistics->max_shard_time_ns,
+                                   iree_memory_order_relaxed));
+}
+#endif  // IREE_STATISTICS_ENABLE
+
 TEST_F(TaskDispatchTest, IssueIndirect) {
   IREE_TRACE_SCOPE();
 
@@ -214,4 +242,235 @@ TEST_F(TaskDispatchTest, IssueFailureChained) {
               StatusIs(StatusCode::kDataLoss));
 }
 
+TEST_F(TaskDispatchTest, IssueYielding) {
+  IREE_TRACE_SCOPE();
+
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {3, 4, 5};
+  GridCoverage coverage(kWorkgroupCount);
+
+  // Each tile yields 3 times before covering its slot and checks that its
+  // state is preserved across each yield.
+  auto tile = [](void* user_context,
+                 const iree_task_tile_context_t* tile_context,
+                 iree_task_submission_t* pending_submission) -> iree_status_t {
+    IREE_TRACE_SCOPE();
+    iree_task_tile_storage_t* storage = tile_context->storage;
+    const uint64_t tile_id = (uint64_t)tile_context->workgroup_xyz[0] |
+                             ((uint64_t)tile_context->workgroup_xyz[1] << 16) |
+                             ((uint64_t)tile_context->workgroup_xyz[2] << 32);
+    if (storage->resume_point == 0) {
+      storage->state[0] = tile_id;
+    } else if (storage->state[0] != tile_id) {
+      return iree_make_status(IREE_STATUS_DATA_LOSS, "tile state corrupted");
+    }
+    if (storage->resume_point < 3) {
+      ++storage->resume_point;
+      return iree_task_tile_yield_status();
+    }
+    return GridCoverage::Tile(user_context, tile_context, pending_submission);
+  };
+
+  iree_task_dispatch_t task;
+  iree_task_dispatch_initialize(
+      &scope_, iree_task_make_dispatch_closure(tile, (void*)&coverage),
+      kWorkgroupSize, kWorkgroupCount, &task);
+  IREE_ASSERT_OK(SubmitTasksAndWaitIdle(&task.header, &task.header));
+  IREE_EXPECT_OK(iree_task_scope_consume_status(&scope_));
+  EXPECT_TRUE(coverage.Verify());
+
+#if IREE_STATISTICS_ENABLE
+  iree_task_dispatch_statistics_t* statistics = &scope_.dispatch_statistics;
+  EXPECT_EQ(iree_atomic_load_int64(&statistics->tile_count,
+                                   iree_memory_order_relaxed),
+            3 * 4 * 5);
+  EXPECT_EQ(iree_atomic_load_int64(&statistics->tile_yield_count,
+                                   iree_memory_order_relaxed),
+            3 * 3 * 4 * 5);
+#endif  // IREE_STATISTICS_ENABLE
+}
+
+// Tests a consumer dispatch whose tiles yield until the corresponding tiles of
+// a concurrently executing producer dispatch have completed.
+TEST_F(TaskDispatchTest, IssueYieldingPipeline) {
+  IREE_TRACE_SCOPE();
+
+  static constexpr uint32_t kTileCount = 64;
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {kTileCount, 1, 1};
+  struct Pipeline {
+    iree_atomic_int32_t produced[kTileCount];
+    int32_t consumed[kTileCount];
+  } pipeline;
+  for (uint32_t i = 0; i < kTileCount; ++i) {
+    pipeline.produced[i] = IREE_ATOMIC_VAR_INIT(0);
+    pipeline.consumed[i] = 0;
+  }
+
+  iree_task_dispatch_t producer_task;
+  iree_task_dispatch_initialize(
+      &scope_,
+      iree_task_make_dispatch_closure(
+          [](void* user_context, const iree_task_tile_context_t* tile_context,
+             iree_task_submission_t* pending_submission) {
+            Pipeline* pipeline = (Pipeline*)user_context;
+            const uint32_t i = tile_context->workgroup_xyz[0];
+            iree_atomic_store_int32(&pipeline->produced[i], (int32_t)i + 1,
+                                    iree_memory_order_release);
+            return iree_ok_status();
+          },
+          (void*)&pipeline),
+      kWorkgroupSize, kWorkgroupCount, &producer_task);
+
+  iree_task_dispatch_t consumer_task;
+  iree_task_dispatch_initialize(
+      &scope_,
+      iree_task_make_dispatch_closure(
+          [](void* user_context, const iree_task_tile_context_t* tile_context,
+             iree_task_submission_t* pending_submission) {
+            Pipeline* pipeline = (Pipeline*)user_context;
+            const uint32_t i = tile_context->workgroup_xyz[0];
+            const int32_t value = iree_atomic_load_int32(
+                &pipeline->produced[i], iree_memory_order_acquire);
+            if (!value) return iree_task_tile_yield_status();
+            pipeline->consumed[i] = value;
+            return iree_ok_status();
+          },
+          (void*)&pipeline),
+      kWorkgroupSize, kWorkgroupCount, &consumer_task);
+
+  // Both dispatches are issued together and joined by a call; the consumer is
+  // submitted first so that its tiles are likely to start before the producer.
+  iree_task_call_t join_task;
+  iree_task_call_initialize(&scope_,
+                            iree_task_make_call_closure(
+                                [](void* user_context, iree_task_t* task,
+                                   iree_task_submission_t* pending_submission) {
+                                  return iree_ok_status();
+                                },
+                                NULL),
+                            &join_task);
+  iree_task_set_completion_task(&consumer_task.header, &join_task.header);
+  iree_task_set_completion_task(&producer_task.header, &join_task.header);
+
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &producer_task.header);
+  iree_task_submission_enqueue(&submission, &consumer_task.header);
+  IREE_ASSERT_OK(SubmitAndWaitIdle(&submission, &join_task.header));
+  IREE_EXPECT_OK(iree_task_scope_consume_status(&scope_));
+  for (uint32_t i = 0; i < kTileCount; ++i) {
+    EXPECT_EQ(pipeline.consumed[i], (int32_t)i + 1);
+  }
+}
+
+// Tests that tiles suspended waiting on something that will never happen are
+// dropped when another tile in the dispatch fails.
+TEST_F(TaskDispatchTest, IssueYieldingFailure) {
+  IREE_TRACE_SCOPE();
+
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {64, 1, 1};
+
+  auto tile = [](void* user_context,
+                 const iree_task_tile_context_t* tile_context,
+                 iree_task_submission_t* pending_submission) -> iree_status_t {
+    IREE_TRACE_SCOPE();
+    if (tile_context->workgroup_xyz[0] < 4) {
+      return iree_task_tile_yield_status();
+    }
+    return tile_context->workgroup_xyz[0] == 32
+               ? iree_make_status(IREE_STATUS_DATA_LOSS, "whoops!")
+               : iree_ok_status();
+  };
+
+  iree_task_dispatch_t task;
+  iree_task_dispatch_initialize(&scope_,
+                                iree_task_make_dispatch_closure(tile, NULL),
+                                kWorkgroupSize, kWorkgroupCount, &task);
+  IREE_ASSERT_OK(SubmitTasksAndWaitIdle(&task.header, &task.header));
+  EXPECT_THAT(Status(iree_task_scope_consume_status(&scope_)),
+              StatusIs(StatusCode::kDataLoss));
+}
+
+// Tests tiles that yield until a tile later in the grid has completed. The
+// tiles each depends on are only started once shards hand off the tiles they
+// cannot hold while all of their suspended tile slots are full.
+static void InitializeYieldingChainDispatch(iree_task_scope_t* scope,
+                                            iree_atomic_int32_t* completed,
+                                            uint32_t tile_count,
+                                            iree_task_dispatch_t* out_task) {
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {tile_count, 1, 1};
+  iree_task_dispatch_initialize(
+      scope,
+      iree_task_make_dispatch_closure(
+          [](void* user_context, const iree_task_tile_context_t* tile_context,
+             iree_task_submission_t* pending_submission) {
+            iree_atomic_int32_t* completed = (iree_atomic_int32_t*)user_context;
+            const uint32_t i = tile_context->workgroup_xyz[0];
+            if (i + 1 < tile_context->workgroup_count[0] &&
+                !iree_atomic_load_int32(&completed[i + 1],
+                                        iree_memory_order_acquire)) {
+              return iree_task_tile_yield_status();
+            }
+            iree_atomic_store_int32(&completed[i], 1,
+                                    iree_memory_order_release);
+            return iree_ok_status();
+          },
+          (void*)completed),
+      workgroup_size, workgroup_count, out_task);
+}
+
+TEST_F(TaskDispatchTest, IssueYieldingChain) {
+  IREE_TRACE_SCOPE();
+
+  // Enough tiles that each shard must hold many more than
+  // IREE_TASK_DISPATCH_MAX_SUSPENDED_TILES_PER_SHARD at once.
+  static constexpr uint32_t kTileCount = 256;
+  std::unique_ptr<iree_atomic_int32_t[]> completed(
+      new iree_atomic_int32_t[kTileCount]);
+  for (uint32_t i = 0; i < kTileCount; ++i) {
+    completed[i] = IREE_ATOMIC_VAR_INIT(0);
+  }
+
+  iree_task_dispatch_t task;
+  InitializeYieldingChainDispatch(&scope_, completed.get(), kTileCount, &task);
+  IREE_ASSERT_OK(SubmitTasksAndWaitIdle(&task.header, &task.header));
+  IREE_EXPECT_OK(iree_task_scope_consume_status(&scope_));
+  for (uint32_t i = 0; i < kTileCount; ++i) {
+    EXPECT_EQ(iree_atomic_load_int32(&completed[i], iree_memory_order_seq_cst),
+              1);
+  }
+}
+
+class TaskDispatchSingleWorkerTest : public TaskTest {
+ public:
+  TaskDispatchSingleWorkerTest() { group_count_ = 1; }
+};
+
+// Tests that a lone worker makes progress when the tiles its shard has
+// suspended wait on tiles it has not started yet.
+TEST_F(TaskDispatchSingleWorkerTest, IssueYieldingChain) {
+  IREE_TRACE_SCOPE();
+
+  // More tiles than both the suspended tile slots and the tiles reserved at a
+  // time by a shard.
+  static constexpr uint32_t kTileCount = 64;
+  std::unique_ptr<iree_atomic_int32_t[]> completed(
+      new iree_atomic_int32_t[kTileCount]);
+  for (uint32_t i = 0; i < kTileCount; ++i) {
+    completed[i] = IREE_ATOMIC_VAR_INIT(0);
+  }
+
+  iree_task_dispatch_t task;
+  InitializeYieldingChainDispatch(&scope_, completed.get(), kTileCount, &task);
+  IREE_ASSERT_OK(SubmitTasksAndWaitIdle(&task.header, &task.header));
+  IREE_EXPECT_OK(iree_task_scope_consume_status(&scope_));
+  for (uint32_t i = 0; i < kTileCount; ++i) {
+    EXPECT_EQ(iree_atomic_load_int32(&completed[i], iree_memory_order_seq_cst),
+              1);
+  }
+}
+
 }  // namespace
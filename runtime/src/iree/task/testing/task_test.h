@@ -26,7 +26,7 @@ class TaskTest : public ::testing::Test {
     options.worker_local_memory_size = 64 * 1024;
     iree_task_executor_options_initialize(&options);
     iree_task_topology_t topology;
-    iree_task_topology_initialize_from_group_count(8, &topology);
+    iree_task_topology_initialize_from_group_count(group_count_, &topology);
     IREE_ASSERT_OK(iree_task_executor_create(
         options, &topology, iree_allocator_system(), &executor_));
     iree_task_topology_deinitialize(&topology);
@@ -71,6 +71,10 @@ class TaskTest : public ::testing::Test {
     return iree_task_scope_wait_idle(&scope_, IREE_TIME_INFINITE_FUTURE);
   }
 
+  // Number of topology groups (and workers) the executor is created with.
+  // Subclasses may change this in their constructor.
+  iree_host_size_t group_count_ = 8;
+
   iree_task_executor_t* executor_ = NULL;
   iree_task_scope_t scope_;
 };
@@ -94,6 +94,40 @@ extern "C" {
 // memory).
 #define IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION (8)
 
+// Minimum duration a worker using IREE_TASK_WORKER_SPIN_POLICY_ADAPTIVE will
+// spin when work is predicted to arrive soon. Covers jitter in arrivals that
+// are predicted to be nearly immediate.
+#define IREE_TASK_WORKER_ADAPTIVE_MIN_SPIN_NS (2 /*us*/ * 1000)
+
+// Weight of each new idle duration observed by a worker using
+// IREE_TASK_WORKER_SPIN_POLICY_ADAPTIVE as a right shift: each observation
+// contributes 1/(1<<N) of the predicted idle duration. Lower values adapt more
+// quickly to changes in arrival rate but are more sensitive to outliers.
+#define IREE_TASK_WORKER_ADAPTIVE_HISTORY_SHIFT (2)
+
+// Duration hot workers spin between rechecking their wait registration. This
+// only bounds the length of individual spin loops and does not cause hot
+// workers to park.
+#define IREE_TASK_WORKER_HOT_SPIN_SLICE_NS (1 /*ms*/ * 1000000)
+
+// Maximum number of suspended tiles a dispatch shard can hold. Once full the
+// shard stops starting new tiles until one of its suspended tiles completes and
+// forks a continuation shard to start the remaining tiles in the grid.
+// Each suspended tile increases the size of every shard task by the size of
+// its iree_task_tile_storage_t.
+#define IREE_TASK_DISPATCH_MAX_SUSPENDED_TILES_PER_SHARD (4)
+
+// Number of 64-bit values a tile can preserve across yields in its
+// iree_task_tile_storage_t.
+#define IREE_TASK_TILE_STORAGE_STATE_COUNT (7)
+
+// Bounds of the exponential backoff a worker applies before resuming yielded
+// tasks when it has nothing else to run. The first resume happens immediately
+// and each consecutive resume that does not complete any task doubles the time
+// the worker parks (waking early if new work is posted to it).
+#define IREE_TASK_WORKER_SUSPENDED_MIN_BACKOFF_NS (2 /*us*/ * 1000)
+#define IREE_TASK_WORKER_SUSPENDED_MAX_BACKOFF_NS (1 /*ms*/ * 1000000)
+
 // Whether to enable per-tile colors for each tile tracing zone based on the
 // tile grid xyz. Not cheap and can be disabled to reduce tracing overhead.
 // TODO(#4017): make per-tile color tracing fast enough to always have on.
@@ -42,11 +42,31 @@ iree_status_t iree_task_worker_initialize(
   out_worker->local_memory = local_memory;
   out_worker->processor_id = 0;
   out_worker->processor_tag = 0;
+  out_worker->max_spin_ns = worker_index < executor->worker_hot_count
+                                ? IREE_DURATION_INFINITE
+                                : executor->worker_spin_ns;
+  out_worker->predicted_idle_ns = IREE_DURATION_ZERO;
 
   iree_notification_initialize(&out_worker->wake_notification);
   iree_notification_initialize(&out_worker->state_notification);
   iree_atomic_task_slist_initialize(&out_worker->mailbox_slist);
   iree_task_queue_initialize(&out_worker->local_task_queue);
+  iree_task_list_initialize(&out_worker->suspended_list);
+  out_worker->suspended_backoff_ns = IREE_DURATION_ZERO;
+#if IREE_STATISTICS_ENABLE
+  iree_atomic_store_int64(&out_worker->wait_time_ns, 0,
+                          iree_memory_order_relaxed);
+  iree_atomic_store_int64(&out_worker->spin_hit_count, 0,
+                          iree_memory_order_relaxed);
+  iree_atomic_store_int64(&out_worker->futex_wake_count, 0,
+                          iree_memory_order_relaxed);
+  iree_atomic_store_int64(&out_worker->wake_post_time_ns, 0,
+                          iree_memory_order_relaxed);
+  iree_atomic_store_int64(&out_worker->wake_count, 0,
+                          iree_memory_order_relaxed);
+  iree_atomic_store_int64(&out_worker->wake_latency_ns, 0,
+                          iree_memory_order_relaxed);
+#endif  // IREE_STATISTICS_ENABLE
 
   iree_task_worker_state_t initial_state = IREE_TASK_WORKER_STATE_RUNNING;
   iree_atomic_store_int32(&out_worker->state, initial_state,
@@ -132,6 +152,7 @@ void iree_task_worker_deinitialize(iree_task_worker_t* worker) {
   // have a reference to.
   iree_atomic_task_slist_discard(&worker->mailbox_slist);
   iree_task_list_discard(&worker->local_task_queue.list);
+  iree_task_list_discard(&worker->suspended_list);
 
   iree_notification_deinitialize(&worker->wake_notification);
   iree_notification_deinitialize(&worker->state_notification);
@@ -178,16 +199,29 @@ static void iree_task_worker_execute(
   // TODO(benvanik): think a bit more about this timing; this ensures we have
   // BFS behavior at the cost of the additional merge overhead - it's probably
   // worth it?
-  // TODO(benvanik): handle partial tasks and re-queuing.
   switch (task->type) {
     case IREE_TASK_TYPE_CALL: {
       iree_task_call_execute((iree_task_call_t*)task, pending_submission);
+      worker->suspended_backoff_ns = IREE_DURATION_ZERO;
       break;
     }
     case IREE_TASK_TYPE_DISPATCH_SHARD: {
-      iree_task_dispatch_shard_execute(
-          (iree_task_dispatch_shard_t*)task, worker->processor_id,
-          worker->worker_index, worker->local_memory, pending_submission);
+      iree_task_dispatch_shard_t* continuation_task = NULL;
+      if (iree_task_dispatch_shard_execute(
+              (iree_task_dispatch_shard_t*)task, worker->processor_id,
+              worker->worker_index, worker->local_memory, pending_submission,
+              &continuation_task)) {
+        worker->suspended_backoff_ns = IREE_DURATION_ZERO;
+      } else {
+        // Tiles yielded; resume the shard after we've run other work.
+        iree_task_list_push_front(&worker->suspended_list, task);
+      }
+      if (continuation_task) {
+        // The shard could not hold any more suspended tiles; run the remaining
+        // tiles next (or let another worker steal them).
+        iree_task_queue_push_front(&worker->local_task_queue,
+                                   &continuation_task->header);
+      }
       break;
     }
     default:
@@ -257,6 +291,112 @@ static void iree_task_worker_update_processor_id(iree_task_worker_t* worker) {
   iree_cpu_requery_processor_id(&worker->processor_tag, &worker->processor_id);
 }
 
+// Returns true if the worker adapts its spin duration to recent arrivals.
+static bool iree_task_worker_is_adaptive(iree_task_worker_t* worker) {
+  return worker->executor->worker_spin_policy ==
+             IREE_TASK_WORKER_SPIN_POLICY_ADAPTIVE &&
+         worker->max_spin_ns != IREE_DURATION_ZERO &&
+         worker->max_spin_ns != IREE_DURATION_INFINITE;
+}
+
+// Selects how long the worker should spin waiting for work before parking.
+// Returns IREE_DURATION_INFINITE if the worker should never park.
+static iree_duration_t iree_task_worker_select_spin_ns(
+    iree_task_worker_t* worker) {
+  const iree_duration_t max_spin_ns = worker->max_spin_ns;
+  if (!iree_task_worker_is_adaptive(worker)) return max_spin_ns;
+  // If work isn't expected to arrive before we'd give up spinning then park
+  // immediately instead of burning the core.
+  const iree_duration_t predicted_idle_ns = worker->predicted_idle_ns;
+  if (predicted_idle_ns > max_spin_ns) return IREE_DURATION_ZERO;
+  // Spin for twice the predicted duration to tolerate jitter in arrivals.
+  return iree_min(max_spin_ns, iree_max(IREE_TASK_WORKER_ADAPTIVE_MIN_SPIN_NS,
+                                        predicted_idle_ns * 2));
+}
+
+// Updates the predicted idle duration of the worker with a wait that lasted
+// |idle_ns|.
+static void iree_task_worker_observe_idle(iree_task_worker_t* worker,
+                                          iree_duration_t idle_ns) {
+  // Clamp so that a single long idle period (such as between program
+  // invocations) only takes a few short arrivals to recover from.
+  idle_ns = iree_min(idle_ns, worker->max_spin_ns * 2);
+  worker->predicted_idle_ns += (idle_ns - worker->predicted_idle_ns) /
+                               (1 << IREE_TASK_WORKER_ADAPTIVE_HISTORY_SHIFT);
+}
+
+// Spins for up to |spin_ns| waiting on the wake notification. Returns true if
+// the worker was woken. Otherwise the wait is registered again with
+// |wait_token| such that it can be committed to park the worker without
+// missing any wakes posted while spinning.
+static bool iree_task_worker_spin_wait(iree_task_worker_t* worker,
+                                       iree_wait_token_t wait_token,
+                                       iree_duration_t spin_ns) {
+  // A deadline in the past prevents the notification from parking the thread.
+  if (iree_notification_commit_wait(&worker->wake_notification, wait_token,
+                                    spin_ns, IREE_TIME_INFINITE_PAST)) {
+    return true;
+  }
+  // The spin timed out and the wait was unregistered. If the notification was
+  // posted between the spin ending and registering again we were woken.
+  if (iree_notification_prepare_wait(&worker->wake_notification) !=
+      wait_token) {
+    iree_notification_cancel_wait(&worker->wake_notification);
+    return true;
+  }
+  return false;
+}
+
+// Waits until the worker is woken by a post to its wake notification.
+// The wait must have been prepared with |wait_token|.
+static void iree_task_worker_wait(iree_task_worker_t* worker,
+                                  iree_wait_token_t wait_token) {
+  const iree_duration_t spin_ns = iree_task_worker_select_spin_ns(worker);
+  const iree_time_t wait_start_time_ns = iree_time_now();
+
+  bool spin_hit = false;
+  if (spin_ns == IREE_DURATION_INFINITE) {
+    // Hot workers never park and keep spinning until woken.
+    while (!iree_task_worker_spin_wait(worker, wait_token,
+                                       IREE_TASK_WORKER_HOT_SPIN_SLICE_NS)) {
+    }
+    spin_hit = true;
+  } else if (spin_ns != IREE_DURATION_ZERO) {
+    spin_hit = iree_task_worker_spin_wait(worker, wait_token, spin_ns);
+  }
+  if (!spin_hit) {
+    // Park in the kernel. We don't care if the condition fails as we're just
+    // using it as a pulse.
+    iree_notification_commit_wait(&worker->wake_notification, wait_token,
+                                  /*spin_ns=*/IREE_DURATION_ZERO,
+                                  /*deadline_ns=*/IREE_TIME_INFINITE_FUTURE);
+  }
+
+  const iree_time_t wait_end_time_ns = iree_time_now();
+  if (iree_task_worker_is_adaptive(worker)) {
+    iree_task_worker_observe_idle(worker,
+                                  wait_end_time_ns - wait_start_time_ns);
+  }
+
+#if IREE_STATISTICS_ENABLE
+  iree_atomic_fetch_add_int64(&worker->wait_time_ns,
+                              wait_end_time_ns - wait_start_time_ns,
+                              iree_memory_order_relaxed);
+  iree_atomic_fetch_add_int64(
+      spin_hit ? &worker->spin_hit_count : &worker->futex_wake_count, 1,
+      iree_memory_order_relaxed);
+  const iree_time_t post_time_ns = iree_atomic_exchange_int64(
+      &worker->wake_post_time_ns, 0, iree_memory_order_relaxed);
+  if (post_time_ns != 0) {
+    iree_atomic_fetch_add_int64(&worker->wake_count, 1,
+                                iree_memory_order_relaxed);
+    iree_atomic_fetch_add_int64(&worker->wake_latency_ns,
+                                iree_max(0, wait_end_time_ns - post_time_ns),
+                                iree_memory_order_relaxed);
+  }
+#endif  // IREE_STATISTICS_ENABLE
+}
+
 // Alternates between pumping ready tasks in the worker queue and waiting
 // for more tasks to arrive. Only returns when the worker has been asked by
 // the executor to exit.
@@ -268,6 +408,13 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
 
   // Pump the thread loop to process more tasks.
   while (true) {
+#if IREE_STATISTICS_ENABLE
+    // Any wake posted prior to this point is satisfied by the pump below and
+    // should not be attributed to the next wait.
+    iree_atomic_store_int64(&worker->wake_post_time_ns, 0,
+                            iree_memory_order_relaxed);
+#endif  // IREE_STATISTICS_ENABLE
+
     // If we fail to find any work to do we'll wait at the end of this loop.
     // In order not to not miss any work that is enqueued after we've already
     // checked a particular source we use an interruptable wait token that
@@ -343,15 +490,36 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
         !iree_task_queue_is_empty(&worker->local_task_queue)) {
       // Have more work to do; loop around to try another pump.
       iree_notification_cancel_wait(&worker->wake_notification);
+    } else if (!iree_task_list_is_empty(&worker->suspended_list)) {
+      // Everything else we could run has run and coordination has had a chance
+      // to distribute new work; resume yielded tasks instead of waiting as
+      // nothing else will wake us to do so. If resuming them has not completed
+      // anything since the last time we got here back off so that tiles
+      // waiting on other workers don't have us busy-spin; we still wake early
+      // if new work is posted to us.
+      if (worker->suspended_backoff_ns == IREE_DURATION_ZERO) {
+        iree_notification_cancel_wait(&worker->wake_notification);
+        worker->suspended_backoff_ns =
+            IREE_TASK_WORKER_SUSPENDED_MIN_BACKOFF_NS;
+      } else {
+        IREE_TRACE_ZONE_BEGIN_NAMED(z_wait,
+                                    "iree_task_worker_main_pump_yield_wait");
+        iree_notification_commit_wait(
+            &worker->wake_notification, wait_token,
+            /*spin_ns=*/IREE_DURATION_ZERO,
+            /*deadline_ns=*/iree_time_now() + worker->suspended_backoff_ns);
+        IREE_TRACE_ZONE_END(z_wait);
+        worker->suspended_backoff_ns =
+            iree_min(worker->suspended_backoff_ns * 2,
+                     IREE_TASK_WORKER_SUSPENDED_MAX_BACKOFF_NS);
+      }
+      iree_task_queue_append_from_lifo_list_unsafe(&worker->local_task_queue,
+                                                   &worker->suspended_list);
     } else {
-      // Spin/wait in the kernel. We don't care if the condition fails as we're
-      // just using it as a pulse.
+      // Spin and/or park until woken.
       IREE_TRACE_ZONE_BEGIN_NAMED(z_wait,
                                   "iree_task_worker_main_pump_wake_wait");
-      iree_notification_commit_wait(
-          &worker->wake_notification, wait_token,
-          /*spin_ns=*/worker->executor->worker_spin_ns,
-          /*deadline_ns=*/IREE_TIME_INFINITE_FUTURE);
+      iree_task_worker_wait(worker, wait_token);
       IREE_TRACE_ZONE_END(z_wait);
 
       // Woke from a wait - query the processor ID in case we migrated during
@@ -121,6 +121,16 @@ typedef struct iree_task_worker_t {
   // An opaque tag used to reduce the cost of processor ID queries.
   iree_cpu_processor_tag_t processor_tag;
 
+  // Maximum duration the worker spins waiting for work before parking or
+  // IREE_DURATION_INFINITE if the worker is hot and never parks.
+  // Only ever touched by the worker thread.
+  iree_duration_t max_spin_ns;
+  // Exponentially weighted moving average of how long the worker has recently
+  // been idle before being woken. Used to predict whether spinning is likely to
+  // pay off under IREE_TASK_WORKER_SPIN_POLICY_ADAPTIVE.
+  // Only ever touched by the worker thread.
+  iree_duration_t predicted_idle_ns;
+
   // Destructive interference padding between the mailbox and local task queue
   // to ensure that the worker - who is pounding on local_task_queue - doesn't
   // contend with submissions or coordinators dropping new tasks in the mailbox.
@@ -138,11 +148,39 @@ typedef struct iree_task_worker_t {
   // workers.
   iree_byte_span_t local_memory;
 
+  // LIFO list of tasks that yielded before completing (such as dispatch shards
+  // with suspended tiles). They are moved back into the local task queue after
+  // the worker has run out of other work and coordinated such that the work
+  // they are waiting on has a chance to make progress.
+  // Only ever touched by the worker thread.
+  iree_task_list_t suspended_list;
+  // Duration the worker parks for before next resuming suspended tasks when it
+  // has nothing else to run. Reset whenever a task completes.
+  // Only ever touched by the worker thread.
+  iree_duration_t suspended_backoff_ns;
+
   // Worker-local FIFO queue containing the tasks that will be processed by the
   // worker. This queue supports work-stealing by other workers if they run out
   // of work of their own.
   // LAYOUT: must be 64b away from mailbox_slist.
   iree_task_queue_t local_task_queue;
+
+#if IREE_STATISTICS_ENABLE
+  // Total time the worker has spent spinning or sleeping while waiting for
+  // work. Only updated by the worker thread and read by statistics queries.
+  iree_atomic_int64_t wait_time_ns;
+  // Number of waits satisfied while spinning and by parking in the system
+  // wait API. Only updated by the worker thread.
+  iree_atomic_int64_t spin_hit_count;
+  iree_atomic_int64_t futex_wake_count;
+  // Time at which work was last posted to the worker along with a wake or 0 if
+  // the worker has observed it. Set by posters and cleared by the worker.
+  iree_atomic_int64_t wake_post_time_ns;
+  // Number of waits ended by a post of work and the total time between the
+  // posts and the worker resuming. Only updated by the worker thread.
+  iree_atomic_int64_t wake_count;
+  iree_atomic_int64_t wake_latency_ns;
+#endif  // IREE_STATISTICS_ENABLE
 } iree_task_worker_t;
 static_assert(offsetof(iree_task_worker_t, mailbox_slist) +
                       sizeof(iree_atomic_task_slist_t) <
@@ -78,6 +78,12 @@ void iree_benchmark_set_bytes_processed(iree_benchmark_state_t* state,
 void iree_benchmark_set_items_processed(iree_benchmark_state_t* state,
                                         int64_t items);
 
+// Adds a user counter |name| with the given value to the report line.
+//
+// REQUIRES: must only be called outside of the benchmark step loop.
+void iree_benchmark_set_counter(iree_benchmark_state_t* state,
+                                const char* name, double value);
+
 //===----------------------------------------------------------------------===//
 // iree_benchmark_def_t
 //===----------------------------------------------------------------------===//
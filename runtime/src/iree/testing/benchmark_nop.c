@@ -33,6 +33,9 @@ void iree_benchmark_set_bytes_processed(iree_benchmark_state_t* state,
 void iree_benchmark_set_items_processed(iree_benchmark_state_t* state,
                                         int64_t items) {}
 
+void iree_benchmark_set_counter(iree_benchmark_state_t* state,
+                                const char* name, double value) {}
+
 void iree_benchmark_register(iree_string_view_t name,
                              const iree_benchmark_def_t* benchmark_def) {}
 
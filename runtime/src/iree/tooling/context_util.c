@@ -16,9 +16,11 @@
 #include "iree/base/tracing.h"
 #include "iree/hal/local/loaders/registration/init.h"
 #include "iree/hal/local/plugins/registration/init.h"
+#include "iree/io/parameter_provider.h"
 #include "iree/modules/hal/inline/module.h"
 #include "iree/modules/hal/loader/module.h"
 #include "iree/modules/hal/module.h"
+#include "iree/modules/io/parameters/module.h"
 #include "iree/tooling/device_util.h"
 #include "iree/tooling/modules/resolver.h"
 #include "iree/vm/bytecode/module.h"
@@ -314,6 +316,77 @@ static iree_status_t iree_tooling_load_hal_loader_module(
   return status;
 }
 
+//===----------------------------------------------------------------------===//
+// Parameter archives
+//===----------------------------------------------------------------------===//
+
+IREE_FLAG_LIST(
+    string, parameters,
+    "A parameter archive (.irpa) to serve to modules compiled with\n"
+    "externalized parameters specified as `[scope=]path.irpa`. The scope is\n"
+    "only split off when the text before the first `=` has no path\n"
+    "separators; use `./` to pass a path containing `=` in its first\n"
+    "component. Archives are mapped read-only and shared and searched in the\n"
+    "order defined by the flags. The io_parameters module is added\n"
+    "automatically when required.");
+
+// Splits a `[scope=]path` --parameters flag value into its scope (empty if
+// none) and path. Paths may themselves contain `=` (`dir/a=b.irpa`) and so text
+// before the first `=` is only treated as a scope if it is not part of a path.
+static void iree_tooling_parse_parameters_flag(iree_string_view_t flag,
+                                               iree_string_view_t* out_scope,
+                                               iree_string_view_t* out_path) {
+  iree_string_view_t scope, path;
+  if (iree_string_view_split(flag, '=', &scope, &path) != -1 &&
+      iree_string_view_find_first_of(scope, IREE_SV("/\\"), 0) ==
+          IREE_STRING_VIEW_NPOS) {
+    *out_scope = scope;
+    *out_path = path;
+  } else {
+    *out_scope = iree_string_view_empty();
+    *out_path = flag;
+  }
+}
+
+static iree_status_t iree_tooling_load_io_parameters_module(
+    iree_vm_instance_t* instance, iree_allocator_t host_allocator,
+    iree_vm_module_t** out_module) {
+  IREE_ASSERT_ARGUMENT(instance);
+  IREE_ASSERT_ARGUMENT(out_module);
+  *out_module = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_io_parameter_provider_t* provider = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_io_parameter_provider_create(host_allocator, &provider));
+
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0;
+       i < FLAG_parameters_list().count && iree_status_is_ok(status); ++i) {
+    iree_string_view_t flag = FLAG_parameters_list().values[i];
+    iree_string_view_t scope, path;
+    iree_tooling_parse_parameters_flag(flag, &scope, &path);
+    status =
+        iree_io_parameter_provider_open_archive_file(provider, scope, path);
+  }
+
+  // Create the module; it retains the provider for its lifetime.
+  iree_vm_module_t* module = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_io_parameters_module_create(instance, provider,
+                                              host_allocator, &module);
+  }
+  iree_io_parameter_provider_release(provider);
+
+  if (iree_status_is_ok(status)) {
+    *out_module = module;
+  } else {
+    iree_vm_module_release(module);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 //===----------------------------------------------------------------------===//
 // Module management
 //===----------------------------------------------------------------------===//
@@ -404,6 +477,10 @@ static iree_status_t iree_tooling_resolve_module_dependency_callback(
   } else if (iree_string_view_equal(dependency->name, IREE_SV("hal_loader"))) {
     IREE_RETURN_IF_ERROR(iree_tooling_load_hal_loader_module(
         state->instance, state->host_allocator, &module));
+  } else if (iree_string_view_equal(dependency->name,
+                                    IREE_SV("io_parameters"))) {
+    IREE_RETURN_IF_ERROR(iree_tooling_load_io_parameters_module(
+        state->instance, state->host_allocator, &module));
   } else {
     // Defer to the generic module resolver registry.
     IREE_RETURN_IF_ERROR(iree_tooling_resolve_module_dependency(
@@ -6,6 +6,9 @@
 
 #include "iree/tooling/device_util.h"
 
+#include <inttypes.h>
+#include <stdio.h>
+
 #include "iree/base/internal/call_once.h"
 #include "iree/base/internal/flags.h"
 #include "iree/base/tracing.h"
@@ -405,10 +408,10 @@ iree_status_t iree_hal_create_device_from_flags(
 
 IREE_FLAG(
     string, device_profiling_mode, "",
-    "HAL device profiling mode (one of ['queue', 'dispatch', 'executable'])\n"
-    "or empty to disable profiling. HAL implementations may require\n"
-    "additional flags in order to configure profiling support on their\n"
-    "devices.");
+    "HAL device profiling mode (one of ['queue', 'dispatch', 'executable',\n"
+    "'timeline']) or empty to disable profiling. HAL implementations may\n"
+    "require additional flags in order to configure profiling support on\n"
+    "their devices.");
 IREE_FLAG(
     string, device_profiling_file, "",
     "Optional file path/prefix for profiling file output. Some\n"
@@ -429,6 +432,8 @@ iree_status_t iree_hal_begin_profiling_from_flags(iree_hal_device_t* device) {
     options.mode |= IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_COUNTERS;
   } else if (strcmp(FLAG_device_profiling_mode, "executable") == 0) {
     options.mode |= IREE_HAL_DEVICE_PROFILING_MODE_EXECUTABLE_COUNTERS;
+  } else if (strcmp(FLAG_device_profiling_mode, "timeline") == 0) {
+    options.mode |= IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_TIMELINE;
   } else {
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "unsupported profiling mode '%s'",
@@ -446,3 +451,79 @@ iree_status_t iree_hal_end_profiling_from_flags(iree_hal_device_t* device) {
   if (strlen(FLAG_device_profiling_mode) == 0) return iree_ok_status();
   return iree_hal_device_profiling_end(device);
 }
+
+iree_status_t iree_hal_device_dispatch_statistics_fprint(
+    FILE* file, iree_hal_device_t* device) {
+  if (!device) return iree_ok_status();
+  static const char* keys[] = {
+      "dispatch_count",          "shard_count",
+      "tile_count",              "stolen_tile_count",
+      "shard_time_ns",           "max_shard_time_ns",
+      "shard_latency_ns",        "worker_wait_time_ns",
+      "worker_spin_hit_count",   "worker_futex_wake_count",
+      "worker_wake_count",       "worker_wake_latency_ns",
+      "tile_yield_count",
+  };
+  int64_t values[IREE_ARRAYSIZE(keys)] = {0};
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(keys); ++i) {
+    iree_status_t status = iree_hal_device_query_i64(
+        device, IREE_SV("hal.task.statistics"),
+        iree_make_cstring_view(keys[i]), &values[i]);
+    if (iree_status_is_not_found(status)) {
+      // Device (or build configuration) does not track statistics.
+      iree_status_ignore(status);
+      return iree_ok_status();
+    }
+    IREE_RETURN_IF_ERROR(status);
+  }
+  const int64_t dispatch_count = values[0];
+  const int64_t shard_count = values[1];
+  const int64_t tile_count = values[2];
+  const int64_t stolen_tile_count = values[3];
+  const int64_t shard_time_ns = values[4];
+  const int64_t max_shard_time_ns = values[5];
+  const int64_t shard_latency_ns = values[6];
+  const int64_t worker_wait_time_ns = values[7];
+  const int64_t worker_spin_hit_count = values[8];
+  const int64_t worker_futex_wake_count = values[9];
+  const int64_t worker_wake_count = values[10];
+  const int64_t worker_wake_latency_ns = values[11];
+  const int64_t tile_yield_count = values[12];
+  const double avg_shard_time_ns =
+      shard_count ? (double)shard_time_ns / shard_count : 0.0;
+  fprintf(file, "[[ iree_hal_device_t dispatch statistics ]]\n");
+  fprintf(file, "DISPATCHES: %" PRIi64 "\n", dispatch_count);
+  fprintf(file, "    SHARDS: %" PRIi64 " (%.2f per dispatch)\n", shard_count,
+          dispatch_count ? (double)shard_count / dispatch_count : 0.0);
+  fprintf(file, "     TILES: %" PRIi64 " (%.2f per shard)\n", tile_count,
+          shard_count ? (double)tile_count / shard_count : 0.0);
+  fprintf(file, "    STOLEN: %" PRIi64 " tiles (%.2f%%)\n", stolen_tile_count,
+          tile_count ? 100.0 * stolen_tile_count / tile_count : 0.0);
+  fprintf(file,
+          "SHARD TIME: %.3fms total, %.3fus avg, %.3fus max (%.2fx "
+          "imbalance)\n",
+          shard_time_ns / 1e6, avg_shard_time_ns / 1e3,
+          max_shard_time_ns / 1e3,
+          avg_shard_time_ns > 0.0 ? max_shard_time_ns / avg_shard_time_ns
+                                  : 0.0);
+  if (tile_yield_count) {
+    fprintf(file, "    YIELDS: %" PRIi64 " (%.2f per tile)\n",
+            tile_yield_count,
+            tile_count ? (double)tile_yield_count / tile_count : 0.0);
+  }
+  fprintf(file, "   LATENCY: %.3fus avg shard start\n",
+          shard_count ? shard_latency_ns / 1e3 / shard_count : 0.0);
+  fprintf(file, " WAIT TIME: %.3fms workers idle (spinning or sleeping)\n",
+          worker_wait_time_ns / 1e6);
+  fprintf(file,
+          "     WAKES: %" PRIi64 " spin hits, %" PRIi64
+          " futex wakes (%.2f%% spin), %.3fus avg wake latency\n",
+          worker_spin_hit_count, worker_futex_wake_count,
+          worker_spin_hit_count + worker_futex_wake_count
+              ? 100.0 * worker_spin_hit_count /
+                    (worker_spin_hit_count + worker_futex_wake_count)
+              : 0.0,
+          worker_wake_count ? worker_wake_latency_ns / 1e3 / worker_wake_count
+                            : 0.0);
+  return iree_ok_status();
+}
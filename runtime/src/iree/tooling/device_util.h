@@ -7,6 +7,8 @@
 #ifndef IREE_TOOLING_DEVICE_UTIL_H_
 #define IREE_TOOLING_DEVICE_UTIL_H_
 
+#include <stdio.h>
+
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
 
@@ -43,6 +45,11 @@ iree_status_t iree_hal_begin_profiling_from_flags(iree_hal_device_t* device);
 // command line flags. No-op if profiling is not enabled.
 iree_status_t iree_hal_end_profiling_from_flags(iree_hal_device_t* device);
 
+// Prints the dispatch execution statistics of |device| to |file|, if the
+// device reports any. No-op if the device does not support statistics.
+iree_status_t iree_hal_device_dispatch_statistics_fprint(
+    FILE* file, iree_hal_device_t* device);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
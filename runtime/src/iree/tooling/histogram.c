@@ -0,0 +1,143 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/tooling/histogram.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+#include "iree/base/internal/math.h"
+
+#define IREE_TOOLING_HISTOGRAM_SUB_BUCKET_COUNT \
+  (1ull << IREE_TOOLING_HISTOGRAM_PRECISION_BITS)
+#define IREE_TOOLING_HISTOGRAM_SUB_BUCKET_HALF_COUNT \
+  (1ull << (IREE_TOOLING_HISTOGRAM_PRECISION_BITS - 1))
+
+// Values below the sub bucket count map 1:1 to buckets. Larger values are
+// shifted right until they have PRECISION_BITS significant bits (placing them
+// in the upper half of a sub bucket range) and each shift amount gets its own
+// set of SUB_BUCKET_HALF_COUNT buckets.
+static iree_host_size_t iree_tooling_histogram_bucket_index(uint64_t value) {
+  if (value < IREE_TOOLING_HISTOGRAM_SUB_BUCKET_COUNT) {
+    return (iree_host_size_t)value;
+  }
+  const int msb = 63 - iree_math_count_leading_zeros_u64(value);
+  const int shift = msb - (IREE_TOOLING_HISTOGRAM_PRECISION_BITS - 1);
+  return (iree_host_size_t)(IREE_TOOLING_HISTOGRAM_SUB_BUCKET_COUNT +
+                            (shift - 1) *
+                                IREE_TOOLING_HISTOGRAM_SUB_BUCKET_HALF_COUNT +
+                            ((value >> shift) -
+                             IREE_TOOLING_HISTOGRAM_SUB_BUCKET_HALF_COUNT));
+}
+
+// Returns the largest value that maps to the bucket at |index|.
+static uint64_t iree_tooling_histogram_bucket_highest_value(
+    iree_host_size_t index) {
+  if (index < IREE_TOOLING_HISTOGRAM_SUB_BUCKET_COUNT) return index;
+  const uint64_t relative_index =
+      index - IREE_TOOLING_HISTOGRAM_SUB_BUCKET_COUNT;
+  const int shift =
+      (int)(relative_index / IREE_TOOLING_HISTOGRAM_SUB_BUCKET_HALF_COUNT) + 1;
+  const uint64_t mantissa =
+      relative_index % IREE_TOOLING_HISTOGRAM_SUB_BUCKET_HALF_COUNT +
+      IREE_TOOLING_HISTOGRAM_SUB_BUCKET_HALF_COUNT;
+  return ((mantissa + 1) << shift) - 1;
+}
+
+void iree_tooling_histogram_initialize(
+    iree_tooling_histogram_t* out_histogram) {
+  memset(out_histogram, 0, sizeof(*out_histogram));
+  out_histogram->min_value = INT64_MAX;
+  out_histogram->max_value = 0;
+}
+
+void iree_tooling_histogram_record(iree_tooling_histogram_t* histogram,
+                                   int64_t value) {
+  if (value < 0) value = 0;
+  ++histogram->counts[iree_tooling_histogram_bucket_index((uint64_t)value)];
+  ++histogram->total_count;
+  histogram->sum += (double)value;
+  if (value < histogram->min_value) histogram->min_value = value;
+  if (value > histogram->max_value) histogram->max_value = value;
+}
+
+void iree_tooling_histogram_merge(iree_tooling_histogram_t* target,
+                                  const iree_tooling_histogram_t* source) {
+  if (!source->total_count) return;
+  for (iree_host_size_t i = 0; i < IREE_TOOLING_HISTOGRAM_BUCKET_COUNT; ++i) {
+    target->counts[i] += source->counts[i];
+  }
+  target->total_count += source->total_count;
+  target->sum += source->sum;
+  if (source->min_value < target->min_value) {
+    target->min_value = source->min_value;
+  }
+  if (source->max_value > target->max_value) {
+    target->max_value = source->max_value;
+  }
+}
+
+double iree_tooling_histogram_mean(const iree_tooling_histogram_t* histogram) {
+  if (!histogram->total_count) return 0.0;
+  return histogram->sum / (double)histogram->total_count;
+}
+
+// Clamps the bucket-equivalent |value| to the exact recorded range.
+static int64_t iree_tooling_histogram_clamp(
+    const iree_tooling_histogram_t* histogram, uint64_t value) {
+  if (value > (uint64_t)histogram->max_value) return histogram->max_value;
+  if ((int64_t)value < histogram->min_value) return histogram->min_value;
+  return (int64_t)value;
+}
+
+int64_t iree_tooling_histogram_value_at_percentile(
+    const iree_tooling_histogram_t* histogram, double percentile) {
+  if (!histogram->total_count) return 0;
+  if (percentile < 0.0) percentile = 0.0;
+  if (percentile > 100.0) percentile = 100.0;
+  // Rank of the value we are looking for (1-based); the 0th percentile is the
+  // smallest recorded value.
+  uint64_t target_count =
+      (uint64_t)((percentile / 100.0) * (double)histogram->total_count + 0.5);
+  if (target_count < 1) target_count = 1;
+  uint64_t running_count = 0;
+  for (iree_host_size_t i = 0; i < IREE_TOOLING_HISTOGRAM_BUCKET_COUNT; ++i) {
+    running_count += histogram->counts[i];
+    if (running_count >= target_count) {
+      return iree_tooling_histogram_clamp(
+          histogram, iree_tooling_histogram_bucket_highest_value(i));
+    }
+  }
+  return histogram->max_value;
+}
+
+void iree_tooling_histogram_fprint_percentiles(
+    FILE* file, const iree_tooling_histogram_t* histogram, double value_scale) {
+  fprintf(file, "%12s %14s %10s %14s\n\n", "Value", "Percentile", "TotalCount",
+          "1/(1-Percentile)");
+  uint64_t running_count = 0;
+  for (iree_host_size_t i = 0; i < IREE_TOOLING_HISTOGRAM_BUCKET_COUNT; ++i) {
+    if (!histogram->counts[i]) continue;
+    running_count += histogram->counts[i];
+    const double value =
+        (double)iree_tooling_histogram_clamp(
+            histogram, iree_tooling_histogram_bucket_highest_value(i)) /
+        value_scale;
+    const double fraction =
+        (double)running_count / (double)histogram->total_count;
+    if (running_count < histogram->total_count) {
+      fprintf(file, "%12.3f %2.12f %10" PRIu64 " %14.2f\n", value, fraction,
+              running_count, 1.0 / (1.0 - fraction));
+    } else {
+      fprintf(file, "%12.3f %2.12f %10" PRIu64 "\n", value, fraction,
+              running_count);
+    }
+  }
+  fprintf(file, "#[Mean    = %12.3f, Max           = %12.3f]\n",
+          iree_tooling_histogram_mean(histogram) / value_scale,
+          (double)histogram->max_value / value_scale);
+  fprintf(file, "#[Total count    = %12" PRIu64 "]\n", histogram->total_count);
+}
@@ -0,0 +1,85 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===----------------------------------------------------------------------===//
+// HDR-style latency histogram
+//===----------------------------------------------------------------------===//
+//
+// Records non-negative 64-bit values (usually nanosecond latencies) into
+// log-linear buckets with a bounded relative error in the same manner as
+// HdrHistogram (http://hdrhistogram.org/). Values below
+// 2^IREE_TOOLING_HISTOGRAM_PRECISION_BITS are recorded exactly and larger
+// values are recorded with a relative error of at most
+// 1/2^(IREE_TOOLING_HISTOGRAM_PRECISION_BITS-1) (~0.8%). The full int64 range
+// is covered without configuration and recording is O(1) with no allocation.
+//
+// Histograms are not thread-safe; record into one histogram per thread and
+// merge them when reporting.
+
+#ifndef IREE_TOOLING_HISTOGRAM_H_
+#define IREE_TOOLING_HISTOGRAM_H_
+
+#include <stdio.h>
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Number of bits of each value recorded exactly.
+#define IREE_TOOLING_HISTOGRAM_PRECISION_BITS 8
+
+// Total number of buckets required to cover all non-negative int64 values.
+#define IREE_TOOLING_HISTOGRAM_BUCKET_COUNT         \
+  ((1 << IREE_TOOLING_HISTOGRAM_PRECISION_BITS) +   \
+   (64 - IREE_TOOLING_HISTOGRAM_PRECISION_BITS) *   \
+       (1 << (IREE_TOOLING_HISTOGRAM_PRECISION_BITS - 1)))
+
+typedef struct iree_tooling_histogram_t {
+  // Total number of recorded values.
+  uint64_t total_count;
+  // Smallest and largest recorded values (exact).
+  int64_t min_value;
+  int64_t max_value;
+  // Sum of all recorded values used to compute the mean.
+  double sum;
+  // Per-bucket counts.
+  uint64_t counts[IREE_TOOLING_HISTOGRAM_BUCKET_COUNT];
+} iree_tooling_histogram_t;
+
+// Initializes |out_histogram| to empty.
+void iree_tooling_histogram_initialize(iree_tooling_histogram_t* out_histogram);
+
+// Records a single |value|. Negative values are recorded as 0.
+void iree_tooling_histogram_record(iree_tooling_histogram_t* histogram,
+                                   int64_t value);
+
+// Adds all values recorded in |source| to |target|.
+void iree_tooling_histogram_merge(iree_tooling_histogram_t* target,
+                                  const iree_tooling_histogram_t* source);
+
+// Returns the mean of all recorded values or 0 if empty.
+double iree_tooling_histogram_mean(const iree_tooling_histogram_t* histogram);
+
+// Returns the value at the given |percentile| in [0, 100]. The value returned
+// is the largest value equivalent (within the histogram precision) to the
+// value at the percentile and is clamped to the recorded min/max. Returns 0
+// if empty.
+int64_t iree_tooling_histogram_value_at_percentile(
+    const iree_tooling_histogram_t* histogram, double percentile);
+
+// Prints the percentile distribution of |histogram| to |file| in the
+// HdrHistogram text format (.hgrm) with values divided by |value_scale|.
+// The output can be plotted with the HdrHistogram plotter.
+void iree_tooling_histogram_fprint_percentiles(
+    FILE* file, const iree_tooling_histogram_t* histogram, double value_scale);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_TOOLING_HISTOGRAM_H_
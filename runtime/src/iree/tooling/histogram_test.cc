@@ -0,0 +1,104 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/tooling/histogram.h"
+
+#include <cstdint>
+#include <memory>
+
+#include "iree/testing/gtest.h"
+
+namespace iree {
+namespace {
+
+struct HistogramTest : public ::testing::Test {
+  void SetUp() override {
+    histogram = std::make_unique<iree_tooling_histogram_t>();
+    iree_tooling_histogram_initialize(histogram.get());
+  }
+  std::unique_ptr<iree_tooling_histogram_t> histogram;
+};
+
+TEST_F(HistogramTest, Empty) {
+  EXPECT_EQ(histogram->total_count, 0u);
+  EXPECT_EQ(iree_tooling_histogram_mean(histogram.get()), 0.0);
+  EXPECT_EQ(iree_tooling_histogram_value_at_percentile(histogram.get(), 50.0),
+            0);
+}
+
+// Values below 2^PRECISION_BITS are recorded exactly.
+TEST_F(HistogramTest, SmallValuesExact) {
+  for (int64_t i = 1; i <= 100; ++i) {
+    iree_tooling_histogram_record(histogram.get(), i);
+  }
+  EXPECT_EQ(histogram->total_count, 100u);
+  EXPECT_EQ(histogram->min_value, 1);
+  EXPECT_EQ(histogram->max_value, 100);
+  EXPECT_DOUBLE_EQ(iree_tooling_histogram_mean(histogram.get()), 50.5);
+  EXPECT_EQ(iree_tooling_histogram_value_at_percentile(histogram.get(), 0.0),
+            1);
+  EXPECT_EQ(iree_tooling_histogram_value_at_percentile(histogram.get(), 50.0),
+            50);
+  EXPECT_EQ(iree_tooling_histogram_value_at_percentile(histogram.get(), 99.0),
+            99);
+  EXPECT_EQ(iree_tooling_histogram_value_at_percentile(histogram.get(), 100.0),
+            100);
+}
+
+// Large values are recorded within the relative error bound.
+TEST_F(HistogramTest, LargeValuesRelativeError) {
+  const double max_error =
+      1.0 / (double)(1 << (IREE_TOOLING_HISTOGRAM_PRECISION_BITS - 1));
+  for (int64_t value = 257; value < INT64_MAX / 3; value = value * 3 + 1) {
+    iree_tooling_histogram_t single;
+    iree_tooling_histogram_initialize(&single);
+    iree_tooling_histogram_record(&single, value);
+    iree_tooling_histogram_record(&single, INT64_MAX);
+    int64_t p50 = iree_tooling_histogram_value_at_percentile(&single, 50.0);
+    EXPECT_GE(p50, value);
+    EXPECT_LE((double)(p50 - value) / (double)value, max_error) << value;
+  }
+}
+
+TEST_F(HistogramTest, NegativeValuesClamped) {
+  iree_tooling_histogram_record(histogram.get(), -5);
+  EXPECT_EQ(histogram->min_value, 0);
+  EXPECT_EQ(iree_tooling_histogram_value_at_percentile(histogram.get(), 50.0),
+            0);
+}
+
+TEST_F(HistogramTest, Percentiles) {
+  // 990 fast values and 10 slow ones: p99 is fast and p99.9 is slow.
+  for (int i = 0; i < 990; ++i) {
+    iree_tooling_histogram_record(histogram.get(), 1000000);
+  }
+  for (int i = 0; i < 10; ++i) {
+    iree_tooling_histogram_record(histogram.get(), 50000000);
+  }
+  int64_t p99 = iree_tooling_histogram_value_at_percentile(histogram.get(), 99);
+  int64_t p999 =
+      iree_tooling_histogram_value_at_percentile(histogram.get(), 99.9);
+  EXPECT_GE(p99, 1000000);
+  EXPECT_LT(p99, 1010000);
+  EXPECT_EQ(p999, 50000000);  // clamped to max
+}
+
+TEST_F(HistogramTest, Merge) {
+  auto other = std::make_unique<iree_tooling_histogram_t>();
+  iree_tooling_histogram_initialize(other.get());
+  iree_tooling_histogram_record(histogram.get(), 10);
+  iree_tooling_histogram_record(other.get(), 5);
+  iree_tooling_histogram_record(other.get(), 20);
+  iree_tooling_histogram_merge(histogram.get(), other.get());
+  EXPECT_EQ(histogram->total_count, 3u);
+  EXPECT_EQ(histogram->min_value, 5);
+  EXPECT_EQ(histogram->max_value, 20);
+  EXPECT_EQ(iree_tooling_histogram_value_at_percentile(histogram.get(), 50.0),
+            10);
+}
+
+}  // namespace
+}  // namespace iree
@@ -6,8 +6,31 @@
 
 #include "iree/tooling/numpy_io.h"
 
+#include <errno.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/file_io.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
 #include "iree/base/tracing.h"
 
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define IREE_NUMPY_HAVE_MMAP 1
+#else
+#define IREE_NUMPY_HAVE_MMAP 0
+#endif  // IREE_PLATFORM_*
+
+#if !defined(IREE_PLATFORM_WINDOWS)
+#include <sys/types.h>  // off_t
+#endif  // !IREE_PLATFORM_WINDOWS
+
 //===----------------------------------------------------------------------===//
 // .npy (multiple values concatenated)
 //===----------------------------------------------------------------------===//
@@ -295,35 +318,33 @@ static iree_status_t iree_numpy_parse_shape_dims(iree_string_view_t shape,
   return iree_ok_status();
 }
 
-IREE_API_EXPORT iree_status_t
-iree_numpy_npy_load_ndarray(FILE* stream, iree_numpy_npy_load_options_t options,
-                            iree_hal_buffer_params_t buffer_params,
-                            iree_hal_allocator_t* device_allocator,
-                            iree_hal_buffer_view_t** out_buffer_view) {
-  IREE_ASSERT_ARGUMENT(stream);
-  IREE_ASSERT_ARGUMENT(device_allocator);
-  IREE_ASSERT_ARGUMENT(out_buffer_view);
-  *out_buffer_view = NULL;
-  IREE_TRACE_ZONE_BEGIN(z0);
-  iree_allocator_t host_allocator =
-      iree_hal_allocator_host_allocator(device_allocator);
+// Maximum supported array rank.
+#define IREE_NUMPY_NPY_MAX_SHAPE_RANK 128
 
-  // Quick check for EOF; if already there we can give a better error than
-  // if we failed trying to parse the header. Since npy files are often
-  // concatenated callers are likely to be using this in a loop and checking for
-  // this condition, even if it'd be better if they did it themselves.
-  if (feof(stream)) {
-    IREE_TRACE_ZONE_END(z0);
-    return iree_make_status(IREE_STATUS_OUT_OF_RANGE, "end-of-file");
-  }
+// Parsed array header describing the contents of an ndarray payload.
+typedef struct iree_numpy_npy_array_header_t {
+  iree_hal_element_type_t element_type;
+  iree_hal_encoding_type_t encoding_type;
+  iree_host_size_t shape_rank;
+  iree_hal_dim_t shape[IREE_NUMPY_NPY_MAX_SHAPE_RANK];
+} iree_numpy_npy_array_header_t;
+
+// Reads and parses the array header from |stream|.
+// Upon successful return the |stream| will be positioned immediately at the
+// start of the array payload.
+static iree_status_t iree_numpy_npy_parse_array_header(
+    FILE* stream, iree_allocator_t host_allocator,
+    iree_numpy_npy_array_header_t* out_header) {
+  out_header->element_type = IREE_HAL_ELEMENT_TYPE_NONE;
+  out_header->encoding_type = IREE_HAL_ENCODING_TYPE_OPAQUE;
+  out_header->shape_rank = 0;
 
   // Read header string.
   // The resulting header must be freed with host_allocator.
   char* header_buffer = NULL;
   iree_host_size_t header_length = 0;
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_numpy_npy_read_header(stream, host_allocator, &header_length,
-                                     &header_buffer));
+  IREE_RETURN_IF_ERROR(iree_numpy_npy_read_header(
+      stream, host_allocator, &header_length, &header_buffer));
   iree_string_view_t header = iree_string_view_trim(
       iree_make_string_view(header_buffer, header_length));
 
@@ -335,10 +356,6 @@ iree_numpy_npy_load_ndarray(FILE* stream, iree_numpy_npy_load_options_t options,
   // also be keys we don't understand such as when what's saved is a pickled
   // object. We implement a basic scanning parser here and try to deal with it.
   iree_status_t status = iree_ok_status();
-  iree_host_size_t shape_rank = 0;
-  iree_hal_dim_t* shape = NULL;
-  iree_hal_element_type_t element_type = IREE_HAL_ELEMENT_TYPE_NONE;
-  iree_hal_encoding_type_t encoding_type = IREE_HAL_ENCODING_TYPE_OPAQUE;
   iree_string_view_consume_prefix(&header, IREE_SV("{"));
   iree_string_view_consume_suffix(&header, IREE_SV("}"));
   while (!iree_string_view_is_empty(header)) {
@@ -348,43 +365,73 @@ iree_numpy_npy_load_ndarray(FILE* stream, iree_numpy_npy_load_options_t options,
     if (!iree_status_is_ok(status)) break;
 
     if (iree_string_view_equal(key, IREE_SV("descr"))) {
-      status = iree_numpy_descr_to_element_type(value, &element_type);
+      status =
+          iree_numpy_descr_to_element_type(value, &out_header->element_type);
     } else if (iree_string_view_equal(key, IREE_SV("fortran_order"))) {
       if (iree_string_view_equal(value, IREE_SV("False"))) {
-        encoding_type = IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR;
+        out_header->encoding_type = IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR;
       } else {
         status = iree_make_status(IREE_STATUS_UNIMPLEMENTED,
                                   "fortran order arrays not supported");
       }
     } else if (iree_string_view_equal(key, IREE_SV("shape"))) {
-      shape_rank = iree_numpy_parse_shape_rank(value);
-      if (shape_rank > 128) {
+      iree_host_size_t shape_rank = iree_numpy_parse_shape_rank(value);
+      if (shape_rank > IREE_NUMPY_NPY_MAX_SHAPE_RANK) {
         status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                                   "shape rank %" PRIhsz
-                                  " too large; be reasonable please");
+                                  " too large; be reasonable please",
+                                  shape_rank);
       } else {
-        shape = iree_alloca(shape_rank * sizeof(*shape));
-        status = iree_numpy_parse_shape_dims(value, shape_rank, shape);
+        out_header->shape_rank = shape_rank;
+        status =
+            iree_numpy_parse_shape_dims(value, shape_rank, out_header->shape);
       }
     }
     if (!iree_status_is_ok(status)) break;
   }
 
+  iree_allocator_free(host_allocator, header_buffer);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t
+iree_numpy_npy_load_ndarray(FILE* stream, iree_numpy_npy_load_options_t options,
+                            iree_hal_buffer_params_t buffer_params,
+                            iree_hal_allocator_t* device_allocator,
+                            iree_hal_buffer_view_t** out_buffer_view) {
+  IREE_ASSERT_ARGUMENT(stream);
+  IREE_ASSERT_ARGUMENT(device_allocator);
+  IREE_ASSERT_ARGUMENT(out_buffer_view);
+  *out_buffer_view = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator =
+      iree_hal_allocator_host_allocator(device_allocator);
+
+  // Quick check for EOF; if already there we can give a better error than
+  // if we failed trying to parse the header. Since npy files are often
+  // concatenated callers are likely to be using this in a loop and checking for
+  // this condition, even if it'd be better if they did it themselves.
+  if (feof(stream)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE, "end-of-file");
+  }
+
+  iree_numpy_npy_array_header_t header;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_numpy_npy_parse_array_header(stream, host_allocator, &header));
+
   // Allocate the buffer view and directly read into the allocated memory.
   // On targets where we can perform host mapping this will be zero-copy; on
   // others it'll at least be _somewhat_ efficient.
-  if (iree_status_is_ok(status)) {
-    iree_numpy_npy_read_params_t read_params = {
-        .stream = stream,
-    };
-    buffer_params.access |= IREE_HAL_MEMORY_ACCESS_DISCARD_WRITE;
-    status = iree_hal_buffer_view_generate_buffer(
-        device_allocator, shape_rank, shape, element_type, encoding_type,
-        buffer_params, iree_numpy_npy_read_into_mapping, &read_params,
-        out_buffer_view);
-  }
+  iree_numpy_npy_read_params_t read_params = {
+      .stream = stream,
+  };
+  buffer_params.access |= IREE_HAL_MEMORY_ACCESS_DISCARD_WRITE;
+  iree_status_t status = iree_hal_buffer_view_generate_buffer(
+      device_allocator, header.shape_rank, header.shape, header.element_type,
+      header.encoding_type, buffer_params, iree_numpy_npy_read_into_mapping,
+      &read_params, out_buffer_view);
 
-  iree_allocator_free(host_allocator, header_buffer);
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
@@ -625,3 +672,792 @@ IREE_API_EXPORT iree_status_t iree_numpy_npy_save_ndarray(
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
+
+//===----------------------------------------------------------------------===//
+// .npz (zip archive of .npy files)
+//===----------------------------------------------------------------------===//
+
+// File format spec:
+// https://pkware.cachefly.net/webdocs/casestudies/APPNOTE.TXT
+//
+// numpy.savez produces a zip archive with one stored (uncompressed) entry per
+// array named `{name}.npy`. Entries are located using the central directory at
+// the end of the archive and each entry payload is a complete .npy file.
+// numpy forces zip64 local headers and large archives use zip64 central
+// directory records so both are handled.
+
+#define IREE_NUMPY_ZIP_LOCAL_FILE_HEADER_SIGNATURE 0x04034B50u
+#define IREE_NUMPY_ZIP_CENTRAL_FILE_HEADER_SIGNATURE 0x02014B50u
+#define IREE_NUMPY_ZIP_END_OF_CENTRAL_DIRECTORY_SIGNATURE 0x06054B50u
+#define IREE_NUMPY_ZIP64_END_OF_CENTRAL_DIRECTORY_SIGNATURE 0x06064B50u
+#define IREE_NUMPY_ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIGNATURE 0x07064B50u
+#define IREE_NUMPY_ZIP64_EXTRA_FIELD_ID 0x0001u
+
+// Fixed sizes of the zip records (excluding variable-length fields).
+#define IREE_NUMPY_ZIP_LOCAL_FILE_HEADER_SIZE 30
+#define IREE_NUMPY_ZIP_CENTRAL_FILE_HEADER_SIZE 46
+#define IREE_NUMPY_ZIP_END_OF_CENTRAL_DIRECTORY_SIZE 22
+#define IREE_NUMPY_ZIP64_END_OF_CENTRAL_DIRECTORY_SIZE 56
+#define IREE_NUMPY_ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIZE 20
+
+// Maximum size of the trailing archive comment that may follow the end of
+// central directory record.
+#define IREE_NUMPY_ZIP_MAX_COMMENT_SIZE 0xFFFF
+
+// Seeks |stream| to the absolute 64-bit |offset|. Returns 0 on success.
+// `fseek`/`ftell` use `long` which is 32 bits on some platforms; archives may
+// be larger than that.
+static int iree_numpy_fseek64(FILE* stream, uint64_t offset) {
+  if (offset > (uint64_t)INT64_MAX) return -1;
+#if defined(IREE_PLATFORM_WINDOWS)
+  return _fseeki64(stream, (__int64)offset, SEEK_SET);
+#else
+  // off_t may be 32 bits on 32-bit hosts without _FILE_OFFSET_BITS=64.
+  if ((uint64_t)(off_t)offset != offset) return -1;
+  return fseeko(stream, (off_t)offset, SEEK_SET);
+#endif  // IREE_PLATFORM_WINDOWS
+}
+
+// Returns the absolute 64-bit offset of |stream| or -1 on failure.
+static int64_t iree_numpy_ftell64(FILE* stream) {
+#if defined(IREE_PLATFORM_WINDOWS)
+  return (int64_t)_ftelli64(stream);
+#else
+  return (int64_t)ftello(stream);
+#endif  // IREE_PLATFORM_WINDOWS
+}
+
+static inline uint16_t iree_numpy_load_le_u16(const uint8_t* p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t iree_numpy_load_le_u32(const uint8_t* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+
+static inline uint64_t iree_numpy_load_le_u64(const uint8_t* p) {
+  return (uint64_t)iree_numpy_load_le_u32(p) |
+         ((uint64_t)iree_numpy_load_le_u32(p + 4) << 32);
+}
+
+// Reads exactly |length| bytes at |offset| in |stream| into |buffer|.
+static iree_status_t iree_numpy_read_at(FILE* stream, uint64_t offset,
+                                        void* buffer, iree_host_size_t length) {
+  if (iree_numpy_fseek64(stream, offset) != 0) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "failed to seek to offset %" PRIu64, offset);
+  }
+  if (fread(buffer, 1, length, stream) != length) {
+    return iree_make_status(
+        IREE_STATUS_OUT_OF_RANGE,
+        "failed to read %" PRIhsz " bytes at offset %" PRIu64, length, offset);
+  }
+  return iree_ok_status();
+}
+
+// A single array entry in an npz archive.
+typedef struct iree_numpy_npz_entry_t {
+  // Entry name without the `.npy` suffix. Points into the entry name storage.
+  iree_string_view_t name;
+  // Offset of the local file header of the entry.
+  uint64_t header_offset;
+  // Length of the entry payload (a complete .npy file).
+  uint64_t length;
+} iree_numpy_npz_entry_t;
+
+// Locates the central directory of the archive in |stream| of |file_length|.
+static iree_status_t iree_numpy_npz_find_central_directory(
+    FILE* stream, uint64_t file_length, iree_allocator_t host_allocator,
+    uint64_t* out_directory_offset, uint64_t* out_directory_length,
+    uint64_t* out_entry_count) {
+  // Scan backwards over the trailing bytes that may contain the end of central
+  // directory record and the archive comment.
+  iree_host_size_t tail_length = (iree_host_size_t)iree_min(
+      file_length, (uint64_t)(IREE_NUMPY_ZIP_END_OF_CENTRAL_DIRECTORY_SIZE +
+                              IREE_NUMPY_ZIP_MAX_COMMENT_SIZE));
+  if (tail_length < IREE_NUMPY_ZIP_END_OF_CENTRAL_DIRECTORY_SIZE) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "file too small to be an npz archive");
+  }
+  uint8_t* tail = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(host_allocator, tail_length, (void**)&tail));
+  const uint64_t tail_offset = file_length - tail_length;
+  iree_status_t status =
+      iree_numpy_read_at(stream, tail_offset, tail, tail_length);
+  const uint8_t* eocd = NULL;
+  if (iree_status_is_ok(status)) {
+    for (iree_host_size_t i =
+             tail_length - IREE_NUMPY_ZIP_END_OF_CENTRAL_DIRECTORY_SIZE + 1;
+         i > 0; --i) {
+      if (iree_numpy_load_le_u32(tail + i - 1) ==
+          IREE_NUMPY_ZIP_END_OF_CENTRAL_DIRECTORY_SIGNATURE) {
+        eocd = tail + i - 1;
+        break;
+      }
+    }
+    if (!eocd) {
+      status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "npz end of central directory not found; "
+                                "file is not a zip archive");
+    }
+  }
+  uint64_t entry_count = 0;
+  uint64_t directory_length = 0;
+  uint64_t directory_offset = 0;
+  if (iree_status_is_ok(status)) {
+    entry_count = iree_numpy_load_le_u16(eocd + 10);
+    directory_length = iree_numpy_load_le_u32(eocd + 12);
+    directory_offset = iree_numpy_load_le_u32(eocd + 16);
+  }
+
+  // If any field is saturated the real values live in the zip64 record that
+  // is referenced by the locator immediately preceding the classic record.
+  if (iree_status_is_ok(status) &&
+      (entry_count == 0xFFFF || directory_length == 0xFFFFFFFFu ||
+       directory_offset == 0xFFFFFFFFu)) {
+    const uint64_t eocd_offset = tail_offset + (uint64_t)(eocd - tail);
+    uint8_t locator[IREE_NUMPY_ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIZE];
+    uint8_t record[IREE_NUMPY_ZIP64_END_OF_CENTRAL_DIRECTORY_SIZE];
+    if (eocd_offset < sizeof(locator)) {
+      status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "npz zip64 locator missing");
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_numpy_read_at(stream, eocd_offset - sizeof(locator),
+                                  locator, sizeof(locator));
+    }
+    if (iree_status_is_ok(status) &&
+        iree_numpy_load_le_u32(locator) !=
+            IREE_NUMPY_ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIGNATURE) {
+      status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "npz zip64 locator signature mismatch");
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_numpy_read_at(stream, iree_numpy_load_le_u64(locator + 8),
+                                  record, sizeof(record));
+    }
+    if (iree_status_is_ok(status) &&
+        iree_numpy_load_le_u32(record) !=
+            IREE_NUMPY_ZIP64_END_OF_CENTRAL_DIRECTORY_SIGNATURE) {
+      status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "npz zip64 end of central directory signature "
+                                "mismatch");
+    }
+    if (iree_status_is_ok(status)) {
+      entry_count = iree_numpy_load_le_u64(record + 32);
+      directory_length = iree_numpy_load_le_u64(record + 40);
+      directory_offset = iree_numpy_load_le_u64(record + 48);
+    }
+  }
+
+  if (iree_status_is_ok(status) &&
+      (directory_offset > file_length ||
+       directory_length > file_length - directory_offset)) {
+    status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "npz central directory out of bounds");
+  }
+
+  iree_allocator_free(host_allocator, tail);
+  if (iree_status_is_ok(status)) {
+    *out_directory_offset = directory_offset;
+    *out_directory_length = directory_length;
+    *out_entry_count = entry_count;
+  }
+  return status;
+}
+
+// Parses the zip64 extended information extra field in |extra| and replaces
+// the saturated values in |inout_length| and |inout_header_offset|. Fields
+// appear in a fixed order and only when saturated in the fixed header.
+static iree_status_t iree_numpy_npz_parse_zip64_extra(
+    iree_const_byte_span_t extra, uint32_t uncompressed_length,
+    uint32_t compressed_length, uint64_t* inout_length,
+    uint64_t* inout_header_offset) {
+  iree_host_size_t offset = 0;
+  while (offset + 4 <= extra.data_length) {
+    const uint16_t id = iree_numpy_load_le_u16(extra.data + offset);
+    const uint16_t size = iree_numpy_load_le_u16(extra.data + offset + 2);
+    offset += 4;
+    if (offset + size > extra.data_length) break;
+    if (id == IREE_NUMPY_ZIP64_EXTRA_FIELD_ID) {
+      const uint8_t* field = extra.data + offset;
+      const uint8_t* field_end = field + size;
+      if (uncompressed_length == 0xFFFFFFFFu) {
+        if (field + 8 > field_end) break;
+        *inout_length = iree_numpy_load_le_u64(field);
+        field += 8;
+      }
+      if (compressed_length == 0xFFFFFFFFu) {
+        // Identical to the uncompressed length for stored entries.
+        if (field + 8 > field_end) break;
+        field += 8;
+      }
+      if (*inout_header_offset == 0xFFFFFFFFu) {
+        if (field + 8 > field_end) break;
+        *inout_header_offset = iree_numpy_load_le_u64(field);
+      }
+      return iree_ok_status();
+    }
+    offset += size;
+  }
+  if (uncompressed_length == 0xFFFFFFFFu ||
+      *inout_header_offset == 0xFFFFFFFFu) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "npz entry missing zip64 extended information");
+  }
+  return iree_ok_status();
+}
+
+// Parses all entries in the central directory.
+// |out_entries| must be freed by the caller with |host_allocator| and entry
+// names point into the same allocation.
+static iree_status_t iree_numpy_npz_parse_entries(
+    FILE* stream, uint64_t file_length, iree_allocator_t host_allocator,
+    iree_host_size_t* out_entry_count, iree_numpy_npz_entry_t** out_entries) {
+  *out_entry_count = 0;
+  *out_entries = NULL;
+
+  uint64_t directory_offset = 0;
+  uint64_t directory_length = 0;
+  uint64_t entry_count = 0;
+  IREE_RETURN_IF_ERROR(iree_numpy_npz_find_central_directory(
+      stream, file_length, host_allocator, &directory_offset, &directory_length,
+      &entry_count));
+  if (directory_length > IREE_HOST_SIZE_MAX ||
+      entry_count * IREE_NUMPY_ZIP_CENTRAL_FILE_HEADER_SIZE >
+          directory_length) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "npz central directory malformed");
+  }
+
+  // Entries are followed by the raw central directory which the entry names
+  // reference.
+  const iree_host_size_t entries_size =
+      (iree_host_size_t)entry_count * sizeof(iree_numpy_npz_entry_t);
+  uint8_t* storage = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      host_allocator, entries_size + (iree_host_size_t)directory_length,
+      (void**)&storage));
+  iree_numpy_npz_entry_t* entries = (iree_numpy_npz_entry_t*)storage;
+  uint8_t* directory = storage + entries_size;
+  iree_status_t status = iree_numpy_read_at(
+      stream, directory_offset, directory, (iree_host_size_t)directory_length);
+
+  iree_host_size_t offset = 0;
+  for (iree_host_size_t i = 0; i < entry_count && iree_status_is_ok(status);
+       ++i) {
+    if (offset + IREE_NUMPY_ZIP_CENTRAL_FILE_HEADER_SIZE > directory_length) {
+      status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "npz central directory truncated");
+      break;
+    }
+    const uint8_t* header = directory + offset;
+    if (iree_numpy_load_le_u32(header) !=
+        IREE_NUMPY_ZIP_CENTRAL_FILE_HEADER_SIGNATURE) {
+      status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "npz central directory signature mismatch");
+      break;
+    }
+    const uint16_t flags = iree_numpy_load_le_u16(header + 8);
+    const uint16_t compression_method = iree_numpy_load_le_u16(header + 10);
+    const uint32_t compressed_length = iree_numpy_load_le_u32(header + 20);
+    const uint32_t uncompressed_length = iree_numpy_load_le_u32(header + 24);
+    const uint16_t name_length = iree_numpy_load_le_u16(header + 28);
+    const uint16_t extra_length = iree_numpy_load_le_u16(header + 30);
+    const uint16_t comment_length = iree_numpy_load_le_u16(header + 32);
+    const uint64_t record_length = IREE_NUMPY_ZIP_CENTRAL_FILE_HEADER_SIZE +
+                                   name_length + extra_length + comment_length;
+    if (offset + record_length > directory_length) {
+      status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "npz central directory truncated");
+      break;
+    }
+    iree_string_view_t name = iree_make_string_view(
+        (const char*)header + IREE_NUMPY_ZIP_CENTRAL_FILE_HEADER_SIZE,
+        name_length);
+    if (flags & 0x1) {
+      status = iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                                "npz entry '%.*s' is encrypted", (int)name.size,
+                                name.data);
+      break;
+    } else if (compression_method != 0) {
+      status = iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                                "npz entry '%.*s' is compressed (method %u); "
+                                "only numpy.savez (not savez_compressed) "
+                                "archives are supported",
+                                (int)name.size, name.data, compression_method);
+      break;
+    }
+    uint64_t length = uncompressed_length;
+    uint64_t header_offset = iree_numpy_load_le_u32(header + 42);
+    status = iree_numpy_npz_parse_zip64_extra(
+        iree_make_const_byte_span(header +
+                                      IREE_NUMPY_ZIP_CENTRAL_FILE_HEADER_SIZE +
+                                      name_length,
+                                  extra_length),
+        uncompressed_length, compressed_length, &length, &header_offset);
+    if (!iree_status_is_ok(status)) break;
+    if (header_offset > file_length || length > file_length - header_offset) {
+      status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "npz entry '%.*s' out of bounds",
+                                (int)name.size, name.data);
+      break;
+    }
+    iree_string_view_consume_suffix(&name, IREE_SV(".npy"));
+    entries[i].name = name;
+    entries[i].header_offset = header_offset;
+    entries[i].length = length;
+    offset += (iree_host_size_t)record_length;
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_entry_count = (iree_host_size_t)entry_count;
+    *out_entries = entries;
+  } else {
+    iree_allocator_free(host_allocator, storage);
+  }
+  return status;
+}
+
+// A read-only mapping of an npz archive shared by all buffers imported from it.
+// The mapping is released when the last buffer referencing it is released.
+typedef struct iree_numpy_npz_mapping_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  uint8_t* data;
+  uint64_t length;
+} iree_numpy_npz_mapping_t;
+
+#if IREE_NUMPY_HAVE_MMAP
+
+static iree_status_t iree_numpy_npz_mapping_create(
+    const char* path, iree_allocator_t host_allocator,
+    iree_numpy_npz_mapping_t** out_mapping) {
+  *out_mapping = NULL;
+  int fd = open(path, O_RDONLY);
+  if (fd == -1) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to open '%s' for mapping", path);
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == -1) {
+    close(fd);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to stat '%s'", path);
+  }
+  if (file_stat.st_size == 0 ||
+      (uint64_t)file_stat.st_size > IREE_HOST_SIZE_MAX) {
+    close(fd);
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "file '%s' cannot be mapped", path);
+  }
+  // Mapped privately so that writes through imported buffers (if the device
+  // allows them) are copy-on-write and never reach the file.
+  void* data = mmap(NULL, (size_t)file_stat.st_size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to map '%s'", path);
+  }
+  iree_numpy_npz_mapping_t* mapping = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      host_allocator, sizeof(*mapping), (void**)&mapping);
+  if (!iree_status_is_ok(status)) {
+    munmap(data, (size_t)file_stat.st_size);
+    return status;
+  }
+  iree_atomic_ref_count_init(&mapping->ref_count);
+  mapping->host_allocator = host_allocator;
+  mapping->data = (uint8_t*)data;
+  mapping->length = (uint64_t)file_stat.st_size;
+  *out_mapping = mapping;
+  return iree_ok_status();
+}
+
+static void iree_numpy_npz_mapping_destroy(iree_numpy_npz_mapping_t* mapping) {
+  munmap(mapping->data, (size_t)mapping->length);
+  iree_allocator_free(mapping->host_allocator, mapping);
+}
+
+#else
+
+static iree_status_t iree_numpy_npz_mapping_create(
+    const char* path, iree_allocator_t host_allocator,
+    iree_numpy_npz_mapping_t** out_mapping) {
+  *out_mapping = NULL;
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "file mapping not available on this platform");
+}
+
+static void iree_numpy_npz_mapping_destroy(iree_numpy_npz_mapping_t* mapping) {}
+
+#endif  // IREE_NUMPY_HAVE_MMAP
+
+static void iree_numpy_npz_mapping_retain(iree_numpy_npz_mapping_t* mapping) {
+  if (mapping) iree_atomic_ref_count_inc(&mapping->ref_count);
+}
+
+static void iree_numpy_npz_mapping_release(iree_numpy_npz_mapping_t* mapping) {
+  if (mapping && iree_atomic_ref_count_dec(&mapping->ref_count) == 1) {
+    iree_numpy_npz_mapping_destroy(mapping);
+  }
+}
+
+static void iree_numpy_npz_mapping_buffer_release(void* user_data,
+                                                  iree_hal_buffer_t* buffer) {
+  iree_numpy_npz_mapping_release((iree_numpy_npz_mapping_t*)user_data);
+}
+
+static iree_status_t iree_numpy_copy_into_mapping(
+    iree_hal_buffer_mapping_t* mapping, void* user_data) {
+  memcpy(mapping->contents.data, user_data, mapping->contents.data_length);
+  return iree_ok_status();
+}
+
+// Shared state of a (possibly parallel) npz load operation.
+typedef struct iree_numpy_npz_loader_t {
+  const char* path;
+  iree_hal_buffer_params_t buffer_params;
+  iree_hal_allocator_t* device_allocator;
+  iree_allocator_t host_allocator;
+  // Optional mapping of the entire archive.
+  iree_numpy_npz_mapping_t* mapping;
+  iree_host_size_t entry_count;
+  const iree_numpy_npz_entry_t* entries;
+  // Loaded buffer views indexed by entry ordinal.
+  iree_hal_buffer_view_t** buffer_views;
+  // Next entry ordinal to be claimed by a worker.
+  iree_atomic_int64_t next_entry;
+  // Set when any worker fails so that others can stop early.
+  iree_atomic_int32_t failed;
+  // Number of worker threads that have not yet exited.
+  iree_atomic_int32_t running_worker_count;
+  // Posted when a worker thread exits.
+  iree_notification_t worker_exit_notification;
+} iree_numpy_npz_loader_t;
+
+// Creates a buffer view for the array described by |header| with contents at
+// |data_offset| in the mapped archive by importing the mapped contents directly
+// when possible and otherwise copying from the mapping. Only contents aligned
+// to IREE_HAL_HEAP_BUFFER_ALIGNMENT are imported as executables assume aligned
+// bindings; zip entries start at arbitrary offsets so most are copied unless
+// the archive was written with aligned entries.
+static iree_status_t iree_numpy_npz_load_mapped_entry(
+    iree_numpy_npz_loader_t* loader,
+    const iree_numpy_npy_array_header_t* header, uint64_t data_offset,
+    iree_hal_buffer_view_t** out_buffer_view) {
+  iree_device_size_t byte_length = 0;
+  IREE_RETURN_IF_ERROR(iree_hal_buffer_compute_view_size(
+      header->shape_rank, header->shape, header->element_type,
+      header->encoding_type, &byte_length));
+  if (data_offset > loader->mapping->length ||
+      byte_length > loader->mapping->length - data_offset) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "npz array contents truncated");
+  }
+  uint8_t* data = loader->mapping->data + data_offset;
+
+  // Try to import the mapped memory; this is zero-copy on devices that can
+  // access host memory but may still be rejected by the allocator.
+  if (byte_length > 0 &&
+      iree_host_size_has_alignment((uintptr_t)data,
+                                   IREE_HAL_HEAP_BUFFER_ALIGNMENT)) {
+    iree_hal_external_buffer_t external_buffer = {
+        .type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION,
+        .flags = 0,
+        .size = byte_length,
+        .handle.host_allocation.ptr = data,
+    };
+    iree_hal_buffer_release_callback_t release_callback = {
+        .fn = iree_numpy_npz_mapping_buffer_release,
+        .user_data = loader->mapping,
+    };
+    iree_numpy_npz_mapping_retain(loader->mapping);
+    iree_hal_buffer_t* buffer = NULL;
+    iree_status_t import_status = iree_hal_allocator_import_buffer(
+        loader->device_allocator, loader->buffer_params, &external_buffer,
+        release_callback, &buffer);
+    if (iree_status_is_ok(import_status)) {
+      iree_status_t status = iree_hal_buffer_view_create(
+          buffer, header->shape_rank, header->shape, header->element_type,
+          header->encoding_type, loader->host_allocator, out_buffer_view);
+      iree_hal_buffer_release(buffer);
+      return status;
+    }
+    iree_status_ignore(import_status);
+    iree_numpy_npz_mapping_release(loader->mapping);
+  }
+
+  iree_hal_buffer_params_t buffer_params = loader->buffer_params;
+  buffer_params.access |= IREE_HAL_MEMORY_ACCESS_DISCARD_WRITE;
+  return iree_hal_buffer_view_generate_buffer(
+      loader->device_allocator, header->shape_rank, header->shape,
+      header->element_type, header->encoding_type, buffer_params,
+      iree_numpy_copy_into_mapping, data, out_buffer_view);
+}
+
+// Loads the array in |entry| using |stream| for reading.
+static iree_status_t iree_numpy_npz_load_entry(
+    iree_numpy_npz_loader_t* loader, FILE* stream,
+    const iree_numpy_npz_entry_t* entry,
+    iree_hal_buffer_view_t** out_buffer_view) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Skip the local file header to reach the npy payload. The local header may
+  // have a different extra field length than the central directory record.
+  uint8_t local_header[IREE_NUMPY_ZIP_LOCAL_FILE_HEADER_SIZE];
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_numpy_read_at(stream, entry->header_offset, local_header,
+                             sizeof(local_header)));
+  if (iree_numpy_load_le_u32(local_header) !=
+      IREE_NUMPY_ZIP_LOCAL_FILE_HEADER_SIGNATURE) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "npz entry '%.*s' local header signature mismatch",
+                            (int)entry->name.size, entry->name.data);
+  }
+  const uint64_t npy_offset = entry->header_offset + sizeof(local_header) +
+                              iree_numpy_load_le_u16(local_header + 26) +
+                              iree_numpy_load_le_u16(local_header + 28);
+  if (iree_numpy_fseek64(stream, npy_offset) != 0) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "failed to seek to npz entry '%.*s'",
+                            (int)entry->name.size, entry->name.data);
+  }
+
+  // Parse the npy header, leaving the stream at the array contents.
+  iree_numpy_npy_array_header_t header;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_numpy_npy_parse_array_header(stream, loader->host_allocator,
+                                            &header));
+
+  iree_status_t status = iree_ok_status();
+  if (loader->mapping) {
+    const int64_t data_offset = iree_numpy_ftell64(stream);
+    if (data_offset < 0) {
+      status = iree_make_status(iree_status_code_from_errno(errno),
+                                "failed to query npz entry '%.*s' offset",
+                                (int)entry->name.size, entry->name.data);
+    } else {
+      status = iree_numpy_npz_load_mapped_entry(
+          loader, &header, (uint64_t)data_offset, out_buffer_view);
+    }
+  } else {
+    iree_numpy_npy_read_params_t read_params = {
+        .stream = stream,
+    };
+    iree_hal_buffer_params_t buffer_params = loader->buffer_params;
+    buffer_params.access |= IREE_HAL_MEMORY_ACCESS_DISCARD_WRITE;
+    status = iree_hal_buffer_view_generate_buffer(
+        loader->device_allocator, header.shape_rank, header.shape,
+        header.element_type, header.encoding_type, buffer_params,
+        iree_numpy_npy_read_into_mapping, &read_params, out_buffer_view);
+  }
+  if (!iree_status_is_ok(status)) {
+    status = iree_status_annotate_f(status, "loading npz entry '%.*s'",
+                                    (int)entry->name.size, entry->name.data);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Loads entries claimed from |loader| until none remain or any worker fails.
+// Each worker uses its own stream so that reads can proceed in parallel.
+static iree_status_t iree_numpy_npz_loader_run(
+    iree_numpy_npz_loader_t* loader) {
+  FILE* stream = fopen(loader->path, "rb");
+  if (!stream) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to open '%s'", loader->path);
+  }
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status) &&
+         !iree_atomic_load_int32(&loader->failed, iree_memory_order_acquire)) {
+    int64_t i = iree_atomic_fetch_add_int64(&loader->next_entry, 1,
+                                            iree_memory_order_relaxed);
+    if (i >= (int64_t)loader->entry_count) break;
+    status = iree_numpy_npz_load_entry(loader, stream, &loader->entries[i],
+                                       &loader->buffer_views[i]);
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_atomic_store_int32(&loader->failed, 1, iree_memory_order_release);
+  }
+  fclose(stream);
+  return status;
+}
+
+typedef struct iree_numpy_npz_worker_t {
+  iree_numpy_npz_loader_t* loader;
+  iree_thread_t* thread;
+  iree_status_t status;
+} iree_numpy_npz_worker_t;
+
+static int iree_numpy_npz_worker_main(void* entry_arg) {
+  iree_numpy_npz_worker_t* worker = (iree_numpy_npz_worker_t*)entry_arg;
+  iree_numpy_npz_loader_t* loader = worker->loader;
+  worker->status = iree_numpy_npz_loader_run(loader);
+  iree_atomic_fetch_sub_int32(&loader->running_worker_count, 1,
+                              iree_memory_order_acq_rel);
+  iree_notification_post(&loader->worker_exit_notification, IREE_ALL_WAITERS);
+  return 0;
+}
+
+static bool iree_numpy_npz_loader_workers_exited(void* arg) {
+  iree_numpy_npz_loader_t* loader = (iree_numpy_npz_loader_t*)arg;
+  return iree_atomic_load_int32(&loader->running_worker_count,
+                                iree_memory_order_acquire) == 0;
+}
+
+// Runs the |loader| on the calling thread and |worker_count| - 1 additional
+// threads.
+static iree_status_t iree_numpy_npz_loader_run_parallel(
+    iree_numpy_npz_loader_t* loader, iree_host_size_t worker_count) {
+  worker_count = iree_min(worker_count, loader->entry_count);
+  if (worker_count <= 1) return iree_numpy_npz_loader_run(loader);
+
+  iree_numpy_npz_worker_t* workers = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      loader->host_allocator, (worker_count - 1) * sizeof(*workers),
+      (void**)&workers));
+  memset(workers, 0, (worker_count - 1) * sizeof(*workers));
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < worker_count - 1; ++i) {
+    workers[i].loader = loader;
+    workers[i].status = iree_ok_status();
+    iree_thread_create_params_t params;
+    memset(&params, 0, sizeof(params));
+    params.name = IREE_SV("iree-npz-load");
+    iree_atomic_fetch_add_int32(&loader->running_worker_count, 1,
+                                iree_memory_order_relaxed);
+    status = iree_thread_create(iree_numpy_npz_worker_main, &workers[i], params,
+                                loader->host_allocator, &workers[i].thread);
+    if (!iree_status_is_ok(status)) {
+      iree_atomic_fetch_sub_int32(&loader->running_worker_count, 1,
+                                  iree_memory_order_relaxed);
+      iree_atomic_store_int32(&loader->failed, 1, iree_memory_order_release);
+      break;
+    }
+  }
+
+  // Participate on the calling thread and then wait for all workers to exit.
+  // Releasing a thread only joins it if the thread has already dropped its own
+  // reference so we can't rely on that to know when the workers are done.
+  if (iree_status_is_ok(status)) {
+    status = iree_numpy_npz_loader_run(loader);
+  }
+  iree_notification_await(&loader->worker_exit_notification,
+                          iree_numpy_npz_loader_workers_exited, loader,
+                          iree_infinite_timeout());
+  for (iree_host_size_t i = 0; i < worker_count - 1; ++i) {
+    if (!workers[i].thread) continue;
+    iree_thread_release(workers[i].thread);
+    if (iree_status_is_ok(status)) {
+      status = workers[i].status;
+    } else {
+      iree_status_ignore(workers[i].status);
+    }
+  }
+
+  iree_allocator_free(loader->host_allocator, workers);
+  return status;
+}
+
+IREE_API_EXPORT iree_host_size_t iree_numpy_npz_default_worker_count(void) {
+#if defined(IREE_PLATFORM_WINDOWS)
+  SYSTEM_INFO system_info;
+  GetSystemInfo(&system_info);
+  return iree_max(1, (iree_host_size_t)system_info.dwNumberOfProcessors);
+#elif IREE_NUMPY_HAVE_MMAP
+  long processor_count = sysconf(_SC_NPROCESSORS_ONLN);
+  return processor_count > 0 ? (iree_host_size_t)processor_count : 1;
+#else
+  return 1;
+#endif  // IREE_PLATFORM_*
+}
+
+IREE_API_EXPORT iree_status_t iree_numpy_npz_load_ndarrays(
+    const char* path, iree_numpy_npy_load_options_t options,
+    iree_host_size_t worker_count, iree_hal_buffer_params_t buffer_params,
+    iree_hal_allocator_t* device_allocator,
+    iree_numpy_npz_load_callback_t callback) {
+  IREE_ASSERT_ARGUMENT(path);
+  IREE_ASSERT_ARGUMENT(device_allocator);
+  IREE_ASSERT_ARGUMENT(callback.fn);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator =
+      iree_hal_allocator_host_allocator(device_allocator);
+
+  // Parse the archive directory up front; entries are then loaded in parallel.
+  FILE* stream = fopen(path, "rb");
+  if (!stream) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to open '%s'", path);
+  }
+  uint64_t file_length = 0;
+  iree_host_size_t entry_count = 0;
+  iree_numpy_npz_entry_t* entries = NULL;
+  iree_status_t status = iree_file_query_length(stream, &file_length);
+  if (iree_status_is_ok(status)) {
+    status = iree_numpy_npz_parse_entries(stream, file_length, host_allocator,
+                                          &entry_count, &entries);
+  }
+  fclose(stream);
+
+  iree_numpy_npz_loader_t loader;
+  memset(&loader, 0, sizeof(loader));
+  loader.path = path;
+  loader.buffer_params = buffer_params;
+  loader.device_allocator = device_allocator;
+  loader.host_allocator = host_allocator;
+  loader.entry_count = entry_count;
+  loader.entries = entries;
+  iree_atomic_store_int64(&loader.next_entry, 0, iree_memory_order_relaxed);
+  iree_atomic_store_int32(&loader.failed, 0, iree_memory_order_relaxed);
+  iree_atomic_store_int32(&loader.running_worker_count, 0,
+                          iree_memory_order_relaxed);
+  iree_notification_initialize(&loader.worker_exit_notification);
+
+  // Mapping is best-effort and when unavailable we fall back to reads.
+  if (iree_status_is_ok(status) &&
+      iree_all_bits_set(options, IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE)) {
+    iree_status_t map_status =
+        iree_numpy_npz_mapping_create(path, host_allocator, &loader.mapping);
+    iree_status_ignore(map_status);
+  }
+
+  if (iree_status_is_ok(status) && entry_count > 0) {
+    status = iree_allocator_malloc(host_allocator,
+                                   entry_count * sizeof(*loader.buffer_views),
+                                   (void**)&loader.buffer_views);
+    if (iree_status_is_ok(status)) {
+      memset(loader.buffer_views, 0,
+             entry_count * sizeof(*loader.buffer_views));
+      status = iree_numpy_npz_loader_run_parallel(&loader, worker_count);
+    }
+  }
+
+  // Issue callbacks in archive order.
+  for (iree_host_size_t i = 0; i < entry_count && iree_status_is_ok(status);
+       ++i) {
+    status = callback.fn(callback.user_data, entries[i].name,
+                         loader.buffer_views[i]);
+  }
+
+  if (loader.buffer_views) {
+    for (iree_host_size_t i = 0; i < entry_count; ++i) {
+      iree_hal_buffer_view_release(loader.buffer_views[i]);
+    }
+    iree_allocator_free(host_allocator, loader.buffer_views);
+  }
+  iree_notification_deinitialize(&loader.worker_exit_notification);
+  iree_numpy_npz_mapping_release(loader.mapping);
+  iree_allocator_free(host_allocator, entries);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
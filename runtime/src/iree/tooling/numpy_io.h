@@ -16,19 +16,16 @@
 // Pickled objects are not supported (similar to using `allow_pickle=False`) and
 // not all dtypes are supported.
 //
-// .npy and uncompressed .npz files can be mapped into host memory with
-// IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE if the HAL device allocator
-// supports using such memory. On devices with discrete memory the contents will
-// be loaded into host memory and copied to the device.
+// Uncompressed .npz files can be mapped into host memory with
+// IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE and their arrays imported directly into
+// HAL buffers if the HAL device allocator supports using such memory. On
+// devices with discrete memory (or when the contents are not suitably aligned)
+// the contents will be copied from the mapping into device buffers instead.
+// Arrays in .npz files can be loaded in parallel across multiple threads.
 //
-// This current implementation is very basic; in the future it'd be nice to
+// This current implementation uses stdio; in the future it'd be nice to
 // support an iree_io_stream_t to allow for externalizing the file access.
 //
-// NOTE: this implementation is optimized for code size and is not intended to
-// be used in performance-sensitive situations. If you are wanting to run
-// through thousands of arrays and GB of data then you're going to want
-// something more sophisticated (delay loading with async IO, etc).
-//
 // TODO(benvanik): conditionally enable compression when zlib is present. For
 // now to reduce dependencies we don't support loading compressed npz files or
 // compression on save.
@@ -98,6 +95,50 @@ IREE_API_EXPORT iree_status_t iree_numpy_npy_save_ndarray(
     FILE* stream, iree_numpy_npy_save_options_t options,
     iree_hal_buffer_view_t* buffer_view, iree_allocator_t host_allocator);
 
+//===----------------------------------------------------------------------===//
+// .npz (zip archive of .npy files)
+//===----------------------------------------------------------------------===//
+
+// Called once per array in an npz archive with the array |name| (the archive
+// entry name without the `.npy` suffix) and its loaded |buffer_view|.
+// The callback must retain the buffer view if it needs it after returning.
+typedef struct iree_numpy_npz_load_callback_t {
+  iree_status_t (*fn)(void* user_data, iree_string_view_t name,
+                      iree_hal_buffer_view_t* buffer_view);
+  void* user_data;
+} iree_numpy_npz_load_callback_t;
+
+// Loads all arrays from the .npz archive at |path| into buffer views allocated
+// from |device_allocator| and issues |callback| for each in archive order.
+//
+// Arrays are read by up to |worker_count| threads (including the calling
+// thread) each using its own file handle. A |worker_count| of 0 or 1 loads all
+// arrays on the calling thread.
+//
+// If IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE is set the archive is mapped into the
+// host process and, when |device_allocator| can import host allocations with
+// |buffer_params|, arrays reference the mapped file directly without copies.
+// The mapping is copy-on-write and stays live until the last buffer
+// referencing it is released. Only arrays whose contents are aligned to
+// IREE_HAL_HEAP_BUFFER_ALIGNMENT in the file are imported; `numpy.savez` does
+// not align entries so their arrays are usually copied from the mapping. If
+// mapping is unavailable the file is read as usual.
+//
+// Only stored (uncompressed) archives as produced by `numpy.savez` are
+// supported.
+//
+// See `numpy.load`:
+// https://numpy.org/doc/stable/reference/generated/numpy.load.html
+IREE_API_EXPORT iree_status_t iree_numpy_npz_load_ndarrays(
+    const char* path, iree_numpy_npy_load_options_t options,
+    iree_host_size_t worker_count, iree_hal_buffer_params_t buffer_params,
+    iree_hal_allocator_t* device_allocator,
+    iree_numpy_npz_load_callback_t callback);
+
+// Returns a |worker_count| for iree_numpy_npz_load_ndarrays that uses one
+// worker per online host processor. Returns 1 if the count is unavailable.
+IREE_API_EXPORT iree_host_size_t iree_numpy_npz_default_worker_count(void);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
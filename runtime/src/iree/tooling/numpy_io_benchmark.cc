@@ -0,0 +1,259 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/tooling/numpy_io.h"
+
+namespace {
+
+// Number of arrays in each benchmark file.
+constexpr int kArrayCount = 256;
+// Number of f32 elements in each array (256KB).
+constexpr iree_hal_dim_t kArrayElementCount = 64 * 1024;
+
+static std::string GetTempFilename(const char* name) {
+  const char* tmpdir = getenv("TEST_TMPDIR");
+  if (!tmpdir) tmpdir = getenv("TMPDIR");
+  if (!tmpdir) tmpdir = getenv("TEMP");
+  if (!tmpdir) tmpdir = "/tmp";
+  return std::string(tmpdir) + "/iree_numpy_io_benchmark_" + name;
+}
+
+static void AppendLE16(std::vector<uint8_t>& data, uint16_t value) {
+  data.push_back(value & 0xFF);
+  data.push_back((value >> 8) & 0xFF);
+}
+
+static void AppendLE32(std::vector<uint8_t>& data, uint32_t value) {
+  AppendLE16(data, value & 0xFFFF);
+  AppendLE16(data, (value >> 16) & 0xFFFF);
+}
+
+// Shared benchmark inputs: a heap allocator, buffer views to save, and the
+// same arrays stored as a concatenated .npy file and as an .npz archive.
+class NumpyIOFixture {
+ public:
+  static NumpyIOFixture& Get() {
+    static NumpyIOFixture* fixture = new NumpyIOFixture();
+    return *fixture;
+  }
+
+  iree_hal_allocator_t* device_allocator() { return device_allocator_; }
+  const std::vector<iree_hal_buffer_view_t*>& buffer_views() {
+    return buffer_views_;
+  }
+  const std::string& npy_path() { return npy_path_; }
+  const std::string& npz_path() { return npz_path_; }
+  int64_t total_bytes() {
+    return (int64_t)kArrayCount * kArrayElementCount * sizeof(float);
+  }
+
+ private:
+  NumpyIOFixture() {
+    IREE_CHECK_OK(iree_hal_allocator_create_heap(
+        IREE_SV("heap"), iree_allocator_system(), iree_allocator_system(),
+        &device_allocator_));
+
+    std::vector<float> contents(kArrayElementCount);
+    for (iree_hal_dim_t i = 0; i < kArrayElementCount; ++i) {
+      contents[i] = (float)i;
+    }
+    iree_hal_buffer_params_t buffer_params = {};
+    buffer_params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+    buffer_params.access = IREE_HAL_MEMORY_ACCESS_ALL;
+    buffer_params.type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL;
+    for (int i = 0; i < kArrayCount; ++i) {
+      iree_hal_buffer_view_t* buffer_view = NULL;
+      IREE_CHECK_OK(iree_hal_buffer_view_allocate_buffer(
+          device_allocator_, 1, &kArrayElementCount,
+          IREE_HAL_ELEMENT_TYPE_FLOAT_32,
+          IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, buffer_params,
+          iree_make_const_byte_span(contents.data(),
+                                    contents.size() * sizeof(float)),
+          &buffer_view));
+      buffer_views_.push_back(buffer_view);
+    }
+
+    // Concatenated .npy file.
+    npy_path_ = GetTempFilename("arrays.npy");
+    FILE* npy_file = fopen(npy_path_.c_str(), "wb");
+    std::vector<std::vector<uint8_t>> npy_entries;
+    for (auto* buffer_view : buffer_views_) {
+      FILE* entry_file = tmpfile();
+      IREE_CHECK_OK(iree_numpy_npy_save_ndarray(
+          entry_file, IREE_NUMPY_NPY_SAVE_OPTION_DEFAULT, buffer_view,
+          iree_allocator_system()));
+      std::vector<uint8_t> entry(ftell(entry_file));
+      fseek(entry_file, 0, SEEK_SET);
+      if (fread(entry.data(), 1, entry.size(), entry_file) != entry.size()) {
+        abort();
+      }
+      fclose(entry_file);
+      fwrite(entry.data(), 1, entry.size(), npy_file);
+      npy_entries.push_back(std::move(entry));
+    }
+    fclose(npy_file);
+
+    // .npz archive with stored entries. CRCs are not verified by the loader
+    // and are left as 0.
+    npz_path_ = GetTempFilename("arrays.npz");
+    std::vector<uint8_t> archive;
+    std::vector<uint8_t> directory;
+    for (size_t i = 0; i < npy_entries.size(); ++i) {
+      std::string name = "arr_" + std::to_string(i) + ".npy";
+      uint32_t size = (uint32_t)npy_entries[i].size();
+      uint32_t header_offset = (uint32_t)archive.size();
+      AppendLE32(archive, 0x04034B50u);
+      AppendLE16(archive, 20);  // version needed
+      AppendLE16(archive, 0);   // flags
+      AppendLE16(archive, 0);   // method (stored)
+      AppendLE32(archive, 0);   // time/date
+      AppendLE32(archive, 0);   // crc32
+      AppendLE32(archive, size);
+      AppendLE32(archive, size);
+      AppendLE16(archive, (uint16_t)name.size());
+      AppendLE16(archive, 0);  // extra length
+      archive.insert(archive.end(), name.begin(), name.end());
+      archive.insert(archive.end(), npy_entries[i].begin(),
+                     npy_entries[i].end());
+      AppendLE32(directory, 0x02014B50u);
+      AppendLE16(directory, 20);  // version made by
+      AppendLE16(directory, 20);  // version needed
+      AppendLE16(directory, 0);   // flags
+      AppendLE16(directory, 0);   // method (stored)
+      AppendLE32(directory, 0);   // time/date
+      AppendLE32(directory, 0);   // crc32
+      AppendLE32(directory, size);
+      AppendLE32(directory, size);
+      AppendLE16(directory, (uint16_t)name.size());
+      AppendLE16(directory, 0);  // extra length
+      AppendLE16(directory, 0);  // comment length
+      AppendLE16(directory, 0);  // disk number
+      AppendLE16(directory, 0);  // internal attributes
+      AppendLE32(directory, 0);  // external attributes
+      AppendLE32(directory, header_offset);
+      directory.insert(directory.end(), name.begin(), name.end());
+    }
+    uint32_t directory_offset = (uint32_t)archive.size();
+    archive.insert(archive.end(), directory.begin(), directory.end());
+    AppendLE32(archive, 0x06054B50u);
+    AppendLE16(archive, 0);  // disk number
+    AppendLE16(archive, 0);  // directory disk number
+    AppendLE16(archive, (uint16_t)npy_entries.size());
+    AppendLE16(archive, (uint16_t)npy_entries.size());
+    AppendLE32(archive, (uint32_t)directory.size());
+    AppendLE32(archive, directory_offset);
+    AppendLE16(archive, 0);  // comment length
+    FILE* npz_file = fopen(npz_path_.c_str(), "wb");
+    fwrite(archive.data(), 1, archive.size(), npz_file);
+    fclose(npz_file);
+  }
+
+  iree_hal_allocator_t* device_allocator_ = NULL;
+  std::vector<iree_hal_buffer_view_t*> buffer_views_;
+  std::string npy_path_;
+  std::string npz_path_;
+};
+
+static iree_hal_buffer_params_t LoadBufferParams() {
+  iree_hal_buffer_params_t buffer_params = {};
+  buffer_params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+  buffer_params.access = IREE_HAL_MEMORY_ACCESS_READ;
+  buffer_params.type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL;
+  return buffer_params;
+}
+
+// Baseline: sequentially loads all arrays from a concatenated .npy file.
+// All arrays are kept live until the end of the iteration as they would be
+// when used as inputs.
+void BM_LoadNpySequential(benchmark::State& state) {
+  auto& fixture = NumpyIOFixture::Get();
+  std::vector<iree_hal_buffer_view_t*> buffer_views(kArrayCount);
+  for (auto _ : state) {
+    FILE* file = fopen(fixture.npy_path().c_str(), "rb");
+    for (int i = 0; i < kArrayCount; ++i) {
+      IREE_CHECK_OK(iree_numpy_npy_load_ndarray(
+          file, IREE_NUMPY_NPY_LOAD_OPTION_DEFAULT, LoadBufferParams(),
+          fixture.device_allocator(), &buffer_views[i]));
+    }
+    fclose(file);
+    for (auto* buffer_view : buffer_views) {
+      iree_hal_buffer_view_release(buffer_view);
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * fixture.total_bytes());
+}
+BENCHMARK(BM_LoadNpySequential)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static iree_status_t DiscardArray(void* user_data, iree_string_view_t name,
+                                  iree_hal_buffer_view_t* buffer_view) {
+  benchmark::DoNotOptimize(buffer_view);
+  return iree_ok_status();
+}
+
+// Loads all arrays from an .npz archive using state.range(0) workers.
+static void LoadNpz(benchmark::State& state,
+                    iree_numpy_npy_load_options_t options) {
+  auto& fixture = NumpyIOFixture::Get();
+  iree_numpy_npz_load_callback_t callback = {DiscardArray, NULL};
+  for (auto _ : state) {
+    IREE_CHECK_OK(iree_numpy_npz_load_ndarrays(
+        fixture.npz_path().c_str(), options, (iree_host_size_t)state.range(0),
+        LoadBufferParams(), fixture.device_allocator(), callback));
+  }
+  state.SetBytesProcessed(state.iterations() * fixture.total_bytes());
+}
+
+void BM_LoadNpz(benchmark::State& state) {
+  LoadNpz(state, IREE_NUMPY_NPY_LOAD_OPTION_DEFAULT);
+}
+BENCHMARK(BM_LoadNpz)
+    ->ArgName("workers")
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Zero-copy loads: buffers alias the mapped archive.
+void BM_LoadNpzMapped(benchmark::State& state) {
+  LoadNpz(state, IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE);
+}
+BENCHMARK(BM_LoadNpzMapped)
+    ->ArgName("workers")
+    ->Arg(1)
+    ->Arg(8)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Saves each array to its own .npy file.
+void BM_SaveNpySync(benchmark::State& state) {
+  auto& fixture = NumpyIOFixture::Get();
+  for (auto _ : state) {
+    for (int i = 0; i < kArrayCount; ++i) {
+      auto path = GetTempFilename(("out_" + std::to_string(i)).c_str());
+      FILE* file = fopen(path.c_str(), "wb");
+      IREE_CHECK_OK(iree_numpy_npy_save_ndarray(
+          file, IREE_NUMPY_NPY_SAVE_OPTION_DEFAULT, fixture.buffer_views()[i],
+          iree_allocator_system()));
+      fclose(file);
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * fixture.total_bytes());
+}
+BENCHMARK(BM_SaveNpySync)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+}  // namespace
@@ -6,6 +6,8 @@
 
 #include "iree/tooling/numpy_io.h"
 
+#include <algorithm>
+
 #include "iree/base/internal/file_io.h"
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
@@ -58,17 +60,29 @@ class NumpyIOTest : public ::testing::Test {
            std::to_string(unique_id++) + '_' + suffix;
   }
 
-  FILE* OpenInputFile(const char* name) {
+  // Returns the contents of the embedded file |name| or an empty span.
+  static iree_const_byte_span_t GetInputFileContents(const char* name) {
     const struct iree_file_toc_t* file_toc = iree_numpy_npy_files_create();
     for (size_t i = 0; i < iree_numpy_npy_files_size(); ++i) {
       if (strcmp(file_toc[i].name, name) != 0) continue;
-      auto file_path = GetTempFilename(name);
-      IREE_CHECK_OK(iree_file_write_contents(
-          file_path.c_str(),
-          iree_make_const_byte_span(file_toc[i].data, file_toc[i].size)));
-      return fopen(file_path.c_str(), "rb");
+      return iree_make_const_byte_span(file_toc[i].data, file_toc[i].size);
     }
-    return NULL;
+    return iree_const_byte_span_empty();
+  }
+
+  // Writes the embedded file |name| to a temporary file and returns its path.
+  static std::string WriteInputFile(const char* name) {
+    iree_const_byte_span_t contents = GetInputFileContents(name);
+    if (!contents.data) return std::string();
+    auto file_path = GetTempFilename(name);
+    IREE_CHECK_OK(iree_file_write_contents(file_path.c_str(), contents));
+    return file_path;
+  }
+
+  FILE* OpenInputFile(const char* name) {
+    auto file_path = WriteInputFile(name);
+    if (file_path.empty()) return NULL;
+    return fopen(file_path.c_str(), "rb");
   }
 
   FILE* OpenOutputFile(const char* name) {
@@ -400,5 +414,234 @@ TEST_F(NumpyIOTest, RoundTripArrayTypes) {
   fclose(target_stream);
 }
 
+// Collects the arrays loaded from an npz file.
+struct NpzArrays {
+  ~NpzArrays() {
+    for (auto* buffer_view : buffer_views) {
+      iree_hal_buffer_view_release(buffer_view);
+    }
+  }
+  static iree_status_t Append(void* user_data, iree_string_view_t name,
+                              iree_hal_buffer_view_t* buffer_view) {
+    auto* arrays = reinterpret_cast<NpzArrays*>(user_data);
+    arrays->names.push_back(std::string(name.data, name.size));
+    iree_hal_buffer_view_retain(buffer_view);
+    arrays->buffer_views.push_back(buffer_view);
+    return iree_ok_status();
+  }
+  iree_numpy_npz_load_callback_t callback() {
+    iree_numpy_npz_load_callback_t callback;
+    callback.fn = Append;
+    callback.user_data = this;
+    return callback;
+  }
+  std::vector<std::string> names;
+  std::vector<iree_hal_buffer_view_t*> buffer_views;
+};
+
+// Tests loading all arrays from an npz archive with varying load options and
+// worker counts.
+TEST_F(NumpyIOTest, LoadNpzArrays) {
+  auto file_path = WriteInputFile("multiple.npz");
+  for (iree_numpy_npy_load_options_t options :
+       {IREE_NUMPY_NPY_LOAD_OPTION_DEFAULT,
+        IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE}) {
+    for (iree_host_size_t worker_count : {0, 1, 2, 8}) {
+      iree_hal_buffer_params_t buffer_params = {};
+      buffer_params.usage = IREE_HAL_BUFFER_USAGE_TRANSFER;
+      buffer_params.access = IREE_HAL_MEMORY_ACCESS_READ;
+      buffer_params.type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL;
+      NpzArrays arrays;
+      IREE_ASSERT_OK(iree_numpy_npz_load_ndarrays(
+          file_path.c_str(), options, worker_count, buffer_params,
+          device_allocator_, arrays.callback()));
+      ASSERT_THAT(arrays.names, ElementsAreArray({"a", "b", "c"}));
+
+      // np.array([1.1, 2.2, 3.3], dtype=np.float32)
+      AssertBufferViewContents<float>(
+          arrays.buffer_views[0], {3}, IREE_HAL_ELEMENT_TYPE_FLOAT_32,
+          IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, {1.1f, 2.2f, 3.3f});
+
+      // np.array([[0, 1], [2, 3]], dtype=np.int32)
+      AssertBufferViewContents<int32_t>(
+          arrays.buffer_views[1], {2, 2}, IREE_HAL_ELEMENT_TYPE_SINT_32,
+          IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, {0, 1, 2, 3});
+
+      // np.array(42, dtype=np.int32)
+      AssertBufferViewContents<int32_t>(
+          arrays.buffer_views[2], {}, IREE_HAL_ELEMENT_TYPE_SINT_32,
+          IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, {42});
+    }
+  }
+}
+
+// Tests that files that are not zip archives are rejected.
+TEST_F(NumpyIOTest, LoadNpzInvalidArchive) {
+  auto file_path = WriteInputFile("multiple.npy");
+  iree_hal_buffer_params_t buffer_params = {};
+  buffer_params.usage = IREE_HAL_BUFFER_USAGE_TRANSFER;
+  buffer_params.access = IREE_HAL_MEMORY_ACCESS_READ;
+  buffer_params.type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL;
+  NpzArrays arrays;
+  EXPECT_THAT(Status(iree_numpy_npz_load_ndarrays(
+                  file_path.c_str(), IREE_NUMPY_NPY_LOAD_OPTION_DEFAULT, 1,
+                  buffer_params, device_allocator_, arrays.callback())),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_TRUE(arrays.names.empty());
+}
+
+static void AppendLE16(std::vector<uint8_t>& data, uint32_t value) {
+  data.push_back(value & 0xFF);
+  data.push_back((value >> 8) & 0xFF);
+}
+
+static void AppendLE32(std::vector<uint8_t>& data, uint32_t value) {
+  AppendLE16(data, value & 0xFFFF);
+  AppendLE16(data, (value >> 16) & 0xFFFF);
+}
+
+// An entry in a stored npz archive whose array contents start |misalignment|
+// bytes past an IREE_HAL_HEAP_BUFFER_ALIGNMENT boundary in the file.
+struct NpzTestEntry {
+  std::string name;
+  iree_host_size_t misalignment;
+};
+
+// Returns a stored zip archive with each of |entries| holding |npy_contents|.
+// Entries are positioned by padding their local header extra field like
+// zipalign does. CRCs are not verified by the loader and are left as 0.
+static std::vector<uint8_t> BuildAlignedNpzArchive(
+    const std::vector<NpzTestEntry>& entries,
+    iree_const_byte_span_t npy_contents, iree_host_size_t npy_data_offset) {
+  std::vector<uint8_t> archive;
+  std::vector<uint8_t> directory;
+  const uint32_t size = (uint32_t)npy_contents.data_length;
+  for (const auto& entry : entries) {
+    const uint32_t header_offset = (uint32_t)archive.size();
+    // The extra field holds at least its own 4 byte header.
+    const iree_host_size_t unpadded_data_offset =
+        header_offset + 30 + entry.name.size() + 4 + npy_data_offset;
+    const iree_host_size_t padding =
+        (entry.misalignment + IREE_HAL_HEAP_BUFFER_ALIGNMENT -
+         unpadded_data_offset % IREE_HAL_HEAP_BUFFER_ALIGNMENT) %
+        IREE_HAL_HEAP_BUFFER_ALIGNMENT;
+    AppendLE32(archive, 0x04034B50u);
+    AppendLE16(archive, 20);  // version needed
+    AppendLE16(archive, 0);   // flags
+    AppendLE16(archive, 0);   // method (stored)
+    AppendLE32(archive, 0);   // time/date
+    AppendLE32(archive, 0);   // crc32
+    AppendLE32(archive, size);
+    AppendLE32(archive, size);
+    AppendLE16(archive, (uint16_t)entry.name.size());
+    AppendLE16(archive, (uint16_t)(4 + padding));  // extra length
+    archive.insert(archive.end(), entry.name.begin(), entry.name.end());
+    AppendLE16(archive, 0xD935);  // zipalign padding extra field
+    AppendLE16(archive, (uint16_t)padding);
+    archive.insert(archive.end(), padding, 0);
+    archive.insert(archive.end(), npy_contents.data,
+                   npy_contents.data + npy_contents.data_length);
+    AppendLE32(directory, 0x02014B50u);
+    AppendLE16(directory, 20);  // version made by
+    AppendLE16(directory, 20);  // version needed
+    AppendLE16(directory, 0);   // flags
+    AppendLE16(directory, 0);   // method (stored)
+    AppendLE32(directory, 0);   // time/date
+    AppendLE32(directory, 0);   // crc32
+    AppendLE32(directory, size);
+    AppendLE32(directory, size);
+    AppendLE16(directory, (uint16_t)entry.name.size());
+    AppendLE16(directory, 0);  // extra length
+    AppendLE16(directory, 0);  // comment length
+    AppendLE16(directory, 0);  // disk number
+    AppendLE16(directory, 0);  // internal attributes
+    AppendLE32(directory, 0);  // external attributes
+    AppendLE32(directory, header_offset);
+    directory.insert(directory.end(), entry.name.begin(), entry.name.end());
+  }
+  const uint32_t directory_offset = (uint32_t)archive.size();
+  archive.insert(archive.end(), directory.begin(), directory.end());
+  AppendLE32(archive, 0x06054B50u);
+  AppendLE16(archive, 0);  // disk number
+  AppendLE16(archive, 0);  // directory disk number
+  AppendLE16(archive, (uint16_t)entries.size());
+  AppendLE16(archive, (uint16_t)entries.size());
+  AppendLE32(archive, (uint32_t)directory.size());
+  AppendLE32(archive, directory_offset);
+  AppendLE16(archive, 0);  // comment length
+  return archive;
+}
+
+// Returns the host pointer of the contents of |buffer_view|.
+static uintptr_t GetBufferViewDataPtr(iree_hal_buffer_view_t* buffer_view) {
+  iree_hal_buffer_mapping_t mapping;
+  IREE_CHECK_OK(iree_hal_buffer_map_range(
+      iree_hal_buffer_view_buffer(buffer_view), IREE_HAL_MAPPING_MODE_SCOPED,
+      IREE_HAL_MEMORY_ACCESS_READ, 0, IREE_WHOLE_BUFFER, &mapping));
+  const uintptr_t data_ptr = (uintptr_t)mapping.contents.data;
+  IREE_CHECK_OK(iree_hal_buffer_unmap_range(&mapping));
+  return data_ptr;
+}
+
+// Tests that mapped npz arrays reference the file mapping directly only when
+// their contents are aligned in the file and are copied into aligned
+// allocations otherwise, even if the buffer params allow unaligned access.
+TEST_F(NumpyIOTest, LoadNpzArraysZeroCopy) {
+#if !defined(IREE_PLATFORM_ANDROID) && !defined(IREE_PLATFORM_APPLE) && \
+    !defined(IREE_PLATFORM_LINUX)
+  GTEST_SKIP() << "file mapping not supported on this platform";
+#endif  // IREE_PLATFORM_*
+
+  // np.array([1.1, 2.2, 3.3], dtype=np.float32)
+  iree_const_byte_span_t npy_contents = GetInputFileContents("single.npy");
+  const iree_host_size_t npy_data_offset =
+      npy_contents.data_length - 3 * sizeof(float);
+  auto archive = BuildAlignedNpzArchive(
+      {{"aligned.npy", 0}, {"misaligned.npy", 4}}, npy_contents,
+      npy_data_offset);
+  auto file_path = GetTempFilename("aligned.npz");
+  IREE_ASSERT_OK(iree_file_write_contents(
+      file_path.c_str(),
+      iree_make_const_byte_span(archive.data(), archive.size())));
+
+  for (bool allow_unaligned : {false, true}) {
+    iree_hal_buffer_params_t buffer_params = {};
+    buffer_params.usage = IREE_HAL_BUFFER_USAGE_TRANSFER;
+    buffer_params.access = IREE_HAL_MEMORY_ACCESS_READ;
+    buffer_params.type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL;
+    if (allow_unaligned) {
+      buffer_params.access |= IREE_HAL_MEMORY_ACCESS_UNALIGNED;
+    }
+    NpzArrays arrays;
+    IREE_ASSERT_OK(iree_numpy_npz_load_ndarrays(
+        file_path.c_str(), IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE, 1,
+        buffer_params, device_allocator_, arrays.callback()));
+    ASSERT_THAT(arrays.names, ElementsAreArray({"aligned", "misaligned"}));
+
+    // The aligned entry aliases the page-aligned mapping and so keeps the page
+    // offset of its contents in the file.
+    const uintptr_t page_size = 4096;
+    const uintptr_t aligned_file_offset =
+        (uintptr_t)(std::search(archive.data(), archive.data() + archive.size(),
+                                npy_contents.data + npy_data_offset,
+                                npy_contents.data + npy_contents.data_length) -
+                    archive.data());
+    EXPECT_EQ(aligned_file_offset % IREE_HAL_HEAP_BUFFER_ALIGNMENT, 0);
+    EXPECT_EQ(GetBufferViewDataPtr(arrays.buffer_views[0]) % page_size,
+              aligned_file_offset % page_size);
+
+    // The misaligned entry is copied into an aligned allocation.
+    EXPECT_EQ(GetBufferViewDataPtr(arrays.buffer_views[1]) %
+                  IREE_HAL_HEAP_BUFFER_ALIGNMENT,
+              0);
+
+    for (auto* buffer_view : arrays.buffer_views) {
+      AssertBufferViewContents<float>(
+          buffer_view, {3}, IREE_HAL_ELEMENT_TYPE_FLOAT_32,
+          IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, {1.1f, 2.2f, 3.3f});
+    }
+  }
+}
+
 }  // namespace
 }  // namespace iree
@@ -39,6 +39,9 @@ IREE_FLAG_LIST(
     "\n"
     "Numpy npy files from numpy.save can be read to provide 1+ values:\n"
     "  @some.npy\n"
+    "Numpy npz files from numpy.savez provide all arrays in archive order and\n"
+    "are loaded in parallel (mapping the file directly when possible):\n"
+    "  @some.npz\n"
     "\n"
     "Each occurrence of the flag indicates an input in the order they were\n"
     "specified on the command line.");
@@ -356,6 +359,10 @@ iree_status_t iree_tooling_run_module_with_data(
     IREE_IGNORE_ERROR(
         iree_hal_allocator_statistics_fprint(stderr, device_allocator));
   }
+  if (device && FLAG_print_statistics) {
+    IREE_IGNORE_ERROR(
+        iree_hal_device_dispatch_statistics_fprint(stderr, device));
+  }
 
   iree_hal_allocator_release(device_allocator);
   iree_hal_device_release(device);
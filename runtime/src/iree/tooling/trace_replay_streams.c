@@ -0,0 +1,651 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/tooling/trace_replay_streams.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
+#include "iree/base/tracing.h"
+#include "iree/tooling/device_util.h"
+#include "iree/tooling/histogram.h"
+
+//===----------------------------------------------------------------------===//
+// iree_trace_replay_document_t
+//===----------------------------------------------------------------------===//
+
+// A parsed trace document shared by all streams it was routed to.
+// The document is only read by the streams and is deleted by whichever stream
+// finishes with it last.
+typedef struct iree_trace_replay_document_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  yaml_document_t document;
+  // Root event node within |document|.
+  yaml_node_t* event_node;
+} iree_trace_replay_document_t;
+
+static void iree_trace_replay_document_release(
+    iree_trace_replay_document_t* document) {
+  if (document && iree_atomic_ref_count_dec(&document->ref_count) == 1) {
+    IREE_TRACE_ZONE_BEGIN_NAMED(z0, "yaml_document_delete");
+    yaml_document_delete(&document->document);
+    iree_allocator_free(document->host_allocator, document);
+    IREE_TRACE_ZONE_END(z0);
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// iree_trace_replay_stream_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_trace_replay_stream_statistics_t {
+  // Total number of events executed.
+  uint64_t event_count;
+  // Total number of call events executed.
+  uint64_t call_count;
+  // Sum over all runs of the time from the start of the first event to the end
+  // of the last event executed by the stream.
+  iree_duration_t active_duration_ns;
+  // Sum of all call durations.
+  iree_duration_t call_duration_ns;
+  // Distribution of call durations in nanoseconds.
+  iree_tooling_histogram_t call_latency;
+} iree_trace_replay_stream_statistics_t;
+
+typedef struct iree_trace_replay_stream_t {
+  iree_trace_replay_streams_t* streams;
+  iree_host_size_t ordinal;
+  iree_thread_t* thread;
+
+  // Replay state used exclusively by the stream thread while running.
+  iree_trace_replay_t replay;
+  // Time the in-flight call began as recorded by the call hooks.
+  iree_time_t call_start_ns;
+
+  // Posted when documents are enqueued or exit is requested.
+  iree_notification_t pending_notification;
+
+  iree_slim_mutex_t mutex;
+  // Ring buffer of pending documents with capacity equal to the queue depth.
+  iree_trace_replay_document_t** queue IREE_GUARDED_BY(mutex);
+  iree_host_size_t queue_head IREE_GUARDED_BY(mutex);
+  iree_host_size_t queue_count IREE_GUARDED_BY(mutex);
+  // True while the stream thread is executing a dequeued document.
+  bool busy IREE_GUARDED_BY(mutex);
+  // True when the stream thread should exit once the queue is drained.
+  bool exit_requested IREE_GUARDED_BY(mutex);
+  // True once the stream thread has returned from its main routine.
+  bool exited IREE_GUARDED_BY(mutex);
+  // Sticky failure of the current run. Once failed all remaining documents
+  // routed to the stream are dropped.
+  iree_status_t status IREE_GUARDED_BY(mutex);
+  // Time the first event of the current run began or 0 if none have run.
+  iree_time_t run_start_ns IREE_GUARDED_BY(mutex);
+  // Time the most recent event of the current run ended.
+  iree_time_t run_end_ns IREE_GUARDED_BY(mutex);
+  iree_trace_replay_stream_statistics_t statistics IREE_GUARDED_BY(mutex);
+} iree_trace_replay_stream_t;
+
+struct iree_trace_replay_streams_t {
+  iree_allocator_t host_allocator;
+  iree_trace_replay_streams_options_t options;
+  iree_hal_device_t* device;
+
+  // Posted whenever a stream finishes executing a document.
+  iree_notification_t idle_notification;
+
+  // Number of completed runs and their total wall time.
+  uint64_t run_count;
+  iree_duration_t run_duration_ns;
+
+  iree_host_size_t stream_count;
+  iree_trace_replay_stream_t streams[];
+};
+
+static iree_status_t iree_trace_replay_stream_call_before(
+    void* user_data, iree_trace_replay_t* replay, yaml_document_t* document,
+    yaml_node_t* event_node, iree_vm_function_t function,
+    iree_vm_list_t* input_list) {
+  iree_trace_replay_stream_t* stream = (iree_trace_replay_stream_t*)user_data;
+  const iree_trace_replay_call_hooks_t* hooks =
+      &stream->streams->options.call_hooks;
+  if (hooks->before) {
+    IREE_RETURN_IF_ERROR(hooks->before(hooks->user_data, replay, document,
+                                       event_node, function, input_list));
+  }
+  stream->call_start_ns = iree_time_now();
+  return iree_ok_status();
+}
+
+static iree_status_t iree_trace_replay_stream_call_after(
+    void* user_data, iree_trace_replay_t* replay, yaml_document_t* document,
+    yaml_node_t* event_node, iree_vm_function_t function,
+    iree_vm_list_t* output_list) {
+  iree_trace_replay_stream_t* stream = (iree_trace_replay_stream_t*)user_data;
+  iree_duration_t duration_ns = iree_time_now() - stream->call_start_ns;
+  iree_slim_mutex_lock(&stream->mutex);
+  ++stream->statistics.call_count;
+  stream->statistics.call_duration_ns += duration_ns;
+  iree_tooling_histogram_record(&stream->statistics.call_latency, duration_ns);
+  iree_slim_mutex_unlock(&stream->mutex);
+  const iree_trace_replay_call_hooks_t* hooks =
+      &stream->streams->options.call_hooks;
+  if (hooks->after) {
+    return hooks->after(hooks->user_data, replay, document, event_node,
+                        function, output_list);
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_trace_replay_stream_call_error(
+    void* user_data, iree_trace_replay_t* replay, yaml_document_t* document,
+    yaml_node_t* event_node, iree_vm_function_t function,
+    iree_status_t status) {
+  iree_trace_replay_stream_t* stream = (iree_trace_replay_stream_t*)user_data;
+  const iree_trace_replay_call_hooks_t* hooks =
+      &stream->streams->options.call_hooks;
+  if (hooks->error) {
+    return hooks->error(hooks->user_data, replay, document, event_node,
+                        function, status);
+  }
+  return status;
+}
+
+static bool iree_trace_replay_stream_has_work(void* arg) {
+  iree_trace_replay_stream_t* stream = (iree_trace_replay_stream_t*)arg;
+  iree_slim_mutex_lock(&stream->mutex);
+  bool has_work = stream->queue_count > 0 || stream->exit_requested;
+  iree_slim_mutex_unlock(&stream->mutex);
+  return has_work;
+}
+
+static bool iree_trace_replay_stream_has_exited(void* arg) {
+  iree_trace_replay_stream_t* stream = (iree_trace_replay_stream_t*)arg;
+  iree_slim_mutex_lock(&stream->mutex);
+  bool has_exited = stream->exited;
+  iree_slim_mutex_unlock(&stream->mutex);
+  return has_exited;
+}
+
+// Stream thread main routine executing documents from the stream queue in
+// order until exit is requested.
+static int iree_trace_replay_stream_main(void* entry_arg) {
+  iree_trace_replay_stream_t* stream = (iree_trace_replay_stream_t*)entry_arg;
+  iree_trace_replay_streams_t* streams = stream->streams;
+  const iree_host_size_t queue_depth = streams->options.queue_depth;
+  for (;;) {
+    iree_notification_await(&stream->pending_notification,
+                            iree_trace_replay_stream_has_work, stream,
+                            iree_infinite_timeout());
+
+    iree_slim_mutex_lock(&stream->mutex);
+    if (stream->queue_count == 0) {
+      // Exit requested and there's no more work.
+      stream->exited = true;
+      iree_slim_mutex_unlock(&stream->mutex);
+      iree_notification_post(&streams->idle_notification, IREE_ALL_WAITERS);
+      break;
+    }
+    iree_trace_replay_document_t* document = stream->queue[stream->queue_head];
+    stream->queue[stream->queue_head] = NULL;
+    stream->queue_head = (stream->queue_head + 1) % queue_depth;
+    --stream->queue_count;
+    stream->busy = true;
+    const bool has_failed = !iree_status_is_ok(stream->status);
+    iree_slim_mutex_unlock(&stream->mutex);
+
+    // Wake the parser if it was waiting for space in our queue.
+    iree_notification_post(&streams->idle_notification, IREE_ALL_WAITERS);
+
+    iree_time_t start_ns = 0;
+    iree_time_t end_ns = 0;
+    iree_status_t status = iree_ok_status();
+    if (!has_failed) {
+      IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_trace_replay_stream_event");
+      start_ns = iree_time_now();
+      status = iree_trace_replay_event(&stream->replay, &document->document,
+                                       document->event_node);
+      end_ns = iree_time_now();
+      IREE_TRACE_ZONE_END(z0);
+    }
+    iree_trace_replay_document_release(document);
+
+    iree_slim_mutex_lock(&stream->mutex);
+    if (!has_failed) {
+      ++stream->statistics.event_count;
+      if (!stream->run_start_ns) stream->run_start_ns = start_ns;
+      stream->run_end_ns = end_ns;
+    }
+    if (!iree_status_is_ok(status)) {
+      status = iree_status_annotate_f(status, "in replay stream %" PRIhsz,
+                                      stream->ordinal);
+      stream->status = status;
+    }
+    stream->busy = false;
+    iree_slim_mutex_unlock(&stream->mutex);
+    iree_notification_post(&streams->idle_notification, IREE_ALL_WAITERS);
+  }
+  return 0;
+}
+
+static iree_status_t iree_trace_replay_stream_initialize(
+    iree_trace_replay_streams_t* streams, iree_host_size_t ordinal,
+    iree_string_view_t root_path, iree_vm_instance_t* instance,
+    iree_hal_driver_registry_t* driver_registry,
+    iree_host_size_t device_uri_count, const iree_string_view_t* device_uris,
+    iree_trace_replay_document_t** queue_storage,
+    iree_trace_replay_stream_t* out_stream) {
+  out_stream->streams = streams;
+  out_stream->ordinal = ordinal;
+  iree_notification_initialize(&out_stream->pending_notification);
+  iree_slim_mutex_initialize(&out_stream->mutex);
+  out_stream->queue = queue_storage;
+  out_stream->status = iree_ok_status();
+  iree_tooling_histogram_initialize(&out_stream->statistics.call_latency);
+
+  // Device statistics are printed once for the shared device instead of by
+  // each stream.
+  iree_trace_replay_flags_t replay_flags =
+      (streams->options.replay_flags &
+       ~IREE_TRACE_REPLAY_FLAG_PRINT_STATISTICS) |
+      IREE_TRACE_REPLAY_FLAG_REUSE_DEVICES;
+  IREE_RETURN_IF_ERROR(iree_trace_replay_initialize(
+      root_path, instance, replay_flags, streams->options.context_flags,
+      driver_registry, streams->host_allocator, &out_stream->replay));
+  iree_trace_replay_set_hal_devices_override(&out_stream->replay,
+                                             device_uri_count, device_uris);
+  out_stream->replay.device = streams->device;
+  iree_hal_device_retain(out_stream->replay.device);
+  out_stream->replay.call_hooks.user_data = out_stream;
+  out_stream->replay.call_hooks.before = iree_trace_replay_stream_call_before;
+  out_stream->replay.call_hooks.after = iree_trace_replay_stream_call_after;
+  out_stream->replay.call_hooks.error = iree_trace_replay_stream_call_error;
+
+  char name[16];
+  snprintf(name, sizeof(name), "iree-replay-%" PRIhsz, ordinal);
+  iree_thread_create_params_t params;
+  memset(&params, 0, sizeof(params));
+  params.name = iree_make_cstring_view(name);
+  return iree_thread_create(iree_trace_replay_stream_main, out_stream, params,
+                            streams->host_allocator, &out_stream->thread);
+}
+
+static void iree_trace_replay_stream_deinitialize(
+    iree_trace_replay_stream_t* stream) {
+  if (stream->thread) {
+    iree_slim_mutex_lock(&stream->mutex);
+    stream->exit_requested = true;
+    iree_slim_mutex_unlock(&stream->mutex);
+    iree_notification_post(&stream->pending_notification, IREE_ALL_WAITERS);
+    // Releasing the thread only joins it if the thread has already dropped its
+    // own reference so wait for it to exit first.
+    iree_notification_await(&stream->streams->idle_notification,
+                            iree_trace_replay_stream_has_exited, stream,
+                            iree_infinite_timeout());
+    iree_thread_release(stream->thread);
+    stream->thread = NULL;
+  }
+  iree_status_ignore(stream->status);
+  iree_trace_replay_deinitialize(&stream->replay);
+  iree_slim_mutex_deinitialize(&stream->mutex);
+  iree_notification_deinitialize(&stream->pending_notification);
+}
+
+//===----------------------------------------------------------------------===//
+// iree_trace_replay_streams_t
+//===----------------------------------------------------------------------===//
+
+iree_status_t iree_trace_replay_streams_create(
+    iree_string_view_t root_path, iree_vm_instance_t* instance,
+    const iree_trace_replay_streams_options_t* options,
+    iree_hal_driver_registry_t* driver_registry,
+    iree_host_size_t device_uri_count, const iree_string_view_t* device_uris,
+    iree_allocator_t host_allocator, iree_trace_replay_streams_t** out_streams) {
+  IREE_ASSERT_ARGUMENT(options);
+  IREE_ASSERT_ARGUMENT(out_streams);
+  *out_streams = NULL;
+  if (options->stream_count == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "at least one replay stream is required");
+  }
+  if (device_uri_count != 1) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "exactly one device must be specified for "
+                            "multi-stream replay; got %" PRIhsz,
+                            device_uri_count);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, options->stream_count);
+
+  const iree_host_size_t queue_depth =
+      options->queue_depth ? options->queue_depth
+                           : IREE_TRACE_REPLAY_STREAMS_DEFAULT_QUEUE_DEPTH;
+  const iree_host_size_t streams_size =
+      sizeof(iree_trace_replay_streams_t) +
+      options->stream_count * sizeof(iree_trace_replay_stream_t);
+  const iree_host_size_t total_size =
+      streams_size + options->stream_count * queue_depth *
+                         sizeof(iree_trace_replay_document_t*);
+  iree_trace_replay_streams_t* streams = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, total_size, (void**)&streams));
+  memset(streams, 0, total_size);
+  streams->host_allocator = host_allocator;
+  streams->options = *options;
+  streams->options.queue_depth = queue_depth;
+  iree_notification_initialize(&streams->idle_notification);
+
+  iree_status_t status = iree_hal_create_device_from_flags(
+      driver_registry, device_uris[0], host_allocator, &streams->device);
+
+  iree_trace_replay_document_t** queue_storage =
+      (iree_trace_replay_document_t**)((uint8_t*)streams + streams_size);
+  for (iree_host_size_t i = 0;
+       i < options->stream_count && iree_status_is_ok(status); ++i) {
+    // Count the stream even if it fails to initialize so that it is cleaned
+    // up on failure.
+    ++streams->stream_count;
+    status = iree_trace_replay_stream_initialize(
+        streams, i, root_path, instance, driver_registry, device_uri_count,
+        device_uris, queue_storage + i * queue_depth, &streams->streams[i]);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_streams = streams;
+  } else {
+    iree_trace_replay_streams_destroy(streams);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+void iree_trace_replay_streams_destroy(iree_trace_replay_streams_t* streams) {
+  if (!streams) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  for (iree_host_size_t i = 0; i < streams->stream_count; ++i) {
+    iree_trace_replay_stream_deinitialize(&streams->streams[i]);
+  }
+
+  if (streams->device &&
+      iree_all_bits_set(streams->options.replay_flags,
+                        IREE_TRACE_REPLAY_FLAG_PRINT_STATISTICS)) {
+    IREE_IGNORE_ERROR(iree_hal_allocator_statistics_fprint(
+        stderr, iree_hal_device_allocator(streams->device)));
+  }
+  iree_hal_device_release(streams->device);
+
+  iree_notification_deinitialize(&streams->idle_notification);
+  iree_allocator_free(streams->host_allocator, streams);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+iree_host_size_t iree_trace_replay_streams_count(
+    const iree_trace_replay_streams_t* streams) {
+  return streams->stream_count;
+}
+
+iree_trace_replay_t* iree_trace_replay_streams_replay(
+    iree_trace_replay_streams_t* streams, iree_host_size_t ordinal) {
+  IREE_ASSERT_LT(ordinal, streams->stream_count);
+  return &streams->streams[ordinal].replay;
+}
+
+iree_hal_device_t* iree_trace_replay_streams_device(
+    const iree_trace_replay_streams_t* streams) {
+  return streams->device;
+}
+
+void iree_trace_replay_streams_reset(iree_trace_replay_streams_t* streams) {
+  for (iree_host_size_t i = 0; i < streams->stream_count; ++i) {
+    iree_trace_replay_reset(&streams->streams[i].replay);
+  }
+}
+
+// Returns true if any stream has failed during the current run.
+static bool iree_trace_replay_streams_any_failed(
+    iree_trace_replay_streams_t* streams) {
+  bool any_failed = false;
+  for (iree_host_size_t i = 0; i < streams->stream_count && !any_failed; ++i) {
+    iree_trace_replay_stream_t* stream = &streams->streams[i];
+    iree_slim_mutex_lock(&stream->mutex);
+    any_failed = !iree_status_is_ok(stream->status);
+    iree_slim_mutex_unlock(&stream->mutex);
+  }
+  return any_failed;
+}
+
+static bool iree_trace_replay_stream_has_space(void* arg) {
+  iree_trace_replay_stream_t* stream = (iree_trace_replay_stream_t*)arg;
+  iree_slim_mutex_lock(&stream->mutex);
+  bool has_space = stream->queue_count < stream->streams->options.queue_depth;
+  iree_slim_mutex_unlock(&stream->mutex);
+  return has_space;
+}
+
+static bool iree_trace_replay_streams_are_idle(void* arg) {
+  iree_trace_replay_streams_t* streams = (iree_trace_replay_streams_t*)arg;
+  bool all_idle = true;
+  for (iree_host_size_t i = 0; i < streams->stream_count && all_idle; ++i) {
+    iree_trace_replay_stream_t* stream = &streams->streams[i];
+    iree_slim_mutex_lock(&stream->mutex);
+    all_idle = stream->queue_count == 0 && !stream->busy;
+    iree_slim_mutex_unlock(&stream->mutex);
+  }
+  return all_idle;
+}
+
+// Enqueues |document| on |stream|, blocking until there is space in the stream
+// queue. Takes a reference to |document| that the stream will release.
+static void iree_trace_replay_stream_enqueue(
+    iree_trace_replay_stream_t* stream,
+    iree_trace_replay_document_t* document) {
+  iree_trace_replay_streams_t* streams = stream->streams;
+  const iree_host_size_t queue_depth = streams->options.queue_depth;
+  iree_notification_await(&streams->idle_notification,
+                          iree_trace_replay_stream_has_space, stream,
+                          iree_infinite_timeout());
+  // Only this thread enqueues so there is still space.
+  iree_slim_mutex_lock(&stream->mutex);
+  stream->queue[(stream->queue_head + stream->queue_count) % queue_depth] =
+      document;
+  ++stream->queue_count;
+  iree_slim_mutex_unlock(&stream->mutex);
+  iree_notification_post(&stream->pending_notification, IREE_ALL_WAITERS);
+}
+
+// Parses the next document from |parser| into |out_document|. Returns with
+// |out_document| NULL when the end of the file has been reached.
+static iree_status_t iree_trace_replay_streams_parse_document(
+    iree_trace_replay_streams_t* streams, yaml_parser_t* parser,
+    iree_trace_replay_document_t** out_document) {
+  *out_document = NULL;
+  IREE_TRACE_ZONE_BEGIN_NAMED(z0, "yaml_parser_load");
+  iree_trace_replay_document_t* document = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(streams->host_allocator, sizeof(*document),
+                                (void**)&document));
+  iree_atomic_ref_count_init_value(&document->ref_count, 0);
+  document->host_allocator = streams->host_allocator;
+  if (!yaml_parser_load(parser, &document->document)) {
+    iree_allocator_free(streams->host_allocator, document);
+    IREE_TRACE_ZONE_END(z0);
+    return iree_status_from_yaml_parser_error(parser);
+  }
+  document->event_node = yaml_document_get_root_node(&document->document);
+  if (!document->event_node) {
+    // EOF (empty document).
+    yaml_document_delete(&document->document);
+    iree_allocator_free(streams->host_allocator, document);
+  } else {
+    *out_document = document;
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+// Routes |document| to the stream named by its `stream` key or all streams if
+// it has none. Consumes the caller's reference to |document|.
+static iree_status_t iree_trace_replay_streams_route_document(
+    iree_trace_replay_streams_t* streams,
+    iree_trace_replay_document_t* document) {
+  yaml_node_t* stream_node = NULL;
+  iree_status_t status = iree_ok_status();
+  if (document->event_node->type == YAML_MAPPING_NODE) {
+    status = iree_yaml_mapping_try_find(&document->document,
+                                        document->event_node,
+                                        IREE_SV("stream"), &stream_node);
+  }
+  if (iree_status_is_ok(status) && stream_node) {
+    uint64_t stream_id = 0;
+    if (!iree_string_view_atoi_uint64(iree_yaml_node_as_string(stream_node),
+                                      &stream_id)) {
+      status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "(%zu): stream must be a non-negative integer",
+                                stream_node->start_mark.line);
+    } else {
+      iree_atomic_ref_count_init_value(&document->ref_count, 1);
+      iree_trace_replay_stream_enqueue(
+          &streams->streams[stream_id % streams->stream_count], document);
+      return iree_ok_status();
+    }
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_atomic_ref_count_init_value(&document->ref_count, 1);
+    iree_trace_replay_document_release(document);
+    return status;
+  }
+
+  // Broadcast; the reference count must be set before any stream can release.
+  iree_atomic_ref_count_init_value(&document->ref_count,
+                                   (int32_t)streams->stream_count);
+  for (iree_host_size_t i = 0; i < streams->stream_count; ++i) {
+    iree_trace_replay_stream_enqueue(&streams->streams[i], document);
+  }
+  return iree_ok_status();
+}
+
+iree_status_t iree_trace_replay_streams_run_file(
+    iree_trace_replay_streams_t* streams, FILE* file) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  yaml_parser_t parser;
+  if (!yaml_parser_initialize(&parser)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_INTERNAL,
+                            "yaml_parser_initialize failed");
+  }
+  yaml_parser_set_input_file(&parser, file);
+
+  // Parse and route documents one at a time. The stream queues bound how far
+  // ahead of execution parsing can get.
+  const iree_time_t start_ns = iree_time_now();
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status) &&
+         !iree_trace_replay_streams_any_failed(streams)) {
+    iree_trace_replay_document_t* document = NULL;
+    status =
+        iree_trace_replay_streams_parse_document(streams, &parser, &document);
+    if (!iree_status_is_ok(status) || !document) break;
+    status = iree_trace_replay_streams_route_document(streams, document);
+  }
+  yaml_parser_delete(&parser);
+
+  // Wait for all streams to drain. Streams that have failed drop their
+  // remaining documents.
+  iree_notification_await(&streams->idle_notification,
+                          iree_trace_replay_streams_are_idle, streams,
+                          iree_infinite_timeout());
+  const iree_time_t end_ns = iree_time_now();
+  ++streams->run_count;
+  streams->run_duration_ns += end_ns - start_ns;
+
+  // Gather stream failures and fold the run timing into the statistics.
+  for (iree_host_size_t i = 0; i < streams->stream_count; ++i) {
+    iree_trace_replay_stream_t* stream = &streams->streams[i];
+    iree_slim_mutex_lock(&stream->mutex);
+    if (stream->run_start_ns) {
+      stream->statistics.active_duration_ns +=
+          stream->run_end_ns - stream->run_start_ns;
+    }
+    stream->run_start_ns = 0;
+    stream->run_end_ns = 0;
+    if (iree_status_is_ok(status)) {
+      status = stream->status;
+    } else {
+      iree_status_ignore(stream->status);
+    }
+    stream->status = iree_ok_status();
+    iree_slim_mutex_unlock(&stream->mutex);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_trace_replay_streams_fprint_row(
+    FILE* file, const char* name, uint64_t event_count, uint64_t call_count,
+    iree_duration_t duration_ns, const iree_tooling_histogram_t* latency) {
+  const double ns_per_ms = 1000000.0;
+  const double calls_per_s =
+      duration_ns > 0 ? (double)call_count * 1e9 / (double)duration_ns : 0.0;
+  fprintf(file,
+          "%8s %10" PRIu64 " %10" PRIu64
+          " %12.3f %10.2f %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+          name, event_count, call_count, (double)duration_ns / ns_per_ms,
+          calls_per_s, iree_tooling_histogram_mean(latency) / ns_per_ms,
+          iree_tooling_histogram_value_at_percentile(latency, 50.0) / ns_per_ms,
+          iree_tooling_histogram_value_at_percentile(latency, 90.0) / ns_per_ms,
+          iree_tooling_histogram_value_at_percentile(latency, 99.0) / ns_per_ms,
+          (latency->total_count ? latency->max_value : 0) / ns_per_ms);
+}
+
+void iree_trace_replay_streams_fprint_statistics(
+    iree_trace_replay_streams_t* streams, FILE* file) {
+  iree_tooling_histogram_t* total_latency = NULL;
+  if (!iree_status_is_ok(iree_allocator_malloc(streams->host_allocator,
+                                               sizeof(*total_latency),
+                                               (void**)&total_latency))) {
+    return;
+  }
+  iree_tooling_histogram_initialize(total_latency);
+
+  fprintf(file,
+          "Replayed %" PRIu64 " run(s) across %" PRIhsz
+          " stream(s); call latencies in ms:\n",
+          streams->run_count, streams->stream_count);
+  fprintf(file, "%8s %10s %10s %12s %10s %10s %10s %10s %10s %10s\n", "stream",
+          "events", "calls", "active(ms)", "calls/s", "mean", "p50", "p90",
+          "p99", "max");
+  uint64_t total_event_count = 0;
+  uint64_t total_call_count = 0;
+  for (iree_host_size_t i = 0; i < streams->stream_count; ++i) {
+    iree_trace_replay_stream_t* stream = &streams->streams[i];
+    iree_slim_mutex_lock(&stream->mutex);
+    const iree_trace_replay_stream_statistics_t* statistics =
+        &stream->statistics;
+    char name[16];
+    snprintf(name, sizeof(name), "%" PRIhsz, i);
+    iree_trace_replay_streams_fprint_row(
+        file, name, statistics->event_count, statistics->call_count,
+        statistics->active_duration_ns, &statistics->call_latency);
+    total_event_count += statistics->event_count;
+    total_call_count += statistics->call_count;
+    iree_tooling_histogram_merge(total_latency, &statistics->call_latency);
+    iree_slim_mutex_unlock(&stream->mutex);
+  }
+  // Aggregate throughput is over the wall time of all runs.
+  iree_trace_replay_streams_fprint_row(file, "all", total_event_count,
+                                       total_call_count,
+                                       streams->run_duration_ns, total_latency);
+
+  iree_allocator_free(streams->host_allocator, total_latency);
+}
@@ -0,0 +1,115 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===----------------------------------------------------------------------===//
+// Concurrent multi-stream trace replay
+//===----------------------------------------------------------------------===//
+//
+// Replays a single trace file across multiple concurrent streams. Each stream
+// is an independent iree_trace_replay_t with its own VM context, inputs,
+// outputs, and blackboard running on its own thread. All streams share a
+// single HAL device so that the replay models a server handling many
+// independent sessions at once.
+//
+// Trace documents are parsed one at a time on the calling thread and routed to
+// streams based on an optional `stream` key in each event:
+//   * `stream: N` routes the event to stream N modulo the stream count. Events
+//     from the same stream are executed in trace order. Recorded sessions can
+//     use their session ID here and any number of sessions can be folded onto
+//     a smaller number of streams.
+//   * Events without a `stream` key are broadcast to all streams. This allows
+//     shared setup (context_load/module_load) to be written once and an
+//     unmodified single-stream trace to be replayed as N concurrent copies.
+//
+// Each stream has a bounded queue of pending documents and parsing blocks when
+// a stream falls behind so the memory required to replay a trace is
+// proportional to the queue depth and not the trace size.
+//
+// Call latencies are recorded per stream and can be reported per stream and in
+// aggregate with iree_trace_replay_streams_fprint_statistics.
+
+#ifndef IREE_TOOLING_TRACE_REPLAY_STREAMS_H_
+#define IREE_TOOLING_TRACE_REPLAY_STREAMS_H_
+
+#include <stdio.h>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/tooling/trace_replay.h"
+#include "iree/tooling/yaml_util.h"
+#include "iree/vm/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Default number of documents that may be pending per stream.
+#define IREE_TRACE_REPLAY_STREAMS_DEFAULT_QUEUE_DEPTH 16
+
+typedef struct iree_trace_replay_streams_options_t {
+  // Total number of concurrent streams. Must be at least 1.
+  iree_host_size_t stream_count;
+  // Maximum number of documents pending on each stream before parsing blocks.
+  // If 0 IREE_TRACE_REPLAY_STREAMS_DEFAULT_QUEUE_DEPTH is used.
+  iree_host_size_t queue_depth;
+  // Flags applied to each stream replay. IREE_TRACE_REPLAY_FLAG_REUSE_DEVICES
+  // is always set as all streams share the same device.
+  iree_trace_replay_flags_t replay_flags;
+  // Flags used for each stream VM context.
+  iree_vm_context_flags_t context_flags;
+  // Optional hooks issued around each call. Hooks are called concurrently from
+  // all stream threads and must be thread-safe.
+  iree_trace_replay_call_hooks_t call_hooks;
+} iree_trace_replay_streams_options_t;
+
+typedef struct iree_trace_replay_streams_t iree_trace_replay_streams_t;
+
+// Creates a multi-stream replay with all streams sharing a single device
+// created from the one required |device_uris| entry. Stream threads are
+// started immediately and idle until a trace file is run.
+iree_status_t iree_trace_replay_streams_create(
+    iree_string_view_t root_path, iree_vm_instance_t* instance,
+    const iree_trace_replay_streams_options_t* options,
+    iree_hal_driver_registry_t* driver_registry,
+    iree_host_size_t device_uri_count, const iree_string_view_t* device_uris,
+    iree_allocator_t host_allocator, iree_trace_replay_streams_t** out_streams);
+
+// Stops all stream threads and releases all replay resources.
+void iree_trace_replay_streams_destroy(iree_trace_replay_streams_t* streams);
+
+// Returns the total number of streams.
+iree_host_size_t iree_trace_replay_streams_count(
+    const iree_trace_replay_streams_t* streams);
+
+// Returns the replay state of stream |ordinal|. Callers may populate stream
+// inputs and read stream outputs only while no trace file is running.
+iree_trace_replay_t* iree_trace_replay_streams_replay(
+    iree_trace_replay_streams_t* streams, iree_host_size_t ordinal);
+
+// Returns the HAL device shared by all streams.
+iree_hal_device_t* iree_trace_replay_streams_device(
+    const iree_trace_replay_streams_t* streams);
+
+// Clears the inputs, outputs, and blackboard of all streams.
+// Statistics are preserved.
+void iree_trace_replay_streams_reset(iree_trace_replay_streams_t* streams);
+
+// Replays all documents in |file| across the streams and returns after all
+// streams have executed all routed events. Returns the first failure of any
+// stream; parsing stops once any stream has failed.
+iree_status_t iree_trace_replay_streams_run_file(
+    iree_trace_replay_streams_t* streams, FILE* file);
+
+// Prints the per-stream and aggregate replay timing accumulated over all runs
+// to |file|.
+void iree_trace_replay_streams_fprint_statistics(
+    iree_trace_replay_streams_t* streams, FILE* file);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_TOOLING_TRACE_REPLAY_STREAMS_H_
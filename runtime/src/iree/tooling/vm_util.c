@@ -26,9 +26,49 @@ static iree_status_t iree_allocate_and_copy_cstring_from_view(
   return iree_ok_status();
 }
 
+static iree_status_t iree_tooling_push_npz_ndarray(
+    void* user_data, iree_string_view_t name,
+    iree_hal_buffer_view_t* buffer_view) {
+  iree_vm_list_t* list = (iree_vm_list_t*)user_data;
+  iree_vm_ref_t buffer_view_ref = iree_hal_buffer_view_retain_ref(buffer_view);
+  return iree_vm_list_push_ref_move(list, &buffer_view_ref);
+}
+
+// Loads all arrays in an .npz file in archive order. Arrays are loaded in
+// parallel and mapped directly from the file when the device allows.
+static iree_status_t iree_tooling_load_ndarrays_from_npz_file(
+    iree_string_view_t file_path, iree_hal_allocator_t* device_allocator,
+    iree_vm_list_t* list) {
+  char* file_path_cstring = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocate_and_copy_cstring_from_view(
+      iree_allocator_system(), file_path, &file_path_cstring));
+
+  iree_hal_buffer_params_t buffer_params = {0};
+  buffer_params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+  buffer_params.access = IREE_HAL_MEMORY_ACCESS_READ;
+  buffer_params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+
+  iree_numpy_npz_load_callback_t callback = {
+      .fn = iree_tooling_push_npz_ndarray,
+      .user_data = list,
+  };
+  iree_status_t status = iree_numpy_npz_load_ndarrays(
+      file_path_cstring, IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE,
+      iree_numpy_npz_default_worker_count(), buffer_params, device_allocator,
+      callback);
+
+  iree_allocator_free(iree_allocator_system(), file_path_cstring);
+  return status;
+}
+
 static iree_status_t iree_tooling_load_ndarrays_from_file(
     iree_string_view_t file_path, iree_hal_allocator_t* device_allocator,
     iree_vm_list_t* list) {
+  if (iree_string_view_ends_with(file_path, IREE_SV(".npz"))) {
+    return iree_tooling_load_ndarrays_from_npz_file(file_path, device_allocator,
+                                                    list);
+  }
+
   char* file_path_cstring = NULL;
   IREE_RETURN_IF_ERROR(iree_allocate_and_copy_cstring_from_view(
       iree_allocator_system(), file_path, &file_path_cstring));
@@ -51,11 +51,28 @@
 // how the full program will run, though, and YMMV. Always verify timings with
 // an appropriate device-specific tool before trusting the more generic and
 // higher-level numbers from this tool.
+//
+// Google Benchmark reports mean times of closed-loop invocations which are not
+// representative of a service handling independent requests. Passing
+// --load_clients=N instead runs a load generator with N client threads, each
+// invoking the function in its own VM context on the shared device, with an
+// optional open-loop arrival rate (--load_rate=). Latency percentiles are
+// measured from each request's scheduled arrival time such that queueing delay
+// is included when the device cannot keep up (avoiding coordinated omission).
+// As an example --load_clients=4 --load_rate=200 --load_arrival=poisson will
+// report the latency distribution of 4 clients each receiving ~50 requests per
+// second.
 
+#include <algorithm>
 #include <array>
+#include <cinttypes>
 #include <cstdio>
+#include <cstring>
 #include <iterator>
+#include <memory>
+#include <random>
 #include <string>
+#include <thread>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -68,6 +85,7 @@
 #include "iree/modules/hal/types.h"
 #include "iree/tooling/context_util.h"
 #include "iree/tooling/device_util.h"
+#include "iree/tooling/histogram.h"
 #include "iree/tooling/vm_util.h"
 #include "iree/vm/api.h"
 
@@ -92,6 +110,37 @@ IREE_FLAG(string, function, "",
 IREE_FLAG(bool, print_statistics, false,
           "Prints runtime statistics to stderr on exit.");
 
+IREE_FLAG(int32_t, load_clients, 0,
+          "When > 0 runs a load generator instead of Google Benchmark with N\n"
+          "client threads each invoking the function in its own VM context\n"
+          "on the shared device and reports latency percentiles.");
+IREE_FLAG(double, load_rate, 0.0,
+          "Target aggregate arrival rate in invocations per second across\n"
+          "all --load_clients=. Arrivals are open-loop and latency is\n"
+          "measured from the scheduled arrival time. When 0 each client\n"
+          "issues invocations back-to-back (closed-loop).");
+IREE_FLAG(string, load_arrival, "constant",
+          "Arrival process used with --load_rate=: 'constant' spaces\n"
+          "arrivals evenly and 'poisson' uses exponentially distributed\n"
+          "inter-arrival times.");
+IREE_FLAG(int32_t, load_duration_ms, 10000,
+          "Duration of the measured portion of a --load_clients= run.");
+IREE_FLAG(int32_t, load_warmup_ms, 1000,
+          "Duration of a --load_clients= run before measurement begins\n"
+          "during which invocations are issued but not recorded.");
+IREE_FLAG(string, load_histogram_output, "",
+          "Path to write the --load_clients= latency distribution to in\n"
+          "HdrHistogram percentile (.hgrm) format in the --time_unit=.");
+
+IREE_FLAG(double, roofline_peak_gflops, 0.0,
+          "Peak compute throughput of the machine in GFLOP/s used to report\n"
+          "the achieved fraction of peak of dispatch benchmarks compiled\n"
+          "with --iree-flow-annotate-dispatch-roofline.");
+IREE_FLAG(double, roofline_peak_gbps, 0.0,
+          "Peak memory bandwidth of the machine in GB/s used to report the\n"
+          "achieved fraction of peak of dispatch benchmarks compiled with\n"
+          "--iree-flow-annotate-dispatch-roofline.");
+
 IREE_FLAG_LIST(
     string, input,
     "An input value or buffer of the format:\n"
@@ -103,6 +152,9 @@ IREE_FLAG_LIST(
     "  2x2xi32=@some/file.bin\n"
     "numpy npy files (from numpy.save) can be read to provide 1+ values:\n"
     "  @some.npy\n"
+    "numpy npz files (from numpy.savez) provide all arrays in archive order\n"
+    "and are loaded in parallel (mapping the file directly when possible):\n"
+    "  @some.npz\n"
     "Each occurrence of the flag indicates an input in the order they were\n"
     "specified on the command line.");
 
@@ -354,9 +406,59 @@ void RegisterAsyncBenchmark(const std::string& function_name,
                                   : benchmark::kMillisecond);
 }
 
+// Static cost of a single dispatch as recorded by the compiler.
+// Counts are 0 when unknown.
+struct DispatchRoofline {
+  uint64_t flop_count = 0;
+  uint64_t byte_count = 0;
+};
+
+// Reads the `iree.roofline.*` reflection attributes from |function|.
+static DispatchRoofline LookupDispatchRoofline(iree_vm_function_t function) {
+  DispatchRoofline roofline;
+  iree_string_view_atoi_uint64(
+      iree_vm_function_lookup_attr_by_name(&function,
+                                           IREE_SV("iree.roofline.flops")),
+      &roofline.flop_count);
+  iree_string_view_atoi_uint64(
+      iree_vm_function_lookup_attr_by_name(&function,
+                                           IREE_SV("iree.roofline.bytes")),
+      &roofline.byte_count);
+  return roofline;
+}
+
+// Reports the achieved throughput of |dispatch_count| dispatches taking
+// |elapsed_ns| in total relative to |roofline| and the configured peaks.
+static void ReportDispatchRoofline(const DispatchRoofline& roofline,
+                                   int64_t dispatch_count,
+                                   iree_duration_t elapsed_ns,
+                                   benchmark::State& state) {
+  if (dispatch_count <= 0 || elapsed_ns <= 0) return;
+  // Counts per nanosecond are equivalent to billions per second.
+  if (roofline.flop_count > 0) {
+    double gflops = static_cast<double>(roofline.flop_count) *
+                    dispatch_count / static_cast<double>(elapsed_ns);
+    state.counters["GFLOP/s"] = benchmark::Counter(gflops);
+    if (FLAG_roofline_peak_gflops > 0.0) {
+      state.counters["%peak_flops"] =
+          benchmark::Counter(100.0 * gflops / FLAG_roofline_peak_gflops);
+    }
+  }
+  if (roofline.byte_count > 0) {
+    double gbps = static_cast<double>(roofline.byte_count) * dispatch_count /
+                  static_cast<double>(elapsed_ns);
+    state.counters["GB/s"] = benchmark::Counter(gbps);
+    if (FLAG_roofline_peak_gbps > 0.0) {
+      state.counters["%peak_bandwidth"] =
+          benchmark::Counter(100.0 * gbps / FLAG_roofline_peak_gbps);
+    }
+  }
+}
+
 static void BenchmarkDispatchFunction(const std::string& benchmark_name,
                                       iree_vm_context_t* context,
                                       iree_vm_function_t function,
+                                      DispatchRoofline roofline,
                                       benchmark::State& state) {
   IREE_TRACE_SCOPE_DYNAMIC(benchmark_name.c_str());
   IREE_TRACE_FRAME_MARK();
@@ -372,6 +474,7 @@ static void BenchmarkDispatchFunction(const std::string& benchmark_name,
                                     iree_allocator_system(), &outputs));
 
   // Benchmarking loop.
+  iree_time_t start_ns = iree_time_now();
   while (state.KeepRunningBatch(FLAG_batch_size)) {
     IREE_TRACE_SCOPE0("BenchmarkIteration");
     IREE_TRACE_FRAME_MARK_NAMED("Iteration");
@@ -380,17 +483,22 @@ static void BenchmarkDispatchFunction(const std::string& benchmark_name,
         inputs.get(), outputs.get(), iree_allocator_system()));
     IREE_CHECK_OK(iree_vm_list_resize(outputs.get(), 0));
   }
+  iree_duration_t elapsed_ns = iree_time_now() - start_ns;
   state.SetItemsProcessed(state.iterations());
+  ReportDispatchRoofline(roofline, state.iterations(), elapsed_ns, state);
 }
 
 void RegisterDispatchBenchmark(const std::string& function_name,
                                iree_vm_context_t* context,
                                iree_vm_function_t function) {
   auto benchmark_name = "BM_" + function_name;
+  DispatchRoofline roofline = LookupDispatchRoofline(function);
   benchmark::RegisterBenchmark(
       benchmark_name.c_str(),
-      [benchmark_name, context, function](benchmark::State& state) -> void {
-        BenchmarkDispatchFunction(benchmark_name, context, function, state);
+      [benchmark_name, context, function,
+       roofline](benchmark::State& state) -> void {
+        BenchmarkDispatchFunction(benchmark_name, context, function, roofline,
+                                  state);
       })
       // By default only the main thread is included in CPU time. Include all
       // the threads instead.
@@ -403,6 +511,328 @@ void RegisterDispatchBenchmark(const std::string& function_name,
                                   : benchmark::kMicrosecond);
 }
 
+//===----------------------------------------------------------------------===//
+// Load generation
+//===----------------------------------------------------------------------===//
+
+struct LoadOptions {
+  int32_t client_count = 1;
+  // Per-client arrival rate in invocations per nanosecond or 0 if closed-loop.
+  double client_rate_per_ns = 0.0;
+  bool poisson_arrival = false;
+  // Time at which all clients begin issuing invocations.
+  iree_time_t start_ns = 0;
+  // Time at which recording begins (after warmup).
+  iree_time_t measure_start_ns = 0;
+  // Time after which no new invocations are scheduled.
+  iree_time_t end_ns = 0;
+  // Time after which clients stop draining invocations that were scheduled
+  // before |end_ns| but could not be issued in time.
+  iree_time_t drain_end_ns = 0;
+};
+
+struct LoadClientResult {
+  LoadClientResult() {
+    iree_tooling_histogram_initialize(&latency);
+    iree_tooling_histogram_initialize(&service_time);
+  }
+  // Time from scheduled arrival to completion.
+  iree_tooling_histogram_t latency;
+  // Time from issue to completion.
+  iree_tooling_histogram_t service_time;
+  // Time the last recorded invocation completed.
+  iree_time_t last_completion_ns = 0;
+  // True if the client gave up draining its backlog.
+  bool saturated = false;
+  iree_status_t status = iree_ok_status();
+};
+
+// Runs a single client issuing invocations of |function| in |context| until
+// the end of the load run. Coarse-fences functions are invoked with a new
+// signal fence per invocation and waited on before the next invocation.
+static iree_status_t RunLoadClient(const LoadOptions& options,
+                                   int32_t client_index,
+                                   iree_hal_device_t* device,
+                                   iree_vm_context_t* context,
+                                   iree_vm_function_t function, bool is_async,
+                                   iree_vm_list_t* common_inputs,
+                                   LoadClientResult* result) {
+  IREE_TRACE_SCOPE0("LoadClient");
+  iree_allocator_t host_allocator = iree_allocator_system();
+
+  vm::ref<iree_vm_list_t> inputs;
+  if (common_inputs) {
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_clone(common_inputs, host_allocator, &inputs));
+  } else {
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                             2, host_allocator, &inputs));
+  }
+  const iree_host_size_t base_input_count = iree_vm_list_size(inputs.get());
+  vm::ref<iree_vm_list_t> outputs;
+  IREE_RETURN_IF_ERROR(iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                           16, host_allocator, &outputs));
+  vm::ref<iree_hal_semaphore_t> timeline_semaphore;
+  if (is_async) {
+    IREE_RETURN_IF_ERROR(
+        iree_hal_semaphore_create(device, 0ull, &timeline_semaphore));
+  }
+
+  // Stagger constant arrivals across clients so that the aggregate arrival
+  // process is evenly spaced.
+  const bool closed_loop = options.client_rate_per_ns <= 0.0;
+  const double interval_ns =
+      closed_loop ? 0.0 : 1.0 / options.client_rate_per_ns;
+  std::mt19937_64 prng(client_index + 1);
+  std::exponential_distribution<double> exponential_interval(
+      closed_loop ? 1.0 : options.client_rate_per_ns);
+  double next_arrival_ns =
+      (double)options.start_ns +
+      (options.poisson_arrival
+           ? exponential_interval(prng)
+           : interval_ns * client_index / options.client_count);
+
+  iree_wait_until(options.start_ns);
+  for (uint64_t invocation = 0;; ++invocation) {
+    iree_time_t scheduled_ns =
+        closed_loop ? iree_time_now() : (iree_time_t)next_arrival_ns;
+    if (scheduled_ns >= options.end_ns) break;
+    if (!closed_loop) iree_wait_until(scheduled_ns);
+    iree_time_t issue_ns = iree_time_now();
+    if (issue_ns >= options.drain_end_ns) {
+      result->saturated = true;
+      break;
+    }
+
+    IREE_TRACE_ZONE_BEGIN_NAMED(z_invocation, "LoadInvocation");
+    iree_status_t status = iree_ok_status();
+    if (is_async) {
+      // Each invocation waits on nothing and signals the next timeline value.
+      vm::ref<iree_hal_fence_t> wait_fence;
+      vm::ref<iree_hal_fence_t> signal_fence;
+      status = iree_hal_fence_create_at(timeline_semaphore.get(),
+                                        invocation + 1, host_allocator,
+                                        &signal_fence);
+      if (iree_status_is_ok(status)) {
+        status = iree_vm_list_resize(inputs.get(), base_input_count);
+      }
+      if (iree_status_is_ok(status)) {
+        status = iree_vm_list_push_ref_move(inputs.get(), wait_fence);
+      }
+      if (iree_status_is_ok(status)) {
+        status = iree_vm_list_push_ref_retain(inputs.get(), signal_fence);
+      }
+      if (iree_status_is_ok(status)) {
+        status = iree_vm_invoke(context, function, IREE_VM_INVOCATION_FLAG_NONE,
+                                /*policy=*/nullptr, inputs.get(),
+                                outputs.get(), host_allocator);
+      }
+      if (iree_status_is_ok(status)) {
+        status =
+            iree_hal_fence_wait(signal_fence.get(), iree_infinite_timeout());
+      }
+    } else {
+      status = iree_vm_invoke(context, function, IREE_VM_INVOCATION_FLAG_NONE,
+                              /*policy=*/nullptr, inputs.get(), outputs.get(),
+                              host_allocator);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_vm_list_resize(outputs.get(), 0);
+    }
+    IREE_TRACE_ZONE_END(z_invocation);
+    IREE_RETURN_IF_ERROR(status);
+    iree_time_t completion_ns = iree_time_now();
+
+    if (scheduled_ns >= options.measure_start_ns) {
+      iree_tooling_histogram_record(&result->latency,
+                                    completion_ns - scheduled_ns);
+      iree_tooling_histogram_record(&result->service_time,
+                                    completion_ns - issue_ns);
+      result->last_completion_ns = completion_ns;
+    }
+
+    if (!closed_loop) {
+      next_arrival_ns += options.poisson_arrival ? exponential_interval(prng)
+                                                 : interval_ns;
+    }
+  }
+  return iree_ok_status();
+}
+
+static void PrintLoadHistogram(const char* name,
+                               const iree_tooling_histogram_t* histogram,
+                               double unit_scale, const char* unit_name) {
+  fprintf(stdout,
+          "  %-8s (%s): mean=%.3f p50=%.3f p90=%.3f p99=%.3f p99.9=%.3f "
+          "max=%.3f\n",
+          name, unit_name, iree_tooling_histogram_mean(histogram) / unit_scale,
+          iree_tooling_histogram_value_at_percentile(histogram, 50.0) /
+              unit_scale,
+          iree_tooling_histogram_value_at_percentile(histogram, 90.0) /
+              unit_scale,
+          iree_tooling_histogram_value_at_percentile(histogram, 99.0) /
+              unit_scale,
+          iree_tooling_histogram_value_at_percentile(histogram, 99.9) /
+              unit_scale,
+          histogram->max_value / unit_scale);
+}
+
+// Runs |function| under load with the configuration from flags using one VM
+// context per client created from the modules registered in |context|.
+static iree_status_t RunLoad(const std::string& function_name,
+                             iree_hal_device_t* device,
+                             iree_vm_context_t* context,
+                             iree_vm_function_t function,
+                             iree_vm_list_t* inputs) {
+  IREE_TRACE_SCOPE0("RunLoad");
+  iree_allocator_t host_allocator = iree_allocator_system();
+
+  const int32_t client_count = FLAG_load_clients;
+  if (FLAG_load_rate < 0.0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "--load_rate= must be >= 0");
+  } else if (FLAG_load_duration_ms <= 0 || FLAG_load_warmup_ms < 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "--load_duration_ms= must be > 0 and "
+                            "--load_warmup_ms= must be >= 0");
+  }
+  iree_string_view_t arrival = iree_make_cstring_view(FLAG_load_arrival);
+  bool poisson_arrival = false;
+  if (iree_string_view_equal(arrival, IREE_SV("poisson"))) {
+    poisson_arrival = true;
+  } else if (!iree_string_view_equal(arrival, IREE_SV("constant"))) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unsupported --load_arrival= '%.*s'; expected "
+                            "'constant' or 'poisson'",
+                            (int)arrival.size, arrival.data);
+  }
+
+  iree_string_view_t invocation_model = iree_vm_function_lookup_attr_by_name(
+      &function, IREE_SV("iree.abi.model"));
+  const bool is_async =
+      iree_string_view_equal(invocation_model, IREE_SV("coarse-fences"));
+  if (is_async && !device) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "coarse-fences functions require a HAL device");
+  }
+
+  // Each client gets its own context sharing the same module instances (and
+  // therefore the same device). Module state such as globals is per-context.
+  std::vector<vm::ref<iree_vm_context_t>> client_contexts(client_count);
+  std::vector<iree_vm_module_t*> modules(iree_vm_context_module_count(context));
+  for (iree_host_size_t i = 0; i < modules.size(); ++i) {
+    modules[i] = iree_vm_context_module_at(context, i);
+  }
+  for (int32_t i = 0; i < client_count; ++i) {
+    IREE_RETURN_IF_ERROR(iree_vm_context_create_with_modules(
+        iree_vm_context_instance(context), iree_vm_context_flags(context),
+        modules.size(), modules.data(), host_allocator, &client_contexts[i]));
+  }
+
+  // Give clients a moment to spin up so that they all start together.
+  LoadOptions options;
+  options.client_count = client_count;
+  options.client_rate_per_ns = FLAG_load_rate / client_count / 1e9;
+  options.poisson_arrival = poisson_arrival;
+  options.start_ns = iree_time_now() + 10 * 1000000ll;
+  options.measure_start_ns =
+      options.start_ns + FLAG_load_warmup_ms * 1000000ll;
+  options.end_ns = options.measure_start_ns + FLAG_load_duration_ms * 1000000ll;
+  options.drain_end_ns = options.end_ns + FLAG_load_duration_ms * 1000000ll;
+
+  std::vector<std::unique_ptr<LoadClientResult>> results(client_count);
+  std::vector<std::thread> threads;
+  for (int32_t i = 0; i < client_count; ++i) {
+    results[i] = std::make_unique<LoadClientResult>();
+    threads.emplace_back([&, i]() {
+      results[i]->status =
+          RunLoadClient(options, i, device, client_contexts[i].get(), function,
+                        is_async, inputs, results[i].get());
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  // Merge results from all clients.
+  auto merged = std::make_unique<LoadClientResult>();
+  bool saturated = false;
+  iree_status_t status = iree_ok_status();
+  for (auto& result : results) {
+    if (!iree_status_is_ok(result->status)) {
+      if (iree_status_is_ok(status)) {
+        status = result->status;
+      } else {
+        iree_status_ignore(result->status);
+      }
+      continue;
+    }
+    iree_tooling_histogram_merge(&merged->latency, &result->latency);
+    iree_tooling_histogram_merge(&merged->service_time,
+                                 &result->service_time);
+    merged->last_completion_ns =
+        std::max(merged->last_completion_ns, result->last_completion_ns);
+    saturated |= result->saturated;
+  }
+  IREE_RETURN_IF_ERROR(status);
+
+  double unit_scale = 1e6;
+  const char* unit_name = kMillisecondsUnitString;
+  if (FLAG_time_unit.first) {
+    switch (FLAG_time_unit.second) {
+      case benchmark::kNanosecond:
+        unit_scale = 1.0;
+        unit_name = kNanosecondsUnitString;
+        break;
+      case benchmark::kMicrosecond:
+        unit_scale = 1e3;
+        unit_name = kMicrosecondsUnitString;
+        break;
+      default:
+        break;
+    }
+  }
+
+  const iree_time_t measured_ns =
+      std::max(options.end_ns, merged->last_completion_ns) -
+      options.measure_start_ns;
+  const uint64_t completed = merged->latency.total_count;
+  fprintf(stdout, "%s: clients=%d", function_name.c_str(), client_count);
+  if (FLAG_load_rate > 0.0) {
+    fprintf(stdout, " rate=%.2f/s arrival=%s", FLAG_load_rate,
+            poisson_arrival ? "poisson" : "constant");
+  } else {
+    fprintf(stdout, " rate=closed-loop");
+  }
+  fprintf(stdout, " duration=%dms warmup=%dms\n", FLAG_load_duration_ms,
+          FLAG_load_warmup_ms);
+  fprintf(stdout, "  completed: %" PRIu64 " invocations (%.2f/s)\n", completed,
+          completed / (measured_ns / 1e9));
+  if (completed) {
+    PrintLoadHistogram("latency", &merged->latency, unit_scale, unit_name);
+    PrintLoadHistogram("service", &merged->service_time, unit_scale,
+                       unit_name);
+  }
+  if (saturated) {
+    fprintf(stdout,
+            "  WARNING: clients could not keep up with the arrival rate and "
+            "stopped draining their backlog; latency is dominated by "
+            "queueing\n");
+  }
+  fflush(stdout);
+
+  if (strlen(FLAG_load_histogram_output) > 0) {
+    FILE* file = fopen(FLAG_load_histogram_output, "wb");
+    if (!file) {
+      return iree_make_status(IREE_STATUS_PERMISSION_DENIED,
+                              "failed to open '%s' for writing",
+                              FLAG_load_histogram_output);
+    }
+    iree_tooling_histogram_fprint_percentiles(file, &merged->latency,
+                                              unit_scale);
+    fclose(file);
+  }
+  return iree_ok_status();
+}
+
 // The lifetime of IREEBenchmark should be as long as
 // ::benchmark::RunSpecifiedBenchmarks() where the resources are used during
 // benchmarking.
@@ -424,12 +854,54 @@ class IREEBenchmark {
       IREE_IGNORE_ERROR(iree_hal_allocator_statistics_fprint(
           stderr, device_allocator_.get()));
     }
+    if (device_ && FLAG_print_statistics) {
+      IREE_IGNORE_ERROR(
+          iree_hal_device_dispatch_statistics_fprint(stderr, device_.get()));
+    }
     device_allocator_.reset();
     device_.reset();
   };
 
   iree_hal_device_t* device() const { return device_.get(); }
 
+  // Runs the function selected by --function= (or the only exported function)
+  // under load as configured by the --load_* flags.
+  iree_status_t RunLoad() {
+    IREE_TRACE_SCOPE0("IREEBenchmark::RunLoad");
+
+    if (!instance_ || !device_allocator_ || !context_ || !module_list_.count) {
+      IREE_RETURN_IF_ERROR(Init());
+    }
+
+    iree_vm_module_t* main_module =
+        iree_tooling_module_list_back(&module_list_);
+    iree_vm_function_t function;
+    auto function_name = std::string(FLAG_function);
+    if (!function_name.empty()) {
+      IREE_RETURN_IF_ERROR(iree_vm_module_lookup_function_by_name(
+          main_module, IREE_VM_FUNCTION_LINKAGE_EXPORT,
+          iree_string_view_t{function_name.data(), function_name.size()},
+          &function));
+    } else {
+      IREE_RETURN_IF_ERROR(
+          iree_tooling_find_single_exported_function(main_module, &function));
+      iree_string_view_t name = iree_vm_function_name(&function);
+      function_name = std::string(name.data, name.size);
+    }
+
+    IREE_RETURN_IF_ERROR(iree_tooling_parse_to_variant_list(
+        device_allocator_.get(), FLAG_input_list().values,
+        FLAG_input_list().count, iree_vm_instance_allocator(instance_.get()),
+        &inputs_));
+
+    IREE_RETURN_IF_ERROR(iree_hal_begin_profiling_from_flags(device_.get()));
+    iree_status_t status =
+        iree::RunLoad(function_name, device_.get(), context_.get(), function,
+                      inputs_.get());
+    return iree_status_join(
+        status, iree_hal_end_profiling_from_flags(device_.get()));
+  }
+
   iree_status_t Register() {
     IREE_TRACE_SCOPE0("IREEBenchmark::Register");
 
@@ -588,6 +1060,16 @@ int main(int argc, char** argv) {
   ::benchmark::Initialize(&argc, argv);
 
   iree::IREEBenchmark iree_benchmark;
+  if (FLAG_load_clients > 0) {
+    iree_status_t status = iree_benchmark.RunLoad();
+    if (!iree_status_is_ok(status)) {
+      int ret = static_cast<int>(iree_status_code(status));
+      printf("%s\n", iree::Status(std::move(status)).ToString().c_str());
+      return ret;
+    }
+    return 0;
+  }
+
   iree_status_t status = iree_benchmark.Register();
   if (!iree_status_is_ok(status)) {
     int ret = static_cast<int>(iree_status_code(status));
@@ -19,6 +19,7 @@
 #include "iree/testing/benchmark.h"
 #include "iree/tooling/device_util.h"
 #include "iree/tooling/trace_replay.h"
+#include "iree/tooling/trace_replay_streams.h"
 #include "iree/tooling/vm_util.h"
 #include "iree/tooling/yaml_util.h"
 #include "iree/vm/api.h"
@@ -34,6 +35,18 @@ IREE_FLAG(bool, reuse_devices, true,
 IREE_FLAG(bool, reuse_modules, true,
           "Only loads modules once and reuses them for all iterations.");
 
+IREE_FLAG(int32_t, replay_streams, 1,
+          "Number of concurrent replay streams each with its own context on a "
+          "shared device. Events with a `stream: N` key run on stream N modulo "
+          "the stream count and events without one run on all streams. When "
+          "greater than 1 each iteration measures the wall time of the entire "
+          "trace and per-stream call timing is printed to stderr with "
+          "--print_statistics.");
+IREE_FLAG(int32_t, replay_queue_depth,
+          IREE_TRACE_REPLAY_STREAMS_DEFAULT_QUEUE_DEPTH,
+          "Maximum number of parsed events pending per replay stream before "
+          "parsing blocks. Bounds replay memory usage for large traces.");
+
 IREE_FLAG_LIST(
     string, input,
     "An input (a) value or (b) buffer of the format:\n"
@@ -50,6 +63,9 @@ IREE_FLAG_LIST(
     "\n"
     "Numpy npy files from numpy.save can be read to provide 1+ values:\n"
     "  @some.npy\n"
+    "Numpy npz files from numpy.savez provide all arrays in archive order and\n"
+    "are loaded in parallel (mapping the file directly when possible):\n"
+    "  @some.npz\n"
     "\n"
     "Each occurrence of the flag indicates an input in the order they were\n"
     "specified on the command line.");
@@ -153,6 +169,87 @@ static iree_status_t iree_replay_benchmark_run_documents(
   return status;
 }
 
+// Benchmark function that runs a trace file across multiple concurrent streams.
+// Calls overlap across streams and timing cannot be paused around them
+// individually so the full replay of the trace is timed instead.
+static iree_status_t iree_replay_benchmark_run_file_streams(
+    const iree_replay_benchmark_registration_t* registration,
+    iree_trace_replay_flags_t replay_flags,
+    iree_benchmark_state_t* benchmark_state) {
+  const iree_replay_benchmark_globals_t* globals = registration->globals;
+
+  if (FLAG_replay_queue_depth < 1) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "--replay_queue_depth must be at least 1; got %d",
+                            FLAG_replay_queue_depth);
+  }
+
+  iree_trace_replay_streams_options_t options;
+  memset(&options, 0, sizeof(options));
+  options.stream_count = (iree_host_size_t)FLAG_replay_streams;
+  options.queue_depth = (iree_host_size_t)FLAG_replay_queue_depth;
+  options.replay_flags = replay_flags;
+  options.context_flags = IREE_VM_CONTEXT_FLAG_NONE;
+
+  iree_host_size_t device_uri_count = 0;
+  const iree_string_view_t* device_uris = NULL;
+  iree_hal_get_devices_flag_list(&device_uri_count, &device_uris);
+  iree_trace_replay_streams_t* streams = NULL;
+  IREE_RETURN_IF_ERROR(iree_trace_replay_streams_create(
+      registration->root_path, globals->instance, &options,
+      iree_hal_available_driver_registry(), device_uri_count, device_uris,
+      iree_allocator_system(), &streams));
+  for (iree_host_size_t i = 0; i < iree_trace_replay_streams_count(streams);
+       ++i) {
+    iree_trace_replay_streams_replay(streams, i)->stdin_contents =
+        globals->stdin_contents;
+  }
+  iree_hal_allocator_t* device_allocator =
+      iree_hal_device_allocator(iree_trace_replay_streams_device(streams));
+
+  iree_status_t status = iree_ok_status();
+  FILE* file = fopen(registration->file_path.data, "rb");
+  if (!file) {
+    status = iree_make_status(
+        iree_status_code_from_errno(errno), "failed to open trace file '%.*s'",
+        (int)registration->file_path.size, registration->file_path.data);
+  }
+
+  while (iree_status_is_ok(status) &&
+         iree_benchmark_keep_running(benchmark_state,
+                                     /*batch_count=*/1)) {
+    // Clear replay state and reload inputs for each stream untimed.
+    iree_benchmark_pause_timing(benchmark_state);
+    iree_trace_replay_streams_reset(streams);
+    for (iree_host_size_t i = 0;
+         i < iree_trace_replay_streams_count(streams) &&
+         iree_status_is_ok(status);
+         ++i) {
+      iree_trace_replay_t* replay = iree_trace_replay_streams_replay(streams, i);
+      status = iree_tooling_parse_into_variant_list(
+          device_allocator, FLAG_input_list().values, FLAG_input_list().count,
+          replay->host_allocator, replay->inputs);
+    }
+    iree_benchmark_resume_timing(benchmark_state);
+    if (!iree_status_is_ok(status)) break;
+
+    // Run all events across all streams from start to end.
+    IREE_TRACE_PLOT_VALUE_I64(IREE_REPLAY_ACTIVE_PLOT_ID, 1);
+    status = iree_trace_replay_streams_run_file(streams, file);
+    IREE_TRACE_PLOT_VALUE_I64(IREE_REPLAY_ACTIVE_PLOT_ID, 0);
+
+    // Reset file back to the start.
+    fseek(file, 0, SEEK_SET);
+  }
+
+  if (file) fclose(file);
+  if (iree_status_is_ok(status) && FLAG_print_statistics) {
+    iree_trace_replay_streams_fprint_statistics(streams, stderr);
+  }
+  iree_trace_replay_streams_destroy(streams);
+  return status;
+}
+
 // Benchmark function that runs a trace file.
 static iree_status_t iree_replay_benchmark_run_file(
     const iree_benchmark_def_t* benchmark_def,
@@ -171,6 +268,10 @@ static iree_status_t iree_replay_benchmark_run_file(
   if (FLAG_reuse_modules) {
     replay_flags |= IREE_TRACE_REPLAY_FLAG_REUSE_MODULES;
   }
+  if (FLAG_replay_streams > 1) {
+    return iree_replay_benchmark_run_file_streams(registration, replay_flags,
+                                                  benchmark_state);
+  }
 
   // Setup replay state used for this benchmark.
   iree_trace_replay_t replay;
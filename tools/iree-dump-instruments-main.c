@@ -195,6 +195,33 @@ static iree_status_t iree_tooling_dump_dispatch_ringbuffer(
         i += sizeof(*value);
         break;
       }
+      case IREE_INSTRUMENT_DISPATCH_TYPE_TIMELINE: {
+        const iree_instrument_dispatch_timeline_t* timeline =
+            (const iree_instrument_dispatch_timeline_t*)header;
+        flatbuffers_string_t name_def = NULL;
+        if (timeline->dispatch_id < iree_instruments_DispatchSiteDef_vec_len(
+                                        metadata->dispatch_sites_def)) {
+          iree_instruments_DispatchSiteDef_table_t dispatch_site_def =
+              iree_instruments_DispatchSiteDef_vec_at(
+                  metadata->dispatch_sites_def, timeline->dispatch_id);
+          iree_instruments_DispatchFunctionDef_table_t function_def =
+              iree_instruments_DispatchFunctionDef_vec_at(
+                  metadata->functions_def,
+                  iree_instruments_DispatchSiteDef_function(dispatch_site_def));
+          name_def = iree_instruments_DispatchFunctionDef_name(function_def);
+        }
+        fprintf(stream,
+                "%016" PRIX64
+                " | TIMELINE dispatch(%u %s) %u+%u wid:%u %" PRId64
+                "-%" PRId64 " %" PRId64 "ns\n",
+                (uint64_t)i, timeline->dispatch_id,
+                name_def ? name_def : "<unknown>", timeline->workgroup_index,
+                timeline->workgroup_count, timeline->worker_id,
+                timeline->begin_time_ns, timeline->end_time_ns,
+                timeline->end_time_ns - timeline->begin_time_ns);
+        i += sizeof(*timeline);
+        break;
+      }
       case IREE_INSTRUMENT_DISPATCH_TYPE_MEMORY_LOAD: {
         const iree_instrument_dispatch_memory_op_t* op =
             (const iree_instrument_dispatch_memory_op_t*)header;
@@ -273,6 +300,18 @@ int main(int argc, char** argv) {
             "        --input=4xf32=4 \\n"
             "        --instrument_file=instrument.bin\n"
             "  $ iree-dump-instruments instrument.bin\n"
+            "\n"
+            "Dispatch timelines can be captured from the local CPU devices\n"
+            "without recompiling:\n"
+            "  $ iree-run-module \\n"
+            "        --device=local-task \\n"
+            "        --module=simple_mul.vmfb \\n"
+            "        --function=simple_mul \\n"
+            "        --input=4xf32=2 \\n"
+            "        --input=4xf32=4 \\n"
+            "        --device_profiling_mode=timeline \\n"
+            "        --device_profiling_file=timeline.bin\n"
+            "  $ iree-dump-instruments timeline.bin\n"
             "\n");
     return 1;
   }
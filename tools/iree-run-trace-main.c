@@ -9,17 +9,25 @@
 #include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/file_io.h"
 #include "iree/base/internal/flags.h"
 #include "iree/base/internal/path.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/hal/api.h"
 #include "iree/tooling/device_util.h"
 #include "iree/tooling/trace_replay.h"
+#include "iree/tooling/trace_replay_streams.h"
 #include "iree/tooling/vm_util.h"
 #include "iree/tooling/yaml_util.h"
 #include "iree/vm/api.h"
 
 IREE_FLAG(bool, trace_execution, false, "Traces VM execution to stderr.");
 
+IREE_FLAG(bool, capture_stdin, false,
+          "Captures stdin up to EOF on startup to use during trace execution. "
+          "Required for traces loading `<stdin>` modules on multiple replay "
+          "streams as each stream loads the module.");
+
 IREE_FLAG(bool, print_statistics, false,
           "Prints runtime statistics to stderr on exit.");
 
@@ -45,6 +53,9 @@ IREE_FLAG_LIST(
     "\n"
     "Numpy npy files from numpy.save can be read to provide 1+ values:\n"
     "  @some.npy\n"
+    "Numpy npz files from numpy.savez provide all arrays in archive order and\n"
+    "are loaded in parallel (mapping the file directly when possible):\n"
+    "  @some.npz\n"
     "\n"
     "Each occurrence of the flag indicates an input in the order they were\n"
     "specified on the command line.");
@@ -83,21 +94,38 @@ IREE_FLAG(int32_t, output_max_element_count, 1024,
           "Prints up to the maximum number of elements of output tensors, "
           "eliding the remainder.");
 
+IREE_FLAG(int32_t, replay_streams, 1,
+          "Number of concurrent replay streams each with its own context on a "
+          "shared device. Events with a `stream: N` key run on stream N modulo "
+          "the stream count and events without one run on all streams. "
+          "Requires exactly one --device= when greater than 1. Per-stream "
+          "call timing is printed to stderr with --print_statistics.");
+IREE_FLAG(int32_t, replay_queue_depth,
+          IREE_TRACE_REPLAY_STREAMS_DEFAULT_QUEUE_DEPTH,
+          "Maximum number of parsed events pending per replay stream before "
+          "parsing blocks. Bounds replay memory usage for large traces.");
+
+// Serializes printing from the call hooks when running multiple streams.
+static iree_slim_mutex_t iree_run_trace_print_mutex;
+
 static iree_status_t iree_trace_replay_call_before(void* user_data,
                                                    iree_trace_replay_t* replay,
                                                    yaml_document_t* document,
                                                    yaml_node_t* event_node,
                                                    iree_vm_function_t function,
                                                    iree_vm_list_t* input_list) {
+  iree_status_t status = iree_ok_status();
   if (FLAG_print_calls || FLAG_print_call_inputs) {
+    iree_slim_mutex_lock(&iree_run_trace_print_mutex);
     iree_string_view_t function_name = iree_vm_function_name(&function);
     fprintf(stdout, "--- CALL[%.*s] ---\n", (int)function_name.size,
             function_name.data);
-    IREE_RETURN_IF_ERROR(iree_tooling_variant_list_fprint(
+    status = iree_tooling_variant_list_fprint(
         IREE_SV("arg"), input_list,
-        (iree_host_size_t)FLAG_output_max_element_count, stdout));
+        (iree_host_size_t)FLAG_output_max_element_count, stdout);
+    iree_slim_mutex_unlock(&iree_run_trace_print_mutex);
   }
-  return iree_ok_status();
+  return status;
 }
 
 static iree_status_t iree_trace_replay_call_after(void* user_data,
@@ -106,24 +134,27 @@ static iree_status_t iree_trace_replay_call_after(void* user_data,
                                                   yaml_node_t* event_node,
                                                   iree_vm_function_t function,
                                                   iree_vm_list_t* output_list) {
+  iree_status_t status = iree_ok_status();
   if (FLAG_print_calls || FLAG_print_call_outputs) {
+    iree_slim_mutex_lock(&iree_run_trace_print_mutex);
     if (!FLAG_print_calls && !FLAG_print_call_inputs) {
       iree_string_view_t function_name = iree_vm_function_name(&function);
       fprintf(stdout, "--- CALL[%.*s] ---\n", (int)function_name.size,
               function_name.data);
     }
-    IREE_RETURN_IF_ERROR(iree_tooling_variant_list_fprint(
+    status = iree_tooling_variant_list_fprint(
         IREE_SV("result"), output_list,
-        (iree_host_size_t)FLAG_output_max_element_count, stdout));
+        (iree_host_size_t)FLAG_output_max_element_count, stdout);
+    iree_slim_mutex_unlock(&iree_run_trace_print_mutex);
   }
-  return iree_ok_status();
+  return status;
 }
 
 // Runs the trace in |file| using |root_path| as the base for any path lookups
 // required for external files referenced in |file|.
-static iree_status_t iree_run_trace_file(iree_string_view_t root_path,
-                                         FILE* file,
-                                         iree_vm_instance_t* instance) {
+static iree_status_t iree_run_trace_file(
+    iree_string_view_t root_path, FILE* file, iree_vm_instance_t* instance,
+    iree_const_byte_span_t stdin_contents) {
   iree_trace_replay_flags_t replay_flags = IREE_TRACE_REPLAY_FLAG_NONE;
   if (FLAG_print_statistics) {
     replay_flags |= IREE_TRACE_REPLAY_FLAG_PRINT_STATISTICS;
@@ -138,6 +169,7 @@ static iree_status_t iree_run_trace_file(iree_string_view_t root_path,
   IREE_RETURN_IF_ERROR(iree_trace_replay_initialize(
       root_path, instance, replay_flags, context_flags,
       iree_hal_available_driver_registry(), iree_allocator_system(), &replay));
+  replay.stdin_contents = stdin_contents;
 
   // Hook into all calls processed during the trace.
   replay.call_hooks.user_data = NULL;
@@ -218,9 +250,91 @@ static iree_status_t iree_run_trace_file(iree_string_view_t root_path,
   return status;
 }
 
+// Runs the trace in |file| across FLAG_replay_streams concurrent streams
+// sharing a single device. Each stream receives its own copy of the inputs and
+// the outputs of each stream are printed after all streams complete.
+static iree_status_t iree_run_trace_file_streams(
+    iree_string_view_t root_path, FILE* file, iree_vm_instance_t* instance,
+    iree_const_byte_span_t stdin_contents) {
+  if (FLAG_output_list().count > 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "--output= is not supported with multiple replay "
+                            "streams; outputs are printed per stream");
+  }
+  if (FLAG_replay_queue_depth < 1) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "--replay_queue_depth must be at least 1; got %d",
+                            FLAG_replay_queue_depth);
+  }
+
+  iree_trace_replay_streams_options_t options;
+  memset(&options, 0, sizeof(options));
+  options.stream_count = (iree_host_size_t)FLAG_replay_streams;
+  options.queue_depth = (iree_host_size_t)FLAG_replay_queue_depth;
+  if (FLAG_print_statistics) {
+    options.replay_flags |= IREE_TRACE_REPLAY_FLAG_PRINT_STATISTICS;
+  }
+  if (FLAG_trace_execution) {
+    options.context_flags |= IREE_VM_CONTEXT_FLAG_TRACE_EXECUTION;
+  }
+  options.call_hooks.before = iree_trace_replay_call_before;
+  options.call_hooks.after = iree_trace_replay_call_after;
+
+  iree_host_size_t device_uri_count = 0;
+  const iree_string_view_t* device_uris = NULL;
+  iree_hal_get_devices_flag_list(&device_uri_count, &device_uris);
+  iree_trace_replay_streams_t* streams = NULL;
+  IREE_RETURN_IF_ERROR(iree_trace_replay_streams_create(
+      root_path, instance, &options, iree_hal_available_driver_registry(),
+      device_uri_count, device_uris, iree_allocator_system(), &streams));
+
+  for (iree_host_size_t i = 0; i < iree_trace_replay_streams_count(streams);
+       ++i) {
+    iree_trace_replay_streams_replay(streams, i)->stdin_contents =
+        stdin_contents;
+  }
+
+  // Each stream gets its own inputs as `!input.take` consumes them.
+  iree_hal_allocator_t* device_allocator =
+      iree_hal_device_allocator(iree_trace_replay_streams_device(streams));
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0;
+       i < iree_trace_replay_streams_count(streams) && iree_status_is_ok(status);
+       ++i) {
+    iree_trace_replay_t* replay = iree_trace_replay_streams_replay(streams, i);
+    status = iree_tooling_parse_into_variant_list(
+        device_allocator, FLAG_input_list().values, FLAG_input_list().count,
+        replay->host_allocator, replay->inputs);
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_trace_replay_streams_run_file(streams, file);
+  }
+
+  for (iree_host_size_t i = 0;
+       i < iree_trace_replay_streams_count(streams) && iree_status_is_ok(status);
+       ++i) {
+    iree_trace_replay_t* replay = iree_trace_replay_streams_replay(streams, i);
+    if (iree_vm_list_size(replay->outputs) == 0) continue;
+    fprintf(stdout, "--- STREAM[%" PRIhsz "] ---\n", i);
+    status = iree_status_annotate(
+        iree_tooling_variant_list_fprint(
+            IREE_SV("output"), replay->outputs,
+            (iree_host_size_t)FLAG_output_max_element_count, stdout),
+        IREE_SV("printing results"));
+  }
+
+  if (FLAG_print_statistics) {
+    iree_trace_replay_streams_fprint_statistics(streams, stderr);
+  }
+  iree_trace_replay_streams_destroy(streams);
+  return status;
+}
+
 // Runs each of the given traces files sequentially in isolated contexts.
-static iree_status_t iree_run_trace_files(int file_count, char** file_paths,
-                                          iree_vm_instance_t* instance) {
+static iree_status_t iree_run_trace_files(
+    int file_count, char** file_paths, iree_vm_instance_t* instance,
+    iree_const_byte_span_t stdin_contents) {
   for (int i = 0; i < file_count; ++i) {
     iree_string_view_t file_path = iree_make_cstring_view(file_paths[i]);
     iree_string_view_t root_path = iree_file_path_dirname(file_path);
@@ -230,7 +344,11 @@ static iree_status_t iree_run_trace_files(int file_count, char** file_paths,
                               "failed to open trace file '%.*s'",
                               (int)file_path.size, file_path.data);
     }
-    iree_status_t status = iree_run_trace_file(root_path, file, instance);
+    iree_status_t status =
+        FLAG_replay_streams > 1
+            ? iree_run_trace_file_streams(root_path, file, instance,
+                                          stdin_contents)
+            : iree_run_trace_file(root_path, file, instance, stdin_contents);
     fclose(file);
     IREE_RETURN_IF_ERROR(status, "replaying trace file '%.*s'",
                          (int)file_path.size, file_path.data);
@@ -313,6 +431,16 @@ int main(int argc, char** argv) {
       "Uses arguments from an `args` sequence and produces results into a\n"
       "`results` sequence.\n"
       "\n"
+      "--- Streams ---\n"
+      "\n"
+      "With `--replay_streams=N` the trace is replayed on N concurrent\n"
+      "streams, each with its own context, inputs, outputs, and blackboard\n"
+      "on a single shared device. Any event may include a `stream: ID` key\n"
+      "to run only on stream ID modulo N (such as a recorded session ID).\n"
+      "Events without a `stream` key run on all streams. Per-stream and\n"
+      "aggregate call timing is printed to stderr with --print_statistics.\n"
+      "Modules loaded from `<stdin>` require --capture_stdin.\n"
+      "\n"
       "--- Sources ---\n"
       "\n"
       "`type: null`\n"
@@ -362,13 +490,27 @@ int main(int argc, char** argv) {
     return 1;
   }
 
+  iree_slim_mutex_initialize(&iree_run_trace_print_mutex);
   iree_vm_instance_t* instance = NULL;
   iree_status_t status = iree_vm_instance_create(
       IREE_VM_TYPE_CAPACITY_DEFAULT, iree_allocator_system(), &instance);
+
+  // Read all of stdin up front so that it can be used multiple times (such as
+  // by each replay stream loading a `<stdin>` module).
+  iree_file_contents_t* stdin_contents = NULL;
+  if (iree_status_is_ok(status) && FLAG_capture_stdin) {
+    status = iree_stdin_read_contents(iree_allocator_system(), &stdin_contents);
+  }
+
   if (iree_status_is_ok(status)) {
-    status = iree_run_trace_files(argc - 1, argv + 1, instance);
+    status = iree_run_trace_files(argc - 1, argv + 1, instance,
+                                  stdin_contents
+                                      ? stdin_contents->const_buffer
+                                      : iree_const_byte_span_empty());
   }
+  iree_file_contents_free(stdin_contents);
   iree_vm_instance_release(instance);
+  iree_slim_mutex_deinitialize(&iree_run_trace_print_mutex);
   if (!iree_status_is_ok(status)) {
     iree_status_fprint(stderr, status);
     iree_status_free(status);
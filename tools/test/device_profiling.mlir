@@ -0,0 +1,47 @@
+// Tests local HAL dispatch profiling via the --device_profiling_* flags.
+
+// RUN: iree-compile --iree-hal-target-backends=vmvx %s -o %t.vmfb
+
+// Timelines are recorded per worker on local-task and written as an
+// instrument stream that can be dumped with iree-dump-instruments.
+
+// RUN: iree-run-module --device=local-task --module=%t.vmfb --function=abs \
+// RUN:   --input=4xf32=-2 --device_profiling_mode=timeline \
+// RUN:   --device_profiling_file=%t.task.idbts | \
+// RUN: FileCheck --check-prefix=EXEC %s
+// RUN: iree-dump-instruments %t.task.idbts | \
+// RUN: FileCheck --check-prefix=TIMELINE %s
+
+// Timelines on local-sync record each dispatch as a single interval.
+
+// RUN: iree-run-module --device=local-sync --module=%t.vmfb --function=abs \
+// RUN:   --input=4xf32=-2 --device_profiling_mode=timeline \
+// RUN:   --device_profiling_file=%t.sync.idbts | \
+// RUN: FileCheck --check-prefix=EXEC %s
+// RUN: iree-dump-instruments %t.sync.idbts | \
+// RUN: FileCheck --check-prefix=TIMELINE %s
+
+// Dispatch counters are aggregated per export. Hardware counters may be
+// unavailable in the test environment but workgroups are always counted.
+
+// RUN: iree-run-module --device=local-task --module=%t.vmfb --function=abs \
+// RUN:   --input=4xf32=-2 --device_profiling_mode=dispatch \
+// RUN:   --device_profiling_file=%t.csv | \
+// RUN: FileCheck --check-prefix=EXEC %s
+// RUN: FileCheck --check-prefix=COUNTERS --input-file=%t.csv %s
+
+// EXEC-LABEL: EXEC @abs
+// EXEC: 4xf32=2 2 2 2
+
+// TIMELINE: // dispatch site 0: {{.*}}abs{{.*}}
+// TIMELINE: TIMELINE dispatch(0 {{.*}}abs{{.*}}) {{[0-9]+}}+{{[0-9]+}} wid:{{[0-9]+}}
+
+// COUNTERS: ; IREE local HAL dispatch profile
+// COUNTERS-NOT: dropped
+// COUNTERS: "Export","Workgroups","Total Time (us)"
+// COUNTERS-NEXT: "{{.*}}abs{{.*}}",{{[1-9][0-9]*}},
+
+func.func @abs(%input : tensor<4xf32>) -> (tensor<4xf32>) {
+  %result = math.absf %input : tensor<4xf32>
+  return %result : tensor<4xf32>
+}
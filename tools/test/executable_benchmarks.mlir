@@ -5,6 +5,17 @@
 // RUN: iree-benchmark-module --module=- | \
 // RUN: FileCheck %s
 
+// Dispatches with a static roofline cost report their achieved throughput.
+// RUN: iree-compile %s -o ignored.mlir \
+// RUN:     --iree-hal-target-backends=vmvx \
+// RUN:     --iree-flow-annotate-dispatch-roofline \
+// RUN:     --iree-hal-dump-executable-benchmarks-to=- | \
+// RUN: iree-compile - | \
+// RUN: iree-benchmark-module --module=- \
+// RUN:     --roofline_peak_gflops=1000 \
+// RUN:     --roofline_peak_gbps=100 | \
+// RUN: FileCheck --check-prefix=ROOFLINE %s
+
 // This test relies on us piping stdout and that there's only a single
 // executable (otherwise we'd need to look at files and that's harder
 // cross-platform). Real automation of this requires xargs: compile and dump a
@@ -27,6 +38,13 @@
 // from being benchmarkable without explicit shape arguments.
 
 // CHECK: BM_abs_dispatch_0_vmvx_bytecode_fb_abs_dispatch_0_generic
+
+// Counters are listed in lexicographic order.
+// ROOFLINE: BM_abs_dispatch_0_vmvx_bytecode_fb_abs_dispatch_0_generic
+// ROOFLINE-SAME: %peak_bandwidth=
+// ROOFLINE-SAME: %peak_flops=
+// ROOFLINE-SAME: GB/s=
+// ROOFLINE-SAME: GFLOP/s=
 func.func @abs(%input : tensor<f32>) -> (tensor<f32>) {
   %result = math.absf %input : tensor<f32>
   return %result : tensor<f32>
@@ -0,0 +1,45 @@
+// Tests reuse of executables across compilations via the executable cache.
+
+// RUN: rm -rf %t.cache %t.dump
+
+// The first compilation populates the cache and the second reuses it.
+
+// RUN: iree-compile %s -o %t.vmfb --iree-hal-target-backends=llvm-cpu \
+// RUN:     --iree-hal-executable-cache-path=%t.cache \
+// RUN:     --mlir-pass-statistics 2>&1 | \
+// RUN: FileCheck --check-prefix=MISS %s
+// RUN: iree-compile %s -o %t.vmfb --iree-hal-target-backends=llvm-cpu \
+// RUN:     --iree-hal-executable-cache-path=%t.cache \
+// RUN:     --mlir-pass-statistics 2>&1 | \
+// RUN: FileCheck --check-prefix=HIT %s
+
+// Changing a flag that affects code generation misses the cache.
+
+// RUN: iree-compile %s -o %t.vmfb --iree-hal-target-backends=llvm-cpu \
+// RUN:     --iree-hal-executable-cache-path=%t.cache \
+// RUN:     --iree-llvmcpu-debug-symbols=false \
+// RUN:     --mlir-pass-statistics 2>&1 | \
+// RUN: FileCheck --check-prefix=MISS %s
+
+// Binaries are still dumped when the translated variants are loaded from the
+// cache.
+
+// RUN: iree-compile %s -o %t.vmfb --iree-hal-target-backends=llvm-cpu \
+// RUN:     --iree-hal-executable-cache-path=%t.cache \
+// RUN:     --iree-hal-dump-executable-binaries-to=%t.dump \
+// RUN:     --mlir-pass-statistics 2>&1 | \
+// RUN: FileCheck --check-prefix=HIT %s
+// RUN: ls %t.dump | FileCheck --check-prefix=DUMP %s
+
+// MISS-DAG: (S) 0 cache hit(s)
+// MISS-DAG: (S) 1 cache miss(es)
+
+// HIT-DAG: (S) 1 cache hit(s)
+// HIT-DAG: (S) 0 cache miss(es)
+
+// DUMP: module_abs_dispatch_0{{.*}}.so
+
+func.func @abs(%input : tensor<4xf32>) -> (tensor<4xf32>) {
+  %result = math.absf %input : tensor<4xf32>
+  return %result : tensor<4xf32>
+}
@@ -0,0 +1,62 @@
+// Tests that executable_library_benchmark reports the achieved throughput of
+// dispatches that have a static roofline cost embedded in their library.
+
+// RUN: iree-compile %s -o %t.so \
+// RUN:     --compile-mode=hal-executable \
+// RUN:     --iree-hal-target-backends=llvm-cpu \
+// RUN:     --iree-llvmcpu-link-embedded=true && \
+// RUN: executable_library_benchmark \
+// RUN:     --executable_format=embedded-elf \
+// RUN:     --executable_file=%t.so \
+// RUN:     --entry_point=0 \
+// RUN:     --binding=4xf32=1,2,3,4 \
+// RUN:     --binding=4xf32=100,200,300,400 \
+// RUN:     --binding=4xf32=0,0,0,0 \
+// RUN:     --roofline_peak_gflops=1000 \
+// RUN:     --roofline_peak_gbps=100 | \
+// RUN: FileCheck %s
+
+// Counters are listed in lexicographic order.
+// CHECK: BM_dispatch
+// CHECK-SAME: %peak_bandwidth=
+// CHECK-SAME: %peak_flops=
+// CHECK-SAME: GB/s=
+// CHECK-SAME: GFLOP/s=
+
+#pipeline_layout = #hal.pipeline.layout<push_constants = 0, sets = [
+  #hal.descriptor_set.layout<0, bindings = [
+    #hal.descriptor_set.binding<0, storage_buffer>,
+    #hal.descriptor_set.binding<1, storage_buffer>,
+    #hal.descriptor_set.binding<2, storage_buffer>
+  ]>
+]>
+
+// The cost is normally computed by --iree-flow-annotate-dispatch-roofline and
+// is specified directly here as there is no flow-level program.
+hal.executable.source public @ex {
+  hal.executable.export public @elementwise_mul ordinal(0) layout(#pipeline_layout) attributes {
+    iree.roofline = {bytes = 48 : i64, flops = 4 : i64}
+  }
+  builtin.module {
+    func.func @elementwise_mul() {
+      %c0 = arith.constant 0 : index
+      %lhs = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) alignment(32) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<4xf32>>
+      %rhs = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) alignment(32) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<4xf32>>
+      %dst = hal.interface.binding.subspan set(0) binding(2) type(storage_buffer) alignment(32) offset(%c0) : !flow.dispatch.tensor<writeonly:tensor<4xf32>>
+      %lhs_value = flow.dispatch.tensor.load %lhs, offsets = [0], sizes = [4], strides = [1] : !flow.dispatch.tensor<readonly:tensor<4xf32>> -> tensor<4xf32>
+      %rhs_value = flow.dispatch.tensor.load %rhs, offsets = [0], sizes = [4], strides = [1] : !flow.dispatch.tensor<readonly:tensor<4xf32>> -> tensor<4xf32>
+      %dst_init = tensor.empty() : tensor<4xf32>
+      %dst_value = linalg.generic {
+        indexing_maps = [affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>],
+        iterator_types = ["parallel"]
+      } ins(%lhs_value, %rhs_value : tensor<4xf32>, tensor<4xf32>)
+        outs(%dst_init : tensor<4xf32>) {
+        ^bb0(%lhs_element: f32, %rhs_element: f32, %dst_element: f32):
+          %product = arith.mulf %lhs_element, %rhs_element : f32
+          linalg.yield %product : f32
+        } -> tensor<4xf32>
+      flow.dispatch.tensor.store %dst_value, %dst, offsets = [0], sizes = [4], strides = [1] : tensor<4xf32> -> !flow.dispatch.tensor<writeonly:tensor<4xf32>>
+      return
+    }
+  }
+}
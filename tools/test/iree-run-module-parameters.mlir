@@ -0,0 +1,43 @@
+// Tests serving constants externalized into a parameter archive to programs
+// with --parameters=.
+
+// The archive is registered under the scope the program was compiled with.
+// RUN: iree-compile %s -o %t.vmfb \
+// RUN:     --iree-hal-target-backends=vmvx \
+// RUN:     --iree-flow-inline-constants-max-byte-length=0 \
+// RUN:     --iree-vm-target-parameter-archive=%t.irpa \
+// RUN:     --iree-vm-target-parameter-archive-scope=model \
+// RUN:     --iree-vm-target-parameter-archive-minimum-size=64 && \
+// RUN: iree-run-module --device=local-task --module=%t.vmfb \
+// RUN:     --function=add --input=16xi32=1 \
+// RUN:     --parameters=model=%t.irpa | \
+// RUN: FileCheck %s
+
+// Archives registered without the scope do not satisfy scoped lookups.
+// RUN: not iree-run-module --device=local-task --module=%t.vmfb \
+// RUN:     --function=add --input=16xi32=1 \
+// RUN:     --parameters=%t.irpa 2>&1 | \
+// RUN: FileCheck --check-prefix=CHECK-MISSING %s
+
+// Paths may contain `=` once a directory is part of the text before it.
+// RUN: rm -rf %t.dir && mkdir -p %t.dir
+// RUN: iree-compile %s -o %t.unscoped.vmfb \
+// RUN:     --iree-hal-target-backends=vmvx \
+// RUN:     --iree-flow-inline-constants-max-byte-length=0 \
+// RUN:     --iree-vm-target-parameter-archive=%t.dir/weights=v1.irpa \
+// RUN:     --iree-vm-target-parameter-archive-minimum-size=64 && \
+// RUN: iree-run-module --device=local-task --module=%t.unscoped.vmfb \
+// RUN:     --function=add --input=16xi32=1 \
+// RUN:     --parameters=%t.dir/weights=v1.irpa | \
+// RUN: FileCheck %s
+
+// CHECK-LABEL: EXEC @add
+// CHECK: 16xi32=1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16
+
+// CHECK-MISSING: parameter '{{.+}}' not found in scope 'model'
+
+func.func @add(%input: tensor<16xi32>) -> tensor<16xi32> {
+  %weight = arith.constant dense<[0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15]> : tensor<16xi32>
+  %result = arith.addi %input, %weight : tensor<16xi32>
+  return %result : tensor<16xi32>
+}
@@ -15,6 +15,37 @@
 //      RUN-TRACE{LITERAL}: [ 0. 4. 8. 12.]
 // RUN-TRACE-NEXT{LITERAL}: [ 0. 12. 24. 36.]
 
+// Tests replaying the same trace on two concurrent streams sharing a device.
+// Each stream gets its own copy of the inputs and prints its own outputs. The
+// module is loaded from stdin on each stream so stdin must be captured.
+// RUN: (iree-compile --iree-hal-target-backends=vmvx %s | \
+// RUN:  iree-run-trace %S/iree-run-trace.yml \
+// RUN:                 --capture_stdin=true \
+// RUN:                 --replay_streams=2 \
+// RUN:                 --device=local-sync \
+// RUN:                 --input=4xf32=4,4,4,4) | \
+// RUN: FileCheck %s --check-prefix=RUN-STREAMS
+//      RUN-STREAMS{LITERAL}: --- STREAM[0] ---
+// RUN-STREAMS-NEXT{LITERAL}: output[0]: hal.buffer_view
+// RUN-STREAMS-NEXT{LITERAL}: 4xf32=0 4 8 12
+// RUN-STREAMS-NEXT{LITERAL}: output[1]: hal.buffer_view
+// RUN-STREAMS-NEXT{LITERAL}: 4xf32=0 12 24 36
+// RUN-STREAMS-NEXT{LITERAL}: --- STREAM[1] ---
+// RUN-STREAMS-NEXT{LITERAL}: output[0]: hal.buffer_view
+// RUN-STREAMS-NEXT{LITERAL}: 4xf32=0 4 8 12
+// RUN-STREAMS-NEXT{LITERAL}: output[1]: hal.buffer_view
+// RUN-STREAMS-NEXT{LITERAL}: 4xf32=0 12 24 36
+
+// Tests that invalid replay stream queue depths are rejected.
+// RUN: (iree-compile --iree-hal-target-backends=vmvx %s | \
+// RUN:  not iree-run-trace %S/iree-run-trace.yml \
+// RUN:                     --capture_stdin=true \
+// RUN:                     --replay_streams=2 \
+// RUN:                     --replay_queue_depth=-1 \
+// RUN:                     --device=local-sync) 2>&1 | \
+// RUN: FileCheck %s --check-prefix=RUN-STREAMS-INVALID
+// RUN-STREAMS-INVALID: --replay_queue_depth must be at least 1; got -1
+
 // Tests iree-run-benchmark usage by running the same sequence as above but with
 // benchmarking enabled. The tools are mostly interchangable except benchmarking
 // doesn't yield any output values or feature I/O printing. All traces that can
@@ -27,6 +58,16 @@
 // RUN: FileCheck %s --check-prefix=BENCHMARK-TRACE
 // BENCHMARK-TRACE{LITERAL}: BM_iree-run-trace/process_time/real_time
 
+// Tests iree-benchmark-trace timing full replays across concurrent streams.
+// RUN: (iree-compile --iree-hal-target-backends=vmvx %s | \
+// RUN:  iree-benchmark-trace %S/iree-run-trace.yml \
+// RUN:                       --capture_stdin=true \
+// RUN:                       --replay_streams=2 \
+// RUN:                       --device=local-sync \
+// RUN:                       --input=4xf32=4,4,4,4) | \
+// RUN: FileCheck %s --check-prefix=BENCHMARK-STREAMS
+// BENCHMARK-STREAMS{LITERAL}: BM_iree-run-trace/process_time/real_time
+
 func.func @mul(%arg0: tensor<4xf32>, %arg1: tensor<4xf32>) -> tensor<4xf32> {
   %0 = arith.mulf %arg0, %arg1 : tensor<4xf32>
   return %0 : tensor<4xf32>